@@ -0,0 +1,236 @@
+/* GStreamer
+ *
+ * gstbandpool.c: runs the bands of a frame or buffer in parallel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:gstbandpool
+ * @short_description: parallel processing of independent bands
+ *
+ * Elements that can split their work into independent parts, like line
+ * bands of a video frame or the channels of an audio buffer, describe each
+ * part in an array of band structures and hand it to gst_band_pool_run().
+ * The first band is processed in the calling thread, the others on a
+ * thread pool that is created when it is first needed. The call returns
+ * once all bands are done.
+ *
+ * gst_band_pool_get_n_bands() picks the number of bands from a thread
+ * count property, where 0 means one thread per processor, and a minimum
+ * band size that keeps the per-band overhead small.
+ *
+ * The elements of a plugin share the pool returned by
+ * gst_band_pool_get_default(), which runs at most one thread per processor
+ * however many of them run bands at the same time. The library is linked
+ * statically into every plugin that uses it, the plugins share the idle
+ * threads through the global GLib thread pool all non-exclusive
+ * #GThreadPool use. A pool can run bands for several threads at the same
+ * time.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbandpool.h"
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+struct _GstBandPool
+{
+  GThreadPool *threads;
+  GMutex lock;
+  /* signalled whenever the last band of a run is done */
+  GCond cond;
+};
+
+typedef struct
+{
+  GstBandPool *pool;
+  GstBandPoolFunc func;
+  gpointer band;
+  gpointer user_data;
+  /* bands of the run that are not done yet, protected by the pool lock */
+  guint *pending;
+} GstBandPoolJob;
+
+static void
+gst_band_pool_job_func (gpointer data, gpointer user_data)
+{
+  GstBandPoolJob *job = data;
+  GstBandPool *pool = job->pool;
+
+  job->func (job->band, job->user_data);
+
+  g_mutex_lock (&pool->lock);
+  if (--(*job->pending) == 0)
+    g_cond_broadcast (&pool->cond);
+  g_mutex_unlock (&pool->lock);
+}
+
+/**
+ * gst_band_pool_new:
+ *
+ * Creates a pool with its own threads, at most one per processor. Elements
+ * use gst_band_pool_get_default() instead.
+ *
+ * Returns: a new #GstBandPool, free with gst_band_pool_free()
+ */
+GstBandPool *
+gst_band_pool_new (void)
+{
+  GstBandPool *pool = g_slice_new0 (GstBandPool);
+
+  g_mutex_init (&pool->lock);
+  g_cond_init (&pool->cond);
+
+  return pool;
+}
+
+/**
+ * gst_band_pool_get_default:
+ *
+ * Returns: (transfer none): the pool shared by all elements, it is never
+ *     freed
+ */
+GstBandPool *
+gst_band_pool_get_default (void)
+{
+  static gsize default_pool = 0;
+
+  if (g_once_init_enter (&default_pool))
+    g_once_init_leave (&default_pool, (gsize) gst_band_pool_new ());
+
+  return (GstBandPool *) default_pool;
+}
+
+/**
+ * gst_band_pool_free:
+ * @pool: a #GstBandPool
+ *
+ * Frees @pool and stops its threads. The default pool must not be freed.
+ */
+void
+gst_band_pool_free (GstBandPool * pool)
+{
+  g_return_if_fail (pool != NULL);
+
+  if (pool->threads)
+    g_thread_pool_free (pool->threads, FALSE, TRUE);
+  g_mutex_clear (&pool->lock);
+  g_cond_clear (&pool->cond);
+
+  g_slice_free (GstBandPool, pool);
+}
+
+/**
+ * gst_band_pool_get_n_cpus:
+ *
+ * Returns: the number of processors online, at least 1
+ */
+guint
+gst_band_pool_get_n_cpus (void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+  glong n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+
+  return n_cpus > 0 ? n_cpus : 1;
+#else
+  return 1;
+#endif
+}
+
+/**
+ * gst_band_pool_get_n_bands:
+ * @n_threads: the number of threads to use, 0 for the number of processors
+ * @n_items: the number of lines, channels or other items to split
+ * @min_band_size: the minimum number of items per band
+ *
+ * Returns: the number of bands to split @n_items items into, at least 1
+ */
+guint
+gst_band_pool_get_n_bands (guint n_threads, guint n_items,
+    guint min_band_size)
+{
+  if (n_threads == 0)
+    n_threads = gst_band_pool_get_n_cpus ();
+
+  return CLAMP (n_threads, 1, MAX (n_items / MAX (min_band_size, 1), 1));
+}
+
+/**
+ * gst_band_pool_run:
+ * @pool: a #GstBandPool
+ * @func: the function processing one band
+ * @user_data: user data to pass to @func
+ * @bands: an array of @n_bands band structures
+ * @band_size: the size of one band structure
+ * @n_bands: the number of bands
+ *
+ * Calls @func on all bands and waits until they are done. The first band
+ * is processed in the calling thread, the others wait for a free thread of
+ * the pool if all of them are busy with bands of other runs.
+ */
+void
+gst_band_pool_run (GstBandPool * pool, GstBandPoolFunc func,
+    gpointer user_data, gpointer bands, gsize band_size, guint n_bands)
+{
+  GstBandPoolJob *jobs;
+  guint pending;
+  guint i;
+
+  g_return_if_fail (pool != NULL);
+  g_return_if_fail (func != NULL);
+  g_return_if_fail (bands != NULL || n_bands == 0);
+
+  if (n_bands > 1) {
+    g_mutex_lock (&pool->lock);
+    if (pool->threads == NULL)
+      pool->threads = g_thread_pool_new (gst_band_pool_job_func, NULL,
+          gst_band_pool_get_n_cpus (), FALSE, NULL);
+    g_mutex_unlock (&pool->lock);
+  }
+
+  if (n_bands < 2 || pool->threads == NULL) {
+    for (i = 0; i < n_bands; i++)
+      func ((guint8 *) bands + i * band_size, user_data);
+    return;
+  }
+
+  jobs = g_newa (GstBandPoolJob, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    jobs[i].pool = pool;
+    jobs[i].func = func;
+    jobs[i].band = (guint8 *) bands + i * band_size;
+    jobs[i].user_data = user_data;
+    jobs[i].pending = &pending;
+  }
+
+  /* the first band is done in this thread */
+  pending = n_bands - 1;
+  for (i = 1; i < n_bands; i++)
+    g_thread_pool_push (pool->threads, &jobs[i], NULL);
+
+  func (jobs[0].band, user_data);
+
+  g_mutex_lock (&pool->lock);
+  while (pending > 0)
+    g_cond_wait (&pool->cond, &pool->lock);
+  g_mutex_unlock (&pool->lock);
+}
@@ -0,0 +1,53 @@
+/* GStreamer
+ *
+ * gstbandpool.h: runs the bands of a frame or buffer in parallel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_BAND_POOL_H__
+#define __GST_BAND_POOL_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstBandPoolFunc:
+ * @band: the band to process
+ * @user_data: the user data passed to gst_band_pool_run()
+ *
+ * Processes one band.
+ */
+typedef void (*GstBandPoolFunc) (gpointer band, gpointer user_data);
+
+typedef struct _GstBandPool GstBandPool;
+
+GstBandPool *gst_band_pool_new (void);
+void gst_band_pool_free (GstBandPool * pool);
+
+GstBandPool *gst_band_pool_get_default (void);
+
+guint gst_band_pool_get_n_cpus (void);
+guint gst_band_pool_get_n_bands (guint n_threads, guint n_items,
+    guint min_band_size);
+
+void gst_band_pool_run (GstBandPool * pool, GstBandPoolFunc func,
+    gpointer user_data, gpointer bands, gsize band_size, guint n_bands);
+
+G_END_DECLS
+
+#endif /* __GST_BAND_POOL_H__ */
@@ -35,6 +35,11 @@
  * 1. if there is an output ready, deliver
  * 2. otherwise pull from each sink-pad, process requested frames and deliver
  *    the buffer
+ *
+ * Output buffers come from a buffer pool per source pad, or are the input
+ * buffers themselves when those are writable and can be processed in place.
+ * The available frames are handed to process() in blocks of at most
+ * #GstSignalProcessor:block-size frames.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -136,6 +141,7 @@ struct _GstSignalProcessorPad
 
   GstBuffer *pen;
   GstMapInfo map;               /* mapped data to read from / write to */
+  gfloat *data;                 /* first unprocessed frame in map */
 
   /* index for the pad per direction (starting from 0) */
   guint index;
@@ -143,8 +149,12 @@ struct _GstSignalProcessorPad
   /* number of channels for the pad */
   guint channels;
 
-  /* these are only used for sink pads */
-  guint samples_avail;          /* available mono sample frames */
+  guint samples_avail;          /* available mono sample frames after data */
+  guint offset;                 /* sample frames in map before data */
+
+  /* these are only used for src pads */
+  GstBufferPool *pool;
+  gsize pool_size;
 };
 
 static GType
@@ -196,7 +206,19 @@ gst_signal_processor_get_type (void)
   return signal_processor_type;
 }
 
+enum
+{
+  PROP_0,
+  PROP_BLOCK_SIZE
+};
+
+#define DEFAULT_BLOCK_SIZE 0
+
 static void gst_signal_processor_finalize (GObject * object);
+static void gst_signal_processor_set_property (GObject * object,
+    guint prop_id, const GValue * value, GParamSpec * pspec);
+static void gst_signal_processor_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec);
 static gboolean gst_signal_processor_src_activate_mode (GstPad * pad,
     GstObject * parent, GstPadMode mode, gboolean active);
 static gboolean gst_signal_processor_sink_activate_mode (GstPad * pad,
@@ -225,6 +247,14 @@ gst_signal_processor_class_init (GstSignalProcessorClass * klass)
   parent_class = g_type_class_peek_parent (klass);
 
   gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_signal_processor_finalize);
+  gobject_class->set_property = gst_signal_processor_set_property;
+  gobject_class->get_property = gst_signal_processor_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_BLOCK_SIZE,
+      g_param_spec_uint ("block-size", "Block size",
+          "Maximum number of sample frames per processing call, 0 to process "
+          "whole buffers at once", 0, G_MAXUINT, DEFAULT_BLOCK_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_signal_processor_change_state);
@@ -291,12 +321,13 @@ gst_signal_processor_init (GstSignalProcessor * self,
 
   self->group_in = g_new0 (GstSignalProcessorGroup, klass->num_group_in);
   self->group_out = g_new0 (GstSignalProcessorGroup, klass->num_group_out);
-  self->audio_in = g_new0 (GstMapInfo, klass->num_audio_in);
-  self->audio_out = g_new0 (GstMapInfo, klass->num_audio_out);
+  self->audio_in = g_new0 (gfloat *, klass->num_audio_in);
+  self->audio_out = g_new0 (gfloat *, klass->num_audio_out);
 
   /* init */
   self->pending_in = klass->num_group_in + klass->num_audio_in;
   self->pending_out = 0;
+  self->block_size = DEFAULT_BLOCK_SIZE;
 }
 
 static void
@@ -316,6 +347,42 @@ gst_signal_processor_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_signal_processor_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSignalProcessor *self = GST_SIGNAL_PROCESSOR (object);
+
+  switch (prop_id) {
+    case PROP_BLOCK_SIZE:
+      GST_OBJECT_LOCK (self);
+      self->block_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_signal_processor_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSignalProcessor *self = GST_SIGNAL_PROCESSOR (object);
+
+  switch (prop_id) {
+    case PROP_BLOCK_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->block_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static gboolean
 gst_signal_processor_setup (GstSignalProcessor * self, GstCaps * caps)
 {
@@ -379,11 +446,8 @@ static void
 gst_signal_processor_stop (GstSignalProcessor * self)
 {
   GstSignalProcessorClass *klass;
-  GstElement *elem;
-  GList *sinks;
 
   klass = GST_SIGNAL_PROCESSOR_GET_CLASS (self);
-  elem = GST_ELEMENT (self);
 
   GST_INFO_OBJECT (self, "stop()");
 
@@ -392,9 +456,9 @@ gst_signal_processor_stop (GstSignalProcessor * self)
   if (klass->stop)
     klass->stop (self);
 
-  for (sinks = elem->sinkpads; sinks; sinks = sinks->next)
-    /* force set_caps when going to RUNNING, see note in _setcaps () */
-    gst_pad_set_caps (GST_PAD (sinks->data), NULL);
+  /* force set_caps when going to RUNNING, see note in _setcaps (). pads can
+     not be set to NULL caps anymore, forget our copy instead */
+  gst_caps_replace (&self->caps, NULL);
 
   /* should also flush our buffers perhaps? */
 
@@ -551,14 +615,18 @@ static void
 gst_signal_processor_deinterleave_group (GstSignalProcessorGroup * group,
     guint nframes)
 {
+  const gfloat *src = group->interleaved_buffer;
   guint i, j;
+
   g_assert (group->nframes == nframes);
-  g_assert (group->interleaved_map.data);
+  g_assert (group->interleaved_buffer);
   g_assert (group->buffer);
-  for (i = 0; i < nframes; ++i)
-    for (j = 0; j < group->channels; ++j)
-      group->buffer[(j * nframes) + i]
-          = group->interleaved_map.data[(i * group->channels) + j];
+  for (j = 0; j < group->channels; ++j) {
+    gfloat *dest = group->buffer + j * nframes;
+
+    for (i = 0; i < nframes; ++i)
+      dest[i] = src[(i * group->channels) + j];
+  }
 }
 
 /* Interleave a pad (plugin => gstreamer) */
@@ -566,14 +634,32 @@ static void
 gst_signal_processor_interleave_group (GstSignalProcessorGroup * group,
     guint nframes)
 {
+  gfloat *dest = group->interleaved_buffer;
   guint i, j;
+
   g_assert (group->nframes == nframes);
-  g_assert (group->interleaved_map.data);
+  g_assert (group->interleaved_buffer);
   g_assert (group->buffer);
-  for (i = 0; i < nframes; ++i)
-    for (j = 0; j < group->channels; ++j)
-      group->interleaved_map.data[(i * group->channels) + j]
-          = group->buffer[(j * nframes) + i];
+  for (j = 0; j < group->channels; ++j) {
+    const gfloat *src = group->buffer + j * nframes;
+
+    for (i = 0; i < nframes; ++i)
+      dest[(i * group->channels) + j] = src[i];
+  }
+}
+
+/* make room for blocks of @nframes frames in the de-interleave buffer */
+static void
+gst_signal_processor_group_alloc (GstSignalProcessorGroup * group,
+    guint channels, guint nframes)
+{
+  if (!group->buffer || group->channels != channels
+      || group->allocated < nframes) {
+    g_free (group->buffer);
+    group->buffer = g_new0 (gfloat, nframes * channels);
+    group->allocated = nframes;
+  }
+  group->channels = channels;
 }
 
 static gboolean
@@ -620,56 +706,97 @@ gst_signal_processor_event (GstPad * pad, GstObject * parent, GstEvent * event)
   return ret;
 }
 
+/* get an output buffer of @size bytes for @srcpad. The pool is grown when a
+ * bigger buffer is needed, smaller requests shrink the pooled buffer when it
+ * is handed out. */
+static GstBuffer *
+gst_signal_processor_alloc_output (GstSignalProcessor * self,
+    GstSignalProcessorPad * srcpad, gsize size)
+{
+  GstBuffer *buffer = NULL;
+
+  if (srcpad->pool && srcpad->pool_size < size) {
+    gst_buffer_pool_set_active (srcpad->pool, FALSE);
+    gst_object_unref (srcpad->pool);
+    srcpad->pool = NULL;
+  }
+
+  if (!srcpad->pool) {
+    GstStructure *config;
+
+    GST_DEBUG_OBJECT (srcpad, "creating pool for buffers of %" G_GSIZE_FORMAT
+        " bytes", size);
+
+    srcpad->pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (srcpad->pool);
+    gst_buffer_pool_config_set_params (config, NULL, size, 0, 0);
+    if (gst_buffer_pool_set_config (srcpad->pool, config)
+        && gst_buffer_pool_set_active (srcpad->pool, TRUE)) {
+      srcpad->pool_size = size;
+    } else {
+      GST_WARNING_OBJECT (srcpad, "failed to activate buffer pool");
+      gst_object_unref (srcpad->pool);
+      srcpad->pool = NULL;
+    }
+  }
+
+  if (!srcpad->pool || gst_buffer_pool_acquire_buffer (srcpad->pool, &buffer,
+          NULL) != GST_FLOW_OK)
+    buffer = gst_buffer_new_allocate (NULL, size, NULL);
+
+  return buffer;
+}
+
+static void
+gst_signal_processor_release_pools (GstSignalProcessor * self)
+{
+  GList *srcs;
+
+  for (srcs = GST_ELEMENT (self)->srcpads; srcs; srcs = srcs->next) {
+    GstSignalProcessorPad *srcpad = (GstSignalProcessorPad *) srcs->data;
+
+    if (srcpad->pool) {
+      gst_buffer_pool_set_active (srcpad->pool, FALSE);
+      gst_object_unref (srcpad->pool);
+      srcpad->pool = NULL;
+      srcpad->pool_size = 0;
+    }
+  }
+}
+
 /*
  * gst_signal_processor_prepare:
  * @self: the element
- * nframes: wanted sample frames
+ * @nframes: wanted sample frames
+ * @timestamp: location for the time stamp of the first sample frame
  *
- * Checks if wan
+ * Checks how many sample frames can be processed and assigns the output
+ * buffers for them, reusing the input buffers where possible.
  *
  * Returns: available sample frames
  */
 static guint
-gst_signal_processor_prepare (GstSignalProcessor * self, guint nframes)
+gst_signal_processor_prepare (GstSignalProcessor * self, guint nframes,
+    GstClockTime * timestamp)
 {
   GstElement *elem = (GstElement *) self;
   GstSignalProcessorClass *klass;
   GList *sinks, *srcs;
   guint samples_avail = nframes;
-  guint i, in_group_index = 0, out_group_index = 0;
   gboolean is_gap = FALSE;
   GstClockTime ts, tss = GST_CLOCK_TIME_NONE, tse = GST_CLOCK_TIME_NONE;
 
   klass = GST_SIGNAL_PROCESSOR_GET_CLASS (self);
 
-  /* first, assign audio_in pointers, and determine the number of samples that
-   * we can process */
-  i = 0;
-  for (sinks = elem->sinkpads; sinks; sinks = sinks->next, ++i) {
+  g_return_val_if_fail (GST_SIGNAL_PROCESSOR_IS_RUNNING (self), 0);
+
+  /* first, determine the number of samples that we can process */
+  for (sinks = elem->sinkpads; sinks; sinks = sinks->next) {
     GstSignalProcessorPad *sinkpad;
 
     sinkpad = (GstSignalProcessorPad *) sinks->data;
     g_assert (sinkpad->samples_avail > 0);
     samples_avail = MIN (samples_avail, sinkpad->samples_avail);
-    if (sinkpad->channels > 1) {
-      GstSignalProcessorGroup *group = &self->group_in[in_group_index++];
-      group->interleaved_map.data = sinkpad->map.data;
-      /* allocate buffer for de-interleaving */
-      if (!group->buffer || group->channels < sinkpad->channels
-          || group->nframes < samples_avail) {
-        group->buffer =
-            (gfloat *) g_realloc (group->buffer,
-            samples_avail * sinkpad->channels * sizeof (gfloat));
-        memset (group->buffer, '\0',
-            samples_avail * sinkpad->channels * sizeof (gfloat));
-      }
-      g_assert (group->buffer);
-      group->channels = sinkpad->channels;
-      group->nframes = samples_avail;
-      gst_signal_processor_deinterleave_group (group, samples_avail);
-    } else {
-      self->audio_in[sinkpad->index] = sinkpad->map;
-    }
   }
 
   GST_LOG_OBJECT (self, "want %u samples, have %u samples", nframes,
@@ -685,6 +812,9 @@ gst_signal_processor_prepare (GstSignalProcessor * self, guint nframes)
       is_gap &= GST_BUFFER_FLAG_IS_SET (sinkpad->pen, GST_BUFFER_FLAG_GAP);
       ts = GST_BUFFER_TIMESTAMP (sinkpad->pen);
       if (GST_CLOCK_TIME_IS_VALID (ts)) {
+        /* skip what was already processed from this buffer */
+        ts += gst_util_uint64_scale_int (sinkpad->offset, GST_SECOND,
+            self->sample_rate);
         tss = !GST_CLOCK_TIME_IS_VALID (tss) ? ts : MIN (tss, ts);
         tse = !GST_CLOCK_TIME_IS_VALID (tse) ? ts : MAX (tse, ts);
       }
@@ -697,78 +827,54 @@ gst_signal_processor_prepare (GstSignalProcessor * self, guint nframes)
     /* FIXME: calculate own timestamps */
     ts = GST_CLOCK_TIME_NONE;
   }
+  *timestamp = ts;
 
   /* now assign output buffers. we can avoid allocation by reusing input
-     buffers, but only if process() can work in place, and if the input buffer
-     is the exact size of the number of samples we are processing. */
-  sinks = elem->sinkpads;
-  srcs = elem->srcpads;
+     buffers that are writable and used up by this run. groups are copied to
+     the de-interleave buffer before processing, so they can always be
+     reused; single channel inputs are handed to process() directly and need
+     a plugin that can work in place. */
+  GST_LOG_OBJECT (self, "assigning %d buffers", g_list_length (elem->srcpads));
 
-  GST_LOG_OBJECT (self, "allocating %d buffers", g_list_length (srcs));
+  for (srcs = elem->srcpads; srcs; srcs = srcs->next) {
+    GstSignalProcessorPad *srcpad = (GstSignalProcessorPad *) srcs->data;
 
-  if (GST_SIGNAL_PROCESSOR_CLASS_CAN_PROCESS_IN_PLACE (klass)) {
-    while (sinks && srcs) {
-      GstSignalProcessorPad *sinkpad, *srcpad;
-
-      sinkpad = (GstSignalProcessorPad *) sinks->data;
-      srcpad = (GstSignalProcessorPad *) srcs->data;
+    for (sinks = elem->sinkpads; sinks; sinks = sinks->next) {
+      GstSignalProcessorPad *sinkpad = (GstSignalProcessorPad *) sinks->data;
 
-      if (sinkpad->channels == 1 && sinkpad->channels == srcpad->channels
-          && gst_buffer_get_size (sinkpad->pen) ==
-          samples_avail * sizeof (gfloat)) {
-        /* reusable, yay */
-        g_assert (sinkpad->samples_avail == samples_avail);
+      if (sinkpad->pen && sinkpad->channels == srcpad->channels
+          && (sinkpad->map.flags & GST_MAP_WRITE)
+          && sinkpad->samples_avail == samples_avail
+          && (sinkpad->channels > 1
+              || GST_SIGNAL_PROCESSOR_CLASS_CAN_PROCESS_IN_PLACE (klass))) {
+        /* reusable, yay. the input keeps reading through sinkpad->data
+           until update_inputs() */
         srcpad->pen = sinkpad->pen;
+        srcpad->map = sinkpad->map;
+        srcpad->data = sinkpad->data;
+        srcpad->offset = sinkpad->offset;
         sinkpad->pen = NULL;
-        self->audio_out[srcpad->index] = sinkpad->map;
-        self->pending_out++;
-
-        srcs = srcs->next;
+        GST_BUFFER_FLAG_UNSET (srcpad->pen, GST_BUFFER_FLAG_GAP);
+        break;
       }
-
-      sinks = sinks->next;
     }
-  }
-
-  g_return_val_if_fail (GST_SIGNAL_PROCESSOR_IS_RUNNING (self), 0);
-
-  /* now allocate for any remaining outputs */
-  while (srcs) {
-    GstSignalProcessorPad *srcpad;
 
-    srcpad = (GstSignalProcessorPad *) srcs->data;
-
-    srcpad->pen =
-        gst_buffer_new_allocate (NULL,
-        samples_avail * srcpad->channels * sizeof (gfloat), NULL);
-
-    if (srcpad->channels > 1) {
-      GstSignalProcessorGroup *group = &self->group_out[out_group_index++];
-      gst_buffer_map (srcpad->pen, &group->interleaved_map, GST_MAP_READWRITE);
-      if (!group->buffer || group->channels < srcpad->channels
-          || group->nframes < samples_avail)
-        group->buffer =
-            (gfloat *) g_realloc (group->buffer,
-            samples_avail * srcpad->channels * sizeof (gfloat));
-      group->channels = srcpad->channels;
-      group->nframes = samples_avail;
-      self->pending_out++;
-    } else {
-      gst_buffer_map (srcpad->pen, &self->audio_out[srcpad->index],
-          GST_MAP_READWRITE);
-      self->pending_out++;
+    if (!srcpad->pen) {
+      srcpad->pen = gst_signal_processor_alloc_output (self, srcpad,
+          samples_avail * srcpad->channels * sizeof (gfloat));
+      gst_buffer_map (srcpad->pen, &srcpad->map, GST_MAP_WRITE);
+      srcpad->data = (gfloat *) srcpad->map.data;
+      srcpad->offset = 0;
     }
+    srcpad->samples_avail = samples_avail;
+    self->pending_out++;
 
     /* set time stamp */
     GST_BUFFER_TIMESTAMP (srcpad->pen) = ts;
+    GST_BUFFER_DURATION (srcpad->pen) =
+        gst_util_uint64_scale_int (samples_avail, GST_SECOND,
+        self->sample_rate);
     /* FIXME: handle gap flag ? */
-
-    srcs = srcs->next;
-  }
-
-  /* update controlled parameters */
-  if (samples_avail && GST_CLOCK_TIME_IS_VALID (ts)) {
-    gst_object_sync_values ((GstObject *) self, ts);
   }
 
   return samples_avail;
@@ -788,56 +894,124 @@ gst_signal_processor_update_inputs (GstSignalProcessor * self, guint nprocessed)
 
     if (sinkpad->pen && sinkpad->samples_avail == nprocessed) {
       /* used up this buffer, unpen */
+      gst_buffer_unmap (sinkpad->pen, &sinkpad->map);
       gst_buffer_unref (sinkpad->pen);
       sinkpad->pen = NULL;
     }
 
     if (!sinkpad->pen) {
-      /* this buffer was used up */
+      /* this buffer was used up or taken for an output */
       self->pending_in++;
-      sinkpad->map.data = NULL;
+      sinkpad->data = NULL;
       sinkpad->samples_avail = 0;
+      sinkpad->offset = 0;
     } else {
-      /* advance ->data pointers and decrement ->samples_avail, unreffing buffer
-         if no samples are left */
+      /* advance ->data pointers and decrement ->samples_avail */
       sinkpad->samples_avail -= nprocessed;
-      sinkpad->map.data += nprocessed * sinkpad->channels;      /* gfloat* arithmetic */
+      sinkpad->offset += nprocessed;
+      sinkpad->data += nprocessed * sinkpad->channels;
     }
   }
 }
 
+/* hand the sample frames from @offset to @offset + @nframes of the prepared
+ * buffers to process() */
 static void
-gst_signal_processor_update_outputs (GstSignalProcessor * self,
-    guint nprocessed)
+gst_signal_processor_process_block (GstSignalProcessor * self, guint offset,
+    guint nframes, GstClockTime ts)
 {
-  GstSignalProcessorClass *klass = GST_SIGNAL_PROCESSOR_GET_CLASS (self);
-  guint i;
-  for (i = 0; i < klass->num_group_out; ++i)
-    gst_signal_processor_interleave_group (&self->group_out[i], nprocessed);
+  GstElement *elem = (GstElement *) self;
+  GstSignalProcessorClass *klass;
+  GList *pads;
+
+  klass = GST_SIGNAL_PROCESSOR_GET_CLASS (self);
+
+  for (pads = elem->sinkpads; pads; pads = pads->next) {
+    GstSignalProcessorPad *sinkpad = (GstSignalProcessorPad *) pads->data;
+    gfloat *data = sinkpad->data + offset * sinkpad->channels;
+
+    if (sinkpad->channels > 1) {
+      GstSignalProcessorGroup *group = &self->group_in[sinkpad->index];
+
+      group->interleaved_buffer = data;
+      group->nframes = nframes;
+      gst_signal_processor_deinterleave_group (group, nframes);
+    } else {
+      self->audio_in[sinkpad->index] = data;
+    }
+  }
+
+  for (pads = elem->srcpads; pads; pads = pads->next) {
+    GstSignalProcessorPad *srcpad = (GstSignalProcessorPad *) pads->data;
+    gfloat *data = srcpad->data + offset * srcpad->channels;
+
+    if (srcpad->channels > 1) {
+      GstSignalProcessorGroup *group = &self->group_out[srcpad->index];
+
+      group->interleaved_buffer = data;
+      group->nframes = nframes;
+    } else {
+      self->audio_out[srcpad->index] = data;
+    }
+  }
+
+  /* update controlled parameters */
+  if (GST_CLOCK_TIME_IS_VALID (ts)) {
+    gst_object_sync_values ((GstObject *) self, ts +
+        gst_util_uint64_scale_int (offset, GST_SECOND, self->sample_rate));
+  }
+
+  klass->process (self, nframes);
+
+  for (pads = elem->srcpads; pads; pads = pads->next) {
+    GstSignalProcessorPad *srcpad = (GstSignalProcessorPad *) pads->data;
+
+    if (srcpad->channels > 1)
+      gst_signal_processor_interleave_group (&self->group_out[srcpad->index],
+          nframes);
+  }
 }
 
 static gboolean
 gst_signal_processor_process (GstSignalProcessor * self, guint nframes)
 {
-  GstSignalProcessorClass *klass;
+  GstElement *elem = (GstElement *) self;
+  GstClockTime ts;
+  GList *pads;
+  guint block_size, offset;
 
   /* check if we have buffers enqueued */
   g_return_val_if_fail (self->pending_in == 0, FALSE);
   g_return_val_if_fail (self->pending_out == 0, FALSE);
 
   /* check how much input is available and prepare output buffers */
-  nframes = gst_signal_processor_prepare (self, nframes);
+  nframes = gst_signal_processor_prepare (self, nframes, &ts);
   if (G_UNLIKELY (nframes == 0))
     goto flow_error;
 
-  klass = GST_SIGNAL_PROCESSOR_GET_CLASS (self);
+  GST_OBJECT_LOCK (self);
+  block_size = self->block_size;
+  GST_OBJECT_UNLOCK (self);
+  if (block_size == 0 || block_size > nframes)
+    block_size = nframes;
 
-  GST_LOG_OBJECT (self, "process(%u)", nframes);
+  /* the de-interleave buffers only need to hold one block */
+  for (pads = elem->pads; pads; pads = pads->next) {
+    GstSignalProcessorPad *spad = (GstSignalProcessorPad *) pads->data;
 
-  klass->process (self, nframes);
+    if (spad->channels > 1)
+      gst_signal_processor_group_alloc (GST_PAD_IS_SINK (spad) ?
+          &self->group_in[spad->index] : &self->group_out[spad->index],
+          spad->channels, block_size);
+  }
+
+  GST_LOG_OBJECT (self, "process(%u) in blocks of %u", nframes, block_size);
+
+  for (offset = 0; offset < nframes; offset += block_size)
+    gst_signal_processor_process_block (self, offset,
+        MIN (block_size, nframes - offset), ts);
 
   gst_signal_processor_update_inputs (self, nframes);
-  gst_signal_processor_update_outputs (self, nframes);
 
   return TRUE;
 
@@ -859,9 +1033,15 @@ gst_signal_processor_pen_buffer (GstSignalProcessor * self, GstPad * pad,
   if (spad->pen)
     goto had_buffer;
 
-  /* keep the reference */
+  /* keep the reference, writable buffers can be reused for the output */
+  if (!gst_buffer_is_writable (buffer)
+      || !gst_buffer_map (buffer, &spad->map, GST_MAP_READWRITE)) {
+    if (!gst_buffer_map (buffer, &spad->map, GST_MAP_READ))
+      goto map_failed;
+  }
   spad->pen = buffer;
-  gst_buffer_map (buffer, &spad->map, GST_MAP_READWRITE);
+  spad->data = (gfloat *) spad->map.data;
+  spad->offset = 0;
   spad->samples_avail = spad->map.size / sizeof (float) / spad->channels;
 
   g_assert (self->pending_in != 0);
@@ -878,6 +1058,35 @@ had_buffer:
     gst_buffer_unref (buffer);
     return;
   }
+map_failed:
+  {
+    GST_ELEMENT_ERROR (self, RESOURCE, READ, (NULL),
+        ("Failed to map buffer on pad %s:%s", GST_DEBUG_PAD_NAME (pad)));
+    gst_buffer_unref (buffer);
+    self->flow_state = GST_FLOW_ERROR;
+    return;
+  }
+}
+
+/* take the processed buffer out of the pen of @srcpad */
+static GstBuffer *
+gst_signal_processor_unpen_output (GstSignalProcessorPad * srcpad)
+{
+  GstBuffer *buffer = srcpad->pen;
+
+  gst_buffer_unmap (buffer, &srcpad->map);
+  /* reused inputs can start after frames processed earlier and pooled
+   * buffers can be bigger than needed */
+  gst_buffer_resize (buffer,
+      srcpad->offset * srcpad->channels * sizeof (gfloat),
+      srcpad->samples_avail * srcpad->channels * sizeof (gfloat));
+
+  srcpad->pen = NULL;
+  srcpad->data = NULL;
+  srcpad->samples_avail = 0;
+  srcpad->offset = 0;
+
+  return buffer;
 }
 
 static void
@@ -898,13 +1107,15 @@ gst_signal_processor_flush (GstSignalProcessor * self)
       gst_buffer_unmap (spad->pen, &spad->map);
       gst_buffer_unref (spad->pen);
       spad->pen = NULL;
-      spad->samples_avail = 0;
     }
+    spad->data = NULL;
+    spad->samples_avail = 0;
+    spad->offset = 0;
   }
 
   /* no outputs prepared and inputs for each pad needed */
   self->pending_out = 0;
-  self->pending_in = klass->num_audio_in;
+  self->pending_in = klass->num_group_in + klass->num_audio_in;
 }
 
 static void
@@ -964,8 +1175,7 @@ gst_signal_processor_getrange (GstPad * pad, GstObject * parent, guint64 offset,
   self = GST_SIGNAL_PROCESSOR (parent);
 
   if (spad->pen) {
-    *buffer = spad->pen;
-    spad->pen = NULL;
+    *buffer = gst_signal_processor_unpen_output (spad);
     g_assert (self->pending_out != 0);
     self->pending_out--;
     ret = GST_FLOW_OK;
@@ -976,8 +1186,7 @@ gst_signal_processor_getrange (GstPad * pad, GstObject * parent, guint64 offset,
       *buffer = NULL;
       ret = self->flow_state;
     } else {
-      *buffer = spad->pen;
-      spad->pen = NULL;
+      *buffer = gst_signal_processor_unpen_output (spad);
       self->pending_out--;
       ret = GST_FLOW_OK;
     }
@@ -1009,8 +1218,7 @@ gst_signal_processor_do_pushes (GstSignalProcessor * self)
     }
 
     /* take buffer from pen */
-    buffer = spad->pen;
-    spad->pen = NULL;
+    buffer = gst_signal_processor_unpen_output (spad);
 
     ret = gst_pad_push (GST_PAD (spad), buffer);
 
@@ -1181,6 +1389,7 @@ gst_signal_processor_change_state (GstElement * element,
       if (GST_SIGNAL_PROCESSOR_IS_RUNNING (self))
         gst_signal_processor_stop (self);
       gst_signal_processor_flush (self);
+      gst_signal_processor_release_pools (self);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
       if (GST_SIGNAL_PROCESSOR_IS_INITIALIZED (self))
@@ -70,8 +70,9 @@ typedef struct _GstSignalProcessorClass GstSignalProcessorClass;
 
 struct _GstSignalProcessorGroup {
   guint channels; /**< Number of channels in buffers */
-  guint nframes; /**< Number of frames currently allocated per channel */
-  GstMapInfo interleaved_map; /**< Interleaved buffer (c1c2c1c2...)*/
+  guint nframes; /**< Number of frames per channel in the current block */
+  guint allocated; /**< Number of frames allocated per channel */
+  gfloat *interleaved_buffer; /**< Interleaved buffer (c1c2c1c2...)*/
   gfloat *buffer; /**< De-interleaved buffer (c1c1...c2c2...) */
 };
 
@@ -94,12 +95,15 @@ struct _GstSignalProcessor {
   GstSignalProcessorGroup *group_out;
 
   /* single channel signal pads */
-  GstMapInfo *audio_in;
-  GstMapInfo *audio_out;
+  gfloat **audio_in;
+  gfloat **audio_out;
 
   /* sampling rate */
   gint sample_rate;
 
+  /* maximum number of frames per process() call, 0 for no limit */
+  guint block_size;
+
 };
 
 struct _GstSignalProcessorClass {
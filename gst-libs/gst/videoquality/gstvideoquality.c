@@ -0,0 +1,889 @@
+/* GStreamer
+ *
+ * gstvideoquality.c: full-reference video quality metrics
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:gstvideoquality
+ * @short_description: PSNR, SSIM and MS-SSIM of 8 bit planes
+ *
+ * Computes full-reference quality metrics between the planes of a
+ * reference and a distorted frame.
+ *
+ * SSIM uses the 11x11 Gaussian windows with a standard deviation of 1.5
+ * of Wang, Bovik, Sheikh and Simoncelli. As in their reference
+ * implementation there is a window around every sample whose window lies
+ * completely inside the plane, planes that are smaller than a window are
+ * measured with windows clipped to the plane instead. The weighted window
+ * sums are computed separably, in parallel line bands of all planes of a
+ * frame at once on the default #GstBandPool.
+ *
+ * MS-SSIM repeats the SSIM measurement on up to four 2x2 box filtered
+ * versions of the planes and combines the contrast-structure terms of
+ * all scales with the luminance term of the last one, using the weights
+ * of Wang, Simoncelli and Bovik. A plane is not scaled down any further
+ * once it would get smaller than a window.
+ *
+ * gst_video_quality_ssim_map() computes the SSIM of a window around every
+ * sample instead, with flat or Gaussian windows, and stores it in a map.
+ * The window sums are computed separably, the flat windows slide their
+ * column sums from line to line and use prefix sums along the line so
+ * that the cost does not depend on the window size. Windows at the edges
+ * are clipped and normalised by the weights that are left.
+ *
+ * A #GstVideoQuality must not be used from several threads at the same
+ * time.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstvideoquality.h"
+#include <gst/bandpool/gstbandpool.h>
+
+#include <string.h>
+#include <math.h>
+
+/* the SSIM window of Wang et al. */
+#define SSIM_WINDOW 11
+#define SSIM_SIGMA 1.5
+
+#define MS_SSIM_SCALES 5
+
+#define DEFAULT_MAP_WINDOW GST_VIDEO_QUALITY_WINDOW_GAUSSIAN
+#define DEFAULT_MAP_SIZE 11
+#define DEFAULT_MAP_SIGMA 1.5
+
+/* don't split a plane into bands of fewer lines than this */
+#define MIN_BAND_HEIGHT 32
+
+static const gdouble ms_ssim_weights[MS_SSIM_SCALES] = {
+  0.0448, 0.2856, 0.3001, 0.2363, 0.1333
+};
+
+/* SSIM constants for 8 bit samples */
+#define SSIM_C1 ((0.01 * 255) * (0.01 * 255))
+#define SSIM_C2 ((0.03 * 255) * (0.03 * 255))
+
+struct _GstVideoQuality
+{
+  guint n_threads;
+  gdouble ssim_kernel[SSIM_WINDOW];
+
+  GstVideoQualityWindow map_window;
+  guint map_size;
+  gdouble *map_kernel;
+  gboolean fixed_mean;
+};
+
+/* one line band of the squared error of a plane */
+typedef struct
+{
+  const GstVideoQualityPlane *ref, *dist;
+  gint y_start, y_end;
+
+  guint64 sse;
+} GstVideoQualitySseBand;
+
+/* the windows around the samples of one line band of a plane, for an SSIM
+ * map or the mean SSIM */
+typedef struct
+{
+  const GstVideoQualityPlane *ref, *dist;
+  GstVideoQualityWindow window;
+  const gdouble *kernel;
+  gint size;
+  gboolean fixed_mean;
+  guint8 *map;
+  gint map_stride;
+  gint x_start, x_end, y_start, y_end;
+
+  gdouble sum, cs_sum, lowest, highest;
+} GstVideoQualityMapBand;
+
+/* the weights are separable, w (x, y) = kernel[x] * kernel[y]. They are
+ * not scaled as every window is normalised by the sum of its weights */
+static void
+gst_video_quality_fill_kernel (gdouble * kernel, GstVideoQualityWindow window,
+    guint size, gdouble sigma)
+{
+  guint i;
+
+  for (i = 0; i < size; i++) {
+    gint coord = (gint) i - (gint) (size / 2) + (gint) (1 - size % 2);
+
+    if (window == GST_VIDEO_QUALITY_WINDOW_FLAT)
+      kernel[i] = 1;
+    else
+      kernel[i] = exp (-(coord * coord) / (2 * sigma * sigma));
+  }
+}
+
+static void
+gst_video_quality_sse_band (gpointer data, gpointer user_data)
+{
+  GstVideoQualitySseBand *band = data;
+  const GstVideoQualityPlane *ref = band->ref, *dist = band->dist;
+  guint64 sse = 0;
+  gint x, y;
+
+  for (y = band->y_start; y < band->y_end; y++) {
+    const guint8 *r = ref->data + y * ref->stride;
+    const guint8 *d = dist->data + y * dist->stride;
+
+    for (x = 0; x < ref->width; x++) {
+      gint diff = (gint) r[x * ref->pstride] - (gint) d[x * dist->pstride];
+
+      sse += diff * diff;
+    }
+  }
+
+  band->sse = sse;
+}
+
+/* Sums up the squared errors of all planes in one run of the band pool */
+static void
+gst_video_quality_sse (GstVideoQuality * quality,
+    const GstVideoQualityPlane * ref, const GstVideoQualityPlane * dist,
+    guint n_planes, guint64 * sse)
+{
+  GstVideoQualitySseBand *bands;
+  guint *first;
+  guint n_bands = 0, i, b;
+
+  first = g_new (guint, n_planes + 1);
+  for (i = 0; i < n_planes; i++) {
+    first[i] = n_bands;
+    n_bands += gst_band_pool_get_n_bands (quality->n_threads,
+        MAX (ref[i].height, 0), MIN_BAND_HEIGHT);
+  }
+  first[n_planes] = n_bands;
+
+  bands = g_new (GstVideoQualitySseBand, MAX (n_bands, 1));
+  for (i = 0; i < n_planes; i++) {
+    guint n = first[i + 1] - first[i];
+
+    for (b = 0; b < n; b++) {
+      GstVideoQualitySseBand *band = &bands[first[i] + b];
+
+      band->ref = &ref[i];
+      band->dist = &dist[i];
+      band->y_start = ref[i].height * b / n;
+      band->y_end = ref[i].height * (b + 1) / n;
+    }
+  }
+
+  if (n_bands > 0)
+    gst_band_pool_run (gst_band_pool_get_default (),
+        gst_video_quality_sse_band, NULL, bands,
+        sizeof (GstVideoQualitySseBand), n_bands);
+
+  for (i = 0; i < n_planes; i++) {
+    sse[i] = 0;
+    for (b = first[i]; b < first[i + 1]; b++)
+      sse[i] += bands[b].sse;
+  }
+
+  g_free (bands);
+  g_free (first);
+}
+
+/* SSIM and contrast-structure term of one window from its (weighted) sums,
+ * w is the sum of the weights inside the plane */
+static inline gdouble
+gst_video_quality_window_ssim (gboolean fixed_mean, gdouble w, gdouble sr,
+    gdouble sd, gdouble srr, gdouble sdd, gdouble srd, gdouble * cs)
+{
+  gdouble mean_r, mean_d, var_r, var_d, cov;
+
+  if (fixed_mean) {
+    mean_r = mean_d = 128;
+  } else {
+    mean_r = sr / w;
+    mean_d = sd / w;
+  }
+
+  /* sum (w * (r - mean_r)^2) / w expanded */
+  var_r = MAX ((srr - 2 * mean_r * sr + mean_r * mean_r * w) / w, 0);
+  var_d = MAX ((sdd - 2 * mean_d * sd + mean_d * mean_d * w) / w, 0);
+  cov = (srd - mean_r * sd - mean_d * sr + mean_r * mean_d * w) / w;
+
+  *cs = (2 * cov + SSIM_C2) / (var_r + var_d + SSIM_C2);
+
+  return (2 * mean_r * mean_d + SSIM_C1) /
+      (mean_r * mean_r + mean_d * mean_d + SSIM_C1) * *cs;
+}
+
+static inline void
+gst_video_quality_map_store (GstVideoQualityMapBand * band, gint x, gint y,
+    gdouble index, gdouble cs)
+{
+  /* SSIM can go negative, that's why it is 127 + index * 128 instead of
+   * index * 255 */
+  if (band->map)
+    band->map[y * band->map_stride + x] =
+        (guint8) CLAMP (127 + index * 128, 0, 255);
+
+  band->sum += index;
+  band->cs_sum += cs;
+  band->lowest = MIN (band->lowest, index);
+  band->highest = MAX (band->highest, index);
+}
+
+/* first and last sample of the window of @size around @p, clipped to @n
+ * samples, and the kernel index of the first one */
+static inline void
+gst_video_quality_map_bounds (gint size, gint p, gint n, gint * start,
+    gint * end, gint * kernel_start)
+{
+  gint half = size / 2;
+  gint even = 1 - size % 2;
+
+  *start = p - half + even;
+  *kernel_start = 0;
+  if (*start < 0) {
+    *kernel_start = -*start;
+    *start = 0;
+  }
+  *end = MIN (p + half, n - 1);
+}
+
+/* the samples of @n whose windows of @size lie completely inside them, or
+ * all of them if there are fewer than @size */
+static void
+gst_video_quality_valid_range (gint size, gint n, gint * start, gint * end)
+{
+  if (n < size) {
+    *start = 0;
+    *end = MAX (n, 0);
+  } else {
+    *start = size / 2 - (1 - size % 2);
+    *end = n - size / 2;
+  }
+}
+
+static void
+gst_video_quality_map_add_line (guint32 * col, const guint8 * r,
+    const guint8 * d, gint width, gint pstride_r, gint pstride_d, gint sign)
+{
+  guint32 *col_r = col, *col_d = col + width, *col_rr = col + 2 * width;
+  guint32 *col_dd = col + 3 * width, *col_rd = col + 4 * width;
+  gint x;
+
+  for (x = 0; x < width; x++) {
+    guint32 vr = r[x * pstride_r], vd = d[x * pstride_d];
+
+    /* unsigned wrap around makes the subtraction exact */
+    col_r[x] += sign * vr;
+    col_d[x] += sign * vd;
+    col_rr[x] += sign * vr * vr;
+    col_dd[x] += sign * vd * vd;
+    col_rd[x] += sign * vr * vd;
+  }
+}
+
+static void
+gst_video_quality_map_band_flat (GstVideoQualityMapBand * band)
+{
+  const GstVideoQualityPlane *ref = band->ref, *dist = band->dist;
+  gint width = ref->width, height = ref->height;
+  guint32 *col = g_new0 (guint32, width * 5);
+  guint64 *sum = g_new (guint64, (width + 1) * 5);
+  gint stride = width + 1;
+  gint x, y, i, cur_y0, cur_y1, y0, y1, x0, x1, k;
+  gdouble cs;
+
+  gst_video_quality_map_bounds (band->size, band->y_start, height, &cur_y0,
+      &y1, &k);
+  cur_y1 = cur_y0 - 1;
+
+  for (y = band->y_start; y < band->y_end; y++) {
+    gst_video_quality_map_bounds (band->size, y, height, &y0, &y1, &k);
+
+    /* slide the column sums down to the window of this line */
+    while (cur_y1 < y1) {
+      cur_y1++;
+      gst_video_quality_map_add_line (col, ref->data + cur_y1 * ref->stride,
+          dist->data + cur_y1 * dist->stride, width, ref->pstride,
+          dist->pstride, 1);
+    }
+    while (cur_y0 < y0) {
+      gst_video_quality_map_add_line (col, ref->data + cur_y0 * ref->stride,
+          dist->data + cur_y0 * dist->stride, width, ref->pstride,
+          dist->pstride, -1);
+      cur_y0++;
+    }
+
+    /* prefix sums along the line */
+    for (i = 0; i < 5; i++) {
+      const guint32 *c = col + i * width;
+      guint64 *p = sum + i * stride;
+
+      p[0] = 0;
+      for (x = 0; x < width; x++)
+        p[x + 1] = p[x] + c[x];
+    }
+
+    for (x = band->x_start; x < band->x_end; x++) {
+      gdouble index;
+
+      gst_video_quality_map_bounds (band->size, x, width, &x0, &x1, &k);
+      x1++;
+
+      index = gst_video_quality_window_ssim (band->fixed_mean,
+          (gdouble) (y1 - y0 + 1) * (x1 - x0), sum[x1] - sum[x0],
+          sum[stride + x1] - sum[stride + x0],
+          sum[2 * stride + x1] - sum[2 * stride + x0],
+          sum[3 * stride + x1] - sum[3 * stride + x0],
+          sum[4 * stride + x1] - sum[4 * stride + x0], &cs);
+      gst_video_quality_map_store (band, x, y, index, cs);
+    }
+  }
+
+  g_free (sum);
+  g_free (col);
+}
+
+static void
+gst_video_quality_map_band_gaussian (GstVideoQualityMapBand * band)
+{
+  const GstVideoQualityPlane *ref = band->ref, *dist = band->dist;
+  gint width = ref->width, height = ref->height;
+  /* the sums are accumulated in double, r*r and mean_r * mean_r cancel
+   * out on flat regions and float would leave noise in the variance */
+  gdouble *col = g_new (gdouble, width * 5);
+  gdouble *col_r = col, *col_d = col + width, *col_rr = col + 2 * width;
+  gdouble *col_dd = col + 3 * width, *col_rd = col + 4 * width;
+  gint x, y, ix, iy, x0, x1, y0, y1, kx, ky, c0, c1;
+
+  /* the columns the windows of this band reach */
+  gst_video_quality_map_bounds (band->size, band->x_start, width, &c0, &x1,
+      &kx);
+  gst_video_quality_map_bounds (band->size, band->x_end - 1, width, &x0, &c1,
+      &kx);
+
+  for (y = band->y_start; y < band->y_end; y++) {
+    const gdouble *kernel_y;
+    gdouble wy = 0;
+    gint n_y;
+
+    gst_video_quality_map_bounds (band->size, y, height, &y0, &y1, &ky);
+    kernel_y = band->kernel + ky;
+    n_y = y1 - y0 + 1;
+    for (iy = 0; iy < n_y; iy++)
+      wy += kernel_y[iy];
+
+    /* weighted column sums over the window lines, kept in registers while
+     * going down a column instead of adding every line to all columns */
+    for (x = c0; x <= c1; x++) {
+      const guint8 *r = ref->data + y0 * ref->stride + x * ref->pstride;
+      const guint8 *d = dist->data + y0 * dist->stride + x * dist->pstride;
+      gdouble sr = 0, sd = 0, srr = 0, sdd = 0, srd = 0;
+
+      for (iy = 0; iy < n_y; iy++) {
+        gdouble vr = r[iy * ref->stride], vd = d[iy * dist->stride];
+        gdouble hr = kernel_y[iy] * vr, hd = kernel_y[iy] * vd;
+
+        sr += hr;
+        sd += hd;
+        srr += hr * vr;
+        sdd += hd * vd;
+        srd += hr * vd;
+      }
+
+      col_r[x] = sr;
+      col_d[x] = sd;
+      col_rr[x] = srr;
+      col_dd[x] = sdd;
+      col_rd[x] = srd;
+    }
+
+    /* and over the window columns */
+    for (x = band->x_start; x < band->x_end; x++) {
+      gdouble wx = 0, sr = 0, sd = 0, srr = 0, sdd = 0, srd = 0;
+      gdouble index, cs;
+
+      gst_video_quality_map_bounds (band->size, x, width, &x0, &x1, &kx);
+      for (ix = x0; ix <= x1; ix++) {
+        gdouble h = band->kernel[kx + ix - x0];
+
+        wx += h;
+        sr += h * col_r[ix];
+        sd += h * col_d[ix];
+        srr += h * col_rr[ix];
+        sdd += h * col_dd[ix];
+        srd += h * col_rd[ix];
+      }
+
+      index = gst_video_quality_window_ssim (band->fixed_mean, wx * wy, sr,
+          sd, srr, sdd, srd, &cs);
+      gst_video_quality_map_store (band, x, y, index, cs);
+    }
+  }
+
+  g_free (col);
+}
+
+static void
+gst_video_quality_map_band (gpointer data, gpointer user_data)
+{
+  GstVideoQualityMapBand *band = data;
+
+  band->sum = 0;
+  band->cs_sum = 0;
+  band->lowest = G_MAXDOUBLE;
+  band->highest = -G_MAXDOUBLE;
+
+  if (band->x_start >= band->x_end)
+    return;
+
+  if (band->window == GST_VIDEO_QUALITY_WINDOW_FLAT)
+    gst_video_quality_map_band_flat (band);
+  else
+    gst_video_quality_map_band_gaussian (band);
+}
+
+/* Mean SSIM and mean contrast-structure term over the windows of all
+ * planes that are @active, in one run of the band pool */
+static void
+gst_video_quality_mean_ssim (GstVideoQuality * quality,
+    const GstVideoQualityPlane * ref, const GstVideoQualityPlane * dist,
+    guint n_planes, const gboolean * active, gdouble * ssim, gdouble * cs)
+{
+  GstVideoQualityMapBand *bands;
+  guint *first;
+  guint n_bands = 0, i, b;
+
+  first = g_new (guint, n_planes + 1);
+  for (i = 0; i < n_planes; i++) {
+    first[i] = n_bands;
+    if (active == NULL || active[i])
+      n_bands += gst_band_pool_get_n_bands (quality->n_threads,
+          MAX (ref[i].height, 0), MIN_BAND_HEIGHT);
+  }
+  first[n_planes] = n_bands;
+
+  bands = g_new (GstVideoQualityMapBand, MAX (n_bands, 1));
+  for (i = 0; i < n_planes; i++) {
+    guint n = first[i + 1] - first[i];
+    gint x_start, x_end, y_start, y_end;
+
+    gst_video_quality_valid_range (SSIM_WINDOW, ref[i].width, &x_start,
+        &x_end);
+    gst_video_quality_valid_range (SSIM_WINDOW, ref[i].height, &y_start,
+        &y_end);
+
+    for (b = 0; b < n; b++) {
+      GstVideoQualityMapBand *band = &bands[first[i] + b];
+
+      band->ref = &ref[i];
+      band->dist = &dist[i];
+      band->window = GST_VIDEO_QUALITY_WINDOW_GAUSSIAN;
+      band->kernel = quality->ssim_kernel;
+      band->size = SSIM_WINDOW;
+      band->fixed_mean = FALSE;
+      band->map = NULL;
+      band->map_stride = 0;
+      band->x_start = x_start;
+      band->x_end = x_end;
+      band->y_start = y_start + (y_end - y_start) * b / n;
+      band->y_end = y_start + (y_end - y_start) * (b + 1) / n;
+    }
+  }
+
+  if (n_bands > 0)
+    gst_band_pool_run (gst_band_pool_get_default (),
+        gst_video_quality_map_band, NULL, bands,
+        sizeof (GstVideoQualityMapBand), n_bands);
+
+  for (i = 0; i < n_planes; i++) {
+    gdouble ssim_sum = 0, cs_sum = 0, n_windows = 0;
+
+    if (first[i] == first[i + 1])
+      continue;
+
+    for (b = first[i]; b < first[i + 1]; b++) {
+      ssim_sum += bands[b].sum;
+      cs_sum += bands[b].cs_sum;
+      n_windows += (gdouble) (bands[b].x_end - bands[b].x_start) *
+          (bands[b].y_end - bands[b].y_start);
+    }
+
+    /* an empty plane has no windows and nothing that differs */
+    if (n_windows > 0) {
+      ssim[i] = ssim_sum / n_windows;
+      cs[i] = cs_sum / n_windows;
+    } else {
+      ssim[i] = cs[i] = 1;
+    }
+  }
+
+  g_free (bands);
+  g_free (first);
+}
+
+/* 2x2 box filter into a new tightly packed plane */
+static guint8 *
+gst_video_quality_downscale (const GstVideoQualityPlane * in,
+    GstVideoQualityPlane * out)
+{
+  guint8 *data;
+  gint x, y;
+
+  out->width = in->width / 2;
+  out->height = in->height / 2;
+  out->pstride = 1;
+  out->stride = out->width;
+
+  data = g_malloc (out->width * out->height);
+  for (y = 0; y < out->height; y++) {
+    const guint8 *l0 = in->data + 2 * y * in->stride;
+    const guint8 *l1 = l0 + in->stride;
+    guint8 *o = data + y * out->stride;
+
+    for (x = 0; x < out->width; x++) {
+      gint p0 = 2 * x * in->pstride, p1 = p0 + in->pstride;
+
+      o[x] = (l0[p0] + l0[p1] + l1[p0] + l1[p1] + 2) >> 2;
+    }
+  }
+  out->data = data;
+
+  return data;
+}
+
+/* @ssim and @cs are the results of the first scale */
+static void
+gst_video_quality_ms_ssim (GstVideoQuality * quality,
+    const GstVideoQualityPlane * ref, const GstVideoQualityPlane * dist,
+    guint n_planes, const gdouble * ssim, const gdouble * cs,
+    GstVideoQualityResult * results)
+{
+  GstVideoQualityPlane *scaled_ref, *scaled_dist;
+  gdouble (*scale_cs)[MS_SSIM_SCALES];
+  gdouble *last_ssim, *scale_ssim, *scale_cs_tmp;
+  gboolean *active;
+  guint *n_scales;
+  GSList *buffers = NULL;
+  guint scale, i;
+
+  scaled_ref = g_new (GstVideoQualityPlane, n_planes);
+  scaled_dist = g_new (GstVideoQualityPlane, n_planes);
+  scale_cs = g_malloc0_n (n_planes, sizeof (*scale_cs));
+  last_ssim = g_new (gdouble, n_planes);
+  scale_ssim = g_new (gdouble, n_planes);
+  scale_cs_tmp = g_new (gdouble, n_planes);
+  active = g_new (gboolean, n_planes);
+  n_scales = g_new (guint, n_planes);
+
+  for (i = 0; i < n_planes; i++) {
+    scaled_ref[i] = ref[i];
+    scaled_dist[i] = dist[i];
+    last_ssim[i] = ssim[i];
+    scale_cs[i][0] = cs[i];
+    n_scales[i] = 1;
+  }
+
+  for (scale = 1; scale < MS_SSIM_SCALES; scale++) {
+    guint n_active = 0;
+
+    for (i = 0; i < n_planes; i++) {
+      GstVideoQualityPlane prev_ref = scaled_ref[i];
+      GstVideoQualityPlane prev_dist = scaled_dist[i];
+
+      /* stop once the plane gets smaller than a window */
+      active[i] = n_scales[i] == scale
+          && prev_ref.width / 2 >= SSIM_WINDOW
+          && prev_ref.height / 2 >= SSIM_WINDOW;
+      if (!active[i])
+        continue;
+
+      buffers = g_slist_prepend (buffers,
+          gst_video_quality_downscale (&prev_ref, &scaled_ref[i]));
+      buffers = g_slist_prepend (buffers,
+          gst_video_quality_downscale (&prev_dist, &scaled_dist[i]));
+      n_active++;
+    }
+
+    if (n_active == 0)
+      break;
+
+    gst_video_quality_mean_ssim (quality, scaled_ref, scaled_dist, n_planes,
+        active, scale_ssim, scale_cs_tmp);
+
+    for (i = 0; i < n_planes; i++) {
+      if (!active[i])
+        continue;
+
+      last_ssim[i] = scale_ssim[i];
+      scale_cs[i][scale] = scale_cs_tmp[i];
+      n_scales[i]++;
+    }
+  }
+
+  for (i = 0; i < n_planes; i++) {
+    gdouble weight_sum = 0, ms_ssim = 1;
+    guint j;
+
+    /* renormalise the exponents if the plane was too small for all
+     * scales */
+    for (j = 0; j < n_scales[i]; j++)
+      weight_sum += ms_ssim_weights[j];
+
+    for (j = 0; j + 1 < n_scales[i]; j++)
+      ms_ssim *= pow (MAX (scale_cs[i][j], 0),
+          ms_ssim_weights[j] / weight_sum);
+    ms_ssim *= pow (MAX (last_ssim[i], 0), ms_ssim_weights[j] / weight_sum);
+
+    results[i].ms_ssim = ms_ssim;
+  }
+
+  g_slist_foreach (buffers, (GFunc) g_free, NULL);
+  g_slist_free (buffers);
+  g_free (n_scales);
+  g_free (active);
+  g_free (scale_cs_tmp);
+  g_free (scale_ssim);
+  g_free (last_ssim);
+  g_free (scale_cs);
+  g_free (scaled_dist);
+  g_free (scaled_ref);
+}
+
+/**
+ * gst_video_quality_new:
+ * @n_threads: number of threads to spread the measurement over, 0 for the
+ *     number of processors
+ *
+ * Returns: a new #GstVideoQuality, free with gst_video_quality_free()
+ */
+GstVideoQuality *
+gst_video_quality_new (guint n_threads)
+{
+  GstVideoQuality *quality = g_slice_new0 (GstVideoQuality);
+
+  if (n_threads == 0)
+    n_threads = gst_band_pool_get_n_cpus ();
+
+  quality->n_threads = n_threads;
+  gst_video_quality_fill_kernel (quality->ssim_kernel,
+      GST_VIDEO_QUALITY_WINDOW_GAUSSIAN, SSIM_WINDOW, SSIM_SIGMA);
+  gst_video_quality_set_ssim_map_window (quality, DEFAULT_MAP_WINDOW,
+      DEFAULT_MAP_SIZE, DEFAULT_MAP_SIGMA);
+
+  return quality;
+}
+
+/**
+ * gst_video_quality_free:
+ * @quality: a #GstVideoQuality
+ *
+ * Frees @quality.
+ */
+void
+gst_video_quality_free (GstVideoQuality * quality)
+{
+  g_return_if_fail (quality != NULL);
+
+  g_free (quality->map_kernel);
+
+  g_slice_free (GstVideoQuality, quality);
+}
+
+/**
+ * gst_video_quality_measure:
+ * @quality: a #GstVideoQuality
+ * @metrics: the metrics to compute
+ * @ref: @n_planes reference planes
+ * @dist: @n_planes distorted planes, of the same sizes as @ref
+ * @n_planes: the number of planes
+ * @results: @n_planes results, one per plane
+ *
+ * Measures all planes of a frame. The planes are processed together so
+ * that the threads are kept busy even when the chroma planes are small.
+ */
+void
+gst_video_quality_measure (GstVideoQuality * quality,
+    GstVideoQualityMetrics metrics, const GstVideoQualityPlane * ref,
+    const GstVideoQualityPlane * dist, guint n_planes,
+    GstVideoQualityResult * results)
+{
+  guint i;
+
+  g_return_if_fail (quality != NULL);
+  g_return_if_fail (ref != NULL && dist != NULL && results != NULL);
+
+  for (i = 0; i < n_planes; i++) {
+    g_return_if_fail (ref[i].width == dist[i].width
+        && ref[i].height == dist[i].height);
+  }
+
+  if (metrics & GST_VIDEO_QUALITY_METRIC_PSNR) {
+    guint64 *sse = g_new (guint64, n_planes);
+
+    gst_video_quality_sse (quality, ref, dist, n_planes, sse);
+    for (i = 0; i < n_planes; i++) {
+      gdouble n = (gdouble) MAX (ref[i].width, 0) * MAX (ref[i].height, 0);
+
+      results[i].mse = n > 0 ? sse[i] / n : 0;
+      results[i].psnr = results[i].mse > 0 ?
+          10 * log10 (255 * 255 / results[i].mse) : HUGE_VAL;
+    }
+    g_free (sse);
+  }
+
+  if (metrics & (GST_VIDEO_QUALITY_METRIC_SSIM |
+          GST_VIDEO_QUALITY_METRIC_MS_SSIM)) {
+    gdouble *ssim = g_new (gdouble, n_planes);
+    gdouble *cs = g_new (gdouble, n_planes);
+
+    gst_video_quality_mean_ssim (quality, ref, dist, n_planes, NULL, ssim,
+        cs);
+
+    if (metrics & GST_VIDEO_QUALITY_METRIC_SSIM) {
+      for (i = 0; i < n_planes; i++)
+        results[i].ssim = ssim[i];
+    }
+    if (metrics & GST_VIDEO_QUALITY_METRIC_MS_SSIM)
+      gst_video_quality_ms_ssim (quality, ref, dist, n_planes, ssim, cs,
+          results);
+
+    g_free (cs);
+    g_free (ssim);
+  }
+}
+
+/**
+ * gst_video_quality_set_ssim_map_window:
+ * @quality: a #GstVideoQuality
+ * @window: the window weighting
+ * @size: width and height of the windows
+ * @sigma: standard deviation of the Gaussian weights
+ *
+ * Sets the windows of gst_video_quality_ssim_map(). The default is an
+ * 11x11 Gaussian window with a standard deviation of 1.5.
+ */
+void
+gst_video_quality_set_ssim_map_window (GstVideoQuality * quality,
+    GstVideoQualityWindow window, guint size, gdouble sigma)
+{
+  g_return_if_fail (quality != NULL);
+  g_return_if_fail (size > 0 && size <= 255);
+  g_return_if_fail (window == GST_VIDEO_QUALITY_WINDOW_FLAT || sigma > 0);
+
+  quality->map_window = window;
+  quality->map_size = size;
+
+  g_free (quality->map_kernel);
+  quality->map_kernel = g_new (gdouble, size);
+  gst_video_quality_fill_kernel (quality->map_kernel, window, size, sigma);
+}
+
+/**
+ * gst_video_quality_set_ssim_map_fixed_mean:
+ * @quality: a #GstVideoQuality
+ * @fixed_mean: whether to fix the window means at 128
+ *
+ * With @fixed_mean the means of the windows of gst_video_quality_ssim_map()
+ * are not measured but fixed at 128, which makes the luminance term 1 and
+ * measures the deviation from mid grey instead of the variance. Defaults to
+ * %FALSE.
+ */
+void
+gst_video_quality_set_ssim_map_fixed_mean (GstVideoQuality * quality,
+    gboolean fixed_mean)
+{
+  g_return_if_fail (quality != NULL);
+
+  quality->fixed_mean = fixed_mean;
+}
+
+/**
+ * gst_video_quality_ssim_map:
+ * @quality: a #GstVideoQuality
+ * @ref: the reference plane
+ * @dist: the distorted plane, of the same size as @ref
+ * @map: (allow-none): @ref's width x height samples to store the SSIM of
+ *     the window around every sample in, as 127 + SSIM * 128
+ * @map_stride: bytes between two lines of @map
+ * @lowest: (out) (allow-none): the lowest SSIM of a window
+ * @highest: (out) (allow-none): the highest SSIM of a window
+ *
+ * Computes the SSIM of a window around every sample of a plane, see
+ * gst_video_quality_set_ssim_map_window().
+ *
+ * Returns: the mean SSIM over all samples
+ */
+gdouble
+gst_video_quality_ssim_map (GstVideoQuality * quality,
+    const GstVideoQualityPlane * ref, const GstVideoQualityPlane * dist,
+    guint8 * map, gint map_stride, gdouble * lowest, gdouble * highest)
+{
+  GstVideoQualityMapBand *bands;
+  gdouble sum = 0, low = G_MAXDOUBLE, high = -G_MAXDOUBLE;
+  guint n_bands, i;
+
+  g_return_val_if_fail (quality != NULL, 0);
+  g_return_val_if_fail (ref != NULL && dist != NULL, 0);
+  g_return_val_if_fail (ref->width == dist->width
+      && ref->height == dist->height, 0);
+
+  if (ref->width <= 0 || ref->height <= 0) {
+    if (lowest)
+      *lowest = 1;
+    if (highest)
+      *highest = 1;
+    return 1;
+  }
+
+  n_bands = gst_band_pool_get_n_bands (quality->n_threads, ref->height,
+      MIN_BAND_HEIGHT);
+  bands = g_new (GstVideoQualityMapBand, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    bands[i].ref = ref;
+    bands[i].dist = dist;
+    bands[i].window = quality->map_window;
+    bands[i].kernel = quality->map_kernel;
+    bands[i].size = quality->map_size;
+    bands[i].fixed_mean = quality->fixed_mean;
+    bands[i].map = map;
+    bands[i].map_stride = map_stride;
+    bands[i].x_start = 0;
+    bands[i].x_end = ref->width;
+    bands[i].y_start = ref->height * i / n_bands;
+    bands[i].y_end = ref->height * (i + 1) / n_bands;
+  }
+
+  gst_band_pool_run (gst_band_pool_get_default (), gst_video_quality_map_band,
+      NULL, bands, sizeof (GstVideoQualityMapBand), n_bands);
+
+  for (i = 0; i < n_bands; i++) {
+    sum += bands[i].sum;
+    low = MIN (low, bands[i].lowest);
+    high = MAX (high, bands[i].highest);
+  }
+  g_free (bands);
+
+  if (lowest)
+    *lowest = low;
+  if (highest)
+    *highest = high;
+
+  return sum / ((gdouble) ref->width * ref->height);
+}
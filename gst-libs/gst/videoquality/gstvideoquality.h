@@ -0,0 +1,109 @@
+/* GStreamer
+ *
+ * gstvideoquality.h: full-reference video quality metrics
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_VIDEO_QUALITY_H__
+#define __GST_VIDEO_QUALITY_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstVideoQualityMetrics:
+ * @GST_VIDEO_QUALITY_METRIC_PSNR: mean squared error and PSNR
+ * @GST_VIDEO_QUALITY_METRIC_SSIM: mean SSIM over the 11x11 Gaussian windows
+ *     of a plane
+ * @GST_VIDEO_QUALITY_METRIC_MS_SSIM: multi-scale SSIM over up to 5 scales
+ *
+ * The metrics to compute with gst_video_quality_measure().
+ */
+typedef enum {
+  GST_VIDEO_QUALITY_METRIC_PSNR = (1 << 0),
+  GST_VIDEO_QUALITY_METRIC_SSIM = (1 << 1),
+  GST_VIDEO_QUALITY_METRIC_MS_SSIM = (1 << 2)
+} GstVideoQualityMetrics;
+
+/**
+ * GstVideoQualityWindow:
+ * @GST_VIDEO_QUALITY_WINDOW_FLAT: all samples of a window weigh the same
+ * @GST_VIDEO_QUALITY_WINDOW_GAUSSIAN: Gaussian weights around the centre
+ *     sample
+ *
+ * The weighting of the windows of gst_video_quality_ssim_map().
+ */
+typedef enum {
+  GST_VIDEO_QUALITY_WINDOW_FLAT,
+  GST_VIDEO_QUALITY_WINDOW_GAUSSIAN
+} GstVideoQualityWindow;
+
+/**
+ * GstVideoQualityPlane:
+ * @data: the first sample of the plane
+ * @width: number of samples per line
+ * @height: number of lines
+ * @pstride: bytes between two samples of a line
+ * @stride: bytes between two lines
+ *
+ * One 8 bit component of a frame.
+ */
+typedef struct {
+  const guint8 *data;
+  gint width, height;
+  gint pstride, stride;
+} GstVideoQualityPlane;
+
+/**
+ * GstVideoQualityResult:
+ * @mse: mean squared error
+ * @psnr: peak signal to noise ratio in dB, infinite for identical planes
+ * @ssim: mean SSIM
+ * @ms_ssim: multi-scale SSIM
+ *
+ * The metrics of one plane. Only the requested fields are set.
+ */
+typedef struct {
+  gdouble mse;
+  gdouble psnr;
+  gdouble ssim;
+  gdouble ms_ssim;
+} GstVideoQualityResult;
+
+typedef struct _GstVideoQuality GstVideoQuality;
+
+GstVideoQuality *gst_video_quality_new (guint n_threads);
+void gst_video_quality_free (GstVideoQuality * quality);
+
+void gst_video_quality_measure (GstVideoQuality * quality,
+    GstVideoQualityMetrics metrics, const GstVideoQualityPlane * ref,
+    const GstVideoQualityPlane * dist, guint n_planes,
+    GstVideoQualityResult * results);
+
+void gst_video_quality_set_ssim_map_window (GstVideoQuality * quality,
+    GstVideoQualityWindow window, guint size, gdouble sigma);
+void gst_video_quality_set_ssim_map_fixed_mean (GstVideoQuality * quality,
+    gboolean fixed_mean);
+
+gdouble gst_video_quality_ssim_map (GstVideoQuality * quality,
+    const GstVideoQualityPlane * ref, const GstVideoQualityPlane * dist,
+    guint8 * map, gint map_stride, gdouble * lowest, gdouble * highest);
+
+G_END_DECLS
+
+#endif /* __GST_VIDEO_QUALITY_H__ */
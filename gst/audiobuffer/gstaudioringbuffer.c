@@ -23,7 +23,11 @@
  * SECTION:element-audioringbuffer
  * @short_description: Asynchronous audio ringbuffer.
  *
- *
+ * When the source pad is pulled from, the data pushed into the sink pad is
+ * handed over through a lock-free ring of #GstAudioRingbuffer:buffer-time.
+ * Reading starts once the ring is full. The #GstAudioRingbuffer:overruns and
+ * #GstAudioRingbuffer:underruns properties count how often the ring ran full
+ * or empty.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -39,6 +43,8 @@
 
 #include <gst/audio/gstringbuffer.h>
 
+#include "gstspscring.h"
+
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -66,6 +72,8 @@ enum
   PROP_0,
   PROP_BUFFER_TIME,
   PROP_SEGMENT_TIME,
+  PROP_OVERRUNS,
+  PROP_UNDERRUNS,
   PROP_LAST
 };
 
@@ -87,9 +95,6 @@ static GType gst_audio_ringbuffer_get_type (void);
 typedef struct _GstAudioRingbuffer GstAudioRingbuffer;
 typedef struct _GstAudioRingbufferClass GstAudioRingbufferClass;
 
-typedef struct _GstIntRingBuffer GstIntRingBuffer;
-typedef struct _GstIntRingBufferClass GstIntRingBufferClass;
-
 struct _GstAudioRingbuffer
 {
   GstElement element;
@@ -105,20 +110,30 @@ struct _GstAudioRingbuffer
   GstSegment sink_segment;
   GstSegment src_segment;
 
-  /* flowreturn when srcpad is paused */
+  /* flowreturn when srcpad is paused, protected by the object lock */
   gboolean is_eos;
   gboolean flushing;
   gboolean waiting;
+  /* the consumer is using the ring and the spec outside of the lock */
+  gboolean reading;
+  /* the ring is being replaced after a caps change */
+  gboolean reconfiguring;
 
   GCond *cond;
 
-  GstRingBuffer *buffer;
+  GstRingBufferSpec spec;
+  GstSpscRing ring;
+  /* set while the producer sleeps because the ring is full */
+  volatile gint writer_waiting;
 
   GstClockTime buffer_time;
   GstClockTime segment_time;
 
   guint64 next_sample;
-  guint64 last_align;
+
+  /* protected by the object lock */
+  guint64 overruns;
+  guint64 underruns;
 };
 
 struct _GstAudioRingbufferClass
@@ -127,102 +142,6 @@ struct _GstAudioRingbufferClass
 };
 
 
-#define GST_TYPE_INT_RING_BUFFER             (gst_int_ring_buffer_get_type())
-#define GST_INT_RING_BUFFER(obj)             (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_INT_RING_BUFFER,GstIntRingBuffer))
-#define GST_INT_RING_BUFFER_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_INT_RING_BUFFER,GstIntRingBufferClass))
-#define GST_INT_RING_BUFFER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), GST_TYPE_INT_RING_BUFFER, GstIntRingBufferClass))
-#define GST_INT_RING_BUFFER_CAST(obj)        ((GstIntRingBuffer *)obj)
-#define GST_IS_INT_RING_BUFFER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_INT_RING_BUFFER))
-#define GST_IS_INT_RING_BUFFER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_INT_RING_BUFFER))
-
-
-struct _GstIntRingBuffer
-{
-  GstRingBuffer object;
-};
-
-struct _GstIntRingBufferClass
-{
-  GstRingBufferClass parent_class;
-};
-
-GST_BOILERPLATE (GstIntRingBuffer, gst_int_ring_buffer, GstRingBuffer,
-    GST_TYPE_RING_BUFFER);
-
-static gboolean
-gst_int_ring_buffer_acquire (GstRingBuffer * buf, GstRingBufferSpec * spec)
-{
-  spec->seglatency = spec->segtotal;
-
-  buf->data = gst_buffer_new_and_alloc (spec->segtotal * spec->segsize);
-  memset (GST_BUFFER_DATA (buf->data), 0, GST_BUFFER_SIZE (buf->data));
-
-  return TRUE;
-}
-
-static gboolean
-gst_int_ring_buffer_release (GstRingBuffer * buf)
-{
-  gst_buffer_unref (buf->data);
-  buf->data = NULL;
-
-  return TRUE;
-}
-
-static gboolean
-gst_int_ring_buffer_start (GstRingBuffer * buf)
-{
-  GstAudioRingbuffer *ringbuffer;
-
-  ringbuffer = GST_AUDIO_RINGBUFFER (GST_OBJECT_PARENT (buf));
-
-  GST_OBJECT_LOCK (ringbuffer);
-  if (G_UNLIKELY (ringbuffer->waiting)) {
-    ringbuffer->waiting = FALSE;
-    GST_DEBUG_OBJECT (ringbuffer, "start, sending signal");
-    g_cond_broadcast (ringbuffer->cond);
-  }
-  GST_OBJECT_UNLOCK (ringbuffer);
-
-  return TRUE;
-}
-
-
-static void
-gst_int_ring_buffer_base_init (gpointer klass)
-{
-}
-
-static void
-gst_int_ring_buffer_class_init (GstIntRingBufferClass * klass)
-{
-  GstRingBufferClass *gstringbuffer_class;
-
-  gstringbuffer_class = (GstRingBufferClass *) klass;
-
-  gstringbuffer_class->acquire =
-      GST_DEBUG_FUNCPTR (gst_int_ring_buffer_acquire);
-  gstringbuffer_class->release =
-      GST_DEBUG_FUNCPTR (gst_int_ring_buffer_release);
-  gstringbuffer_class->start = GST_DEBUG_FUNCPTR (gst_int_ring_buffer_start);
-}
-
-static void
-gst_int_ring_buffer_init (GstIntRingBuffer * buff,
-    GstIntRingBufferClass * g_class)
-{
-}
-
-static GstRingBuffer *
-gst_int_ring_buffer_new (void)
-{
-  GstRingBuffer *res;
-
-  res = g_object_new (GST_TYPE_INT_RING_BUFFER, NULL);
-
-  return res;
-}
-
 /* can't use boilerplate as we need to register with Queue2 to avoid conflicts
  * with ringbuffer in core elements */
 static void gst_audio_ringbuffer_class_init (GstAudioRingbufferClass * klass);
@@ -293,6 +212,8 @@ static gboolean gst_audio_ringbuffer_sink_activate_push (GstPad * pad,
 static GstStateChangeReturn gst_audio_ringbuffer_change_state (GstElement *
     element, GstStateChange transition);
 
+static void gst_audio_ringbuffer_start (GstAudioRingbuffer * ringbuffer);
+
 /* static guint gst_audio_ringbuffer_signals[LAST_SIGNAL] = { 0 }; */
 
 static void
@@ -310,16 +231,26 @@ gst_audio_ringbuffer_class_init (GstAudioRingbufferClass * klass)
 
   g_object_class_install_property (gobject_class, PROP_BUFFER_TIME,
       g_param_spec_int64 ("buffer-time", "Buffer Time",
-          "Size of audio buffer in nanoseconds", 1,
+          "Size of audio buffer in microseconds", 1,
           G_MAXINT64, DEFAULT_BUFFER_TIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (gobject_class, PROP_SEGMENT_TIME,
       g_param_spec_int64 ("segment-time", "Segment Time",
-          "Audio segment duration in nanoseconds", 1,
+          "Audio segment duration in microseconds", 1,
           G_MAXINT64, DEFAULT_SEGMENT_TIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_OVERRUNS,
+      g_param_spec_uint64 ("overruns", "Overruns",
+          "Number of times the ringbuffer was full and the input had to wait",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_UNDERRUNS,
+      g_param_spec_uint64 ("underruns", "Underruns",
+          "Number of times the ringbuffer ran empty and silence was output",
+          0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&srctemplate));
   gst_element_class_add_pad_template (gstelement_class,
@@ -397,6 +328,7 @@ gst_audio_ringbuffer_finalize (GObject * object)
   GST_DEBUG_OBJECT (ringbuffer, "finalizing ringbuffer");
 
   g_cond_free (ringbuffer->cond);
+  gst_spsc_ring_free (&ringbuffer->ring);
 
   G_OBJECT_CLASS (elem_parent_class)->finalize (object);
 }
@@ -427,19 +359,20 @@ gst_audio_ringbuffer_setcaps (GstPad * pad, GstCaps * caps)
 
   ringbuffer = GST_AUDIO_RINGBUFFER (GST_PAD_PARENT (pad));
 
-  if (!ringbuffer->buffer)
-    return FALSE;
-
-  spec = &ringbuffer->buffer->spec;
-
-  GST_DEBUG_OBJECT (ringbuffer, "release old ringbuffer");
-
-  /* release old ringbuffer */
-  gst_ring_buffer_activate (ringbuffer->buffer, FALSE);
-  gst_ring_buffer_release (ringbuffer->buffer);
+  spec = &ringbuffer->spec;
 
   GST_DEBUG_OBJECT (ringbuffer, "parse caps");
 
+  /* keep the consumer out of the ring and the spec while they change */
+  GST_OBJECT_LOCK (ringbuffer);
+  ringbuffer->reconfiguring = TRUE;
+  g_cond_broadcast (ringbuffer->cond);
+  while (ringbuffer->reading) {
+    GST_DEBUG_OBJECT (ringbuffer, "waiting for the consumer to leave the ring");
+    g_cond_wait (ringbuffer->cond, GST_OBJECT_GET_LOCK (ringbuffer));
+  }
+  GST_OBJECT_UNLOCK (ringbuffer);
+
   spec->buffer_time = ringbuffer->buffer_time;
   spec->latency_time = ringbuffer->segment_time;
 
@@ -447,14 +380,20 @@ gst_audio_ringbuffer_setcaps (GstPad * pad, GstCaps * caps)
   if (!gst_ring_buffer_parse_caps (spec, caps))
     goto parse_error;
 
+  /* the ring holds a whole number of segments of whole samples */
+  spec->segsize = MAX (spec->segsize, spec->bytes_per_sample);
+  spec->segsize -= spec->segsize % spec->bytes_per_sample;
+  spec->segtotal = MAX (spec->segtotal, 2);
+  spec->seglatency = spec->segtotal;
+
   gst_ring_buffer_debug_spec_buff (spec);
 
-  GST_DEBUG_OBJECT (ringbuffer, "acquire ringbuffer");
-  if (!gst_ring_buffer_acquire (ringbuffer->buffer, spec))
-    goto acquire_error;
+  GST_DEBUG_OBJECT (ringbuffer, "allocate ring of %d bytes",
+      spec->segtotal * spec->segsize);
 
-  GST_DEBUG_OBJECT (ringbuffer, "activate ringbuffer");
-  gst_ring_buffer_activate (ringbuffer->buffer, TRUE);
+  /* release old ring */
+  gst_spsc_ring_free (&ringbuffer->ring);
+  gst_spsc_ring_init (&ringbuffer->ring, spec->segtotal * spec->segsize);
 
   /* calculate actual latency and buffer times. 
    * FIXME: In 0.11, store the latency_time internally in ns */
@@ -465,21 +404,28 @@ gst_audio_ringbuffer_setcaps (GstPad * pad, GstCaps * caps)
 
   gst_ring_buffer_debug_spec_buff (spec);
 
+  GST_OBJECT_LOCK (ringbuffer);
+  /* the old samples are gone, let the new ring fill up before reading again */
+  if (!ringbuffer->pulling && !ringbuffer->pushing && !ringbuffer->flushing)
+    ringbuffer->waiting = TRUE;
+  ringbuffer->reconfiguring = FALSE;
+  g_cond_broadcast (ringbuffer->cond);
+  GST_OBJECT_UNLOCK (ringbuffer);
+
   return TRUE;
 
   /* ERRORS */
 parse_error:
   {
     GST_DEBUG_OBJECT (ringbuffer, "could not parse caps");
+    GST_OBJECT_LOCK (ringbuffer);
+    ringbuffer->reconfiguring = FALSE;
+    g_cond_broadcast (ringbuffer->cond);
+    GST_OBJECT_UNLOCK (ringbuffer);
     GST_ELEMENT_ERROR (ringbuffer, STREAM, FORMAT,
         (NULL), ("cannot parse audio format."));
     return FALSE;
   }
-acquire_error:
-  {
-    GST_DEBUG_OBJECT (ringbuffer, "could not acquire ringbuffer");
-    return FALSE;
-  }
 }
 
 static GstFlowReturn
@@ -515,7 +461,9 @@ gst_audio_ringbuffer_handle_sink_event (GstPad * pad, GstEvent * event)
     }
     case GST_EVENT_FLUSH_STOP:
     {
+      GST_OBJECT_LOCK (ringbuffer);
       ringbuffer->is_eos = FALSE;
+      GST_OBJECT_UNLOCK (ringbuffer);
       GST_LOG_OBJECT (ringbuffer, "received flush stop event");
       break;
     }
@@ -534,7 +482,13 @@ gst_audio_ringbuffer_handle_sink_event (GstPad * pad, GstEvent * event)
       break;
     }
     case GST_EVENT_EOS:
+      /* everything written so far is visible to the consumer once it sees
+       * is_eos under the lock */
+      GST_OBJECT_LOCK (ringbuffer);
       ringbuffer->is_eos = TRUE;
+      GST_OBJECT_UNLOCK (ringbuffer);
+      /* let the consumer drain what is left */
+      gst_audio_ringbuffer_start (ringbuffer);
       break;
     default:
       break;
@@ -548,35 +502,101 @@ gst_audio_ringbuffer_handle_sink_event (GstPad * pad, GstEvent * event)
   return TRUE;
 }
 
+/* lets the consumer start reading from the ring */
+static void
+gst_audio_ringbuffer_start (GstAudioRingbuffer * ringbuffer)
+{
+  GST_OBJECT_LOCK (ringbuffer);
+  if (G_UNLIKELY (ringbuffer->waiting)) {
+    ringbuffer->waiting = FALSE;
+    GST_DEBUG_OBJECT (ringbuffer, "start, sending signal");
+    g_cond_broadcast (ringbuffer->cond);
+  }
+  GST_OBJECT_UNLOCK (ringbuffer);
+}
+
+/* Writes @len bytes of @data into the ring, or silence when @data is NULL.
+ * The copy itself takes no locks, only when the ring is full the producer
+ * sleeps until the consumer made room for at least a segment. */
+static GstFlowReturn
+gst_audio_ringbuffer_write (GstAudioRingbuffer * ringbuffer,
+    const guint8 * data, guint len)
+{
+  GstSpscRing *ring = &ringbuffer->ring;
+  GstRingBufferSpec *spec = &ringbuffer->spec;
+  guint written;
+
+  while (TRUE) {
+    written = gst_spsc_ring_write (ring, data, len, spec->silence_sample,
+        spec->bytes_per_sample);
+    len -= written;
+    if (data)
+      data += written;
+
+    if (len == 0)
+      break;
+
+    /* the ring is full, the consumer can start now if it did not yet */
+    gst_audio_ringbuffer_start (ringbuffer);
+
+    GST_LOG_OBJECT (ringbuffer, "ring full, waiting for %u bytes of space",
+        MIN (len, spec->segsize));
+
+    GST_OBJECT_LOCK (ringbuffer);
+    ringbuffer->overruns++;
+    /* the consumer checks this after it moved read_pos, so either we see the
+     * space it made or it sees that it has to wake us up */
+    g_atomic_int_set (&ringbuffer->writer_waiting, TRUE);
+    while (!ringbuffer->flushing &&
+        ring->size - gst_spsc_ring_fill (ring) < MIN (len, spec->segsize))
+      g_cond_wait (ringbuffer->cond, GST_OBJECT_GET_LOCK (ringbuffer));
+    g_atomic_int_set (&ringbuffer->writer_waiting, FALSE);
+    if (ringbuffer->flushing)
+      goto flushing;
+    GST_OBJECT_UNLOCK (ringbuffer);
+  }
+
+  if (gst_spsc_ring_fill (ring) == ring->size)
+    gst_audio_ringbuffer_start (ringbuffer);
+
+  return GST_FLOW_OK;
+
+flushing:
+  {
+    GST_DEBUG_OBJECT (ringbuffer, "ringbuffer is flushing");
+    GST_OBJECT_UNLOCK (ringbuffer);
+    return GST_FLOW_FLUSHING;
+  }
+}
+
 #define DIFF_TOLERANCE  2
 
 static GstFlowReturn
 gst_audio_ringbuffer_render (GstAudioRingbuffer * ringbuffer, GstBuffer * buf)
 {
-  GstRingBuffer *rbuf;
-  gint bps, accum;
+  GstRingBufferSpec *spec;
+  gint bps;
   guint size;
-  guint samples, written, out_samples;
-  gint64 diff, align, ctime, cstop;
+  guint samples;
+  gint64 diff, ctime, cstop;
   guint8 *data;
   guint64 in_offset;
-  GstClockTime time, stop, render_start, render_stop, sample_offset;
-  gboolean align_next;
+  GstClockTime time, stop, render_start;
+  GstFlowReturn ret;
 
-  rbuf = ringbuffer->buffer;
+  spec = &ringbuffer->spec;
 
-  /* can't do anything when we don't have the device */
-  if (G_UNLIKELY (!gst_ring_buffer_is_acquired (rbuf)))
+  /* can't do anything when we don't have the ring */
+  if (G_UNLIKELY (ringbuffer->ring.data == NULL))
     goto wrong_state;
 
-  bps = rbuf->spec.bytes_per_sample;
+  bps = spec->bytes_per_sample;
 
   size = GST_BUFFER_SIZE (buf);
   if (G_UNLIKELY (size % bps) != 0)
     goto wrong_size;
 
   samples = size / bps;
-  out_samples = samples;
 
   in_offset = GST_BUFFER_OFFSET (buf);
   time = GST_BUFFER_TIMESTAMP (buf);
@@ -588,8 +608,7 @@ gst_audio_ringbuffer_render (GstAudioRingbuffer * ringbuffer, GstBuffer * buf)
 
   data = GST_BUFFER_DATA (buf);
 
-  stop = time + gst_util_uint64_scale_int (samples, GST_SECOND,
-      rbuf->spec.rate);
+  stop = time + gst_util_uint64_scale_int (samples, GST_SECOND, spec->rate);
 
   if (!gst_segment_clip (&ringbuffer->sink_segment, GST_FORMAT_TIME, time, stop,
           &ctime, &cstop))
@@ -599,7 +618,7 @@ gst_audio_ringbuffer_render (GstAudioRingbuffer * ringbuffer, GstBuffer * buf)
   diff = ctime - time;
   if (diff > 0) {
     /* bring clipped time to samples */
-    diff = gst_util_uint64_scale_int (diff, rbuf->spec.rate, GST_SECOND);
+    diff = gst_util_uint64_scale_int (diff, spec->rate, GST_SECOND);
     GST_DEBUG_OBJECT (ringbuffer, "clipping start to %" GST_TIME_FORMAT " %"
         G_GUINT64_FORMAT " samples", GST_TIME_ARGS (ctime), diff);
     samples -= diff;
@@ -609,43 +628,22 @@ gst_audio_ringbuffer_render (GstAudioRingbuffer * ringbuffer, GstBuffer * buf)
   diff = stop - cstop;
   if (diff > 0) {
     /* bring clipped time to samples */
-    diff = gst_util_uint64_scale_int (diff, rbuf->spec.rate, GST_SECOND);
+    diff = gst_util_uint64_scale_int (diff, spec->rate, GST_SECOND);
     GST_DEBUG_OBJECT (ringbuffer, "clipping stop to %" GST_TIME_FORMAT " %"
         G_GUINT64_FORMAT " samples", GST_TIME_ARGS (cstop), diff);
     samples -= diff;
     stop = cstop;
   }
 
-  /* bring buffer start and stop times to running time */
+  /* bring buffer start time to running time and then to a sample offset */
   render_start =
       gst_segment_to_running_time (&ringbuffer->sink_segment, GST_FORMAT_TIME,
       time);
-  render_stop =
-      gst_segment_to_running_time (&ringbuffer->sink_segment, GST_FORMAT_TIME,
-      stop);
+  render_start = gst_util_uint64_scale_int (render_start, spec->rate,
+      GST_SECOND);
 
-  GST_DEBUG_OBJECT (ringbuffer,
-      "running: start %" GST_TIME_FORMAT " - stop %" GST_TIME_FORMAT,
-      GST_TIME_ARGS (render_start), GST_TIME_ARGS (render_stop));
-
-  /* and bring the time to the rate corrected offset in the buffer */
-  render_start = gst_util_uint64_scale_int (render_start,
-      rbuf->spec.rate, GST_SECOND);
-  render_stop = gst_util_uint64_scale_int (render_stop,
-      rbuf->spec.rate, GST_SECOND);
-
-  /* positive playback rate, first sample is render_start, negative rate, first
-   * sample is render_stop. When no rate conversion is active, render exactly
-   * the amount of input samples to avoid aligning to rounding errors. */
-  if (ringbuffer->sink_segment.rate >= 0.0) {
-    sample_offset = render_start;
-    if (ringbuffer->sink_segment.rate == 1.0)
-      render_stop = sample_offset + samples;
-  } else {
-    sample_offset = render_stop;
-    if (ringbuffer->sink_segment.rate == -1.0)
-      render_start = sample_offset + samples;
-  }
+  GST_DEBUG_OBJECT (ringbuffer, "running: start sample %" G_GUINT64_FORMAT,
+      render_start);
 
   /* always resync after a discont */
   if (G_UNLIKELY (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DISCONT))) {
@@ -653,33 +651,44 @@ gst_audio_ringbuffer_render (GstAudioRingbuffer * ringbuffer, GstBuffer * buf)
     goto no_align;
   }
 
-  /* resync when we don't know what to align the sample with */
-  if (G_UNLIKELY (ringbuffer->next_sample == -1)) {
+  /* resync when we don't know what to align the sample with or when the
+   * running time does not advance at the rate of the samples */
+  if (G_UNLIKELY (ringbuffer->next_sample == -1 ||
+          ringbuffer->sink_segment.rate != 1.0)) {
     GST_DEBUG_OBJECT (ringbuffer,
         "no align possible: no previous sample position known");
     goto no_align;
   }
 
-  /* now try to align the sample to the previous one, first see how big the
-   * difference is. */
-  if (sample_offset >= ringbuffer->next_sample)
-    diff = sample_offset - ringbuffer->next_sample;
+  /* the ring is a plain stream of samples, so align by filling gaps with
+   * silence and by dropping samples that overlap with the previous buffer */
+  if (render_start >= ringbuffer->next_sample)
+    diff = render_start - ringbuffer->next_sample;
   else
-    diff = ringbuffer->next_sample - sample_offset;
+    diff = ringbuffer->next_sample - render_start;
 
   /* we tollerate half a second diff before we start resyncing. This
    * should be enough to compensate for various rounding errors in the timestamp
    * and sample offset position. We always resync if we got a discont anyway and
    * non-discont should be aligned by definition. */
-  if (G_LIKELY (diff < rbuf->spec.rate / DIFF_TOLERANCE)) {
-    /* calc align with previous sample */
-    align = ringbuffer->next_sample - sample_offset;
-    GST_DEBUG_OBJECT (ringbuffer,
-        "align with prev sample, ABS (%" G_GINT64_FORMAT ") < %d", align,
-        rbuf->spec.rate / DIFF_TOLERANCE);
+  if (G_LIKELY (diff < spec->rate / DIFF_TOLERANCE)) {
+    if (render_start > ringbuffer->next_sample) {
+      GST_DEBUG_OBJECT (ringbuffer, "filling gap of %" G_GINT64_FORMAT
+          " samples", diff);
+      ret = gst_audio_ringbuffer_write (ringbuffer, NULL, diff * bps);
+      if (ret != GST_FLOW_OK)
+        return ret;
+    } else if (diff > 0) {
+      GST_DEBUG_OBJECT (ringbuffer, "dropping %" G_GINT64_FORMAT
+          " overlapping samples", diff);
+      diff = MIN (diff, samples);
+      samples -= diff;
+      data += diff * bps;
+      render_start += diff;
+    }
   } else {
     /* bring sample diff to seconds for error message */
-    diff = gst_util_uint64_scale_int (diff, GST_SECOND, rbuf->spec.rate);
+    diff = gst_util_uint64_scale_int (diff, GST_SECOND, spec->rate);
     /* timestamps drifted apart from previous samples too much, we need to
      * resync. We log this as an element warning. */
     GST_ELEMENT_WARNING (ringbuffer, CORE, CLOCK,
@@ -687,57 +696,16 @@ gst_audio_ringbuffer_render (GstAudioRingbuffer * ringbuffer, GstBuffer * buf)
         ("Unexpected discontinuity in audio timestamps of more "
             "than half a second (%" GST_TIME_FORMAT "), resyncing",
             GST_TIME_ARGS (diff)));
-    align = 0;
   }
-  ringbuffer->last_align = align;
-
-  /* apply alignment */
-  render_start += align;
-  render_stop += align;
 
 no_align:
-  /* number of target samples is difference between start and stop */
-  out_samples = render_stop - render_start;
-
-  /* we render the first or last sample first, depending on the rate */
-  if (ringbuffer->sink_segment.rate >= 0.0)
-    sample_offset = render_start;
-  else
-    sample_offset = render_stop;
-
-  GST_DEBUG_OBJECT (ringbuffer, "rendering at %" G_GUINT64_FORMAT " %d/%d",
-      sample_offset, samples, out_samples);
-
-  /* we need to accumulate over different runs for when we get interrupted */
-  accum = 0;
-  align_next = TRUE;
-  do {
-    written =
-        gst_ring_buffer_commit_full (rbuf, &sample_offset, data, samples,
-        out_samples, &accum);
-
-    GST_DEBUG_OBJECT (ringbuffer, "wrote %u of %u", written, samples);
-    /* if we wrote all, we're done */
-    if (written == samples)
-      break;
+  GST_DEBUG_OBJECT (ringbuffer, "writing %u samples", samples);
 
-    GST_OBJECT_LOCK (ringbuffer);
-    if (ringbuffer->flushing)
-      goto flushing;
-    GST_OBJECT_UNLOCK (ringbuffer);
-
-    /* if we got interrupted, we cannot assume that the next sample should
-     * be aligned to this one */
-    align_next = FALSE;
+  ret = gst_audio_ringbuffer_write (ringbuffer, data, samples * bps);
+  if (ret != GST_FLOW_OK)
+    return ret;
 
-    samples -= written;
-    data += written * bps;
-  } while (TRUE);
-
-  if (align_next)
-    ringbuffer->next_sample = sample_offset;
-  else
-    ringbuffer->next_sample = -1;
+  ringbuffer->next_sample = render_start + samples;
 
   GST_DEBUG_OBJECT (ringbuffer, "next sample expected at %" G_GUINT64_FORMAT,
       ringbuffer->next_sample);
@@ -745,7 +713,7 @@ no_align:
   if (GST_CLOCK_TIME_IS_VALID (stop) && stop >= ringbuffer->sink_segment.stop) {
     GST_DEBUG_OBJECT (ringbuffer,
         "start playback because we are at the end of segment");
-    gst_ring_buffer_start (rbuf);
+    gst_audio_ringbuffer_start (ringbuffer);
   }
 
   return GST_FLOW_OK;
@@ -774,12 +742,6 @@ wrong_size:
         (NULL), ("ringbuffer received buffer of wrong size."));
     return GST_FLOW_ERROR;
   }
-flushing:
-  {
-    GST_DEBUG_OBJECT (ringbuffer, "ringbuffer is flushing");
-    GST_OBJECT_UNLOCK (ringbuffer);
-    return GST_FLOW_FLUSHING;
-  }
 }
 
 static GstFlowReturn
@@ -834,29 +796,36 @@ gst_audio_ringbuffer_handle_src_query (GstPad * pad, GstQuery * query)
   return TRUE;
 }
 
+/* the consumer is done with the ring, lets a pending caps change go ahead */
+static void
+gst_audio_ringbuffer_stop_reading (GstAudioRingbuffer * ringbuffer)
+{
+  GST_OBJECT_LOCK (ringbuffer);
+  ringbuffer->reading = FALSE;
+  if (G_UNLIKELY (ringbuffer->reconfiguring))
+    g_cond_broadcast (ringbuffer->cond);
+  GST_OBJECT_UNLOCK (ringbuffer);
+}
+
 static GstFlowReturn
 gst_audio_ringbuffer_get_range (GstPad * pad, guint64 offset, guint length,
     GstBuffer ** buffer)
 {
   GstAudioRingbuffer *ringbuffer;
-  GstRingBuffer *rbuf;
   GstFlowReturn ret;
 
   ringbuffer = GST_AUDIO_RINGBUFFER_CAST (gst_pad_get_parent (pad));
 
-  rbuf = ringbuffer->buffer;
-
   if (ringbuffer->pulling) {
     GST_DEBUG_OBJECT (ringbuffer, "proxy pulling range");
     ret = gst_pad_pull_range (ringbuffer->sinkpad, offset, length, buffer);
   } else {
+    GstSpscRing *ring = &ringbuffer->ring;
+    GstRingBufferSpec *spec = &ringbuffer->spec;
     guint8 *data;
     guint len;
-    guint64 sample;
-    gint bps, segsize, segtotal, sps;
-    gint sampleslen, segdone;
-    gint readseg, sampleoff;
-    guint8 *dest;
+    gint bps;
+    gboolean is_eos;
 
     GST_DEBUG_OBJECT (ringbuffer,
         "pulling data at %" G_GUINT64_FORMAT ", length %u", offset, length);
@@ -872,7 +841,8 @@ gst_audio_ringbuffer_get_range (GstPad * pad, guint64 offset, guint length,
     if (ringbuffer->flushing)
       goto flushing;
 
-    while (ringbuffer->waiting) {
+    while ((ringbuffer->waiting && !ringbuffer->is_eos) ||
+        ringbuffer->reconfiguring) {
       GST_DEBUG_OBJECT (ringbuffer, "waiting for unlock");
       g_cond_wait (ringbuffer->cond, GST_OBJECT_GET_LOCK (ringbuffer));
       GST_DEBUG_OBJECT (ringbuffer, "unlocked");
@@ -880,56 +850,64 @@ gst_audio_ringbuffer_get_range (GstPad * pad, guint64 offset, guint length,
       if (ringbuffer->flushing)
         goto flushing;
     }
+    /* read before the ring, so that with EOS set the ring holds all the
+     * remaining data */
+    is_eos = ringbuffer->is_eos;
+    ringbuffer->reading = TRUE;
     GST_OBJECT_UNLOCK (ringbuffer);
 
-    bps = rbuf->spec.bytes_per_sample;
+    bps = spec->bytes_per_sample;
 
-    if (G_UNLIKELY (length % bps) != 0)
+    if (G_UNLIKELY (bps == 0 || (length % bps) != 0))
       goto wrong_size;
 
-    segsize = rbuf->spec.segsize;
-    segtotal = rbuf->spec.segtotal;
-    sps = rbuf->samples_per_seg;
-    dest = GST_BUFFER_DATA (rbuf->data);
-
-    sample = offset / bps;
-    len = length / bps;
-
     *buffer = gst_buffer_new_and_alloc (length);
     data = GST_BUFFER_DATA (*buffer);
 
-    while (len) {
-      gint diff;
-
-      /* figure out the segment and the offset inside the segment where
-       * the sample should be read from. */
-      readseg = sample / sps;
-      sampleoff = (sample % sps);
+    len = gst_spsc_ring_read (ring, data, length);
 
-      segdone = g_atomic_int_get (&rbuf->segdone) - rbuf->segbase;
-
-      diff = readseg - segdone;
-
-      /* we can read now */
-      readseg = readseg % segtotal;
-      sampleslen = MIN (sps - sampleoff, len);
-
-      GST_DEBUG_OBJECT (ringbuffer,
-          "read @%p seg %d, off %d, sampleslen %d, diff %d",
-          dest + readseg * segsize, readseg, sampleoff, sampleslen, diff);
+    if (G_UNLIKELY (len < length && !is_eos)) {
+      /* EOS might have arrived after the read, take the tail that was
+       * written before it instead of padding with silence */
+      GST_OBJECT_LOCK (ringbuffer);
+      is_eos = ringbuffer->is_eos;
+      GST_OBJECT_UNLOCK (ringbuffer);
 
-      memcpy (data, dest + (readseg * segsize) + (sampleoff * bps),
-          (sampleslen * bps));
+      if (is_eos)
+        len += gst_spsc_ring_read (ring, data + len, length - len);
+    }
 
-      if (diff > 0)
-        gst_ring_buffer_advance (rbuf, diff);
+    /* wake up the producer when it waits for room */
+    if (g_atomic_int_get (&ringbuffer->writer_waiting) &&
+        ring->size - gst_spsc_ring_fill (ring) >= spec->segsize) {
+      GST_OBJECT_LOCK (ringbuffer);
+      g_cond_broadcast (ringbuffer->cond);
+      GST_OBJECT_UNLOCK (ringbuffer);
+    }
 
-      len -= sampleslen;
-      sample += sampleslen;
-      data += sampleslen * bps;
+    if (G_UNLIKELY (len < length)) {
+      if (is_eos) {
+        /* drained, hand out what is left */
+        if (len == 0)
+          goto eos;
+        GST_BUFFER_SIZE (*buffer) = len;
+      } else {
+        guint i;
+
+        /* the producer did not keep up, play silence for the missing part */
+        GST_OBJECT_LOCK (ringbuffer);
+        ringbuffer->underruns++;
+        GST_OBJECT_UNLOCK (ringbuffer);
+        GST_DEBUG_OBJECT (ringbuffer, "underrun, %u of %u bytes available",
+            len, length);
+        for (i = len; i < length; i++)
+          data[i] = spec->silence_sample[(i - len) % bps];
+      }
     }
 
-    ringbuffer->src_segment.last_stop += length;
+    ringbuffer->src_segment.last_stop += GST_BUFFER_SIZE (*buffer);
+
+    gst_audio_ringbuffer_stop_reading (ringbuffer);
 
     ret = GST_FLOW_OK;
   }
@@ -949,10 +927,21 @@ flushing:
 wrong_size:
   {
     GST_DEBUG_OBJECT (ringbuffer, "wrong size");
+    gst_audio_ringbuffer_stop_reading (ringbuffer);
     GST_ELEMENT_ERROR (ringbuffer, STREAM, WRONG_TYPE,
         (NULL), ("asked to pull buffer of wrong size."));
+    gst_object_unref (ringbuffer);
     return GST_FLOW_ERROR;
   }
+eos:
+  {
+    GST_DEBUG_OBJECT (ringbuffer, "ring drained after EOS");
+    gst_audio_ringbuffer_stop_reading (ringbuffer);
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+    gst_object_unref (ringbuffer);
+    return GST_FLOW_EOS;
+  }
 }
 
 static gboolean
@@ -1065,29 +1054,20 @@ gst_audio_ringbuffer_change_state (GstElement * element,
   ringbuffer = GST_AUDIO_RINGBUFFER (element);
 
   switch (transition) {
-    case GST_STATE_CHANGE_NULL_TO_READY:
-      if (ringbuffer->buffer == NULL) {
-        ringbuffer->buffer = gst_int_ring_buffer_new ();
-        gst_object_set_parent (GST_OBJECT (ringbuffer->buffer),
-            GST_OBJECT (ringbuffer));
-        gst_ring_buffer_open_device (ringbuffer->buffer);
-      }
-      break;
     case GST_STATE_CHANGE_READY_TO_PAUSED:
       ringbuffer->next_sample = -1;
-      ringbuffer->last_align = -1;
-      gst_ring_buffer_set_flushing (ringbuffer->buffer, FALSE);
-      gst_ring_buffer_may_start (ringbuffer->buffer, TRUE);
+      GST_OBJECT_LOCK (ringbuffer);
+      ringbuffer->overruns = 0;
+      ringbuffer->underruns = 0;
+      GST_OBJECT_UNLOCK (ringbuffer);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* wakes up both the producer and the consumer */
       GST_OBJECT_LOCK (ringbuffer);
       ringbuffer->flushing = TRUE;
       ringbuffer->waiting = FALSE;
       g_cond_broadcast (ringbuffer->cond);
       GST_OBJECT_UNLOCK (ringbuffer);
-
-      gst_ring_buffer_set_flushing (ringbuffer->buffer, TRUE);
-      gst_ring_buffer_may_start (ringbuffer->buffer, FALSE);
       break;
     default:
       break;
@@ -1098,15 +1078,7 @@ gst_audio_ringbuffer_change_state (GstElement * element,
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
-      gst_ring_buffer_activate (ringbuffer->buffer, FALSE);
-      gst_ring_buffer_release (ringbuffer->buffer);
-      break;
-    case GST_STATE_CHANGE_READY_TO_NULL:
-      if (ringbuffer->buffer != NULL) {
-        gst_ring_buffer_close_device (ringbuffer->buffer);
-        gst_object_unparent (GST_OBJECT (ringbuffer->buffer));
-        ringbuffer->buffer = NULL;
-      }
+      gst_spsc_ring_free (&ringbuffer->ring);
       break;
     default:
       break;
@@ -1151,6 +1123,16 @@ gst_audio_ringbuffer_get_property (GObject * object,
     case PROP_SEGMENT_TIME:
       g_value_set_int64 (value, ringbuffer->segment_time);
       break;
+    case PROP_OVERRUNS:
+      GST_OBJECT_LOCK (ringbuffer);
+      g_value_set_uint64 (value, ringbuffer->overruns);
+      GST_OBJECT_UNLOCK (ringbuffer);
+      break;
+    case PROP_UNDERRUNS:
+      GST_OBJECT_LOCK (ringbuffer);
+      g_value_set_uint64 (value, ringbuffer->underruns);
+      GST_OBJECT_UNLOCK (ringbuffer);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
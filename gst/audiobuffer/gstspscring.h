@@ -0,0 +1,143 @@
+/* GStreamer
+ * Copyright (C) 2008 Wim Taymans <wim.taymans@gmail.com>
+ *
+ * gstspscring.h:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_SPSC_RING_H__
+#define __GST_SPSC_RING_H__
+
+#include <string.h>
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Lock-free single producer, single consumer ring between the streaming
+ * thread that pushes into the sink pad and the thread that pulls from the
+ * source pad. Only the producer moves write_pos and only the consumer moves
+ * read_pos. Both count bytes and wrap around at 2^32, the storage is a power
+ * of 2 so that they can be masked into it. The positions sit on separate
+ * cache lines so that the two threads do not keep taking the line away from
+ * each other. */
+#define RING_CACHE_LINE 64
+
+typedef struct
+{
+  guint8 *data;
+  guint size;                   /* usable bytes */
+  guint mask;                   /* allocated bytes - 1 */
+
+  guint8 _pad0[RING_CACHE_LINE];
+  volatile gint write_pos;
+  guint8 _pad1[RING_CACHE_LINE - sizeof (gint)];
+  volatile gint read_pos;
+  guint8 _pad2[RING_CACHE_LINE - sizeof (gint)];
+} GstSpscRing;
+
+static inline void
+gst_spsc_ring_init (GstSpscRing * ring, guint size)
+{
+  guint alloc = 1 << g_bit_storage (MAX (size, 1) - 1);
+
+  ring->data = g_malloc0 (alloc);
+  ring->size = size;
+  ring->mask = alloc - 1;
+  ring->write_pos = 0;
+  ring->read_pos = 0;
+}
+
+static inline void
+gst_spsc_ring_free (GstSpscRing * ring)
+{
+  g_free (ring->data);
+  ring->data = NULL;
+  ring->size = 0;
+}
+
+static inline guint
+gst_spsc_ring_fill (GstSpscRing * ring)
+{
+  return (guint) g_atomic_int_get (&ring->write_pos) -
+      (guint) g_atomic_int_get (&ring->read_pos);
+}
+
+/* copies @len bytes of @src to @pos in the ring, or repeats the @bps bytes
+ * of @silence when @src is NULL */
+static inline void
+gst_spsc_ring_copy_in (GstSpscRing * ring, guint pos, const guint8 * src,
+    guint len, const guint8 * silence, gint bps)
+{
+  guint i;
+
+  if (src) {
+    guint off = pos & ring->mask;
+    guint n = MIN (len, ring->mask + 1 - off);
+
+    memcpy (ring->data + off, src, n);
+    memcpy (ring->data, src + n, len - n);
+  } else {
+    for (i = 0; i < len; i++)
+      ring->data[(pos + i) & ring->mask] = silence[i % bps];
+  }
+}
+
+/* producer side, returns the number of bytes that fit */
+static inline guint
+gst_spsc_ring_write (GstSpscRing * ring, const guint8 * src, guint len,
+    const guint8 * silence, gint bps)
+{
+  guint w = (guint) ring->write_pos;
+  guint r = (guint) g_atomic_int_get (&ring->read_pos);
+
+  len = MIN (len, ring->size - (w - r));
+  if (len == 0)
+    return 0;
+
+  gst_spsc_ring_copy_in (ring, w, src, len, silence, bps);
+  /* publish the data only after it was written */
+  g_atomic_int_set (&ring->write_pos, (gint) (w + len));
+
+  return len;
+}
+
+/* consumer side, returns the number of bytes read */
+static inline guint
+gst_spsc_ring_read (GstSpscRing * ring, guint8 * dest, guint len)
+{
+  guint r = (guint) ring->read_pos;
+  guint w = (guint) g_atomic_int_get (&ring->write_pos);
+  guint off, n;
+
+  len = MIN (len, w - r);
+  if (len == 0)
+    return 0;
+
+  off = r & ring->mask;
+  n = MIN (len, ring->mask + 1 - off);
+  memcpy (dest, ring->data + off, n);
+  memcpy (dest + n, ring->data, len - n);
+  /* only hand the space back once it was read */
+  g_atomic_int_set (&ring->read_pos, (gint) (r + len));
+
+  return len;
+}
+
+G_END_DECLS
+
+#endif /* __GST_SPSC_RING_H__ */
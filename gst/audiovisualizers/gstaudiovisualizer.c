@@ -40,18 +40,24 @@
 #include <string.h>
 
 #include "gstaudiovisualizer.h"
+#include "gstaudiovisualizersorc.h"
 
 GST_DEBUG_CATEGORY_STATIC (audio_visualizer_debug);
 #define GST_CAT_DEFAULT (audio_visualizer_debug)
 
 #define DEFAULT_SHADER GST_AUDIO_VISUALIZER_SHADER_FADE
 #define DEFAULT_SHADE_AMOUNT   0x000a0a0a
+#define DEFAULT_ASYNC_SHADING FALSE
+#define DEFAULT_MAX_FPS_N 0
+#define DEFAULT_MAX_FPS_D 1
 
 enum
 {
   PROP_0,
   PROP_SHADER,
-  PROP_SHADE_AMOUNT
+  PROP_SHADE_AMOUNT,
+  PROP_ASYNC_SHADING,
+  PROP_MAX_FPS
 };
 
 static GstBaseTransformClass *parent_class = NULL;
@@ -126,119 +132,59 @@ gst_audio_visualizer_shader_get_type (void)
   return shader_type;
 }
 
-/* we're only supporting GST_VIDEO_FORMAT_xRGB right now) */
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-
-#define SHADE1(_d, _s, _i, _r, _g, _b)          \
-G_STMT_START {                                  \
-    _d[_i] = (_s[_i] > _b) ? _s[_i] - _b : 0;   \
-    _i++;                                       \
-    _d[_i] = (_s[_i] > _g) ? _s[_i] - _g : 0;   \
-    _i++;                                       \
-    _d[_i] = (_s[_i] > _r) ? _s[_i] - _r : 0;   \
-    _i++;                                       \
-    _d[_i++] = 0;                               \
-} G_STMT_END
-
-#define SHADE2(_d, _s, _j, _i, _r, _g, _b)      \
-G_STMT_START {                                  \
-    _d[_j++] = (_s[_i] > _b) ? _s[_i] - _b : 0; \
-    _i++;                                       \
-    _d[_j++] = (_s[_i] > _g) ? _s[_i] - _g : 0; \
-    _i++;                                       \
-    _d[_j++] = (_s[_i] > _r) ? _s[_i] - _r : 0; \
-    _i++;                                       \
-    _d[_j++] = 0;                               \
-    _i++;                                       \
-} G_STMT_END
-
-#else
-
-#define SHADE1(_d, _s, _i, _r, _g, _b)          \
-G_STMT_START {                                  \
-    _d[_i++] = 0;                               \
-    _d[_i] = (_s[_i] > _r) ? _s[_i] - _r : 0;   \
-    _i++;                                       \
-    _d[_i] = (_s[_i] > _g) ? _s[_i] - _g : 0;   \
-    _i++;                                       \
-    _d[_i] = (_s[_i] > _b) ? _s[_i] - _b : 0;   \
-    _i++;                                       \
-} G_STMT_END
-
-#define SHADE2(_d, _s, _j, _i, _r, _g, _b)      \
-G_STMT_START {                                  \
-    _d[_j++] = 0;                               \
-    _i++;                                       \
-    _d[_j++] = (_s[_i] > _r) ? _s[_i] - _r : 0; \
-    _i++;                                       \
-    _d[_j++] = (_s[_i] > _g) ? _s[_i] - _g : 0; \
-    _i++;                                       \
-    _d[_j++] = (_s[_i] > _b) ? _s[_i] - _b : 0; \
-    _i++;                                       \
-} G_STMT_END
-
-#endif
+/* we're only supporting GST_VIDEO_FORMAT_xRGB right now)
+ *
+ * The shade amount is subtracted with saturation from every colour byte of a
+ * pixel. The padding byte gets 0xff subtracted, which clears it. As the packed
+ * colour is read in native endianness the same value works for the xRGB and
+ * the BGRx layout. */
+#define SHADE_COLOR(_scope) (((_scope)->shade_amount & 0x00ffffff) | 0xff000000)
+
+static inline void
+shade_pixels (GstAudioVisualizer * scope, const guint8 * s, guint8 * d,
+    guint n)
+{
+  audiovisualizers_orc_shade ((guint32 *) d, (const guint32 *) s,
+      SHADE_COLOR (scope), n);
+}
 
 static void
 shader_fade (GstAudioVisualizer * scope, const guint8 * s, guint8 * d)
 {
-  guint i, bpf = scope->bpf;
-  guint r = (scope->shade_amount >> 16) & 0xff;
-  guint g = (scope->shade_amount >> 8) & 0xff;
-  guint b = (scope->shade_amount >> 0) & 0xff;
-
-  for (i = 0; i < bpf;) {
-    SHADE1 (d, s, i, r, g, b);
-  }
+  shade_pixels (scope, s, d, scope->bpf / 4);
 }
 
 static void
 shader_fade_and_move_up (GstAudioVisualizer * scope, const guint8 * s,
     guint8 * d)
 {
-  guint i, j, bpf = scope->bpf;
+  guint bpf = scope->bpf;
   guint bpl = 4 * scope->width;
-  guint r = (scope->shade_amount >> 16) & 0xff;
-  guint g = (scope->shade_amount >> 8) & 0xff;
-  guint b = (scope->shade_amount >> 0) & 0xff;
 
-  for (j = 0, i = bpl; i < bpf;) {
-    SHADE2 (d, s, j, i, r, g, b);
-  }
+  shade_pixels (scope, s + bpl, d, (bpf - bpl) / 4);
 }
 
 static void
 shader_fade_and_move_down (GstAudioVisualizer * scope, const guint8 * s,
     guint8 * d)
 {
-  guint i, j, bpf = scope->bpf;
+  guint bpf = scope->bpf;
   guint bpl = 4 * scope->width;
-  guint r = (scope->shade_amount >> 16) & 0xff;
-  guint g = (scope->shade_amount >> 8) & 0xff;
-  guint b = (scope->shade_amount >> 0) & 0xff;
 
-  for (j = bpl, i = 0; j < bpf;) {
-    SHADE2 (d, s, j, i, r, g, b);
-  }
+  shade_pixels (scope, s, d + bpl, (bpf - bpl) / 4);
 }
 
 static void
 shader_fade_and_move_left (GstAudioVisualizer * scope,
     const guint8 * s, guint8 * d)
 {
-  guint i, j, k, bpf = scope->bpf;
+  guint i, bpf = scope->bpf;
   guint w = scope->width;
-  guint r = (scope->shade_amount >> 16) & 0xff;
-  guint g = (scope->shade_amount >> 8) & 0xff;
-  guint b = (scope->shade_amount >> 0) & 0xff;
+  guint bpl = 4 * w;
 
   /* move to the left */
-  for (j = 0, i = 4; i < bpf;) {
-    for (k = 0; k < w - 1; k++) {
-      SHADE2 (d, s, j, i, r, g, b);
-    }
-    i += 4;
-    j += 4;
+  for (i = 0; i < bpf; i += bpl) {
+    shade_pixels (scope, s + i + 4, d + i, w - 1);
   }
 }
 
@@ -246,19 +192,13 @@ static void
 shader_fade_and_move_right (GstAudioVisualizer * scope,
     const guint8 * s, guint8 * d)
 {
-  guint i, j, k, bpf = scope->bpf;
+  guint i, bpf = scope->bpf;
   guint w = scope->width;
-  guint r = (scope->shade_amount >> 16) & 0xff;
-  guint g = (scope->shade_amount >> 8) & 0xff;
-  guint b = (scope->shade_amount >> 0) & 0xff;
+  guint bpl = 4 * w;
 
-  /* move to the left */
-  for (j = 4, i = 0; i < bpf;) {
-    for (k = 0; k < w - 1; k++) {
-      SHADE2 (d, s, j, i, r, g, b);
-    }
-    i += 4;
-    j += 4;
+  /* move to the right */
+  for (i = 0; i < bpf; i += bpl) {
+    shade_pixels (scope, s + i, d + i + 4, w - 1);
   }
 }
 
@@ -266,67 +206,48 @@ static void
 shader_fade_and_move_horiz_out (GstAudioVisualizer * scope,
     const guint8 * s, guint8 * d)
 {
-  guint i, j, bpf = scope->bpf / 2;
+  guint bpf = scope->bpf / 2;
   guint bpl = 4 * scope->width;
-  guint r = (scope->shade_amount >> 16) & 0xff;
-  guint g = (scope->shade_amount >> 8) & 0xff;
-  guint b = (scope->shade_amount >> 0) & 0xff;
+
+  if (bpf < bpl)
+    return;
 
   /* move upper half up */
-  for (j = 0, i = bpl; i < bpf;) {
-    SHADE2 (d, s, j, i, r, g, b);
-  }
+  shade_pixels (scope, s + bpl, d, (bpf - bpl) / 4);
   /* move lower half down */
-  for (j = bpf + bpl, i = bpf; j < bpf + bpf;) {
-    SHADE2 (d, s, j, i, r, g, b);
-  }
+  shade_pixels (scope, s + bpf, d + bpf + bpl, (bpf - bpl) / 4);
 }
 
 static void
 shader_fade_and_move_horiz_in (GstAudioVisualizer * scope,
     const guint8 * s, guint8 * d)
 {
-  guint i, j, bpf = scope->bpf / 2;
+  guint bpf = scope->bpf / 2;
   guint bpl = 4 * scope->width;
-  guint r = (scope->shade_amount >> 16) & 0xff;
-  guint g = (scope->shade_amount >> 8) & 0xff;
-  guint b = (scope->shade_amount >> 0) & 0xff;
+
+  if (bpf < bpl)
+    return;
 
   /* move upper half down */
-  for (i = 0, j = bpl; i < bpf;) {
-    SHADE2 (d, s, j, i, r, g, b);
-  }
+  shade_pixels (scope, s, d + bpl, bpf / 4);
   /* move lower half up */
-  for (i = bpf + bpl, j = bpf; i < bpf + bpf;) {
-    SHADE2 (d, s, j, i, r, g, b);
-  }
+  shade_pixels (scope, s + bpf + bpl, d + bpf, (bpf - bpl) / 4);
 }
 
 static void
 shader_fade_and_move_vert_out (GstAudioVisualizer * scope,
     const guint8 * s, guint8 * d)
 {
-  guint i, j, k, bpf = scope->bpf;
-  guint m = scope->width / 2;
-  guint r = (scope->shade_amount >> 16) & 0xff;
-  guint g = (scope->shade_amount >> 8) & 0xff;
-  guint b = (scope->shade_amount >> 0) & 0xff;
-
-  /* move left half to the left */
-  for (j = 0, i = 4; i < bpf;) {
-    for (k = 0; k < m; k++) {
-      SHADE2 (d, s, j, i, r, g, b);
-    }
-    j += 4 * m;
-    i += 4 * m;
-  }
-  /* move right half to the right */
-  for (j = 4 * (m + 1), i = 4 * m; j < bpf;) {
-    for (k = 0; k < m; k++) {
-      SHADE2 (d, s, j, i, r, g, b);
-    }
-    j += 4 * m;
-    i += 4 * m;
+  guint i, bpf = scope->bpf;
+  guint w = scope->width;
+  guint m = w / 2;
+  guint bpl = 4 * w;
+
+  for (i = 0; i < bpf; i += bpl) {
+    /* move left half to the left */
+    shade_pixels (scope, s + i + 4, d + i, m);
+    /* move right half to the right */
+    shade_pixels (scope, s + i + 4 * m, d + i + 4 * (m + 1), w - m - 1);
   }
 }
 
@@ -334,27 +255,16 @@ static void
 shader_fade_and_move_vert_in (GstAudioVisualizer * scope,
     const guint8 * s, guint8 * d)
 {
-  guint i, j, k, bpf = scope->bpf;
-  guint m = scope->width / 2;
-  guint r = (scope->shade_amount >> 16) & 0xff;
-  guint g = (scope->shade_amount >> 8) & 0xff;
-  guint b = (scope->shade_amount >> 0) & 0xff;
-
-  /* move left half to the right */
-  for (j = 4, i = 0; j < bpf;) {
-    for (k = 0; k < m; k++) {
-      SHADE2 (d, s, j, i, r, g, b);
-    }
-    j += 4 * m;
-    i += 4 * m;
-  }
-  /* move right half to the left */
-  for (j = 4 * m, i = 4 * (m + 1); i < bpf;) {
-    for (k = 0; k < m; k++) {
-      SHADE2 (d, s, j, i, r, g, b);
-    }
-    j += 4 * m;
-    i += 4 * m;
+  guint i, bpf = scope->bpf;
+  guint w = scope->width;
+  guint m = w / 2;
+  guint bpl = 4 * w;
+
+  for (i = 0; i < bpf; i += bpl) {
+    /* move left half to the right */
+    shade_pixels (scope, s + i, d + i + 4, m);
+    /* move right half to the left */
+    shade_pixels (scope, s + i + 4 * (m + 1), d + i + 4 * m, w - m - 1);
   }
 }
 
@@ -399,6 +309,60 @@ gst_audio_visualizer_change_shader (GstAudioVisualizer * scope)
   }
 }
 
+/* asynchronous shading */
+
+static void
+gst_audio_visualizer_shade_func (gpointer data, gpointer user_data)
+{
+  GstAudioVisualizer *scope = user_data;
+  const guint8 *frame = data;
+
+  scope->shade_func (scope, frame, scope->pixelbuf);
+
+  g_mutex_lock (&scope->shade_lock);
+  scope->shade_pending = FALSE;
+  g_cond_signal (&scope->shade_cond);
+  g_mutex_unlock (&scope->shade_lock);
+}
+
+/* shades the rendered @frame into the pixel buffer in the worker thread.
+ * The worker reads a private copy of the frame, so that the output buffer
+ * is not kept referenced and downstream can write to it without a copy */
+static void
+gst_audio_visualizer_shade_async (GstAudioVisualizer * scope,
+    GstAudioVisualizerShaderFunc shader, const guint8 * frame)
+{
+  if (scope->shade_pool == NULL) {
+    scope->shade_pool = g_thread_pool_new (gst_audio_visualizer_shade_func,
+        scope, 1, FALSE, NULL);
+  }
+
+  if (scope->shade_pool == NULL) {
+    shader (scope, frame, scope->pixelbuf);
+    return;
+  }
+
+  /* the previous shading has finished reading the copy, the frame was
+   * rendered on top of its result */
+  memcpy (scope->shadebuf, frame, scope->bpf);
+
+  g_mutex_lock (&scope->shade_lock);
+  scope->shade_func = shader;
+  scope->shade_pending = TRUE;
+  g_mutex_unlock (&scope->shade_lock);
+  g_thread_pool_push (scope->shade_pool, scope->shadebuf, NULL);
+}
+
+/* waits until the pixel buffer holds the shaded previous frame */
+static void
+gst_audio_visualizer_wait_shade (GstAudioVisualizer * scope)
+{
+  g_mutex_lock (&scope->shade_lock);
+  while (scope->shade_pending)
+    g_cond_wait (&scope->shade_cond, &scope->shade_lock);
+  g_mutex_unlock (&scope->shade_lock);
+}
+
 /* base class */
 
 GType
@@ -457,6 +421,17 @@ gst_audio_visualizer_class_init (GstAudioVisualizerClass * klass)
           "Shading color to use (big-endian ARGB)", 0, G_MAXUINT32,
           DEFAULT_SHADE_AMOUNT,
           G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_ASYNC_SHADING,
+      g_param_spec_boolean ("async-shading", "async shading",
+          "Shade the background for the next frame in a worker thread while "
+          "the current frame is pushed downstream", DEFAULT_ASYNC_SHADING,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_MAX_FPS,
+      gst_param_spec_fraction ("max-fps", "max fps",
+          "Maximum number of frames rendered per second, frames above it are "
+          "dropped (0/1 = unlimited)", 0, 1, G_MAXINT, 1,
+          DEFAULT_MAX_FPS_N, DEFAULT_MAX_FPS_D,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -495,6 +470,9 @@ gst_audio_visualizer_init (GstAudioVisualizer * scope,
   scope->shader_type = DEFAULT_SHADER;
   gst_audio_visualizer_change_shader (scope);
   scope->shade_amount = DEFAULT_SHADE_AMOUNT;
+  scope->async_shading = DEFAULT_ASYNC_SHADING;
+  scope->max_fps_n = DEFAULT_MAX_FPS_N;
+  scope->max_fps_d = DEFAULT_MAX_FPS_D;
 
   /* reset the initial video state */
   scope->width = 320;
@@ -508,6 +486,8 @@ gst_audio_visualizer_init (GstAudioVisualizer * scope,
   gst_video_info_init (&scope->vinfo);
 
   g_mutex_init (&scope->config_lock);
+  g_mutex_init (&scope->shade_lock);
+  g_cond_init (&scope->shade_cond);
 }
 
 static void
@@ -524,6 +504,15 @@ gst_audio_visualizer_set_property (GObject * object, guint prop_id,
     case PROP_SHADE_AMOUNT:
       scope->shade_amount = g_value_get_uint (value);
       break;
+    case PROP_ASYNC_SHADING:
+      scope->async_shading = g_value_get_boolean (value);
+      break;
+    case PROP_MAX_FPS:
+      GST_OBJECT_LOCK (scope);
+      scope->max_fps_n = gst_value_get_fraction_numerator (value);
+      scope->max_fps_d = gst_value_get_fraction_denominator (value);
+      GST_OBJECT_UNLOCK (scope);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -543,6 +532,14 @@ gst_audio_visualizer_get_property (GObject * object, guint prop_id,
     case PROP_SHADE_AMOUNT:
       g_value_set_uint (value, scope->shade_amount);
       break;
+    case PROP_ASYNC_SHADING:
+      g_value_set_boolean (value, scope->async_shading);
+      break;
+    case PROP_MAX_FPS:
+      GST_OBJECT_LOCK (scope);
+      gst_value_set_fraction (value, scope->max_fps_n, scope->max_fps_d);
+      GST_OBJECT_UNLOCK (scope);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -554,6 +551,11 @@ gst_audio_visualizer_dispose (GObject * object)
 {
   GstAudioVisualizer *scope = GST_AUDIO_VISUALIZER (object);
 
+  if (scope->shade_pool) {
+    /* lets a pending shading finish */
+    g_thread_pool_free (scope->shade_pool, FALSE, TRUE);
+    scope->shade_pool = NULL;
+  }
   if (scope->adapter) {
     g_object_unref (scope->adapter);
     scope->adapter = NULL;
@@ -566,10 +568,22 @@ gst_audio_visualizer_dispose (GObject * object)
     g_free (scope->pixelbuf);
     scope->pixelbuf = NULL;
   }
+  if (scope->shadebuf) {
+    g_free (scope->shadebuf);
+    scope->shadebuf = NULL;
+  }
   if (scope->config_lock.p) {
     g_mutex_clear (&scope->config_lock);
     scope->config_lock.p = NULL;
   }
+  if (scope->shade_lock.p) {
+    g_mutex_clear (&scope->shade_lock);
+    scope->shade_lock.p = NULL;
+  }
+  if (scope->shade_cond.p) {
+    g_cond_clear (&scope->shade_cond);
+    scope->shade_cond.p = NULL;
+  }
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -582,6 +596,8 @@ gst_audio_visualizer_reset (GstAudioVisualizer * scope)
   GST_OBJECT_LOCK (scope);
   scope->proportion = 1.0;
   scope->earliest_time = -1;
+  scope->processed = 0;
+  scope->dropped = 0;
   GST_OBJECT_UNLOCK (scope);
 }
 
@@ -639,20 +655,25 @@ gst_audio_visualizer_src_setcaps (GstAudioVisualizer * scope, GstCaps * caps)
   scope->spf = gst_util_uint64_scale_int (GST_AUDIO_INFO_RATE (&scope->ainfo),
       scope->fps_d, scope->fps_n);
   scope->req_spf = scope->spf;
+  scope->req_hop = 0;
+
+  gst_audio_visualizer_wait_shade (scope);
 
   scope->bpf = scope->width * scope->height * 4;
 
   if (scope->pixelbuf)
     g_free (scope->pixelbuf);
   scope->pixelbuf = g_malloc0 (scope->bpf);
+  g_free (scope->shadebuf);
+  scope->shadebuf = g_malloc (scope->bpf);
 
   if (klass->setup)
     res = klass->setup (scope);
 
   GST_DEBUG_OBJECT (scope, "video: dimension %dx%d, framerate %d/%d",
       scope->width, scope->height, scope->fps_n, scope->fps_d);
-  GST_DEBUG_OBJECT (scope, "blocks: spf %u, req_spf %u",
-      scope->spf, scope->req_spf);
+  GST_DEBUG_OBJECT (scope, "blocks: spf %u, req_spf %u, req_hop %u",
+      scope->spf, scope->req_spf, scope->req_hop);
 
   res = gst_pad_set_caps (scope->srcpad, caps);
 
@@ -676,6 +697,7 @@ gst_audio_visualizer_src_negotiate (GstAudioVisualizer * scope)
   GstBufferPool *pool;
   GstStructure *config;
   guint size, min, max;
+  gint fps_n, fps_d;
 
   templ = gst_pad_get_pad_template_caps (scope->srcpad);
 
@@ -700,8 +722,18 @@ gst_audio_visualizer_src_negotiate (GstAudioVisualizer * scope)
   structure = gst_caps_get_structure (target, 0);
   gst_structure_fixate_field_nearest_int (structure, "width", scope->width);
   gst_structure_fixate_field_nearest_int (structure, "height", scope->height);
+  fps_n = scope->fps_n;
+  fps_d = scope->fps_d;
+  GST_OBJECT_LOCK (scope);
+  if (scope->max_fps_n > 0 && gst_util_fraction_compare (fps_n, fps_d,
+          scope->max_fps_n, scope->max_fps_d) > 0) {
+    /* prefer a frame rate that we do not need to drop frames from */
+    fps_n = scope->max_fps_n;
+    fps_d = scope->max_fps_d;
+  }
+  GST_OBJECT_UNLOCK (scope);
   gst_structure_fixate_field_nearest_fraction (structure, "framerate",
-      scope->fps_n, scope->fps_d);
+      fps_n, fps_d);
   target = gst_caps_fixate (target);
 
   GST_DEBUG_OBJECT (scope, "final caps are %" GST_PTR_FORMAT, target);
@@ -720,6 +752,7 @@ gst_audio_visualizer_src_negotiate (GstAudioVisualizer * scope)
   if (gst_query_get_n_allocation_pools (query) > 0) {
     /* we got configuration from our peer, parse them */
     gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    size = MAX (size, scope->bpf);
   } else {
     pool = NULL;
     size = scope->bpf;
@@ -733,7 +766,15 @@ gst_audio_visualizer_src_negotiate (GstAudioVisualizer * scope)
 
   config = gst_buffer_pool_get_config (pool);
   gst_buffer_pool_config_set_params (config, target, size, min, max);
-  gst_buffer_pool_set_config (pool, config);
+  if (!gst_buffer_pool_set_config (pool, config)) {
+    /* the peer pool does not take our configuration, use our own */
+    GST_DEBUG_OBJECT (scope, "peer pool rejected our configuration");
+    gst_object_unref (pool);
+    pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (config, target, scope->bpf, min, max);
+    gst_buffer_pool_set_config (pool, config);
+  }
 
   if (scope->pool) {
     gst_buffer_pool_set_active (scope->pool, FALSE);
@@ -744,6 +785,7 @@ gst_audio_visualizer_src_negotiate (GstAudioVisualizer * scope)
   /* and activate */
   gst_buffer_pool_set_active (pool, TRUE);
 
+  gst_query_unref (query);
   gst_caps_unref (target);
 
   return TRUE;
@@ -755,6 +797,30 @@ no_format:
   }
 }
 
+/* with max-fps below the negotiated frame rate, only the frames that a tick of
+ * the max-fps clock falls into are rendered. The frame index is derived from
+ * the running time, so the pattern does not drift. Called with the object
+ * lock. */
+static gboolean
+gst_audio_visualizer_over_max_fps (GstAudioVisualizer * scope,
+    GstClockTime rtime)
+{
+  guint64 n, num, den;
+
+  if (scope->max_fps_n <= 0 || scope->fps_n <= 0 ||
+      gst_util_fraction_compare (scope->max_fps_n, scope->max_fps_d,
+          scope->fps_n, scope->fps_d) >= 0)
+    return FALSE;
+
+  n = gst_util_uint64_scale_round (rtime, scope->fps_n,
+      GST_SECOND * scope->fps_d);
+  num = (guint64) scope->max_fps_n * scope->fps_d;
+  den = (guint64) scope->max_fps_d * scope->fps_n;
+
+  return gst_util_uint64_scale_ceil (n, num, den) ==
+      gst_util_uint64_scale_ceil (n + 1, num, den);
+}
+
 /* make sure we are negotiated */
 static GstFlowReturn
 gst_audio_visualizer_ensure_negotiated (GstAudioVisualizer * scope)
@@ -784,6 +850,7 @@ gst_audio_visualizer_chain (GstPad * pad, GstObject * parent,
   gpointer adata;
   gboolean (*render) (GstAudioVisualizer * scope, GstBuffer * audio,
       GstBuffer * video);
+  GstClockTime rtime;
   gint bps, channels, rate;
 
   scope = GST_AUDIO_VISUALIZER (parent);
@@ -839,23 +906,53 @@ gst_audio_visualizer_chain (GstPad * pad, GstObject * parent,
       ts += gst_util_uint64_scale_int (dist, GST_SECOND, rate);
     }
 
-    if (GST_CLOCK_TIME_IS_VALID (ts)) {
-      gint64 qostime;
-      gboolean need_skip;
+    rtime = GST_CLOCK_TIME_NONE;
+    if (GST_CLOCK_TIME_IS_VALID (ts))
+      rtime = gst_segment_to_running_time (&scope->segment, GST_FORMAT_TIME,
+          ts);
+
+    if (GST_CLOCK_TIME_IS_VALID (rtime)) {
+      GstClockTime qostime, earliest_time;
+      gdouble proportion;
+      gboolean need_skip, over_max_fps;
 
-      qostime =
-          gst_segment_to_running_time (&scope->segment, GST_FORMAT_TIME, ts) +
-          scope->frame_duration;
+      qostime = rtime + scope->frame_duration;
 
       GST_OBJECT_LOCK (scope);
       /* check for QoS, don't compute buffers that are known to be late */
-      need_skip = scope->earliest_time != -1 && qostime <= scope->earliest_time;
+      earliest_time = scope->earliest_time;
+      proportion = scope->proportion;
+      need_skip = earliest_time != -1 && qostime <= earliest_time;
+      over_max_fps = gst_audio_visualizer_over_max_fps (scope, rtime);
       GST_OBJECT_UNLOCK (scope);
 
       if (need_skip) {
-        GST_WARNING_OBJECT (scope,
+        GstMessage *qos_msg;
+        guint64 processed, dropped;
+
+        GST_DEBUG_OBJECT (scope,
             "QoS: skip ts: %" GST_TIME_FORMAT ", earliest: %" GST_TIME_FORMAT,
-            GST_TIME_ARGS (qostime), GST_TIME_ARGS (scope->earliest_time));
+            GST_TIME_ARGS (qostime), GST_TIME_ARGS (earliest_time));
+
+        GST_OBJECT_LOCK (scope);
+        scope->dropped++;
+        processed = scope->processed;
+        dropped = scope->dropped;
+        GST_OBJECT_UNLOCK (scope);
+
+        qos_msg = gst_message_new_qos (GST_OBJECT (scope), FALSE, rtime,
+            gst_segment_to_stream_time (&scope->segment, GST_FORMAT_TIME, ts),
+            ts, scope->frame_duration);
+        gst_message_set_qos_values (qos_msg,
+            GST_CLOCK_DIFF (qostime, earliest_time), proportion, 1000000);
+        gst_message_set_qos_stats (qos_msg, GST_FORMAT_BUFFERS, processed,
+            dropped);
+        gst_element_post_message (GST_ELEMENT (scope), qos_msg);
+        goto skip;
+      }
+      if (over_max_fps) {
+        GST_LOG_OBJECT (scope, "skip ts: %" GST_TIME_FORMAT " for max-fps",
+            GST_TIME_ARGS (ts));
         goto skip;
       }
     }
@@ -877,6 +974,7 @@ gst_audio_visualizer_chain (GstPad * pad, GstObject * parent,
     GST_BUFFER_DURATION (outbuf) = scope->frame_duration;
 
     gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
+    gst_audio_visualizer_wait_shade (scope);
     if (scope->shader) {
       memcpy (map.data, scope->pixelbuf, scope->bpf);
     } else {
@@ -898,7 +996,11 @@ gst_audio_visualizer_chain (GstPad * pad, GstObject * parent,
       } else {
         /* run various post processing (shading and geometri transformation */
         if (scope->shader) {
-          scope->shader (scope, map.data, scope->pixelbuf);
+          /* overlap the shading with pushing the frame downstream */
+          if (scope->async_shading)
+            gst_audio_visualizer_shade_async (scope, scope->shader, map.data);
+          else
+            scope->shader (scope, map.data, scope->pixelbuf);
         }
       }
     }
@@ -906,6 +1008,10 @@ gst_audio_visualizer_chain (GstPad * pad, GstObject * parent,
     gst_buffer_unmap (outbuf, &map);
     gst_buffer_resize (outbuf, 0, scope->bpf);
 
+    GST_OBJECT_LOCK (scope);
+    scope->processed++;
+    GST_OBJECT_UNLOCK (scope);
+
     g_mutex_unlock (&scope->config_lock);
     ret = gst_pad_push (scope->srcpad, outbuf);
     outbuf = NULL;
@@ -915,8 +1021,16 @@ gst_audio_visualizer_chain (GstPad * pad, GstObject * parent,
     /* recheck as the value could have changed */
     sbpf = scope->req_spf * channels * sizeof (gint16);
     GST_LOG_OBJECT (scope, "avail: %u, bpf: %u", avail, sbpf);
-    /* we want to take less or more, depending on spf : req_spf */
-    if (avail - sbpf >= sbpf) {
+    /* overlapping frames: advance by the hop and keep the rest of the
+     * window for the next frame */
+    if (scope->req_hop > 0) {
+      if (avail >= sbpf) {
+        gst_adapter_flush (scope->adapter,
+            MIN (scope->req_hop, scope->req_spf) * channels * sizeof (gint16));
+        gst_adapter_unmap (scope->adapter);
+      }
+    } else if (avail - sbpf >= sbpf) {
+      /* we want to take less or more, depending on spf : req_spf */
       gst_adapter_flush (scope->adapter, sbpf);
       gst_adapter_unmap (scope->adapter);
     } else if (avail >= sbpf) {
@@ -958,11 +1072,14 @@ gst_audio_visualizer_src_event (GstPad * pad, GstObject * parent,
       /* save stuff for the _chain() function */
       GST_OBJECT_LOCK (scope);
       scope->proportion = proportion;
-      if (diff >= 0)
+      if (diff >= 0) {
         /* we're late, this is a good estimate for next displayable
          * frame (see part-qos.txt) */
-        scope->earliest_time = timestamp + 2 * diff + scope->frame_duration;
-      else
+        scope->earliest_time = timestamp + 2 * diff;
+        /* not known before the caps are negotiated */
+        if (GST_CLOCK_TIME_IS_VALID (scope->frame_duration))
+          scope->earliest_time += scope->frame_duration;
+      } else
         scope->earliest_time = timestamp + diff;
       GST_OBJECT_UNLOCK (scope);
 
@@ -1119,6 +1236,7 @@ gst_audio_visualizer_change_state (GstElement * element,
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_audio_visualizer_wait_shade (scope);
       if (scope->pool) {
         gst_buffer_pool_set_active (scope->pool, FALSE);
         gst_object_replace ((GstObject **) & scope->pool, NULL);
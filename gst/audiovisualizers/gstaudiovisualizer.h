@@ -83,8 +83,19 @@ struct _GstAudioVisualizer
   GstAudioVisualizerShaderFunc shader;
   guint32 shade_amount;
 
+  /* shading of the previous frame running in a worker thread */
+  gboolean async_shading;
+  GThreadPool *shade_pool;
+  GstAudioVisualizerShaderFunc shade_func;
+  guint8 *shadebuf;             /* copy of the frame being shaded */
+  GMutex shade_lock;
+  GCond shade_cond;
+  gboolean shade_pending;
+
   guint spf;                    /* samples per video frame */
   guint req_spf;                /* min samples per frame wanted by the subclass */
+  guint req_hop;                /* samples to advance per frame, at most req_spf;
+                                 * 0 to take req_spf samples per frame */
 
   /* video state */
   GstVideoInfo vinfo;
@@ -104,6 +115,8 @@ struct _GstAudioVisualizer
   /* QoS stuff *//* with LOCK */
   gdouble proportion;
   GstClockTime earliest_time;
+  gint max_fps_n, max_fps_d;
+  guint64 processed, dropped;
   
   GstSegment segment;
 };
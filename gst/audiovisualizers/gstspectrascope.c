@@ -24,17 +24,33 @@
  * Spectrascope is a simple spectrum visualisation element. It renders the
  * frequency spectrum as a series of bars.
  *
+ * The frequency axis is linear by default and logarithmic with
+ * #GstSpectraScope:log-frequency. With #GstSpectraScope:split-channels each
+ * channel gets its own horizontal band in the frame instead of drawing the
+ * spectrum of the downmix.
+ *
+ * The analysis window is twice the width of the frame in samples. By default
+ * every frame takes a new window from the stream. With
+ * #GstSpectraScope:overlap the windows advance by one video frame instead, so
+ * that there is one spectrum per output frame and windows longer than a
+ * video frame overlap.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
  * gst-launch audiotestsrc ! audioconvert ! spectrascope ! ximagesink
  * ]|
+ * |[
+ * gst-launch filesrc location=surround.wav ! wavparse ! audioconvert !
+ *   spectrascope split-channels=true log-frequency=true ! ximagesink
+ * ]|
  * </refsect2>
  */
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 #include <stdlib.h>
+#include <math.h>
 
 #include "gstspectrascope.h"
 
@@ -56,14 +72,25 @@ GST_STATIC_PAD_TEMPLATE ("sink",
     GST_STATIC_CAPS ("audio/x-raw, "
         "format = (string) " GST_AUDIO_NE (S16) ", "
         "layout = (string) interleaved, "
-        "rate = (int) [ 8000, 96000 ], "
-        "channels = (int) 2, " "channel-mask = (bitmask) 0x3")
+        "rate = (int) [ 8000, 96000 ], " "channels = (int) [ 1, 64 ]")
     );
 
 
 GST_DEBUG_CATEGORY_STATIC (spectra_scope_debug);
 #define GST_CAT_DEFAULT spectra_scope_debug
 
+enum
+{
+  PROP_0,
+  PROP_LOG_FREQUENCY,
+  PROP_SPLIT_CHANNELS,
+  PROP_OVERLAP
+};
+
+static void gst_spectra_scope_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_spectra_scope_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 static void gst_spectra_scope_finalize (GObject * object);
 
 static gboolean gst_spectra_scope_setup (GstAudioVisualizer * scope);
@@ -80,8 +107,25 @@ gst_spectra_scope_class_init (GstSpectraScopeClass * g_class)
   GstElementClass *element_class = (GstElementClass *) g_class;
   GstAudioVisualizerClass *scope_class = (GstAudioVisualizerClass *) g_class;
 
+  gobject_class->set_property = gst_spectra_scope_set_property;
+  gobject_class->get_property = gst_spectra_scope_get_property;
   gobject_class->finalize = gst_spectra_scope_finalize;
 
+  g_object_class_install_property (gobject_class, PROP_LOG_FREQUENCY,
+      g_param_spec_boolean ("log-frequency", "Log frequency",
+          "Use a logarithmic frequency axis", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_SPLIT_CHANNELS,
+      g_param_spec_boolean ("split-channels", "Split channels",
+          "Draw the spectrum of every channel in its own band instead of the "
+          "spectrum of the downmix", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_OVERLAP,
+      g_param_spec_boolean ("overlap", "Overlap",
+          "Advance the analysis window by one video frame, overlapping the "
+          "previous window when it is longer than a frame", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_details_simple (element_class,
       "Frequency spectrum scope", "Visualization",
       "Simple frequency spectrum scope", "Stefan Kost <ensonic@users.sf.net>");
@@ -102,40 +146,152 @@ gst_spectra_scope_init (GstSpectraScope * scope)
 }
 
 static void
-gst_spectra_scope_finalize (GObject * object)
+gst_spectra_scope_free (GstSpectraScope * scope)
 {
-  GstSpectraScope *scope = GST_SPECTRA_SCOPE (object);
-
   if (scope->fft_ctx) {
-    gst_fft_s16_free (scope->fft_ctx);
+    gst_fft_f32_free (scope->fft_ctx);
     scope->fft_ctx = NULL;
   }
-  if (scope->freq_data) {
-    g_free (scope->freq_data);
-    scope->freq_data = NULL;
-  }
+  g_free (scope->freq_data);
+  scope->freq_data = NULL;
+  g_free (scope->time_data);
+  scope->time_data = NULL;
+  g_free (scope->window);
+  scope->window = NULL;
+  g_free (scope->col_bins);
+  scope->col_bins = NULL;
+}
+
+static void
+gst_spectra_scope_finalize (GObject * object)
+{
+  GstSpectraScope *scope = GST_SPECTRA_SCOPE (object);
+
+  gst_spectra_scope_free (scope);
 
   G_OBJECT_CLASS (gst_spectra_scope_parent_class)->finalize (object);
 }
 
+/* maps the columns to ranges of fft bins, column x shows the loudest of the
+ * bins col_bins[x] .. col_bins[x + 1] - 1 */
+static void
+gst_spectra_scope_update_bins (GstSpectraScope * scope)
+{
+  GstAudioVisualizer *bscope = GST_AUDIO_VISUALIZER (scope);
+  guint w = bscope->width;
+  guint x;
+
+  if (scope->log_frequency) {
+    /* spread the bins 1 .. w over the columns so that every column covers
+     * the same frequency ratio */
+    for (x = 0; x <= w; x++)
+      scope->col_bins[x] = (guint) pow (w + 1, (gdouble) x / w);
+  } else {
+    for (x = 0; x <= w; x++)
+      scope->col_bins[x] = x + 1;
+  }
+  scope->col_bins[w] = w + 1;
+}
+
+/* with overlap every window starts one video frame after the previous one,
+ * the base class keeps the rest of it in the adapter */
+static void
+gst_spectra_scope_update_hop (GstSpectraScope * scope)
+{
+  GstAudioVisualizer *bscope = GST_AUDIO_VISUALIZER (scope);
+
+  if (scope->overlap)
+    bscope->req_hop = MIN (bscope->spf, bscope->req_spf);
+  else
+    bscope->req_hop = 0;
+}
+
 static gboolean
 gst_spectra_scope_setup (GstAudioVisualizer * bscope)
 {
   GstSpectraScope *scope = GST_SPECTRA_SCOPE (bscope);
   guint num_freq = bscope->width + 1;
+  guint i, n;
 
-  if (scope->fft_ctx)
-    gst_fft_s16_free (scope->fft_ctx);
-  g_free (scope->freq_data);
+  gst_spectra_scope_free (scope);
 
   /* we'd need this amount of samples per render() call */
-  bscope->req_spf = num_freq * 2 - 2;
-  scope->fft_ctx = gst_fft_s16_new (bscope->req_spf, FALSE);
-  scope->freq_data = g_new (GstFFTS16Complex, num_freq);
+  bscope->req_spf = n = num_freq * 2 - 2;
+  scope->fft_ctx = gst_fft_f32_new (n, FALSE);
+  scope->freq_data = g_new (GstFFTF32Complex, num_freq);
+  scope->time_data = g_new (gfloat, n);
+
+  /* the hamming window only depends on the fft length, compute it once.
+   * It also scales the unnormalized float fft to the range the bars are
+   * drawn in */
+  scope->window = g_new (gfloat, n);
+  for (i = 0; i < n; i++) {
+    scope->window[i] = (0.53836 - 0.46164 * cos (2.0 * M_PI * i / n)) /
+        (512.0 * n);
+  }
+
+  scope->col_bins = g_new (guint, bscope->width + 1);
+  gst_spectra_scope_update_bins (scope);
+  gst_spectra_scope_update_hop (scope);
 
   return TRUE;
 }
 
+static void
+gst_spectra_scope_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSpectraScope *scope = GST_SPECTRA_SCOPE (object);
+  GstAudioVisualizer *bscope = GST_AUDIO_VISUALIZER (object);
+
+  switch (prop_id) {
+    case PROP_LOG_FREQUENCY:
+      g_mutex_lock (&bscope->config_lock);
+      scope->log_frequency = g_value_get_boolean (value);
+      if (scope->col_bins)
+        gst_spectra_scope_update_bins (scope);
+      g_mutex_unlock (&bscope->config_lock);
+      break;
+    case PROP_SPLIT_CHANNELS:
+      g_mutex_lock (&bscope->config_lock);
+      scope->split_channels = g_value_get_boolean (value);
+      g_mutex_unlock (&bscope->config_lock);
+      break;
+    case PROP_OVERLAP:
+      g_mutex_lock (&bscope->config_lock);
+      scope->overlap = g_value_get_boolean (value);
+      if (scope->fft_ctx)
+        gst_spectra_scope_update_hop (scope);
+      g_mutex_unlock (&bscope->config_lock);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_spectra_scope_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSpectraScope *scope = GST_SPECTRA_SCOPE (object);
+
+  switch (prop_id) {
+    case PROP_LOG_FREQUENCY:
+      g_value_set_boolean (value, scope->log_frequency);
+      break;
+    case PROP_SPLIT_CHANNELS:
+      g_value_set_boolean (value, scope->split_channels);
+      break;
+    case PROP_OVERLAP:
+      g_value_set_boolean (value, scope->overlap);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static inline void
 add_pixel (guint32 * _p, guint32 _c)
 {
@@ -160,58 +316,65 @@ add_pixel (guint32 * _p, guint32 _c)
     p[3] = 255;
 }
 
-static gboolean
-gst_spectra_scope_render (GstAudioVisualizer * bscope, GstBuffer * audio,
-    GstBuffer * video)
+/* converts one channel, or the downmix of all channels when @channel is -1,
+ * to float and applies the window in the same pass */
+static void
+gst_spectra_scope_load (GstSpectraScope * scope, const gint16 * adata,
+    guint channels, gint channel, guint num_samples)
 {
-  GstSpectraScope *scope = GST_SPECTRA_SCOPE (bscope);
-  gint16 *mono_adata;
-  GstFFTS16Complex *fdata = scope->freq_data;
-  guint x, y, off;
-  guint l, h = bscope->height - 1;
-  gfloat fr, fi;
-  guint w = bscope->width;
-  GstMapInfo amap, vmap;
-  guint32 *vdata;
-  gint channels;
-
-  gst_buffer_map (audio, &amap, GST_MAP_READ);
-  gst_buffer_map (video, &vmap, GST_MAP_WRITE);
-  vdata = (guint32 *) vmap.data;
-
-  channels = GST_AUDIO_INFO_CHANNELS (&bscope->ainfo);
-
-  mono_adata = (gint16 *) g_memdup (amap.data, amap.size);
+  GstAudioVisualizer *bscope = GST_AUDIO_VISUALIZER (scope);
+  gfloat *tdata = scope->time_data;
+  const gfloat *window = scope->window;
+  guint i, c;
 
-  if (channels > 1) {
-    guint ch = channels;
-    guint num_samples = amap.size / (ch * sizeof (gint16));
-    guint i, c, v, s = 0;
+  if (channel >= 0) {
+    adata += channel;
+    for (i = 0; i < num_samples; i++) {
+      tdata[i] = window[i] * adata[0];
+      adata += channels;
+    }
+  } else {
+    gfloat norm = 1.0 / channels;
 
-    /* deinterleave and mixdown adata */
     for (i = 0; i < num_samples; i++) {
-      v = 0;
-      for (c = 0; c < ch; c++) {
-        v += mono_adata[s++];
-      }
-      mono_adata[i] = v / ch;
+      gint v = 0;
+
+      for (c = 0; c < channels; c++)
+        v += *adata++;
+      tdata[i] = window[i] * norm * v;
     }
   }
+  for (; i < bscope->req_spf; i++)
+    tdata[i] = 0.0;
+}
 
-  /* run fft */
-  gst_fft_s16_window (scope->fft_ctx, mono_adata, GST_FFT_WINDOW_HAMMING);
-  gst_fft_s16_fft (scope->fft_ctx, mono_adata, fdata);
-  g_free (mono_adata);
-
-  /* draw lines */
-  for (x = 0; x < bscope->width; x++) {
-    /* figure out the range so that we don't need to clip,
-     * or even better do a log mapping? */
-    fr = (gfloat) fdata[1 + x].r / 512.0;
-    fi = (gfloat) fdata[1 + x].i / 512.0;
-    y = (guint) (h * sqrt (fr * fr + fi * fi));
-    if (y > h)
+/* draws the bars of the current spectrum into a band of @h lines */
+static void
+gst_spectra_scope_draw (GstSpectraScope * scope, guint32 * vdata, guint h)
+{
+  GstAudioVisualizer *bscope = GST_AUDIO_VISUALIZER (scope);
+  GstFFTF32Complex *fdata = scope->freq_data;
+  guint *col_bins = scope->col_bins;
+  guint x, y, b, off;
+  guint l, w = bscope->width;
+  gfloat mag, m;
+
+  h--;
+  for (x = 0; x < w; x++) {
+    guint end = MAX (col_bins[x] + 1, col_bins[x + 1]);
+
+    /* the loudest bin decides, a column that covers less than a bin shows
+     * the bin it starts in */
+    mag = 0.0;
+    for (b = col_bins[x]; b < end; b++) {
+      m = fdata[b].r * fdata[b].r + fdata[b].i * fdata[b].i;
+      if (m > mag)
+        mag = m;
+    }
+    if (mag >= 1.0)
       y = h;
+    else
+      y = (guint) (h * sqrtf (mag));
     y = h - y;
     off = (y * w) + x;
     vdata[off] = 0x00FFFFFF;
@@ -222,6 +385,41 @@ gst_spectra_scope_render (GstAudioVisualizer * bscope, GstBuffer * audio,
     /* ensure bottom line is full bright (especially in move-up mode) */
     add_pixel (&vdata[off], 0x007F7F7F);
   }
+}
+
+static gboolean
+gst_spectra_scope_render (GstAudioVisualizer * bscope, GstBuffer * audio,
+    GstBuffer * video)
+{
+  GstSpectraScope *scope = GST_SPECTRA_SCOPE (bscope);
+  GstMapInfo amap, vmap;
+  guint32 *vdata;
+  gint16 *adata;
+  guint channels, num_samples, n_bands, band_height, i;
+
+  gst_buffer_map (audio, &amap, GST_MAP_READ);
+  gst_buffer_map (video, &vmap, GST_MAP_WRITE);
+  adata = (gint16 *) amap.data;
+  vdata = (guint32 *) vmap.data;
+
+  channels = GST_AUDIO_INFO_CHANNELS (&bscope->ainfo);
+  num_samples = MIN (amap.size / (channels * sizeof (gint16)),
+      bscope->req_spf);
+
+  if (scope->split_channels)
+    n_bands = MIN (channels, bscope->height);
+  else
+    n_bands = 1;
+  band_height = bscope->height / n_bands;
+
+  for (i = 0; i < n_bands; i++) {
+    gst_spectra_scope_load (scope, adata, channels,
+        scope->split_channels ? i : -1, num_samples);
+    gst_fft_f32_fft (scope->fft_ctx, scope->time_data, scope->freq_data);
+    gst_spectra_scope_draw (scope, vdata + i * band_height * bscope->width,
+        band_height);
+  }
+
   gst_buffer_unmap (video, &vmap);
   gst_buffer_unmap (audio, &amap);
   return TRUE;
@@ -23,7 +23,7 @@
 #define __GST_SPECTRA_SCOPE_H__
 
 #include "gstaudiovisualizer.h"
-#include <gst/fft/gstffts16.h>
+#include <gst/fft/gstfftf32.h>
 
 G_BEGIN_DECLS
 #define GST_TYPE_SPECTRA_SCOPE            (gst_spectra_scope_get_type())
@@ -38,8 +38,16 @@ struct _GstSpectraScope
 {
   GstAudioVisualizer parent;
 
-  GstFFTS16 *fft_ctx;
-  GstFFTS16Complex *freq_data;
+  /* properties */
+  gboolean log_frequency;
+  gboolean split_channels;
+  gboolean overlap;
+
+  GstFFTF32 *fft_ctx;
+  GstFFTF32Complex *freq_data;
+  gfloat *time_data;
+  gfloat *window;               /* cached window, includes the scaling */
+  guint *col_bins;              /* first fft bin of each column, width + 1 */
 };
 
 struct _GstSpectraScopeClass
@@ -28,7 +28,17 @@
  * gst-launch -v videotestsrc ! coloreffects preset=heat ! ffmpegcolorspace !
  *     autovideosink
  * ]| This pipeline shows the effect of coloreffects on a test stream.
+ * |[
+ * gst-launch -v videotestsrc ! coloreffects lut-file=grade.cube !
+ *     ffmpegcolorspace ! autovideosink
+ * ]| This pipeline grades a test stream with a 3D lookup table in the
+ * .cube format.
  * </refsect2>
+ *
+ * Colours are mapped with a 1D table where that is exact (the presets on
+ * RGB input, the luma presets on AYUV input), everything else goes through
+ * a 3D table sampled in the colour space of the stream, so that every
+ * pixel costs a single interpolated lookup.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -36,9 +46,31 @@
 #endif
 
 #include <gst/video/video.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <gst/bandpool/gstbandpool.h>
+
 #include "gstcoloreffects.h"
+#include "gstcoloreffectscube.h"
 
 #define DEFAULT_PROP_PRESET GST_COLOR_EFFECTS_PRESET_NONE
+#define DEFAULT_PROP_LUT_FILE NULL
+#define DEFAULT_PROP_N_THREADS 0
+
+/* grid size of the 3D table compiled from the presets */
+#define DEFAULT_LUT_SIZE 33
+/* .cube files with a finer grid are resampled to this */
+#define MAX_LUT_SIZE 65
+
+/* don't split frames into bands of fewer lines than this */
+#define MIN_BAND_HEIGHT 16
+
+typedef struct
+{
+  GstVideoFrame *frame;
+  gint y_start, y_end;
+} GstColorEffectsBand;
 
 GST_DEBUG_CATEGORY_STATIC (coloreffects_debug);
 #define GST_CAT_DEFAULT (coloreffects_debug)
@@ -46,7 +78,9 @@ GST_DEBUG_CATEGORY_STATIC (coloreffects_debug);
 enum
 {
   PROP_0,
-  PROP_PRESET
+  PROP_PRESET,
+  PROP_LUT_FILE,
+  PROP_N_THREADS
 };
 
 #define gst_color_effects_parent_class parent_class
@@ -94,9 +128,8 @@ gst_color_effects_preset_get_type (void)
 }
 
 /*
- * Currently hardcoded tables, in the future may be nice to load them
- * from a file or just leave these as default presets and add a
- * property to load a custom one from file
+ * Hardcoded preset tables, custom 3D tables can be loaded from a .cube
+ * file with the lut-file property
  */
 
 /*
@@ -297,34 +330,171 @@ static const gint cog_rgb_to_ycbcr_matrix_8bit_sdtv[] = {
 
 #define APPLY_MATRIX(m,o,v1,v2,v3) ((m[o*4] * v1 + m[o*4+1] * v2 + \
     m[o*4+2] * v3 + m[o*4+3]) >> 8)
+#define APPLY_MATRIX_F(m,o,v1,v2,v3) ((m[o*4] * (v1) + m[o*4+1] * (v2) + \
+    m[o*4+2] * (v3) + m[o*4+3]) / 256.0f)
+
+/* trilinear lookup in the loaded .cube table, rgb in the 0-255 range */
+static void
+gst_color_effects_sample_cube (GstColorEffects * filter, gfloat * rgb)
+{
+  gint n = filter->cube_size;
+  gint idx[3], c, corner;
+  gfloat f[3], out[3] = { 0.0, 0.0, 0.0 };
+
+  for (c = 0; c < 3; c++) {
+    gfloat x = (rgb[c] / 255.0f - filter->cube_min[c]) /
+        (filter->cube_max[c] - filter->cube_min[c]) * (n - 1);
+
+    x = CLAMP (x, 0.0f, n - 1);
+    idx[c] = MIN ((gint) x, n - 2);
+    f[c] = x - idx[c];
+  }
+
+  for (corner = 0; corner < 8; corner++) {
+    gint i0 = corner & 1, i1 = (corner >> 1) & 1, i2 = (corner >> 2) & 1;
+    gfloat w = (i0 ? f[0] : 1.0f - f[0]) * (i1 ? f[1] : 1.0f - f[1]) *
+        (i2 ? f[2] : 1.0f - f[2]);
+    const gfloat *p = filter->cube +
+        (((idx[2] + i2) * n + idx[1] + i1) * n + idx[0] + i0) * 3;
+
+    out[0] += w * p[0];
+    out[1] += w * p[1];
+    out[2] += w * p[2];
+  }
+
+  for (c = 0; c < 3; c++)
+    rgb[c] = out[c] * 255.0f;
+}
+
+static gfloat
+gst_color_effects_table_lerp (const guint8 * table, gfloat x, gint c)
+{
+  gint i = CLAMP ((gint) x, 0, 254);
+  gfloat f = CLAMP (x - i, 0.0f, 1.0f);
+
+  return table[i * 3 + c] * (1.0f - f) + table[(i + 1) * 3 + c] * f;
+}
+
+/* the colour mapping of the current settings, rgb in the 0-255 range */
+static void
+gst_color_effects_map_rgb (GstColorEffects * filter, gfloat * rgb)
+{
+  gint c;
+
+  if (filter->cube) {
+    gst_color_effects_sample_cube (filter, rgb);
+  } else if (filter->map_luma) {
+    gfloat luma = 0.2126f * rgb[0] + 0.7152f * rgb[1] + 0.0722f * rgb[2];
+
+    for (c = 0; c < 3; c++)
+      rgb[c] = gst_color_effects_table_lerp (filter->table, luma, c);
+  } else {
+    for (c = 0; c < 3; c++)
+      rgb[c] = gst_color_effects_table_lerp (filter->table, rgb[c], c);
+  }
+}
+
+/*
+ * Samples the colour mapping on a size^3 grid of the frame's colour space
+ * (RGB or YCbCr, first component varying fastest), so that processing a
+ * pixel is a single interpolated lookup whatever the mapping is.
+ */
+static void
+gst_color_effects_compile_lut (GstColorEffects * filter, gboolean yuv)
+{
+  gint n, i, k0, k1, k2, c;
+  guint8 *p;
+
+  if (filter->cube)
+    n = CLAMP (filter->cube_size, 2, MAX_LUT_SIZE);
+  else
+    n = DEFAULT_LUT_SIZE;
+
+  filter->lut_size = n;
+  filter->lut = p = g_malloc (n * n * n * 3);
+
+  for (k2 = 0; k2 < n; k2++) {
+    for (k1 = 0; k1 < n; k1++) {
+      for (k0 = 0; k0 < n; k0++) {
+        gfloat v[3], rgb[3];
+
+        v[0] = k0 * 255.0f / (n - 1);
+        v[1] = k1 * 255.0f / (n - 1);
+        v[2] = k2 * 255.0f / (n - 1);
+
+        if (yuv) {
+          for (c = 0; c < 3; c++) {
+            rgb[c] = APPLY_MATRIX_F (cog_ycbcr_to_rgb_matrix_8bit_sdtv, c,
+                v[0], v[1], v[2]);
+            rgb[c] = CLAMP (rgb[c], 0.0f, 255.0f);
+          }
+        } else {
+          memcpy (rgb, v, sizeof (rgb));
+        }
+
+        gst_color_effects_map_rgb (filter, rgb);
+
+        for (c = 0; c < 3; c++) {
+          if (yuv)
+            v[c] = APPLY_MATRIX_F (cog_rgb_to_ycbcr_matrix_8bit_sdtv, c,
+                rgb[0], rgb[1], rgb[2]);
+          else
+            v[c] = rgb[c];
+          *p++ = (guint8) (CLAMP (v[c], 0.0f, 255.0f) + 0.5f);
+        }
+      }
+    }
+  }
+
+  /* cell and position inside the cell (in 1/256) of each 8 bit value */
+  for (i = 0; i < 256; i++) {
+    gint pos = (i * (n - 1) * 256 + 127) / 255;
+    gint cell = pos >> 8;
+    gint frac = pos & 255;
+
+    if (cell >= n - 1) {
+      cell = n - 2;
+      frac = 256;
+    }
+
+    filter->lut_offset[0][i] = cell * 3;
+    filter->lut_offset[1][i] = cell * 3 * n;
+    filter->lut_offset[2][i] = cell * 3 * n * n;
+    filter->lut_frac[i] = frac;
+  }
+
+  GST_DEBUG_OBJECT (filter, "compiled %dx%dx%d %s lookup table", n, n, n,
+      yuv ? "YCbCr" : "RGB");
+}
 
 static void
 gst_color_effects_transform_rgb (GstColorEffects * filter,
-    GstVideoFrame * frame)
+    GstVideoFrame * frame, gint y_start, gint y_end)
 {
   gint i, j;
-  gint width, height;
+  gint width;
   gint pixel_stride, row_stride, row_wrap;
   guint32 r, g, b;
   guint32 luma;
   gint offsets[3];
   guint8 *data;
 
-  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
   offsets[0] = GST_VIDEO_FRAME_COMP_POFFSET (frame, 0);
   offsets[1] = GST_VIDEO_FRAME_COMP_POFFSET (frame, 1);
   offsets[2] = GST_VIDEO_FRAME_COMP_POFFSET (frame, 2);
 
   width = GST_VIDEO_FRAME_WIDTH (frame);
-  height = GST_VIDEO_FRAME_HEIGHT (frame);
 
   row_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
   pixel_stride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 0);
   row_wrap = row_stride - pixel_stride * width;
 
+  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+  data += y_start * row_stride;
+
   /* transform */
 
-  for (i = 0; i < height; i++) {
+  for (i = y_start; i < y_end; i++) {
     for (j = 0; j < width; j++) {
       r = data[offsets[0]];
       g = data[offsets[1]];
@@ -357,102 +527,250 @@ gst_color_effects_transform_rgb (GstColorEffects * filter,
 }
 
 static void
-gst_color_effects_transform_ayuv (GstColorEffects * filter,
-    GstVideoFrame * frame)
+gst_color_effects_transform_ayuv_luma (GstColorEffects * filter,
+    GstVideoFrame * frame, gint y_start, gint y_end)
 {
   gint i, j;
-  gint width, height;
+  gint width;
   gint pixel_stride, row_stride, row_wrap;
-  gint r, g, b;
-  gint y, u, v;
+  gint y;
   gint offsets[3];
   guint8 *data;
 
-  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
   offsets[0] = GST_VIDEO_FRAME_COMP_POFFSET (frame, 0);
   offsets[1] = GST_VIDEO_FRAME_COMP_POFFSET (frame, 1);
   offsets[2] = GST_VIDEO_FRAME_COMP_POFFSET (frame, 2);
 
   width = GST_VIDEO_FRAME_WIDTH (frame);
-  height = GST_VIDEO_FRAME_HEIGHT (frame);
 
   row_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
   pixel_stride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 0);
   row_wrap = row_stride - pixel_stride * width;
 
-  for (i = 0; i < height; i++) {
+  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+  data += y_start * row_stride;
+
+  for (i = y_start; i < y_end; i++) {
     for (j = 0; j < width; j++) {
-      y = data[offsets[0]];
-      u = data[offsets[1]];
-      v = data[offsets[2]];
+      /* map luma to lookup table, already converted to YCbCr */
+      /* src.luma |-> yuv_table[luma].yuv */
+      y = data[offsets[0]] * 3;
 
-      if (filter->map_luma) {
-        /* map luma to lookup table */
-        /* src.luma |-> table[luma].rgb */
-        y *= 3;
-        r = filter->table[y];
-        g = filter->table[y + 1];
-        b = filter->table[y + 2];
-
-        y = APPLY_MATRIX (cog_rgb_to_ycbcr_matrix_8bit_sdtv, 0, r, g, b);
-        u = APPLY_MATRIX (cog_rgb_to_ycbcr_matrix_8bit_sdtv, 1, r, g, b);
-        v = APPLY_MATRIX (cog_rgb_to_ycbcr_matrix_8bit_sdtv, 2, r, g, b);
-
-        data[offsets[0]] = CLAMP (y, 0, 255);
-        data[offsets[1]] = CLAMP (u, 0, 255);
-        data[offsets[2]] = CLAMP (v, 0, 255);
-      } else {
-        r = APPLY_MATRIX (cog_ycbcr_to_rgb_matrix_8bit_sdtv, 0, y, u, v);
-        g = APPLY_MATRIX (cog_ycbcr_to_rgb_matrix_8bit_sdtv, 1, y, u, v);
-        b = APPLY_MATRIX (cog_ycbcr_to_rgb_matrix_8bit_sdtv, 2, y, u, v);
+      data[offsets[0]] = filter->yuv_table[y];
+      data[offsets[1]] = filter->yuv_table[y + 1];
+      data[offsets[2]] = filter->yuv_table[y + 2];
+
+      data += pixel_stride;
+    }
+    data += row_wrap;
+  }
+}
+
+static void
+gst_color_effects_transform_lut (GstColorEffects * filter,
+    GstVideoFrame * frame, gint y_start, gint y_end)
+{
+  gint i, j, c;
+  gint width, n;
+  gint pixel_stride, row_stride, row_wrap;
+  gint d0, d1, d2;
+  gint offsets[3];
+  const guint8 *lut = filter->lut;
+  const guint16 *frac = filter->lut_frac;
+  guint8 *data;
 
-        r = CLAMP (r, 0, 255);
-        g = CLAMP (g, 0, 255);
-        b = CLAMP (b, 0, 255);
+  offsets[0] = GST_VIDEO_FRAME_COMP_POFFSET (frame, 0);
+  offsets[1] = GST_VIDEO_FRAME_COMP_POFFSET (frame, 1);
+  offsets[2] = GST_VIDEO_FRAME_COMP_POFFSET (frame, 2);
 
-        /* map each color component to the correspondent lut color */
-        /* src.r |-> table[r].r */
-        /* src.g |-> table[g].g */
-        /* src.b |-> table[b].b */
-        r = filter->table[r * 3];
-        g = filter->table[g * 3 + 1];
-        b = filter->table[b * 3 + 2];
+  width = GST_VIDEO_FRAME_WIDTH (frame);
 
-        y = APPLY_MATRIX (cog_rgb_to_ycbcr_matrix_8bit_sdtv, 0, r, g, b);
-        u = APPLY_MATRIX (cog_rgb_to_ycbcr_matrix_8bit_sdtv, 1, r, g, b);
-        v = APPLY_MATRIX (cog_rgb_to_ycbcr_matrix_8bit_sdtv, 2, r, g, b);
+  row_stride = GST_VIDEO_FRAME_PLANE_STRIDE (frame, 0);
+  pixel_stride = GST_VIDEO_FRAME_COMP_PSTRIDE (frame, 0);
+  row_wrap = row_stride - pixel_stride * width;
+
+  /* distance to the next grid point along each axis */
+  n = filter->lut_size;
+  d0 = 3;
+  d1 = 3 * n;
+  d2 = 3 * n * n;
+
+  data = GST_VIDEO_FRAME_PLANE_DATA (frame, 0);
+  data += y_start * row_stride;
+
+  for (i = y_start; i < y_end; i++) {
+    for (j = 0; j < width; j++) {
+      gint v0 = data[offsets[0]];
+      gint v1 = data[offsets[1]];
+      gint v2 = data[offsets[2]];
+      gint f0 = frac[v0], f1 = frac[v1], f2 = frac[v2];
+      gint w0, w1, w2, w3, o1, o2, o3;
+      const guint8 *p;
+
+      p = lut + filter->lut_offset[0][v0] + filter->lut_offset[1][v1] +
+          filter->lut_offset[2][v2];
+
+      /* tetrahedral interpolation: walk from the cell origin to the
+       * opposite corner along the axes by decreasing fraction, the
+       * four visited corners enclose the value */
+      if (f0 >= f1) {
+        if (f1 >= f2) {
+          w0 = 256 - f0;
+          w1 = f0 - f1;
+          w2 = f1 - f2;
+          w3 = f2;
+          o1 = d0;
+          o2 = d0 + d1;
+        } else if (f0 >= f2) {
+          w0 = 256 - f0;
+          w1 = f0 - f2;
+          w2 = f2 - f1;
+          w3 = f1;
+          o1 = d0;
+          o2 = d0 + d2;
+        } else {
+          w0 = 256 - f2;
+          w1 = f2 - f0;
+          w2 = f0 - f1;
+          w3 = f1;
+          o1 = d2;
+          o2 = d0 + d2;
+        }
+      } else {
+        if (f2 >= f1) {
+          w0 = 256 - f2;
+          w1 = f2 - f1;
+          w2 = f1 - f0;
+          w3 = f0;
+          o1 = d2;
+          o2 = d1 + d2;
+        } else if (f2 >= f0) {
+          w0 = 256 - f1;
+          w1 = f1 - f2;
+          w2 = f2 - f0;
+          w3 = f0;
+          o1 = d1;
+          o2 = d1 + d2;
+        } else {
+          w0 = 256 - f1;
+          w1 = f1 - f0;
+          w2 = f0 - f2;
+          w3 = f2;
+          o1 = d1;
+          o2 = d0 + d1;
+        }
+      }
+      o3 = d0 + d1 + d2;
 
-        data[offsets[0]] = CLAMP (y, 0, 255);
-        data[offsets[1]] = CLAMP (u, 0, 255);
-        data[offsets[2]] = CLAMP (v, 0, 255);
+      for (c = 0; c < 3; c++) {
+        data[offsets[c]] = (w0 * p[c] + w1 * p[o1 + c] + w2 * p[o2 + c] +
+            w3 * p[o3 + c] + 128) >> 8;
       }
+
       data += pixel_stride;
     }
     data += row_wrap;
   }
 }
 
+/* must be called with the object lock, whenever the preset, the lookup
+ * table file or the format changes */
+static void
+gst_color_effects_update (GstColorEffects * filter)
+{
+  gboolean yuv;
+  gint i;
+
+  filter->process = NULL;
+  g_free (filter->lut);
+  filter->lut = NULL;
+
+  /* nothing to do for the "none" preset */
+  if (filter->format == GST_VIDEO_FORMAT_UNKNOWN ||
+      (filter->cube == NULL && filter->table == NULL))
+    return;
+
+  yuv = (filter->format == GST_VIDEO_FORMAT_AYUV);
+
+  if (filter->cube == NULL && !yuv) {
+    /* presets map RGB channels independently, a 1D lookup is exact */
+    filter->process = gst_color_effects_transform_rgb;
+  } else if (filter->cube == NULL && filter->map_luma) {
+    /* luma presets only depend on Y, convert the table once */
+    for (i = 0; i < 256; i++) {
+      gint r = filter->table[i * 3];
+      gint g = filter->table[i * 3 + 1];
+      gint b = filter->table[i * 3 + 2];
+      gint y = APPLY_MATRIX (cog_rgb_to_ycbcr_matrix_8bit_sdtv, 0, r, g, b);
+      gint u = APPLY_MATRIX (cog_rgb_to_ycbcr_matrix_8bit_sdtv, 1, r, g, b);
+      gint v = APPLY_MATRIX (cog_rgb_to_ycbcr_matrix_8bit_sdtv, 2, r, g, b);
+
+      filter->yuv_table[i * 3] = CLAMP (y, 0, 255);
+      filter->yuv_table[i * 3 + 1] = CLAMP (u, 0, 255);
+      filter->yuv_table[i * 3 + 2] = CLAMP (v, 0, 255);
+    }
+    filter->process = gst_color_effects_transform_ayuv_luma;
+  } else {
+    gst_color_effects_compile_lut (filter, yuv);
+    filter->process = gst_color_effects_transform_lut;
+  }
+}
+
+static void
+gst_color_effects_band_func (gpointer data, gpointer user_data)
+{
+  GstColorEffectsBand *band = data;
+  GstColorEffects *filter = user_data;
+
+  filter->process (filter, band->frame, band->y_start, band->y_end);
+}
+
+/* must be called with the object lock */
+static void
+gst_color_effects_process (GstColorEffects * filter, GstVideoFrame * frame)
+{
+  GstColorEffectsBand *bands;
+  guint n_bands, i;
+
+  n_bands = gst_band_pool_get_n_bands (filter->n_threads, filter->height,
+      MIN_BAND_HEIGHT);
+
+  if (n_bands == 1) {
+    filter->process (filter, frame, 0, filter->height);
+    return;
+  }
+
+  bands = g_newa (GstColorEffectsBand, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    bands[i].frame = frame;
+    bands[i].y_start = filter->height * i / n_bands;
+    bands[i].y_end = filter->height * (i + 1) / n_bands;
+  }
+
+  gst_band_pool_run (gst_band_pool_get_default (),
+      gst_color_effects_band_func, filter, bands, sizeof (GstColorEffectsBand),
+      n_bands);
+}
+
 static gboolean
 gst_color_effects_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
     GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
 {
   GstColorEffects *filter = GST_COLOR_EFFECTS (vfilter);
+  GstVideoFormat format;
 
   GST_DEBUG_OBJECT (filter,
       "in %" GST_PTR_FORMAT " out %" GST_PTR_FORMAT, incaps, outcaps);
 
-  filter->process = NULL;
+  format = GST_VIDEO_INFO_FORMAT (in_info);
+
+  GST_OBJECT_LOCK (filter);
 
-  filter->format = GST_VIDEO_INFO_FORMAT (in_info);
   filter->width = GST_VIDEO_INFO_WIDTH (in_info);
   filter->height = GST_VIDEO_INFO_HEIGHT (in_info);
 
-  GST_OBJECT_LOCK (filter);
-
-  switch (filter->format) {
+  switch (format) {
     case GST_VIDEO_FORMAT_AYUV:
-      filter->process = gst_color_effects_transform_ayuv;
-      break;
     case GST_VIDEO_FORMAT_ARGB:
     case GST_VIDEO_FORMAT_ABGR:
     case GST_VIDEO_FORMAT_RGBA:
@@ -463,15 +781,18 @@ gst_color_effects_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
     case GST_VIDEO_FORMAT_BGRx:
     case GST_VIDEO_FORMAT_RGB:
     case GST_VIDEO_FORMAT_BGR:
-      filter->process = gst_color_effects_transform_rgb;
+      filter->format = format;
       break;
     default:
+      filter->format = GST_VIDEO_FORMAT_UNKNOWN;
       break;
   }
 
+  gst_color_effects_update (filter);
+
   GST_OBJECT_UNLOCK (filter);
 
-  return filter->process != NULL;
+  return filter->format != GST_VIDEO_FORMAT_UNKNOWN;
 }
 
 static GstFlowReturn
@@ -480,15 +801,13 @@ gst_color_effects_transform_frame_ip (GstVideoFilter * vfilter,
 {
   GstColorEffects *filter = GST_COLOR_EFFECTS (vfilter);
 
-  if (!filter->process)
+  if (filter->format == GST_VIDEO_FORMAT_UNKNOWN)
     goto not_negotiated;
 
-  /* do nothing if there is no table ("none" preset) */
-  if (filter->table == NULL)
-    return GST_FLOW_OK;
-
   GST_OBJECT_LOCK (filter);
-  filter->process (filter, out);
+  /* do nothing if there is no table ("none" preset) */
+  if (filter->process)
+    gst_color_effects_process (filter, out);
   GST_OBJECT_UNLOCK (filter);
 
   return GST_FLOW_OK;
@@ -498,6 +817,44 @@ not_negotiated:
   return GST_FLOW_NOT_NEGOTIATED;
 }
 
+static void
+gst_color_effects_set_lut_file (GstColorEffects * filter,
+    const gchar * filename)
+{
+  GError *err = NULL;
+  gfloat *cube = NULL;
+  gfloat domain_min[3], domain_max[3];
+  gint size = 0;
+
+  /* parse outside of the lock, the old table stays in use meanwhile */
+  if (filename && *filename) {
+    cube = gst_color_effects_load_cube (filename, &size, domain_min,
+        domain_max, &err);
+    if (cube == NULL) {
+      GST_ELEMENT_WARNING (filter, RESOURCE, READ,
+          ("Could not load lookup table \"%s\", using the preset instead.",
+              filename), ("%s", err->message));
+      g_error_free (err);
+    } else {
+      GST_DEBUG_OBJECT (filter, "loaded %dx%dx%d lookup table from %s",
+          size, size, size, filename);
+    }
+  }
+
+  GST_OBJECT_LOCK (filter);
+  g_free (filter->lut_file);
+  filter->lut_file = g_strdup (filename);
+  g_free (filter->cube);
+  filter->cube = cube;
+  filter->cube_size = size;
+  if (cube) {
+    memcpy (filter->cube_min, domain_min, sizeof (domain_min));
+    memcpy (filter->cube_max, domain_max, sizeof (domain_max));
+  }
+  gst_color_effects_update (filter);
+  GST_OBJECT_UNLOCK (filter);
+}
+
 static void
 gst_color_effects_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -537,6 +894,15 @@ gst_color_effects_set_property (GObject * object, guint prop_id,
           g_assert_not_reached ();
 
       }
+      gst_color_effects_update (filter);
+      GST_OBJECT_UNLOCK (filter);
+      break;
+    case PROP_LUT_FILE:
+      gst_color_effects_set_lut_file (filter, g_value_get_string (value));
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      filter->n_threads = g_value_get_uint (value);
       GST_OBJECT_UNLOCK (filter);
       break;
     default:
@@ -557,17 +923,40 @@ gst_color_effects_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_enum (value, filter->preset);
       GST_OBJECT_UNLOCK (filter);
       break;
+    case PROP_LUT_FILE:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_string (value, filter->lut_file);
+      GST_OBJECT_UNLOCK (filter);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (filter);
+      g_value_set_uint (value, filter->n_threads);
+      GST_OBJECT_UNLOCK (filter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_color_effects_finalize (GObject * object)
+{
+  GstColorEffects *filter = GST_COLOR_EFFECTS (object);
+
+  g_free (filter->lut_file);
+  g_free (filter->cube);
+  g_free (filter->lut);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_color_effects_class_init (GstColorEffectsClass * klass)
 {
   GObjectClass *gobject_class = (GObjectClass *) klass;
   GstElementClass *element_class = (GstElementClass *) klass;
+  GstBaseTransformClass *trans_class = (GstBaseTransformClass *) klass;
   GstVideoFilterClass *vfilter_class = (GstVideoFilterClass *) klass;
 
   GST_DEBUG_CATEGORY_INIT (coloreffects_debug, "coloreffects", 0,
@@ -575,11 +964,22 @@ gst_color_effects_class_init (GstColorEffectsClass * klass)
 
   gobject_class->set_property = gst_color_effects_set_property;
   gobject_class->get_property = gst_color_effects_get_property;
+  gobject_class->finalize = gst_color_effects_finalize;
 
   g_object_class_install_property (gobject_class, PROP_PRESET,
       g_param_spec_enum ("preset", "Preset", "Color effect preset to use",
           GST_TYPE_COLOR_EFFECTS_PRESET, DEFAULT_PROP_PRESET,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_LUT_FILE,
+      g_param_spec_string ("lut-file", "LUT file",
+          "3D lookup table to use instead of the preset (.cube format)",
+          DEFAULT_PROP_LUT_FILE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of horizontal bands filtered in parallel "
+          "(0 = number of processors)", 0, G_MAXINT, DEFAULT_PROP_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
 
   vfilter_class->set_info = GST_DEBUG_FUNCPTR (gst_color_effects_set_info);
   vfilter_class->transform_frame_ip =
@@ -602,4 +1002,6 @@ gst_color_effects_init (GstColorEffects * filter)
   filter->preset = GST_COLOR_EFFECTS_PRESET_NONE;
   filter->table = NULL;
   filter->map_luma = TRUE;
+  filter->format = GST_VIDEO_FORMAT_UNKNOWN;
+  filter->n_threads = DEFAULT_PROP_N_THREADS;
 }
@@ -73,12 +73,29 @@ struct _GstColorEffects
   const guint8 *table;
   gboolean map_luma;
 
+  /* 3D table loaded from lut_file, RGB float triplets */
+  gchar *lut_file;
+  gfloat *cube;
+  gint cube_size;
+  gfloat cube_min[3], cube_max[3];
+
+  /* tables compiled for the current format */
+  guint8 yuv_table[768];
+  guint8 *lut;
+  gint lut_size;
+  guint32 lut_offset[3][256];
+  guint16 lut_frac[256];
+
   /* video format */
   GstVideoFormat format;
   gint width;
   gint height;
 
-  void (*process) (GstColorEffects * filter, GstVideoFrame * frame);
+  /* band-parallel processing */
+  guint n_threads;
+
+  void (*process) (GstColorEffects * filter, GstVideoFrame * frame,
+      gint y_start, gint y_end);
 };
 
 struct _GstColorEffectsClass
@@ -0,0 +1,136 @@
+/* GStreamer
+ * Copyright (C) <2010> Filippo Argiolas <filippo.argiolas@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "gstcoloreffectscube.h"
+
+/*
+ * Lookup table parser for the Adobe/Resolve .cube format: keyword lines
+ * (TITLE, LUT_3D_SIZE, DOMAIN_MIN, DOMAIN_MAX, LUT_3D_INPUT_RANGE) followed
+ * by size^3 lines of "r g b" in the 0-1 range, red varying fastest.
+ */
+static gboolean
+gst_color_effects_parse_floats (const gchar * str, gfloat * values, gint n)
+{
+  gchar *end;
+  gint i;
+
+  for (i = 0; i < n; i++) {
+    values[i] = g_ascii_strtod (str, &end);
+    if (end == str)
+      return FALSE;
+    str = end;
+  }
+
+  return TRUE;
+}
+
+gfloat *
+gst_color_effects_load_cube (const gchar * filename, gint * size,
+    gfloat * domain_min, gfloat * domain_max, GError ** error)
+{
+  gchar *contents, **lines;
+  gfloat *cube = NULL;
+  gint i, n = 0, count = 0;
+
+  if (!g_file_get_contents (filename, &contents, NULL, error))
+    return NULL;
+
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  for (i = 0; i < 3; i++) {
+    domain_min[i] = 0.0;
+    domain_max[i] = 1.0;
+  }
+
+  for (i = 0; lines[i]; i++) {
+    gchar *line = g_strstrip (lines[i]);
+
+    if (*line == '\0' || *line == '#')
+      continue;
+
+    if (g_ascii_isdigit (*line) || *line == '-' || *line == '+'
+        || *line == '.') {
+      if (cube == NULL || count == n * n * n ||
+          !gst_color_effects_parse_floats (line, cube + count * 3, 3))
+        goto parse_error;
+      count++;
+    } else if (g_str_has_prefix (line, "LUT_3D_SIZE")) {
+      n = atoi (line + strlen ("LUT_3D_SIZE"));
+      if (cube != NULL || n < 2 || n > 256)
+        goto parse_error;
+      cube = g_new (gfloat, n * n * n * 3);
+    } else if (g_str_has_prefix (line, "DOMAIN_MIN")) {
+      if (!gst_color_effects_parse_floats (line + strlen ("DOMAIN_MIN"),
+              domain_min, 3))
+        goto parse_error;
+    } else if (g_str_has_prefix (line, "DOMAIN_MAX")) {
+      if (!gst_color_effects_parse_floats (line + strlen ("DOMAIN_MAX"),
+              domain_max, 3))
+        goto parse_error;
+    } else if (g_str_has_prefix (line, "LUT_3D_INPUT_RANGE")) {
+      gfloat range[2];
+
+      if (!gst_color_effects_parse_floats (line +
+              strlen ("LUT_3D_INPUT_RANGE"), range, 2))
+        goto parse_error;
+      domain_min[0] = domain_min[1] = domain_min[2] = range[0];
+      domain_max[0] = domain_max[1] = domain_max[2] = range[1];
+    } else if (g_str_has_prefix (line, "LUT_1D_SIZE")) {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+          "%s: 1D lookup tables are not supported", filename);
+      goto error;
+    }
+    /* TITLE and unknown keywords are ignored */
+  }
+
+  if (cube == NULL || count != n * n * n) {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+        "%s: expected %d table entries, found %d", filename, n * n * n, count);
+    goto error;
+  }
+
+  for (i = 0; i < 3; i++) {
+    if (domain_max[i] <= domain_min[i]) {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+          "%s: invalid domain", filename);
+      goto error;
+    }
+  }
+
+  g_strfreev (lines);
+  *size = n;
+
+  return cube;
+
+parse_error:
+  g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+      "%s:%d: invalid line", filename, i + 1);
+error:
+  g_strfreev (lines);
+  g_free (cube);
+  return NULL;
+}
@@ -0,0 +1,35 @@
+/* GStreamer
+ * Copyright (C) <2010> Filippo Argiolas <filippo.argiolas@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_COLOR_EFFECTS_CUBE_H__
+#define __GST_COLOR_EFFECTS_CUBE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Loads the .cube file @filename. Returns the @size^3 rgb triplets of the
+ * table, red varying fastest, and the input range of each component in
+ * @domain_min and @domain_max, or NULL with @error set. */
+gfloat *gst_color_effects_load_cube (const gchar * filename, gint * size,
+    gfloat * domain_min, gfloat * domain_max, GError ** error);
+
+G_END_DECLS
+
+#endif /* __GST_COLOR_EFFECTS_CUBE_H__ */
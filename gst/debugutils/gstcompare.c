@@ -55,7 +55,8 @@ enum GstCompareMethod
 {
   GST_COMPARE_METHOD_MEM,
   GST_COMPARE_METHOD_MAX,
-  GST_COMPARE_METHOD_SSIM
+  GST_COMPARE_METHOD_SSIM,
+  GST_COMPARE_METHOD_PSNR
 };
 
 #define GST_COMPARE_METHOD_TYPE (gst_compare_method_get_type())
@@ -68,6 +69,7 @@ gst_compare_method_get_type (void)
     {GST_COMPARE_METHOD_MEM, "Memory", "mem"},
     {GST_COMPARE_METHOD_MAX, "Maximum metric", "max"},
     {GST_COMPARE_METHOD_SSIM, "SSIM (raw video)", "ssim"},
+    {GST_COMPARE_METHOD_PSNR, "PSNR in dB (raw video)", "psnr"},
     {0, NULL, NULL}
   };
 
@@ -125,6 +127,8 @@ gst_compare_finalize (GObject * object)
   GstCompare *comp = GST_COMPARE (object);
 
   gst_object_unref (comp->cpads);
+  if (comp->quality)
+    gst_video_quality_free (comp->quality);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -349,82 +353,22 @@ gst_compare_max (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
   return delta;
 }
 
-static double
-gst_compare_ssim_window (GstCompare * comp, guint8 * data1, guint8 * data2,
-    gint width, gint height, gint step, gint stride)
-{
-  gint count = 0, i, j;
-  gint sum1 = 0, sum2 = 0, ssum1 = 0, ssum2 = 0, acov = 0;
-  gdouble avg1, avg2, var1, var2, cov;
-
-  const gdouble k1 = 0.01;
-  const gdouble k2 = 0.03;
-  const gdouble L = 255.0;
-  const gdouble c1 = (k1 * L) * (k1 * L);
-  const gdouble c2 = (k2 * L) * (k2 * L);
-
-  /* plain and simple; no fancy optimizations */
-  for (i = 0; i < height; i++) {
-    for (j = 0; j < width; j++) {
-      sum1 += *data1;
-      sum2 += *data2;
-      ssum1 += *data1 * *data1;
-      ssum2 += *data2 * *data2;
-      acov += *data1 * *data2;
-      count++;
-      data1 += step;
-      data2 += step;
-    }
-    data1 -= j * step;
-    data2 -= j * step;
-    data1 += stride;
-    data2 += stride;
-  }
-
-  avg1 = sum1 / count;
-  avg2 = sum2 / count;
-  var1 = ssum1 / count - avg1 * avg1;
-  var2 = ssum2 / count - avg2 * avg2;
-  cov = acov / count - avg1 * avg2;
-
-  return (2 * avg1 * avg2 + c1) * (2 * cov + c2) /
-      ((avg1 * avg1 + avg2 * avg2 + c1) * (var1 + var2 + c2));
-}
-
-/* @width etc are for the particular component */
+/* Measures all components of raw video with the quality library and
+ * returns their weighted average, the per-component values are stored in
+ * @cvalues */
 static gdouble
-gst_compare_ssim_component (GstCompare * comp, guint8 * data1, guint8 * data2,
-    gint width, gint height, gint step, gint stride)
-{
-  const gint window = 16;
-  gdouble ssim_sum = 0;
-  gint count = 0, i, j;
-
-  for (j = 0; j + (window / 2) < height; j += (window / 2)) {
-    for (i = 0; i + (window / 2) < width; i += (window / 2)) {
-      gdouble ssim;
-
-      ssim = gst_compare_ssim_window (comp, data1 + step * i + j * stride,
-          data2 + step * i + j * stride,
-          MIN (window, width - i), MIN (window, height - j), step, stride);
-      GST_LOG_OBJECT (comp, "ssim for %dx%d at (%d, %d) = %f", window, window,
-          i, j, ssim);
-      ssim_sum += ssim;
-      count++;
-    }
-  }
-
-  return (ssim_sum / count);
-}
-
-static gdouble
-gst_compare_ssim (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
-    GstBuffer * buf2, GstCaps * caps2)
+gst_compare_quality (GstCompare * comp, GstVideoQualityMetrics metric,
+    GstBuffer * buf1, GstCaps * caps1, GstBuffer * buf2, GstCaps * caps2,
+    gdouble * cvalues, gint * n_comps)
 {
   GstVideoInfo info1, info2;
   GstVideoFrame frame1, frame2;
+  GstVideoQualityPlane planes1[4], planes2[4];
+  GstVideoQualityResult results[4];
   gint i, comps;
-  gdouble cssim[4], ssim, c[4] = { 1.0, 0.0, 0.0, 0.0 };
+  gdouble value, c[4] = { 1.0, 0.0, 0.0, 0.0 };
+
+  *n_comps = 0;
 
   if (!caps1)
     goto invalid_input;
@@ -454,44 +398,57 @@ gst_compare_ssim (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
     c[i] /= (GST_VIDEO_INFO_IS_YUV (&info1) && (comps > 1)) ?
         2 * (comps - 1) : comps;
 
+  /* only support most common formats */
+  for (i = 0; i < comps; i++) {
+    if (GST_VIDEO_INFO_COMP_DEPTH (&info1, i) != 8)
+      goto unsupported_input;
+  }
+
   gst_video_frame_map (&frame1, &info1, buf1, GST_MAP_READ);
   gst_video_frame_map (&frame2, &info2, buf2, GST_MAP_READ);
 
   for (i = 0; i < comps; i++) {
-    gint cw, ch, step, stride;
-
-    /* only support most common formats */
-    if (GST_VIDEO_INFO_COMP_DEPTH (&info1, i) != 8)
-      goto unsupported_input;
-    cw = GST_VIDEO_FRAME_COMP_WIDTH (&frame1, i);
-    ch = GST_VIDEO_FRAME_COMP_HEIGHT (&frame1, i);
-    step = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame1, i);
-    stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame1, i);
-
-    GST_LOG_OBJECT (comp, "component %d", i);
-    cssim[i] = gst_compare_ssim_component (comp,
-        GST_VIDEO_FRAME_COMP_DATA (&frame1, i),
-        GST_VIDEO_FRAME_COMP_DATA (&frame2, i), cw, ch, step, stride);
-    GST_LOG_OBJECT (comp, "ssim[%d] = %f", i, cssim[i]);
+    planes1[i].data = GST_VIDEO_FRAME_COMP_DATA (&frame1, i);
+    planes1[i].width = GST_VIDEO_FRAME_COMP_WIDTH (&frame1, i);
+    planes1[i].height = GST_VIDEO_FRAME_COMP_HEIGHT (&frame1, i);
+    planes1[i].pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame1, i);
+    planes1[i].stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame1, i);
+
+    planes2[i] = planes1[i];
+    planes2[i].data = GST_VIDEO_FRAME_COMP_DATA (&frame2, i);
+    planes2[i].pstride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame2, i);
+    planes2[i].stride = GST_VIDEO_FRAME_COMP_STRIDE (&frame2, i);
   }
 
+  if (!comp->quality)
+    comp->quality = gst_video_quality_new (0);
+
+  /* all components in one go, so the threads are shared among them */
+  gst_video_quality_measure (comp->quality, metric, planes1, planes2, comps,
+      results);
+
   gst_video_frame_unmap (&frame1);
   gst_video_frame_unmap (&frame2);
 
-#ifndef GST_DISABLE_GST_DEBUG
-  for (i = 0; i < 4; i++) {
-    GST_DEBUG_OBJECT (comp, "ssim[%d] = %f, c[%d] = %f", i, cssim[i], i, c[i]);
+  value = 0;
+  for (i = 0; i < comps; i++) {
+    if (metric == GST_VIDEO_QUALITY_METRIC_PSNR)
+      cvalues[i] = results[i].psnr;
+    else
+      cvalues[i] = results[i].ssim;
+
+    GST_DEBUG_OBJECT (comp, "component %d: %f, c[%d] = %f", i, cvalues[i],
+        i, c[i]);
+    value += cvalues[i] * c[i];
   }
-#endif
-
-  ssim = cssim[0] * c[0] + cssim[1] * c[1] + cssim[2] * c[2] + cssim[3] * c[3];
+  *n_comps = comps;
 
-  return ssim;
+  return value;
 
   /* ERRORS */
 invalid_input:
   {
-    GST_ERROR_OBJECT (comp, "ssim method needs raw video input");
+    GST_ERROR_OBJECT (comp, "ssim and psnr methods need raw video input");
     return 0;
   }
 unsupported_input:
@@ -506,7 +463,8 @@ static void
 gst_compare_buffers (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
     GstBuffer * buf2, GstCaps * caps2)
 {
-  gdouble delta = 0;
+  gdouble delta = 0, cvalues[4];
+  gint n_comps = 0;
   gsize size1, size2;
 
   /* first check metadata */
@@ -536,7 +494,12 @@ gst_compare_buffers (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
         delta = gst_compare_max (comp, buf1, caps1, buf2, caps2);
         break;
       case GST_COMPARE_METHOD_SSIM:
-        delta = gst_compare_ssim (comp, buf1, caps1, buf2, caps2);
+        delta = gst_compare_quality (comp, GST_VIDEO_QUALITY_METRIC_SSIM,
+            buf1, caps1, buf2, caps2, cvalues, &n_comps);
+        break;
+      case GST_COMPARE_METHOD_PSNR:
+        delta = gst_compare_quality (comp, GST_VIDEO_QUALITY_METRIC_PSNR,
+            buf1, caps1, buf2, caps2, cvalues, &n_comps);
         break;
       default:
         g_assert_not_reached ();
@@ -546,13 +509,31 @@ gst_compare_buffers (GstCompare * comp, GstBuffer * buf1, GstCaps * caps1,
 
   if ((comp->upper && delta > comp->threshold) ||
       (!comp->upper && delta < comp->threshold)) {
+    GstStructure *s;
+
     GST_WARNING_OBJECT (comp, "buffers %p and %p failed content match %f",
         buf1, buf2, delta);
 
+    s = gst_structure_new ("delta", "content", G_TYPE_DOUBLE, delta, NULL);
+
+    /* per component values of the video methods */
+    if (n_comps > 0) {
+      GValue array = { 0, };
+      GValue v = { 0, };
+      gint i;
+
+      g_value_init (&array, GST_TYPE_ARRAY);
+      g_value_init (&v, G_TYPE_DOUBLE);
+      for (i = 0; i < n_comps; i++) {
+        g_value_set_double (&v, cvalues[i]);
+        gst_value_array_append_value (&array, &v);
+      }
+      gst_structure_take_value (s, "components", &array);
+      g_value_unset (&v);
+    }
+
     gst_element_post_message (GST_ELEMENT (comp),
-        gst_message_new_element (GST_OBJECT (comp),
-            gst_structure_new ("delta", "content", G_TYPE_DOUBLE, delta,
-                NULL)));
+        gst_message_new_element (GST_OBJECT (comp), s));
   }
 }
 
@@ -26,6 +26,7 @@
 
 
 #include <gst/gst.h>
+#include <gst/videoquality/gstvideoquality.h>
 
 G_BEGIN_DECLS
 
@@ -56,6 +57,9 @@ struct _GstCompare {
 
   gint count;
 
+  /* metrics of the raw video methods, created on first use */
+  GstVideoQuality *quality;
+
   /* properties */
   GstBufferCopyFlags meta;
   gboolean offset_ts;
@@ -53,6 +53,13 @@
  *   This field will always been 2 (ie sound) from this element.
  *   </para>
  * </listitem>
+ * <listitem>
+ *   <para>
+ *   gint <classname>channel</classname>:
+ *   The channel the tone was detected on. Only present if the input has
+ *   more than one channel, every channel is treated as a separate call.
+ *   </para>
+ * </listitem>
  * </itemizedlist>
  */
 
@@ -74,7 +81,7 @@ static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
         "format = (string) \"" GST_AUDIO_NE (S16) "\", "
-        "rate = (int) 8000, " "channels = (int) 1")
+        "rate = (int) 8000, " "channels = (int) [ 1, MAX ]")
     );
 
 
@@ -83,7 +90,7 @@ static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw, "
         "format = (string) \"" GST_AUDIO_NE (S16) "\", "
-        "rate = (int) 8000, " "channels = (int) 1")
+        "rate = (int) 8000, " "channels = (int) [ 1, MAX ]")
     );
 
 /* signals and args */
@@ -98,6 +105,8 @@ enum
   PROP_0,
 };
 
+static void gst_dtmf_detect_finalize (GObject * object);
+
 static gboolean gst_dtmf_detect_set_caps (GstBaseTransform * trans,
     GstCaps * incaps, GstCaps * outcaps);
 static GstFlowReturn gst_dtmf_detect_transform_ip (GstBaseTransform * trans,
@@ -110,12 +119,16 @@ G_DEFINE_TYPE (GstDtmfDetect, gst_dtmf_detect, GST_TYPE_BASE_TRANSFORM);
 static void
 gst_dtmf_detect_class_init (GstDtmfDetectClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
   GstBaseTransformClass *gstbasetransform_class;
 
+  gobject_class = G_OBJECT_CLASS (klass);
   gstelement_class = GST_ELEMENT_CLASS (klass);
   gstbasetransform_class = (GstBaseTransformClass *) klass;
 
+  gobject_class->finalize = gst_dtmf_detect_finalize;
+
   GST_DEBUG_CATEGORY_INIT (dtmf_detect_debug, "dtmfdetect", 0, "dtmfdetect");
 
   gst_element_class_add_pad_template (gstelement_class,
@@ -143,44 +156,61 @@ gst_dtmf_detect_init (GstDtmfDetect * dtmfdetect)
   gst_base_transform_set_gap_aware (GST_BASE_TRANSFORM (dtmfdetect), TRUE);
 }
 
+static void
+gst_dtmf_detect_finalize (GObject * object)
+{
+  GstDtmfDetect *self = GST_DTMF_DETECT (object);
+
+  g_free (self->dtmf_state);
+
+  G_OBJECT_CLASS (gst_dtmf_detect_parent_class)->finalize (object);
+}
+
+static void
+gst_dtmf_detect_reset (GstDtmfDetect * self)
+{
+  gint i;
+
+  for (i = 0; i < self->channels; i++)
+    zap_dtmf_detect_init (&self->dtmf_state[i]);
+}
+
 static gboolean
 gst_dtmf_detect_set_caps (GstBaseTransform * trans, GstCaps * incaps,
     GstCaps * outcaps)
 {
   GstDtmfDetect *self = GST_DTMF_DETECT (trans);
+  GstStructure *structure = gst_caps_get_structure (incaps, 0);
+  gint channels;
 
-  zap_dtmf_detect_init (&self->dtmf_state);
+  if (!gst_structure_get_int (structure, "channels", &channels))
+    return FALSE;
+
+  if (self->channels != channels) {
+    g_free (self->dtmf_state);
+    self->channels = channels;
+    self->dtmf_state = g_new0 (dtmf_detect_state_t, self->channels);
+  }
+  gst_dtmf_detect_reset (self);
 
   return TRUE;
 }
 
-
-static GstFlowReturn
-gst_dtmf_detect_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+static void
+gst_dtmf_detect_post_events (GstDtmfDetect * self, gint channel)
 {
-  GstDtmfDetect *self = GST_DTMF_DETECT (trans);
   gint dtmf_count;
   gchar dtmfbuf[MAX_DTMF_DIGITS] = "";
   gint i;
-  GstMapInfo map;
 
-  if (GST_BUFFER_IS_DISCONT (buf))
-    zap_dtmf_detect_init (&self->dtmf_state);
-  if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_GAP))
-    return GST_FLOW_OK;
-
-  gst_buffer_map (buf, &map, GST_MAP_READ);
-
-  zap_dtmf_detect (&self->dtmf_state, (gint16 *) map.data, map.size / 2, FALSE);
-
-  dtmf_count = zap_dtmf_get (&self->dtmf_state, dtmfbuf, MAX_DTMF_DIGITS);
+  dtmf_count = zap_dtmf_get (&self->dtmf_state[channel], dtmfbuf,
+      MAX_DTMF_DIGITS);
 
   if (dtmf_count)
-    GST_DEBUG_OBJECT (self, "Got %d DTMF events: %s", dtmf_count, dtmfbuf);
+    GST_DEBUG_OBJECT (self, "Got %d DTMF events on channel %d: %s",
+        dtmf_count, channel, dtmfbuf);
   else
-    GST_LOG_OBJECT (self, "Got no DTMF events");
-
-  gst_buffer_unmap (buf, &map);
+    GST_LOG_OBJECT (self, "Got no DTMF events on channel %d", channel);
 
   for (i = 0; i < dtmf_count; i++) {
     GstMessage *dtmf_message = NULL;
@@ -246,9 +276,37 @@ gst_dtmf_detect_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
         "type", G_TYPE_INT, 1,
         "number", G_TYPE_INT, dtmf_payload_event,
         "method", G_TYPE_INT, 2, NULL);
+    /* only tell the channels apart when there is more than one */
+    if (self->channels > 1)
+      gst_structure_set (structure, "channel", G_TYPE_INT, channel, NULL);
     dtmf_message = gst_message_new_element (GST_OBJECT (self), structure);
     gst_element_post_message (GST_ELEMENT (self), dtmf_message);
   }
+}
+
+static GstFlowReturn
+gst_dtmf_detect_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
+{
+  GstDtmfDetect *self = GST_DTMF_DETECT (trans);
+  GstMapInfo map;
+  gint i;
+
+  if (GST_BUFFER_IS_DISCONT (buf))
+    gst_dtmf_detect_reset (self);
+  if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_GAP))
+    return GST_FLOW_OK;
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+
+  /* every channel has its own detector, which reads its samples straight
+   * from the interleaved buffer, one strided pass per channel */
+  zap_dtmf_detect_multi (self->dtmf_state, self->channels,
+      (gint16 *) map.data, map.size / (2 * self->channels), FALSE);
+
+  gst_buffer_unmap (buf, &map);
+
+  for (i = 0; i < self->channels; i++)
+    gst_dtmf_detect_post_events (self, i);
 
   return GST_FLOW_OK;
 }
@@ -261,7 +319,7 @@ gst_dtmf_detect_sink_event (GstBaseTransform * trans, GstEvent * event)
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_FLUSH_STOP:
-      zap_dtmf_detect_init (&self->dtmf_state);
+      gst_dtmf_detect_reset (self);
       break;
     default:
       break;
@@ -54,7 +54,9 @@ struct _GstDtmfDetect
 {
   GstBaseTransform parent;
 
-  dtmf_detect_state_t dtmf_state;
+  /* one detector per channel */
+  dtmf_detect_state_t *dtmf_state;
+  gint channels;
 };
 
 struct _GstDtmfDetectClass
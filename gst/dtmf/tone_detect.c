@@ -45,8 +45,6 @@
 #define TRUE    (!FALSE)
 #endif
 
-//#define USE_3DNOW
-
 /* Basic DTMF specs:
  *
  * Minimum tone on = 40ms
@@ -71,104 +69,73 @@
 #define DTMF_2ND_HARMONIC_ROW       ((isradio) ? 1.7 : 2.5)     /* 4dB normal */
 #define DTMF_2ND_HARMONIC_COL       63.1        /* 18dB */
 
-static tone_detection_descriptor_t dtmf_detect_row[4];
-static tone_detection_descriptor_t dtmf_detect_col[4];
-static tone_detection_descriptor_t dtmf_detect_row_2nd[4];
-static tone_detection_descriptor_t dtmf_detect_col_2nd[4];
-static tone_detection_descriptor_t fax_detect;
-static tone_detection_descriptor_t fax_detect_2nd;
-
-static float dtmf_row[] = {
-  697.0, 770.0, 852.0, 941.0
-};
-
-static float dtmf_col[] = {
-  1209.0, 1336.0, 1477.0, 1633.0
+/* Filter coefficients of all lanes of the tone bank, 2 cos (2 pi f / 8000)
+   of the tone frequencies f. A constant table, so that detectors on
+   several threads can read it while others are set up. */
+static const float dtmf_tone_fac[DTMF_TONE_LANES] = {
+  /* rows: 697, 770, 852 and 941 Hz */
+  1.7077378, 1.64528108, 1.56868696, 1.47820449,
+  /* columns: 1209, 1336, 1477 and 1633 Hz */
+  1.16410398, 0.996370196, 0.798618376, 0.568532646,
+  /* second harmonics of the rows */
+  0.916368425, 0.706949651, 0.460778862, 0.185088679,
+  /* second harmonics of the columns */
+  -0.644861877, -1.00724649, -1.36220872, -1.67677057,
+  /* fax tone, 1100 Hz, and its second harmonic */
+  1.29889607, -0.312868893,
+  /* padding */
+  0.0, 0.0
 };
 
-static float fax_freq = 1100.0;
-
 static char dtmf_positions[] = "123A" "456B" "789C" "*0#D";
 
+/* Longest run of samples processed in one go, a detection block is 102
+   samples. */
+#define DTMF_BLOCK_SIZE 102
+
 static void
-goertzel_init (goertzel_state_t * s, tone_detection_descriptor_t * t)
+goertzel_bank_init (goertzel_bank_t * b)
 {
-  s->v2 = s->v3 = 0.0;
-  s->fac = t->fac;
+  memset (b, 0, sizeof (goertzel_bank_t));
 }
 
 /*- End of function --------------------------------------------------------*/
 
-#if defined(USE_3DNOW)
-static inline void
-_dtmf_goertzel_update (goertzel_state_t * s, float x[], int samples)
+/* Runs all the tones of the bank over a block of samples. The lanes do not
+   depend on each other, so the inner loop maps onto SIMD registers. */
+static void
+goertzel_bank_update (goertzel_bank_t * b, const float x[], int samples)
 {
-  int n;
-  float v;
+  float v2[DTMF_TONE_LANES];
+  float v3[DTMF_TONE_LANES];
+  float v1;
   int i;
-  float vv[16];
-
-  vv[4] = s[0].v2;
-  vv[5] = s[1].v2;
-  vv[6] = s[2].v2;
-  vv[7] = s[3].v2;
-  vv[8] = s[0].v3;
-  vv[9] = s[1].v3;
-  vv[10] = s[2].v3;
-  vv[11] = s[3].v3;
-  vv[12] = s[0].fac;
-  vv[13] = s[1].fac;
-  vv[14] = s[2].fac;
-  vv[15] = s[3].fac;
-
-  //v1 = s->v2;
-  //s->v2 = s->v3;
-  //s->v3 = s->fac*s->v2 - v1 + x[0];
-
-  __asm__ __volatile__ (" femms;\n"
-      " movq        16(%%edx),%%mm2;\n"
-      " movq        24(%%edx),%%mm3;\n"
-      " movq        32(%%edx),%%mm4;\n"
-      " movq        40(%%edx),%%mm5;\n"
-      " movq        48(%%edx),%%mm6;\n"
-      " movq        56(%%edx),%%mm7;\n"
-      " jmp         1f;\n"
-      " .align 32;\n"
-      " 1: ;\n"
-      " prefetch    (%%eax);\n"
-      " movq        %%mm3,%%mm1;\n"
-      " movq        %%mm2,%%mm0;\n"
-      " movq        %%mm5,%%mm3;\n"
-      " movq        %%mm4,%%mm2;\n"
-      " pfmul       %%mm7,%%mm5;\n"
-      " pfmul       %%mm6,%%mm4;\n"
-      " pfsub       %%mm1,%%mm5;\n"
-      " pfsub       %%mm0,%%mm4;\n"
-      " movq        (%%eax),%%mm0;\n"
-      " movq        %%mm0,%%mm1;\n"
-      " punpckldq   %%mm0,%%mm1;\n"
-      " add         $4,%%eax;\n"
-      " pfadd       %%mm1,%%mm5;\n"
-      " pfadd       %%mm1,%%mm4;\n"
-      " dec         %%ecx;\n"
-      " jnz         1b;\n"
-      " movq        %%mm2,16(%%edx);\n"
-      " movq        %%mm3,24(%%edx);\n"
-      " movq        %%mm4,32(%%edx);\n"
-      " movq        %%mm5,40(%%edx);\n"
-      " femms;\n"::"c" (samples), "a" (x), "d" (vv)
-      :"memory", "eax", "ecx");
-
-  s[0].v2 = vv[4];
-  s[1].v2 = vv[5];
-  s[2].v2 = vv[6];
-  s[3].v2 = vv[7];
-  s[0].v3 = vv[8];
-  s[1].v3 = vv[9];
-  s[2].v3 = vv[10];
-  s[3].v3 = vv[11];
+  int t;
+
+  memcpy (v2, b->v2, sizeof (v2));
+  memcpy (v3, b->v3, sizeof (v3));
+
+  for (i = 0; i < samples; i++) {
+    for (t = 0; t < DTMF_TONE_LANES; t++) {
+      v1 = v2[t];
+      v2[t] = v3[t];
+      v3[t] = dtmf_tone_fac[t] * v3[t] - v1 + x[i];
+    }
+  }
+
+  memcpy (b->v2, v2, sizeof (v2));
+  memcpy (b->v3, v3, sizeof (v3));
 }
-#endif
+
+/*- End of function --------------------------------------------------------*/
+
+static float
+goertzel_bank_result (goertzel_bank_t * b, int t)
+{
+  return b->v3[t] * b->v3[t] + b->v2[t] * b->v2[t] -
+      b->v2[t] * b->v3[t] * dtmf_tone_fac[t];
+}
+
 /*- End of function --------------------------------------------------------*/
 
 void
@@ -197,41 +164,10 @@ zap_goertzel_result (goertzel_state_t * s)
 void
 zap_dtmf_detect_init (dtmf_detect_state_t * s)
 {
-  int i;
-  float theta;
-
   s->hit1 = s->hit2 = 0;
 
-  for (i = 0; i < 4; i++) {
-    theta = 2.0 * G_PI * (dtmf_row[i] / SAMPLE_RATE);
-    dtmf_detect_row[i].fac = 2.0 * cos (theta);
-
-    theta = 2.0 * G_PI * (dtmf_col[i] / SAMPLE_RATE);
-    dtmf_detect_col[i].fac = 2.0 * cos (theta);
-
-    theta = 2.0 * G_PI * (dtmf_row[i] * 2.0 / SAMPLE_RATE);
-    dtmf_detect_row_2nd[i].fac = 2.0 * cos (theta);
-
-    theta = 2.0 * G_PI * (dtmf_col[i] * 2.0 / SAMPLE_RATE);
-    dtmf_detect_col_2nd[i].fac = 2.0 * cos (theta);
-
-    goertzel_init (&s->row_out[i], &dtmf_detect_row[i]);
-    goertzel_init (&s->col_out[i], &dtmf_detect_col[i]);
-    goertzel_init (&s->row_out2nd[i], &dtmf_detect_row_2nd[i]);
-    goertzel_init (&s->col_out2nd[i], &dtmf_detect_col_2nd[i]);
-
-    s->energy = 0.0;
-  }
-
-  /* Same for the fax dector */
-  theta = 2.0 * G_PI * (fax_freq / SAMPLE_RATE);
-  fax_detect.fac = 2.0 * cos (theta);
-  goertzel_init (&s->fax_tone, &fax_detect);
-
-  /* Same for the fax dector 2nd harmonic */
-  theta = 2.0 * G_PI * (fax_freq * 2.0 / SAMPLE_RATE);
-  fax_detect_2nd.fac = 2.0 * cos (theta);
-  goertzel_init (&s->fax_tone2nd, &fax_detect_2nd);
+  goertzel_bank_init (&s->tones);
+  s->energy = 0.0;
 
   s->current_sample = 0;
   s->detected_digits = 0;
@@ -242,17 +178,18 @@ zap_dtmf_detect_init (dtmf_detect_state_t * s)
 
 /*- End of function --------------------------------------------------------*/
 
-int
-zap_dtmf_detect (dtmf_detect_state_t * s,
-    int16_t amp[], int samples, int isradio)
+/* Works on every @stride'th sample of @amp, so that one stream of
+   interleaved data can be picked out without copying it first. */
+static int
+dtmf_detect_strided (dtmf_detect_state_t * s,
+    int16_t amp[], int stride, int samples, int isradio)
 {
 
   float row_energy[4];
   float col_energy[4];
   float fax_energy;
   float fax_energy_2nd;
-  float famp;
-  float v1;
+  float famp[DTMF_BLOCK_SIZE];
   int i;
   int j;
   int sample;
@@ -264,126 +201,34 @@ zap_dtmf_detect (dtmf_detect_state_t * s,
   hit = 0;
   for (sample = 0; sample < samples; sample = limit) {
     /* 102 is optimised to meet the DTMF specs. */
-    if ((samples - sample) >= (102 - s->current_sample))
-      limit = sample + (102 - s->current_sample);
+    if ((samples - sample) >= (DTMF_BLOCK_SIZE - s->current_sample))
+      limit = sample + (DTMF_BLOCK_SIZE - s->current_sample);
     else
       limit = samples;
-#if defined(USE_3DNOW)
-    _dtmf_goertzel_update (s->row_out, amp + sample, limit - sample);
-    _dtmf_goertzel_update (s->col_out, amp + sample, limit - sample);
-    _dtmf_goertzel_update (s->row_out2nd, amp + sample, limit2 - sample);
-    _dtmf_goertzel_update (s->col_out2nd, amp + sample, limit2 - sample);
-    /* XXX Need to fax detect for 3dnow too XXX */
-#warning "Fax Support Broken"
-#else
-    /* The following unrolled loop takes only 35% (rough estimate) of the 
-       time of a rolled loop on the machine on which it was developed */
-    for (j = sample; j < limit; j++) {
-      famp = amp[j];
-
-      s->energy += famp * famp;
-
-      /* With GCC 2.95, the following unrolled code seems to take about 35%
-         (rough estimate) as long as a neat little 0-3 loop */
-      v1 = s->row_out[0].v2;
-      s->row_out[0].v2 = s->row_out[0].v3;
-      s->row_out[0].v3 = s->row_out[0].fac * s->row_out[0].v2 - v1 + famp;
-
-      v1 = s->col_out[0].v2;
-      s->col_out[0].v2 = s->col_out[0].v3;
-      s->col_out[0].v3 = s->col_out[0].fac * s->col_out[0].v2 - v1 + famp;
-
-      v1 = s->row_out[1].v2;
-      s->row_out[1].v2 = s->row_out[1].v3;
-      s->row_out[1].v3 = s->row_out[1].fac * s->row_out[1].v2 - v1 + famp;
-
-      v1 = s->col_out[1].v2;
-      s->col_out[1].v2 = s->col_out[1].v3;
-      s->col_out[1].v3 = s->col_out[1].fac * s->col_out[1].v2 - v1 + famp;
-
-      v1 = s->row_out[2].v2;
-      s->row_out[2].v2 = s->row_out[2].v3;
-      s->row_out[2].v3 = s->row_out[2].fac * s->row_out[2].v2 - v1 + famp;
-
-      v1 = s->col_out[2].v2;
-      s->col_out[2].v2 = s->col_out[2].v3;
-      s->col_out[2].v3 = s->col_out[2].fac * s->col_out[2].v2 - v1 + famp;
-
-      v1 = s->row_out[3].v2;
-      s->row_out[3].v2 = s->row_out[3].v3;
-      s->row_out[3].v3 = s->row_out[3].fac * s->row_out[3].v2 - v1 + famp;
-
-      v1 = s->col_out[3].v2;
-      s->col_out[3].v2 = s->col_out[3].v3;
-      s->col_out[3].v3 = s->col_out[3].fac * s->col_out[3].v2 - v1 + famp;
-
-      v1 = s->col_out2nd[0].v2;
-      s->col_out2nd[0].v2 = s->col_out2nd[0].v3;
-      s->col_out2nd[0].v3 =
-          s->col_out2nd[0].fac * s->col_out2nd[0].v2 - v1 + famp;
-
-      v1 = s->row_out2nd[0].v2;
-      s->row_out2nd[0].v2 = s->row_out2nd[0].v3;
-      s->row_out2nd[0].v3 =
-          s->row_out2nd[0].fac * s->row_out2nd[0].v2 - v1 + famp;
-
-      v1 = s->col_out2nd[1].v2;
-      s->col_out2nd[1].v2 = s->col_out2nd[1].v3;
-      s->col_out2nd[1].v3 =
-          s->col_out2nd[1].fac * s->col_out2nd[1].v2 - v1 + famp;
-
-      v1 = s->row_out2nd[1].v2;
-      s->row_out2nd[1].v2 = s->row_out2nd[1].v3;
-      s->row_out2nd[1].v3 =
-          s->row_out2nd[1].fac * s->row_out2nd[1].v2 - v1 + famp;
-
-      v1 = s->col_out2nd[2].v2;
-      s->col_out2nd[2].v2 = s->col_out2nd[2].v3;
-      s->col_out2nd[2].v3 =
-          s->col_out2nd[2].fac * s->col_out2nd[2].v2 - v1 + famp;
-
-      v1 = s->row_out2nd[2].v2;
-      s->row_out2nd[2].v2 = s->row_out2nd[2].v3;
-      s->row_out2nd[2].v3 =
-          s->row_out2nd[2].fac * s->row_out2nd[2].v2 - v1 + famp;
-
-      v1 = s->col_out2nd[3].v2;
-      s->col_out2nd[3].v2 = s->col_out2nd[3].v3;
-      s->col_out2nd[3].v3 =
-          s->col_out2nd[3].fac * s->col_out2nd[3].v2 - v1 + famp;
-
-      v1 = s->row_out2nd[3].v2;
-      s->row_out2nd[3].v2 = s->row_out2nd[3].v3;
-      s->row_out2nd[3].v3 =
-          s->row_out2nd[3].fac * s->row_out2nd[3].v2 - v1 + famp;
-
-      /* Update fax tone */
-      v1 = s->fax_tone.v2;
-      s->fax_tone.v2 = s->fax_tone.v3;
-      s->fax_tone.v3 = s->fax_tone.fac * s->fax_tone.v2 - v1 + famp;
-
-      v1 = s->fax_tone.v2;
-      s->fax_tone2nd.v2 = s->fax_tone2nd.v3;
-      s->fax_tone2nd.v3 = s->fax_tone2nd.fac * s->fax_tone2nd.v2 - v1 + famp;
+
+    for (j = 0; j < limit - sample; j++) {
+      famp[j] = amp[(sample + j) * stride];
+      s->energy += famp[j] * famp[j];
     }
-#endif
+    goertzel_bank_update (&s->tones, famp, limit - sample);
+
     s->current_sample += (limit - sample);
-    if (s->current_sample < 102)
+    if (s->current_sample < DTMF_BLOCK_SIZE)
       continue;
 
     /* Detect the fax energy, too */
-    fax_energy = zap_goertzel_result (&s->fax_tone);
+    fax_energy = goertzel_bank_result (&s->tones, DTMF_TONE_FAX);
 
     /* We are at the end of a DTMF detection block */
     /* Find the peak row and the peak column */
-    row_energy[0] = zap_goertzel_result (&s->row_out[0]);
-    col_energy[0] = zap_goertzel_result (&s->col_out[0]);
+    row_energy[0] = goertzel_bank_result (&s->tones, DTMF_TONE_ROW (0));
+    col_energy[0] = goertzel_bank_result (&s->tones, DTMF_TONE_COL (0));
 
     for (best_row = best_col = 0, i = 1; i < 4; i++) {
-      row_energy[i] = zap_goertzel_result (&s->row_out[i]);
+      row_energy[i] = goertzel_bank_result (&s->tones, DTMF_TONE_ROW (i));
       if (row_energy[i] > row_energy[best_row])
         best_row = i;
-      col_energy[i] = zap_goertzel_result (&s->col_out[i]);
+      col_energy[i] = goertzel_bank_result (&s->tones, DTMF_TONE_COL (i));
       if (col_energy[i] > col_energy[best_col])
         best_col = i;
     }
@@ -411,9 +256,9 @@ zap_dtmf_detect (dtmf_detect_state_t * s,
           &&
           (row_energy[best_row] + col_energy[best_col]) > 42.0 * s->energy
           &&
-          zap_goertzel_result (&s->col_out2nd[best_col]) *
+          goertzel_bank_result (&s->tones, DTMF_TONE_COL_2ND (best_col)) *
           DTMF_2ND_HARMONIC_COL < col_energy[best_col]
-          && zap_goertzel_result (&s->row_out2nd[best_row]) *
+          && goertzel_bank_result (&s->tones, DTMF_TONE_ROW_2ND (best_row)) *
           DTMF_2ND_HARMONIC_ROW < row_energy[best_row]) {
         hit = dtmf_positions[(best_row << 2) + best_col];
         /* Look for two successive similar results */
@@ -438,7 +283,7 @@ zap_dtmf_detect (dtmf_detect_state_t * s,
     }
     if (!hit && (fax_energy >= FAX_THRESHOLD)
         && (fax_energy > s->energy * 21.0)) {
-      fax_energy_2nd = zap_goertzel_result (&s->fax_tone2nd);
+      fax_energy_2nd = goertzel_bank_result (&s->tones, DTMF_TONE_FAX_2ND);
       if (fax_energy_2nd * FAX_2ND_HARMONIC < fax_energy) {
 #if 0
         printf ("Fax energy/Second Harmonic: %f/%f\n", fax_energy,
@@ -465,14 +310,7 @@ zap_dtmf_detect (dtmf_detect_state_t * s,
     s->hit2 = s->hit3;
     s->hit3 = hit;
     /* Reinitialise the detector for the next block */
-    for (i = 0; i < 4; i++) {
-      goertzel_init (&s->row_out[i], &dtmf_detect_row[i]);
-      goertzel_init (&s->col_out[i], &dtmf_detect_col[i]);
-      goertzel_init (&s->row_out2nd[i], &dtmf_detect_row_2nd[i]);
-      goertzel_init (&s->col_out2nd[i], &dtmf_detect_col_2nd[i]);
-    }
-    goertzel_init (&s->fax_tone, &fax_detect);
-    goertzel_init (&s->fax_tone2nd, &fax_detect_2nd);
+    goertzel_bank_init (&s->tones);
     s->energy = 0.0;
     s->current_sample = 0;
   }
@@ -485,6 +323,30 @@ zap_dtmf_detect (dtmf_detect_state_t * s,
 
 /*- End of function --------------------------------------------------------*/
 
+int
+zap_dtmf_detect (dtmf_detect_state_t * s,
+    int16_t amp[], int samples, int isradio)
+{
+  return dtmf_detect_strided (s, amp, 1, samples, isradio);
+}
+
+/*- End of function --------------------------------------------------------*/
+
+/* Runs the detectors of @n_streams streams over @samples frames of
+   interleaved data, stream i being the i'th sample of each frame. The
+   streams are detected one after the other, each in a strided pass. */
+void
+zap_dtmf_detect_multi (dtmf_detect_state_t s[],
+    int n_streams, int16_t amp[], int samples, int isradio)
+{
+  int i;
+
+  for (i = 0; i < n_streams; i++)
+    dtmf_detect_strided (&s[i], amp + i, n_streams, samples, isradio);
+}
+
+/*- End of function --------------------------------------------------------*/
+
 int
 zap_dtmf_get (dtmf_detect_state_t * s, char *buf, int max)
 {
@@ -44,6 +44,29 @@ typedef struct
     float fac;
 } goertzel_state_t;
 
+/* All the tones of the DTMF detector are run as one bank of filters, one
+   lane per tone, so that they can be updated together over a block of
+   samples:
+     0 - 3    rows
+     4 - 7    columns
+     8 - 11   second harmonics of the rows
+     12 - 15  second harmonics of the columns
+     16, 17   fax tone and its second harmonic
+   The bank is padded to a multiple of 4 lanes, the padding is unused. */
+#define DTMF_TONE_ROW(i)        (i)
+#define DTMF_TONE_COL(i)        (4 + (i))
+#define DTMF_TONE_ROW_2ND(i)    (8 + (i))
+#define DTMF_TONE_COL_2ND(i)    (12 + (i))
+#define DTMF_TONE_FAX           16
+#define DTMF_TONE_FAX_2ND       17
+#define DTMF_TONE_LANES         20
+
+typedef struct
+{
+    float v2[DTMF_TONE_LANES];
+    float v3[DTMF_TONE_LANES];
+} goertzel_bank_t;
+
 #define	MAX_DTMF_DIGITS 128
 
 typedef struct
@@ -54,12 +77,7 @@ typedef struct
     int hit4;
     int mhit;
 
-    goertzel_state_t row_out[4];
-    goertzel_state_t col_out[4];
-    goertzel_state_t row_out2nd[4];
-    goertzel_state_t col_out2nd[4];
-	goertzel_state_t fax_tone;
-	goertzel_state_t fax_tone2nd;
+    goertzel_bank_t tones;
     float energy;
     
     int current_sample;
@@ -86,6 +104,11 @@ int zap_dtmf_detect (dtmf_detect_state_t *s,
                  gint16 amp[],
                  int samples,
 		 int isradio);
+void zap_dtmf_detect_multi (dtmf_detect_state_t s[],
+                 int n_streams,
+                 gint16 amp[],
+                 int samples,
+                 int isradio);
 int zap_dtmf_get (dtmf_detect_state_t *s,
               char *buf,
               int max);
@@ -62,6 +62,7 @@
 
 #include <gst/gst.h>
 #include <gst/video/video.h>
+#include <gst/bandpool/gstbandpool.h>
 #include <string.h>
 #include <stdlib.h>             /* for abs() */
 
@@ -82,6 +83,10 @@ GST_DEBUG_CATEGORY_STATIC (gst_field_analysis_debug);
 #define DEFAULT_BLOCK_HEIGHT 16
 #define DEFAULT_BLOCK_THRESH 80
 #define DEFAULT_IGNORED_LINES 2
+#define DEFAULT_N_THREADS 0
+
+/* don't split frames into bands of fewer lines than this */
+#define MIN_BAND_HEIGHT 16
 
 enum
 {
@@ -96,7 +101,8 @@ enum
   PROP_BLOCK_WIDTH,
   PROP_BLOCK_HEIGHT,
   PROP_BLOCK_THRESH,
-  PROP_IGNORED_LINES
+  PROP_IGNORED_LINES,
+  PROP_N_THREADS
 };
 
 static GstStaticPadTemplate sink_factory =
@@ -188,7 +194,7 @@ gst_fieldanalysis_frame_metric_get_type (void)
     static const GEnumValue fieldanalyis_frame_metrics[] = {
       {GST_FIELDANALYSIS_5_TAP, "5-tap [1,-3,4,-3,1] Vertical Filter", "5-tap"},
       {GST_FIELDANALYSIS_WINDOWED_COMB,
-            "Windowed Comb Detection (not optimised)",
+            "Windowed Comb Detection",
           "windowed-comb"},
       {0, NULL, NULL},
     };
@@ -291,6 +297,11 @@ gst_field_analysis_class_init (GstFieldAnalysisClass * klass)
           "Ignore this many lines from the top and bottom for windowed comb detection",
           2, G_MAXUINT64, DEFAULT_IGNORED_LINES,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of horizontal bands analysed in parallel "
+          "(0 = number of processors)", 0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_field_analysis_change_state);
@@ -304,14 +315,9 @@ static gfloat same_parity_3_tap (GstFieldAnalysis * filter,
     FieldAnalysisFields * fields);
 static gfloat opposite_parity_5_tap (GstFieldAnalysis * filter,
     FieldAnalysisFields * fields);
-static guint64 block_score_for_row_32detect (GstFieldAnalysis * filter,
-    guint8 * base_fj, guint8 * base_fjp1);
-static guint64 block_score_for_row_iscombed (GstFieldAnalysis * filter,
-    guint8 * base_fj, guint8 * base_fjp1);
-static guint64 block_score_for_row_5_tap (GstFieldAnalysis * filter,
-    guint8 * base_fj, guint8 * base_fjp1);
 static gfloat opposite_parity_windowed_comb (GstFieldAnalysis * filter,
     FieldAnalysisFields * fields);
+static void gst_field_analysis_free_bands (GstFieldAnalysis * filter);
 
 static void
 gst_field_analysis_empty_queue (GstFieldAnalysis * filter)
@@ -337,10 +343,7 @@ gst_field_analysis_reset (GstFieldAnalysis * filter)
   filter->is_telecine = FALSE;
   filter->first_buffer = TRUE;
   filter->width = 0;
-  g_free (filter->comb_mask);
-  filter->comb_mask = NULL;
-  g_free (filter->block_scores);
-  filter->block_scores = NULL;
+  gst_field_analysis_free_bands (filter);
 }
 
 static void
@@ -371,12 +374,13 @@ gst_field_analysis_init (GstFieldAnalysis * filter,
   filter->same_frame = &opposite_parity_5_tap;
   filter->frame_thresh = DEFAULT_FRAME_THRESH;
   filter->noise_floor = DEFAULT_NOISE_FLOOR;
-  filter->block_score_for_row = &block_score_for_row_5_tap;
+  filter->comb_method = DEFAULT_COMB_METHOD;
   filter->spatial_thresh = DEFAULT_SPATIAL_THRESH;
   filter->block_width = DEFAULT_BLOCK_WIDTH;
   filter->block_height = DEFAULT_BLOCK_HEIGHT;
   filter->block_thresh = DEFAULT_BLOCK_THRESH;
   filter->ignored_lines = DEFAULT_IGNORED_LINES;
+  filter->n_threads = DEFAULT_N_THREADS;
 }
 
 static void
@@ -423,36 +427,13 @@ gst_field_analysis_set_property (GObject * object, guint prop_id,
       filter->frame_thresh = g_value_get_float (value);
       break;
     case PROP_COMB_METHOD:
-      switch (g_value_get_enum (value)) {
-        case METHOD_32DETECT:
-          filter->block_score_for_row = &block_score_for_row_32detect;
-          break;
-        case METHOD_IS_COMBED:
-          filter->block_score_for_row = &block_score_for_row_iscombed;
-          break;
-        case METHOD_5_TAP:
-          filter->block_score_for_row = &block_score_for_row_5_tap;
-          break;
-        default:
-          break;
-      }
+      filter->comb_method = g_value_get_enum (value);
       break;
     case PROP_SPATIAL_THRESH:
       filter->spatial_thresh = g_value_get_int64 (value);
       break;
     case PROP_BLOCK_WIDTH:
       filter->block_width = g_value_get_uint64 (value);
-      if (filter->width) {
-        if (filter->block_scores) {
-          gsize nbytes = (filter->width / filter->block_width) * sizeof (guint);
-          filter->block_scores = g_realloc (filter->block_scores, nbytes);
-          memset (filter->block_scores, 0, nbytes);
-        } else {
-          filter->block_scores =
-              g_malloc0 ((filter->width / filter->block_width) *
-              sizeof (guint));
-        }
-      }
       break;
     case PROP_BLOCK_HEIGHT:
       filter->block_height = g_value_get_uint64 (value);
@@ -463,6 +444,9 @@ gst_field_analysis_set_property (GObject * object, guint prop_id,
     case PROP_IGNORED_LINES:
       filter->ignored_lines = g_value_get_uint64 (value);
       break;
+    case PROP_N_THREADS:
+      filter->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -510,18 +494,8 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
       g_value_set_float (value, filter->frame_thresh);
       break;
     case PROP_COMB_METHOD:
-    {
-      FieldAnalysisCombMethod method = DEFAULT_COMB_METHOD;
-      if (filter->block_score_for_row == &block_score_for_row_32detect) {
-        method = METHOD_32DETECT;
-      } else if (filter->block_score_for_row == &block_score_for_row_iscombed) {
-        method = METHOD_IS_COMBED;
-      } else if (filter->block_score_for_row == &block_score_for_row_5_tap) {
-        method = METHOD_5_TAP;
-      }
-      g_value_set_enum (value, method);
+      g_value_set_enum (value, filter->comb_method);
       break;
-    }
     case PROP_SPATIAL_THRESH:
       g_value_set_int64 (value, filter->spatial_thresh);
       break;
@@ -537,6 +511,9 @@ gst_field_analysis_get_property (GObject * object, guint prop_id,
     case PROP_IGNORED_LINES:
       g_value_set_uint64 (value, filter->ignored_lines);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, filter->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -592,20 +569,9 @@ gst_field_analysis_update_format (GstFieldAnalysis * filter, GstCaps * caps)
   filter->sample_incr = sample_incr;
   filter->line_stride = line_stride;
 
-  /* update allocations for metric scores */
-  if (filter->comb_mask) {
-    filter->comb_mask = g_realloc (filter->comb_mask, width);
-  } else {
-    filter->comb_mask = g_malloc (width);
-  }
-  if (filter->block_scores) {
-    gsize nbytes = (width / filter->block_width) * sizeof (guint);
-    filter->block_scores = g_realloc (filter->block_scores, nbytes);
-    memset (filter->block_scores, 0, nbytes);
-  } else {
-    filter->block_scores =
-        g_malloc0 ((width / filter->block_width) * sizeof (guint));
-  }
+  /* the comb detection scratch is reallocated for the new width on the next
+   * frame */
+  gst_field_analysis_free_bands (filter);
 
   GST_OBJECT_UNLOCK (filter);
   return;
@@ -828,11 +794,95 @@ gst_field_analysis_sink_event (GstPad * pad, GstEvent * event)
 }
 
 
-static gfloat
-same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
+static void
+gst_field_analysis_band_func (gpointer data, gpointer user_data)
+{
+  FieldAnalysisBand *band = data;
+  GstFieldAnalysis *filter = user_data;
+
+  band->result = filter->band_func (filter, filter->band_fields, band);
+}
+
+static void
+gst_field_analysis_free_bands (GstFieldAnalysis * filter)
+{
+  guint i;
+
+  for (i = 0; i < filter->n_bands; i++) {
+    g_free (filter->bands[i].comb_mask);
+    g_free (filter->bands[i].comb_counts);
+  }
+  g_free (filter->bands);
+  filter->bands = NULL;
+  filter->n_bands = 0;
+}
+
+static void
+gst_field_analysis_alloc_bands (GstFieldAnalysis * filter, guint n_bands)
+{
+  guint i;
+
+  if (filter->n_bands == n_bands)
+    return;
+
+  gst_field_analysis_free_bands (filter);
+
+  /* each band has its own comb detection scratch with room for one sample
+   * either side of the line */
+  filter->bands = g_new0 (FieldAnalysisBand, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    filter->bands[i].comb_mask = g_malloc (filter->width + 2);
+    filter->bands[i].comb_counts = g_new (guint32, filter->width);
+  }
+  filter->n_bands = n_bands;
+}
+
+/* splits the items [0, n_items) - lines of a field or rows of blocks - into
+ * bands that are evaluated in parallel and returns the sum of the band
+ * results, or their maximum if max is set. integer results make the outcome
+ * independent of the number of bands
+ *
+ * must be called with the object lock */
+static guint64
+gst_field_analysis_run_bands (GstFieldAnalysis * filter,
+    FieldAnalysisFields * fields, FieldAnalysisBandFunc func, gint n_items,
+    gboolean max)
+{
+  guint64 result;
+  guint n_bands, i;
+
+  n_bands = gst_band_pool_get_n_bands (filter->n_threads, filter->height,
+      MIN_BAND_HEIGHT);
+  gst_field_analysis_alloc_bands (filter, n_bands);
+
+  for (i = 0; i < n_bands; i++) {
+    filter->bands[i].start = n_items * i / n_bands;
+    filter->bands[i].end = n_items * (i + 1) / n_bands;
+  }
+
+  filter->band_func = func;
+  filter->band_fields = fields;
+  gst_band_pool_run (gst_band_pool_get_default (),
+      gst_field_analysis_band_func, filter, filter->bands,
+      sizeof (FieldAnalysisBand), n_bands);
+
+  result = 0;
+  for (i = 0; i < n_bands; i++) {
+    if (!max)
+      result += filter->bands[i].result;
+    else if (filter->bands[i].result > result)
+      result = filter->bands[i].result;
+  }
+
+  return result;
+}
+
+static guint64
+same_parity_sad_band (GstFieldAnalysis * filter, FieldAnalysisFields * fields,
+    FieldAnalysisBand * band)
 {
   gint j;
-  gfloat sum;
+  guint64 sum;
   guint8 *f1j, *f2j;
 
   const gint y_offset = filter->data_offset;
@@ -840,11 +890,13 @@ same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
   const gint stridex2 = stride << 1;
   const guint32 noise_floor = filter->noise_floor;
 
-  f1j = GST_BUFFER_DATA (fields[0].buf) + y_offset + fields[0].parity * stride;
-  f2j = GST_BUFFER_DATA (fields[1].buf) + y_offset + fields[1].parity * stride;
+  f1j = GST_BUFFER_DATA (fields[0].buf) + y_offset + fields[0].parity * stride
+      + band->start * stridex2;
+  f2j = GST_BUFFER_DATA (fields[1].buf) + y_offset + fields[1].parity * stride
+      + band->start * stridex2;
 
-  sum = 0.0f;
-  for (j = 0; j < (filter->height >> 1); j++) {
+  sum = 0;
+  for (j = band->start; j < band->end; j++) {
     guint32 tempsum = 0;
     fieldanalysis_orc_same_parity_sad_planar_yuv (&tempsum, f1j, f2j,
         noise_floor, filter->width);
@@ -853,14 +905,24 @@ same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
     f2j += stridex2;
   }
 
-  return sum / (0.5f * filter->width * filter->height);
+  return sum;
 }
 
 static gfloat
-same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
+same_parity_sad (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
+{
+  guint64 sum = gst_field_analysis_run_bands (filter, fields,
+      same_parity_sad_band, filter->height >> 1, FALSE);
+
+  return sum / (0.5f * filter->width * filter->height);
+}
+
+static guint64
+same_parity_ssd_band (GstFieldAnalysis * filter, FieldAnalysisFields * fields,
+    FieldAnalysisBand * band)
 {
   gint j;
-  gfloat sum;
+  guint64 sum;
   guint8 *f1j, *f2j;
 
   const gint y_offset = filter->data_offset;
@@ -869,11 +931,13 @@ same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
   /* noise floor needs to be squared for SSD */
   const guint32 noise_floor = filter->noise_floor * filter->noise_floor;
 
-  f1j = GST_BUFFER_DATA (fields[0].buf) + y_offset + fields[0].parity * stride;
-  f2j = GST_BUFFER_DATA (fields[1].buf) + y_offset + fields[1].parity * stride;
+  f1j = GST_BUFFER_DATA (fields[0].buf) + y_offset + fields[0].parity * stride
+      + band->start * stridex2;
+  f2j = GST_BUFFER_DATA (fields[1].buf) + y_offset + fields[1].parity * stride
+      + band->start * stridex2;
 
-  sum = 0.0f;
-  for (j = 0; j < (filter->height >> 1); j++) {
+  sum = 0;
+  for (j = band->start; j < band->end; j++) {
     guint32 tempsum = 0;
     fieldanalysis_orc_same_parity_ssd_planar_yuv (&tempsum, f1j, f2j,
         noise_floor, filter->width);
@@ -882,16 +946,26 @@ same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
     f2j += stridex2;
   }
 
+  return sum;
+}
+
+static gfloat
+same_parity_ssd (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
+{
+  guint64 sum = gst_field_analysis_run_bands (filter, fields,
+      same_parity_ssd_band, filter->height >> 1, FALSE);
+
   return sum / (0.5f * filter->width * filter->height); /* field is half height */
 }
 
 /* horizontal [1,4,1] diff between fields - is this a good idea or should the
  * current sample be emphasised more or less? */
-static gfloat
-same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
+static guint64
+same_parity_3_tap_band (GstFieldAnalysis * filter,
+    FieldAnalysisFields * fields, FieldAnalysisBand * band)
 {
   gint i, j;
-  gfloat sum;
+  guint64 sum;
   guint8 *f1j, *f2j;
 
   const gint y_offset = filter->data_offset;
@@ -901,11 +975,13 @@ same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
   /* noise floor needs to be squared for [1,4,1] */
   const guint32 noise_floor = filter->noise_floor * 6;
 
-  f1j = GST_BUFFER_DATA (fields[0].buf) + y_offset + fields[0].parity * stride;
-  f2j = GST_BUFFER_DATA (fields[1].buf) + y_offset + fields[1].parity * stride;
+  f1j = GST_BUFFER_DATA (fields[0].buf) + y_offset + fields[0].parity * stride
+      + band->start * stridex2;
+  f2j = GST_BUFFER_DATA (fields[1].buf) + y_offset + fields[1].parity * stride
+      + band->start * stridex2;
 
-  sum = 0.0f;
-  for (j = 0; j < (filter->height >> 1); j++) {
+  sum = 0;
+  for (j = band->start; j < band->end; j++) {
     guint32 tempsum = 0;
     guint32 diff;
 
@@ -931,28 +1007,36 @@ same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
     f2j += stridex2;
   }
 
+  return sum;
+}
+
+static gfloat
+same_parity_3_tap (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
+{
+  guint64 sum = gst_field_analysis_run_bands (filter, fields,
+      same_parity_3_tap_band, filter->height >> 1, FALSE);
+
   return sum / ((6.0f / 2.0f) * filter->width * filter->height);        /* 1 + 4 + 1 = 6; field is half height */
 }
 
 /* vertical [1,-3,4,-3,1] - same as is used in FieldDiff from TIVTC,
  * tritical's AVISynth IVTC filter */
 /* 0th field's parity defines operation */
-static gfloat
-opposite_parity_5_tap (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
+static guint64
+opposite_parity_5_tap_band (GstFieldAnalysis * filter,
+    FieldAnalysisFields * fields, FieldAnalysisBand * band)
 {
   gint j;
-  gfloat sum;
-  guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
-  guint32 tempsum;
+  guint64 sum;
+  guint8 *base_fj, *base_fjp1;
 
   const gint y_offset = filter->data_offset;
   const gint stride = filter->line_stride;
   const gint stridex2 = stride << 1;
+  const gint last = (filter->height >> 1) - 1;
   /* noise floor needs to be *6 for [1,-3,4,-3,1] */
   const guint32 noise_floor = filter->noise_floor * 6;
 
-  sum = 0.0f;
-
   /* fj is line j of the combined frame made from the top field even lines of
    *   field 0 and the bottom field odd lines from field 1
    * fjp1 is one line down from fj
@@ -960,344 +1044,178 @@ opposite_parity_5_tap (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
    * fj with j == 0 is the 0th line of the top field
    * fj with j == 1 is the 0th line of the bottom field or the 1st field of
    *   the frame*/
-
-  /* unroll first line as it is a special case */
   if (fields[0].parity == TOP_FIELD) {
-    fj = GST_BUFFER_DATA (fields[0].buf) + y_offset;
-    fjp1 = GST_BUFFER_DATA (fields[1].buf) + y_offset + stride;
+    base_fj = GST_BUFFER_DATA (fields[0].buf) + y_offset;
+    base_fjp1 = GST_BUFFER_DATA (fields[1].buf) + y_offset + stride;
   } else {
-    fj = GST_BUFFER_DATA (fields[1].buf) + y_offset;
-    fjp1 = GST_BUFFER_DATA (fields[0].buf) + y_offset + stride;
-  }
-  fjp2 = fj + stridex2;
-
-  tempsum = 0;
-  fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjp2, fjp1, fj,
-      fjp1, fjp2, noise_floor, filter->width);
-  sum += tempsum;
-
-  for (j = 1; j < (filter->height >> 1) - 1; j++) {
-    /* shift everything down a line in the field of interest (means += stridex2) */
-    fjm2 = fj;
-    fjm1 = fjp1;
-    fj = fjp2;
-    fjp1 += stridex2;
-    fjp2 += stridex2;
-
-    tempsum = 0;
-    fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjm2, fjm1,
-        fj, fjp1, fjp2, noise_floor, filter->width);
-    sum += tempsum;
+    base_fj = GST_BUFFER_DATA (fields[1].buf) + y_offset;
+    base_fjp1 = GST_BUFFER_DATA (fields[0].buf) + y_offset + stride;
   }
 
-  /* unroll the last line as it is a special case */
-  /* shift everything down a line in the field of interest (means += stridex2) */
-  fjm2 = fj;
-  fjm1 = fjp1;
-  fj = fjp2;
-
-  tempsum = 0;
-  fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum, fjm2, fjm1, fj,
-      fjm1, fjm2, noise_floor, filter->width);
-  sum += tempsum;
-
-  return sum / ((6.0f / 2.0f) * filter->width * filter->height);        /* 1 + 4 + 1 == 3 + 3 == 6; field is half height */
-}
-
-/* this metric was sourced from HandBrake but originally from transcode
- * the return value is the highest block score for the row of blocks */
-static inline guint64
-block_score_for_row_32detect (GstFieldAnalysis * filter, guint8 * base_fj,
-    guint8 * base_fjp1)
-{
-  guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
-  guint8 *fjm2, *fjm1, *fj, *fjp1;
-  const gint incr = filter->sample_incr;
-  const gint stridex2 = filter->line_stride << 1;
-  const guint64 block_width = filter->block_width;
-  const guint64 block_height = filter->block_height;
-  const gint64 spatial_thresh = filter->spatial_thresh;
-  const gint width = filter->width - (filter->width % block_width);
-
-  fjm2 = base_fj - stridex2;
-  fjm1 = base_fjp1 - stridex2;
-  fj = base_fj;
-  fjp1 = base_fjp1;
-
-  for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
+  sum = 0;
+  for (j = band->start; j < band->end; j++) {
+    guint8 *fj = base_fj + j * stridex2;
+    guint8 *fjp1 = base_fjp1 + j * stridex2;
+    guint32 tempsum = 0;
 
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
-    /* change in the same direction */
-    if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-        || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] = abs (fj[0] - fjm2[0]) < 10 && abs (fj[0] - fjm1[0]) > 15;
+    if (j == 0) {
+      /* the first line is a special case, mirror the lines below it */
+      fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum,
+          fj + stridex2, fjp1, fj, fjp1, fj + stridex2, noise_floor,
+          filter->width);
+    } else if (j == last) {
+      /* as is the last line, mirror the lines above it */
+      fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum,
+          fj - stridex2, fjp1 - stridex2, fj, fjp1 - stridex2, fj - stridex2,
+          noise_floor, filter->width);
     } else {
-      comb_mask[0] = FALSE;
-    }
-
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] = abs (fj[idx] - fjm2[idx]) < 10
-            && abs (fj[idx] - fjm1[idx]) > 15;
-      } else {
-        comb_mask[i] = FALSE;
-      }
-
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
+      fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (&tempsum,
+          fj - stridex2, fjp1 - stridex2, fj, fjp1, fj + stridex2,
+          noise_floor, filter->width);
     }
-    /* advance down a line */
-    fjm2 = fjm1;
-    fjm1 = fj;
-    fj = fjp1;
-    fjp1 = fjm1 + stridex2;
-  }
-
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
+    sum += tempsum;
   }
 
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
+  return sum;
 }
 
-/* this metric was sourced from HandBrake but originally from
- * tritical's isCombedT Avisynth function
- * the return value is the highest block score for the row of blocks */
-static inline guint64
-block_score_for_row_iscombed (GstFieldAnalysis * filter, guint8 * base_fj,
-    guint8 * base_fjp1)
+static gfloat
+opposite_parity_5_tap (GstFieldAnalysis * filter, FieldAnalysisFields * fields)
 {
-  guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
-  guint64 block_score;
-  guint8 *fjm1, *fj, *fjp1;
-  const gint incr = filter->sample_incr;
-  const gint stridex2 = filter->line_stride << 1;
-  const guint64 block_width = filter->block_width;
-  const guint64 block_height = filter->block_height;
-  const gint64 spatial_thresh = filter->spatial_thresh;
-  const gint64 spatial_thresh_squared = spatial_thresh * spatial_thresh;
-  const gint width = filter->width - (filter->width % block_width);
+  guint64 sum = gst_field_analysis_run_bands (filter, fields,
+      opposite_parity_5_tap_band, filter->height >> 1, FALSE);
 
-  fjm1 = base_fjp1 - stridex2;
-  fj = base_fj;
-  fjp1 = base_fjp1;
+  return sum / ((6.0f / 2.0f) * filter->width * filter->height);        /* 1 + 4 + 1 == 3 + 3 == 6; field is half height */
+}
 
-  for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
+/* marks the combed samples of a line in comb_mask; lines points at the lines
+ * two above to two below the line of interest
+ *
+ * 32-detect was sourced from HandBrake but originally from transcode and
+ * isCombed was sourced from HandBrake but originally from tritical's
+ * isCombedT Avisynth function */
+static void
+comb_mask_for_line (GstFieldAnalysis * filter, guint8 * comb_mask,
+    guint8 ** lines, gint width)
+{
+  gint i;
 
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
-    /* change in the same direction */
-    if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-        || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] =
-          (fjm1[0] - fj[0]) * (fjp1[0] - fj[0]) > spatial_thresh_squared;
-    } else {
-      comb_mask[0] = FALSE;
+  const gint incr = filter->sample_incr;
+  /* differences between samples never exceed 255 so larger thresholds can
+   * be clamped to keep the vectorised arithmetic in 16 bits */
+  const gint spatial_thresh = MIN (filter->spatial_thresh, 255);
+
+  if (incr == 1) {
+    switch (filter->comb_method) {
+      case METHOD_32DETECT:
+        fieldanalysis_orc_comb_mask_32detect (comb_mask, lines[0], lines[1],
+            lines[2], lines[3], spatial_thresh, -spatial_thresh, width);
+        break;
+      case METHOD_IS_COMBED:
+        /* when both differences exceed the spatial threshold in the same
+         * direction their product always exceeds its square, so the
+         * direction test is all that is needed */
+        fieldanalysis_orc_comb_mask_iscombed (comb_mask, lines[1], lines[2],
+            lines[3], spatial_thresh, -spatial_thresh, width);
+        break;
+      case METHOD_5_TAP:
+      default:
+        fieldanalysis_orc_comb_mask_5_tap (comb_mask, lines[0], lines[1],
+            lines[2], lines[3], lines[4], spatial_thresh, -spatial_thresh,
+            6 * spatial_thresh, width);
+        break;
     }
+    return;
+  }
 
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] =
-            (fjm1[idx] - fj[idx]) * (fjp1[idx] - fj[idx]) >
-            spatial_thresh_squared;
-      } else {
-        comb_mask[i] = FALSE;
-      }
+  /* samples of packed formats are not contiguous */
+  for (i = 0; i < width; i++) {
+    const gint idx = i * incr;
+    const gint fj = lines[2][idx];
+    const gint diff1 = fj - lines[1][idx];
+    const gint diff2 = fj - lines[3][idx];
+    gboolean combed;
 
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
+    /* change in the same direction */
+    combed = (diff1 > spatial_thresh && diff2 > spatial_thresh)
+        || (diff1 < -spatial_thresh && diff2 < -spatial_thresh);
+
+    if (combed && filter->comb_method == METHOD_32DETECT) {
+      combed = abs (fj - lines[0][idx]) < 10 && abs (diff1) > 15;
+    } else if (combed && filter->comb_method == METHOD_5_TAP) {
+      combed = abs (lines[0][idx] + (fj << 2) + lines[4][idx]
+          - 3 * (lines[1][idx] + lines[3][idx])) > 6 * spatial_thresh;
     }
-    /* advance down a line */
-    fjm1 = fj;
-    fj = fjp1;
-    fjp1 = fjm1 + stridex2;
-  }
 
-  block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
+    comb_mask[i] = combed;
   }
-
-  g_free (block_scores);
-  g_free (comb_mask);
-  return block_score;
 }
 
-/* this metric was sourced from HandBrake but originally from
- * tritical's isCombedT Avisynth function
+/* a sample counts towards the score of its block if it and both of its
+ * horizontal neighbours are combed
  * the return value is the highest block score for the row of blocks */
-static inline guint64
-block_score_for_row_5_tap (GstFieldAnalysis * filter, guint8 * base_fj,
-    guint8 * base_fjp1)
+static guint64
+block_score_for_row (GstFieldAnalysis * filter, FieldAnalysisBand * band,
+    guint8 * base_fj, guint8 * base_fjp1)
 {
-  guint64 i, j;
-  guint8 *comb_mask = filter->comb_mask;
-  guint *block_scores = filter->block_scores;
+  gint i, j, k;
   guint64 block_score;
-  guint8 *fjm2, *fjm1, *fj, *fjp1, *fjp2;
-  const gint incr = filter->sample_incr;
+  guint8 *lines[5];
+  guint8 *comb_mask = band->comb_mask + 1;
+  guint32 *comb_counts = band->comb_counts;
   const gint stridex2 = filter->line_stride << 1;
   const guint64 block_width = filter->block_width;
   const guint64 block_height = filter->block_height;
-  const gint64 spatial_thresh = filter->spatial_thresh;
-  const gint64 spatial_threshx6 = 6 * spatial_thresh;
   const gint width = filter->width - (filter->width % block_width);
 
-  fjm2 = base_fj - stridex2;
-  fjm1 = base_fjp1 - stridex2;
-  fj = base_fj;
-  fjp1 = base_fjp1;
-  fjp2 = fj + stridex2;
+  if (width <= 0)
+    return 0;
 
-  for (j = 0; j < block_height; j++) {
-    /* we have to work one result ahead of ourselves which results in some small
-     * peculiarities below */
-    gint diff1, diff2;
+  /* samples beyond the edges count as combed so that edge samples only need
+   * their one neighbour to be combed */
+  comb_mask[-1] = comb_mask[width] = TRUE;
+  memset (comb_counts, 0, width * sizeof (guint32));
 
-    diff1 = fj[0] - fjm1[0];
-    diff2 = fj[0] - fjp1[0];
-    /* change in the same direction */
-    if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-        || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-      comb_mask[0] =
-          abs (fjm2[0] + (fj[0] << 2) + fjp2[0] - 3 * (fjm1[0] + fjp1[0])) >
-          spatial_threshx6;
-
-      /* motion detection that needs previous and next frames
-         this isn't really necessary, but acts as an optimisation if the
-         additional delay isn't a problem
-         if (motion_detection) {
-         if (abs(fpj[idx] - fj[idx]               ) > motion_thresh &&
-         abs(           fjm1[idx] - fnjm1[idx]) > motion_thresh &&
-         abs(           fjp1[idx] - fnjp1[idx]) > motion_thresh)
-         motion++;
-         if (abs(             fj[idx]   - fnj[idx]) > motion_thresh &&
-         abs(fpjm1[idx] - fjm1[idx]           ) > motion_thresh &&
-         abs(fpjp1[idx] - fjp1[idx]           ) > motion_thresh)
-         motion++;
-         } else {
-         motion = 1;
-         }
-       */
-    } else {
-      comb_mask[0] = FALSE;
+  for (j = 0; j < block_height; j++) {
+    /* even lines of the row are in the field of base_fj and odd lines are in
+     * the field of base_fjp1 */
+    for (k = 0; k < 5; k++) {
+      const gint line = j + k - 2;
+
+      if (line & 1)
+        lines[k] = base_fjp1 + ((line - 1) / 2) * stridex2;
+      else
+        lines[k] = base_fj + (line / 2) * stridex2;
     }
 
-    for (i = 1; i < width; i++) {
-      const guint64 idx = i * incr;
-      const guint64 res_idx = (i - 1) / block_width;
-
-      diff1 = fj[idx] - fjm1[idx];
-      diff2 = fj[idx] - fjp1[idx];
-      if ((diff1 > spatial_thresh && diff2 > spatial_thresh)
-          || (diff1 < -spatial_thresh && diff2 < -spatial_thresh)) {
-        comb_mask[i] =
-            abs (fjm2[idx] + (fj[idx] << 2) + fjp2[idx] - 3 * (fjm1[idx] +
-                fjp1[idx])) > spatial_threshx6;
-      } else {
-        comb_mask[i] = FALSE;
-      }
-
-      if (i == 1 && comb_mask[i - 1] && comb_mask[i]) {
-        /* left edge */
-        block_scores[res_idx]++;
-      } else if (i == width - 1) {
-        /* right edge */
-        if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i])
-          block_scores[res_idx]++;
-        if (comb_mask[i - 1] && comb_mask[i])
-          block_scores[i / block_width]++;
-      } else if (comb_mask[i - 2] && comb_mask[i - 1] && comb_mask[i]) {
-        block_scores[res_idx]++;
-      }
-    }
-    /* advance down a line */
-    fjm2 = fjm1;
-    fjm1 = fj;
-    fj = fjp1;
-    fjp1 = fjp2;
-    fjp2 = fj + stridex2;
+    comb_mask_for_line (filter, comb_mask, lines, width);
+    fieldanalysis_orc_comb_count (comb_counts, comb_mask - 1, comb_mask,
+        comb_mask + 1, width);
   }
 
   block_score = 0;
-  for (i = 0; i < width / block_width; i++) {
-    if (block_scores[i] > block_score)
-      block_score = block_scores[i];
+  for (i = 0; i < width; i += block_width) {
+    guint64 score = 0;
+
+    for (k = i; k < i + block_width; k++)
+      score += comb_counts[k];
+    if (score > block_score)
+      block_score = score;
   }
 
-  g_free (block_scores);
-  g_free (comb_mask);
   return block_score;
 }
 
-/* a pass is made over the field using one of three comb-detection metrics
-   and the results are then analysed block-wise. if the samples to the left
-   and right are combed, they contribute to the block score. if the block
-   score is above the given threshold, the frame is combed. if the block
-   score is between half the threshold and the threshold, the block is
-   slightly combed. if when analysis is complete, slight combing is detected
-   that is returned. if any results are observed that are above the threshold,
-   the function returns immediately */
 /* 0th field's parity defines operation */
-static gfloat
-opposite_parity_windowed_comb (GstFieldAnalysis * filter,
-    FieldAnalysisFields * fields)
+static guint64
+opposite_parity_windowed_comb_band (GstFieldAnalysis * filter,
+    FieldAnalysisFields * fields, FieldAnalysisBand * band)
 {
   gint j;
-  gboolean slightly_combed;
+  guint64 max_score;
 
   const gint y_offset = filter->data_offset;
   const gint stride = filter->line_stride;
-  const guint64 block_thresh = filter->block_thresh;
   const guint64 block_height = filter->block_height;
   guint8 *base_fj, *base_fjp1;
 
@@ -1309,33 +1227,58 @@ opposite_parity_windowed_comb (GstFieldAnalysis * filter,
     base_fjp1 = GST_BUFFER_DATA (fields[0].buf) + y_offset + stride;
   }
 
-  /* we operate on a row of blocks of height block_height through each iteration */
-  slightly_combed = FALSE;
-  for (j = 0; j <= filter->height - filter->ignored_lines - block_height;
-      j += block_height) {
-    guint64 line_offset = (filter->ignored_lines + j) * stride;
-    guint block_score =
-        filter->block_score_for_row (filter, base_fj + line_offset,
-        base_fjp1 + line_offset);
-
-    if (block_score > (block_thresh >> 1)
-        && block_score <= block_thresh) {
-      /* blend if nothing more combed comes along */
-      slightly_combed = TRUE;
-    } else if (block_score > block_thresh) {
-      GstCaps *caps = GST_BUFFER_CAPS (fields[0].buf);
-      GstStructure *struc = gst_caps_get_structure (caps, 0);
-      gboolean interlaced;
-      if (gst_structure_get_boolean (struc, "interlaced", &interlaced)
-          && interlaced == TRUE) {
-        return 1.0f;            /* blend */
-      } else {
-        return 2.0f;            /* deinterlace */
-      }
+  max_score = 0;
+  for (j = band->start; j < band->end; j++) {
+    guint64 line_offset = (filter->ignored_lines + j * block_height) * stride;
+    guint64 block_score = block_score_for_row (filter, band,
+        base_fj + line_offset, base_fjp1 + line_offset);
+
+    if (block_score > max_score) {
+      max_score = block_score;
+      /* the rest of the band cannot change the outcome */
+      if (max_score > filter->block_thresh)
+        break;
+    }
+  }
+
+  return max_score;
+}
+
+static gfloat
+opposite_parity_windowed_comb (GstFieldAnalysis * filter,
+    FieldAnalysisFields * fields)
+{
+  gint n_rows = 0;
+  guint64 block_score;
+
+  const guint64 block_thresh = filter->block_thresh;
+  const guint64 block_height = filter->block_height;
+
+  /* we operate on rows of blocks of height block_height, one starting every
+   * block_height lines below the ignored lines */
+  if (filter->block_width && block_height
+      && filter->height >= filter->ignored_lines + block_height)
+    n_rows =
+        (filter->height - filter->ignored_lines - block_height) / block_height
+        + 1;
+
+  block_score = gst_field_analysis_run_bands (filter, fields,
+      opposite_parity_windowed_comb_band, n_rows, TRUE);
+
+  if (block_score > block_thresh) {
+    GstCaps *caps = GST_BUFFER_CAPS (fields[0].buf);
+    GstStructure *struc = gst_caps_get_structure (caps, 0);
+    gboolean interlaced;
+    if (gst_structure_get_boolean (struc, "interlaced", &interlaced)
+        && interlaced == TRUE) {
+      return 1.0f;              /* blend */
+    } else {
+      return 2.0f;              /* deinterlace */
     }
   }
 
-  return (gfloat) slightly_combed;      /* TRUE means blend, else don't */
+  /* blend if nothing more combed came along */
+  return (gfloat) (block_score > (block_thresh >> 1));  /* TRUE means blend, else don't */
 }
 
 /* this is where the magic happens
@@ -62,6 +62,7 @@ typedef struct _GstFieldAnalysis GstFieldAnalysis;
 typedef struct _GstFieldAnalysisClass GstFieldAnalysisClass;
 typedef struct _FieldAnalysisFields FieldAnalysisFields;
 typedef struct _FieldAnalysis FieldAnalysis;
+typedef struct _FieldAnalysisBand FieldAnalysisBand;
 
 typedef enum
 {
@@ -101,6 +102,17 @@ typedef enum
   METHOD_5_TAP
 } FieldAnalysisCombMethod;
 
+struct _FieldAnalysisBand
+{
+  gint start, end; /* range of field lines or rows of blocks of the band */
+  guint64 result;
+  guint8 *comb_mask; /* comb detection scratch, one sample wider either side */
+  guint32 *comb_counts;
+};
+
+typedef guint64 (*FieldAnalysisBandFunc) (GstFieldAnalysis * filter,
+    FieldAnalysisFields * fields, FieldAnalysisBand * band);
+
 struct _GstFieldAnalysis
 {
   GstElement element;
@@ -115,14 +127,18 @@ struct _GstFieldAnalysis
   FieldAnalysis results[2];
   gfloat (*same_field) (GstFieldAnalysis *, FieldAnalysisFields *);
   gfloat (*same_frame) (GstFieldAnalysis *, FieldAnalysisFields *);
-  guint64 (*block_score_for_row) (GstFieldAnalysis *, guint8 *, guint8 *);
+  FieldAnalysisCombMethod comb_method;
   gboolean is_telecine;
   gboolean first_buffer; /* indicates the first buffer for which a buffer will be output
                           * after a discont or flushing seek */
-  guint8 *comb_mask;
-  guint *block_scores;
   gboolean flushing;     /* indicates whether we are flushing or not */
 
+  /* bands of the frame analysed in parallel */
+  FieldAnalysisBand *bands;
+  guint n_bands;
+  FieldAnalysisBandFunc band_func;
+  FieldAnalysisFields *band_fields;
+
   /* properties */
   guint32 noise_floor; /* threshold for the result of a metric to be valid */
   gfloat field_thresh; /* threshold used for the same parity field metric */
@@ -131,6 +147,7 @@ struct _GstFieldAnalysis
   guint64 block_width, block_height; /* width/height of window used for comb clusted detection */
   guint64 block_thresh;
   guint64 ignored_lines;
+  guint n_threads; /* number of bands analysed in parallel, 0 = number of processors */
 };
 
 struct _GstFieldAnalysisClass
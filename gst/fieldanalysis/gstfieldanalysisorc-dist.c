@@ -98,6 +98,20 @@ void fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (guint32 *
     const orc_uint8 * ORC_RESTRICT s2, const orc_uint8 * ORC_RESTRICT s3,
     const orc_uint8 * ORC_RESTRICT s4, const orc_uint8 * ORC_RESTRICT s5,
     int p2, int n);
+void fieldanalysis_orc_comb_mask_32detect (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    int p1, int p2, int n);
+void fieldanalysis_orc_comb_mask_iscombed (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int p1, int p2, int n);
+void fieldanalysis_orc_comb_mask_5_tap (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, int p1, int p2, int p3, int n);
+void fieldanalysis_orc_comb_count (guint32 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int n);
 
 
 /* begin Orc C target preamble */
@@ -1096,3 +1110,1180 @@ fieldanalysis_orc_opposite_parity_5_tap_planar_yuv (guint32 * ORC_RESTRICT a1,
   *a1 = orc_executor_get_accumulator (ex, ORC_VAR_A1);
 }
 #endif
+
+
+/* fieldanalysis_orc_comb_mask_32detect */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_32detect (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    int p1, int p2, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_int8 var35;
+  orc_union16 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_int8 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_int8 var64;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+
+  /* 8: loadpw */
+  var41.i = p1;
+  /* 12: loadpw */
+  var45.i = p2;
+  /* 21: loadpw */
+  var54.i = (int) 0x0000000a;   /* 10 or 4.94066e-323f */
+  /* 25: loadpw */
+  var58.i = (int) 0x0000000f;   /* 15 or 7.41098e-323f */
+  /* 29: loadpw */
+  var62.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var33 = ptr5[i];
+    /* 1: convubw */
+    var34.i = (orc_uint8) var33;
+    /* 2: loadb */
+    var35 = ptr6[i];
+    /* 3: convubw */
+    var36.i = (orc_uint8) var35;
+    /* 4: loadb */
+    var37 = ptr7[i];
+    /* 5: convubw */
+    var38.i = (orc_uint8) var37;
+    /* 6: subw */
+    var39.i = var36.i - var34.i;
+    /* 7: subw */
+    var40.i = var36.i - var38.i;
+    /* 9: cmpgtsw */
+    var42.i = (var39.i > var41.i) ? (~0) : 0;
+    /* 10: cmpgtsw */
+    var43.i = (var40.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var44.i = var42.i & var43.i;
+    /* 13: cmpgtsw */
+    var46.i = (var45.i > var39.i) ? (~0) : 0;
+    /* 14: cmpgtsw */
+    var47.i = (var45.i > var40.i) ? (~0) : 0;
+    /* 15: andw */
+    var48.i = var46.i & var47.i;
+    /* 16: orw */
+    var49.i = var44.i | var48.i;
+    /* 17: loadb */
+    var50 = ptr4[i];
+    /* 18: convubw */
+    var51.i = (orc_uint8) var50;
+    /* 19: subw */
+    var52.i = var36.i - var51.i;
+    /* 20: absw */
+    var53.i = ORC_ABS (var52.i);
+    /* 22: subw */
+    var55.i = var53.i - var54.i;
+    /* 23: shrsw */
+    var56.i = var55.i >> 15;
+    /* 24: absw */
+    var57.i = ORC_ABS (var39.i);
+    /* 26: cmpgtsw */
+    var59.i = (var57.i > var58.i) ? (~0) : 0;
+    /* 27: andw */
+    var60.i = var59.i & var56.i;
+    /* 28: andw */
+    var61.i = var49.i & var60.i;
+    /* 30: andw */
+    var63.i = var61.i & var62.i;
+    /* 31: convwb */
+    var64 = var63.i;
+    /* 32: storeb */
+    ptr0[i] = var64;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_32detect (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_int8 var35;
+  orc_union16 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_int8 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_union16 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_union16 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_int8 var64;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+
+  /* 8: loadpw */
+  var41.i = ex->params[24];
+  /* 12: loadpw */
+  var45.i = ex->params[25];
+  /* 21: loadpw */
+  var54.i = (int) 0x0000000a;   /* 10 or 4.94066e-323f */
+  /* 25: loadpw */
+  var58.i = (int) 0x0000000f;   /* 15 or 7.41098e-323f */
+  /* 29: loadpw */
+  var62.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var33 = ptr5[i];
+    /* 1: convubw */
+    var34.i = (orc_uint8) var33;
+    /* 2: loadb */
+    var35 = ptr6[i];
+    /* 3: convubw */
+    var36.i = (orc_uint8) var35;
+    /* 4: loadb */
+    var37 = ptr7[i];
+    /* 5: convubw */
+    var38.i = (orc_uint8) var37;
+    /* 6: subw */
+    var39.i = var36.i - var34.i;
+    /* 7: subw */
+    var40.i = var36.i - var38.i;
+    /* 9: cmpgtsw */
+    var42.i = (var39.i > var41.i) ? (~0) : 0;
+    /* 10: cmpgtsw */
+    var43.i = (var40.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var44.i = var42.i & var43.i;
+    /* 13: cmpgtsw */
+    var46.i = (var45.i > var39.i) ? (~0) : 0;
+    /* 14: cmpgtsw */
+    var47.i = (var45.i > var40.i) ? (~0) : 0;
+    /* 15: andw */
+    var48.i = var46.i & var47.i;
+    /* 16: orw */
+    var49.i = var44.i | var48.i;
+    /* 17: loadb */
+    var50 = ptr4[i];
+    /* 18: convubw */
+    var51.i = (orc_uint8) var50;
+    /* 19: subw */
+    var52.i = var36.i - var51.i;
+    /* 20: absw */
+    var53.i = ORC_ABS (var52.i);
+    /* 22: subw */
+    var55.i = var53.i - var54.i;
+    /* 23: shrsw */
+    var56.i = var55.i >> 15;
+    /* 24: absw */
+    var57.i = ORC_ABS (var39.i);
+    /* 26: cmpgtsw */
+    var59.i = (var57.i > var58.i) ? (~0) : 0;
+    /* 27: andw */
+    var60.i = var59.i & var56.i;
+    /* 28: andw */
+    var61.i = var49.i & var60.i;
+    /* 30: andw */
+    var63.i = var61.i & var62.i;
+    /* 31: convwb */
+    var64 = var63.i;
+    /* 32: storeb */
+    ptr0[i] = var64;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_32detect (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    int p1, int p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_32detect");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_32detect);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_constant (p, 4, 0x0000000a, "c1");
+      orc_program_add_constant (p, 4, 0x0000000f, "c2");
+      orc_program_add_constant (p, 4, 0x00000001, "c3");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T3, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_T3, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_P2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_P2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T3, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsw", 0, ORC_VAR_T3, ORC_VAR_T3, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T4, ORC_VAR_D1,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* fieldanalysis_orc_comb_mask_iscombed */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_iscombed (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int p1, int p2, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_int8 var35;
+  orc_union16 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_int8 var52;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+
+  /* 8: loadpw */
+  var41.i = p1;
+  /* 12: loadpw */
+  var45.i = p2;
+  /* 17: loadpw */
+  var50.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var33 = ptr4[i];
+    /* 1: convubw */
+    var34.i = (orc_uint8) var33;
+    /* 2: loadb */
+    var35 = ptr5[i];
+    /* 3: convubw */
+    var36.i = (orc_uint8) var35;
+    /* 4: loadb */
+    var37 = ptr6[i];
+    /* 5: convubw */
+    var38.i = (orc_uint8) var37;
+    /* 6: subw */
+    var39.i = var36.i - var34.i;
+    /* 7: subw */
+    var40.i = var36.i - var38.i;
+    /* 9: cmpgtsw */
+    var42.i = (var39.i > var41.i) ? (~0) : 0;
+    /* 10: cmpgtsw */
+    var43.i = (var40.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var44.i = var42.i & var43.i;
+    /* 13: cmpgtsw */
+    var46.i = (var45.i > var39.i) ? (~0) : 0;
+    /* 14: cmpgtsw */
+    var47.i = (var45.i > var40.i) ? (~0) : 0;
+    /* 15: andw */
+    var48.i = var46.i & var47.i;
+    /* 16: orw */
+    var49.i = var44.i | var48.i;
+    /* 18: andw */
+    var51.i = var49.i & var50.i;
+    /* 19: convwb */
+    var52 = var51.i;
+    /* 20: storeb */
+    ptr0[i] = var52;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_iscombed (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_int8 var35;
+  orc_union16 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_int8 var52;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+
+  /* 8: loadpw */
+  var41.i = ex->params[24];
+  /* 12: loadpw */
+  var45.i = ex->params[25];
+  /* 17: loadpw */
+  var50.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var33 = ptr4[i];
+    /* 1: convubw */
+    var34.i = (orc_uint8) var33;
+    /* 2: loadb */
+    var35 = ptr5[i];
+    /* 3: convubw */
+    var36.i = (orc_uint8) var35;
+    /* 4: loadb */
+    var37 = ptr6[i];
+    /* 5: convubw */
+    var38.i = (orc_uint8) var37;
+    /* 6: subw */
+    var39.i = var36.i - var34.i;
+    /* 7: subw */
+    var40.i = var36.i - var38.i;
+    /* 9: cmpgtsw */
+    var42.i = (var39.i > var41.i) ? (~0) : 0;
+    /* 10: cmpgtsw */
+    var43.i = (var40.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var44.i = var42.i & var43.i;
+    /* 13: cmpgtsw */
+    var46.i = (var45.i > var39.i) ? (~0) : 0;
+    /* 14: cmpgtsw */
+    var47.i = (var45.i > var40.i) ? (~0) : 0;
+    /* 15: andw */
+    var48.i = var46.i & var47.i;
+    /* 16: orw */
+    var49.i = var44.i | var48.i;
+    /* 18: andw */
+    var51.i = var49.i & var50.i;
+    /* 19: convwb */
+    var52 = var51.i;
+    /* 20: storeb */
+    ptr0[i] = var52;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_iscombed (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int p1, int p2, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_iscombed");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_iscombed);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_constant (p, 4, 0x00000001, "c1");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T3, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_T3, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_P2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_P2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T4, ORC_VAR_D1,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* fieldanalysis_orc_comb_mask_5_tap */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_mask_5_tap (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, int p1, int p2, int p3, int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_int8 var35;
+  orc_union16 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_int8 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_int8 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_int8 var69;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+  ptr7 = (orc_int8 *) s4;
+  ptr8 = (orc_int8 *) s5;
+
+  /* 8: loadpw */
+  var41.i = p1;
+  /* 12: loadpw */
+  var45.i = p2;
+  /* 20: loadpw */
+  var53.i = (int) 0x00000003;   /* 3 or 1.4822e-323f */
+  /* 31: loadpw */
+  var64.i = p3;
+  /* 34: loadpw */
+  var67.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var33 = ptr5[i];
+    /* 1: convubw */
+    var34.i = (orc_uint8) var33;
+    /* 2: loadb */
+    var35 = ptr6[i];
+    /* 3: convubw */
+    var36.i = (orc_uint8) var35;
+    /* 4: loadb */
+    var37 = ptr7[i];
+    /* 5: convubw */
+    var38.i = (orc_uint8) var37;
+    /* 6: subw */
+    var39.i = var36.i - var34.i;
+    /* 7: subw */
+    var40.i = var36.i - var38.i;
+    /* 9: cmpgtsw */
+    var42.i = (var39.i > var41.i) ? (~0) : 0;
+    /* 10: cmpgtsw */
+    var43.i = (var40.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var44.i = var42.i & var43.i;
+    /* 13: cmpgtsw */
+    var46.i = (var45.i > var39.i) ? (~0) : 0;
+    /* 14: cmpgtsw */
+    var47.i = (var45.i > var40.i) ? (~0) : 0;
+    /* 15: andw */
+    var48.i = var46.i & var47.i;
+    /* 16: orw */
+    var49.i = var44.i | var48.i;
+    /* 17: convubw */
+    var50.i = (orc_uint8) var33;
+    /* 18: convubw */
+    var51.i = (orc_uint8) var37;
+    /* 19: addw */
+    var52.i = var50.i + var51.i;
+    /* 21: mullw */
+    var54.i = (var52.i * var53.i) & 0xffff;
+    /* 22: shlw */
+    var55.i = var36.i << 2;
+    /* 23: loadb */
+    var56 = ptr4[i];
+    /* 24: convubw */
+    var57.i = (orc_uint8) var56;
+    /* 25: addw */
+    var58.i = var55.i + var57.i;
+    /* 26: loadb */
+    var59 = ptr8[i];
+    /* 27: convubw */
+    var60.i = (orc_uint8) var59;
+    /* 28: addw */
+    var61.i = var58.i + var60.i;
+    /* 29: subw */
+    var62.i = var61.i - var54.i;
+    /* 30: absw */
+    var63.i = ORC_ABS (var62.i);
+    /* 32: cmpgtsw */
+    var65.i = (var63.i > var64.i) ? (~0) : 0;
+    /* 33: andw */
+    var66.i = var49.i & var65.i;
+    /* 35: andw */
+    var68.i = var66.i & var67.i;
+    /* 36: convwb */
+    var69 = var68.i;
+    /* 37: storeb */
+    ptr0[i] = var69;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_mask_5_tap (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  const orc_int8 *ORC_RESTRICT ptr7;
+  const orc_int8 *ORC_RESTRICT ptr8;
+  orc_int8 var33;
+  orc_union16 var34;
+  orc_int8 var35;
+  orc_union16 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union16 var39;
+  orc_union16 var40;
+  orc_union16 var41;
+  orc_union16 var42;
+  orc_union16 var43;
+  orc_union16 var44;
+  orc_union16 var45;
+  orc_union16 var46;
+  orc_union16 var47;
+  orc_union16 var48;
+  orc_union16 var49;
+  orc_union16 var50;
+  orc_union16 var51;
+  orc_union16 var52;
+  orc_union16 var53;
+  orc_union16 var54;
+  orc_union16 var55;
+  orc_int8 var56;
+  orc_union16 var57;
+  orc_union16 var58;
+  orc_int8 var59;
+  orc_union16 var60;
+  orc_union16 var61;
+  orc_union16 var62;
+  orc_union16 var63;
+  orc_union16 var64;
+  orc_union16 var65;
+  orc_union16 var66;
+  orc_union16 var67;
+  orc_union16 var68;
+  orc_int8 var69;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+  ptr7 = (orc_int8 *) ex->arrays[7];
+  ptr8 = (orc_int8 *) ex->arrays[8];
+
+  /* 8: loadpw */
+  var41.i = ex->params[24];
+  /* 12: loadpw */
+  var45.i = ex->params[25];
+  /* 20: loadpw */
+  var53.i = (int) 0x00000003;   /* 3 or 1.4822e-323f */
+  /* 31: loadpw */
+  var64.i = ex->params[26];
+  /* 34: loadpw */
+  var67.i = (int) 0x00000001;   /* 1 or 4.94066e-324f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var33 = ptr5[i];
+    /* 1: convubw */
+    var34.i = (orc_uint8) var33;
+    /* 2: loadb */
+    var35 = ptr6[i];
+    /* 3: convubw */
+    var36.i = (orc_uint8) var35;
+    /* 4: loadb */
+    var37 = ptr7[i];
+    /* 5: convubw */
+    var38.i = (orc_uint8) var37;
+    /* 6: subw */
+    var39.i = var36.i - var34.i;
+    /* 7: subw */
+    var40.i = var36.i - var38.i;
+    /* 9: cmpgtsw */
+    var42.i = (var39.i > var41.i) ? (~0) : 0;
+    /* 10: cmpgtsw */
+    var43.i = (var40.i > var41.i) ? (~0) : 0;
+    /* 11: andw */
+    var44.i = var42.i & var43.i;
+    /* 13: cmpgtsw */
+    var46.i = (var45.i > var39.i) ? (~0) : 0;
+    /* 14: cmpgtsw */
+    var47.i = (var45.i > var40.i) ? (~0) : 0;
+    /* 15: andw */
+    var48.i = var46.i & var47.i;
+    /* 16: orw */
+    var49.i = var44.i | var48.i;
+    /* 17: convubw */
+    var50.i = (orc_uint8) var33;
+    /* 18: convubw */
+    var51.i = (orc_uint8) var37;
+    /* 19: addw */
+    var52.i = var50.i + var51.i;
+    /* 21: mullw */
+    var54.i = (var52.i * var53.i) & 0xffff;
+    /* 22: shlw */
+    var55.i = var36.i << 2;
+    /* 23: loadb */
+    var56 = ptr4[i];
+    /* 24: convubw */
+    var57.i = (orc_uint8) var56;
+    /* 25: addw */
+    var58.i = var55.i + var57.i;
+    /* 26: loadb */
+    var59 = ptr8[i];
+    /* 27: convubw */
+    var60.i = (orc_uint8) var59;
+    /* 28: addw */
+    var61.i = var58.i + var60.i;
+    /* 29: subw */
+    var62.i = var61.i - var54.i;
+    /* 30: absw */
+    var63.i = ORC_ABS (var62.i);
+    /* 32: cmpgtsw */
+    var65.i = (var63.i > var64.i) ? (~0) : 0;
+    /* 33: andw */
+    var66.i = var49.i & var65.i;
+    /* 35: andw */
+    var68.i = var66.i & var67.i;
+    /* 36: convwb */
+    var69 = var68.i;
+    /* 37: storeb */
+    ptr0[i] = var69;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_mask_5_tap (guint8 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, const orc_uint8 * ORC_RESTRICT s4,
+    const orc_uint8 * ORC_RESTRICT s5, int p1, int p2, int p3, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_mask_5_tap");
+      orc_program_set_backup_function (p,
+          _backup_fieldanalysis_orc_comb_mask_5_tap);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_source (p, 1, "s4");
+      orc_program_add_source (p, 1, "s5");
+      orc_program_add_constant (p, 4, 0x00000003, "c1");
+      orc_program_add_constant (p, 4, 0x00000002, "c2");
+      orc_program_add_constant (p, 4, 0x00000001, "c3");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_parameter (p, 2, "p2");
+      orc_program_add_parameter (p, 2, "p3");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 2, "t3");
+      orc_program_add_temporary (p, 2, "t4");
+      orc_program_add_temporary (p, 2, "t5");
+      orc_program_add_temporary (p, 2, "t6");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_S3, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T1, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T3, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T4, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_T3, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T5, ORC_VAR_P2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T6, ORC_VAR_P2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T5, ORC_VAR_T5, ORC_VAR_T6,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "orw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T5,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S4, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mullw", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shlw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T3, ORC_VAR_S5, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "subw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "absw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "cmpgtsw", 0, ORC_VAR_T2, ORC_VAR_T2, ORC_VAR_P3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_T2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andw", 0, ORC_VAR_T4, ORC_VAR_T4, ORC_VAR_C3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convwb", 0, ORC_VAR_D1, ORC_VAR_T4, ORC_VAR_D1,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+  ex->arrays[ORC_VAR_S4] = (void *) s4;
+  ex->arrays[ORC_VAR_S5] = (void *) s5;
+  ex->params[ORC_VAR_P1] = p1;
+  ex->params[ORC_VAR_P2] = p2;
+  ex->params[ORC_VAR_P3] = p3;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* fieldanalysis_orc_comb_count */
+#ifdef DISABLE_ORC
+void
+fieldanalysis_orc_comb_count (guint32 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_int8 *) s1;
+  ptr5 = (orc_int8 *) s2;
+  ptr6 = (orc_int8 *) s3;
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var33 = ptr4[i];
+    /* 1: loadb */
+    var34 = ptr5[i];
+    /* 2: andb */
+    var35 = var33 & var34;
+    /* 3: loadb */
+    var36 = ptr6[i];
+    /* 4: andb */
+    var37 = var35 & var36;
+    /* 5: convubw */
+    var38.i = (orc_uint8) var37;
+    /* 6: convuwl */
+    var39.i = (orc_uint16) var38.i;
+    /* 7: loadl */
+    var40 = ptr0[i];
+    /* 8: addl */
+    var41.i = ((orc_uint32) var40.i) + ((orc_uint32) var39.i);
+    /* 9: storel */
+    ptr0[i] = var41;
+  }
+
+}
+
+#else
+static void
+_backup_fieldanalysis_orc_comb_count (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  const orc_int8 *ORC_RESTRICT ptr5;
+  const orc_int8 *ORC_RESTRICT ptr6;
+  orc_int8 var33;
+  orc_int8 var34;
+  orc_int8 var35;
+  orc_int8 var36;
+  orc_int8 var37;
+  orc_union16 var38;
+  orc_union32 var39;
+  orc_union32 var40;
+  orc_union32 var41;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+  ptr5 = (orc_int8 *) ex->arrays[5];
+  ptr6 = (orc_int8 *) ex->arrays[6];
+
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var33 = ptr4[i];
+    /* 1: loadb */
+    var34 = ptr5[i];
+    /* 2: andb */
+    var35 = var33 & var34;
+    /* 3: loadb */
+    var36 = ptr6[i];
+    /* 4: andb */
+    var37 = var35 & var36;
+    /* 5: convubw */
+    var38.i = (orc_uint8) var37;
+    /* 6: convuwl */
+    var39.i = (orc_uint16) var38.i;
+    /* 7: loadl */
+    var40 = ptr0[i];
+    /* 8: addl */
+    var41.i = ((orc_uint32) var40.i) + ((orc_uint32) var39.i);
+    /* 9: storel */
+    ptr0[i] = var41;
+  }
+
+}
+
+void
+fieldanalysis_orc_comb_count (guint32 * ORC_RESTRICT d1,
+    const orc_uint8 * ORC_RESTRICT s1, const orc_uint8 * ORC_RESTRICT s2,
+    const orc_uint8 * ORC_RESTRICT s3, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "fieldanalysis_orc_comb_count");
+      orc_program_set_backup_function (p, _backup_fieldanalysis_orc_comb_count);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_source (p, 1, "s2");
+      orc_program_add_source (p, 1, "s3");
+      orc_program_add_temporary (p, 1, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+      orc_program_add_temporary (p, 4, "t3");
+
+      orc_program_append_2 (p, "andb", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_S2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "andb", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_S3,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convuwl", 0, ORC_VAR_T3, ORC_VAR_T2, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T3,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->arrays[ORC_VAR_S2] = (void *) s2;
+  ex->arrays[ORC_VAR_S3] = (void *) s3;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
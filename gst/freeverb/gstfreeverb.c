@@ -52,12 +52,17 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
 #include <gst/controller/gstcontroller.h>
 
 #include "gstfreeverb.h"
+#include "gstfreeverbmodel.h"
 
 #define GST_CAT_DEFAULT gst_freeverb_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
@@ -76,11 +81,11 @@ static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw-float, "
         "rate = (int) [ 1, MAX ], "
-        "channels = (int) [ 1, 2 ], "
+        "channels = (int) [ 1, MAX ], "
         "endianness = (int) BYTE_ORDER, " "width = (int) 32; "
         "audio/x-raw-int, "
         "rate = (int) [ 1, MAX ], "
-        "channels = (int) [ 1, 2 ], "
+        "channels = (int) [ 1, MAX ], "
         "endianness = (int) BYTE_ORDER, "
         "width = (int) 16, " "depth = (int) 16, " "signed = (boolean) true")
     );
@@ -90,11 +95,11 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-raw-float, "
         "rate = (int) [ 1, MAX ], "
-        "channels = (int) 2, "
+        "channels = (int) [ 2, MAX ], "
         "endianness = (int) BYTE_ORDER, " "width = (int) 32; "
         "audio/x-raw-int, "
         "rate = (int) [ 1, MAX ], "
-        "channels = (int) 2, "
+        "channels = (int) [ 2, MAX ], "
         "endianness = (int) BYTE_ORDER, "
         "width = (int) 16, " "depth = (int) 16, " "signed = (boolean) true")
     );
@@ -127,223 +132,28 @@ static gboolean gst_freeverb_set_caps (GstBaseTransform * base,
 static GstFlowReturn gst_freeverb_transform (GstBaseTransform * base,
     GstBuffer * inbuf, GstBuffer * outbuf);
 
-static gboolean gst_freeverb_transform_m2s_int (GstFreeverb * filter,
-    gint16 * idata, gint16 * odata, guint num_samples);
-static gboolean gst_freeverb_transform_s2s_int (GstFreeverb * filter,
+static gboolean gst_freeverb_transform_int (GstFreeverb * filter,
     gint16 * idata, gint16 * odata, guint num_samples);
-static gboolean gst_freeverb_transform_m2s_float (GstFreeverb * filter,
-    gfloat * idata, gfloat * odata, guint num_samples);
-static gboolean gst_freeverb_transform_s2s_float (GstFreeverb * filter,
+static gboolean gst_freeverb_transform_float (GstFreeverb * filter,
     gfloat * idata, gfloat * odata, guint num_samples);
 
-
-/* Table with processing functions: [channels][format] */
-static GstFreeverbProcessFunc process_functions[2][2] = {
-  {
-        (GstFreeverbProcessFunc) gst_freeverb_transform_m2s_int,
-        (GstFreeverbProcessFunc) gst_freeverb_transform_m2s_float,
-      },
-  {
-        (GstFreeverbProcessFunc) gst_freeverb_transform_s2s_int,
-        (GstFreeverbProcessFunc) gst_freeverb_transform_s2s_float,
-      }
-};
-
 /***************************************************************
  *
  *                           REVERB
  */
 
-/* Denormalising:
- *
- * Another method fixes the problem cheaper: Use a small DC-offset in
- * the filter calculations.  Now the signals converge not against 0,
- * but against the offset.  The constant offset is invisible from the
- * outside world (i.e. it does not appear at the output.  There is a
- * very small turn-on transient response, which should not cause
- * problems.
- */
-
-//#define DC_OFFSET 0
-#define DC_OFFSET 1e-8
-//#define DC_OFFSET 0.001f
-
-/* all pass filter */
-
-typedef struct _freeverb_allpass
-{
-  gfloat feedback;
-  gfloat *buffer;
-  gint bufsize;
-  gint bufidx;
-} freeverb_allpass;
-
-static void
-freeverb_allpass_setbuffer (freeverb_allpass * allpass, gint size)
-{
-  allpass->bufidx = 0;
-  allpass->buffer = g_new (gfloat, size);
-  allpass->bufsize = size;
-}
-
-static void
-freeverb_allpass_release (freeverb_allpass * allpass)
-{
-  g_free (allpass->buffer);
-}
-
-static void
-freeverb_allpass_init (freeverb_allpass * allpass)
-{
-  gint i, len = allpass->bufsize;
-  gfloat *buf = allpass->buffer;
-
-  for (i = 0; i < len; i++) {
-    buf[i] = DC_OFFSET;         /* this is not 100 % correct. */
-  }
-}
-
-static void
-freeverb_allpass_setfeedback (freeverb_allpass * allpass, gfloat val)
-{
-  allpass->feedback = val;
-}
-
-/*
-static gfloat
-freeverb_allpass_getfeedback(freeverb_allpass* allpass)
-{
-  return allpass->feedback;
-}*/
-
-#define freeverb_allpass_process(_allpass, _input_1) \
-{ \
-  gfloat output; \
-  gfloat bufout; \
-  bufout = _allpass.buffer[_allpass.bufidx]; \
-  output = bufout-_input_1; \
-  _allpass.buffer[_allpass.bufidx] = _input_1 + (bufout * _allpass.feedback); \
-  if (++_allpass.bufidx >= _allpass.bufsize) { \
-    _allpass.bufidx = 0; \
-  } \
-  _input_1 = output; \
-}
-
-/* comb filter */
-
-typedef struct _freeverb_comb
-{
-  gfloat feedback;
-  gfloat filterstore;
-  gfloat damp1;
-  gfloat damp2;
-  gfloat *buffer;
-  gint bufsize;
-  gint bufidx;
-} freeverb_comb;
-
-static void
-freeverb_comb_setbuffer (freeverb_comb * comb, gint size)
-{
-  comb->filterstore = 0;
-  comb->bufidx = 0;
-  comb->buffer = g_new (gfloat, size);
-  comb->bufsize = size;
-}
-
-static void
-freeverb_comb_release (freeverb_comb * comb)
-{
-  g_free (comb->buffer);
-}
-
-static void
-freeverb_comb_init (freeverb_comb * comb)
-{
-  gint i, len = comb->bufsize;
-  gfloat *buf = comb->buffer;
-
-  for (i = 0; i < len; i++) {
-    buf[i] = DC_OFFSET;         /* This is not 100 % correct. */
-  }
-}
-
-static void
-freeverb_comb_setdamp (freeverb_comb * comb, gfloat val)
-{
-  comb->damp1 = val;
-  comb->damp2 = 1 - val;
-}
-
-/*
-static gfloat
-freeverb_comb_getdamp(freeverb_comb* comb)
-{
-  return comb->damp1;
-}*/
-
-static void
-freeverb_comb_setfeedback (freeverb_comb * comb, gfloat val)
-{
-  comb->feedback = val;
-}
-
-/*
-static gfloat
-freeverb_comb_getfeedback(freeverb_comb* comb)
-{
-  return comb->feedback;
-}*/
-
-#define freeverb_comb_process(_comb, _input_1, _output) \
-{ \
-  gfloat _tmp = _comb.buffer[_comb.bufidx]; \
-  _comb.filterstore = (_tmp * _comb.damp2) + (_comb.filterstore * _comb.damp1); \
-  _comb.buffer[_comb.bufidx] = _input_1 + (_comb.filterstore * _comb.feedback); \
-  if (++_comb.bufidx >= _comb.bufsize) { \
-    _comb.bufidx = 0; \
-  } \
-  _output += _tmp; \
-}
-
-#define numcombs 8
-#define numallpasses 4
-#define	fixedgain 0.015f
-#define scalewet 1.0f
-#define scaledry 1.0f
-#define scaledamp 1.0f
-#define scaleroom 0.28f
-#define offsetroom 0.7f
-#define stereospread 23
-
-/* These values assume 44.1KHz sample rate
- * they will need scaling for 96KHz (or other) sample rates.
- * The values were obtained by listening tests.
- */
-#define combtuningL1 1116
-#define combtuningR1 (1116 + stereospread)
-#define combtuningL2 1188
-#define combtuningR2 (1188 + stereospread)
-#define combtuningL3 1277
-#define combtuningR3 (1277 + stereospread)
-#define combtuningL4 1356
-#define combtuningR4 (1356 + stereospread)
-#define combtuningL5 1422
-#define combtuningR5 (1422 + stereospread)
-#define combtuningL6 1491
-#define combtuningR6 (1491 + stereospread)
-#define combtuningL7 1557
-#define combtuningR7 (1557 + stereospread)
-#define combtuningL8 1617
-#define combtuningR8 (1617 + stereospread)
-#define allpasstuningL1 556
-#define allpasstuningR1 (556 + stereospread)
-#define allpasstuningL2 441
-#define allpasstuningR2 (441 + stereospread)
-#define allpasstuningL3 341
-#define allpasstuningR3 (341 + stereospread)
-#define allpasstuningL4 225
-#define allpasstuningR4 (225 + stereospread)
+/* Where the FPU can do it, results that would be denormal are also flushed
+ * to zero while processing, on top of the DC offset of gstfreeverbmodel.h */
+#ifdef __SSE__
+#define DENORMALS_OFF(_mode) G_STMT_START { \
+  _mode = _MM_GET_FLUSH_ZERO_MODE (); \
+  _MM_SET_FLUSH_ZERO_MODE (_MM_FLUSH_ZERO_ON); \
+} G_STMT_END
+#define DENORMALS_RESTORE(_mode) _MM_SET_FLUSH_ZERO_MODE (_mode)
+#else
+#define DENORMALS_OFF(_mode) (_mode = 0)
+#define DENORMALS_RESTORE(_mode) ((void) (_mode))
+#endif
 
 struct _GstFreeverbPrivate
 {
@@ -352,49 +162,40 @@ struct _GstFreeverbPrivate
   gfloat wet, wet1, wet2, dry;
   gfloat width;
   gfloat gain;
-  /*
-     The following are all declared inline
-     to remove the need for dynamic allocation
-     with its subsequent error-checking messiness
-   */
-  /* Comb filters */
-  freeverb_comb combL[numcombs];
-  freeverb_comb combR[numcombs];
-  /* Allpass filters */
-  freeverb_allpass allpassL[numallpasses];
-  freeverb_allpass allpassR[numallpasses];
+
+  /* one filter bank per output channel */
+  freeverb_bank *banks;
+  gint n_banks;
+  /* input and output blocks of all banks, n_banks * BLOCK_SIZE each */
+  gfloat *block_in;
+  gfloat *block_out;
 };
 
 static void
 freeverb_revmodel_init (GstFreeverb * filter)
 {
   GstFreeverbPrivate *priv = filter->priv;
-  gint i;
+  gint b;
 
-  for (i = 0; i < numcombs; i++) {
-    freeverb_comb_init (&priv->combL[i]);
-    freeverb_comb_init (&priv->combR[i]);
-  }
-  for (i = 0; i < numallpasses; i++) {
-    freeverb_allpass_init (&priv->allpassL[i]);
-    freeverb_allpass_init (&priv->allpassR[i]);
-  }
+  for (b = 0; b < priv->n_banks; b++)
+    freeverb_bank_init (&priv->banks[b]);
 }
 
 static void
 freeverb_revmodel_free (GstFreeverb * filter)
 {
   GstFreeverbPrivate *priv = filter->priv;
-  gint i;
-
-  for (i = 0; i < numcombs; i++) {
-    freeverb_comb_release (&priv->combL[i]);
-    freeverb_comb_release (&priv->combR[i]);
-  }
-  for (i = 0; i < numallpasses; i++) {
-    freeverb_allpass_release (&priv->allpassL[i]);
-    freeverb_allpass_release (&priv->allpassR[i]);
-  }
+  gint b;
+
+  for (b = 0; b < priv->n_banks; b++)
+    freeverb_bank_release (&priv->banks[b]);
+  g_free (priv->banks);
+  priv->banks = NULL;
+  priv->n_banks = 0;
+  g_free (priv->block_in);
+  priv->block_in = NULL;
+  g_free (priv->block_out);
+  priv->block_out = NULL;
 }
 
 /* GObject vmethod implementations */
@@ -485,20 +286,17 @@ gst_freeverb_finalize (GObject * object)
 static gboolean
 gst_freeverb_set_process_function (GstFreeverb * filter)
 {
-  gint channel_index, format_index;
-
   /* set processing function */
-  channel_index = filter->channels - 1;
-  if (channel_index > 1 || channel_index < 0) {
+  if (filter->channels < 1) {
     filter->process = NULL;
     return FALSE;
   }
 
-  format_index = (filter->format_float) ? 1 : 0;
-
-  filter->process = process_functions[channel_index][format_index];
+  if (filter->format_float)
+    filter->process = (GstFreeverbProcessFunc) gst_freeverb_transform_float;
+  else
+    filter->process = (GstFreeverbProcessFunc) gst_freeverb_transform_int;
 
-  g_assert (filter->process);
   return TRUE;
 }
 
@@ -507,48 +305,23 @@ gst_freeverb_init_rev_model (GstFreeverb * filter)
 {
   gfloat srfactor = filter->rate / 44100.0f;
   GstFreeverbPrivate *priv = filter->priv;
+  gint b;
 
   freeverb_revmodel_free (filter);
 
   priv->gain = fixedgain;
 
-  freeverb_comb_setbuffer (&priv->combL[0], combtuningL1 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[0], combtuningR1 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[1], combtuningL2 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[1], combtuningR2 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[2], combtuningL3 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[2], combtuningR3 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[3], combtuningL4 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[3], combtuningR4 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[4], combtuningL5 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[4], combtuningR5 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[5], combtuningL6 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[5], combtuningR6 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[6], combtuningL7 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[6], combtuningR7 * srfactor);
-  freeverb_comb_setbuffer (&priv->combL[7], combtuningL8 * srfactor);
-  freeverb_comb_setbuffer (&priv->combR[7], combtuningR8 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassL[0], allpasstuningL1 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassR[0], allpasstuningR1 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassL[1], allpasstuningL2 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassR[1], allpasstuningR2 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassL[2], allpasstuningL3 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassR[2], allpasstuningR3 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassL[3], allpasstuningL4 * srfactor);
-  freeverb_allpass_setbuffer (&priv->allpassR[3], allpasstuningR4 * srfactor);
+  /* mono input gets a stereo reverb */
+  priv->n_banks = MAX (filter->channels, 2);
+  priv->banks = g_new0 (freeverb_bank, priv->n_banks);
+  priv->block_in = g_new (gfloat, priv->n_banks * BLOCK_SIZE);
+  priv->block_out = g_new (gfloat, priv->n_banks * BLOCK_SIZE);
+
+  for (b = 0; b < priv->n_banks; b++)
+    freeverb_bank_setbuffers (&priv->banks[b], b, srfactor);
 
   /* clear buffers */
   freeverb_revmodel_init (filter);
-
-  /* set default values */
-  freeverb_allpass_setfeedback (&priv->allpassL[0], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassR[0], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassL[1], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassR[1], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassL[2], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassR[2], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassL[3], 0.5f);
-  freeverb_allpass_setfeedback (&priv->allpassR[3], 0.5f);
 }
 
 static void
@@ -557,24 +330,15 @@ gst_freeverb_set_property (GObject * object, guint prop_id,
 {
   GstFreeverb *filter = GST_FREEVERB (object);
   GstFreeverbPrivate *priv = filter->priv;
-  gint i;
 
   switch (prop_id) {
     case PROP_ROOM_SIZE:
       filter->room_size = g_value_get_float (value);
       priv->roomsize = (filter->room_size * scaleroom) + offsetroom;
-      for (i = 0; i < numcombs; i++) {
-        freeverb_comb_setfeedback (&priv->combL[i], priv->roomsize);
-        freeverb_comb_setfeedback (&priv->combR[i], priv->roomsize);
-      }
       break;
     case PROP_DAMPING:
       filter->damping = g_value_get_float (value);
       priv->damp = filter->damping * scaledamp;
-      for (i = 0; i < numcombs; i++) {
-        freeverb_comb_setdamp (&priv->combL[i], priv->damp);
-        freeverb_comb_setdamp (&priv->combR[i], priv->damp);
-      }
       break;
     case PROP_PAN_WIDTH:
       filter->pan_width = g_value_get_float (value);
@@ -649,19 +413,50 @@ gst_freeverb_transform_caps (GstBaseTransform * base,
     GstPadDirection direction, GstCaps * caps)
 {
   GstCaps *res;
-  GstStructure *structure;
+  guint i;
 
-  /* transform caps gives one single caps so we can just replace
-   * the channel property with our range. */
+  /* Every input channel gets its own reverb, mono input is turned into
+   * stereo. So on the sink side anything from mono upwards is allowed and
+   * on the source side at least two channels are produced. */
   res = gst_caps_copy (caps);
-  structure = gst_caps_get_structure (res, 0);
-  if (direction == GST_PAD_SRC) {
-    GST_INFO_OBJECT (base, "allow 1-2 channels");
-    gst_structure_set (structure, "channels", GST_TYPE_INT_RANGE, 1, 2, NULL);
-  } else {
-    GST_INFO_OBJECT (base, "allow 2 channels");
-    gst_structure_set (structure, "channels", G_TYPE_INT, 2, NULL);
+  for (i = 0; i < gst_caps_get_size (res); i++) {
+    GstStructure *structure = gst_caps_get_structure (res, i);
+    const GValue *value = gst_structure_get_value (structure, "channels");
+    gint min, max;
+
+    if (value == NULL)
+      continue;
+
+    if (G_VALUE_HOLDS_INT (value)) {
+      min = max = g_value_get_int (value);
+    } else if (GST_VALUE_HOLDS_INT_RANGE (value)) {
+      min = gst_value_get_int_range_min (value);
+      max = gst_value_get_int_range_max (value);
+    } else {
+      continue;
+    }
+
+    if (direction == GST_PAD_SRC) {
+      if (min <= 2 && max >= 2)
+        min = 1;
+    } else {
+      min = MAX (min, 2);
+      max = MAX (max, 2);
+    }
+
+    /* the layout only survives if the channels stay the same */
+    if (min != max || !G_VALUE_HOLDS_INT (value) ||
+        g_value_get_int (value) != min)
+      gst_structure_remove_field (structure, "channel-positions");
+
+    if (min == max)
+      gst_structure_set (structure, "channels", G_TYPE_INT, min, NULL);
+    else
+      gst_structure_set (structure, "channels", GST_TYPE_INT_RANGE, min, max,
+          NULL);
   }
+  GST_INFO_OBJECT (base, "transformed %" GST_PTR_FORMAT " to %"
+      GST_PTR_FORMAT, caps, res);
 
   return res;
 }
@@ -724,191 +519,89 @@ no_rate:
   return ret;
 }
 
-static gboolean
-gst_freeverb_transform_m2s_int (GstFreeverb * filter,
-    gint16 * idata, gint16 * odata, guint num_samples)
-{
-  GstFreeverbPrivate *priv = filter->priv;
-  gint i, k;
-  gfloat out_l1, out_r1, input_1;
-  gfloat out_l2, out_r2, input_2;
-  gboolean drained = TRUE;
-
-  for (k = 0; k < num_samples; k++) {
-
-    out_l1 = out_r1 = 0.0;
-
-    /* The original Freeverb code expects a stereo signal and 'input_1'
-     * is set to the sum of the left and right input_1 sample. Since
-     * this code works on a mono signal, 'input_1' is set to twice the
-     * input_1 sample. */
-    input_2 = (gfloat) * idata++;
-    input_1 = (2.0f * input_2 + DC_OFFSET) * priv->gain;
-
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      freeverb_comb_process (priv->combL[i], input_1, out_l1);
-      freeverb_comb_process (priv->combR[i], input_1, out_r1);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      freeverb_allpass_process (priv->allpassL[i], out_l1);
-      freeverb_allpass_process (priv->allpassR[i], out_r1);
-    }
-
-    /* Remove the DC offset */
-    out_l1 -= DC_OFFSET;
-    out_r1 -= DC_OFFSET;
+/* Runs all banks over a block of frames that was deinterleaved into
+ * priv->block_in, then mixes the wet signal of each output channel, see
+ * freeverb_bank_wet(), back into priv->block_in and adds the dry input. */
+#define GST_FREEVERB_PROCESS_BLOCKS(filter, type, idata, odata, num_samples, \
+    TO_OUTPUT, IS_SILENT) \
+G_STMT_START { \
+  GstFreeverbPrivate *priv = filter->priv; \
+  gint in_channels = filter->channels; \
+  gint n_banks = priv->n_banks; \
+  gfloat *block_in = priv->block_in; \
+  gfloat *block_out = priv->block_out; \
+  guint off, len, k; \
+  gint b; \
+  \
+  for (off = 0; off < num_samples; off += len) { \
+    len = MIN (BLOCK_SIZE, num_samples - off); \
+    \
+    for (b = 0; b < n_banks; b++) { \
+      gfloat *in = block_in + b * BLOCK_SIZE; \
+      \
+      /* The original Freeverb code expects a stereo signal and 'input_1' \
+       * is set to the sum of the left and right input_1 sample. For mono \
+       * input 'input_1' is set to twice the input_1 sample for both \
+       * channels. */ \
+      if (in_channels == 1) { \
+        for (k = 0; k < len; k++) \
+          in[k] = (2.0f * idata[k] + DC_OFFSET) * priv->gain; \
+      } else { \
+        const type *s = idata + b; \
+        for (k = 0; k < len; k++) \
+          in[k] = (s[k * in_channels] + DC_OFFSET) * priv->gain; \
+      } \
+      freeverb_bank_process (&priv->banks[b], priv->roomsize, priv->damp, \
+          in, block_out + b * BLOCK_SIZE, len); \
+    } \
+    \
+    for (b = 0; b < n_banks; b++) { \
+      gfloat *wet = block_in + b * BLOCK_SIZE; \
+      const type *s = idata + (in_channels == 1 ? 0 : b); \
+      type *d = odata + b; \
+      \
+      freeverb_bank_wet (block_out, b, n_banks, priv->wet1, priv->wet2, \
+          wet, len); \
+      for (k = 0; k < len; k++) { \
+        gfloat v = wet[k] + s[k * in_channels] * priv->dry; \
+        \
+        d[k * n_banks] = TO_OUTPUT (v); \
+        if (!IS_SILENT (v)) \
+          drained = FALSE; \
+      } \
+    } \
+    \
+    idata += len * in_channels; \
+    odata += len * n_banks; \
+  } \
+} G_STMT_END
 
-    /* Calculate output */
-    out_l2 = out_l1 * priv->wet1 + out_r1 * priv->wet2 + input_2 * priv->dry;
-    out_r2 = out_r1 * priv->wet1 + out_l1 * priv->wet2 + input_2 * priv->dry;
-    *odata++ = (gint16) CLAMP (out_l2, G_MININT16, G_MAXINT16);
-    *odata++ = (gint16) CLAMP (out_r2, G_MININT16, G_MAXINT16);
-
-    if (abs (out_l2) > 0 || abs (out_r2) > 0)
-      drained = FALSE;
-  }
-  return drained;
-}
+#define FLOAT_TO_INT16(v) ((gint16) CLAMP (v, G_MININT16, G_MAXINT16))
+#define FLOAT_TO_FLOAT(v) (v)
+#define INT16_IS_SILENT(v) (fabsf (v) < 1.0f)
+#define FLOAT_IS_SILENT(v) ((v) == 0.0f)
 
 static gboolean
-gst_freeverb_transform_s2s_int (GstFreeverb * filter,
+gst_freeverb_transform_int (GstFreeverb * filter,
     gint16 * idata, gint16 * odata, guint num_samples)
 {
-  GstFreeverbPrivate *priv = filter->priv;
-  gint i, k;
-  gfloat out_l1, out_r1, input_1l, input_1r;
-  gfloat out_l2, out_r2, input_2l, input_2r;
   gboolean drained = TRUE;
 
-  for (k = 0; k < num_samples; k++) {
+  GST_FREEVERB_PROCESS_BLOCKS (filter, gint16, idata, odata, num_samples,
+      FLOAT_TO_INT16, INT16_IS_SILENT);
 
-    out_l1 = out_r1 = 0.0;
-
-    input_2l = (gfloat) * idata++;
-    input_2r = (gfloat) * idata++;
-    input_1l = (input_2l + DC_OFFSET) * priv->gain;
-    input_1r = (input_2r + DC_OFFSET) * priv->gain;
-
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      freeverb_comb_process (priv->combL[i], input_1l, out_l1);
-      freeverb_comb_process (priv->combR[i], input_1r, out_r1);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      freeverb_allpass_process (priv->allpassL[i], out_l1);
-      freeverb_allpass_process (priv->allpassR[i], out_r1);
-    }
-
-    /* Remove the DC offset */
-    out_l1 -= DC_OFFSET;
-    out_r1 -= DC_OFFSET;
-
-    /* Calculate output */
-    out_l2 = out_l1 * priv->wet1 + out_r1 * priv->wet2 + input_2l * priv->dry;
-    out_r2 = out_r1 * priv->wet1 + out_l1 * priv->wet2 + input_2r * priv->dry;
-    *odata++ = (gint16) CLAMP (out_l2, G_MININT16, G_MAXINT16);
-    *odata++ = (gint16) CLAMP (out_r2, G_MININT16, G_MAXINT16);
-
-    if (abs (out_l2) > 0 || abs (out_r2) > 0)
-      drained = FALSE;
-  }
   return drained;
 }
 
 static gboolean
-gst_freeverb_transform_m2s_float (GstFreeverb * filter,
+gst_freeverb_transform_float (GstFreeverb * filter,
     gfloat * idata, gfloat * odata, guint num_samples)
 {
-  GstFreeverbPrivate *priv = filter->priv;
-  gint i, k;
-  gfloat out_l1, out_r1, input_1;
-  gfloat out_l2, out_r2, input_2;
   gboolean drained = TRUE;
 
-  for (k = 0; k < num_samples; k++) {
+  GST_FREEVERB_PROCESS_BLOCKS (filter, gfloat, idata, odata, num_samples,
+      FLOAT_TO_FLOAT, FLOAT_IS_SILENT);
 
-    out_l1 = out_r1 = 0.0;
-
-    /* The original Freeverb code expects a stereo signal and 'input_1'
-     * is set to the sum of the left and right input_1 sample. Since
-     * this code works on a mono signal, 'input_1' is set to twice the
-     * input_1 sample. */
-    input_2 = *idata++;
-    input_1 = (2.0f * input_2 + DC_OFFSET) * priv->gain;
-
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      freeverb_comb_process (priv->combL[i], input_1, out_l1);
-      freeverb_comb_process (priv->combR[i], input_1, out_r1);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      freeverb_allpass_process (priv->allpassL[i], out_l1);
-      freeverb_allpass_process (priv->allpassR[i], out_r1);
-    }
-
-    /* Remove the DC offset */
-    out_l1 -= DC_OFFSET;
-    out_r1 -= DC_OFFSET;
-
-    /* Calculate output */
-    out_l2 = out_l1 * priv->wet1 + out_r1 * priv->wet2 + input_2 * priv->dry;
-    out_r2 = out_r1 * priv->wet1 + out_l1 * priv->wet2 + input_2 * priv->dry;
-    *odata++ = out_l2;
-    *odata++ = out_r2;
-
-    if (fabs (out_l2) > 0 || fabs (out_r2) > 0)
-      drained = FALSE;
-  }
-  return drained;
-}
-
-static gboolean
-gst_freeverb_transform_s2s_float (GstFreeverb * filter,
-    gfloat * idata, gfloat * odata, guint num_samples)
-{
-  GstFreeverbPrivate *priv = filter->priv;
-  gint i, k;
-  gfloat out_l1, out_r1, input_1l, input_1r;
-  gfloat out_l2, out_r2, input_2l, input_2r;
-  gboolean drained = TRUE;
-
-  for (k = 0; k < num_samples; k++) {
-
-    out_l1 = out_r1 = 0.0;
-
-    input_2l = *idata++;
-    input_2r = *idata++;
-    input_1l = (input_2l + DC_OFFSET) * priv->gain;
-    input_1r = (input_2r + DC_OFFSET) * priv->gain;
-
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      freeverb_comb_process (priv->combL[i], input_1l, out_l1);
-      freeverb_comb_process (priv->combR[i], input_1r, out_r1);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      freeverb_allpass_process (priv->allpassL[i], out_l1);
-      freeverb_allpass_process (priv->allpassR[i], out_r1);
-    }
-
-    /* Remove the DC offset */
-    out_l1 -= DC_OFFSET;
-    out_r1 -= DC_OFFSET;
-
-    /* Calculate output */
-    out_l2 = out_l1 * priv->wet1 + out_r1 * priv->wet2 + input_2l * priv->dry;
-    out_r2 = out_r1 * priv->wet1 + out_l1 * priv->wet2 + input_2r * priv->dry;
-    *odata++ = out_l2;
-    *odata++ = out_r2;
-
-    if (fabs (out_l2) > 0 || fabs (out_r2) > 0)
-      drained = FALSE;
-  }
   return drained;
 }
 
@@ -919,8 +612,10 @@ gst_freeverb_transform (GstBaseTransform * base, GstBuffer * inbuf,
     GstBuffer * outbuf)
 {
   GstFreeverb *filter = GST_FREEVERB (base);
-  guint num_samples = GST_BUFFER_SIZE (outbuf) / (2 * filter->width);
+  guint num_samples = GST_BUFFER_SIZE (outbuf) /
+      (filter->priv->n_banks * filter->width);
   GstClockTime timestamp;
+  guint fz_mode;
 
   timestamp = GST_BUFFER_TIMESTAMP (inbuf);
   timestamp =
@@ -945,8 +640,10 @@ gst_freeverb_transform (GstBaseTransform * base, GstBuffer * inbuf,
     filter->drained = FALSE;
   }
 
+  DENORMALS_OFF (fz_mode);
   filter->drained = filter->process (filter, GST_BUFFER_DATA (inbuf),
       GST_BUFFER_DATA (outbuf), num_samples);
+  DENORMALS_RESTORE (fz_mode);
 
   if (filter->drained) {
     GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_GAP);
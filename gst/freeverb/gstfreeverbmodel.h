@@ -0,0 +1,299 @@
+/*
+ * GStreamer
+ * Copyright (C) 2011 Stefan Sauer <ensonic@users.sf.net>
+ *
+ * gstfreeverbmodel.h: the filters of the reverb
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/*
+ * Freeverb
+ *
+ * Written by Jezar at Dreampoint, June 2000
+ * http://www.dreampoint.co.uk
+ * This code is public domain
+ *
+ * Translated to C by Peter Hanappe, Mai 2001
+ */
+
+#ifndef __GST_FREEVERB_MODEL_H__
+#define __GST_FREEVERB_MODEL_H__
+
+#include <glib.h>
+#include <string.h>
+
+G_BEGIN_DECLS
+
+/* Denormalising:
+ *
+ * Another method fixes the problem cheaper: Use a small DC-offset in
+ * the filter calculations.  Now the signals converge not against 0,
+ * but against the offset.  The constant offset is invisible from the
+ * outside world (i.e. it does not appear at the output.  There is a
+ * very small turn-on transient response, which should not cause
+ * problems.
+ */
+
+//#define DC_OFFSET 0
+#define DC_OFFSET 1e-8
+//#define DC_OFFSET 0.001f
+
+/* number of frames that are run through the filters in one go */
+#define BLOCK_SIZE 256
+
+/* The filters below run over a whole block at a time. Their delay lines are
+ * at least as long as the part of a block that is processed before the
+ * index wraps around, so a sample that is read was always written in an
+ * earlier pass and the loops have no dependency through memory. */
+
+/* all pass filter */
+
+#define allpassfeedback 0.5f
+
+typedef struct _freeverb_allpass
+{
+  gfloat *buffer;
+  gint bufsize;
+  gint bufidx;
+} freeverb_allpass;
+
+static inline void
+freeverb_allpass_setbuffer (freeverb_allpass * allpass, gint size)
+{
+  allpass->bufidx = 0;
+  size = MAX (size, 1);
+  allpass->buffer = g_new (gfloat, size);
+  allpass->bufsize = size;
+}
+
+static inline void
+freeverb_allpass_release (freeverb_allpass * allpass)
+{
+  g_free (allpass->buffer);
+}
+
+static inline void
+freeverb_allpass_init (freeverb_allpass * allpass)
+{
+  gint i, len = allpass->bufsize;
+  gfloat *buf = allpass->buffer;
+
+  for (i = 0; i < len; i++) {
+    buf[i] = DC_OFFSET;         /* this is not 100 % correct. */
+  }
+}
+
+/* filters @data in place */
+static inline void
+freeverb_allpass_process (freeverb_allpass * allpass, gfloat * data,
+    guint len)
+{
+  while (len > 0) {
+    gfloat *buf = allpass->buffer + allpass->bufidx;
+    guint k, n = MIN (len, allpass->bufsize - allpass->bufidx);
+
+    for (k = 0; k < n; k++) {
+      gfloat bufout = buf[k];
+      gfloat input = data[k];
+
+      buf[k] = input + (bufout * allpassfeedback);
+      data[k] = bufout - input;
+    }
+
+    allpass->bufidx += n;
+    if (allpass->bufidx >= allpass->bufsize)
+      allpass->bufidx = 0;
+    data += n;
+    len -= n;
+  }
+}
+
+/* comb filter */
+
+typedef struct _freeverb_comb
+{
+  gfloat filterstore;
+  gfloat *buffer;
+  gint bufsize;
+  gint bufidx;
+} freeverb_comb;
+
+static inline void
+freeverb_comb_setbuffer (freeverb_comb * comb, gint size)
+{
+  comb->filterstore = 0;
+  comb->bufidx = 0;
+  size = MAX (size, 1);
+  comb->buffer = g_new (gfloat, size);
+  comb->bufsize = size;
+}
+
+static inline void
+freeverb_comb_release (freeverb_comb * comb)
+{
+  g_free (comb->buffer);
+}
+
+static inline void
+freeverb_comb_init (freeverb_comb * comb)
+{
+  gint i, len = comb->bufsize;
+  gfloat *buf = comb->buffer;
+
+  for (i = 0; i < len; i++) {
+    buf[i] = DC_OFFSET;         /* This is not 100 % correct. */
+  }
+}
+
+/* filters @in and adds the result to @out */
+static inline void
+freeverb_comb_process (freeverb_comb * comb, gfloat feedback, gfloat damp1,
+    gfloat damp2, const gfloat * in, gfloat * out, guint len)
+{
+  gfloat filterstore = comb->filterstore;
+
+  while (len > 0) {
+    gfloat *buf = comb->buffer + comb->bufidx;
+    guint k, n = MIN (len, comb->bufsize - comb->bufidx);
+
+    for (k = 0; k < n; k++) {
+      gfloat tmp = buf[k];
+
+      filterstore = (tmp * damp2) + (filterstore * damp1);
+      buf[k] = in[k] + (filterstore * feedback);
+      out[k] += tmp;
+    }
+
+    comb->bufidx += n;
+    if (comb->bufidx >= comb->bufsize)
+      comb->bufidx = 0;
+    in += n;
+    out += n;
+    len -= n;
+  }
+  comb->filterstore = filterstore;
+}
+
+#define numcombs 8
+#define numallpasses 4
+#define	fixedgain 0.015f
+#define scalewet 1.0f
+#define scaledry 1.0f
+#define scaledamp 1.0f
+#define scaleroom 0.28f
+#define offsetroom 0.7f
+#define stereospread 23
+
+/* These values assume 44.1KHz sample rate
+ * they will need scaling for 96KHz (or other) sample rates.
+ * The values were obtained by listening tests.
+ * Channel n uses these values plus n * stereospread.
+ */
+static const gint combtuning[numcombs] = {
+  1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617
+};
+
+static const gint allpasstuning[numallpasses] = {
+  556, 441, 341, 225
+};
+
+/* the filters of one output channel */
+typedef struct _freeverb_bank
+{
+  freeverb_comb comb[numcombs];
+  freeverb_allpass allpass[numallpasses];
+} freeverb_bank;
+
+/* allocates the delay lines of the bank of output channel @b */
+static inline void
+freeverb_bank_setbuffers (freeverb_bank * bank, gint b, gfloat srfactor)
+{
+  gint i;
+
+  for (i = 0; i < numcombs; i++)
+    freeverb_comb_setbuffer (&bank->comb[i],
+        (combtuning[i] + b * stereospread) * srfactor);
+  for (i = 0; i < numallpasses; i++)
+    freeverb_allpass_setbuffer (&bank->allpass[i],
+        (allpasstuning[i] + b * stereospread) * srfactor);
+}
+
+static inline void
+freeverb_bank_init (freeverb_bank * bank)
+{
+  gint i;
+
+  for (i = 0; i < numcombs; i++)
+    freeverb_comb_init (&bank->comb[i]);
+  for (i = 0; i < numallpasses; i++)
+    freeverb_allpass_init (&bank->allpass[i]);
+}
+
+static inline void
+freeverb_bank_release (freeverb_bank * bank)
+{
+  gint i;
+
+  for (i = 0; i < numcombs; i++)
+    freeverb_comb_release (&bank->comb[i]);
+  for (i = 0; i < numallpasses; i++)
+    freeverb_allpass_release (&bank->allpass[i]);
+}
+
+/* runs the filters of @bank over @len frames of @in, writing to @out */
+static inline void
+freeverb_bank_process (freeverb_bank * bank, gfloat feedback, gfloat damp,
+    const gfloat * in, gfloat * out, guint len)
+{
+  gfloat damp1 = damp, damp2 = 1.0f - damp;
+  guint i;
+
+  /* Accumulate comb filters in parallel */
+  memset (out, 0, len * sizeof (gfloat));
+  for (i = 0; i < numcombs; i++)
+    freeverb_comb_process (&bank->comb[i], feedback, damp1, damp2, in, out,
+        len);
+  /* Feed through allpasses in series */
+  for (i = 0; i < numallpasses; i++)
+    freeverb_allpass_process (&bank->allpass[i], out, len);
+}
+
+/* Writes the wet signal of output channel @b to @wet: its own reverb plus
+ * some of the reverb of its stereo partner, channel b ^ 1, like the left and
+ * right channel of the original stereo freeverb. @block_out holds the
+ * reverb of all @n_banks banks, BLOCK_SIZE frames each. The last channel of
+ * an odd number of channels has no partner and only gets its own reverb. */
+static inline void
+freeverb_bank_wet (const gfloat * block_out, gint b, gint n_banks,
+    gfloat wet1, gfloat wet2, gfloat * wet, guint len)
+{
+  const gfloat *out = block_out + b * BLOCK_SIZE;
+  guint k;
+
+  if ((b ^ 1) < n_banks) {
+    const gfloat *other = block_out + (b ^ 1) * BLOCK_SIZE;
+
+    for (k = 0; k < len; k++)
+      wet[k] = (out[k] - DC_OFFSET) * wet1 + (other[k] - DC_OFFSET) * wet2;
+  } else {
+    for (k = 0; k < len; k++)
+      wet[k] = (out[k] - DC_OFFSET) * wet1;
+  }
+}
+
+G_END_DECLS
+
+#endif /* __GST_FREEVERB_MODEL_H__ */
@@ -84,6 +84,14 @@ typedef union
 #endif
 void gaudi_orc_burn (guint32 * ORC_RESTRICT d1, const guint32 * ORC_RESTRICT s1,
     int p1, int n);
+void gaudi_orc_blur_mac_u8 (gint32 * ORC_RESTRICT d1, const guint8 * ORC_RESTRICT s1,
+    int p1, int n);
+void gaudi_orc_blur_narrow (gint16 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1,
+    int n);
+void gaudi_orc_blur_mac_s16 (gint32 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    int p1, int n);
+void gaudi_orc_blur_pack (guint8 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1,
+    int n);
 
 
 /* begin Orc C target preamble */
@@ -426,3 +434,501 @@ gaudi_orc_burn (guint32 * ORC_RESTRICT d1, const guint32 * ORC_RESTRICT s1,
   func (ex);
 }
 #endif
+
+
+/* gaudi_orc_blur_mac_u8 */
+#ifdef DISABLE_ORC
+void
+gaudi_orc_blur_mac_u8 (gint32 * ORC_RESTRICT d1, const guint8 * ORC_RESTRICT s1,
+    int p1, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  orc_int8 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_int8 *) s1;
+
+  /* 2: loadpw */
+  var35.i = p1;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 1: convubw */
+    var38.i = (orc_uint8) var34;
+    /* 3: mulswl */
+    var39.i = var38.i * var35.i;
+    /* 4: loadl */
+    var36 = ptr0[i];
+    /* 5: addl */
+    var37.i = ((orc_uint32) var36.i) + ((orc_uint32) var39.i);
+    /* 6: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+#else
+static void
+_backup_gaudi_orc_blur_mac_u8 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_int8 *ORC_RESTRICT ptr4;
+  orc_int8 var34;
+  orc_union16 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+  orc_union16 var38;
+  orc_union32 var39;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_int8 *) ex->arrays[4];
+
+  /* 2: loadpw */
+  var35.i = ex->params[24];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadb */
+    var34 = ptr4[i];
+    /* 1: convubw */
+    var38.i = (orc_uint8) var34;
+    /* 3: mulswl */
+    var39.i = var38.i * var35.i;
+    /* 4: loadl */
+    var36 = ptr0[i];
+    /* 5: addl */
+    var37.i = ((orc_uint32) var36.i) + ((orc_uint32) var39.i);
+    /* 6: storel */
+    ptr0[i] = var37;
+  }
+
+}
+
+void
+gaudi_orc_blur_mac_u8 (gint32 * ORC_RESTRICT d1, const guint8 * ORC_RESTRICT s1,
+    int p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "gaudi_orc_blur_mac_u8");
+      orc_program_set_backup_function (p, _backup_gaudi_orc_blur_mac_u8);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 1, "s1");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_temporary (p, 2, "t1");
+      orc_program_add_temporary (p, 4, "t2");
+
+      orc_program_append_2 (p, "convubw", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_D1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T2, ORC_VAR_T1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->params[ORC_VAR_P1] = p1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* gaudi_orc_blur_narrow */
+#ifdef DISABLE_ORC
+void
+gaudi_orc_blur_narrow (gint16 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1,
+    int n)
+{
+  int i;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+
+  ptr0 = (orc_union16 *) d1;
+  ptr4 = (orc_union32 *) s1;
+
+  /* 1: loadpl */
+  var34.i = (int) 0x00000080;   /* 128 or 6.32404e-322f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: addl */
+    var37.i = ((orc_uint32) var33.i) + ((orc_uint32) var34.i);
+    /* 4: shrsl */
+    var38.i = var37.i >> 8;
+    /* 5: convlw */
+    var36.i = var38.i;
+    /* 6: storew */
+    ptr0[i] = var36;
+  }
+
+}
+
+#else
+static void
+_backup_gaudi_orc_blur_narrow (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union16 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var33;
+  orc_union32 var34;
+  orc_union16 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+
+  ptr0 = (orc_union16 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+
+  /* 1: loadpl */
+  var34.i = (int) 0x00000080;   /* 128 or 6.32404e-322f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var33 = ptr4[i];
+    /* 2: addl */
+    var37.i = ((orc_uint32) var33.i) + ((orc_uint32) var34.i);
+    /* 4: shrsl */
+    var38.i = var37.i >> 8;
+    /* 5: convlw */
+    var36.i = var38.i;
+    /* 6: storew */
+    ptr0[i] = var36;
+  }
+
+}
+
+void
+gaudi_orc_blur_narrow (gint16 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1,
+    int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "gaudi_orc_blur_narrow");
+      orc_program_set_backup_function (p, _backup_gaudi_orc_blur_narrow);
+      orc_program_add_destination (p, 2, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_constant (p, 4, 0x00000080, "c1");
+      orc_program_add_constant (p, 4, 0x00000008, "c2");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convlw", 0, ORC_VAR_D1, ORC_VAR_T1, ORC_VAR_D1,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* gaudi_orc_blur_mac_s16 */
+#ifdef DISABLE_ORC
+void
+gaudi_orc_blur_mac_s16 (gint32 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    int p1, int n)
+{
+  int i;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+
+  ptr0 = (orc_union32 *) d1;
+  ptr4 = (orc_union16 *) s1;
+
+  /* 1: loadpw */
+  var34.i = p1;
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr4[i];
+    /* 2: mulswl */
+    var37.i = var33.i * var34.i;
+    /* 3: loadl */
+    var35 = ptr0[i];
+    /* 4: addl */
+    var36.i = ((orc_uint32) var35.i) + ((orc_uint32) var37.i);
+    /* 5: storel */
+    ptr0[i] = var36;
+  }
+
+}
+
+#else
+static void
+_backup_gaudi_orc_blur_mac_s16 (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_union32 *ORC_RESTRICT ptr0;
+  const orc_union16 *ORC_RESTRICT ptr4;
+  orc_union16 var33;
+  orc_union16 var34;
+  orc_union32 var35;
+  orc_union32 var36;
+  orc_union32 var37;
+
+  ptr0 = (orc_union32 *) ex->arrays[0];
+  ptr4 = (orc_union16 *) ex->arrays[4];
+
+  /* 1: loadpw */
+  var34.i = ex->params[24];
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadw */
+    var33 = ptr4[i];
+    /* 2: mulswl */
+    var37.i = var33.i * var34.i;
+    /* 3: loadl */
+    var35 = ptr0[i];
+    /* 4: addl */
+    var36.i = ((orc_uint32) var35.i) + ((orc_uint32) var37.i);
+    /* 5: storel */
+    ptr0[i] = var36;
+  }
+
+}
+
+void
+gaudi_orc_blur_mac_s16 (gint32 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1,
+    int p1, int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "gaudi_orc_blur_mac_s16");
+      orc_program_set_backup_function (p, _backup_gaudi_orc_blur_mac_s16);
+      orc_program_add_destination (p, 4, "d1");
+      orc_program_add_source (p, 2, "s1");
+      orc_program_add_parameter (p, 2, "p1");
+      orc_program_add_temporary (p, 4, "t1");
+
+      orc_program_append_2 (p, "mulswl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_P1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_D1, ORC_VAR_D1, ORC_VAR_T1,
+          ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+  ex->params[ORC_VAR_P1] = p1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
+
+
+/* gaudi_orc_blur_pack */
+#ifdef DISABLE_ORC
+void
+gaudi_orc_blur_pack (guint8 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1,
+    int n)
+{
+  int i;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_int8 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union16 var39;
+
+  ptr0 = (orc_int8 *) d1;
+  ptr4 = (orc_union32 *) s1;
+
+  /* 1: loadpl */
+  var35.i = (int) 0x00020000;   /* 131072 or 6.47582e-319f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var34 = ptr4[i];
+    /* 2: addl */
+    var37.i = ((orc_uint32) var34.i) + ((orc_uint32) var35.i);
+    /* 4: shrsl */
+    var38.i = var37.i >> 18;
+    /* 5: convssslw */
+    var39.i = ORC_CLAMP_SW (var38.i);
+    /* 6: convsuswb */
+    var36 = ORC_CLAMP_UB (var39.i);
+    /* 7: storeb */
+    ptr0[i] = var36;
+  }
+
+}
+
+#else
+static void
+_backup_gaudi_orc_blur_pack (OrcExecutor * ORC_RESTRICT ex)
+{
+  int i;
+  int n = ex->n;
+  orc_int8 *ORC_RESTRICT ptr0;
+  const orc_union32 *ORC_RESTRICT ptr4;
+  orc_union32 var34;
+  orc_union32 var35;
+  orc_int8 var36;
+  orc_union32 var37;
+  orc_union32 var38;
+  orc_union16 var39;
+
+  ptr0 = (orc_int8 *) ex->arrays[0];
+  ptr4 = (orc_union32 *) ex->arrays[4];
+
+  /* 1: loadpl */
+  var35.i = (int) 0x00020000;   /* 131072 or 6.47582e-319f */
+
+  for (i = 0; i < n; i++) {
+    /* 0: loadl */
+    var34 = ptr4[i];
+    /* 2: addl */
+    var37.i = ((orc_uint32) var34.i) + ((orc_uint32) var35.i);
+    /* 4: shrsl */
+    var38.i = var37.i >> 18;
+    /* 5: convssslw */
+    var39.i = ORC_CLAMP_SW (var38.i);
+    /* 6: convsuswb */
+    var36 = ORC_CLAMP_UB (var39.i);
+    /* 7: storeb */
+    ptr0[i] = var36;
+  }
+
+}
+
+void
+gaudi_orc_blur_pack (guint8 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1,
+    int n)
+{
+  OrcExecutor _ex, *ex = &_ex;
+  static volatile int p_inited = 0;
+  static OrcCode *c = 0;
+  void (*func) (OrcExecutor *);
+
+  if (!p_inited) {
+    orc_once_mutex_lock ();
+    if (!p_inited) {
+      OrcProgram *p;
+
+      p = orc_program_new ();
+      orc_program_set_name (p, "gaudi_orc_blur_pack");
+      orc_program_set_backup_function (p, _backup_gaudi_orc_blur_pack);
+      orc_program_add_destination (p, 1, "d1");
+      orc_program_add_source (p, 4, "s1");
+      orc_program_add_constant (p, 4, 0x00020000, "c1");
+      orc_program_add_constant (p, 4, 0x00000012, "c2");
+      orc_program_add_temporary (p, 4, "t1");
+      orc_program_add_temporary (p, 2, "t2");
+
+      orc_program_append_2 (p, "addl", 0, ORC_VAR_T1, ORC_VAR_S1, ORC_VAR_C1,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "shrsl", 0, ORC_VAR_T1, ORC_VAR_T1, ORC_VAR_C2,
+          ORC_VAR_D1);
+      orc_program_append_2 (p, "convssslw", 0, ORC_VAR_T2, ORC_VAR_T1,
+          ORC_VAR_D1, ORC_VAR_D1);
+      orc_program_append_2 (p, "convsuswb", 0, ORC_VAR_D1, ORC_VAR_T2,
+          ORC_VAR_D1, ORC_VAR_D1);
+
+      orc_program_compile (p);
+      c = orc_program_take_code (p);
+      orc_program_free (p);
+    }
+    p_inited = TRUE;
+    orc_once_mutex_unlock ();
+  }
+  ex->arrays[ORC_VAR_A2] = c;
+  ex->program = 0;
+
+  ex->n = n;
+  ex->arrays[ORC_VAR_D1] = d1;
+  ex->arrays[ORC_VAR_S1] = (void *) s1;
+
+  func = c->exec;
+  func (ex);
+}
+#endif
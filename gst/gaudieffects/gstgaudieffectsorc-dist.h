@@ -68,6 +68,10 @@ typedef union { orc_int64 i; double f; orc_int32 x2[2]; float x2f[2]; orc_int16
 #endif
 #endif
 void gaudi_orc_burn (guint32 * ORC_RESTRICT d1, const guint32 * ORC_RESTRICT s1, int p1, int n);
+void gaudi_orc_blur_mac_u8 (gint32 * ORC_RESTRICT d1, const guint8 * ORC_RESTRICT s1, int p1, int n);
+void gaudi_orc_blur_narrow (gint16 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1, int n);
+void gaudi_orc_blur_mac_s16 (gint32 * ORC_RESTRICT d1, const gint16 * ORC_RESTRICT s1, int p1, int n);
+void gaudi_orc_blur_pack (guint8 * ORC_RESTRICT d1, const gint32 * ORC_RESTRICT s1, int n);
 
 #ifdef __cplusplus
 }
@@ -60,15 +60,18 @@
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
-#include <string.h>
 #endif
 
+#include <string.h>
 #include <math.h>
 #include <gst/gst.h>
+#include <gst/bandpool/gstbandpool.h>
 
 #include "gstplugin.h"
 #include "gstgaussblur.h"
 
+#include "gstgaudieffectsorc.h"
+
 static void gst_gaussianblur_finalize (GObject * object);
 
 static gboolean gst_gaussianblur_set_info (GstVideoFilter * filter,
@@ -112,17 +115,21 @@ enum
 {
   PROP_0,
   PROP_SIGMA,
+  PROP_N_THREADS,
   PROP_LAST
 };
 
 static gboolean make_gaussian_kernel (GstGaussianBlur * gb, float sigma);
-static void gaussian_smooth (GstGaussianBlur * gb, guint8 * image,
-    guint8 * out_image);
+static void gaussian_smooth (GstGaussianBlur * gb, GstGaussianBlurBand * band);
 
 #define gst_gaussianblur_parent_class parent_class
 G_DEFINE_TYPE (GstGaussianBlur, gst_gaussianblur, GST_TYPE_VIDEO_FILTER);
 
 #define DEFAULT_SIGMA 1.2
+#define DEFAULT_N_THREADS 0
+
+/* don't split frames into bands of fewer lines than this */
+#define MIN_BAND_HEIGHT 16
 
 /* Initalize the gaussianblur's class. */
 static void
@@ -152,26 +159,60 @@ gst_gaussianblur_class_init (GstGaussianBlurClass * klass)
           "Sigma value for gaussian blur (negative for sharpen)",
           -20.0, 20.0, DEFAULT_SIGMA,
           G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of horizontal bands blurred in parallel "
+          "(0 = number of processors)", 0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   vfilter_class->transform_frame =
       GST_DEBUG_FUNCPTR (gst_gaussianblur_transform_frame);
   vfilter_class->set_info = GST_DEBUG_FUNCPTR (gst_gaussianblur_set_info);
 }
 
+static void
+gst_gaussianblur_free_bands (GstGaussianBlur * gb)
+{
+  guint i;
+
+  for (i = 0; i < gb->n_bands; i++) {
+    g_free (gb->bands[i].rows);
+    g_free (gb->bands[i].acc);
+    g_free (gb->bands[i].padded);
+  }
+  g_free (gb->bands);
+  gb->bands = NULL;
+  gb->n_bands = 0;
+}
+
+static void
+gst_gaussianblur_alloc_bands (GstGaussianBlur * gb, guint n_bands)
+{
+  gint n = gb->width * 4;
+  guint i;
+
+  gst_gaussianblur_free_bands (gb);
+
+  gb->bands = g_new0 (GstGaussianBlurBand, n_bands);
+  gb->n_bands = n_bands;
+  for (i = 0; i < n_bands; i++) {
+    gb->bands[i].rows = g_new (gint16, gb->windowsize * n);
+    gb->bands[i].acc = g_new (gint32, n);
+    gb->bands[i].padded = g_new (guint8, n + (gb->windowsize - 1) * 4);
+  }
+}
+
 static gboolean
 gst_gaussianblur_set_info (GstVideoFilter * filter, GstCaps * incaps,
     GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
 {
   GstGaussianBlur *gb = GST_GAUSSIANBLUR (filter);
-  guint32 n_elems;
 
   gb->width = GST_VIDEO_INFO_WIDTH (in_info);
   gb->height = GST_VIDEO_INFO_HEIGHT (in_info);
 
-  /* get stride */
-  gb->stride = GST_VIDEO_INFO_COMP_STRIDE (in_info, 0);
-  n_elems = gb->stride * gb->height;
-  gb->tempim = g_malloc (sizeof (gfloat) * n_elems);
+  /* the scratch rows depend on the width */
+  gst_gaussianblur_free_bands (gb);
 
   return TRUE;
 }
@@ -181,6 +222,7 @@ gst_gaussianblur_init (GstGaussianBlur * gb)
 {
   gb->sigma = DEFAULT_SIGMA;
   gb->cur_sigma = -1.0;
+  gb->n_threads = DEFAULT_N_THREADS;
 }
 
 static void
@@ -188,20 +230,23 @@ gst_gaussianblur_finalize (GObject * object)
 {
   GstGaussianBlur *gb = GST_GAUSSIANBLUR (object);
 
-  g_free (gb->tempim);
-  gb->tempim = NULL;
-
-  g_free (gb->smoothedim);
-  gb->smoothedim = NULL;
+  gst_gaussianblur_free_bands (gb);
 
   g_free (gb->kernel);
   gb->kernel = NULL;
-  g_free (gb->kernel_sum);
-  gb->kernel_sum = NULL;
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_gaussianblur_band_func (gpointer data, gpointer user_data)
+{
+  GstGaussianBlurBand *band = data;
+  GstGaussianBlur *gb = user_data;
+
+  gaussian_smooth (gb, band);
+}
+
 static GstFlowReturn
 gst_gaussianblur_transform_frame (GstVideoFilter * vfilter,
     GstVideoFrame * in_frame, GstVideoFrame * out_frame)
@@ -210,7 +255,7 @@ gst_gaussianblur_transform_frame (GstVideoFilter * vfilter,
   GstClockTime timestamp;
   gint64 stream_time;
   gfloat sigma;
-  guint8 *src, *dest;
+  guint n_threads, n_bands, i;
 
   /* GstController: update the properties */
   timestamp = GST_BUFFER_TIMESTAMP (in_frame->buffer);
@@ -226,13 +271,14 @@ gst_gaussianblur_transform_frame (GstVideoFilter * vfilter,
 
   GST_OBJECT_LOCK (filter);
   sigma = filter->sigma;
+  n_threads = filter->n_threads;
   GST_OBJECT_UNLOCK (filter);
 
   if (filter->cur_sigma != sigma) {
     g_free (filter->kernel);
     filter->kernel = NULL;
-    g_free (filter->kernel_sum);
-    filter->kernel_sum = NULL;
+    /* the scratch rows depend on the window size */
+    gst_gaussianblur_free_bands (filter);
     filter->cur_sigma = sigma;
   }
   if (filter->kernel == NULL &&
@@ -242,179 +288,145 @@ gst_gaussianblur_transform_frame (GstVideoFilter * vfilter,
     return GST_FLOW_ERROR;
   }
 
+  /* every band also blurs the rows above and below it horizontally,
+   * keep that overhead small compared to the band */
+  n_bands = gst_band_pool_get_n_bands (n_threads, filter->height,
+      MAX (MIN_BAND_HEIGHT, filter->windowsize));
+  if (filter->bands == NULL || filter->n_bands != n_bands)
+    gst_gaussianblur_alloc_bands (filter, n_bands);
+
   /*
    * Perform gaussian smoothing on the image using the input standard
    * deviation.
    */
-  src = GST_VIDEO_FRAME_COMP_DATA (in_frame, 0);
-  dest = GST_VIDEO_FRAME_COMP_DATA (out_frame, 0);
-  gst_video_frame_copy (out_frame, in_frame);
-  gaussian_smooth (filter, src, dest);
+  for (i = 0; i < n_bands; i++) {
+    GstGaussianBlurBand *band = &filter->bands[i];
+
+    band->src = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0);
+    band->dest = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
+    band->src_stride = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0);
+    band->dest_stride = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0);
+    band->y_start = filter->height * i / n_bands;
+    band->y_end = filter->height * (i + 1) / n_bands;
+  }
+
+  gst_band_pool_run (gst_band_pool_get_default (), gst_gaussianblur_band_func,
+      filter, filter->bands, sizeof (GstGaussianBlurBand), n_bands);
 
   return GST_FLOW_OK;
 }
 
+/* horizontal pass of one row into Q5 */
 static void
-blur_row_x (GstGaussianBlur * gb, guint8 * in_row, gfloat * out_row)
+blur_row_x (GstGaussianBlur * gb, GstGaussianBlurBand * band,
+    const guint8 * in_row, gint16 * out_row)
 {
-  int c, cc, center;
-  float dot[4], sum;
-  int k, kmin, kmax;
-
-  center = gb->windowsize / 2;
-
-  for (c = 0; c < gb->width; c++) {
-    /* Calculate min */
-    cc = center - c;
-    kmin = MAX (0, cc);
-    cc = kmin - cc;
-    /* Calc max */
-    kmax = MIN (gb->windowsize, gb->width - cc);
-    cc *= 4;
-
-    dot[0] = dot[1] = dot[2] = dot[3] = 0.0;
-    /* Calculate sum for range */
-    sum = gb->kernel_sum[kmax - 1];
-    sum -= kmin ? gb->kernel_sum[kmin - 1] : 0.0;
-
-    for (k = kmin; k < kmax; k++) {
-      float coeff = gb->kernel[k];
-      dot[0] += (float) in_row[cc++] * coeff;
-      dot[1] += (float) in_row[cc++] * coeff;
-      dot[2] += (float) in_row[cc++] * coeff;
-      dot[3] += (float) in_row[cc++] * coeff;
-    }
-
-    out_row[c * 4] = dot[0] / sum;
-    out_row[c * 4 + 1] = dot[1] / sum;
-    out_row[c * 4 + 2] = dot[2] / sum;
-    out_row[c * 4 + 3] = dot[3] / sum;
+  gint center = gb->windowsize / 2;
+  gint n = gb->width * 4;
+  guint8 *padded = band->padded;
+  gint i, k;
+
+  /* replicate the edge pixels, so that each tap is a shifted row */
+  for (i = 0; i < center; i++) {
+    memcpy (padded + i * 4, in_row, 4);
+    memcpy (padded + (center + gb->width + i) * 4, in_row + n - 4, 4);
   }
+  memcpy (padded + center * 4, in_row, n);
+
+  memset (band->acc, 0, n * sizeof (gint32));
+  for (k = 0; k < gb->windowsize; k++)
+    gaudi_orc_blur_mac_u8 (band->acc, padded + k * 4, gb->kernel[k], n);
+  gaudi_orc_blur_narrow (out_row, band->acc, n);
 }
 
 static void
-gaussian_smooth (GstGaussianBlur * gb, guint8 * image, guint8 * out_image)
+gaussian_smooth (GstGaussianBlur * gb, GstGaussianBlurBand * band)
 {
-  int r, c, rr, center;
-  float dot[4], sum;
-  int k, kmin, kmax;
-  guint8 *in_row = image;
-  float *tmp_out_row = gb->tempim;
-  float *tmp_in_pos;
-  gint y_avail = 0;
-  guint8 *out_row;
+  gint center = gb->windowsize / 2;
+  gint n = gb->width * 4;
+  gint r, rr, k, y_avail;
 
   /* Apply the gaussian kernel */
-  center = gb->windowsize / 2;
+
+  /* first input row this band needs */
+  y_avail = MAX (band->y_start - center, 0);
 
   /* Blur in the y - direction. */
-  for (r = 0; r < gb->height; r++) {
-    /* Calculate input row range */
-    rr = center - r;
-    kmin = MAX (0, rr);
-    rr = kmin - rr;
-    /* Calc max */
-    kmax = MIN (gb->windowsize, gb->height - rr);
-
-    /* Precalculate sum for range */
-    sum = gb->kernel_sum[kmax - 1];
-    sum -= kmin ? gb->kernel_sum[kmin - 1] : 0.0;
-
-    /* Blur more input rows (x direction blur) */
+  for (r = band->y_start; r < band->y_end; r++) {
+    /* Blur more input rows (x direction blur), the rows are kept in a
+     * ring of windowsize entries */
     while (y_avail <= (r + center) && y_avail < gb->height) {
-      blur_row_x (gb, in_row, tmp_out_row);
-      in_row += gb->stride;
-      tmp_out_row += gb->stride;
+      blur_row_x (gb, band, band->src + y_avail * band->src_stride,
+          band->rows + (y_avail % gb->windowsize) * n);
       y_avail++;
     }
 
-    tmp_in_pos = gb->tempim + (rr * gb->stride);
-    out_row = out_image + r * gb->stride;
-
-    for (c = 0; c < gb->width; c++) {
-      float *tmp = tmp_in_pos;
-
-      dot[0] = dot[1] = dot[2] = dot[3] = 0.0;
-      for (k = kmin; k < kmax; k++, tmp += gb->stride) {
-        float kern = gb->kernel[k];
-        dot[0] += tmp[0] * kern;
-        dot[1] += tmp[1] * kern;
-        dot[2] += tmp[2] * kern;
-        dot[3] += tmp[3] * kern;
-      }
-
-      *out_row++ = (guint8) CLAMP ((dot[0] / sum + 0.5), 0, 255);
-      *out_row++ = (guint8) CLAMP ((dot[1] / sum + 0.5), 0, 255);
-      *out_row++ = (guint8) CLAMP ((dot[2] / sum + 0.5), 0, 255);
-      *out_row++ = (guint8) CLAMP ((dot[3] / sum + 0.5), 0, 255);
-
-      tmp_in_pos += 4;
+    memset (band->acc, 0, n * sizeof (gint32));
+    for (k = 0; k < gb->windowsize; k++) {
+      /* rows past the edges repeat the edge row */
+      rr = CLAMP (r + k - center, 0, gb->height - 1);
+      gaudi_orc_blur_mac_s16 (band->acc,
+          band->rows + (rr % gb->windowsize) * n, gb->kernel[k], n);
     }
+    gaudi_orc_blur_pack (band->dest + r * band->dest_stride, band->acc, n);
   }
 }
 
 /*
- * Create a one dimensional gaussian kernel.
+ * Create a one dimensional gaussian kernel, in Q13 fixed point.
  */
 static gboolean
 make_gaussian_kernel (GstGaussianBlur * gb, float sigma)
 {
   int i, center, left, right;
-  float sum, sum2;
+  float sum;
+  float *kernel;
+  gint isum;
   const float fe = -0.5 / (sigma * sigma);
   const float dx = 1.0 / (sigma * sqrt (2 * G_PI));
 
   center = ceil (2.5 * fabs (sigma));
   gb->windowsize = (int) (1 + 2 * center);
 
-  gb->kernel = g_new (float, gb->windowsize);
-  gb->kernel_sum = g_new (float, gb->windowsize);
-  if (gb->kernel == NULL || gb->kernel_sum == NULL)
+  gb->kernel = g_new (gint16, gb->windowsize);
+  if (gb->kernel == NULL)
     return FALSE;
 
   if (gb->windowsize == 1) {
-    gb->kernel[0] = 1.0;
-    gb->kernel_sum[0] = 1.0;
+    gb->kernel[0] = 1 << 13;
     return TRUE;
   }
 
+  kernel = g_new (float, gb->windowsize);
+
   /* Center co-efficient */
-  sum = gb->kernel[center] = dx;
+  sum = kernel[center] = dx;
 
   /* Other coefficients */
   left = center - 1;
   right = center + 1;
   for (i = 1; i <= center; i++, left--, right++) {
     float fx = dx * pow (G_E, fe * i * i);
-    gb->kernel[right] = gb->kernel[left] = fx;
+    kernel[right] = kernel[left] = fx;
     sum += 2 * fx;
   }
 
   if (sigma < 0) {
     sum = -sum;
-    gb->kernel[center] += 2.0 * sum;
+    kernel[center] += 2.0 * sum;
   }
 
-  for (i = 0; i < gb->windowsize; i++)
-    gb->kernel[i] /= sum;
-
-  sum2 = 0.0;
+  /* the taps sum to 1, at most 2 for the sharpening center tap, which
+   * still fits in Q13 */
+  isum = 0;
   for (i = 0; i < gb->windowsize; i++) {
-    sum2 += gb->kernel[i];
-    gb->kernel_sum[i] = sum2;
+    gb->kernel[i] = (gint16) floor (kernel[i] / sum * (1 << 13) + 0.5);
+    isum += gb->kernel[i];
   }
+  /* make the rounded taps sum to exactly 1 */
+  gb->kernel[center] += (1 << 13) - isum;
 
-#if 0
-  g_print ("Sigma %f: ", sigma);
-  for (i = 0; i < gb->windowsize; i++)
-    g_print ("%f ", gb->kernel[i]);
-  g_print ("\n");
-  g_print ("sums: ");
-  for (i = 0; i < gb->windowsize; i++)
-    g_print ("%f ", gb->kernel_sum[i]);
-  g_print ("\n");
-  g_print ("sum %f sum2 %f\n", sum, sum2);
-#endif
+  g_free (kernel);
 
   return TRUE;
 }
@@ -430,6 +442,11 @@ gst_gaussianblur_set_property (GObject * object,
       gb->sigma = g_value_get_double (value);
       GST_OBJECT_UNLOCK (object);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (object);
+      gb->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -447,6 +464,11 @@ gst_gaussianblur_get_property (GObject * object,
       g_value_set_double (value, gb->sigma);
       GST_OBJECT_UNLOCK (gb);
       break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (gb);
+      g_value_set_uint (value, gb->n_threads);
+      GST_OBJECT_UNLOCK (gb);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
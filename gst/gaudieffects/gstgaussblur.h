@@ -61,18 +61,35 @@ G_BEGIN_DECLS
 typedef struct GstGaussianBlur GstGaussianBlur;
 typedef struct GstGaussianBlurClass GstGaussianBlurClass;
 
+typedef struct
+{
+  const guint8 *src;
+  guint8 *dest;
+  gint src_stride, dest_stride;
+  gint y_start, y_end;
+
+  /* horizontally blurred rows, one per kernel tap, in Q5 */
+  gint16 *rows;
+  gint32 *acc;
+  /* input row with the edge pixels replicated */
+  guint8 *padded;
+} GstGaussianBlurBand;
+
 struct GstGaussianBlur
 {
   GstVideoFilter videofilter;
-  gint width, height, stride;
+  gint width, height;
 
   float cur_sigma, sigma;
   int windowsize;
 
-  float *kernel;
-  float *kernel_sum;
-  float *tempim;
-  gint16 *smoothedim;
+  /* Q13 kernel taps */
+  gint16 *kernel;
+
+  /* band-parallel blur */
+  guint n_threads;
+  GstGaussianBlurBand *bands;
+  guint n_bands;
 };
 
 struct GstGaussianBlurClass
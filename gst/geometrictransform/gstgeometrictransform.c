@@ -23,7 +23,9 @@
 
 #include "gstgeometrictransform.h"
 #include "geometricmath.h"
+#include <gst/bandpool/gstbandpool.h>
 #include <string.h>
+#include <math.h>
 
 GST_DEBUG_CATEGORY_STATIC (geometric_transform_debug);
 #define GST_CAT_DEFAULT geometric_transform_debug
@@ -49,7 +51,9 @@ static GstVideoFilterClass *parent_class = NULL;
 enum
 {
   PROP_0,
-  PROP_OFF_EDGE_PIXELS
+  PROP_OFF_EDGE_PIXELS,
+  PROP_INTERPOLATION,
+  PROP_N_THREADS
 };
 
 #define GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE ( \
@@ -76,6 +80,131 @@ gst_geometric_transform_off_edges_pixels_method_get_type (void)
 
 #define DEFAULT_OFF_EDGE_PIXELS GST_GT_OFF_EDGES_PIXELS_IGNORE
 
+#define GST_GT_INTERPOLATION_METHOD_TYPE ( \
+    gst_geometric_transform_interpolation_method_get_type())
+static GType
+gst_geometric_transform_interpolation_method_get_type (void)
+{
+  static GType method_type = 0;
+
+  static const GEnumValue method_types[] = {
+    {GST_GT_INTERPOLATION_NEAREST, "Nearest neighbour", "nearest"},
+    {GST_GT_INTERPOLATION_BILINEAR, "Bilinear", "bilinear"},
+    {0, NULL, NULL}
+  };
+
+  if (!method_type) {
+    method_type =
+        g_enum_register_static ("GstGeometricTransformInterpolationMethod",
+        method_types);
+  }
+  return method_type;
+}
+
+#define DEFAULT_INTERPOLATION GST_GT_INTERPOLATION_NEAREST
+#define DEFAULT_N_THREADS 0
+
+/* don't split frames into bands of fewer lines than this */
+#define MIN_BAND_HEIGHT 16
+
+typedef struct
+{
+  const guint8 *in_data;
+  guint8 *out_data;
+  gint y_start, y_end;
+} GstGeometricTransformBand;
+
+
+/* Resolves the off edge pixel handling and the interpolation weights for
+ * the input position of one output pixel. Must be called with the object
+ * lock */
+static inline void
+gst_geometric_transform_map_pixel (GstGeometricTransform * gt,
+    gdouble in_x, gdouble in_y, gint32 * offset, guint16 * weights)
+{
+  gint trunc_x, trunc_y;
+  guint16 fx = 0, fy = 0;
+
+  /* operate on out of edge pixels */
+  switch (gt->off_edge_pixels) {
+    case GST_GT_OFF_EDGES_PIXELS_CLAMP:
+      in_x = CLAMP (in_x, 0, gt->width - 1);
+      in_y = CLAMP (in_y, 0, gt->height - 1);
+      break;
+
+    case GST_GT_OFF_EDGES_PIXELS_WRAP:
+      in_x = mod_float (in_x, gt->width);
+      in_y = mod_float (in_y, gt->height);
+      if (in_x < 0)
+        in_x += gt->width;
+      if (in_y < 0)
+        in_y += gt->height;
+      break;
+
+    default:
+      break;
+  }
+
+  if (weights) {
+    gdouble floor_x = floor (in_x);
+    gdouble floor_y = floor (in_y);
+
+    /* only set the values if the values are valid */
+    if (floor_x < -1 || floor_x >= gt->width || floor_y < -1
+        || floor_y >= gt->height) {
+      *offset = -1;
+      weights[0] = weights[1] = 0;
+      return;
+    }
+
+    trunc_x = (gint) floor_x;
+    trunc_y = (gint) floor_y;
+    fx = (guint16) ((in_x - floor_x) * 256 + 0.5);
+    fy = (guint16) ((in_y - floor_y) * 256 + 0.5);
+
+    /* keep the neighbours inside the frame */
+    if (trunc_x < 0) {
+      trunc_x = 0;
+      fx = 0;
+    } else if (trunc_x >= gt->width - 1) {
+      if (gt->width > 1 && fx > 0) {
+        trunc_x = gt->width - 2;
+        fx = 256;
+      } else {
+        trunc_x = gt->width - 1;
+        fx = 0;
+      }
+    }
+    if (trunc_y < 0) {
+      trunc_y = 0;
+      fy = 0;
+    } else if (trunc_y >= gt->height - 1) {
+      if (gt->height > 1 && fy > 0) {
+        trunc_y = gt->height - 2;
+        fy = 256;
+      } else {
+        trunc_y = gt->height - 1;
+        fy = 0;
+      }
+    }
+
+    weights[0] = fx;
+    weights[1] = fy;
+  } else {
+    trunc_x = (gint) in_x;
+    trunc_y = (gint) in_y;
+
+    /* only set the values if the values are valid */
+    if (trunc_x < 0 || trunc_x >= gt->width || trunc_y < 0
+        || trunc_y >= gt->height) {
+      *offset = -1;
+      return;
+    }
+  }
+
+  *offset = trunc_y * gt->row_stride + trunc_x * gt->pixel_stride;
+}
+
 /* must be called with the object lock */
 static gboolean
 gst_geometric_transform_generate_map (GstGeometricTransform * gt)
@@ -84,13 +213,16 @@ gst_geometric_transform_generate_map (GstGeometricTransform * gt)
   gdouble in_x, in_y;
   gboolean ret = TRUE;
   GstGeometricTransformClass *klass;
-  gdouble *ptr;
+  gint32 *ptr;
+  guint16 *wptr = NULL;
 
   GST_INFO_OBJECT (gt, "Generating new transform map");
 
   /* cleanup old map */
   g_free (gt->map);
   gt->map = NULL;
+  g_free (gt->weights);
+  gt->weights = NULL;
 
   klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
 
@@ -98,10 +230,14 @@ gst_geometric_transform_generate_map (GstGeometricTransform * gt)
   g_return_val_if_fail (klass->map_func, FALSE);
 
   /*
-   * (x,y) pairs of the inverse mapping
+   * input offsets of the inverse mapping, plus the interpolation weights
    */
-  gt->map = g_malloc0 (sizeof (gdouble) * gt->width * gt->height * 2);
+  gt->map = g_malloc0 (sizeof (gint32) * gt->width * gt->height);
   ptr = gt->map;
+  if (gt->interpolation == GST_GT_INTERPOLATION_BILINEAR) {
+    gt->weights = g_malloc0 (sizeof (guint16) * gt->width * gt->height * 2);
+    wptr = gt->weights;
+  }
 
   for (y = 0; y < gt->height; y++) {
     for (x = 0; x < gt->width; x++) {
@@ -111,9 +247,10 @@ gst_geometric_transform_generate_map (GstGeometricTransform * gt)
         goto end;
       }
 
-      ptr[0] = in_x;
-      ptr[1] = in_y;
-      ptr += 2;
+      gst_geometric_transform_map_pixel (gt, in_x, in_y, ptr, wptr);
+      ptr++;
+      if (wptr)
+        wptr += 2;
     }
   }
 
@@ -122,6 +259,8 @@ end:
     GST_WARNING_OBJECT (gt, "Generating transform map failed");
     g_free (gt->map);
     gt->map = NULL;
+    g_free (gt->weights);
+    gt->weights = NULL;
   } else
     gt->needs_remap = FALSE;
   return ret;
@@ -135,6 +274,8 @@ gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
   gboolean ret = TRUE;
   gint old_width;
   gint old_height;
+  gint old_row_stride;
+  gint old_pixel_stride;
   GstGeometricTransformClass *klass;
 
   gt = GST_GEOMETRIC_TRANSFORM_CAST (vfilter);
@@ -142,16 +283,21 @@ gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
 
   old_width = gt->width;
   old_height = gt->height;
+  old_row_stride = gt->row_stride;
+  old_pixel_stride = gt->pixel_stride;
 
   gt->width = in_info->width;
   gt->height = in_info->height;
+  gt->format = GST_VIDEO_INFO_FORMAT (in_info);
   gt->row_stride = in_info->stride[0];
   gt->pixel_stride = GST_VIDEO_INFO_COMP_PSTRIDE (in_info, 0);
 
-  /* regenerate the map */
+  /* regenerate the map, it contains byte offsets */
   GST_OBJECT_LOCK (gt);
   if (gt->map == NULL || old_width == 0 || old_height == 0
-      || gt->width != old_width || gt->height != old_height) {
+      || gt->width != old_width || gt->height != old_height
+      || gt->row_stride != old_row_stride
+      || gt->pixel_stride != old_pixel_stride) {
     if (klass->prepare_func)
       if (!klass->prepare_func (gt)) {
         GST_OBJECT_UNLOCK (gt);
@@ -164,46 +310,129 @@ gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
   return ret;
 }
 
-static void
-gst_geometric_transform_do_map (GstGeometricTransform * gt, guint8 * in_data,
-    guint8 * out_data, gint x, gint y, gdouble in_x, gdouble in_y)
+static inline void
+gst_geometric_transform_do_map (GstGeometricTransform * gt,
+    const guint8 * in_data, guint8 * out_data, gint32 in_offset,
+    const guint16 * weights)
 {
-  gint in_offset;
-  gint out_offset;
+  const guint8 *p00, *p01, *p10, *p11;
+  guint fx, fy;
+  gint i;
 
-  out_offset = y * gt->row_stride + x * gt->pixel_stride;
+  if (in_offset < 0) {
+    memset (out_data, 0, gt->pixel_stride);
+    return;
+  }
 
-  /* operate on out of edge pixels */
-  switch (gt->off_edge_pixels) {
-    case GST_GT_OFF_EDGES_PIXELS_CLAMP:
-      in_x = CLAMP (in_x, 0, gt->width - 1);
-      in_y = CLAMP (in_y, 0, gt->height - 1);
-      break;
+  p00 = in_data + in_offset;
 
-    case GST_GT_OFF_EDGES_PIXELS_WRAP:
-      in_x = mod_float (in_x, gt->width);
-      in_y = mod_float (in_y, gt->height);
-      if (in_x < 0)
-        in_x += gt->width;
-      if (in_y < 0)
-        in_y += gt->height;
-      break;
+  if (!weights || (weights[0] == 0 && weights[1] == 0)) {
+    memcpy (out_data, p00, gt->pixel_stride);
+    return;
+  }
 
-    default:
+  fx = weights[0];
+  fy = weights[1];
+  p01 = fx ? p00 + gt->pixel_stride : p00;
+  p10 = fy ? p00 + gt->row_stride : p00;
+  p11 = fx ? p10 + gt->pixel_stride : p10;
+
+  switch (gt->format) {
+    case GST_VIDEO_FORMAT_GRAY16_LE:{
+      guint64 v;
+
+      v = (guint64) GST_READ_UINT16_LE (p00) * (256 - fx) * (256 - fy) +
+          (guint64) GST_READ_UINT16_LE (p01) * fx * (256 - fy) +
+          (guint64) GST_READ_UINT16_LE (p10) * (256 - fx) * fy +
+          (guint64) GST_READ_UINT16_LE (p11) * fx * fy;
+      GST_WRITE_UINT16_LE (out_data, (v + 32768) >> 16);
+      break;
+    }
+    case GST_VIDEO_FORMAT_GRAY16_BE:{
+      guint64 v;
+
+      v = (guint64) GST_READ_UINT16_BE (p00) * (256 - fx) * (256 - fy) +
+          (guint64) GST_READ_UINT16_BE (p01) * fx * (256 - fy) +
+          (guint64) GST_READ_UINT16_BE (p10) * (256 - fx) * fy +
+          (guint64) GST_READ_UINT16_BE (p11) * fx * fy;
+      GST_WRITE_UINT16_BE (out_data, (v + 32768) >> 16);
+      break;
+    }
+    default:{
+      guint w00 = (256 - fx) * (256 - fy);
+      guint w01 = fx * (256 - fy);
+      guint w10 = (256 - fx) * fy;
+      guint w11 = fx * fy;
+
+      for (i = 0; i < gt->pixel_stride; i++)
+        out_data[i] = (p00[i] * w00 + p01[i] * w01 + p10[i] * w10 +
+            p11[i] * w11 + 32768) >> 16;
       break;
+    }
   }
+}
 
-  {
-    gint trunc_x = (gint) in_x;
-    gint trunc_y = (gint) in_y;
-    /* only set the values if the values are valid */
-    if (trunc_x >= 0 && trunc_x < gt->width && trunc_y >= 0 &&
-        trunc_y < gt->height) {
-      in_offset = trunc_y * gt->row_stride + trunc_x * gt->pixel_stride;
+static void
+gst_geometric_transform_remap_band (GstGeometricTransform * gt,
+    const guint8 * in_data, guint8 * out_data, gint y_start, gint y_end)
+{
+  const gint32 *ptr = gt->map + y_start * gt->width;
+  const guint16 *wptr = gt->weights ? gt->weights + y_start * gt->width * 2 :
+      NULL;
+  gint x, y;
+
+  for (y = y_start; y < y_end; y++) {
+    guint8 *out = out_data + y * gt->row_stride;
 
-      memcpy (out_data + out_offset, in_data + in_offset, gt->pixel_stride);
+    for (x = 0; x < gt->width; x++) {
+      gst_geometric_transform_do_map (gt, in_data, out, *ptr, wptr);
+      out += gt->pixel_stride;
+      ptr++;
+      if (wptr)
+        wptr += 2;
     }
+    /* row padding */
+    memset (out, 0, gt->row_stride - gt->width * gt->pixel_stride);
+  }
+}
+
+static void
+gst_geometric_transform_band_func (gpointer data, gpointer user_data)
+{
+  GstGeometricTransformBand *band = data;
+  GstGeometricTransform *gt = user_data;
+
+  gst_geometric_transform_remap_band (gt, band->in_data, band->out_data,
+      band->y_start, band->y_end);
+}
+
+/* must be called with the object lock */
+static void
+gst_geometric_transform_remap (GstGeometricTransform * gt,
+    const guint8 * in_data, guint8 * out_data)
+{
+  GstGeometricTransformBand *bands;
+  guint n_bands, i;
+
+  n_bands = gst_band_pool_get_n_bands (gt->n_threads, gt->height,
+      MIN_BAND_HEIGHT);
+
+  if (n_bands == 1) {
+    gst_geometric_transform_remap_band (gt, in_data, out_data, 0, gt->height);
+    return;
   }
+
+  bands = g_newa (GstGeometricTransformBand, n_bands);
+  for (i = 0; i < n_bands; i++) {
+    bands[i].in_data = in_data;
+    bands[i].out_data = out_data;
+    bands[i].y_start = gt->height * i / n_bands;
+    bands[i].y_end = gt->height * (i + 1) / n_bands;
+  }
+
+  gst_band_pool_run (gst_band_pool_get_default (),
+      gst_geometric_transform_band_func, gt, bands,
+      sizeof (GstGeometricTransformBand), n_bands);
 }
 
 static void
@@ -231,7 +460,6 @@ gst_geometric_transform_transform_frame (GstVideoFilter * vfilter,
   GstGeometricTransformClass *klass;
   gint x, y;
   GstFlowReturn ret = GST_FLOW_OK;
-  gdouble *ptr;
   guint8 *in_data;
   guint8 *out_data;
 
@@ -240,7 +468,6 @@ gst_geometric_transform_transform_frame (GstVideoFilter * vfilter,
 
   in_data = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0);
   out_data = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
-  memset (out_data, 0, out_frame->map[0].size);
 
   GST_OBJECT_LOCK (gt);
   if (gt->precalc_map) {
@@ -252,24 +479,31 @@ gst_geometric_transform_transform_frame (GstVideoFilter * vfilter,
         }
       gst_geometric_transform_generate_map (gt);
     }
-    g_return_val_if_fail (gt->map, GST_FLOW_ERROR);
-    ptr = gt->map;
-    for (y = 0; y < gt->height; y++) {
-      for (x = 0; x < gt->width; x++) {
-        /* do the mapping */
-        gst_geometric_transform_do_map (gt, in_data, out_data, x, y, ptr[0],
-            ptr[1]);
-        ptr += 2;
-      }
+    if (gt->map == NULL) {
+      ret = GST_FLOW_ERROR;
+      goto end;
     }
+    gst_geometric_transform_remap (gt, in_data, out_data);
   } else {
+    gboolean bilinear = gt->interpolation == GST_GT_INTERPOLATION_BILINEAR;
+
+    /* clears the row padding, and the pixels after a failed mapping */
+    memset (out_data, 0, out_frame->map[0].size);
+
     for (y = 0; y < gt->height; y++) {
+      guint8 *out = out_data + y * gt->row_stride;
+
       for (x = 0; x < gt->width; x++) {
         gdouble in_x, in_y;
+        gint32 in_offset;
+        guint16 weights[2];
 
         if (klass->map_func (gt, x, y, &in_x, &in_y)) {
-          gst_geometric_transform_do_map (gt, in_data, out_data, x, y, in_x,
-              in_y);
+          gst_geometric_transform_map_pixel (gt, in_x, in_y, &in_offset,
+              bilinear ? weights : NULL);
+          gst_geometric_transform_do_map (gt, in_data, out, in_offset,
+              bilinear ? weights : NULL);
+          out += gt->pixel_stride;
         } else {
           GST_WARNING_OBJECT (gt, "Failed to do mapping for %d %d", x, y);
           ret = GST_FLOW_ERROR;
@@ -292,9 +526,32 @@ gst_geometric_transform_set_property (GObject * object, guint prop_id,
   gt = GST_GEOMETRIC_TRANSFORM_CAST (object);
 
   switch (prop_id) {
-    case PROP_OFF_EDGE_PIXELS:
+    case PROP_OFF_EDGE_PIXELS:{
+      gint off_edge_pixels = g_value_get_enum (value);
+
+      /* the off edge handling is part of the precalculated map */
+      GST_OBJECT_LOCK (gt);
+      if (off_edge_pixels != gt->off_edge_pixels) {
+        gt->off_edge_pixels = off_edge_pixels;
+        gst_geometric_transform_set_need_remap (gt);
+      }
+      GST_OBJECT_UNLOCK (gt);
+      break;
+    }
+    case PROP_INTERPOLATION:{
+      gint interpolation = g_value_get_enum (value);
+
+      GST_OBJECT_LOCK (gt);
+      if (interpolation != gt->interpolation) {
+        gt->interpolation = interpolation;
+        gst_geometric_transform_set_need_remap (gt);
+      }
+      GST_OBJECT_UNLOCK (gt);
+      break;
+    }
+    case PROP_N_THREADS:
       GST_OBJECT_LOCK (gt);
-      gt->off_edge_pixels = g_value_get_enum (value);
+      gt->n_threads = g_value_get_uint (value);
       GST_OBJECT_UNLOCK (gt);
       break;
     default:
@@ -315,6 +572,12 @@ gst_geometric_transform_get_property (GObject * object, guint prop_id,
     case PROP_OFF_EDGE_PIXELS:
       g_value_set_enum (value, gt->off_edge_pixels);
       break;
+    case PROP_INTERPOLATION:
+      g_value_set_enum (value, gt->interpolation);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, gt->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -334,6 +597,8 @@ gst_geometric_transform_stop (GstBaseTransform * trans)
 
   g_free (gt->map);
   gt->map = NULL;
+  g_free (gt->weights);
+  gt->weights = NULL;
 
   return TRUE;
 }
@@ -381,6 +646,16 @@ gst_geometric_transform_class_init (gpointer klass, gpointer class_data)
           "What to do with off edge pixels",
           GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE, DEFAULT_OFF_EDGE_PIXELS,
           GST_PARAM_CONTROLLABLE | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (obj_class, PROP_INTERPOLATION,
+      g_param_spec_enum ("interpolation", "Interpolation",
+          "How to sample the input pixels",
+          GST_GT_INTERPOLATION_METHOD_TYPE, DEFAULT_INTERPOLATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (obj_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of horizontal bands transformed in parallel "
+          "(0 = number of processors)", 0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -389,6 +664,8 @@ gst_geometric_transform_init (GTypeInstance * instance, gpointer g_class)
   GstGeometricTransform *gt = GST_GEOMETRIC_TRANSFORM_CAST (instance);
 
   gt->off_edge_pixels = DEFAULT_OFF_EDGE_PIXELS;
+  gt->interpolation = DEFAULT_INTERPOLATION;
+  gt->n_threads = DEFAULT_N_THREADS;
   gt->precalc_map = TRUE;
   gt->needs_remap = TRUE;
 }
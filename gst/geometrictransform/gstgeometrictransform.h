@@ -46,6 +46,12 @@ enum
   GST_GT_OFF_EDGES_PIXELS_WRAP
 };
 
+enum
+{
+  GST_GT_INTERPOLATION_NEAREST = 0,
+  GST_GT_INTERPOLATION_BILINEAR
+};
+
 typedef struct _GstGeometricTransform GstGeometricTransform;
 typedef struct _GstGeometricTransformClass GstGeometricTransformClass;
 
@@ -99,8 +105,14 @@ struct _GstGeometricTransform {
 
   /* properties */
   gint off_edge_pixels;
-
-  gdouble *map;
+  gint interpolation;
+  guint n_threads;
+
+  /* byte offset of the (top left) input pixel for each output pixel,
+   * -1 for off edge pixels that are ignored */
+  gint32 *map;
+  /* bilinear only: weights of the right and bottom neighbours in 1/256 */
+  guint16 *weights;
 };
 
 struct _GstGeometricTransformClass {
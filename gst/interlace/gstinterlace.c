@@ -50,6 +50,12 @@
  * 30000/1001 2:3:2:3... pattern telecined stream suitable for displaying film
  * content on NTSC.
  * </refsect2>
+ *
+ * Output frames are built with as little copying as possible: frames whose
+ * two fields come from the same input frame are pushed without touching the
+ * picture data, and frames mixing two input frames are woven in a single
+ * pass, in place into the older input frame when nothing else references it
+ * and into a buffer from the downstream buffer pool otherwise.
  */
 
 
@@ -97,8 +103,11 @@ struct _GstInterlace
   int src_fps_n;
   int src_fps_d;
 
+  GstBufferPool *pool;
+
   GstBuffer *stored_frame;
   gint stored_fields;
+  gboolean stored_frame_shared; /* stored_frame memory was also pushed */
   gint phase_index;
   int field_index;              /* index of the next field to push, 0=top 1=bottom */
   GstClockTime timebase;
@@ -126,7 +135,11 @@ typedef enum
   GST_INTERLACE_PATTERN_2_2,
   GST_INTERLACE_PATTERN_2_3,
   GST_INTERLACE_PATTERN_2_3_3_2,
-  GST_INTERLACE_PATTERN_EURO
+  GST_INTERLACE_PATTERN_EURO,
+  GST_INTERLACE_PATTERN_2_2_2_4,
+  GST_INTERLACE_PATTERN_2_2_3_2_3,
+  GST_INTERLACE_PATTERN_3_3_4,
+  GST_INTERLACE_PATTERN_3_3
 } GstInterlacePattern;
 
 #define GST_INTERLACE_PATTERN (gst_interlace_pattern_get_type ())
@@ -140,6 +153,10 @@ gst_interlace_pattern_get_type (void)
     {GST_INTERLACE_PATTERN_2_3, "2:3", "2:3"},
     {GST_INTERLACE_PATTERN_2_3_3_2, "2:3:3:2", "2:3:3:2"},
     {GST_INTERLACE_PATTERN_EURO, "Euro 2-11:3", "2-11:3"},
+    {GST_INTERLACE_PATTERN_2_2_2_4, "2:2:2:4", "2:2:2:4"},
+    {GST_INTERLACE_PATTERN_2_2_3_2_3, "2:2:3:2:3", "2:2:3:2:3"},
+    {GST_INTERLACE_PATTERN_3_3_4, "3:3:4", "3:3:4"},
+    {GST_INTERLACE_PATTERN_3_3, "3:3", "3:3"},
     {0, NULL, NULL}
   };
 
@@ -239,9 +256,23 @@ gst_interlace_class_init (GstInterlaceClass * klass)
   element_class->change_state = gst_interlace_change_state;
 }
 
+static void
+gst_interlace_set_pool (GstInterlace * interlace, GstBufferPool * pool)
+{
+  if (interlace->pool) {
+    gst_buffer_pool_set_active (interlace->pool, FALSE);
+    gst_object_unref (interlace->pool);
+  }
+  interlace->pool = pool;
+}
+
 static void
 gst_interlace_finalize (GObject * obj)
 {
+  GstInterlace *interlace = GST_INTERLACE (obj);
+
+  gst_interlace_set_pool (interlace, NULL);
+
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
 
@@ -299,13 +330,27 @@ static const PulldownFormat formats[] = {
   {"2:3", 5, 4, {2, 3,}},
   {"2:3:3:2", 5, 4, {2, 3, 3, 2,}},
   /* 24p -> 50i Euro pulldown */
-  {"2-11:3", 25, 24, {2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3,}}
+  {"2-11:3", 25, 24, {2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3,}},
+  /* 24p -> 60i with whole-frame cadence (DVCPRO HD 24pN) */
+  {"2:2:2:4", 5, 4, {2, 2, 2, 4,}},
+  /* 25p -> 60i */
+  {"2:2:3:2:3", 6, 5, {2, 2, 3, 2, 3,}},
+  /* 18p -> 60i silent film */
+  {"3:3:4", 5, 3, {3, 3, 4,}},
+  /* 20p -> 60i */
+  {"3:3", 3, 2, {3, 3,}}
 };
 
 static void
 gst_interlace_decorate_buffer (GstInterlace * interlace, GstBuffer * buf,
     int n_fields, gboolean interlaced)
 {
+  /* the field flags are set from the pattern below, not kept from the
+   * frame the buffer was made from */
+  GST_BUFFER_FLAG_UNSET (buf, GST_VIDEO_BUFFER_FLAG_TFF |
+      GST_VIDEO_BUFFER_FLAG_RFF | GST_VIDEO_BUFFER_FLAG_ONEFIELD |
+      GST_VIDEO_BUFFER_FLAG_INTERLACED);
+
   /* field duration = src_fps_d / (2 * src_fps_n) */
   if (interlace->src_fps_n == 0) {
     /* If we don't know the fps, we can't generate timestamps/durations */
@@ -336,6 +381,62 @@ gst_interlace_decorate_buffer (GstInterlace * interlace, GstBuffer * buf,
   }
 }
 
+/* woven frames go into buffers from a pool so that their memory is
+ * recycled instead of allocated for every frame */
+static void
+gst_interlace_decide_allocation (GstInterlace * interlace, GstCaps * caps)
+{
+  GstQuery *query;
+  GstBufferPool *pool;
+  GstStructure *config;
+  guint size, min, max;
+
+  query = gst_query_new_allocation (caps, TRUE);
+
+  if (!gst_pad_peer_query (interlace->srcpad, query)) {
+    /* not a problem, we use the query defaults */
+    GST_DEBUG_OBJECT (interlace, "allocation query failed");
+  }
+
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    /* we got configuration from our peer, parse them */
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    size = MAX (size, interlace->info.size);
+  } else {
+    pool = NULL;
+    size = interlace->info.size;
+    min = max = 0;
+  }
+  gst_query_unref (query);
+
+  if (pool == NULL) {
+    /* we did not get a pool, make one ourselves then */
+    pool = gst_buffer_pool_new ();
+  }
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size, min, max);
+  if (!gst_buffer_pool_set_config (pool, config)
+      || !gst_buffer_pool_set_active (pool, TRUE)) {
+    GST_WARNING_OBJECT (interlace, "failed to configure buffer pool");
+    gst_object_unref (pool);
+    pool = NULL;
+  }
+
+  gst_interlace_set_pool (interlace, pool);
+}
+
+static GstFlowReturn
+gst_interlace_alloc_buffer (GstInterlace * interlace, GstBuffer ** buffer)
+{
+  if (interlace->pool)
+    return gst_buffer_pool_acquire_buffer (interlace->pool, buffer, NULL);
+
+  *buffer = gst_buffer_new_and_alloc (interlace->info.size);
+
+  return GST_FLOW_OK;
+}
+
 static gboolean
 gst_interlace_setcaps (GstInterlace * interlace, GstCaps * caps)
 {
@@ -366,10 +467,13 @@ gst_interlace_setcaps (GstInterlace * interlace, GstCaps * caps)
       interlace->src_fps_n, interlace->src_fps_d, NULL);
 
   ret = gst_pad_set_caps (interlace->srcpad, othercaps);
-  gst_caps_unref (othercaps);
 
   interlace->info = info;
 
+  if (ret)
+    gst_interlace_decide_allocation (interlace, othercaps);
+  gst_caps_unref (othercaps);
+
   return ret;
 
 caps_error:
@@ -554,20 +658,30 @@ gst_interlace_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
   return ret;
 }
 
-static void
-copy_field (GstInterlace * interlace, GstBuffer * dest, GstBuffer * src,
-    int field_index)
+/* Weaves the lines of field @field_index of @first and the lines of the
+ * opposite field of @second into @dest, mapping every buffer once. A source
+ * that is @dest itself already has its lines in place and is skipped. */
+static gboolean
+gst_interlace_weave (GstInterlace * interlace, GstBuffer * dest,
+    GstBuffer * first, GstBuffer * second, int field_index)
 {
   GstVideoInfo *info = &interlace->info;
-  gint i, j, n_planes;
+  GstBuffer *src[2];
+  gint i, j, k, n_planes;
   guint8 *d, *s;
-  GstVideoFrame dframe, sframe;
+  GstVideoFrame dframe, sframe[2];
+
+  src[0] = first;
+  src[1] = second;
 
   if (!gst_video_frame_map (&dframe, info, dest, GST_MAP_WRITE))
     goto dest_map_failed;
 
-  if (!gst_video_frame_map (&sframe, info, src, GST_MAP_READ))
-    goto src_map_failed;
+  for (k = 0; k < 2; k++) {
+    if (src[k] != dest
+        && !gst_video_frame_map (&sframe[k], info, src[k], GST_MAP_READ))
+      goto src_map_failed;
+  }
 
   n_planes = GST_VIDEO_FRAME_N_PLANES (&dframe);
 
@@ -575,39 +689,54 @@ copy_field (GstInterlace * interlace, GstBuffer * dest, GstBuffer * src,
     gint cheight, cwidth;
     gint ss, ds;
 
-    d = GST_VIDEO_FRAME_PLANE_DATA (&dframe, i);
-    s = GST_VIDEO_FRAME_PLANE_DATA (&sframe, i);
-
+    cheight = GST_VIDEO_FRAME_COMP_HEIGHT (&dframe, i);
     ds = GST_VIDEO_FRAME_PLANE_STRIDE (&dframe, i);
-    ss = GST_VIDEO_FRAME_PLANE_STRIDE (&sframe, i);
 
-    d += field_index * ds;
-    s += field_index * ss;
+    for (k = 0; k < 2; k++) {
+      /* the first source gives the lines of field_index, the second the
+       * lines of the other field */
+      gint line = field_index ^ k;
 
-    cheight = GST_VIDEO_FRAME_COMP_HEIGHT (&dframe, i);
-    cwidth = MIN (ABS (ss), ABS (ds));
+      if (src[k] == dest)
+        continue;
+
+      d = GST_VIDEO_FRAME_PLANE_DATA (&dframe, i);
+      s = GST_VIDEO_FRAME_PLANE_DATA (&sframe[k], i);
+      ss = GST_VIDEO_FRAME_PLANE_STRIDE (&sframe[k], i);
 
-    for (j = field_index; j < cheight; j += 2) {
-      memcpy (d, s, cwidth);
-      d += ds * 2;
-      s += ss * 2;
+      d += line * ds;
+      s += line * ss;
+      cwidth = MIN (ABS (ss), ABS (ds));
+
+      for (j = line; j < cheight; j += 2) {
+        memcpy (d, s, cwidth);
+        d += ds * 2;
+        s += ss * 2;
+      }
     }
   }
 
+  for (k = 0; k < 2; k++) {
+    if (src[k] != dest)
+      gst_video_frame_unmap (&sframe[k]);
+  }
   gst_video_frame_unmap (&dframe);
-  gst_video_frame_unmap (&sframe);
-  return;
+  return TRUE;
 
 dest_map_failed:
   {
     GST_ERROR_OBJECT (interlace, "failed to map dest");
-    return;
+    return FALSE;
   }
 src_map_failed:
   {
     GST_ERROR_OBJECT (interlace, "failed to map src");
+    while (k-- > 0) {
+      if (src[k] != dest)
+        gst_video_frame_unmap (&sframe[k]);
+    }
     gst_video_frame_unmap (&dframe);
-    return;
+    return FALSE;
   }
 }
 
@@ -619,6 +748,7 @@ gst_interlace_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GstFlowReturn ret = GST_FLOW_OK;
   gint num_fields = 0;
   int current_fields;
+  gboolean current_shared = FALSE;
   const PulldownFormat *format;
 
   GST_DEBUG ("Received buffer at %u:%02u:%02u:%09u",
@@ -643,6 +773,7 @@ gst_interlace_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     }
     interlace->stored_frame = NULL;
     interlace->stored_fields = 0;
+    interlace->stored_frame_shared = FALSE;
 
     if (interlace->top_field_first) {
       interlace->field_index = 0;
@@ -676,7 +807,7 @@ gst_interlace_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
   num_fields = interlace->stored_fields + current_fields;
   while (num_fields >= 2) {
-    GstBuffer *output_buffer;
+    GstBuffer *output_buffer, *stored_frame;
     int n_output_fields;
     gboolean interlaced = FALSE;
 
@@ -686,18 +817,42 @@ gst_interlace_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     if (interlace->stored_fields > 0) {
       GST_DEBUG ("1 field from stored, 1 from current");
 
-      output_buffer = gst_buffer_new_and_alloc (gst_buffer_get_size (buffer));
-      /* take the first field from the stored frame */
-      copy_field (interlace, output_buffer, interlace->stored_frame,
-          interlace->field_index);
+      stored_frame = interlace->stored_frame;
+      if (!interlace->stored_frame_shared
+          && gst_buffer_is_writable (stored_frame)) {
+        /* this is the last field of the stored frame, so nobody needs the
+         * stored frame after this and the field of the incoming buffer can
+         * be woven straight into it */
+        GST_LOG_OBJECT (interlace, "weaving in place");
+        output_buffer = stored_frame;
+        interlace->stored_frame = NULL;
+        /* the woven frame does not continue a discontinuity of the stored
+         * frame */
+        GST_BUFFER_FLAG_UNSET (output_buffer, GST_BUFFER_FLAG_DISCONT);
+      } else {
+        ret = gst_interlace_alloc_buffer (interlace, &output_buffer);
+        if (ret != GST_FLOW_OK) {
+          GST_DEBUG_OBJECT (interlace, "failed to allocate buffer");
+          break;
+        }
+      }
+      /* take the first field from the stored frame and the second field
+       * from the incoming buffer */
+      if (!gst_interlace_weave (interlace, output_buffer, stored_frame, buffer,
+              interlace->field_index)) {
+        gst_buffer_unref (output_buffer);
+        ret = GST_FLOW_ERROR;
+        break;
+      }
       interlace->stored_fields--;
-      /* take the second field from the incoming buffer */
-      copy_field (interlace, output_buffer, buffer, interlace->field_index ^ 1);
       current_fields--;
       n_output_fields = 2;
       interlaced = TRUE;
     } else {
+      /* the picture data is shared with the pushed buffer, only the
+       * metadata gets copied */
       output_buffer = gst_buffer_make_writable (gst_buffer_ref (buffer));
+      current_shared = TRUE;
       if (num_fields >= 3 && interlace->allow_rff) {
         GST_DEBUG ("3 fields from current");
         /* take both fields from incoming buffer */
@@ -747,6 +902,7 @@ gst_interlace_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   if (current_fields > 0) {
     interlace->stored_frame = buffer;
     interlace->stored_fields = current_fields;
+    interlace->stored_frame_shared = current_shared;
   } else {
     gst_buffer_unref (buffer);
   }
@@ -806,17 +962,21 @@ gst_interlace_get_property (GObject * object,
 static GstStateChangeReturn
 gst_interlace_change_state (GstElement * element, GstStateChange transition)
 {
-  //GstInterlace *interlace = GST_INTERLACE (element);
+  GstInterlace *interlace = GST_INTERLACE (element);
+  GstStateChangeReturn ret;
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       //gst_interlace_reset (interlace);
+      gst_interlace_set_pool (interlace, NULL);
       break;
     default:
       break;
   }
 
-  return GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+  return ret;
 }
 
 static gboolean
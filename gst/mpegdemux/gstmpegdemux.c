@@ -66,6 +66,9 @@
 
 #define DURATION_SCAN_LIMIT         4 * 1024 * 1024
 
+/* maximum number of payloads collected per stream before pushing them */
+#define MAX_PENDING_BUFFERS         64
+
 typedef enum
 {
   SCAN_SCR,
@@ -272,6 +275,7 @@ gst_flups_demux_init (GstFluPSDemux * demux)
       g_malloc0 (sizeof (GstFluPSStream *) * (GST_FLUPS_DEMUX_MAX_STREAMS));
   demux->found_count = 0;
 
+  demux->scr_index = g_array_new (FALSE, FALSE, sizeof (GstFluPSIndexEntry));
 }
 
 static void
@@ -280,6 +284,7 @@ gst_flups_demux_finalize (GstFluPSDemux * demux)
   gst_flups_demux_reset (demux);
   g_free (demux->streams);
   g_free (demux->streams_found);
+  g_array_free (demux->scr_index, TRUE);
 
   G_OBJECT_CLASS (parent_class)->finalize (G_OBJECT (demux));
 }
@@ -298,6 +303,8 @@ gst_flups_demux_reset (GstFluPSDemux * demux)
       if (stream->pad)
         gst_element_remove_pad (GST_ELEMENT_CAST (demux), stream->pad);
 
+      if (stream->pending)
+        gst_buffer_list_unref (stream->pending);
       g_free (stream);
       demux->streams[i] = NULL;
     }
@@ -471,6 +478,73 @@ unknown_stream:
   }
 }
 
+/* Push the payloads collected for @stream downstream as one buffer list */
+static GstFlowReturn
+gst_flups_demux_push_pending (GstFluPSDemux * demux, GstFluPSStream * stream)
+{
+  GstBufferList *list = stream->pending;
+  GstFlowReturn result;
+
+  if (list == NULL)
+    return GST_FLOW_OK;
+
+  stream->pending = NULL;
+
+  GST_LOG_OBJECT (demux, "pushing %u buffers on stream id 0x%02x",
+      gst_buffer_list_length (list), stream->id);
+
+  result = gst_pad_push_list (stream->pad, list);
+  GST_DEBUG_OBJECT (demux, "pushed list on stream id 0x%02x type 0x%02x, "
+      "result: %s", stream->id, stream->type, gst_flow_get_name (result));
+
+  if (result == GST_FLOW_NOT_LINKED) {
+    stream->notlinked = TRUE;
+    result = GST_FLOW_OK;
+  }
+
+  return result;
+}
+
+static GstFlowReturn
+gst_flups_demux_push_all_pending (GstFluPSDemux * demux)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  gint i, count = demux->found_count;
+
+  for (i = 0; i < count; i++) {
+    GstFluPSStream *stream = demux->streams_found[i];
+    GstFlowReturn res;
+
+    if (G_UNLIKELY (stream == NULL))
+      continue;
+
+    /* keep pushing the other streams, report the first error */
+    res = gst_flups_demux_push_pending (demux, stream);
+    if (ret == GST_FLOW_OK)
+      ret = res;
+  }
+
+  return ret;
+}
+
+static void
+gst_flups_demux_clear_pending (GstFluPSDemux * demux)
+{
+  gint i, count = demux->found_count;
+
+  for (i = 0; i < count; i++) {
+    GstFluPSStream *stream = demux->streams_found[i];
+
+    if (stream && stream->pending) {
+      gst_buffer_list_unref (stream->pending);
+      stream->pending = NULL;
+    }
+  }
+}
+
+/* Queue @buf on @stream, the collected payloads are pushed when the
+ * current input buffer is consumed, before serialized events, or when
+ * MAX_PENDING_BUFFERS is reached */
 static GstFlowReturn
 gst_flups_demux_send_data (GstFluPSDemux * demux, GstFluPSStream * stream,
     GstBuffer * buf)
@@ -541,6 +615,12 @@ gst_flups_demux_send_data (GstFluPSDemux * demux, GstFluPSStream * stream,
     segment.time = time;
     newsegment = gst_event_new_segment (&segment);
 
+    result = gst_flups_demux_push_pending (demux, stream);
+    if (G_UNLIKELY (result != GST_FLOW_OK)) {
+      gst_event_unref (newsegment);
+      gst_buffer_unref (buf);
+      return result;
+    }
     gst_pad_push_event (stream->pad, newsegment);
 
     stream->need_segment = FALSE;
@@ -584,11 +664,16 @@ gst_flups_demux_send_data (GstFluPSDemux * demux, GstFluPSStream * stream,
   demux->next_pts = G_MAXUINT64;
   demux->next_dts = G_MAXUINT64;
 
-  result = gst_pad_push (stream->pad, buf);
-  GST_DEBUG_OBJECT (demux, "pushed stream id 0x%02x type 0x%02x, time: %"
-      GST_TIME_FORMAT ", size %d. result: %s",
-      stream->id, stream->type, GST_TIME_ARGS (timestamp),
-      size, gst_flow_get_name (result));
+  if (stream->pending == NULL)
+    stream->pending = gst_buffer_list_new_sized (MAX_PENDING_BUFFERS);
+  gst_buffer_list_add (stream->pending, buf);
+  GST_LOG_OBJECT (demux, "queued on stream id 0x%02x type 0x%02x, time: %"
+      GST_TIME_FORMAT ", size %d", stream->id, stream->type,
+      GST_TIME_ARGS (timestamp), size);
+
+  result = GST_FLOW_OK;
+  if (gst_buffer_list_length (stream->pending) >= MAX_PENDING_BUFFERS)
+    result = gst_flups_demux_push_pending (demux, stream);
 
   return result;
 
@@ -630,6 +715,11 @@ gst_flups_demux_send_event (GstFluPSDemux * demux, GstEvent * event)
     GstFluPSStream *stream = demux->streams_found[i];
 
     if (stream && !stream->notlinked) {
+      /* out of band events can come from other threads, the pending
+       * payloads are dropped when flushing anyway */
+      if (GST_EVENT_IS_SERIALIZED (event))
+        gst_flups_demux_push_pending (demux, stream);
+
       (void) gst_event_ref (event);
 
       if (!gst_pad_push_event (stream->pad, event)) {
@@ -744,6 +834,7 @@ gst_flups_demux_flush (GstFluPSDemux * demux)
   gst_adapter_clear (demux->adapter);
   gst_adapter_clear (demux->rev_adapter);
   gst_pes_filter_drain (&demux->filter);
+  gst_flups_demux_clear_pending (demux);
   gst_flups_demux_clear_times (demux);
   demux->adapter_offset = G_MAXUINT64;
   demux->current_scr = G_MAXUINT64;
@@ -815,6 +906,7 @@ gst_flups_demux_send_segment_updates (GstFluPSDemux * demux,
           segment.time = time;
           event = gst_event_new_segment (&segment);
         }
+        gst_flups_demux_push_pending (demux, stream);
         gst_event_ref (event);
         gst_pad_push_event (stream->pad, event);
         stream->last_seg_start = stream->last_ts = new_start;
@@ -872,6 +964,7 @@ gst_flups_demux_close_segment (GstFluPSDemux * demux)
       GstFluPSStream *stream = demux->streams_found[i];
 
       if (stream && !stream->notlinked && !stream->need_segment) {
+        gst_flups_demux_push_pending (demux, stream);
         (void) gst_event_ref (event);
 
         if (!gst_pad_push_event (stream->pad, event)) {
@@ -1044,6 +1137,19 @@ not_supported:
   }
 }
 
+/* Remember that the pack starting at @offset carries @scr. Entries are only
+ * added in pull mode, where offsets are absolute. */
+static void
+gst_flups_demux_index_add (GstFluPSDemux * demux, guint64 scr, guint64 offset)
+{
+  if (!demux->random_access)
+    return;
+
+  if (gst_flups_index_add (demux->scr_index, scr, offset))
+    GST_LOG_OBJECT (demux, "added index entry, SCR %" G_GUINT64_FORMAT
+        " at offset %" G_GUINT64_FORMAT, scr, offset);
+}
+
 #define MAX_RECURSION_COUNT 100
 
 /* Binary search for requested SCR */
@@ -1052,8 +1158,8 @@ find_offset (GstFluPSDemux * demux, guint64 scr,
     guint64 min_scr, guint64 min_scr_offset,
     guint64 max_scr, guint64 max_scr_offset, int recursion_count)
 {
-  guint64 scr_rate_n = max_scr_offset - min_scr_offset;
-  guint64 scr_rate_d = max_scr - min_scr;
+  guint64 scr_rate_n;
+  guint64 scr_rate_d;
   guint64 fscr = scr;
   gboolean found;
   guint64 offset;
@@ -1062,6 +1168,18 @@ find_offset (GstFluPSDemux * demux, guint64 scr,
     return -1;
   }
 
+  /* narrow the search interval with what we already know about the file,
+   * when that is close enough start from the pack before the requested SCR */
+  if (gst_flups_index_lookup (demux->scr_index, scr, &min_scr,
+          &min_scr_offset, &max_scr, &max_scr_offset)) {
+    GST_DEBUG_OBJECT (demux, "SCR %" G_GUINT64_FORMAT " resolved from index"
+        " at offset %" G_GUINT64_FORMAT, scr, min_scr_offset);
+    return min_scr_offset;
+  }
+
+  scr_rate_n = max_scr_offset - min_scr_offset;
+  scr_rate_d = max_scr - min_scr;
+
   offset = min_scr_offset +
       MIN (gst_util_uint64_scale (scr - min_scr, scr_rate_n,
           scr_rate_d), demux->sink_segment.stop);
@@ -1073,6 +1191,9 @@ find_offset (GstFluPSDemux * demux, guint64 scr,
         gst_flups_demux_scan_backward_ts (demux, &offset, SCAN_SCR, &fscr, 0);
   }
 
+  if (found)
+    gst_flups_demux_index_add (demux, fscr, offset);
+
   if (fscr == scr || fscr == min_scr || fscr == max_scr) {
     return offset;
   }
@@ -1646,6 +1767,10 @@ gst_flups_demux_parse_pack_start (GstFluPSDemux * demux)
       scr, scr_adjusted, new_rate,
       GST_TIME_ARGS (MPEGTIME_TO_GSTTIME ((guint64) scr)));
 
+  /* remember where this SCR lives for later seeks, adapter_offset still
+   * points to the pack start code here */
+  gst_flups_demux_index_add (demux, scr, demux->adapter_offset);
+
   /* keep the first src in order to calculate delta time */
   if (G_UNLIKELY (demux->first_scr == G_MAXUINT64)) {
     demux->first_scr = scr;
@@ -2173,8 +2298,25 @@ gst_flups_demux_data_cb (GstPESFilter * filter, gboolean first,
   }
 
   if (demux->current_stream->notlinked == FALSE) {
-    out_buf =
-        gst_buffer_copy_region (buffer, GST_BUFFER_COPY_ALL, offset, datalen);
+    gst_buffer_unmap (buffer, &map);
+
+    /* the payload is a sub-buffer of the input, only wrap it again when
+     * private stream headers have to be stripped */
+    if (offset == 0) {
+      /* the sub-buffer carries the flags and times of the input, only the
+       * DISCONT flag and the timestamp set by send_data belong on the pad */
+      out_buf = gst_buffer_make_writable (buffer);
+      GST_BUFFER_FLAGS (out_buf) = 0;
+      GST_BUFFER_DTS (out_buf) = GST_CLOCK_TIME_NONE;
+      GST_BUFFER_DURATION (out_buf) = GST_CLOCK_TIME_NONE;
+      GST_BUFFER_OFFSET (out_buf) = GST_BUFFER_OFFSET_NONE;
+      GST_BUFFER_OFFSET_END (out_buf) = GST_BUFFER_OFFSET_NONE;
+    } else {
+      out_buf = gst_buffer_copy_region (buffer, GST_BUFFER_COPY_MEMORY, offset,
+          datalen);
+      gst_buffer_unref (buffer);
+    }
+    buffer = NULL;
 
     ret = gst_flups_demux_send_data (demux, demux->current_stream, out_buf);
     if (ret == GST_FLOW_NOT_LINKED) {
@@ -2184,8 +2326,10 @@ gst_flups_demux_data_cb (GstPESFilter * filter, gboolean first,
   }
 
 done:
-  gst_buffer_unmap (buffer, &map);
-  gst_buffer_unref (buffer);
+  if (buffer) {
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+  }
 
   return ret;
 
@@ -2253,11 +2397,13 @@ gst_flups_demux_resync (GstFluPSDemux * demux, gboolean save)
        * the stream. */
       gst_adapter_push (demux->rev_adapter,
           gst_adapter_take_buffer (demux->adapter, offset - 4));
+      ADAPTER_OFFSET_FLUSH (offset - 4);
     } else {
       GST_LOG_OBJECT (demux, "reverse saving %d bytes", avail);
       /* nothing found, keep all bytes */
       gst_adapter_push (demux->rev_adapter,
           gst_adapter_take_buffer (demux->adapter, avail));
+      ADAPTER_OFFSET_FLUSH (avail);
     }
   }
 
@@ -2681,6 +2827,10 @@ gst_flups_sink_get_duration (GstFluPSDemux * demux)
       }
     }
   }
+  /* seed the SCR index with the boundaries */
+  gst_flups_demux_index_add (demux, demux->first_scr, demux->first_scr_offset);
+  gst_flups_demux_index_add (demux, demux->last_scr, demux->last_scr_offset);
+
   /* Set the base_time and avg rate */
   demux->base_time = MPEGTIME_TO_GSTTIME (demux->first_scr);
   demux->scr_rate_n = demux->last_scr_offset - demux->first_scr_offset;
@@ -2785,6 +2935,14 @@ gst_flups_demux_loop (GstPad * pad)
     }
   } else {                      /* Reverse playback */
     guint64 size = MIN (offset, BLOCK_SZ);
+    guint64 start;
+
+    /* start at an indexed pack when there is one close by, the chunk then
+     * has no partial pack in front to save for the previous one */
+    start = gst_flups_index_chunk_start (demux->scr_index, offset,
+        2 * GST_FLUPS_INDEX_ENTRY_DISTANCE);
+    if (start != G_MAXUINT64)
+      size = offset - start;
 
     /* pull in data */
     ret = gst_flups_demux_pull_block (pad, demux, offset - size, size);
@@ -3073,6 +3231,7 @@ gst_flups_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
           GST_DEBUG_OBJECT (demux, "saving 3 bytes");
           gst_adapter_push (demux->rev_adapter,
               gst_adapter_take_buffer (demux->adapter, 3));
+          ADAPTER_OFFSET_FLUSH (3);
         }
         ret = GST_FLOW_OK;
         break;
@@ -3081,6 +3240,12 @@ gst_flups_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     }
   }
 done:
+  /* push out everything collected from this buffer */
+  if (ret == GST_FLOW_OK)
+    ret = gst_flups_demux_push_all_pending (demux);
+  else if (ret != GST_FLOW_FLUSHING)
+    gst_flups_demux_push_all_pending (demux);
+
   gst_object_unref (demux);
 
   return ret;
@@ -3126,6 +3291,7 @@ gst_flups_demux_change_state (GstElement * element, GstStateChange transition)
       demux->first_pts = G_MAXUINT64;
       demux->last_pts = G_MAXUINT64;
       gst_flups_demux_reset_psm (demux);
+      g_array_set_size (demux->scr_index, 0);
       gst_segment_init (&demux->sink_segment, GST_FORMAT_UNDEFINED);
       gst_segment_init (&demux->src_segment, GST_FORMAT_TIME);
       gst_flups_demux_flush (demux);
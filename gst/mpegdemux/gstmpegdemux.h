@@ -48,6 +48,7 @@
 #include <gst/base/gstadapter.h>
 
 #include "gstpesfilter.h"
+#include "gstmpegdemuxindex.h"
 
 G_BEGIN_DECLS
 #define GST_TYPE_FLUPS_DEMUX		(gst_flups_demux_get_type())
@@ -92,6 +93,10 @@ struct _GstFluPSStream
   gboolean discont;
   gboolean notlinked;
   gboolean need_segment;
+
+  /* payloads collected while parsing the current input buffer, pushed
+   * downstream in one go, see gst_flups_demux_push_pending () */
+  GstBufferList *pending;
 };
 
 struct _GstFluPSDemux
@@ -126,6 +131,10 @@ struct _GstFluPSDemux
   guint64 first_pts;
   guint64 last_pts;
 
+  /* SCR index built while playing and seeking in pull mode, sorted on
+   * offset, see gst_flups_index_add () */
+  GArray *scr_index;
+
   gint16 psm[GST_FLUPS_DEMUX_MAX_PSM];
 
   GstSegment sink_segment;
@@ -0,0 +1,153 @@
+/* GStreamer
+ *
+ * gstmpegdemuxindex.h: SCR index of the MPEG program stream demuxer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_MPEG_DEMUX_INDEX_H__
+#define __GST_MPEG_DEMUX_INDEX_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstFluPSIndexEntry GstFluPSIndexEntry;
+
+/* An SCR -> byte offset association, offset is the position of the pack
+ * start code carrying the SCR. */
+struct _GstFluPSIndexEntry
+{
+  guint64 scr;
+  guint64 offset;
+};
+
+/* minimum byte distance between two entries of the SCR index, two blocks
+ * of the demuxer; a seek that lands between two entries closer than this is
+ * resolved without scanning */
+#define GST_FLUPS_INDEX_ENTRY_DISTANCE (2 * 32768)
+
+/* Returns the position in @index at which an entry for @offset would have
+ * to be inserted to keep it sorted */
+static inline guint
+gst_flups_index_find_pos (GArray * index, guint64 offset)
+{
+  GstFluPSIndexEntry *entries = (GstFluPSIndexEntry *) index->data;
+  guint lo = 0, hi = index->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (entries[mid].offset < offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+/* Remembers that the pack starting at @offset carries @scr, if that is
+ * consistent with the neighbouring entries: SCR discontinuities would
+ * otherwise make the index unusable for bisection. Entries closer than
+ * GST_FLUPS_INDEX_ENTRY_DISTANCE to another one are not added either.
+ * Returns whether the entry was added. */
+static inline gboolean
+gst_flups_index_add (GArray * index, guint64 scr, guint64 offset)
+{
+  GstFluPSIndexEntry *entries = (GstFluPSIndexEntry *) index->data;
+  GstFluPSIndexEntry entry;
+  guint pos;
+
+  if (offset == G_MAXUINT64 || scr == G_MAXUINT64)
+    return FALSE;
+
+  pos = gst_flups_index_find_pos (index, offset);
+
+  if (pos > 0) {
+    if (entries[pos - 1].scr > scr)
+      return FALSE;
+    if (offset - entries[pos - 1].offset < GST_FLUPS_INDEX_ENTRY_DISTANCE)
+      return FALSE;
+  }
+  if (pos < index->len) {
+    if (entries[pos].scr < scr)
+      return FALSE;
+    if (entries[pos].offset - offset < GST_FLUPS_INDEX_ENTRY_DISTANCE)
+      return FALSE;
+  }
+
+  entry.scr = scr;
+  entry.offset = offset;
+  g_array_insert_val (index, pos, entry);
+
+  return TRUE;
+}
+
+/* Narrows the interval from @min_scr at @min_offset to @max_scr at
+ * @max_offset around @scr with the entries of @index. Returns TRUE when
+ * @scr is then resolved without scanning: it is that of the lower end, or
+ * the interval is too short to hold another entry. The pack to start from
+ * is then the one at @min_offset. */
+static inline gboolean
+gst_flups_index_lookup (GArray * index, guint64 scr,
+    guint64 * min_scr, guint64 * min_offset,
+    guint64 * max_scr, guint64 * max_offset)
+{
+  GstFluPSIndexEntry *entries = (GstFluPSIndexEntry *) index->data;
+  guint lo = 0, hi = index->len;
+
+  /* entries are sorted on offset and, by construction, on SCR too */
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (entries[mid].scr <= scr)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo > 0 && entries[lo - 1].scr >= *min_scr) {
+    *min_scr = entries[lo - 1].scr;
+    *min_offset = entries[lo - 1].offset;
+  }
+  if (lo < index->len && entries[lo].scr <= *max_scr) {
+    *max_scr = entries[lo].scr;
+    *max_offset = entries[lo].offset;
+  }
+
+  return *min_scr == scr ||
+      *max_offset - *min_offset <= GST_FLUPS_INDEX_ENTRY_DISTANCE;
+}
+
+/* Returns the offset of the last entry of @index before @offset when it is
+ * at most @max_size bytes before it, or G_MAXUINT64. Reverse playback pulls
+ * the data from there up to @offset, which then starts with a pack. */
+static inline guint64
+gst_flups_index_chunk_start (GArray * index, guint64 offset, guint64 max_size)
+{
+  GstFluPSIndexEntry *entries = (GstFluPSIndexEntry *) index->data;
+  guint pos = gst_flups_index_find_pos (index, offset);
+
+  if (pos == 0 || offset - entries[pos - 1].offset > max_size)
+    return G_MAXUINT64;
+
+  return entries[pos - 1].offset;
+}
+
+G_END_DECLS
+
+#endif /* __GST_MPEG_DEMUX_INDEX_H__ */
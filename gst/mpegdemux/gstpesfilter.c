@@ -471,9 +471,16 @@ push_out:
           datalen, consumed);
     }
 
+    /* drop the header and take the payload out of the adapter, this gives
+     * us a sub-buffer of the input instead of a copy whenever the packet
+     * does not straddle input buffers */
+    gst_adapter_unmap (filter->adapter);
+    gst_adapter_flush (filter->adapter, avail - datalen);
+    ADAPTER_OFFSET_FLUSH (avail - datalen);
+
     if (datalen > 0) {
-      out = gst_buffer_new_allocate (NULL, datalen, NULL);
-      gst_buffer_fill (out, 0, data, datalen);
+      out = gst_adapter_take_buffer (filter->adapter, datalen);
+      ADAPTER_OFFSET_FLUSH (datalen);
       ret = gst_pes_filter_data_push (filter, TRUE, out);
       filter->first = FALSE;
     } else {
@@ -486,10 +493,6 @@ push_out:
       filter->state = STATE_DATA_PUSH;
   }
 
-  gst_adapter_unmap (filter->adapter);
-  gst_adapter_flush (filter->adapter, avail);
-  ADAPTER_OFFSET_FLUSH (avail);
-
   return ret;
 
 need_more_data:
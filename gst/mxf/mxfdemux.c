@@ -114,7 +114,8 @@ enum
   PROP_0,
   PROP_PACKAGE,
   PROP_MAX_DRIFT,
-  PROP_STRUCTURE
+  PROP_STRUCTURE,
+  PROP_LAZY_DESCRIPTIVE_METADATA
 };
 
 static gboolean gst_mxf_demux_sink_event (GstPad * pad, GstEvent * event);
@@ -203,6 +204,15 @@ gst_mxf_demux_reset_linked_metadata (GstMXFDemux * demux)
   demux->current_package = NULL;
 }
 
+static void
+gst_mxf_demux_pending_descriptive_metadata_free
+    (GstMXFDemuxPendingDescriptiveMetadata * pending)
+{
+  mxf_primer_pack_reset (&pending->primer);
+  gst_buffer_unref (pending->buffer);
+  g_free (pending);
+}
+
 static void
 gst_mxf_demux_reset_metadata (GstMXFDemux * demux)
 {
@@ -210,6 +220,11 @@ gst_mxf_demux_reset_metadata (GstMXFDemux * demux)
 
   g_static_rw_lock_writer_lock (&demux->metadata_lock);
 
+  g_list_foreach (demux->pending_descriptive_metadata,
+      (GFunc) gst_mxf_demux_pending_descriptive_metadata_free, NULL);
+  g_list_free (demux->pending_descriptive_metadata);
+  demux->pending_descriptive_metadata = NULL;
+
   demux->update_metadata = TRUE;
   demux->metadata_resolved = FALSE;
 
@@ -237,6 +252,10 @@ gst_mxf_demux_reset (GstMXFDemux * demux)
 
   demux->pull_footer_metadata = TRUE;
 
+  GST_OBJECT_LOCK (demux);
+  demux->descriptive_metadata_requested = FALSE;
+  GST_OBJECT_UNLOCK (demux);
+
   demux->run_in = -1;
 
   memset (&demux->current_package_uid, 0, sizeof (MXFUMID));
@@ -508,23 +527,39 @@ gst_mxf_demux_resolve_references (GstMXFDemux * demux)
     return GST_FLOW_ERROR;
   }
 
-  g_hash_table_iter_init (&iter, demux->metadata);
-  while (g_hash_table_iter_next (&iter, NULL, (gpointer) & m)) {
-    m->resolved = MXF_METADATA_BASE_RESOLVE_STATE_NONE;
+  if (!demux->preface) {
+    GST_ERROR_OBJECT (demux, "No preface yet");
+    g_static_rw_lock_writer_unlock (&demux->metadata_lock);
+    return GST_FLOW_ERROR;
   }
 
   g_hash_table_iter_init (&iter, demux->metadata);
   while (g_hash_table_iter_next (&iter, NULL, (gpointer) & m)) {
-    gboolean resolved;
-
-    resolved = mxf_metadata_base_resolve (m, demux->metadata);
+    m->resolved = MXF_METADATA_BASE_RESOLVE_STATE_NONE;
+  }
 
-    /* Resolving can fail for anything but the preface, as the preface
-     * will resolve everything required */
-    if (!resolved && MXF_IS_METADATA_PREFACE (m)) {
+  if (demux->lazy_descriptive_metadata) {
+    /* Only resolve what is reachable from the preface, descriptive
+     * metadata that is not parsed yet gets linked once it is requested */
+    if (!mxf_metadata_base_resolve (MXF_METADATA_BASE (demux->preface),
+            demux->metadata)) {
       ret = GST_FLOW_ERROR;
       goto error;
     }
+  } else {
+    g_hash_table_iter_init (&iter, demux->metadata);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer) & m)) {
+      gboolean resolved;
+
+      resolved = mxf_metadata_base_resolve (m, demux->metadata);
+
+      /* Resolving can fail for anything but the preface, as the preface
+       * will resolve everything required */
+      if (!resolved && MXF_IS_METADATA_PREFACE (m)) {
+        ret = GST_FLOW_ERROR;
+        goto error;
+      }
+    }
   }
 
   demux->metadata_resolved = TRUE;
@@ -1298,40 +1333,13 @@ gst_mxf_demux_handle_metadata (GstMXFDemux * demux, const MXFUL * key,
 }
 
 static GstFlowReturn
-gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
-    const MXFUL * key, GstBuffer * buffer)
+gst_mxf_demux_add_descriptive_metadata (GstMXFDemux * demux, guint8 scheme,
+    guint32 type, MXFPrimerPack * primer, guint64 offset, const guint8 * data,
+    guint size)
 {
-  guint32 type;
-  guint8 scheme;
-  GstFlowReturn ret = GST_FLOW_OK;
   MXFDescriptiveMetadata *m = NULL, *old = NULL;
 
-  scheme = GST_READ_UINT8 (key->u + 12);
-  type = GST_READ_UINT24_BE (key->u + 13);
-
-  GST_DEBUG_OBJECT (demux,
-      "Handling descriptive metadata of size %u at offset %"
-      G_GUINT64_FORMAT " with scheme 0x%02x and type 0x%06x",
-      GST_BUFFER_SIZE (buffer), demux->offset, scheme, type);
-
-  if (G_UNLIKELY (!demux->current_partition)) {
-    GST_ERROR_OBJECT (demux, "Partition pack doesn't exist");
-    return GST_FLOW_ERROR;
-  }
-
-  if (G_UNLIKELY (!demux->current_partition->primer.mappings)) {
-    GST_ERROR_OBJECT (demux, "Primer pack doesn't exists");
-    return GST_FLOW_ERROR;
-  }
-
-  if (demux->current_partition->parsed_metadata) {
-    GST_DEBUG_OBJECT (demux, "Metadata of this partition was already parsed");
-    return GST_FLOW_OK;
-  }
-
-  m = mxf_descriptive_metadata_new (scheme, type,
-      &demux->current_partition->primer, demux->offset,
-      GST_BUFFER_DATA (buffer), GST_BUFFER_SIZE (buffer));
+  m = mxf_descriptive_metadata_new (scheme, type, primer, offset, data, size);
 
   if (!m) {
     GST_WARNING_OBJECT (demux,
@@ -1340,6 +1348,10 @@ gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
     return GST_FLOW_OK;
   }
 
+  /* the structure property reads the metadata from the application
+   * thread */
+  g_static_rw_lock_writer_lock (&demux->metadata_lock);
+
   old =
       g_hash_table_lookup (demux->metadata,
       &MXF_METADATA_BASE (m)->instance_uid);
@@ -1356,6 +1368,7 @@ gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
         g_type_name (G_TYPE_FROM_INSTANCE (old)),
         g_type_name (G_TYPE_FROM_INSTANCE (m)));
     g_object_unref (m);
+    g_static_rw_lock_writer_unlock (&demux->metadata_lock);
     return GST_FLOW_ERROR;
   } else if (old
       && MXF_METADATA_BASE (old)->offset >= MXF_METADATA_BASE (m)->offset) {
@@ -1367,11 +1380,10 @@ gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
         "Metadata with instance uid %s already exists and is newer",
         mxf_uuid_to_string (&MXF_METADATA_BASE (m)->instance_uid, str));
     g_object_unref (m);
+    g_static_rw_lock_writer_unlock (&demux->metadata_lock);
     return GST_FLOW_OK;
   }
 
-  g_static_rw_lock_writer_lock (&demux->metadata_lock);
-
   demux->update_metadata = TRUE;
   gst_mxf_demux_reset_linked_metadata (demux);
 
@@ -1380,7 +1392,117 @@ gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
 
   g_static_rw_lock_writer_unlock (&demux->metadata_lock);
 
-  return ret;
+  return GST_FLOW_OK;
+}
+
+/* Parses all descriptive metadata sets that were stored by
+ * gst_mxf_demux_handle_descriptive_metadata() in lazy mode. Only called
+ * from the streaming thread, the references are resolved with the next
+ * metadata update. */
+static void
+gst_mxf_demux_parse_pending_descriptive_metadata (GstMXFDemux * demux)
+{
+  GList *pending, *l;
+
+  g_static_rw_lock_writer_lock (&demux->metadata_lock);
+  pending = demux->pending_descriptive_metadata;
+  demux->pending_descriptive_metadata = NULL;
+  g_static_rw_lock_writer_unlock (&demux->metadata_lock);
+
+  if (!pending)
+    return;
+
+  GST_DEBUG_OBJECT (demux, "Parsing %u pending descriptive metadata sets",
+      g_list_length (pending));
+
+  for (l = pending; l; l = l->next) {
+    GstMXFDemuxPendingDescriptiveMetadata *p = l->data;
+
+    gst_mxf_demux_add_descriptive_metadata (demux, p->scheme, p->type,
+        &p->primer, p->offset, GST_BUFFER_DATA (p->buffer),
+        GST_BUFFER_SIZE (p->buffer));
+    gst_mxf_demux_pending_descriptive_metadata_free (p);
+  }
+  g_list_free (pending);
+}
+
+/* Called when the descriptive metadata is requested. If the streaming
+ * thread is idle, e.g. after EOS, it would not handle the request anymore,
+ * so parse the pending sets and update the metadata here */
+static void
+gst_mxf_demux_parse_requested_descriptive_metadata (GstMXFDemux * demux)
+{
+  if (!GST_PAD_STREAM_TRYLOCK (demux->sinkpad))
+    return;
+
+  if (demux->pending_descriptive_metadata) {
+    gst_mxf_demux_parse_pending_descriptive_metadata (demux);
+
+    if (demux->update_metadata && demux->preface && demux->metadata_resolved) {
+      if (gst_mxf_demux_resolve_references (demux) != GST_FLOW_OK ||
+          gst_mxf_demux_update_tracks (demux) != GST_FLOW_OK)
+        GST_WARNING_OBJECT (demux,
+            "Failed to update metadata with the descriptive metadata");
+    }
+  }
+
+  GST_PAD_STREAM_UNLOCK (demux->sinkpad);
+}
+
+static GstFlowReturn
+gst_mxf_demux_handle_descriptive_metadata (GstMXFDemux * demux,
+    const MXFUL * key, GstBuffer * buffer)
+{
+  guint32 type;
+  guint8 scheme;
+
+  scheme = GST_READ_UINT8 (key->u + 12);
+  type = GST_READ_UINT24_BE (key->u + 13);
+
+  GST_DEBUG_OBJECT (demux,
+      "Handling descriptive metadata of size %u at offset %"
+      G_GUINT64_FORMAT " with scheme 0x%02x and type 0x%06x",
+      GST_BUFFER_SIZE (buffer), demux->offset, scheme, type);
+
+  if (G_UNLIKELY (!demux->current_partition)) {
+    GST_ERROR_OBJECT (demux, "Partition pack doesn't exist");
+    return GST_FLOW_ERROR;
+  }
+
+  if (G_UNLIKELY (!demux->current_partition->primer.mappings)) {
+    GST_ERROR_OBJECT (demux, "Primer pack doesn't exists");
+    return GST_FLOW_ERROR;
+  }
+
+  if (demux->current_partition->parsed_metadata) {
+    GST_DEBUG_OBJECT (demux, "Metadata of this partition was already parsed");
+    return GST_FLOW_OK;
+  }
+
+  if (demux->lazy_descriptive_metadata) {
+    GstMXFDemuxPendingDescriptiveMetadata *pending;
+
+    pending = g_new0 (GstMXFDemuxPendingDescriptiveMetadata, 1);
+    pending->scheme = scheme;
+    pending->type = type;
+    pending->primer = demux->current_partition->primer;
+    g_hash_table_ref (pending->primer.mappings);
+    if (pending->primer.reverse_mappings)
+      g_hash_table_ref (pending->primer.reverse_mappings);
+    pending->offset = demux->offset;
+    pending->buffer = gst_buffer_ref (buffer);
+
+    g_static_rw_lock_writer_lock (&demux->metadata_lock);
+    demux->pending_descriptive_metadata =
+        g_list_prepend (demux->pending_descriptive_metadata, pending);
+    g_static_rw_lock_writer_unlock (&demux->metadata_lock);
+
+    return GST_FLOW_OK;
+  }
+
+  return gst_mxf_demux_add_descriptive_metadata (demux, scheme, type,
+      &demux->current_partition->primer, demux->offset,
+      GST_BUFFER_DATA (buffer), GST_BUFFER_SIZE (buffer));
 }
 
 static GstFlowReturn
@@ -1599,15 +1721,34 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
     GST_DEBUG_OBJECT (demux,
         "Unknown essence track position, looking into index");
     if (etrack->offsets) {
+      guint64 offset = demux->offset - demux->run_in;
+
       for (i = 0; i < etrack->offsets->len; i++) {
         GstMXFDemuxIndex *idx =
             &g_array_index (etrack->offsets, GstMXFDemuxIndex, i);
 
-        if (idx->offset != 0 && idx->offset == demux->offset - demux->run_in) {
+        if (idx->offset != 0 && idx->offset == offset) {
           etrack->position = i;
           break;
         }
       }
+
+      /* Offsets from index table segments point to the start of the edit
+       * unit, which might begin with a system item */
+      if (etrack->position == -1) {
+        for (i = 0; i + 1 < etrack->offsets->len; i++) {
+          GstMXFDemuxIndex *idx =
+              &g_array_index (etrack->offsets, GstMXFDemuxIndex, i);
+          GstMXFDemuxIndex *next =
+              &g_array_index (etrack->offsets, GstMXFDemuxIndex, i + 1);
+
+          if (idx->offset != 0 && idx->offset < offset
+              && next->offset > offset) {
+            etrack->position = i;
+            break;
+          }
+        }
+      }
     }
 
     if (etrack->position == -1) {
@@ -1904,6 +2045,7 @@ gst_mxf_demux_handle_index_table_segment (GstMXFDemux * demux,
     const MXFUL * key, GstBuffer * buffer)
 {
   MXFIndexTableSegment *segment;
+  GList *l;
 
   GST_DEBUG_OBJECT (demux,
       "Handling index table segment of size %u at offset %"
@@ -1923,6 +2065,19 @@ gst_mxf_demux_handle_index_table_segment (GstMXFDemux * demux,
     return GST_FLOW_ERROR;
   }
 
+  /* The footer's index might have been read already at startup */
+  for (l = demux->pending_index_table_segments; l; l = l->next) {
+    MXFIndexTableSegment *tmp = l->data;
+
+    if (mxf_uuid_is_equal (&tmp->instance_id, &segment->instance_id)
+        && tmp->index_start_position == segment->index_start_position) {
+      GST_DEBUG_OBJECT (demux, "Index table segment already known");
+      mxf_index_table_segment_reset (segment);
+      g_free (segment);
+      return GST_FLOW_OK;
+    }
+  }
+
   demux->pending_index_table_segments =
       g_list_prepend (demux->pending_index_table_segments, segment);
 
@@ -2081,7 +2236,208 @@ gst_mxf_demux_pull_random_index_pack (GstMXFDemux * demux)
   demux->offset = old_offset;
 }
 
+/* Pull the index table segments of the current partition, which start at
+ * demux->offset, and keep them for gst_mxf_demux_update_offsets_from_index() */
+static void
+gst_mxf_demux_pull_index_table_segments (GstMXFDemux * demux)
+{
+  guint64 end =
+      demux->offset + demux->current_partition->partition.index_byte_count;
+  GstBuffer *buffer = NULL;
+  guint read = 0;
+  MXFUL key;
+
+  while (demux->offset < end) {
+    if (gst_mxf_demux_pull_klv_packet (demux, demux->offset, &key, &buffer,
+            &read) != GST_FLOW_OK)
+      break;
+
+    if (mxf_is_index_table_segment (&key)) {
+      gst_mxf_demux_handle_index_table_segment (demux, &key, buffer);
+    } else if (!mxf_is_fill (&key)) {
+      gst_buffer_unref (buffer);
+      break;
+    }
+
+    demux->offset += read;
+    gst_buffer_unref (buffer);
+    buffer = NULL;
+  }
+}
+
+/* Returns the offset of the first KLV packet at or after @offset that is
+ * not a fill item */
+static guint64
+gst_mxf_demux_skip_fill (GstMXFDemux * demux, guint64 offset)
+{
+  GstBuffer *buffer = NULL;
+  guint read = 0;
+  MXFUL key;
+
+  while (gst_mxf_demux_pull_klv_packet (demux, offset, &key, &buffer,
+          &read) == GST_FLOW_OK) {
+    gst_buffer_unref (buffer);
+    buffer = NULL;
+
+    if (!mxf_is_fill (&key))
+      break;
+    offset += read;
+  }
+
+  return offset;
+}
+
+/* Find the start of the essence container of every partition that was not
+ * read yet by pulling its partition pack. Only fill items, the header
+ * metadata and the index table segments can come before the essence, and
+ * the latter two are counted in the partition pack */
 static void
+gst_mxf_demux_pull_essence_container_offsets (GstMXFDemux * demux)
+{
+  GstMXFDemuxPartition *old_partition = demux->current_partition;
+  guint64 old_offset = demux->offset;
+  GList *l;
+
+  for (l = demux->partitions; l; l = l->next) {
+    GstMXFDemuxPartition *p = l->data;
+    GstBuffer *buffer = NULL;
+    guint read = 0;
+    guint64 offset;
+    MXFUL key;
+
+    if (p->essence_container_offset != 0 || p->partition.body_sid == 0)
+      continue;
+
+    demux->offset = demux->run_in + p->partition.this_partition;
+    if (gst_mxf_demux_pull_klv_packet (demux, demux->offset, &key, &buffer,
+            &read) != GST_FLOW_OK)
+      break;
+
+    /* Partitions only known from the random index pack */
+    if (!mxf_is_partition_pack (&key) || (p->partition.major_version == 0
+            && gst_mxf_demux_handle_partition_pack (demux, &key,
+                buffer) != GST_FLOW_OK)) {
+      gst_buffer_unref (buffer);
+      continue;
+    }
+    gst_buffer_unref (buffer);
+
+    if (p->partition.body_sid == 0)
+      continue;
+
+    offset = gst_mxf_demux_skip_fill (demux, demux->offset + read);
+    if (p->partition.header_byte_count + p->partition.index_byte_count > 0)
+      offset = gst_mxf_demux_skip_fill (demux,
+          offset + p->partition.header_byte_count +
+          p->partition.index_byte_count);
+
+    p->essence_container_offset =
+        offset - p->partition.this_partition - demux->run_in;
+    GST_DEBUG_OBJECT (demux,
+        "Essence container of partition at %" G_GUINT64_FORMAT
+        " starts at %" G_GUINT64_FORMAT, p->partition.this_partition,
+        p->essence_container_offset);
+  }
+
+  demux->offset = old_offset;
+  demux->current_partition = old_partition;
+}
+
+/* Fill the essence track offsets from the index table segments known so
+ * far, so that seeking does not need to scan the essence. Index entries
+ * point to the start of the edit unit, which every track of an interleaved
+ * essence container gets as its offset. The flags of the entries are only
+ * used for picture tracks, the other tracks only have keyframes. Stream
+ * offsets are only converted inside partitions whose essence container
+ * offset is known. */
+static void
+gst_mxf_demux_update_offsets_from_index (GstMXFDemux * demux)
+{
+  GList *l, *k;
+  guint i;
+
+  for (l = demux->pending_index_table_segments; l; l = l->next) {
+    MXFIndexTableSegment *segment = l->data;
+    gint64 n_entries, j;
+
+    if (segment->n_index_entries > 0)
+      n_entries = segment->n_index_entries;
+    else if (segment->edit_unit_byte_count > 0)
+      n_entries = segment->index_duration;
+    else
+      continue;
+
+    if (segment->index_start_position < 0 || n_entries <= 0)
+      continue;
+
+    for (i = 0; i < demux->essence_tracks->len; i++) {
+      GstMXFDemuxEssenceTrack *etrack =
+          &g_array_index (demux->essence_tracks, GstMXFDemuxEssenceTrack, i);
+      gboolean use_flags;
+
+      if (etrack->body_sid != segment->body_sid)
+        continue;
+
+      use_flags = etrack->source_track
+          && etrack->source_track->parent.type ==
+          MXF_METADATA_TRACK_PICTURE_ESSENCE;
+
+      if (!etrack->offsets)
+        etrack->offsets = g_array_new (FALSE, TRUE, sizeof (GstMXFDemuxIndex));
+      if (etrack->offsets->len < segment->index_start_position + n_entries)
+        g_array_set_size (etrack->offsets,
+            segment->index_start_position + n_entries);
+
+      for (j = 0; j < n_entries; j++) {
+        GstMXFDemuxIndex *idx = &g_array_index (etrack->offsets,
+            GstMXFDemuxIndex, segment->index_start_position + j);
+        GstMXFDemuxPartition *p = NULL, *next = NULL;
+        guint64 stream_offset;
+        gboolean keyframe = TRUE;
+
+        if (idx->offset != 0)
+          continue;
+
+        if (segment->n_index_entries > 0) {
+          stream_offset = segment->index_entries[j].stream_offset;
+          /* Random access flag, SMPTE 377M 10.2.3 */
+          if (use_flags)
+            keyframe = (segment->index_entries[j].flags & 0x80) != 0;
+        } else {
+          stream_offset = (guint64) j * segment->edit_unit_byte_count;
+        }
+
+        for (k = demux->partitions; k; k = k->next) {
+          GstMXFDemuxPartition *tmp = k->data;
+
+          if (tmp->partition.body_sid != segment->body_sid)
+            continue;
+
+          if (tmp->partition.major_version == 0
+              || tmp->essence_container_offset == 0
+              || tmp->partition.body_offset > stream_offset) {
+            next = tmp;
+            break;
+          }
+          p = tmp;
+        }
+
+        /* Only use the partition if we know where its essence ends */
+        if (!p || (next && (next->partition.major_version == 0
+                    || next->partition.body_offset <= stream_offset)))
+          continue;
+
+        idx->offset = p->partition.this_partition + p->essence_container_offset
+            + stream_offset - p->partition.body_offset;
+        idx->keyframe = keyframe;
+      }
+    }
+  }
+}
+
+/* Returns TRUE if the resolved metadata comes from a closed and complete
+ * partition and is final */
+static gboolean
 gst_mxf_demux_parse_footer_metadata (GstMXFDemux * demux)
 {
   guint64 old_offset = demux->offset;
@@ -2090,6 +2446,7 @@ gst_mxf_demux_parse_footer_metadata (GstMXFDemux * demux)
   guint read = 0;
   GstFlowReturn ret = GST_FLOW_OK;
   GstMXFDemuxPartition *old_partition = demux->current_partition;
+  gboolean final = FALSE;
 
   demux->current_partition = NULL;
 
@@ -2122,6 +2479,9 @@ next_try:
   buffer = NULL;
 
   if (demux->current_partition->partition.header_byte_count == 0) {
+    /* The footer usually carries the complete index */
+    gst_mxf_demux_pull_index_table_segments (demux);
+
     if (demux->current_partition->partition.prev_partition == 0
         || demux->current_partition->partition.this_partition == 0)
       goto out;
@@ -2240,12 +2600,23 @@ next_try:
     goto next_try;
   }
 
+  final = demux->current_partition->partition.closed
+      && demux->current_partition->partition.complete;
+
+  /* Index table segments directly follow the header metadata */
+  demux->offset =
+      demux->run_in + demux->current_partition->primer.offset +
+      demux->current_partition->partition.header_byte_count;
+  gst_mxf_demux_pull_index_table_segments (demux);
+
 out:
   if (buffer)
     gst_buffer_unref (buffer);
 
   demux->offset = old_offset;
   demux->current_partition = old_partition;
+
+  return final;
 }
 
 static GstFlowReturn
@@ -2256,6 +2627,14 @@ gst_mxf_demux_handle_klv_packet (GstMXFDemux * demux, const MXFUL * key,
   gchar key_str[48];
 #endif
   GstFlowReturn ret = GST_FLOW_OK;
+  gboolean parse_descriptive_metadata;
+
+  GST_OBJECT_LOCK (demux);
+  parse_descriptive_metadata = demux->descriptive_metadata_requested;
+  GST_OBJECT_UNLOCK (demux);
+
+  if (parse_descriptive_metadata && demux->pending_descriptive_metadata)
+    gst_mxf_demux_parse_pending_descriptive_metadata (demux);
 
   if (demux->update_metadata
       && demux->preface
@@ -2339,11 +2718,19 @@ gst_mxf_demux_handle_klv_packet (GstMXFDemux * demux, const MXFUL * key,
       && (!demux->current_partition->partition.closed
           || !demux->current_partition->partition.complete)
       && (demux->footer_partition_pack_offset != 0 || demux->random_index_pack)) {
+    gboolean final_metadata;
+
     GST_DEBUG_OBJECT (demux,
         "Open or incomplete header partition, trying to get final metadata from the last partitions");
-    gst_mxf_demux_parse_footer_metadata (demux);
+    final_metadata = gst_mxf_demux_parse_footer_metadata (demux);
     demux->pull_footer_metadata = FALSE;
 
+    /* Metadata from a closed and complete partition supersedes the one of
+     * the header partition, no need to parse the latter anymore. Open or
+     * incomplete metadata might still miss parts of the header's */
+    if (demux->metadata_resolved && final_metadata)
+      demux->current_partition->parsed_metadata = TRUE;
+
     if (demux->current_partition->partition.body_sid != 0 &&
         demux->current_partition->partition.body_offset == 0) {
       guint i;
@@ -2385,6 +2772,7 @@ gst_mxf_demux_find_essence_element (GstMXFDemux * demux,
   GstFlowReturn ret = GST_FLOW_OK;
   guint64 old_offset = demux->offset;
   GstMXFDemuxPartition *old_partition = demux->current_partition;
+  gboolean updated_from_index = FALSE;
   gint i;
 
   GST_DEBUG_OBJECT (demux, "Trying to find essence element %" G_GINT64_FORMAT
@@ -2434,6 +2822,15 @@ from_index:
   }
 
   GST_DEBUG_OBJECT (demux, "Not found in index");
+
+  if (!updated_from_index && demux->pending_index_table_segments) {
+    updated_from_index = TRUE;
+    if (demux->random_access)
+      gst_mxf_demux_pull_essence_container_offsets (demux);
+    gst_mxf_demux_update_offsets_from_index (demux);
+    goto from_index;
+  }
+
   if (!demux->random_access) {
     guint64 new_offset = -1;
     gint64 new_position = -1;
@@ -2632,6 +3029,22 @@ gst_mxf_demux_pull_and_handle_klv_packet (GstMXFDemux * demux)
   ret = gst_mxf_demux_handle_klv_packet (demux, &key, buffer, FALSE);
   demux->offset += read;
 
+  /* Jump over metadata we already have instead of pulling it KLV by KLV */
+  if (ret == GST_FLOW_OK && mxf_is_primer_pack (&key)
+      && demux->current_partition
+      && demux->current_partition->parsed_metadata
+      && demux->current_partition->partition.header_byte_count != 0) {
+    guint64 metadata_end =
+        demux->run_in + demux->current_partition->primer.offset +
+        demux->current_partition->partition.header_byte_count;
+
+    if (metadata_end > demux->offset) {
+      GST_DEBUG_OBJECT (demux, "Skipping already parsed metadata up to %"
+          G_GUINT64_FORMAT, metadata_end);
+      demux->offset = metadata_end;
+    }
+  }
+
   if (ret == GST_FLOW_OK && demux->src->len > 0
       && demux->essence_tracks->len > 0) {
     GstMXFDemuxPad *earliest = NULL;
@@ -3891,6 +4304,9 @@ gst_mxf_demux_set_property (GObject * object, guint prop_id,
     case PROP_MAX_DRIFT:
       demux->max_drift = g_value_get_uint64 (value);
       break;
+    case PROP_LAZY_DESCRIPTIVE_METADATA:
+      demux->lazy_descriptive_metadata = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3910,9 +4326,22 @@ gst_mxf_demux_get_property (GObject * object, guint prop_id,
     case PROP_MAX_DRIFT:
       g_value_set_uint64 (value, demux->max_drift);
       break;
+    case PROP_LAZY_DESCRIPTIVE_METADATA:
+      g_value_set_boolean (value, demux->lazy_descriptive_metadata);
+      break;
     case PROP_STRUCTURE:{
       GstStructure *s;
 
+      /* Descriptive metadata is requested now. It is parsed by the
+       * streaming thread and the structure tag posted after the next
+       * metadata update will contain it, or right here if the streaming
+       * thread is idle */
+      GST_OBJECT_LOCK (demux);
+      demux->descriptive_metadata_requested = TRUE;
+      GST_OBJECT_UNLOCK (demux);
+
+      gst_mxf_demux_parse_requested_descriptive_metadata (demux);
+
       g_static_rw_lock_reader_lock (&demux->metadata_lock);
       if (demux->preface)
         s = mxf_metadata_base_to_structure (MXF_METADATA_BASE (demux->preface));
@@ -4009,6 +4438,14 @@ gst_mxf_demux_class_init (GstMXFDemuxClass * klass)
           "Structural metadata of the MXF file",
           GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class,
+      PROP_LAZY_DESCRIPTIVE_METADATA,
+      g_param_spec_boolean ("lazy-descriptive-metadata",
+          "Lazy descriptive metadata",
+          "Only parse descriptive metadata when the structure is requested, "
+          "tracks are built from the structural metadata alone", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_mxf_demux_change_state);
   gstelement_class->query = GST_DEBUG_FUNCPTR (gst_mxf_demux_query);
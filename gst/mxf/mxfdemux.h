@@ -61,6 +61,19 @@ typedef struct
   gboolean keyframe;
 } GstMXFDemuxIndex;
 
+/* Descriptive metadata set that was not parsed yet, see the
+ * lazy-descriptive-metadata property */
+typedef struct
+{
+  guint8 scheme;
+  guint32 type;
+  /* shares the mappings with the partition's primer, which can be gone
+   * by the time the set is parsed */
+  MXFPrimerPack primer;
+  guint64 offset;
+  GstBuffer *buffer;
+} GstMXFDemuxPendingDescriptiveMetadata;
+
 typedef struct
 {
   guint32 body_sid;
@@ -161,6 +174,9 @@ struct _GstMXFDemux
   gboolean metadata_resolved;
   MXFMetadataPreface *preface;
   GHashTable *metadata;
+  GList *pending_descriptive_metadata;
+  /* Set by the application thread, protected by the object lock */
+  gboolean descriptive_metadata_requested;
 
   MXFUMID current_package_uid;
   MXFMetadataGenericPackage *current_package;
@@ -169,6 +185,7 @@ struct _GstMXFDemux
   /* Properties */
   gchar *requested_package_string;
   GstClockTime max_drift;
+  gboolean lazy_descriptive_metadata;
 };
 
 struct _GstMXFDemuxClass
@@ -3686,6 +3686,11 @@ mxf_metadata_dm_segment_resolve (MXFMetadataBase * m, GHashTable * metadata)
   MXFMetadataDMSegment *self = MXF_METADATA_DM_SEGMENT (m);
   MXFMetadataBase *current = NULL;
 
+  self->dm_framework = NULL;
+
+  /* The framework is optional for the structural metadata, it is not
+   * parsed yet when the demuxer only parses descriptive metadata on
+   * request */
   current = g_hash_table_lookup (metadata, &self->dm_framework_uid);
   if (current && MXF_IS_DESCRIPTIVE_METADATA_FRAMEWORK (current)) {
     if (mxf_metadata_base_resolve (current, metadata)) {
@@ -3695,8 +3700,7 @@ mxf_metadata_dm_segment_resolve (MXFMetadataBase * m, GHashTable * metadata)
       return FALSE;
     }
   } else {
-    GST_ERROR ("Couldn't find DM framework");
-    return FALSE;
+    GST_DEBUG ("DM framework not available");
   }
 
 
@@ -3720,7 +3724,16 @@ mxf_metadata_dm_segment_to_structure (MXFMetadataBase * m)
   if (self->event_comment)
     gst_structure_id_set (ret, MXF_QUARK (EVENT_COMMENT), G_TYPE_STRING,
         self->event_comment, NULL);
-  /* FIXME: DMS1 doesn't support serializing to a structure yet */
+  /* FIXME: DMS1 doesn't support serializing to a structure yet, only
+   * reference the framework */
+  if (self->dm_framework) {
+    gchar str[48];
+
+    mxf_uuid_to_string (&MXF_METADATA_BASE (self->dm_framework)->instance_uid,
+        str);
+    gst_structure_id_set (ret, MXF_QUARK (DM_FRAMEWORK), G_TYPE_STRING, str,
+        NULL);
+  }
 #if 0
   if (self->dm_framework) {
     GstStructure *s =
@@ -1102,6 +1102,8 @@ mxf_mpeg_video_write_func (GstBuffer * buffer, GstCaps * caps,
       if (buffer) {
         memcpy (GST_BUFFER_DATA (ret) + av, GST_BUFFER_DATA (buffer),
             GST_BUFFER_SIZE (buffer));
+        /* the muxer takes the random access flag from here */
+        gst_buffer_copy_metadata (ret, buffer, GST_BUFFER_COPY_FLAGS);
         gst_buffer_unref (buffer);
       }
       *outbuf = ret;
@@ -1130,6 +1132,8 @@ mxf_mpeg_video_write_func (GstBuffer * buffer, GstCaps * caps,
       if (buffer) {
         memcpy (GST_BUFFER_DATA (ret) + av, GST_BUFFER_DATA (buffer),
             GST_BUFFER_SIZE (buffer));
+        /* the muxer takes the random access flag from here */
+        gst_buffer_copy_metadata (ret, buffer, GST_BUFFER_COPY_FLAGS);
         gst_buffer_unref (buffer);
       }
       *outbuf = ret;
@@ -28,6 +28,19 @@
  * gst-launch -v filesrc location=/path/to/audio ! decodebin2 ! queue ! mxfmux name=m ! filesink location=file.mxf   filesrc location=/path/to/video ! decodebin2 ! queue ! m. 
  * ]| This pipeline muxes an audio and video file into a single MXF file.
  * </refsect2>
+ *
+ * By default all essence goes into a single body partition and the index
+ * table is only written into the footer partition. With
+ * #GstMXFMux:partition-interval a new body partition is started
+ * periodically, carrying the index table segments of the previous one, and
+ * with #GstMXFMux:header-interval a copy of the header metadata with the
+ * durations so far is repeated periodically in a new body partition. Both
+ * are for files that are read while they are still being written: a
+ * reader of such a growing file finds no footer partition and no random
+ * index pack, as these are only written at EOS, and the header partition
+ * stays open and incomplete until it is rewritten then. It has to locate
+ * the body partitions from the partition packs themselves and take the
+ * index and the durations from the last complete body partition.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -52,11 +65,23 @@ static GstStaticPadTemplate src_templ = GST_STATIC_PAD_TEMPLATE ("src",
     GST_STATIC_CAPS ("application/mxf")
     );
 
+#define DEFAULT_PARTITION_INTERVAL 0
+#define DEFAULT_HEADER_INTERVAL 0
+
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_PARTITION_INTERVAL,
+  PROP_HEADER_INTERVAL
 };
 
+/* Index table segments are only written for the generic container
+ * of the single essence container data set, see gst_mxf_mux_create_metadata() */
+#define MXF_MUX_INDEX_SID 2
+
+/* Index entries are 11 bytes and the local tag size is only 16 bits */
+#define MXF_MUX_MAX_INDEX_ENTRIES ((G_MAXUINT16 - 8) / 11)
+
 GST_BOILERPLATE (GstMXFMux, gst_mxf_mux, GstElement, GST_TYPE_ELEMENT);
 
 static void gst_mxf_mux_finalize (GObject * object);
@@ -128,6 +153,22 @@ gst_mxf_mux_class_init (GstMXFMuxClass * klass)
   gobject_class->set_property = gst_mxf_mux_set_property;
   gobject_class->get_property = gst_mxf_mux_get_property;
 
+  g_object_class_install_property (gobject_class, PROP_PARTITION_INTERVAL,
+      g_param_spec_uint64 ("partition-interval", "Partition interval",
+          "Start a new body partition with an index table segment for the "
+          "previous one after this many nanoseconds (0 = single body "
+          "partition, index only in the footer)", 0, G_MAXUINT64,
+          DEFAULT_PARTITION_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_HEADER_INTERVAL,
+      g_param_spec_uint64 ("header-interval", "Header interval",
+          "Repeat the header metadata with the current durations in a new "
+          "body partition after this many nanoseconds (0 = header metadata "
+          "only in the header and footer partitions)", 0, G_MAXUINT64,
+          DEFAULT_HEADER_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_mxf_mux_change_state);
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_mxf_mux_request_new_pad);
@@ -150,6 +191,12 @@ gst_mxf_mux_init (GstMXFMux * mux, GstMXFMuxClass * g_class)
   gst_collect_pads_set_function (mux->collect,
       (GstCollectPadsFunction) GST_DEBUG_FUNCPTR (gst_mxf_mux_collected), mux);
 
+  mux->index_entries = g_array_new (FALSE, TRUE, sizeof (MXFIndexEntry));
+  mux->rip = g_array_new (FALSE, FALSE, sizeof (MXFRandomIndexPackEntry));
+
+  mux->partition_interval = DEFAULT_PARTITION_INTERVAL;
+  mux->header_interval = DEFAULT_HEADER_INTERVAL;
+
   gst_mxf_mux_reset (mux);
 }
 
@@ -167,6 +214,9 @@ gst_mxf_mux_finalize (GObject * object)
     mux->metadata_list = NULL;
   }
 
+  g_array_free (mux->index_entries, TRUE);
+  g_array_free (mux->rip, TRUE);
+
   gst_object_unref (mux->collect);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -176,9 +226,15 @@ static void
 gst_mxf_mux_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec)
 {
-  //GstMXFMux *mux = GST_MXF_MUX (object);
+  GstMXFMux *mux = GST_MXF_MUX (object);
 
   switch (prop_id) {
+    case PROP_PARTITION_INTERVAL:
+      mux->partition_interval = g_value_get_uint64 (value);
+      break;
+    case PROP_HEADER_INTERVAL:
+      mux->header_interval = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -189,9 +245,15 @@ static void
 gst_mxf_mux_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec)
 {
-  //GstMXFMux *mux = GST_MXF_MUX (object);
+  GstMXFMux *mux = GST_MXF_MUX (object);
 
   switch (prop_id) {
+    case PROP_PARTITION_INTERVAL:
+      g_value_set_uint64 (value, mux->partition_interval);
+      break;
+    case PROP_HEADER_INTERVAL:
+      g_value_set_uint64 (value, mux->header_interval);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -229,6 +291,12 @@ gst_mxf_mux_reset (GstMXFMux * mux)
   mux->last_gc_timestamp = 0;
   mux->last_gc_position = 0;
   mux->offset = 0;
+
+  mux->essence_offset = 0;
+  mux->index_start_position = 0;
+  mux->header_position = 0;
+  g_array_set_size (mux->index_entries, 0);
+  g_array_set_size (mux->rip, 0);
 }
 
 static gboolean
@@ -940,7 +1008,7 @@ gst_mxf_mux_create_metadata (GstMXFMux * mux)
 
     cstorage->essence_container_data[0]->linked_package =
         MXF_METADATA_SOURCE_PACKAGE (cstorage->packages[1]);
-    cstorage->essence_container_data[0]->index_sid = 0;
+    cstorage->essence_container_data[0]->index_sid = MXF_MUX_INDEX_SID;
     cstorage->essence_container_data[0]->body_sid = 1;
   }
 
@@ -1086,6 +1154,255 @@ gst_mxf_mux_write_header_metadata (GstMXFMux * mux)
   return ret;
 }
 
+static GstFlowReturn
+gst_mxf_mux_create_index_table_segments (GstMXFMux * mux, GList ** index,
+    guint64 * index_byte_count)
+{
+  GList *buffers = NULL;
+  guint i = 0;
+
+  *index = NULL;
+  *index_byte_count = 0;
+
+  while (i < mux->index_entries->len) {
+    MXFIndexTableSegment segment;
+    GstBuffer *buf;
+
+    memset (&segment, 0, sizeof (MXFIndexTableSegment));
+    mxf_uuid_init (&segment.instance_id, mux->metadata);
+    memcpy (&segment.index_edit_rate, &mux->min_edit_rate,
+        sizeof (MXFFraction));
+    segment.index_start_position = mux->index_start_position + i;
+    segment.n_index_entries =
+        MIN (mux->index_entries->len - i, MXF_MUX_MAX_INDEX_ENTRIES);
+    segment.index_duration = segment.n_index_entries;
+    segment.index_sid = MXF_MUX_INDEX_SID;
+    segment.body_sid =
+        mux->preface->content_storage->essence_container_data[0]->body_sid;
+    segment.index_entries =
+        &g_array_index (mux->index_entries, MXFIndexEntry, i);
+
+    buf = mxf_index_table_segment_to_buffer (&segment);
+    if (buf == NULL) {
+      GST_ERROR_OBJECT (mux, "Failed creating index table segment for %u "
+          "entries", segment.n_index_entries);
+      g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+      g_list_free (buffers);
+      *index_byte_count = 0;
+      return GST_FLOW_ERROR;
+    }
+    *index_byte_count += GST_BUFFER_SIZE (buf);
+    buffers = g_list_prepend (buffers, buf);
+
+    i += segment.n_index_entries;
+  }
+
+  GST_DEBUG_OBJECT (mux, "Created %u index table segments for %u edit units "
+      "starting at %" G_GUINT64_FORMAT, g_list_length (buffers),
+      mux->index_entries->len, mux->index_start_position);
+
+  mux->index_start_position += mux->index_entries->len;
+  g_array_set_size (mux->index_entries, 0);
+
+  *index = g_list_reverse (buffers);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_mxf_mux_push_buffers (GstMXFMux * mux, GList * buffers)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GList *l;
+
+  for (l = buffers; l; l = l->next) {
+    GstBuffer *buf = l->data;
+
+    l->data = NULL;
+    if ((ret = gst_mxf_mux_push (mux, buf)) != GST_FLOW_OK) {
+      GST_ERROR_OBJECT (mux, "Failed pushing buffer: %s",
+          gst_flow_get_name (ret));
+      g_list_foreach (l, (GFunc) gst_mini_object_unref, NULL);
+      break;
+    }
+  }
+
+  g_list_free (buffers);
+
+  return ret;
+}
+
+static void
+gst_mxf_mux_update_durations (GstMXFMux * mux)
+{
+  GSList *l;
+
+  /* Update essence track durations */
+  for (l = mux->collect->data; l; l = l->next) {
+    GstMXFMuxPad *cpad = l->data;
+    guint i;
+
+    /* Update durations */
+    cpad->source_track->parent.sequence->duration = cpad->pos;
+    MXF_METADATA_SOURCE_CLIP (cpad->source_track->parent.
+        sequence->structural_components[0])->parent.duration = cpad->pos;
+    for (i = 0; i < mux->preface->content_storage->packages[0]->n_tracks; i++) {
+      MXFMetadataTimelineTrack *track;
+
+      if (!MXF_IS_METADATA_TIMELINE_TRACK (mux->preface->
+              content_storage->packages[0]->tracks[i])
+          || !MXF_IS_METADATA_SOURCE_CLIP (mux->preface->
+              content_storage->packages[0]->tracks[i]->sequence->
+              structural_components[0]))
+        continue;
+
+      track =
+          MXF_METADATA_TIMELINE_TRACK (mux->preface->
+          content_storage->packages[0]->tracks[i]);
+      if (MXF_METADATA_SOURCE_CLIP (track->parent.
+              sequence->structural_components[0])->source_track_id ==
+          cpad->source_track->parent.track_id) {
+        track->parent.sequence->structural_components[0]->duration = cpad->pos;
+        track->parent.sequence->duration = cpad->pos;
+      }
+    }
+  }
+
+  /* Update timecode track duration */
+  {
+    MXFMetadataTimelineTrack *track =
+        MXF_METADATA_TIMELINE_TRACK (mux->preface->
+        content_storage->packages[0]->tracks[0]);
+    MXFMetadataSequence *sequence = track->parent.sequence;
+    MXFMetadataTimecodeComponent *component =
+        MXF_METADATA_TIMECODE_COMPONENT (sequence->structural_components[0]);
+
+    sequence->duration = mux->last_gc_position;
+    component->parent.duration = mux->last_gc_position;
+  }
+}
+
+/* Starts a new body partition, with a copy of the header metadata if
+ * @with_metadata is set */
+static GstFlowReturn
+gst_mxf_mux_write_body_partition (GstMXFMux * mux, gboolean with_metadata)
+{
+  GstBuffer *buf;
+  GList *index;
+  guint64 index_byte_count;
+  MXFRandomIndexPackEntry entry;
+  GstFlowReturn ret;
+
+  /* The index table segments of the previous body partition are
+   * written into the new one, after its header metadata */
+  ret = gst_mxf_mux_create_index_table_segments (mux, &index,
+      &index_byte_count);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  mux->partition.type = MXF_PARTITION_PACK_BODY;
+  mux->partition.prev_partition = mux->partition.this_partition;
+  mux->partition.this_partition = mux->offset;
+  mux->partition.footer_partition = 0;
+  mux->partition.header_byte_count = 0;
+  mux->partition.index_byte_count = index_byte_count;
+  mux->partition.index_sid = index ? MXF_MUX_INDEX_SID : 0;
+  mux->partition.body_offset = mux->essence_offset;
+  mux->partition.body_sid =
+      mux->preface->content_storage->essence_container_data[0]->body_sid;
+
+  GST_DEBUG_OBJECT (mux, "Writing body partition at offset %" G_GUINT64_FORMAT
+      ", body offset %" G_GUINT64_FORMAT, mux->partition.this_partition,
+      mux->partition.body_offset);
+
+  entry.offset = mux->partition.this_partition;
+  entry.body_sid = mux->partition.body_sid;
+  g_array_append_val (mux->rip, entry);
+
+  if (with_metadata) {
+    gst_mxf_mux_update_durations (mux);
+    mux->header_position = mux->last_gc_position;
+    ret = gst_mxf_mux_write_header_metadata (mux);
+  } else {
+    buf = mxf_partition_pack_to_buffer (&mux->partition);
+    ret = gst_mxf_mux_push (mux, buf);
+  }
+
+  if (ret != GST_FLOW_OK) {
+    g_list_foreach (index, (GFunc) gst_mini_object_unref, NULL);
+    g_list_free (index);
+    return ret;
+  }
+
+  return gst_mxf_mux_push_buffers (mux, index);
+}
+
+/* Time from @position to the current content package */
+static GstClockTime
+gst_mxf_mux_time_since (GstMXFMux * mux, guint64 position)
+{
+  return gst_util_uint64_scale ((mux->last_gc_position - position) *
+      GST_SECOND, mux->min_edit_rate.d, mux->min_edit_rate.n);
+}
+
+/* Called for every essence element before it is written. The first element
+ * of each content package gets an index entry and, if the partition or the
+ * header interval is over, starts a new body partition. The random access
+ * flag of the entry is the one of the picture element of the content
+ * package */
+static GstFlowReturn
+gst_mxf_mux_add_index_entry (GstMXFMux * mux, GstMXFMuxPad * cpad,
+    GstBuffer * essence)
+{
+  MXFIndexEntry entry;
+  guint64 position = mux->index_start_position + mux->index_entries->len;
+  gboolean picture =
+      MXF_IS_METADATA_GENERIC_PICTURE_ESSENCE_DESCRIPTOR (cpad->descriptor);
+  guint8 flags =
+      GST_BUFFER_FLAG_IS_SET (essence, GST_BUFFER_FLAG_DELTA_UNIT) ? 0x00 :
+      0x80;
+
+  if (mux->last_gc_position < position) {
+    /* The entry of this content package was added by an earlier element */
+    if (picture && mux->index_entries->len > 0)
+      g_array_index (mux->index_entries, MXFIndexEntry,
+          mux->index_entries->len - 1).flags = flags;
+    return GST_FLOW_OK;
+  }
+
+  if (mux->index_entries->len > 0) {
+    gboolean new_partition = mux->partition_interval > 0 &&
+        gst_mxf_mux_time_since (mux, mux->index_start_position) >=
+        mux->partition_interval;
+    gboolean new_header = mux->header_interval > 0 &&
+        gst_mxf_mux_time_since (mux, mux->header_position) >=
+        mux->header_interval;
+
+    if (new_partition || new_header) {
+      GstFlowReturn ret;
+
+      ret = gst_mxf_mux_write_body_partition (mux, new_header);
+      if (ret != GST_FLOW_OK)
+        return ret;
+    }
+  }
+
+  memset (&entry, 0, sizeof (MXFIndexEntry));
+  entry.stream_offset = mux->essence_offset;
+
+  /* Content packages without any element get empty entries */
+  for (position = mux->index_start_position + mux->index_entries->len;
+      position < mux->last_gc_position; position++)
+    g_array_append_val (mux->index_entries, entry);
+
+  /* Random access flag, SMPTE 377M 10.2.3. Content packages without
+   * picture element are always random access points */
+  entry.flags = picture ? flags : 0x80;
+  g_array_append_val (mux->index_entries, entry);
+
+  return GST_FLOW_OK;
+}
+
 static const guint8 _gc_essence_element_ul[] = {
   0x06, 0x0e, 0x2b, 0x34, 0x01, 0x02, 0x01, 0x00,
   0x0d, 0x01, 0x03, 0x01, 0x00, 0x00, 0x00, 0x00
@@ -1099,6 +1416,7 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * cpad)
   GstBuffer *packet;
   GstFlowReturn ret = GST_FLOW_OK;
   guint8 slen, ber[9];
+  guint size;
   gboolean flush = ((cpad->collect.state & GST_COLLECT_PADS_STATE_EOS)
       && !cpad->have_complete_edit_unit && cpad->collect.buffer == NULL);
 
@@ -1151,17 +1469,27 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * cpad)
   memcpy (&GST_BUFFER_DATA (packet)[16], ber, slen);
   memcpy (&GST_BUFFER_DATA (packet)[16 + slen], GST_BUFFER_DATA (buf),
       GST_BUFFER_SIZE (buf));
+
+  ret = gst_mxf_mux_add_index_entry (mux, cpad, buf);
   gst_buffer_unref (buf);
+  if (ret != GST_FLOW_OK) {
+    GST_ERROR_OBJECT (mux, "Failed writing body partition, reason %s",
+        gst_flow_get_name (ret));
+    gst_buffer_unref (packet);
+    return ret;
+  }
 
   GST_DEBUG_OBJECT (cpad->collect.pad, "Pushing buffer of size %u for track %u",
       GST_BUFFER_SIZE (packet), cpad->source_track->parent.track_id);
 
+  size = GST_BUFFER_SIZE (packet);
   if ((ret = gst_mxf_mux_push (mux, packet)) != GST_FLOW_OK) {
     GST_ERROR_OBJECT (cpad->collect.pad,
         "Failed pushing buffer for track %u, reason %s",
         cpad->source_track->parent.track_id, gst_flow_get_name (ret));
     return ret;
   }
+  mux->essence_offset += size;
 
   cpad->pos++;
   cpad->last_timestamp =
@@ -1171,26 +1499,6 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * cpad)
   return ret;
 }
 
-static GstFlowReturn
-gst_mxf_mux_write_body_partition (GstMXFMux * mux)
-{
-  GstBuffer *buf;
-
-  mux->partition.type = MXF_PARTITION_PACK_BODY;
-  mux->partition.this_partition = mux->offset;
-  mux->partition.prev_partition = 0;
-  mux->partition.footer_partition = 0;
-  mux->partition.header_byte_count = 0;
-  mux->partition.index_byte_count = 0;
-  mux->partition.index_sid = 0;
-  mux->partition.body_offset = 0;
-  mux->partition.body_sid =
-      mux->preface->content_storage->essence_container_data[0]->body_sid;
-
-  buf = mxf_partition_pack_to_buffer (&mux->partition);
-  return gst_mxf_mux_push (mux, buf);
-}
-
 static GstFlowReturn
 gst_mxf_mux_handle_eos (GstMXFMux * mux)
 {
@@ -1239,58 +1547,21 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
       gst_util_uint64_scale (mux->last_gc_position * GST_SECOND,
       mux->min_edit_rate.d, mux->min_edit_rate.n);
 
-  /* Update essence track durations */
-  for (l = mux->collect->data; l; l = l->next) {
-    GstMXFMuxPad *cpad = l->data;
-    guint i;
-
-    /* Update durations */
-    cpad->source_track->parent.sequence->duration = cpad->pos;
-    MXF_METADATA_SOURCE_CLIP (cpad->source_track->parent.
-        sequence->structural_components[0])->parent.duration = cpad->pos;
-    for (i = 0; i < mux->preface->content_storage->packages[0]->n_tracks; i++) {
-      MXFMetadataTimelineTrack *track;
-
-      if (!MXF_IS_METADATA_TIMELINE_TRACK (mux->preface->
-              content_storage->packages[0]->tracks[i])
-          || !MXF_IS_METADATA_SOURCE_CLIP (mux->preface->
-              content_storage->packages[0]->tracks[i]->sequence->
-              structural_components[0]))
-        continue;
-
-      track =
-          MXF_METADATA_TIMELINE_TRACK (mux->preface->
-          content_storage->packages[0]->tracks[i]);
-      if (MXF_METADATA_SOURCE_CLIP (track->parent.
-              sequence->structural_components[0])->source_track_id ==
-          cpad->source_track->parent.track_id) {
-        track->parent.sequence->structural_components[0]->duration = cpad->pos;
-        track->parent.sequence->duration = cpad->pos;
-      }
-    }
-  }
-
-  /* Update timecode track duration */
-  {
-    MXFMetadataTimelineTrack *track =
-        MXF_METADATA_TIMELINE_TRACK (mux->preface->
-        content_storage->packages[0]->tracks[0]);
-    MXFMetadataSequence *sequence = track->parent.sequence;
-    MXFMetadataTimecodeComponent *component =
-        MXF_METADATA_TIMECODE_COMPONENT (sequence->structural_components[0]);
-
-    sequence->duration = mux->last_gc_position;
-    component->parent.duration = mux->last_gc_position;
-  }
+  gst_mxf_mux_update_durations (mux);
 
   {
     guint64 body_partition = mux->partition.this_partition;
-    guint32 body_sid = mux->partition.body_sid;
     guint64 footer_partition = mux->offset;
-    GArray *rip;
+    guint64 index_byte_count;
+    GList *index;
     GstFlowReturn ret;
     MXFRandomIndexPackEntry entry;
 
+    ret = gst_mxf_mux_create_index_table_segments (mux, &index,
+        &index_byte_count);
+    if (ret != GST_FLOW_OK)
+      return ret;
+
     mux->partition.type = MXF_PARTITION_PACK_FOOTER;
     mux->partition.closed = TRUE;
     mux->partition.complete = TRUE;
@@ -1298,29 +1569,27 @@ gst_mxf_mux_handle_eos (GstMXFMux * mux)
     mux->partition.prev_partition = body_partition;
     mux->partition.footer_partition = mux->offset;
     mux->partition.header_byte_count = 0;
-    mux->partition.index_byte_count = 0;
-    mux->partition.index_sid = 0;
+    mux->partition.index_byte_count = index_byte_count;
+    mux->partition.index_sid = index ? MXF_MUX_INDEX_SID : 0;
     mux->partition.body_offset = 0;
     mux->partition.body_sid = 0;
 
-    gst_mxf_mux_write_header_metadata (mux);
+    ret = gst_mxf_mux_write_header_metadata (mux);
+    if (ret == GST_FLOW_OK) {
+      ret = gst_mxf_mux_push_buffers (mux, index);
+    } else {
+      g_list_foreach (index, (GFunc) gst_mini_object_unref, NULL);
+      g_list_free (index);
+    }
 
-    rip = g_array_sized_new (FALSE, FALSE, sizeof (MXFRandomIndexPackEntry), 3);
-    entry.offset = 0;
-    entry.body_sid = 0;
-    g_array_append_val (rip, entry);
-    entry.offset = body_partition;
-    entry.body_sid = body_sid;
-    g_array_append_val (rip, entry);
     entry.offset = footer_partition;
     entry.body_sid = 0;
-    g_array_append_val (rip, entry);
+    g_array_append_val (mux->rip, entry);
 
-    packet = mxf_random_index_pack_to_buffer (rip);
+    packet = mxf_random_index_pack_to_buffer (mux->rip);
     if ((ret = gst_mxf_mux_push (mux, packet)) != GST_FLOW_OK) {
       GST_ERROR_OBJECT (mux, "Failed pushing random index pack");
     }
-    g_array_free (rip, TRUE);
 
     /* Rewrite header partition with updated values */
     if (gst_pad_push_event (mux->srcpad,
@@ -1407,6 +1676,14 @@ gst_mxf_mux_collected (GstCollectPads * pads, gpointer user_data)
       ret = GST_FLOW_ERROR;
     }
 
+    if (ret == GST_FLOW_OK) {
+      MXFRandomIndexPackEntry entry;
+
+      entry.offset = 0;
+      entry.body_sid = 0;
+      g_array_append_val (mux->rip, entry);
+    }
+
     if (ret != GST_FLOW_OK)
       goto error;
 
@@ -1414,7 +1691,7 @@ gst_mxf_mux_collected (GstCollectPads * pads, gpointer user_data)
     mux->collect->data = g_slist_sort (mux->collect->data, _sort_mux_pads);
 
     /* Write body partition */
-    ret = gst_mxf_mux_write_body_partition (mux);
+    ret = gst_mxf_mux_write_body_partition (mux, FALSE);
     if (ret != GST_FLOW_OK)
       goto error;
     mux->state = GST_MXF_MUX_STATE_DATA;
@@ -92,7 +92,21 @@ typedef struct _GstMXFMux {
   guint64 last_gc_position;
   GstClockTime last_gc_timestamp;
 
+  /* Essence bytes written so far and the index entries of the
+   * current body partition */
+  guint64 essence_offset;
+  guint64 index_start_position;
+  GArray *index_entries;
+  GArray *rip;
+
+  /* Position of the last copy of the header metadata */
+  guint64 header_position;
+
   gchar *application;
+
+  /* properties */
+  guint64 partition_interval;
+  guint64 header_interval;
 } GstMXFMux;
 
 typedef struct _GstMXFMuxClass {
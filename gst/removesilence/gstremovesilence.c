@@ -23,6 +23,15 @@
  *
  * Removes all silence periods from an audio stream, dropping silence buffers.
  *
+ * In the "block" #GstRemoveSilence:mode every buffer is classified in 10 ms
+ * blocks by their energy and zero crossings, and optionally the flatness of
+ * their spectrum. Zero crossings on half or more of the samples only make a
+ * block silence when it is less than 10 dB above the
+ * #GstRemoveSilence:threshold, so that loud fricatives are kept. Silence is
+ * cut out of the buffers at block boundaries instead of dropping whole
+ * buffers. A buffer with silence between voice is split into one buffer
+ * per stretch of voice, each with the timestamp of its first sample.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -38,6 +47,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
 #include <gst/audio/audio.h>
+#include <string.h>
 
 #include "gstremovesilence.h"
 
@@ -45,6 +55,9 @@
 GST_DEBUG_CATEGORY_STATIC (gst_remove_silence_debug);
 #define GST_CAT_DEFAULT gst_remove_silence_debug
 #define DEFAULT_VAD_HYSTERESIS  480     /* 60 mseg */
+#define DEFAULT_MODE            GST_REMOVE_SILENCE_MODE_POWER
+#define DEFAULT_THRESHOLD       -60
+#define DEFAULT_SPECTRAL_FLATNESS FALSE
 
 /* Filter signals and args */
 enum
@@ -57,9 +70,32 @@ enum
 {
   PROP_0,
   PROP_REMOVE,
-  PROP_HYSTERESIS
+  PROP_HYSTERESIS,
+  PROP_MODE,
+  PROP_THRESHOLD,
+  PROP_SPECTRAL_FLATNESS
 };
 
+#define GST_TYPE_REMOVE_SILENCE_MODE (gst_remove_silence_mode_get_type ())
+static GType
+gst_remove_silence_mode_get_type (void)
+{
+  static GType gtype = 0;
+
+  if (gtype == 0) {
+    static const GEnumValue values[] = {
+      {GST_REMOVE_SILENCE_MODE_POWER,
+          "Smoothed power per buffer, drops whole buffers (default)", "power"},
+      {GST_REMOVE_SILENCE_MODE_BLOCK,
+          "Energy and zero crossings per block, cuts inside buffers", "block"},
+      {0, NULL, NULL}
+    };
+
+    gtype = g_enum_register_static ("GstRemoveSilenceMode", values);
+  }
+  return gtype;
+}
+
 
 static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -90,6 +126,8 @@ static void gst_remove_silence_set_property (GObject * object, guint prop_id,
 static void gst_remove_silence_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 
+static gboolean gst_remove_silence_set_caps (GstBaseTransform * trans,
+    GstCaps * incaps, GstCaps * outcaps);
 static GstFlowReturn gst_remove_silence_transform_ip (GstBaseTransform * base,
     GstBuffer * buf);
 static void gst_remove_silence_finalize (GObject * obj);
@@ -122,6 +160,23 @@ gst_remove_silence_class_init (GstRemoveSilenceClass * klass)
           "Set the hysteresis (on samples) used on the internal VAD",
           1, G_MAXUINT64, DEFAULT_VAD_HYSTERESIS, G_PARAM_READWRITE));
 
+  g_object_class_install_property (gobject_class, PROP_MODE,
+      g_param_spec_enum ("mode", "Mode",
+          "How silence is detected and removed", GST_TYPE_REMOVE_SILENCE_MODE,
+          DEFAULT_MODE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_THRESHOLD,
+      g_param_spec_int ("threshold", "Threshold",
+          "Level (in dB) below which blocks are silence in block mode",
+          -120, 0, DEFAULT_THRESHOLD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SPECTRAL_FLATNESS,
+      g_param_spec_boolean ("spectral-flatness", "Spectral flatness",
+          "Also take blocks with a noise-like spectrum for silence in block "
+          "mode", DEFAULT_SPECTRAL_FLATNESS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_details_simple (gstelement_class,
       "RemoveSilence",
       "Filter/Effect/Audio",
@@ -134,6 +189,8 @@ gst_remove_silence_class_init (GstRemoveSilenceClass * klass)
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&sink_template));
 
+  GST_BASE_TRANSFORM_CLASS (klass)->set_caps =
+      GST_DEBUG_FUNCPTR (gst_remove_silence_set_caps);
   GST_BASE_TRANSFORM_CLASS (klass)->transform_ip =
       GST_DEBUG_FUNCPTR (gst_remove_silence_transform_ip);
 }
@@ -148,6 +205,9 @@ gst_remove_silence_init (GstRemoveSilence * filter)
 {
   filter->vad = vad_new (DEFAULT_VAD_HYSTERESIS);
   filter->remove = FALSE;
+  filter->mode = DEFAULT_MODE;
+  filter->rate = 0;
+  filter->block_size = 160;
 
   if (!filter->vad) {
     GST_DEBUG ("Error initializing VAD !!");
@@ -191,6 +251,15 @@ gst_remove_silence_set_property (GObject * object, guint prop_id,
     case PROP_HYSTERESIS:
       vad_set_hysteresis (filter->vad, g_value_get_uint64 (value));
       break;
+    case PROP_MODE:
+      filter->mode = g_value_get_enum (value);
+      break;
+    case PROP_THRESHOLD:
+      vad_set_threshold (filter->vad, g_value_get_int (value));
+      break;
+    case PROP_SPECTRAL_FLATNESS:
+      vad_set_spectral_flatness (filter->vad, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -210,12 +279,130 @@ gst_remove_silence_get_property (GObject * object, guint prop_id,
     case PROP_HYSTERESIS:
       g_value_set_uint64 (value, vad_get_hysteresis (filter->vad));
       break;
+    case PROP_MODE:
+      g_value_set_enum (value, filter->mode);
+      break;
+    case PROP_THRESHOLD:
+      g_value_set_int (value, vad_get_threshold (filter->vad));
+      break;
+    case PROP_SPECTRAL_FLATNESS:
+      g_value_set_boolean (value, vad_get_spectral_flatness (filter->vad));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static gboolean
+gst_remove_silence_set_caps (GstBaseTransform * trans, GstCaps * incaps,
+    GstCaps * outcaps)
+{
+  GstRemoveSilence *filter = GST_REMOVE_SILENCE (trans);
+  GstStructure *structure = gst_caps_get_structure (incaps, 0);
+
+  if (!gst_structure_get_int (structure, "rate", &filter->rate))
+    return FALSE;
+
+  /* 10 ms blocks */
+  filter->block_size = MAX (filter->rate / 100, 1);
+
+  return TRUE;
+}
+
+/* sets the timestamp and duration of @buf, which holds @len samples from
+ * sample @offset of a buffer that started at @timestamp */
+static void
+gst_remove_silence_set_times (GstRemoveSilence * filter, GstBuffer * buf,
+    GstClockTime timestamp, gint offset, gint len)
+{
+  if (!GST_CLOCK_TIME_IS_VALID (timestamp) || filter->rate <= 0)
+    return;
+
+  GST_BUFFER_TIMESTAMP (buf) = timestamp +
+      gst_util_uint64_scale_int (offset, GST_SECOND, filter->rate);
+  GST_BUFFER_DURATION (buf) =
+      gst_util_uint64_scale_int (len, GST_SECOND, filter->rate);
+}
+
+/* classifies the buffer in blocks and, when removing, splits it into one
+ * buffer per run of voice blocks. All runs but the last are pushed from
+ * here, the last one is returned in @inbuf. Every part keeps the
+ * timestamp of its first sample, so the removed silence leaves gaps in the
+ * timestamps just like the buffers dropped in power mode. */
+static GstFlowReturn
+gst_remove_silence_transform_blocks (GstRemoveSilence * filter,
+    GstBuffer * inbuf)
+{
+  GstMapInfo map;
+  gint16 *data;
+  gint n_samples, offset, len, kept = 0;
+  gint run_start = -1, run_len = 0;
+  GstClockTime timestamp;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  if (!gst_buffer_map (inbuf, &map, GST_MAP_READ))
+    return GST_FLOW_ERROR;
+
+  data = (gint16 *) map.data;
+  n_samples = map.size / sizeof (gint16);
+  timestamp = GST_BUFFER_TIMESTAMP (inbuf);
+
+  for (offset = 0; offset < n_samples; offset += len) {
+    len = MIN (filter->block_size, n_samples - offset);
+
+    if (vad_update_block (filter->vad, data + offset, len) != VAD_SILENCE) {
+      if (run_start < 0)
+        run_start = offset;
+      run_len += len;
+      kept += len;
+      continue;
+    }
+
+    if (!filter->remove || run_start < 0)
+      continue;
+
+    /* silence ends a run of voice, push it on its own */
+    if (ret == GST_FLOW_OK) {
+      GstBuffer *part;
+
+      GST_DEBUG ("Pushing %d samples of voice before silence", run_len);
+
+      part = gst_buffer_copy_region (inbuf, GST_BUFFER_COPY_ALL,
+          run_start * sizeof (gint16), run_len * sizeof (gint16));
+      gst_remove_silence_set_times (filter, part, timestamp, run_start,
+          run_len);
+      /* only the first part continues a discontinuity */
+      GST_BUFFER_FLAG_UNSET (inbuf, GST_BUFFER_FLAG_DISCONT);
+      ret = gst_pad_push (GST_BASE_TRANSFORM_SRC_PAD (filter), part);
+    }
+    run_start = -1;
+    run_len = 0;
+  }
+  gst_buffer_unmap (inbuf, &map);
+
+  GST_LOG_OBJECT (filter, "%d of %d samples are voice", kept, n_samples);
+
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  if (!filter->remove || kept == n_samples)
+    return GST_FLOW_OK;
+
+  if (run_start < 0) {
+    GST_DEBUG ("Removing silence");
+    return GST_BASE_TRANSFORM_FLOW_DROPPED;
+  }
+
+  GST_DEBUG ("Removing %d samples of silence", n_samples - kept);
+
+  gst_buffer_resize (inbuf, run_start * sizeof (gint16),
+      run_len * sizeof (gint16));
+  gst_remove_silence_set_times (filter, inbuf, timestamp, run_start, run_len);
+
+  return GST_FLOW_OK;
+}
+
 static GstFlowReturn
 gst_remove_silence_transform_ip (GstBaseTransform * trans, GstBuffer * inbuf)
 {
@@ -225,6 +412,9 @@ gst_remove_silence_transform_ip (GstBaseTransform * trans, GstBuffer * inbuf)
 
   filter = GST_REMOVE_SILENCE (trans);
 
+  if (filter->mode == GST_REMOVE_SILENCE_MODE_BLOCK)
+    return gst_remove_silence_transform_blocks (filter, inbuf);
+
   gst_buffer_map (inbuf, &map, GST_MAP_READ);
   frame_type =
       vad_update (filter->vad, (gint16 *) map.data, map.size / sizeof (gint16));
@@ -39,10 +39,18 @@ G_BEGIN_DECLS
 #define GST_IS_REMOVESILENCE_CLASS(klass) \
   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_REMOVE_SILENCE))
 
+typedef enum {
+  GST_REMOVE_SILENCE_MODE_POWER,
+  GST_REMOVE_SILENCE_MODE_BLOCK
+} GstRemoveSilenceMode;
+
 typedef struct _GstRemoveSilence {
   GstBaseTransform parent;
   VADFilter* vad;
   gboolean remove;
+  GstRemoveSilenceMode mode;
+  gint rate;
+  gint block_size;
 } GstRemoveSilence;
 
 typedef struct _GstRemoveSilenceClass {
@@ -22,7 +22,9 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <glib.h>
+#include <gst/fft/gstfftf32.h>
 #include "vad_private.h"
 
 #define VAD_POWER_ALPHA     0x0800      /* Q16 */
@@ -30,6 +32,15 @@
 #define VAD_ZCR_THRESHOLD   0
 #define VAD_BUFFER_SIZE     256
 
+/* blocks whose spectrum is flatter than this are taken for noise; white
+ * noise is around 0.56, voiced speech well below 0.3 */
+#define VAD_FLATNESS_THRESHOLD 0.45
+
+/* the zero crossing rate only decides for blocks less than this much (10 dB)
+ * above the threshold; fricatives cross zero on most samples too, but are
+ * louder than the noise the rule is meant for */
+#define VAD_ZCR_MAX_ENERGY  10.0
+
 
 union pgen
 {
@@ -60,30 +71,50 @@ struct _vad_s
   guint64 vad_samples;
   guint64 vad_power;
   long vad_zcr;
+
+  /* block mode */
+  gint threshold;               /* dB below full scale */
+  gdouble block_threshold;      /* mean square for threshold */
+  gboolean flatness;
+  gint16 last_sample;
+
+  GstFFTF32 *fft;
+  gint fft_len;
+  gfloat *fft_in;
+  GstFFTF32Complex *fft_out;
 };
 
 VADFilter *
 vad_new (guint64 hysteresis)
 {
-  VADFilter *vad = malloc (sizeof (VADFilter));
+  VADFilter *vad = calloc (1, sizeof (VADFilter));
   vad_reset (vad);
   vad->hysteresis = hysteresis;
+  vad_set_threshold (vad, -60);
   return vad;
 }
 
 void
 vad_reset (VADFilter * vad)
 {
-  memset (vad, 0, sizeof (*vad));
+  memset (vad->vad_buffer, 0, sizeof (vad->vad_buffer));
   vad->cqueue.base.s = vad->vad_buffer;
   vad->cqueue.tail.a = vad->cqueue.head.a = 0;
   vad->cqueue.size = VAD_BUFFER_SIZE;
   vad->vad_state = VAD_SILENCE;
+  vad->vad_samples = 0;
+  vad->vad_power = 0;
+  vad->vad_zcr = 0;
+  vad->last_sample = 0;
 }
 
 void
 vad_destroy (VADFilter * p)
 {
+  if (p->fft)
+    gst_fft_f32_free (p->fft);
+  g_free (p->fft_in);
+  g_free (p->fft_out);
   free (p);
 }
 
@@ -99,6 +130,54 @@ vad_get_hysteresis (struct _vad_s *p)
   return p->hysteresis;
 }
 
+void
+vad_set_threshold (VADFilter * p, gint threshold)
+{
+  p->threshold = threshold;
+  p->block_threshold = 32768.0 * 32768.0 * pow (10.0, threshold / 10.0);
+}
+
+gint
+vad_get_threshold (VADFilter * p)
+{
+  return p->threshold;
+}
+
+void
+vad_set_spectral_flatness (VADFilter * p, gboolean flatness)
+{
+  p->flatness = flatness;
+}
+
+gboolean
+vad_get_spectral_flatness (VADFilter * p)
+{
+  return p->flatness;
+}
+
+/* applies the hysteresis to the decision for the next @len samples */
+static gint
+vad_hysteresis (struct _vad_s *p, gint frame_type, gint len)
+{
+  if (p->vad_state != frame_type) {
+    /* Voice to silence transition */
+    if (p->vad_state == VAD_VOICE) {
+      p->vad_samples += len;
+      if (p->vad_samples >= p->hysteresis) {
+        p->vad_state = frame_type;
+        p->vad_samples = 0;
+      }
+    } else {
+      p->vad_state = frame_type;
+      p->vad_samples = 0;
+    }
+  } else {
+    p->vad_samples = 0;
+  }
+
+  return p->vad_state;
+}
+
 gint
 vad_update (struct _vad_s * p, gint16 * data, gint len)
 {
@@ -132,21 +211,100 @@ vad_update (struct _vad_s * p, gint16 * data, gint len)
   frame_type = (p->vad_power > VAD_POWER_THRESHOLD
       && p->vad_zcr < VAD_ZCR_THRESHOLD) ? VAD_VOICE : VAD_SILENCE;
 
-  if (p->vad_state != frame_type) {
-    /* Voice to silence transition */
-    if (p->vad_state == VAD_VOICE) {
-      p->vad_samples += len;
-      if (p->vad_samples >= p->hysteresis) {
-        p->vad_state = frame_type;
-        p->vad_samples = 0;
-      }
-    } else {
-      p->vad_state = frame_type;
-      p->vad_samples = 0;
-    }
-  } else {
-    p->vad_samples = 0;
+  return vad_hysteresis (p, frame_type, len);
+}
+
+/* Energy and sign changes of a block. Both are branch-free loops over
+ * the samples that the compiler can vectorize. */
+static guint64
+vad_block_energy (const gint16 * data, gint len)
+{
+  guint64 energy = 0;
+  gint i;
+
+  for (i = 0; i < len; i++)
+    energy += (guint32) ((gint32) data[i] * data[i]);
+
+  return energy;
+}
+
+static gint
+vad_block_crossings (const gint16 * data, gint len, gint16 previous)
+{
+  gint crossings = ((previous ^ data[0]) < 0);
+  gint i;
+
+  for (i = 1; i < len; i++)
+    crossings += ((data[i - 1] ^ data[i]) < 0);
+
+  return crossings;
+}
+
+/* ratio of the geometric to the arithmetic mean of the power spectrum */
+static gdouble
+vad_block_flatness (struct _vad_s *p, const gint16 * data, gint len)
+{
+  gdouble log_sum = 0.0, sum = 0.0, power;
+  gint i, n_bins;
+
+  if (!p->fft || p->fft_len < len) {
+    gint fft_len = gst_fft_next_fast_length (len);
+
+    /* the real FFT needs an even length */
+    while (fft_len & 1)
+      fft_len = gst_fft_next_fast_length (fft_len + 1);
+
+    if (p->fft)
+      gst_fft_f32_free (p->fft);
+    g_free (p->fft_in);
+    g_free (p->fft_out);
+    p->fft = gst_fft_f32_new (fft_len, FALSE);
+    p->fft_len = fft_len;
+    p->fft_in = g_new (gfloat, fft_len);
+    p->fft_out = g_new (GstFFTF32Complex, fft_len / 2 + 1);
   }
 
-  return p->vad_state;
+  for (i = 0; i < len; i++)
+    p->fft_in[i] = data[i];
+  for (; i < p->fft_len; i++)
+    p->fft_in[i] = 0.0;
+
+  gst_fft_f32_window (p->fft, p->fft_in, GST_FFT_WINDOW_HAMMING);
+  gst_fft_f32_fft (p->fft, p->fft_in, p->fft_out);
+
+  /* leave out DC and Nyquist */
+  n_bins = p->fft_len / 2 - 1;
+  for (i = 1; i <= n_bins; i++) {
+    power = p->fft_out[i].r * p->fft_out[i].r +
+        p->fft_out[i].i * p->fft_out[i].i + 1e-3;
+    log_sum += log (power);
+    sum += power;
+  }
+
+  return exp (log_sum / n_bins) / (sum / n_bins);
+}
+
+gint
+vad_update_block (VADFilter * p, const gint16 * data, gint len)
+{
+  gint frame_type = VAD_SILENCE;
+  gdouble energy;
+
+  if (len <= 0)
+    return p->vad_state;
+
+  /* loud enough, and either clearly louder than the threshold or crossing
+   * zero on less than half of the samples, so not low-level noise; the
+   * spectral flatness rejects steady noise further */
+  energy = vad_block_energy (data, len);
+  if (energy > p->block_threshold * len
+      && (energy > VAD_ZCR_MAX_ENERGY * p->block_threshold * len
+          || 2 * vad_block_crossings (data, len, p->last_sample) < len)) {
+    if (!p->flatness
+        || vad_block_flatness (p, data, len) < VAD_FLATNESS_THRESHOLD)
+      frame_type = VAD_VOICE;
+  }
+  p->last_sample = data[len - 1];
+
+  return vad_hysteresis (p, frame_type, len);
 }
@@ -31,10 +31,20 @@ typedef struct _vad_s VADFilter;
 
 gint vad_update(VADFilter *p, gint16 *data, gint len);
 
+gint vad_update_block(VADFilter *p, const gint16 *data, gint len);
+
 void vad_set_hysteresis(VADFilter *p, guint64 hysteresis);
 
 guint64 vad_get_hysteresis(VADFilter *p);
 
+void vad_set_threshold(VADFilter *p, gint threshold);
+
+gint vad_get_threshold(VADFilter *p);
+
+void vad_set_spectral_flatness(VADFilter *p, gboolean flatness);
+
+gboolean vad_get_spectral_flatness(VADFilter *p);
+
 VADFilter* vad_new(guint64 hysteresis);
 
 void vad_reset(VADFilter *p);
@@ -53,7 +53,8 @@
  * for the best overlap position.  Scaletempo uses a statistical cross
  * correlation (roughly a dot-product).  Scaletempo consumes most of its CPU
  * cycles here. One can use the #GstScaletempo:search propery to tune how far
- * the algoritm looks.
+ * the algoritm looks. For long searches the correlation is computed for all
+ * positions at once with an FFT instead of one dot-product per position.
  * </para>
  * </refsect2>
  */
@@ -72,6 +73,7 @@
 #include <string.h>             /* for memset */
 
 #include "gstscaletempo.h"
+#include "gstscaletempocorr.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_scaletempo_debug);
 #define GST_CAT_DEFAULT gst_scaletempo_debug
@@ -149,6 +151,8 @@ typedef struct _GstScaletempoPrivate
   gpointer buf_pre_corr;
   gpointer table_window;
     guint (*best_overlap_offset) (GstScaletempo * scaletempo);
+  /* best overlap by fft cross correlation */
+  GstScaletempoCorrFFT corr_fft;
   /* gstreamer */
   gint64 segment_start;
   /* threads */
@@ -161,10 +165,8 @@ static guint
 best_overlap_offset_float (GstScaletempo * scaletempo)
 {
   GstScaletempoPrivate *p = GST_SCALETEMPO_GET_PRIVATE (scaletempo);
-  gfloat *pw, *po, *ppc, *search_start;
-  gfloat best_corr = G_MININT;
-  guint best_off = 0;
-  gint i, off;
+  gfloat *pw, *po, *ppc;
+  gint i;
 
   pw = p->table_window;
   po = p->buf_overlap;
@@ -174,22 +176,10 @@ best_overlap_offset_float (GstScaletempo * scaletempo)
     *ppc++ = *pw++ * *po++;
   }
 
-  search_start = (gfloat *) p->buf_queue + p->samples_per_frame;
-  for (off = 0; off < p->frames_search; off++) {
-    gfloat corr = 0;
-    gfloat *ps = search_start;
-    ppc = p->buf_pre_corr;
-    for (i = p->samples_per_frame; i < p->samples_overlap; i++) {
-      corr += *ppc++ * *ps++;
-    }
-    if (corr > best_corr) {
-      best_corr = corr;
-      best_off = off;
-    }
-    search_start += p->samples_per_frame;
-  }
-
-  return best_off * p->bytes_per_frame;
+  return gst_scaletempo_corr_float (p->buf_pre_corr,
+      (gfloat *) p->buf_queue + p->samples_per_frame,
+      p->samples_overlap - p->samples_per_frame, p->frames_search,
+      p->samples_per_frame) * p->bytes_per_frame;
 }
 
 /* buffer padding for loop optimization: sizeof(gint32) * (loop_size - 1) */
@@ -199,11 +189,8 @@ best_overlap_offset_s16 (GstScaletempo * scaletempo)
 {
   GstScaletempoPrivate *p = GST_SCALETEMPO_GET_PRIVATE (scaletempo);
   gint32 *pw, *ppc;
-  gint16 *po, *search_start;
-  gint64 best_corr = G_MININT64;
-  guint best_off = 0;
-  guint off;
-  glong i;
+  gint16 *po;
+  gint i;
 
   pw = p->table_window;
   po = p->buf_overlap;
@@ -213,29 +200,64 @@ best_overlap_offset_s16 (GstScaletempo * scaletempo)
     *ppc++ = (*pw++ * *po++) >> 15;
   }
 
-  search_start = (gint16 *) p->buf_queue + p->samples_per_frame;
-  for (off = 0; off < p->frames_search; off++) {
-    gint64 corr = 0;
-    gint16 *ps = search_start;
-    ppc = p->buf_pre_corr;
-    ppc += p->samples_overlap - p->samples_per_frame;
-    ps += p->samples_overlap - p->samples_per_frame;
-    i = -((glong) p->samples_overlap - (glong) p->samples_per_frame);
-    do {
-      corr += ppc[i + 0] * ps[i + 0];
-      corr += ppc[i + 1] * ps[i + 1];
-      corr += ppc[i + 2] * ps[i + 2];
-      corr += ppc[i + 3] * ps[i + 3];
-      i += 4;
-    } while (i < 0);
-    if (corr > best_corr) {
-      best_corr = corr;
-      best_off = off;
-    }
-    search_start += p->samples_per_frame;
+  return gst_scaletempo_corr_s16 (p->buf_pre_corr,
+      (gint16 *) p->buf_queue + p->samples_per_frame,
+      p->samples_overlap - p->samples_per_frame, p->frames_search,
+      p->samples_per_frame) * p->bytes_per_frame;
+}
+
+/* the same search as the dot products above, see gstscaletempocorr.h */
+static guint
+best_overlap_offset_fft (GstScaletempo * scaletempo)
+{
+  GstScaletempoPrivate *p = GST_SCALETEMPO_GET_PRIVATE (scaletempo);
+  gfloat *t = p->corr_fft.overlap;
+  gfloat *s = p->corr_fft.search;
+  guint n_pre_corr, n_search;
+  guint i;
+
+  n_pre_corr = p->samples_overlap - p->samples_per_frame;
+  n_search = p->frames_search * p->samples_per_frame + n_pre_corr;
+
+  if (p->use_int) {
+    gint32 *pw = p->table_window;
+    gint16 *po = (gint16 *) p->buf_overlap + p->samples_per_frame;
+    gint16 *ps = (gint16 *) p->buf_queue + p->samples_per_frame;
+
+    for (i = 0; i < n_pre_corr; i++)
+      t[i] = (pw[i] * po[i]) >> 15;
+    for (i = 0; i < n_search; i++)
+      s[i] = ps[i];
+  } else {
+    gfloat *pw = p->table_window;
+    gfloat *po = (gfloat *) p->buf_overlap + p->samples_per_frame;
+
+    for (i = 0; i < n_pre_corr; i++)
+      t[i] = pw[i] * po[i];
+    memcpy (s, (gfloat *) p->buf_queue + p->samples_per_frame,
+        n_search * sizeof (gfloat));
+  }
+
+  return gst_scaletempo_corr_fft (&p->corr_fft, n_pre_corr, n_search,
+      p->frames_search, p->samples_per_frame) * p->bytes_per_frame;
+}
+
+static gboolean
+setup_fft_correlation (GstScaletempoPrivate * p)
+{
+  guint n_pre_corr = p->samples_overlap - p->samples_per_frame;
+  guint n_search = p->frames_search * p->samples_per_frame + n_pre_corr;
+  guint len = gst_scaletempo_corr_fft_length (n_search);
+
+  if (!gst_scaletempo_corr_use_fft (p->use_int, n_pre_corr, p->frames_search,
+          len)) {
+    gst_scaletempo_corr_fft_free (&p->corr_fft);
+    return FALSE;
   }
 
-  return best_off * p->bytes_per_frame;
+  gst_scaletempo_corr_fft_init (&p->corr_fft, len);
+
+  return TRUE;
 }
 
 static void
@@ -366,6 +388,7 @@ reinit_buffers (GstScaletempo * scaletempo)
       (frames_overlap <= 1) ? 0 : p->ms_search * p->sample_rate / 1000.0;
   if (p->frames_search < 1) {   /* if no search */
     p->best_overlap_offset = NULL;
+    gst_scaletempo_corr_fft_free (&p->corr_fft);
   } else {
     guint bytes_pre_corr = (p->samples_overlap - p->samples_per_frame) * 4;     /* sizeof (gint32|gfloat) */
     p->buf_pre_corr =
@@ -395,6 +418,8 @@ reinit_buffers (GstScaletempo * scaletempo)
       }
       p->best_overlap_offset = best_overlap_offset_float;
     }
+    if (setup_fft_correlation (p))
+      p->best_overlap_offset = best_overlap_offset_fft;
   }
 
   new_size =
@@ -418,13 +443,13 @@ reinit_buffers (GstScaletempo * scaletempo)
   p->frames_stride_scaled = p->bytes_stride_scaled / p->bytes_per_frame;
 
   GST_DEBUG
-      ("%.3f scale, %.3f stride_in, %i stride_out, %i standing, %i overlap, %i search, %i queue, %s mode",
+      ("%.3f scale, %.3f stride_in, %i stride_out, %i standing, %i overlap, %i search, %i queue, %s mode, %u fft",
       p->scale, p->frames_stride_scaled,
       (gint) (p->bytes_stride / p->bytes_per_frame),
       (gint) (p->bytes_standing / p->bytes_per_frame),
       (gint) (p->bytes_overlap / p->bytes_per_frame), p->frames_search,
       (gint) (p->bytes_queue_max / p->bytes_per_frame),
-      (p->use_int ? "s16" : "float"));
+      (p->use_int ? "s16" : "float"), p->corr_fft.len);
 
   p->reinit_buffers = FALSE;
 }
@@ -600,6 +625,22 @@ gst_scaletempo_set_caps (GstBaseTransform * trans,
 
 
 /* GObject vmethod implementations */
+static void
+gst_scaletempo_finalize (GObject * object)
+{
+  GstScaletempo *scaletempo = GST_SCALETEMPO (object);
+  GstScaletempoPrivate *priv = GST_SCALETEMPO_GET_PRIVATE (scaletempo);
+
+  g_free (priv->buf_queue);
+  g_free (priv->buf_overlap);
+  g_free (priv->table_blend);
+  g_free (priv->buf_pre_corr);
+  g_free (priv->table_window);
+  gst_scaletempo_corr_fft_free (&priv->corr_fft);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_scaletempo_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec)
@@ -675,6 +716,7 @@ gst_scaletempo_class_init (GstScaletempoClass * klass)
 
   gobject_class->get_property = GST_DEBUG_FUNCPTR (gst_scaletempo_get_property);
   gobject_class->set_property = GST_DEBUG_FUNCPTR (gst_scaletempo_set_property);
+  gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_scaletempo_finalize);
 
   g_object_class_install_property (gobject_class, PROP_RATE,
       g_param_spec_double ("rate", "Playback Rate", "Current playback rate",
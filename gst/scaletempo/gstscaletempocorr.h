@@ -0,0 +1,214 @@
+/*
+ * GStreamer
+ * Copyright (C) 2008 Rov Juvano <rovjuvano@users.sourceforge.net>
+ *
+ * gstscaletempocorr.h: the best overlap search of scaletempo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_SCALETEMPO_CORR_H__
+#define __GST_SCALETEMPO_CORR_H__
+
+#include <glib.h>
+#include <string.h>
+#include <gst/fft/gstfftf32.h>
+
+G_BEGIN_DECLS
+
+/* The search looks for the offset, in whole frames below @frames_search, at
+ * which the @n samples of the windowed overlap @pre_corr correlate best with
+ * the samples of @search starting there. */
+
+/* one dot product per offset */
+static inline guint
+gst_scaletempo_corr_float (const gfloat * pre_corr, const gfloat * search,
+    guint n, guint frames_search, guint samples_per_frame)
+{
+  gfloat best_corr = G_MININT;
+  guint best_off = 0;
+  guint i, off;
+
+  for (off = 0; off < frames_search; off++) {
+    /* independent partial sums so that the compiler can vectorize */
+    gfloat corr0 = 0, corr1 = 0, corr2 = 0, corr3 = 0, corr;
+    const gfloat *ps = search + off * samples_per_frame;
+
+    for (i = 0; i + 3 < n; i += 4) {
+      corr0 += pre_corr[i + 0] * ps[i + 0];
+      corr1 += pre_corr[i + 1] * ps[i + 1];
+      corr2 += pre_corr[i + 2] * ps[i + 2];
+      corr3 += pre_corr[i + 3] * ps[i + 3];
+    }
+    for (; i < n; i++) {
+      corr0 += pre_corr[i] * ps[i];
+    }
+    corr = (corr0 + corr1) + (corr2 + corr3);
+    if (corr > best_corr) {
+      best_corr = corr;
+      best_off = off;
+    }
+  }
+
+  return best_off;
+}
+
+/* the same for S16. @pre_corr is padded with zeroes up to a multiple of four
+ * samples and @search can be read that far */
+static inline guint
+gst_scaletempo_corr_s16 (const gint32 * pre_corr, const gint16 * search,
+    guint n, guint frames_search, guint samples_per_frame)
+{
+  gint64 best_corr = G_MININT64;
+  guint best_off = 0;
+  guint off;
+  glong i;
+
+  for (off = 0; off < frames_search; off++) {
+    gint64 corr = 0;
+    const gint32 *ppc = pre_corr + n;
+    const gint16 *ps = search + off * samples_per_frame + n;
+
+    i = -((glong) n);
+    do {
+      corr += ppc[i + 0] * ps[i + 0];
+      corr += ppc[i + 1] * ps[i + 1];
+      corr += ppc[i + 2] * ps[i + 2];
+      corr += ppc[i + 3] * ps[i + 3];
+      i += 4;
+    } while (i < 0);
+    if (corr > best_corr) {
+      best_corr = corr;
+      best_off = off;
+    }
+  }
+
+  return best_off;
+}
+
+/* The correlation with every offset at once: the transform of the cross
+ * correlation is the conjugate transform of the windowed overlap times the
+ * transform of the search region. The caller fills @overlap and @search. */
+typedef struct
+{
+  guint len;
+  GstFFTF32 *fft;
+  GstFFTF32 *ifft;
+  gfloat *overlap;
+  gfloat *search;
+  GstFFTF32Complex *freq_overlap;
+  GstFFTF32Complex *freq_search;
+} GstScaletempoCorrFFT;
+
+/* transform length for a search region of @n_search samples */
+static inline guint
+gst_scaletempo_corr_fft_length (guint n_search)
+{
+  /* gst_fft_f32 wants an even length */
+  return gst_fft_next_fast_length ((n_search + 1) / 2) * 2;
+}
+
+static inline void
+gst_scaletempo_corr_fft_free (GstScaletempoCorrFFT * c)
+{
+  if (c->fft)
+    gst_fft_f32_free (c->fft);
+  if (c->ifft)
+    gst_fft_f32_free (c->ifft);
+  g_free (c->overlap);
+  g_free (c->search);
+  g_free (c->freq_overlap);
+  g_free (c->freq_search);
+  memset (c, 0, sizeof (GstScaletempoCorrFFT));
+}
+
+static inline void
+gst_scaletempo_corr_fft_init (GstScaletempoCorrFFT * c, guint len)
+{
+  if (c->len == len)
+    return;
+
+  gst_scaletempo_corr_fft_free (c);
+  c->len = len;
+  c->fft = gst_fft_f32_new (len, FALSE);
+  c->ifft = gst_fft_f32_new (len, TRUE);
+  c->overlap = g_new (gfloat, len);
+  c->search = g_new (gfloat, len);
+  c->freq_overlap = g_new (GstFFTF32Complex, len / 2 + 1);
+  c->freq_search = g_new (GstFFTF32Complex, len / 2 + 1);
+}
+
+static inline guint
+gst_scaletempo_corr_fft (GstScaletempoCorrFFT * c, guint n, guint n_search,
+    guint frames_search, guint samples_per_frame)
+{
+  GstFFTF32Complex *fo = c->freq_overlap;
+  GstFFTF32Complex *fs = c->freq_search;
+  gfloat *t = c->search;
+  gfloat best_corr;
+  guint best_off = 0;
+  guint i, off;
+
+  memset (c->overlap + n, 0, (c->len - n) * sizeof (gfloat));
+  gst_fft_f32_fft (c->fft, c->overlap, fo);
+  memset (c->search + n_search, 0, (c->len - n_search) * sizeof (gfloat));
+  gst_fft_f32_fft (c->fft, c->search, fs);
+
+  for (i = 0; i < c->len / 2 + 1; i++) {
+    gfloat r = fo[i].r * fs[i].r + fo[i].i * fs[i].i;
+    gfloat im = fo[i].r * fs[i].i - fo[i].i * fs[i].r;
+
+    fs[i].r = r;
+    fs[i].i = im;
+  }
+  gst_fft_f32_inverse_fft (c->ifft, fs, t);
+
+  /* the inverse transform is not normalized, which does not change the
+   * position of the maximum. lags that are not whole frames are skipped */
+  best_corr = t[0];
+  for (off = 1; off < frames_search; off++) {
+    gfloat corr = t[off * samples_per_frame];
+
+    if (corr > best_corr) {
+      best_corr = corr;
+      best_off = off;
+    }
+  }
+
+  return best_off;
+}
+
+/* The dot products cost frames_search * n multiply-adds, the fft correlation
+ * three real transforms of len * log2 (len) plus the products. These are the
+ * number of multiply-adds that take as long as one len * log2 (len) unit,
+ * the medians measured with tests/benchmarks/scaletempo over rates, channel
+ * counts and search lengths. The S16 dot products do not vectorize as well
+ * as the float ones. */
+#define GST_SCALETEMPO_CORR_FFT_COST_FLOAT 17
+#define GST_SCALETEMPO_CORR_FFT_COST_S16 6
+
+static inline gboolean
+gst_scaletempo_corr_use_fft (gboolean use_int, guint n, guint frames_search,
+    guint len)
+{
+  return (gdouble) frames_search * n > (gdouble) (use_int ?
+      GST_SCALETEMPO_CORR_FFT_COST_S16 : GST_SCALETEMPO_CORR_FFT_COST_FLOAT) *
+      len * g_bit_storage (len);
+}
+
+G_END_DECLS
+
+#endif /* __GST_SCALETEMPO_CORR_H__ */
@@ -23,177 +23,222 @@
 #include "siren7.h"
 
 
-#define PI 3.1415926
-
+#define PI 3.14159265358979323846
+
+/* constants of the 5-point DFT */
+#define DFT5_C1 0.309016994374947424f   /* cos (2 * PI / 5) */
+#define DFT5_C2 -0.809016994374947424f  /* cos (4 * PI / 5) */
+#define DFT5_S1 0.951056516295153572f   /* sin (2 * PI / 5) */
+#define DFT5_S2 0.587785252292473129f   /* sin (4 * PI / 5) */
+
+#define MAX_DCT_LENGTH 640
+#define MAX_FFT_LENGTH (MAX_DCT_LENGTH / 2)
+#define MAX_SUB_LENGTH (MAX_FFT_LENGTH / 5)
+
+/* The DCT-IV of length N is folded into a complex FFT of length N / 2,
+ * with a rotation of the input and of the output. N / 2 is 5 * 2^k for
+ * the 320 and 640 sample transforms, so that FFT is done as five radix-2
+ * FFTs over the interleaved sub-sequences that are then combined with
+ * 5-point DFTs. Real and imaginary parts are kept in separate arrays so
+ * that the butterfly loops can be vectorized by the compiler. */
 typedef struct
 {
-  float cos;
-  float msin;
-} dct_table_type;
-
-static float dct_core_320[100];
-static float dct_core_640[100];
-static dct_table_type dct_table_5[5];
-static dct_table_type dct_table_10[10];
-static dct_table_type dct_table_20[20];
-static dct_table_type dct_table_40[40];
-static dct_table_type dct_table_80[80];
-static dct_table_type dct_table_160[160];
-static dct_table_type dct_table_320[320];
-static dct_table_type dct_table_640[640];
-static dct_table_type *dct_tables[8] = { dct_table_5,
-  dct_table_10,
-  dct_table_20,
-  dct_table_40,
-  dct_table_80,
-  dct_table_160,
-  dct_table_320,
-  dct_table_640
-};
+  int dct_length;
+  int sub_length;
+  /* input rotation, includes the sqrt (2 / N) scale */
+  float pre_cos[MAX_FFT_LENGTH];
+  float pre_sin[MAX_FFT_LENGTH];
+  /* output rotation */
+  float post_cos[MAX_FFT_LENGTH];
+  float post_sin[MAX_FFT_LENGTH];
+  /* twiddles of sub-sequences 1 to 4 before the 5-point DFTs */
+  float comb_cos[4][MAX_SUB_LENGTH];
+  float comb_sin[4][MAX_SUB_LENGTH];
+  /* radix-2 twiddles, those of the stage with half size h start at h - 1 */
+  float fft_cos[MAX_SUB_LENGTH];
+  float fft_sin[MAX_SUB_LENGTH];
+  /* where each input pair goes in the bit-reversed sub-sequences */
+  short input_index[MAX_FFT_LENGTH];
+} dct_plan_type;
+
+static dct_plan_type dct_plan_320;
+static dct_plan_type dct_plan_640;
 
 static int dct4_initialized = 0;
 
-void
-siren_dct4_init (void)
+static void
+siren_dct4_plan_init (dct_plan_type * plan, int dct_length)
 {
-  int i, j = 0;
-  double scale_320 = (float) sqrt (2.0 / 320);
-  double scale_640 = (float) sqrt (2.0 / 640);
+  int fft_length = dct_length / 2;
+  int sub_length = fft_length / 5;
+  double scale = sqrt (2.0 / dct_length);
   double angle;
-  double scale;
-
-  /* set up dct4 tables */
-  for (i = 0; i < 10; i++) {
-    angle = (float) ((i + 0.5) * PI);
-    for (j = 0; j < 10; j++) {
-      dct_core_320[(i * 10) + j] =
-          (float) (scale_320 * cos ((j + 0.5) * angle / 10));
-      dct_core_640[(i * 10) + j] =
-          (float) (scale_640 * cos ((j + 0.5) * angle / 10));
+  int i, j, bits, rev;
+
+  plan->dct_length = dct_length;
+  plan->sub_length = sub_length;
+
+  for (i = 0; i < fft_length; i++) {
+    angle = PI * (4 * i + 1) / (4.0 * dct_length);
+    plan->pre_cos[i] = (float) (scale * cos (angle));
+    plan->pre_sin[i] = (float) (-scale * sin (angle));
+    angle = PI * i / dct_length;
+    plan->post_cos[i] = (float) cos (angle);
+    plan->post_sin[i] = (float) -sin (angle);
+  }
+
+  for (i = 1; i < 5; i++) {
+    for (j = 0; j < sub_length; j++) {
+      angle = 2 * PI * i * j / fft_length;
+      plan->comb_cos[i - 1][j] = (float) cos (angle);
+      plan->comb_sin[i - 1][j] = (float) -sin (angle);
     }
   }
 
-  for (i = 0; i < 8; i++) {
-    scale = (float) (PI / ((5 << i) * 4));
-    for (j = 0; j < (5 << i); j++) {
-      angle = (float) (j + 0.5) * scale;
-      dct_tables[i][j].cos = (float) cos (angle);
-      dct_tables[i][j].msin = (float) -sin (angle);
+  for (i = 1; i < sub_length; i *= 2) {
+    for (j = 0; j < i; j++) {
+      angle = PI * j / i;
+      plan->fft_cos[i - 1 + j] = (float) cos (angle);
+      plan->fft_sin[i - 1 + j] = (float) -sin (angle);
     }
   }
 
+  for (bits = 0; (1 << bits) < sub_length; bits++);
+  for (i = 0; i < fft_length; i++) {
+    for (j = 0, rev = 0; j < bits; j++)
+      rev |= (((i / 5) >> j) & 1) << (bits - 1 - j);
+    plan->input_index[i] = (short) ((i % 5) * sub_length + rev);
+  }
+}
+
+void
+siren_dct4_init (void)
+{
+  siren_dct4_plan_init (&dct_plan_320, 320);
+  siren_dct4_plan_init (&dct_plan_640, 640);
+
   dct4_initialized = 1;
 }
 
+/* in-place radix-2 FFT of @length values given in bit-reversed order */
+static void
+siren_fft_radix2 (const dct_plan_type * plan, float *re, float *im,
+    int length)
+{
+  int half, start, k;
+
+  for (half = 1; half < length; half *= 2) {
+    const float *w_cos = plan->fft_cos + half - 1;
+    const float *w_sin = plan->fft_sin + half - 1;
+
+    for (start = 0; start < length; start += 2 * half) {
+      float *re_low = re + start;
+      float *im_low = im + start;
+      float *re_high = re_low + half;
+      float *im_high = im_low + half;
+
+      for (k = 0; k < half; k++) {
+        float vr = re_high[k] * w_cos[k] - im_high[k] * w_sin[k];
+        float vi = re_high[k] * w_sin[k] + im_high[k] * w_cos[k];
+
+        re_high[k] = re_low[k] - vr;
+        im_high[k] = im_low[k] - vi;
+        re_low[k] += vr;
+        im_low[k] += vi;
+      }
+    }
+  }
+}
+
 
 void
 siren_dct4 (float *Source, float *Destination, int dct_length)
 {
-  int log_length = 0;
-  float *dct_core = NULL;
-  dct_table_type **dct_table_ptr_ptr = NULL;
-  dct_table_type *dct_table_ptr = NULL;
-  float OutBuffer1[640];
-  float OutBuffer2[640];
-  float *Out_ptr;
-  float *NextOut_ptr;
-  float *In_Ptr = NULL;
-  float *In_Ptr_low = NULL;
-  float *In_Ptr_high = NULL;
-  float In_val_low;
-  float In_val_high;
-  float *Out_ptr_low = NULL;
-  float *Out_ptr_high = NULL;
-  float mult1, mult2, mult3, mult4, mult5, mult6, mult7, mult8, mult9, mult10;
-  int i, j;
+  const dct_plan_type *plan;
+  float re[MAX_FFT_LENGTH];
+  float im[MAX_FFT_LENGTH];
+  float yr[5], yi[5], zr[5], zi[5];
+  float t1r, t1i, t2r, t2i, t3r, t3i, t4r, t4i;
+  float a1r, a1i, a2r, a2i, b1r, b1i, b2r, b2i;
+  int fft_length, sub_length;
+  int i, r, k;
 
   if (dct4_initialized == 0)
     siren_dct4_init ();
 
-  if (dct_length == 640) {
-    log_length = 5;
-    dct_core = dct_core_640;
-  } else {
-    log_length = 4;
-    dct_core = dct_core_320;
-  }
-
-  Out_ptr = OutBuffer1;
-  NextOut_ptr = OutBuffer2;
-  In_Ptr = Source;
-  for (i = 0; i <= log_length; i++) {
-    for (j = 0; j < (1 << i); j++) {
-      Out_ptr_low = Out_ptr + (j * (dct_length >> i));
-      Out_ptr_high = Out_ptr + ((j + 1) * (dct_length >> i));
-      do {
-        In_val_low = *In_Ptr++;
-        In_val_high = *In_Ptr++;
-        *Out_ptr_low++ = In_val_low + In_val_high;
-        *--Out_ptr_high = In_val_low - In_val_high;
-      } while (Out_ptr_low < Out_ptr_high);
-    }
-
-    In_Ptr = Out_ptr;
-    Out_ptr = NextOut_ptr;
-    NextOut_ptr = In_Ptr;
+  if (dct_length == 640)
+    plan = &dct_plan_640;
+  else
+    plan = &dct_plan_320;
+
+  dct_length = plan->dct_length;
+  fft_length = dct_length / 2;
+  sub_length = plan->sub_length;
+
+  /* pair the even samples with the odd ones from the end as complex values
+   * and rotate them. All of Source is read here, so Destination may be the
+   * same buffer. */
+  for (i = 0; i < fft_length; i++) {
+    float a = Source[2 * i];
+    float b = Source[dct_length - 1 - 2 * i];
+    int index = plan->input_index[i];
+
+    re[index] = a * plan->pre_cos[i] - b * plan->pre_sin[i];
+    im[index] = a * plan->pre_sin[i] + b * plan->pre_cos[i];
   }
 
-  for (i = 0; i < (2 << log_length); i++) {
-    for (j = 0; j < 10; j++) {
-      mult1 = In_Ptr[(i * 10)] * dct_core[j * 10];
-      mult2 = In_Ptr[(i * 10) + 1] * dct_core[(j * 10) + 1];
-      mult3 = In_Ptr[(i * 10) + 2] * dct_core[(j * 10) + 2];
-      mult4 = In_Ptr[(i * 10) + 3] * dct_core[(j * 10) + 3];
-      mult5 = In_Ptr[(i * 10) + 4] * dct_core[(j * 10) + 4];
-      mult6 = In_Ptr[(i * 10) + 5] * dct_core[(j * 10) + 5];
-      mult7 = In_Ptr[(i * 10) + 6] * dct_core[(j * 10) + 6];
-      mult8 = In_Ptr[(i * 10) + 7] * dct_core[(j * 10) + 7];
-      mult9 = In_Ptr[(i * 10) + 8] * dct_core[(j * 10) + 8];
-      mult10 = In_Ptr[(i * 10) + 9] * dct_core[(j * 10) + 9];
-      Out_ptr[(i * 10) + j] = mult1 + mult2 + mult3 + mult4 +
-          mult5 + mult6 + mult7 + mult8 + mult9 + mult10;
+  for (r = 0; r < 5; r++)
+    siren_fft_radix2 (plan, re + r * sub_length, im + r * sub_length,
+        sub_length);
+
+  /* combine the sub-sequences with 5-point DFTs and rotate the result into
+   * the even and the reversed odd outputs */
+  for (i = 0; i < sub_length; i++) {
+    yr[0] = re[i];
+    yi[0] = im[i];
+    for (r = 1; r < 5; r++) {
+      float xr = re[r * sub_length + i];
+      float xi = im[r * sub_length + i];
+
+      yr[r] = xr * plan->comb_cos[r - 1][i] - xi * plan->comb_sin[r - 1][i];
+      yi[r] = xr * plan->comb_sin[r - 1][i] + xi * plan->comb_cos[r - 1][i];
     }
-  }
 
-
-  In_Ptr = Out_ptr;
-  Out_ptr = NextOut_ptr;
-  NextOut_ptr = In_Ptr;
-  dct_table_ptr_ptr = dct_tables;
-  for (i = log_length; i >= 0; i--) {
-    dct_table_ptr_ptr++;
-    for (j = 0; j < (1 << i); j++) {
-      dct_table_ptr = *dct_table_ptr_ptr;
-      if (i == 0)
-        Out_ptr_low = Destination + (j * (dct_length >> i));
-      else
-        Out_ptr_low = Out_ptr + (j * (dct_length >> i));
-
-      Out_ptr_high = Out_ptr_low + (dct_length >> i);
-
-      In_Ptr_low = In_Ptr + (j * (dct_length >> i));
-      In_Ptr_high = In_Ptr_low + (dct_length >> (i + 1));
-      do {
-        *Out_ptr_low++ =
-            (*In_Ptr_low * (*dct_table_ptr).cos) -
-            (*In_Ptr_high * (*dct_table_ptr).msin);
-        *--Out_ptr_high =
-            (*In_Ptr_high++ * (*dct_table_ptr).cos) +
-            (*In_Ptr_low++ * (*dct_table_ptr).msin);
-        dct_table_ptr++;
-        *Out_ptr_low++ =
-            (*In_Ptr_low * (*dct_table_ptr).cos) +
-            (*In_Ptr_high * (*dct_table_ptr).msin);
-        *--Out_ptr_high =
-            (*In_Ptr_low++ * (*dct_table_ptr).msin) -
-            (*In_Ptr_high++ * (*dct_table_ptr).cos);
-        dct_table_ptr++;
-      } while (Out_ptr_low < Out_ptr_high);
+    t1r = yr[1] + yr[4];
+    t1i = yi[1] + yi[4];
+    t2r = yr[2] + yr[3];
+    t2i = yi[2] + yi[3];
+    t3r = yr[1] - yr[4];
+    t3i = yi[1] - yi[4];
+    t4r = yr[2] - yr[3];
+    t4i = yi[2] - yi[3];
+
+    a1r = yr[0] + DFT5_C1 * t1r + DFT5_C2 * t2r;
+    a1i = yi[0] + DFT5_C1 * t1i + DFT5_C2 * t2i;
+    a2r = yr[0] + DFT5_C2 * t1r + DFT5_C1 * t2r;
+    a2i = yi[0] + DFT5_C2 * t1i + DFT5_C1 * t2i;
+    b1r = DFT5_S1 * t3r + DFT5_S2 * t4r;
+    b1i = DFT5_S1 * t3i + DFT5_S2 * t4i;
+    b2r = DFT5_S2 * t3r - DFT5_S1 * t4r;
+    b2i = DFT5_S2 * t3i - DFT5_S1 * t4i;
+
+    zr[0] = yr[0] + t1r + t2r;
+    zi[0] = yi[0] + t1i + t2i;
+    zr[1] = a1r + b1i;
+    zi[1] = a1i - b1r;
+    zr[2] = a2r + b2i;
+    zi[2] = a2i - b2r;
+    zr[3] = a2r - b2i;
+    zi[3] = a2i + b2r;
+    zr[4] = a1r - b1i;
+    zi[4] = a1i + b1r;
+
+    for (r = 0; r < 5; r++) {
+      k = i + r * sub_length;
+      Destination[2 * k] =
+          zr[r] * plan->post_cos[k] - zi[r] * plan->post_sin[k];
+      Destination[dct_length - 1 - 2 * k] =
+          -(zr[r] * plan->post_sin[k] + zi[r] * plan->post_cos[k]);
     }
-
-    In_Ptr = Out_ptr;
-    Out_ptr = NextOut_ptr;
-    NextOut_ptr = In_Ptr;
   }
-
 }
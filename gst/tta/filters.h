@@ -48,52 +48,37 @@ memshl (register long *pA, register long *pB) {
 
 static void
 hybrid_filter (fltst *fs, long *in) {
-        register long *pA = fs->dl;
-        register long *pB = fs->qm;
-        register long *pM = fs->dx;
-        register long sum = fs->round;
+        long *pA = fs->dl;
+        long *pB = fs->qm;
+        long *pM = fs->dx;
+        long sum = fs->round;
+        int i;
 
-        if (!fs->error) {
-                sum += *pA++ * *pB, pB++;
-                sum += *pA++ * *pB, pB++;
-                sum += *pA++ * *pB, pB++;
-                sum += *pA++ * *pB, pB++;
-                sum += *pA++ * *pB, pB++;
-                sum += *pA++ * *pB, pB++;
-                sum += *pA++ * *pB, pB++;
-                sum += *pA++ * *pB, pB++; pM += 8;
-        } else if (fs->error < 0) {
-                sum += *pA++ * (*pB -= *pM++), pB++;
-                sum += *pA++ * (*pB -= *pM++), pB++;
-                sum += *pA++ * (*pB -= *pM++), pB++;
-                sum += *pA++ * (*pB -= *pM++), pB++;
-                sum += *pA++ * (*pB -= *pM++), pB++;
-                sum += *pA++ * (*pB -= *pM++), pB++;
-                sum += *pA++ * (*pB -= *pM++), pB++;
-                sum += *pA++ * (*pB -= *pM++), pB++;
-        } else {
-                sum += *pA++ * (*pB += *pM++), pB++;
-                sum += *pA++ * (*pB += *pM++), pB++;
-                sum += *pA++ * (*pB += *pM++), pB++;
-                sum += *pA++ * (*pB += *pM++), pB++;
-                sum += *pA++ * (*pB += *pM++), pB++;
-                sum += *pA++ * (*pB += *pM++), pB++;
-                sum += *pA++ * (*pB += *pM++), pB++;
-                sum += *pA++ * (*pB += *pM++), pB++;
+        /* adapting the coefficients and the dot product are kept as
+         * separate fixed length loops, which compilers vectorise */
+        if (fs->error < 0) {
+                for (i = 0; i < MAX_ORDER; i++)
+                        pB[i] -= pM[i];
+        } else if (fs->error > 0) {
+                for (i = 0; i < MAX_ORDER; i++)
+                        pB[i] += pM[i];
         }
 
-        *(pM-0) = ((*(pA-1) >> 30) | 1) << 2;
-        *(pM-1) = ((*(pA-2) >> 30) | 1) << 1;
-        *(pM-2) = ((*(pA-3) >> 30) | 1) << 1;
-        *(pM-3) = ((*(pA-4) >> 30) | 1);
+        for (i = 0; i < MAX_ORDER; i++)
+                sum += pA[i] * pB[i];
+
+        pM[8] = ((pA[7] >> 30) | 1) << 2;
+        pM[7] = ((pA[6] >> 30) | 1) << 1;
+        pM[6] = ((pA[5] >> 30) | 1) << 1;
+        pM[5] = ((pA[4] >> 30) | 1);
 
         fs->error = *in;
         *in += (sum >> fs->shift);
-        *pA = *in;
+        pA[8] = *in;
 
-        *(pA-1) = *(pA-0) - *(pA-1);
-        *(pA-2) = *(pA-1) - *(pA-2);
-        *(pA-3) = *(pA-2) - *(pA-3);
+        pA[7] = pA[8] - pA[7];
+        pA[6] = pA[7] - pA[6];
+        pA[5] = pA[6] - pA[5];
 
         memshl (fs->dl, fs->dl + 1);
         memshl (fs->dx, fs->dx + 1);
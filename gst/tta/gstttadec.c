@@ -27,9 +27,10 @@
 #include <math.h>
 #include <string.h>
 
+#include <gst/bandpool/gstbandpool.h>
+
 #include "gstttadec.h"
-#include "ttadec.h"
-#include "filters.h"
+#include "gstttafilter.h"
 
 #define TTA_BUFFER_SIZE (1024 * 32 * 8)
 
@@ -68,9 +69,12 @@ enum
   LAST_SIGNAL
 };
 
+#define DEFAULT_N_THREADS 0
+
 enum
 {
-  ARG_0
+  ARG_0,
+  ARG_N_THREADS
 };
 
 static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
@@ -78,7 +82,7 @@ static GstStaticPadTemplate sink_factory = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-tta, "
         "width = (int) { 8, 16, 24 }, "
-        "channels = (int) { 1, 2 }, " "rate = (int) [ 8000, 96000 ]")
+        "channels = (int) [ 1, 8 ], " "rate = (int) [ 8000, 96000 ]")
     );
 
 static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
@@ -87,7 +91,7 @@ static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
     GST_STATIC_CAPS ("audio/x-raw-int, "
         "width = (int) { 8, 16, 24 }, "
         "depth = (int) { 8, 16, 24 }, "
-        "channels = (int) { 1, 2 }, "
+        "channels = (int) [ 1, 8 ], "
         "rate = (int) [ 8000, 96000 ], "
         "endianness = (int) BYTE_ORDER, " "signed = (boolean) true")
     );
@@ -95,6 +99,10 @@ static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
 static void gst_tta_dec_class_init (GstTtaDecClass * klass);
 static void gst_tta_dec_base_init (GstTtaDecClass * klass);
 static void gst_tta_dec_init (GstTtaDec * ttadec);
+static void gst_tta_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_tta_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static GstFlowReturn gst_tta_dec_chain (GstPad * pad, GstBuffer * in);
 
@@ -131,12 +139,21 @@ gst_tta_dec_setcaps (GstPad * pad, GstCaps * caps)
     return FALSE;
 
   ttadec->frame_length = FRAME_TIME * ttadec->samplerate;
+  /* ceil() of the buffer duration can round up by one sample */
+  ttadec->max_samples = ttadec->frame_length + 1;
+
+  g_free (ttadec->tta);
+  g_free (ttadec->cache);
+  g_free (ttadec->residuals);
+  g_free (ttadec->decdata);
 
   ttadec->tta = g_malloc (ttadec->channels * sizeof (decoder));
   ttadec->cache = g_malloc (ttadec->channels * sizeof (long));
+  ttadec->residuals =
+      g_malloc (ttadec->channels * ttadec->max_samples * sizeof (long));
 
   ttadec->decdata =
-      (guchar *) g_malloc (ttadec->channels * ttadec->frame_length *
+      (guchar *) g_malloc (ttadec->channels * ttadec->max_samples *
       ttadec->bytes * sizeof (guchar));
 
   return TRUE;
@@ -186,8 +203,15 @@ gst_tta_dec_dispose (GObject * object)
   GstTtaDec *ttadec = GST_TTA_DEC (object);
 
   g_free (ttadec->tta);
+  ttadec->tta = NULL;
+  g_free (ttadec->cache);
+  ttadec->cache = NULL;
+  g_free (ttadec->residuals);
+  ttadec->residuals = NULL;
   g_free (ttadec->decdata);
+  ttadec->decdata = NULL;
   g_free (ttadec->tta_buf.buffer);
+  ttadec->tta_buf.buffer = NULL;
 
   G_OBJECT_CLASS (parent)->dispose (object);
 }
@@ -202,6 +226,14 @@ gst_tta_dec_class_init (GstTtaDecClass * klass)
   parent = g_type_class_peek_parent (klass);
 
   gobject_class->dispose = gst_tta_dec_dispose;
+  gobject_class->set_property = gst_tta_dec_set_property;
+  gobject_class->get_property = gst_tta_dec_get_property;
+
+  g_object_class_install_property (gobject_class, ARG_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads the channels are filtered in, "
+          "0 = number of processors", 0, G_MAXUINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -224,6 +256,44 @@ gst_tta_dec_init (GstTtaDec * ttadec)
   gst_pad_set_chain_function (ttadec->sinkpad, gst_tta_dec_chain);
   ttadec->tta_buf.buffer = (guchar *) g_malloc (TTA_BUFFER_SIZE + 4);
   ttadec->tta_buf.buffer_end = ttadec->tta_buf.buffer + TTA_BUFFER_SIZE;
+
+  ttadec->n_threads = DEFAULT_N_THREADS;
+}
+
+static void
+gst_tta_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstTtaDec *ttadec = GST_TTA_DEC (object);
+
+  switch (prop_id) {
+    case ARG_N_THREADS:
+      GST_OBJECT_LOCK (ttadec);
+      ttadec->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (ttadec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_tta_dec_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstTtaDec *ttadec = GST_TTA_DEC (object);
+
+  switch (prop_id) {
+    case ARG_N_THREADS:
+      GST_OBJECT_LOCK (ttadec);
+      g_value_set_uint (value, ttadec->n_threads);
+      GST_OBJECT_UNLOCK (ttadec);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
 }
 
 static void
@@ -306,18 +376,58 @@ get_unary (tta_buffer * tta_buf, guchar * buffer, unsigned long buffersize,
   tta_buf->bit_count--;
 }
 
+/* filters the channels of @band */
+static void
+gst_tta_dec_filter_band (GstTtaDec * ttadec, guint band)
+{
+  guint ch;
+
+  for (ch = band; ch < ttadec->channels; ch += ttadec->n_bands)
+    gst_tta_filter_channel (&ttadec->tta[ch],
+        ttadec->residuals + ch * ttadec->max_samples, ttadec->frame_samples,
+        ttadec->bytes);
+}
+
+static void
+gst_tta_dec_band_func (gpointer data, gpointer user_data)
+{
+  guint *band = data;
+  GstTtaDec *ttadec = user_data;
+
+  gst_tta_dec_filter_band (ttadec, *band);
+}
+
+/* filters all channels, spread over n_bands bands that run in parallel */
+static void
+gst_tta_dec_filter (GstTtaDec * ttadec)
+{
+  guint n_threads, *bands, i;
+
+  GST_OBJECT_LOCK (ttadec);
+  n_threads = ttadec->n_threads;
+  GST_OBJECT_UNLOCK (ttadec);
+
+  ttadec->n_bands = gst_band_pool_get_n_bands (n_threads, ttadec->channels,
+      1);
+
+  bands = g_newa (guint, ttadec->n_bands);
+  for (i = 0; i < ttadec->n_bands; i++)
+    bands[i] = i;
+
+  gst_band_pool_run (gst_band_pool_get_default (), gst_tta_dec_band_func,
+      ttadec, bands, sizeof (guint), ttadec->n_bands);
+}
+
 static GstFlowReturn
 gst_tta_dec_chain (GstPad * pad, GstBuffer * in)
 {
   GstTtaDec *ttadec;
   GstBuffer *outbuf, *buf = GST_BUFFER (in);
-  guchar *data, *p;
-  decoder *dec;
+  guchar *data;
   unsigned long outsize;
   unsigned long size;
-  guint32 frame_samples;
-  long res;
-  long *prev;
+  guint32 frame_samples, i;
+  guint ch;
 
   ttadec = GST_TTA_DEC (GST_OBJECT_PARENT (pad));
 
@@ -337,99 +447,67 @@ gst_tta_dec_chain (GstPad * pad, GstBuffer * in)
   } else {
     frame_samples = ttadec->samplerate * FRAME_TIME;
   }
+  frame_samples = MIN (frame_samples, ttadec->max_samples);
+  ttadec->frame_samples = frame_samples;
   outsize = ttadec->channels * frame_samples * ttadec->bytes;
 
-  dec = ttadec->tta;
-  p = ttadec->decdata;
-  prev = ttadec->cache;
-  for (res = 0;
-      p < ttadec->decdata + frame_samples * ttadec->channels * ttadec->bytes;) {
-    unsigned long unary, binary, depth, k;
-    long value, temp_value;
-    fltst *fst = &dec->fst;
-    adapt *rice = &dec->rice;
-    long *last = &dec->last;
-
-    // decode Rice unsigned
-    get_unary (&ttadec->tta_buf, data, size, &unary);
-
-    switch (unary) {
-      case 0:
-        depth = 0;
-        k = rice->k0;
-        break;
-      default:
-        depth = 1;
-        k = rice->k1;
-        unary--;
-    }
-
-    if (k) {
-      get_binary (&ttadec->tta_buf, data, size, &binary, k);
-      value = (unary << k) + binary;
-    } else
-      value = unary;
-
-    switch (depth) {
-      case 1:
-        rice->sum1 += value - (rice->sum1 >> 4);
-        if (rice->k1 > 0 && rice->sum1 < shift_16[rice->k1])
-          rice->k1--;
-        else if (rice->sum1 > shift_16[rice->k1 + 1])
-          rice->k1++;
-        value += bit_shift[rice->k0];
-      default:
-        rice->sum0 += value - (rice->sum0 >> 4);
-        if (rice->k0 > 0 && rice->sum0 < shift_16[rice->k0])
-          rice->k0--;
-        else if (rice->sum0 > shift_16[rice->k0 + 1])
-          rice->k0++;
-    }
+  /* Rice decoding. The channels are interleaved in the bitstream, so this
+   * part is serial; the residuals are stored per channel for the filters */
+  for (i = 0; i < frame_samples; i++) {
+    for (ch = 0; ch < ttadec->channels; ch++) {
+      unsigned long unary, binary, depth, k;
+      long value, temp_value;
+      adapt *rice = &ttadec->tta[ch].rice;
+
+      // decode Rice unsigned
+      get_unary (&ttadec->tta_buf, data, size, &unary);
+
+      switch (unary) {
+        case 0:
+          depth = 0;
+          k = rice->k0;
+          break;
+        default:
+          depth = 1;
+          k = rice->k1;
+          unary--;
+      }
 
-    /* this only uses a temporary variable to silence a gcc warning */
-    temp_value = DEC (value);
-    value = temp_value;
-
-    // decompress stage 1: adaptive hybrid filter
-    hybrid_filter (fst, &value);
-
-    // decompress stage 2: fixed order 1 prediction
-    switch (ttadec->bytes) {
-      case 1:
-        value += PREDICTOR1 (*last, 4);
-        break;                  // bps 8
-      case 2:
-        value += PREDICTOR1 (*last, 5);
-        break;                  // bps 16
-      case 3:
-        value += PREDICTOR1 (*last, 5);
-        break;                  // bps 24
-      case 4:
-        value += *last;
-        break;                  // bps 32
-    }
-    *last = value;
-
-    if (dec < ttadec->tta + ttadec->channels - 1) {
-      *prev++ = value;
-      dec++;
-    } else {
-      *prev = value;
-      if (ttadec->channels > 1) {
-        long *r = prev - 1;
-
-        for (*prev += *r / 2; r >= ttadec->cache; r--)
-          *r = *(r + 1) - *r;
-        for (r = ttadec->cache; r < prev; r++)
-          WRITE_BUFFER (r, ttadec->bytes, p);
+      if (k) {
+        get_binary (&ttadec->tta_buf, data, size, &binary, k);
+        value = (unary << k) + binary;
+      } else
+        value = unary;
+
+      switch (depth) {
+        case 1:
+          rice->sum1 += value - (rice->sum1 >> 4);
+          if (rice->k1 > 0 && rice->sum1 < shift_16[rice->k1])
+            rice->k1--;
+          else if (rice->sum1 > shift_16[rice->k1 + 1])
+            rice->k1++;
+          value += bit_shift[rice->k0];
+        default:
+          rice->sum0 += value - (rice->sum0 >> 4);
+          if (rice->k0 > 0 && rice->sum0 < shift_16[rice->k0])
+            rice->k0--;
+          else if (rice->sum0 > shift_16[rice->k0 + 1])
+            rice->k0++;
       }
-      WRITE_BUFFER (prev, ttadec->bytes, p);
-      prev = ttadec->cache;
-      res++;
-      dec = ttadec->tta;
+
+      /* this only uses a temporary variable to silence a gcc warning */
+      temp_value = DEC (value);
+      ttadec->residuals[ch * ttadec->max_samples + i] = temp_value;
     }
   }
 
+  gst_tta_dec_filter (ttadec);
+
+  /* undo the inter-channel decorrelation and interleave */
+  gst_tta_decorrelate (ttadec->residuals, ttadec->max_samples,
+      ttadec->channels, ttadec->bytes, frame_samples, ttadec->cache,
+      ttadec->decdata);
+
   outbuf = gst_buffer_new_and_alloc (outsize);
   memcpy (GST_BUFFER_DATA (outbuf), ttadec->decdata, outsize);
   GST_BUFFER_TIMESTAMP (outbuf) = GST_BUFFER_TIMESTAMP (buf);
@@ -68,6 +68,15 @@ struct _GstTtaDec
   guchar *decdata;
   tta_buffer tta_buf;
   long *cache;
+
+  /* residuals of the current frame, max_samples per channel */
+  long *residuals;
+  guint32 frame_samples;
+  long max_samples;
+
+  /* the channels are filtered in n_bands bands run in parallel */
+  guint n_threads;
+  guint n_bands;
 };
 
 struct _GstTtaDecClass 
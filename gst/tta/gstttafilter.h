@@ -0,0 +1,93 @@
+/* GStreamer TTA plugin
+ *
+ * gstttafilter.h: the filter stages of the decoder
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_TTA_FILTER_H__
+#define __GST_TTA_FILTER_H__
+
+#include <glib.h>
+#include <string.h>
+
+#include "ttadec.h"
+#include "filters.h"
+
+G_BEGIN_DECLS
+
+/* runs the adaptive filter and the fixed prediction over @n_samples
+ * residuals of one channel, the channels are independent of each other
+ * here */
+static inline void
+gst_tta_filter_channel (decoder * dec, long *value, guint32 n_samples,
+    guint bytes)
+{
+  guint32 i;
+
+  for (i = 0; i < n_samples; i++) {
+    // decompress stage 1: adaptive hybrid filter
+    hybrid_filter (&dec->fst, &value[i]);
+
+    // decompress stage 2: fixed order 1 prediction
+    switch (bytes) {
+      case 1:
+        value[i] += PREDICTOR1 (dec->last, 4);
+        break;                  // bps 8
+      case 2:
+        value[i] += PREDICTOR1 (dec->last, 5);
+        break;                  // bps 16
+      case 3:
+        value[i] += PREDICTOR1 (dec->last, 5);
+        break;                  // bps 24
+      case 4:
+        value[i] += dec->last;
+        break;                  // bps 32
+    }
+    dec->last = value[i];
+  }
+}
+
+/* undoes the inter-channel decorrelation of @n_samples filtered samples,
+ * stored per channel @stride samples apart, and writes them interleaved to
+ * @out. @cache has room for one sample of every channel */
+static inline void
+gst_tta_decorrelate (const long *values, long stride, guint channels,
+    guint bytes, guint32 n_samples, long *cache, guchar * out)
+{
+  long *prev = cache + channels - 1;
+  guint32 i;
+  guint ch;
+
+  for (i = 0; i < n_samples; i++) {
+    for (ch = 0; ch < channels; ch++)
+      cache[ch] = values[ch * stride + i];
+
+    if (channels > 1) {
+      long *r = prev - 1;
+
+      for (*prev += *r / 2; r >= cache; r--)
+        *r = *(r + 1) - *r;
+      for (r = cache; r < prev; r++)
+        WRITE_BUFFER (r, bytes, out);
+    }
+    WRITE_BUFFER (prev, bytes, out);
+  }
+}
+
+G_END_DECLS
+
+#endif /* __GST_TTA_FILTER_H__ */
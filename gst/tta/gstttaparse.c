@@ -45,7 +45,7 @@ static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("audio/x-tta, "
         "width = (int) { 8, 16, 24 }, "
-        "channels = (int) { 1, 2 }, " "rate = (int) [ 8000, 96000 ]")
+        "channels = (int) [ 1, 8 ], " "rate = (int) [ 8000, 96000 ]")
     );
 
 static void gst_tta_parse_class_init (GstTtaParseClass * klass);
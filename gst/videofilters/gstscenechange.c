@@ -32,6 +32,12 @@
  *
  * The scenechange element does not work with compressed video.
  *
+ * The frames are compared on a copy of their luma plane that is decimated
+ * by the #GstSceneChange:downscale factor. With #GstSceneChange:score-events
+ * the score of every frame is sent downstream in a "GstSceneChange" event
+ * before the frame, so that encoders can use it without analysing the video
+ * again.
+ *
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -82,6 +88,8 @@
 #include <gst/video/video.h>
 #include "gstvideofilter2.h"
 #include "gstscenechange.h"
+#include "gstscenechangedecimate.h"
+#include "gstvideofiltersbadorc.h"
 #include <string.h>
 
 GST_DEBUG_CATEGORY_STATIC (gst_scene_change_debug_category);
@@ -101,6 +109,8 @@ static gboolean gst_scene_change_start (GstBaseTransform * trans);
 static gboolean gst_scene_change_stop (GstBaseTransform * trans);
 static GstFlowReturn
 gst_scene_change_prefilter (GstVideoFilter2 * videofilter2, GstBuffer * buf);
+static GstFlowReturn
+gst_scene_change_postfilter (GstVideoFilter2 * videofilter2, GstBuffer * buf);
 
 static GstVideoFilter2Functions gst_scene_change_filter_functions[];
 
@@ -111,9 +121,14 @@ static gboolean is_shot_change (int frame_number);
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_DOWNSCALE,
+  PROP_SCORE_EVENTS
 };
 
+#define DEFAULT_DOWNSCALE 4
+#define DEFAULT_SCORE_EVENTS FALSE
+
 /* pad templates */
 
 
@@ -153,9 +168,22 @@ gst_scene_change_class_init (GstSceneChangeClass * klass)
   base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_scene_change_stop);
   video_filter2_class->prefilter =
       GST_DEBUG_FUNCPTR (gst_scene_change_prefilter);
+  video_filter2_class->postfilter =
+      GST_DEBUG_FUNCPTR (gst_scene_change_postfilter);
+
+  g_object_class_install_property (gobject_class, PROP_DOWNSCALE,
+      g_param_spec_int ("downscale", "Downscale",
+          "Factor by which the luma is decimated in both directions before "
+          "the frames are compared", 1, GST_SCENE_CHANGE_MAX_DOWNSCALE,
+          DEFAULT_DOWNSCALE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, PROP_SCORE_EVENTS,
+      g_param_spec_boolean ("score-events", "Score events",
+          "Send the score of each frame downstream in a GstSceneChange event",
+          DEFAULT_SCORE_EVENTS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_video_filter2_class_add_functions (video_filter2_class,
       gst_scene_change_filter_functions);
+  gst_video_filter2_class_set_slice_parallel (video_filter2_class, TRUE);
 
 }
 
@@ -163,15 +191,28 @@ static void
 gst_scene_change_init (GstSceneChange * scenechange,
     GstSceneChangeClass * scenechange_class)
 {
+  scenechange->downscale = DEFAULT_DOWNSCALE;
+  scenechange->score_events = DEFAULT_SCORE_EVENTS;
 }
 
 void
 gst_scene_change_set_property (GObject * object, guint property_id,
     const GValue * value, GParamSpec * pspec)
 {
+  GstSceneChange *scenechange;
+
   g_return_if_fail (GST_IS_SCENE_CHANGE (object));
+  scenechange = GST_SCENE_CHANGE (object);
 
   switch (property_id) {
+    case PROP_DOWNSCALE:
+      GST_OBJECT_LOCK (scenechange);
+      scenechange->downscale = g_value_get_int (value);
+      GST_OBJECT_UNLOCK (scenechange);
+      break;
+    case PROP_SCORE_EVENTS:
+      scenechange->score_events = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -182,9 +223,18 @@ void
 gst_scene_change_get_property (GObject * object, guint property_id,
     GValue * value, GParamSpec * pspec)
 {
+  GstSceneChange *scenechange;
+
   g_return_if_fail (GST_IS_SCENE_CHANGE (object));
+  scenechange = GST_SCENE_CHANGE (object);
 
   switch (property_id) {
+    case PROP_DOWNSCALE:
+      g_value_set_int (value, scenechange->downscale);
+      break;
+    case PROP_SCORE_EVENTS:
+      g_value_set_boolean (value, scenechange->score_events);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -209,8 +259,8 @@ gst_scene_change_finalize (GObject * object)
   g_return_if_fail (GST_IS_SCENE_CHANGE (object));
   scenechange = GST_SCENE_CHANGE (object);
 
-  if (scenechange->oldbuf)
-    gst_buffer_unref (scenechange->oldbuf);
+  g_free (scenechange->plane);
+  g_free (scenechange->oldplane);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -226,33 +276,61 @@ gst_scene_change_start (GstBaseTransform * trans)
 static gboolean
 gst_scene_change_stop (GstBaseTransform * trans)
 {
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (trans);
+
+  scenechange->have_old = FALSE;
 
   return TRUE;
 }
 
+/* Sets up the decimated planes for the frame, the slices only fill and
+ * compare their lines of them */
 static GstFlowReturn
 gst_scene_change_prefilter (GstVideoFilter2 * video_filter2, GstBuffer * buf)
 {
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (video_filter2);
+  int width = GST_VIDEO_FILTER2_WIDTH (video_filter2);
+  int height = GST_VIDEO_FILTER2_HEIGHT (video_filter2);
+  int factor;
+
+  GST_OBJECT_LOCK (scenechange);
+  factor = MIN (scenechange->downscale, MIN (width, height));
+  GST_OBJECT_UNLOCK (scenechange);
+
+  /* start over when the decimated plane changes */
+  if (scenechange->plane_factor != factor ||
+      scenechange->plane_width != width / factor ||
+      scenechange->plane_height != height / factor) {
+    scenechange->plane_factor = factor;
+    scenechange->plane_width = width / factor;
+    scenechange->plane_height = height / factor;
+    g_free (scenechange->plane);
+    g_free (scenechange->oldplane);
+    scenechange->plane = g_malloc (scenechange->plane_width *
+        scenechange->plane_height);
+    scenechange->oldplane = g_malloc (scenechange->plane_width *
+        scenechange->plane_height);
+    scenechange->have_old = FALSE;
+  }
+
+  scenechange->sad = 0;
 
   return GST_FLOW_OK;
 }
 
-static double
-get_frame_score (guint8 * s1, guint8 * s2, int width, int height)
+/* Averages the factor x factor blocks of the luma plane that start in lines
+ * start to end into the tightly packed scenechange->plane. Columns and
+ * lines that don't fill a block are left out. */
+static void
+gst_scene_change_decimate (GstSceneChange * scenechange, const guint8 * src,
+    int stride, int start, int end)
 {
-  int i;
-  int j;
-  int score = 0;
-
-  for (j = 0; j < height; j++) {
-    for (i = 0; i < width; i++) {
-      score += ABS (s1[i] - s2[i]);
-    }
-    s1 += width;
-    s2 += width;
-  }
+  int factor = scenechange->plane_factor;
+  int j_start = (start + factor - 1) / factor;
+  int j_end = MIN ((end + factor - 1) / factor, scenechange->plane_height);
 
-  return ((double) score) / (width * height);
+  gst_scene_change_decimate_rows (scenechange->plane,
+      scenechange->plane_width, factor, src, stride, j_start, j_end);
 }
 
 static GstFlowReturn
@@ -260,64 +338,70 @@ gst_scene_change_filter_ip_I420 (GstVideoFilter2 * videofilter2,
     GstBuffer * buf, int start, int end)
 {
   GstSceneChange *scenechange;
-  double score_min;
-  double score_max;
-  double threshold;
-  double score;
-  gboolean change;
-  int i;
   int width;
-  int height;
+  int factor;
+  int j_start, j_end;
+  guint32 sad;
 
   g_return_val_if_fail (GST_IS_SCENE_CHANGE (videofilter2), GST_FLOW_ERROR);
   scenechange = GST_SCENE_CHANGE (videofilter2);
 
-  width = GST_VIDEO_FILTER2_WIDTH (videofilter2);
-  height = GST_VIDEO_FILTER2_HEIGHT (videofilter2);
+  width = scenechange->plane_width;
+  factor = scenechange->plane_factor;
 
-  if (!scenechange->oldbuf) {
-    scenechange->n_diffs = 0;
-    memset (scenechange->diffs, 0, sizeof (double) * SC_N_DIFFS);
-    scenechange->oldbuf = gst_buffer_ref (buf);
+  gst_scene_change_decimate (scenechange, GST_BUFFER_DATA (buf),
+      gst_video_format_get_row_stride (GST_VIDEO_FORMAT_I420, 0,
+          GST_VIDEO_FILTER2_WIDTH (videofilter2)), start, end);
+
+  if (!scenechange->have_old)
     return GST_FLOW_OK;
-  }
 
-  score = get_frame_score (GST_BUFFER_DATA (scenechange->oldbuf),
-      GST_BUFFER_DATA (buf), width, height);
+  /* the sum of absolute differences of the block rows of this slice */
+  j_start = (start + factor - 1) / factor;
+  j_end = MIN ((end + factor - 1) / factor, scenechange->plane_height);
+  if (j_end <= j_start)
+    return GST_FLOW_OK;
 
-  memmove (scenechange->diffs, scenechange->diffs + 1,
-      sizeof (double) * (SC_N_DIFFS - 1));
-  scenechange->diffs[SC_N_DIFFS - 1] = score;
-  scenechange->n_diffs++;
+  video_filters_bad_orc_sad_u8 (&sad, scenechange->oldplane + j_start * width,
+      scenechange->plane + j_start * width, width * (j_end - j_start));
 
-  gst_buffer_unref (scenechange->oldbuf);
-  scenechange->oldbuf = gst_buffer_ref (buf);
+  GST_OBJECT_LOCK (scenechange);
+  scenechange->sad += sad;
+  GST_OBJECT_UNLOCK (scenechange);
 
-  score_min = scenechange->diffs[0];
-  score_max = scenechange->diffs[0];
-  for (i = 1; i < SC_N_DIFFS - 1; i++) {
-    score_min = MIN (score_min, scenechange->diffs[i]);
-    score_max = MAX (score_max, scenechange->diffs[i]);
-  }
+  return GST_FLOW_OK;
+}
 
-  threshold = 1.8 * score_max - 0.8 * score_min;
-
-  if (scenechange->n_diffs > 2) {
-    if (score < 5) {
-      change = FALSE;
-    } else if (score / threshold < 1.0) {
-      change = FALSE;
-    } else if (score / threshold > 2.5) {
-      change = TRUE;
-    } else if (score > 50) {
-      change = TRUE;
-    } else {
-      change = FALSE;
-    }
-  } else {
-    change = FALSE;
+/* Scores the frame once all slices are done */
+static GstFlowReturn
+gst_scene_change_postfilter (GstVideoFilter2 * videofilter2, GstBuffer * buf)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (videofilter2);
+  double threshold;
+  double score;
+  gboolean change;
+  guint8 *tmp;
+
+  if (!scenechange->have_old) {
+    scenechange->n_diffs = 0;
+    memset (scenechange->diffs, 0, sizeof (double) * SC_N_DIFFS);
+    tmp = scenechange->oldplane;
+    scenechange->oldplane = scenechange->plane;
+    scenechange->plane = tmp;
+    scenechange->have_old = TRUE;
+    return GST_FLOW_OK;
   }
 
+  score = ((double) scenechange->sad) /
+      (scenechange->plane_width * scenechange->plane_height);
+
+  tmp = scenechange->oldplane;
+  scenechange->oldplane = scenechange->plane;
+  scenechange->plane = tmp;
+
+  change = gst_scene_change_score (scenechange->diffs, &scenechange->n_diffs,
+      score, &threshold);
+
 #ifdef TESTING
   if (change != is_shot_change (scenechange->n_diffs)) {
     g_print ("%d %g %g %g %d\n", scenechange->n_diffs, score / threshold,
@@ -325,6 +409,19 @@ gst_scene_change_filter_ip_I420 (GstVideoFilter2 * videofilter2,
   }
 #endif
 
+  if (scenechange->score_events) {
+    GstEvent *event;
+
+    event = gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+        gst_structure_new ("GstSceneChange",
+            "timestamp", GST_TYPE_CLOCK_TIME, GST_BUFFER_TIMESTAMP (buf),
+            "score", G_TYPE_DOUBLE, score,
+            "threshold", G_TYPE_DOUBLE, threshold,
+            "scene-change", G_TYPE_BOOLEAN, change, NULL));
+
+    gst_pad_push_event (GST_BASE_TRANSFORM_SRC_PAD (scenechange), event);
+  }
+
   if (change) {
     GstEvent *event;
 
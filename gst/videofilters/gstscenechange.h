@@ -23,6 +23,7 @@
 #include <gst/base/gstbasetransform.h>
 #include <gst/video/video.h>
 #include "gstvideofilter2.h"
+#include "gstscenechangedecimate.h"
 
 G_BEGIN_DECLS
 
@@ -35,15 +36,29 @@ G_BEGIN_DECLS
 typedef struct _GstSceneChange GstSceneChange;
 typedef struct _GstSceneChangeClass GstSceneChangeClass;
 
-#define SC_N_DIFFS 5
-
 struct _GstSceneChange
 {
   GstVideoFilter2 base_scenechange;
 
   int n_diffs;
   double diffs[SC_N_DIFFS];
-  GstBuffer *oldbuf;
+
+  /* luma of the current and the previous frame, decimated by downscale
+   * in both directions */
+  guint8 *plane;
+  guint8 *oldplane;
+  int plane_width;
+  int plane_height;
+  int plane_factor;
+  gboolean have_old;
+
+  /* sum of absolute differences of the current frame, added up by the
+   * slices under the object lock */
+  guint64 sad;
+
+  /* properties */
+  int downscale;
+  gboolean score_events;
 };
 
 struct _GstSceneChangeClass
@@ -0,0 +1,123 @@
+/* GStreamer
+ *
+ * gstscenechangedecimate.h: block averaging and scoring of the scenechange
+ * element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __GST_SCENE_CHANGE_DECIMATE_H__
+#define __GST_SCENE_CHANGE_DECIMATE_H__
+
+#include <string.h>
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define GST_SCENE_CHANGE_MAX_DOWNSCALE 8
+
+#define SC_N_DIFFS 5
+
+/* Number of blocks of a block row that are summed at a time, the line sums
+ * of that many blocks fit on the stack */
+#define GST_SCENE_CHANGE_DECIMATE_CHUNK 128
+
+/* Averages the factor x factor blocks of block rows j_start to j_end of
+ * @src into the tightly packed @plane, which is @width blocks wide.
+ * Columns that don't fill a block are left out. */
+static inline void
+gst_scene_change_decimate_rows (guint8 * plane, int width, int factor,
+    const guint8 * src, int stride, int j_start, int j_end)
+{
+  guint16 linesum[GST_SCENE_CHANGE_DECIMATE_CHUNK *
+      GST_SCENE_CHANGE_MAX_DOWNSCALE];
+  int area = factor * factor;
+  int c, i, j, k;
+
+  if (factor == 1) {
+    for (j = j_start; j < j_end; j++)
+      memcpy (plane + j * width, src + j * stride, width);
+    return;
+  }
+
+  for (j = j_start; j < j_end; j++) {
+    guint8 *dest = plane + j * width;
+
+    for (c = 0; c < width; c += GST_SCENE_CHANGE_DECIMATE_CHUNK) {
+      const guint8 *line = src + j * factor * stride + c * factor;
+      int n_blocks = MIN (GST_SCENE_CHANGE_DECIMATE_CHUNK, width - c);
+      int n = n_blocks * factor;
+
+      /* sum the lines of the blocks first, then the columns of each block */
+      for (i = 0; i < n; i++)
+        linesum[i] = line[i];
+      for (k = 1; k < factor; k++) {
+        line += stride;
+        for (i = 0; i < n; i++)
+          linesum[i] += line[i];
+      }
+
+      for (i = 0; i < n_blocks; i++) {
+        int sum = 0;
+
+        for (k = 0; k < factor; k++)
+          sum += linesum[i * factor + k];
+        dest[c + i] = (sum + area / 2) / area;
+      }
+    }
+  }
+}
+
+/* Appends @score, the mean absolute difference between the decimated luma
+ * of a frame and that of the previous one, to the last scores in @diffs,
+ * of which there were @n_diffs, and returns whether the frame starts a new
+ * scene. The threshold is derived from the scores before it. */
+static inline gboolean
+gst_scene_change_score (double *diffs, int *n_diffs, double score,
+    double *threshold)
+{
+  double score_min;
+  double score_max;
+  int i;
+
+  memmove (diffs, diffs + 1, sizeof (double) * (SC_N_DIFFS - 1));
+  diffs[SC_N_DIFFS - 1] = score;
+  (*n_diffs)++;
+
+  score_min = diffs[0];
+  score_max = diffs[0];
+  for (i = 1; i < SC_N_DIFFS - 1; i++) {
+    score_min = MIN (score_min, diffs[i]);
+    score_max = MAX (score_max, diffs[i]);
+  }
+
+  *threshold = 1.8 * score_max - 0.8 * score_min;
+
+  if (*n_diffs <= 2)
+    return FALSE;
+  if (score < 5)
+    return FALSE;
+  if (score / *threshold < 1.0)
+    return FALSE;
+  if (score / *threshold > 2.5)
+    return TRUE;
+  return score > 50;
+}
+
+G_END_DECLS
+
+#endif /* __GST_SCENE_CHANGE_DECIMATE_H__ */
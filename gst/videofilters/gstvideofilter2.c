@@ -19,6 +19,10 @@
 /**
  * SECTION:element-gstvideofilter2
  *
+ * Base class for filters with one function per video format. Subclasses
+ * that set slice_parallel get each frame split into bands of lines that
+ * are filtered in parallel on the band pool all elements of the plugin
+ * share; the number of bands is set with the n-threads property.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -28,8 +32,11 @@
 #include <gst/gst.h>
 #include <gst/base/gstbasetransform.h>
 #include <gst/video/video.h>
+#include <gst/bandpool/gstbandpool.h>
 #include "gstvideofilter2.h"
 
+#include <string.h>
+
 GST_DEBUG_CATEGORY_STATIC (gst_video_filter2_debug_category);
 #define GST_CAT_DEFAULT gst_video_filter2_debug_category
 
@@ -60,9 +67,27 @@ static GstFlowReturn gst_video_filter2_transform_ip (GstBaseTransform * trans,
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_N_THREADS
 };
 
+#define DEFAULT_N_THREADS 0
+
+/* slices start on multiples of this many lines, which keeps them aligned
+ * to the chroma subsampling of all formats */
+#define SLICE_ALIGN 16
+
+typedef struct
+{
+  GstVideoFilter2 *filter;
+  const GstVideoFilter2Functions *functions;
+  GstBuffer *inbuf;
+  GstBuffer *outbuf;
+  int start;
+  int end;
+  GstFlowReturn ret;
+} GstVideoFilter2Slice;
+
 
 /* class initialization */
 
@@ -116,6 +141,11 @@ gst_video_filter2_class_init (GstVideoFilter2Class * klass)
   base_transform_class->transform_ip =
       GST_DEBUG_FUNCPTR (gst_video_filter2_transform_ip);
 
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of slices of a frame filtered in parallel, for filters "
+          "that support it (0 = number of processors)", 0, G_MAXINT,
+          DEFAULT_N_THREADS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -124,15 +154,23 @@ gst_video_filter2_init (GstVideoFilter2 * videofilter2,
 {
 
   gst_base_transform_set_qos_enabled (GST_BASE_TRANSFORM (videofilter2), TRUE);
+
+  videofilter2->n_threads = DEFAULT_N_THREADS;
 }
 
 void
 gst_video_filter2_set_property (GObject * object, guint property_id,
     const GValue * value, GParamSpec * pspec)
 {
+  GstVideoFilter2 *videofilter2;
+
   g_return_if_fail (GST_IS_VIDEO_FILTER2 (object));
+  videofilter2 = GST_VIDEO_FILTER2 (object);
 
   switch (property_id) {
+    case PROP_N_THREADS:
+      videofilter2->n_threads = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -143,9 +181,15 @@ void
 gst_video_filter2_get_property (GObject * object, guint property_id,
     GValue * value, GParamSpec * pspec)
 {
+  GstVideoFilter2 *videofilter2;
+
   g_return_if_fail (GST_IS_VIDEO_FILTER2 (object));
+  videofilter2 = GST_VIDEO_FILTER2 (object);
 
   switch (property_id) {
+    case PROP_N_THREADS:
+      g_value_set_uint (value, videofilter2->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -231,12 +275,115 @@ gst_video_filter2_stop (GstBaseTransform * trans)
   return FALSE;
 }
 
+static void
+gst_video_filter2_run_slice (gpointer data, gpointer user_data)
+{
+  GstVideoFilter2Slice *slice = data;
+
+  if (slice->outbuf)
+    slice->ret = slice->functions->filter (slice->filter, slice->inbuf,
+        slice->outbuf, slice->start, slice->end);
+  else
+    slice->ret = slice->functions->filter_ip (slice->filter, slice->inbuf,
+        slice->start, slice->end);
+}
+
+/* Filters lines 0 to height, in slices on the pool if the subclass allows
+ * it. Without @outbuf the filter_ip function is used on @inbuf. */
+static GstFlowReturn
+gst_video_filter2_process (GstVideoFilter2 * video_filter2,
+    const GstVideoFilter2Functions * functions, GstBuffer * inbuf,
+    GstBuffer * outbuf)
+{
+  GstVideoFilter2Class *klass =
+      GST_VIDEO_FILTER2_CLASS (G_OBJECT_GET_CLASS (video_filter2));
+  GstVideoFilter2Slice *slices;
+  GstFlowReturn ret = GST_FLOW_OK;
+  int height = video_filter2->height;
+  int n_units = (height + SLICE_ALIGN - 1) / SLICE_ALIGN;
+  guint n_slices = 1;
+  guint i;
+
+  if (klass->slice_parallel)
+    n_slices = gst_band_pool_get_n_bands (video_filter2->n_threads, height,
+        SLICE_ALIGN);
+
+  slices = g_newa (GstVideoFilter2Slice, n_slices);
+  for (i = 0; i < n_slices; i++) {
+    slices[i].filter = video_filter2;
+    slices[i].functions = functions;
+    slices[i].inbuf = inbuf;
+    slices[i].outbuf = outbuf;
+    slices[i].start = MIN (n_units * i / n_slices * SLICE_ALIGN, height);
+    slices[i].end = MIN (n_units * (i + 1) / n_slices * SLICE_ALIGN, height);
+  }
+
+  if (n_slices > 1)
+    GST_LOG_OBJECT (video_filter2, "filtering in %u slices", n_slices);
+
+  gst_band_pool_run (gst_band_pool_get_default (),
+      gst_video_filter2_run_slice, NULL, slices, sizeof (GstVideoFilter2Slice),
+      n_slices);
+
+  for (i = 0; i < n_slices; i++) {
+    if (slices[i].ret != GST_FLOW_OK) {
+      ret = slices[i].ret;
+      break;
+    }
+  }
+
+  if (ret == GST_FLOW_OK && klass->postfilter)
+    ret = klass->postfilter (video_filter2, outbuf ? outbuf : inbuf);
+
+  return ret;
+}
+
+static const GstVideoFilter2Functions *
+gst_video_filter2_find_functions (GstVideoFilter2 * video_filter2)
+{
+  GstVideoFilter2Class *klass =
+      GST_VIDEO_FILTER2_CLASS (G_OBJECT_GET_CLASS (video_filter2));
+  int i;
+
+  for (i = 0; klass->functions[i].format != GST_VIDEO_FORMAT_UNKNOWN; i++) {
+    if (klass->functions[i].format == video_filter2->format)
+      return &klass->functions[i];
+  }
+
+  return NULL;
+}
+
 static GstFlowReturn
 gst_video_filter2_transform (GstBaseTransform * trans, GstBuffer * inbuf,
     GstBuffer * outbuf)
 {
+  GstVideoFilter2 *video_filter2 = GST_VIDEO_FILTER2 (trans);
+  GstVideoFilter2Class *klass =
+      GST_VIDEO_FILTER2_CLASS (G_OBJECT_GET_CLASS (trans));
+  const GstVideoFilter2Functions *functions;
+  GstFlowReturn ret;
 
-  return GST_FLOW_ERROR;
+  functions = gst_video_filter2_find_functions (video_filter2);
+  if (functions == NULL)
+    return GST_FLOW_ERROR;
+
+  if (klass->prefilter) {
+    ret = klass->prefilter (video_filter2, inbuf);
+    if (ret != GST_FLOW_OK)
+      return ret;
+  }
+
+  if (functions->filter)
+    return gst_video_filter2_process (video_filter2, functions, inbuf, outbuf);
+
+  /* only an in-place function, filter a copy */
+  if (functions->filter_ip == NULL)
+    return GST_FLOW_ERROR;
+
+  memcpy (GST_BUFFER_DATA (outbuf), GST_BUFFER_DATA (inbuf),
+      MIN (GST_BUFFER_SIZE (inbuf), GST_BUFFER_SIZE (outbuf)));
+
+  return gst_video_filter2_process (video_filter2, functions, outbuf, NULL);
 }
 
 static GstFlowReturn
@@ -245,18 +392,20 @@ gst_video_filter2_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
   GstVideoFilter2 *video_filter2 = GST_VIDEO_FILTER2 (trans);
   GstVideoFilter2Class *klass =
       GST_VIDEO_FILTER2_CLASS (G_OBJECT_GET_CLASS (trans));
-  int i;
+  const GstVideoFilter2Functions *functions;
   GstFlowReturn ret;
 
-  for (i = 0; klass->functions[i].format != GST_VIDEO_FORMAT_UNKNOWN; i++) {
-    if (klass->functions[i].format == video_filter2->format) {
-      ret = klass->functions[i].filter_ip (video_filter2, buf, 0,
-          video_filter2->height);
+  functions = gst_video_filter2_find_functions (video_filter2);
+  if (functions == NULL || functions->filter_ip == NULL)
+    return GST_FLOW_ERROR;
+
+  if (klass->prefilter) {
+    ret = klass->prefilter (video_filter2, buf);
+    if (ret != GST_FLOW_OK)
       return ret;
-    }
   }
 
-  return GST_FLOW_ERROR;
+  return gst_video_filter2_process (video_filter2, functions, buf, NULL);
 }
 
 /* API */
@@ -267,3 +416,13 @@ gst_video_filter2_class_add_functions (GstVideoFilter2Class * klass,
 {
   klass->functions = functions;
 }
+
+/* Lets the frames be split into slices that are filtered in parallel. Only
+ * for subclasses whose filter functions touch nothing outside of the lines
+ * they are given and keep no state across lines. */
+void
+gst_video_filter2_class_set_slice_parallel (GstVideoFilter2Class * klass,
+    gboolean slice_parallel)
+{
+  klass->slice_parallel = slice_parallel;
+}
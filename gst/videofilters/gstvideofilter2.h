@@ -43,6 +43,9 @@ struct _GstVideoFilter2
   int width;
   int height;
 
+  /* properties */
+  guint n_threads;
+
   gpointer _gst_reserved[GST_PADDING_LARGE];
 };
 
@@ -53,6 +56,12 @@ struct _GstVideoFilter2Class
   const GstVideoFilter2Functions *functions;
 
   GstFlowReturn (*prefilter) (GstVideoFilter2 *filter, GstBuffer *inbuf);
+  /* called with the filtered buffer once all slices are done */
+  GstFlowReturn (*postfilter) (GstVideoFilter2 *filter, GstBuffer *buf);
+
+  /* the filter functions only touch lines start to end and may be called
+   * for several slices of a frame at the same time */
+  gboolean slice_parallel;
 
   gpointer _gst_reserved[GST_PADDING_LARGE];
 };
@@ -75,6 +84,8 @@ GType gst_video_filter2_get_type (void);
 
 void gst_video_filter2_class_add_functions (GstVideoFilter2Class *klass,
     const GstVideoFilter2Functions *functions);
+void gst_video_filter2_class_set_slice_parallel (GstVideoFilter2Class *klass,
+    gboolean slice_parallel);
 
 G_END_DECLS
 
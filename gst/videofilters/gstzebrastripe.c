@@ -125,6 +125,7 @@ gst_zebra_stripe_class_init (GstZebraStripeClass * klass)
 
   gst_video_filter2_class_add_functions (video_filter2_class,
       gst_zebra_stripe_filter_functions);
+  gst_video_filter2_class_set_slice_parallel (video_filter2_class, TRUE);
 }
 
 static void
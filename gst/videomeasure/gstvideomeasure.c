@@ -31,6 +31,25 @@ GstEvent *
 gst_event_new_measured (guint64 framenumber, GstClockTime timestamp,
     const gchar * metric, const GValue * mean, const GValue * lowest,
     const GValue * highest)
+{
+  return gst_event_new_measured_full (framenumber, timestamp, metric, mean,
+      lowest, highest, NULL);
+}
+
+static gboolean
+gst_event_measured_copy_field (GQuark field_id, const GValue * value,
+    gpointer user_data)
+{
+  gst_structure_id_set_value ((GstStructure *) user_data, field_id, value);
+  return TRUE;
+}
+
+/* Like gst_event_new_measured(), with the fields of @extra (such as other
+ * metrics of the same frame) appended after the standard ones */
+GstEvent *
+gst_event_new_measured_full (guint64 framenumber, GstClockTime timestamp,
+    const gchar * metric, const GValue * mean, const GValue * lowest,
+    const GValue * highest, const GstStructure * extra)
 {
   GstStructure *str = gst_structure_new (GST_EVENT_VIDEO_MEASURE,
       "event", G_TYPE_STRING, "frame-measured",
@@ -41,6 +60,8 @@ gst_event_new_measured (guint64 framenumber, GstClockTime timestamp,
   gst_structure_set_value (str, "mean", mean);
   gst_structure_set_value (str, "lowest", lowest);
   gst_structure_set_value (str, "highest", highest);
+  if (extra)
+    gst_structure_foreach (extra, gst_event_measured_copy_field, str);
   return gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM, str);
 }
 
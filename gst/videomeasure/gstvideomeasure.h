@@ -27,5 +27,8 @@
 GstEvent *gst_event_new_measured (guint64 framenumber, GstClockTime timestamp,
     const gchar *metric, const GValue *mean, const GValue *lowest,
     const GValue *highest);
+GstEvent *gst_event_new_measured_full (guint64 framenumber,
+    GstClockTime timestamp, const gchar *metric, const GValue *mean,
+    const GValue *lowest, const GValue *highest, const GstStructure *extra);
 
 #endif /* __GST_VIDEO_MEASURE_H__ */
@@ -71,7 +71,11 @@ GST_STATIC_PAD_TEMPLATE ("sink",
 static void gst_measure_collector_finalize (GObject * object);
 static gboolean gst_measure_collector_event (GstBaseTransform * base,
     GstEvent * event);
-static void gst_measure_collector_save_csv (GstMeasureCollector * mc);
+static gboolean gst_measure_collector_open_csv (GstMeasureCollector * mc,
+    const GstStructure * str);
+static void gst_measure_collector_write_csv (GstMeasureCollector * mc,
+    gboolean eos);
+static void gst_measure_collector_close_csv (GstMeasureCollector * mc);
 
 static void gst_measure_collector_post_message (GstMeasureCollector * mc);
 
@@ -114,6 +118,13 @@ gst_measure_collector_collect (GstMeasureCollector * mc, GstEvent * gstevent)
 
     if (!mc->metric)
       mc->metric = g_strdup (metric);
+
+    /* stream the rows to the file as soon as they are complete instead of
+     * holding the whole sequence until EOS */
+    if ((mc->flags & GST_MEASURE_COLLECTOR_WRITE_CSV) && !mc->csv_failed) {
+      if (mc->file != NULL || gst_measure_collector_open_csv (mc, cpy))
+        gst_measure_collector_write_csv (mc, FALSE);
+    }
   }
 }
 
@@ -209,7 +220,8 @@ gst_measure_collector_event (GstBaseTransform * base, GstEvent * event)
       break;
     case GST_EVENT_EOS:
       gst_measure_collector_post_message (mc);
-      gst_measure_collector_save_csv (mc);
+      gst_measure_collector_write_csv (mc, TRUE);
+      gst_measure_collector_close_csv (mc);
       break;
     default:
       break;
@@ -218,21 +230,13 @@ gst_measure_collector_event (GstBaseTransform * base, GstEvent * event)
   return parent_class->event (base, event);
 }
 
-static void
-gst_measure_collector_save_csv (GstMeasureCollector * mc)
+/* Opens the file and writes the header, using the fields of @str */
+static gboolean
+gst_measure_collector_open_csv (GstMeasureCollector * mc,
+    const GstStructure * str)
 {
   gchar *name_local;
-  FILE *file;
-  guint64 i, j;
-  GstStructure *str;
-  GValue tmp = { 0 };
-  g_value_init (&tmp, G_TYPE_STRING);
-
-  if (!(mc->flags & GST_MEASURE_COLLECTOR_WRITE_CSV))
-    return;
-
-  if (mc->measurements->len <= 0)
-    goto empty;
+  guint j;
 
   /* open the file */
   if (mc->filename == NULL || mc->filename[0] == '\0')
@@ -249,67 +253,96 @@ gst_measure_collector_save_csv (GstMeasureCollector * mc)
   /* FIXME, can we use g_fopen here? some people say that the FILE object is
    * local to the .so that performed the fopen call, which would not be us when
    * we use g_fopen. */
-  file = fopen (name_local, "wb");
+  mc->file = fopen (name_local, "wb");
 
   g_free (name_local);
 
-  if (file == NULL)
+  if (mc->file == NULL)
     goto open_failed;
 
-  str = (GstStructure *) g_ptr_array_index (mc->measurements, 0);
-
   for (j = 0; j < gst_structure_n_fields (str); j++) {
     const gchar *fieldname;
     fieldname = gst_structure_nth_field_name (str, j);
     if (G_LIKELY (j > 0))
-      fprintf (file, ";");
-    fprintf (file, "%s", fieldname);
-  }
-
-  for (i = 0; i < mc->measurements->len; i++) {
-    fprintf (file, "\n");
-    str = (GstStructure *) g_ptr_array_index (mc->measurements, i);
-    if (str != NULL) {
-      for (j = 0; j < gst_structure_n_fields (str); j++) {
-        const gchar *fieldname;
-        fieldname = gst_structure_nth_field_name (str, j);
-        if (G_LIKELY (j > 0))
-          fprintf (file, ";");
-        if (G_LIKELY (g_value_transform (gst_structure_get_value (str,
-                        fieldname), &tmp)))
-          fprintf (file, "%s", g_value_get_string (&tmp));
-        else
-          fprintf (file, "<untranslatable>");
-      }
-    }
+      fprintf (mc->file, ";");
+    fprintf (mc->file, "%s", fieldname);
   }
+  mc->written = 0;
 
-  fclose (file);
+  return TRUE;
 
   /* ERRORS */
-empty:
-  {
-    return;
-  }
 no_filename:
   {
     GST_ELEMENT_ERROR (mc, RESOURCE, NOT_FOUND,
         (_("No file name specified for writing.")), (NULL));
-    return;
+    mc->csv_failed = TRUE;
+    return FALSE;
   }
 not_good_filename:
   {
+    g_free (name_local);
     GST_ELEMENT_ERROR (mc, RESOURCE, NOT_FOUND,
         (_("Given file name \"%s\" can't be converted to local file name \
 encoding."), mc->filename), (NULL));
-    return;
+    mc->csv_failed = TRUE;
+    return FALSE;
   }
 open_failed:
   {
     GST_ELEMENT_ERROR (mc, RESOURCE, OPEN_WRITE,
         (_("Could not open file \"%s\" for writing."), mc->filename),
         GST_ERROR_SYSTEM);
+    mc->csv_failed = TRUE;
+    return FALSE;
+  }
+}
+
+/* Writes the rows of all frames measured so far. Rows are written in frame
+ * order, so a frame that has not been measured yet holds back the frames
+ * after it, unless at @eos where it is left empty */
+static void
+gst_measure_collector_write_csv (GstMeasureCollector * mc, gboolean eos)
+{
+  GstStructure *str;
+  guint j;
+  GValue tmp = { 0 };
+
+  if (mc->file == NULL)
     return;
+
+  g_value_init (&tmp, G_TYPE_STRING);
+
+  for (; mc->written < mc->measurements->len; mc->written++) {
+    str = (GstStructure *) g_ptr_array_index (mc->measurements, mc->written);
+    if (str == NULL && !eos)
+      break;
+
+    fprintf (mc->file, "\n");
+    if (str != NULL) {
+      for (j = 0; j < gst_structure_n_fields (str); j++) {
+        const gchar *fieldname;
+        fieldname = gst_structure_nth_field_name (str, j);
+        if (G_LIKELY (j > 0))
+          fprintf (mc->file, ";");
+        if (G_LIKELY (g_value_transform (gst_structure_get_value (str,
+                        fieldname), &tmp)))
+          fprintf (mc->file, "%s", g_value_get_string (&tmp));
+        else
+          fprintf (mc->file, "<untranslatable>");
+      }
+    }
+  }
+
+  g_value_unset (&tmp);
+}
+
+static void
+gst_measure_collector_close_csv (GstMeasureCollector * mc)
+{
+  if (mc->file != NULL) {
+    fclose (mc->file);
+    mc->file = NULL;
   }
 }
 
@@ -383,6 +416,9 @@ gst_measure_collector_init (GstMeasureCollector * instance,
   measurecollector->flags = 0;
   measurecollector->nextoffset = 0;
   measurecollector->result = NULL;
+  measurecollector->file = NULL;
+  measurecollector->written = 0;
+  measurecollector->csv_failed = FALSE;
 }
 
 static void
@@ -391,6 +427,8 @@ gst_measure_collector_finalize (GObject * object)
   gint i;
   GstMeasureCollector *mc = GST_MEASURE_COLLECTOR (object);
 
+  gst_measure_collector_close_csv (mc);
+
   for (i = 0; i < mc->measurements->len; i++) {
     if (g_ptr_array_index (mc->measurements, i) != NULL)
       gst_structure_free ((GstStructure *) g_ptr_array_index (mc->measurements,
@@ -22,6 +22,7 @@
 
 #include "gstvideomeasure.h"
 #include <gst/base/gstbasetransform.h>
+#include <stdio.h>
 
 G_BEGIN_DECLS
 
@@ -67,6 +68,11 @@ struct _GstMeasureCollector {
   gchar *metric;
 
   gboolean inited;
+
+  /* CSV output, rows before written are in the file */
+  FILE *file;
+  guint64 written;
+  gboolean csv_failed;
 };
 
 struct _GstMeasureCollectorClass {
@@ -34,6 +34,8 @@
  * message.
  * ssim is intended to be used with videomeasure_collector element to catch the 
  * events (such as mean SSIM index values) and save them into a file.
+ * The measurement events also carry the Y-PSNR of the frame and, with
+ * #GstSSim:ms-ssim, its multi-scale SSIM.
  *
  * <refsect2>
  * <title>Example launch line</title>
@@ -197,287 +199,6 @@ gst_ssim_sink_getcaps (GstPad * pad)
   return result;
 }
 
-static void
-calculate_mu (GstSSim * ssim, gfloat * outmu, guint8 * buf)
-{
-  gint oy, ox, iy, ix;
-
-  for (oy = 0; oy < ssim->height; oy++) {
-    for (ox = 0; ox < ssim->width; ox++) {
-      gfloat mu = 0;
-      gfloat elsumm;
-      gint weight_y_base, weight_x_base;
-      gint weight_offset;
-      gint pixel_offset;
-      gint winstart_y;
-      gint wghstart_y;
-      gint winend_y;
-      gint winstart_x;
-      gint wghstart_x;
-      gint winend_x;
-      gfloat weight;
-      gint source_offset;
-
-      source_offset = oy * ssim->width + ox;
-
-      winstart_x = ssim->windows[source_offset].x_window_start;
-      wghstart_x = ssim->windows[source_offset].x_weight_start;
-      winend_x = ssim->windows[source_offset].x_window_end;
-      winstart_y = ssim->windows[source_offset].y_window_start;
-      wghstart_y = ssim->windows[source_offset].y_weight_start;
-      winend_y = ssim->windows[source_offset].y_window_end;
-      elsumm = ssim->windows[source_offset].element_summ;
-
-      switch (ssim->windowtype) {
-        case 0:
-          for (iy = winstart_y; iy <= winend_y; iy++) {
-            pixel_offset = iy * ssim->width;
-            for (ix = winstart_x; ix <= winend_x; ix++)
-              mu += buf[pixel_offset + ix];
-          }
-          mu = mu / elsumm;
-          break;
-        case 1:
-
-          weight_y_base = wghstart_y - winstart_y;
-          weight_x_base = wghstart_x - winstart_x;
-
-          for (iy = winstart_y; iy <= winend_y; iy++) {
-            pixel_offset = iy * ssim->width;
-            weight_offset = (weight_y_base + iy) * ssim->windowsize +
-                weight_x_base;
-            for (ix = winstart_x; ix <= winend_x; ix++) {
-              weight = ssim->weights[weight_offset + ix];
-              mu += weight * buf[pixel_offset + ix];
-            }
-          }
-          mu = mu / elsumm;
-          break;
-      }
-      outmu[oy * ssim->width + ox] = mu;
-    }
-  }
-
-}
-
-static void
-calcssim_without_mu (GstSSim * ssim, guint8 * org, gfloat * orgmu, guint8 * mod,
-    guint8 * out, gfloat * mean, gfloat * lowest, gfloat * highest)
-{
-  gint oy, ox, iy, ix;
-  gfloat cumulative_ssim = 0;
-  *lowest = G_MAXFLOAT;
-  *highest = -G_MAXFLOAT;
-
-  for (oy = 0; oy < ssim->height; oy++) {
-    for (ox = 0; ox < ssim->width; ox++) {
-      gfloat mu_o = 128, mu_m = 128;
-      gdouble sigma_o = 0, sigma_m = 0, sigma_om = 0;
-      gfloat tmp1 = 0, tmp2 = 0;
-      gfloat elsumm = 0;
-      gint weight_y_base, weight_x_base;
-      gint weight_offset;
-      gint pixel_offset;
-      gint winstart_y;
-      gint wghstart_y;
-      gint winend_y;
-      gint winstart_x;
-      gint wghstart_x;
-      gint winend_x;
-      gfloat weight;
-      gint source_offset;
-
-      source_offset = oy * ssim->width + ox;
-
-      winstart_x = ssim->windows[source_offset].x_window_start;
-      wghstart_x = ssim->windows[source_offset].x_weight_start;
-      winend_x = ssim->windows[source_offset].x_window_end;
-      winstart_y = ssim->windows[source_offset].y_window_start;
-      wghstart_y = ssim->windows[source_offset].y_weight_start;
-      winend_y = ssim->windows[source_offset].y_window_end;
-      elsumm = ssim->windows[source_offset].element_summ;
-
-      weight_y_base = wghstart_y - winstart_y;
-      weight_x_base = wghstart_x - winstart_x;
-      switch (ssim->windowtype) {
-        case 0:
-          for (iy = winstart_y; iy <= winend_y; iy++) {
-            guint8 *org_with_offset, *mod_with_offset;
-            pixel_offset = iy * ssim->width;
-            org_with_offset = &org[pixel_offset];
-            mod_with_offset = &mod[pixel_offset];
-            for (ix = winstart_x; ix <= winend_x; ix++) {
-              tmp1 = org_with_offset[ix] - mu_o;
-              sigma_o += tmp1 * tmp1;
-              tmp2 = mod_with_offset[ix] - mu_m;
-              sigma_m += tmp2 * tmp2;
-              sigma_om += tmp1 * tmp2;
-            }
-          }
-          break;
-        case 1:
-
-          weight_y_base = wghstart_y - winstart_y;
-          weight_x_base = wghstart_x - winstart_x;
-
-          for (iy = winstart_y; iy <= winend_y; iy++) {
-            guint8 *org_with_offset, *mod_with_offset;
-            gfloat *weights_with_offset;
-            gfloat wt1, wt2;
-            pixel_offset = iy * ssim->width;
-            weight_offset = (weight_y_base + iy) * ssim->windowsize +
-                weight_x_base;
-            org_with_offset = &org[pixel_offset];
-            mod_with_offset = &mod[pixel_offset];
-            weights_with_offset = &ssim->weights[weight_offset];
-            for (ix = winstart_x; ix <= winend_x; ix++) {
-              weight = weights_with_offset[ix];
-              tmp1 = org_with_offset[ix] - mu_o;
-              tmp2 = mod_with_offset[ix] - mu_m;
-              wt1 = weight * tmp1;
-              wt2 = weight * tmp2;
-              sigma_o += wt1 * tmp1;
-              sigma_m += wt2 * tmp2;
-              sigma_om += wt1 * tmp2;
-            }
-          }
-          break;
-      }
-      sigma_o = sqrt (sigma_o / elsumm);
-      sigma_m = sqrt (sigma_m / elsumm);
-      sigma_om = sigma_om / elsumm;
-      tmp1 = (2 * mu_o * mu_m + ssim->const1) * (2 * sigma_om + ssim->const2) /
-          ((mu_o * mu_o + mu_m * mu_m + ssim->const1) *
-          (sigma_o * sigma_o + sigma_m * sigma_m + ssim->const2));
-
-      /* SSIM can go negative, that's why it is
-         127 + index * 128 instead of index * 255 */
-      out[oy * ssim->width + ox] = 127 + tmp1 * 128;
-      *lowest = MIN (*lowest, tmp1);
-      *highest = MAX (*highest, tmp1);
-      cumulative_ssim += tmp1;
-    }
-  }
-  *mean = cumulative_ssim / (ssim->width * ssim->height);
-}
-
-static void
-calcssim_canonical (GstSSim * ssim, guint8 * org, gfloat * orgmu, guint8 * mod,
-    guint8 * out, gfloat * mean, gfloat * lowest, gfloat * highest)
-{
-  gint oy, ox, iy, ix;
-  gfloat cumulative_ssim = 0;
-  *lowest = G_MAXFLOAT;
-  *highest = -G_MAXFLOAT;
-
-  for (oy = 0; oy < ssim->height; oy++) {
-    for (ox = 0; ox < ssim->width; ox++) {
-      gfloat mu_o = 0, mu_m = 0;
-      gdouble sigma_o = 0, sigma_m = 0, sigma_om = 0;
-      gfloat tmp1, tmp2;
-      gfloat elsumm = 0;
-      gint weight_y_base, weight_x_base;
-      gint weight_offset;
-      gint pixel_offset;
-      gint winstart_y;
-      gint wghstart_y;
-      gint winend_y;
-      gint winstart_x;
-      gint wghstart_x;
-      gint winend_x;
-      gfloat weight;
-      gint source_offset;
-
-      source_offset = oy * ssim->width + ox;
-
-      winstart_x = ssim->windows[source_offset].x_window_start;
-      wghstart_x = ssim->windows[source_offset].x_weight_start;
-      winend_x = ssim->windows[source_offset].x_window_end;
-      winstart_y = ssim->windows[source_offset].y_window_start;
-      wghstart_y = ssim->windows[source_offset].y_weight_start;
-      winend_y = ssim->windows[source_offset].y_window_end;
-      elsumm = ssim->windows[source_offset].element_summ;
-
-      switch (ssim->windowtype) {
-        case 0:
-          for (iy = winstart_y; iy <= winend_y; iy++) {
-            pixel_offset = iy * ssim->width;
-            for (ix = winstart_x; ix <= winend_x; ix++) {
-              mu_m += mod[pixel_offset + ix];
-            }
-          }
-          mu_m = mu_m / elsumm;
-          mu_o = orgmu[oy * ssim->width + ox];
-          for (iy = winstart_y; iy <= winend_y; iy++) {
-            pixel_offset = iy * ssim->width;
-            for (ix = winstart_x; ix <= winend_x; ix++) {
-              tmp1 = org[pixel_offset + ix] - mu_o;
-              tmp2 = mod[pixel_offset + ix] - mu_m;
-              sigma_o += tmp1 * tmp1;
-              sigma_m += tmp2 * tmp2;
-              sigma_om += tmp1 * tmp2;
-            }
-          }
-          break;
-        case 1:
-
-          weight_y_base = wghstart_y - winstart_y;
-          weight_x_base = wghstart_x - winstart_x;
-
-          for (iy = winstart_y; iy <= winend_y; iy++) {
-            pixel_offset = iy * ssim->width;
-            weight_offset = (weight_y_base + iy) * ssim->windowsize +
-                weight_x_base;
-            for (ix = winstart_x; ix <= winend_x; ix++) {
-              weight = ssim->weights[weight_offset + ix];
-              mu_o += weight * org[pixel_offset + ix];
-              mu_m += weight * mod[pixel_offset + ix];
-            }
-          }
-          mu_m = mu_m / elsumm;
-          mu_o = orgmu[oy * ssim->width + ox];
-          for (iy = winstart_y; iy <= winend_y; iy++) {
-            gfloat *weights_with_offset;
-            guint8 *org_with_offset, *mod_with_offset;
-            gfloat wt1, wt2;
-            pixel_offset = iy * ssim->width;
-            weight_offset = (weight_y_base + iy) * ssim->windowsize +
-                weight_x_base;
-            weights_with_offset = &ssim->weights[weight_offset];
-            org_with_offset = &org[pixel_offset];
-            mod_with_offset = &mod[pixel_offset];
-            for (ix = winstart_x; ix <= winend_x; ix++) {
-              weight = weights_with_offset[ix];
-              tmp1 = org_with_offset[ix] - mu_o;
-              tmp2 = mod_with_offset[ix] - mu_m;
-              wt1 = weight * tmp1;
-              wt2 = weight * tmp2;
-              sigma_o += wt1 * tmp1;
-              sigma_m += wt2 * tmp2;
-              sigma_om += wt1 * tmp2;
-            }
-          }
-          break;
-      }
-      sigma_o = sqrt (sigma_o / elsumm);
-      sigma_m = sqrt (sigma_m / elsumm);
-      sigma_om = sigma_om / elsumm;
-      tmp1 = (2 * mu_o * mu_m + ssim->const1) * (2 * sigma_om + ssim->const2) /
-          ((mu_o * mu_o + mu_m * mu_m + ssim->const1) *
-          (sigma_o * sigma_o + sigma_m * sigma_m + ssim->const2));
-
-      /* SSIM can go negative, that's why it is
-         127 + index * 128 instead of index * 255 */
-      out[oy * ssim->width + ox] = 127 + tmp1 * 128;
-      *lowest = MIN (*lowest, tmp1);
-      *highest = MAX (*highest, tmp1);
-      cumulative_ssim += tmp1;
-    }
-  }
-  *mean = cumulative_ssim / (ssim->width * ssim->height);
-}
-
-
 /* the first caps we receive on any of the sinkpads will define the caps for all
  * the other sinkpads because we can only measure streams with the same caps.
  */
@@ -1015,18 +736,21 @@ gst_ssim_set_property (GObject * object, guint prop_id,
       break;
     case PROP_WINDOW_TYPE:
       ssim->windowtype = g_value_get_int (value);
-      g_free (ssim->windows);
-      ssim->windows = NULL;
       break;
     case PROP_WINDOW_SIZE:
       ssim->windowsize = g_value_get_int (value);
-      g_free (ssim->windows);
-      ssim->windows = NULL;
       break;
     case PROP_GAUSS_SIGMA:
       ssim->sigma = g_value_get_float (value);
-      g_free (ssim->windows);
-      ssim->windows = NULL;
+      break;
+    case PROP_N_THREADS:
+      ssim->n_threads = g_value_get_uint (value);
+      if (ssim->quality)
+        gst_video_quality_free (ssim->quality);
+      ssim->quality = NULL;
+      break;
+    case PROP_MS_SSIM:
+      ssim->ms_ssim = g_value_get_boolean (value);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1055,6 +779,12 @@ gst_ssim_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_GAUSS_SIGMA:
       g_value_set_float (value, ssim->sigma);
       break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, ssim->n_threads);
+      break;
+    case PROP_MS_SSIM:
+      g_value_set_boolean (value, ssim->ms_ssim);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1075,7 +805,7 @@ gst_ssim_class_init (GstSSimClass * klass)
   g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_SSIM_TYPE,
       g_param_spec_int ("ssim-type", "SSIM type",
           "Type of the SSIM metric. 0 - canonical. 1 - with fixed mu "
-          "(almost the same results, but roughly 20% faster)",
+          "(almost the same results)",
           0, 1, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_WINDOW_TYPE,
@@ -1095,6 +825,18 @@ gst_ssim_class_init (GstSSimClass * klass)
           "(only when using Gaussian window).",
           G_MINFLOAT, 10, 1.5, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of line bands measured in parallel "
+          "(0 = number of processors)", 0, G_MAXINT, 0,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_MS_SSIM,
+      g_param_spec_boolean ("ms-ssim", "MS-SSIM",
+          "Also measure the multi-scale SSIM of each frame "
+          "(\"ms-ssim\" field of the measurement)", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&gst_ssim_src_template));
   gst_element_class_add_pad_template (gstelement_class,
@@ -1258,13 +1000,15 @@ gst_ssim_init (GstSSim * ssim)
 {
   ssim->windowsize = 11;
   ssim->windowtype = 1;
-  ssim->windows = NULL;
   ssim->sigma = 1.5;
   ssim->ssimtype = 0;
   ssim->src = g_ptr_array_new ();
   ssim->padcount = 0;
   ssim->collect_event = NULL;
   ssim->sinkcaps = NULL;
+  ssim->n_threads = 0;
+  ssim->ms_ssim = FALSE;
+  ssim->quality = NULL;
 
   /* keep track of the sinkpads requested */
   ssim->collect = gst_collect_pads_new ();
@@ -1280,11 +1024,9 @@ gst_ssim_finalize (GObject * object)
   gst_object_unref (ssim->collect);
   ssim->collect = NULL;
 
-  g_free (ssim->windows);
-  ssim->windows = NULL;
-
-  g_free (ssim->weights);
-  ssim->weights = NULL;
+  if (ssim->quality)
+    gst_video_quality_free (ssim->quality);
+  ssim->quality = NULL;
 
   if (ssim->sinkcaps)
     gst_caps_unref (ssim->sinkcaps);
@@ -1296,114 +1038,55 @@ gst_ssim_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
-typedef gfloat (*GstSSimWeightFunc) (GstSSim * ssim, gint y, gint x);
-
-static gfloat
-gst_ssim_weight_func_none (GstSSim * ssim, gint y, gint x)
-{
-  return 1;
-}
-
-static gfloat
-gst_ssim_weight_func_gauss (GstSSim * ssim, gint y, gint x)
-{
-  gfloat coord = sqrt (x * x + y * y);
-  return exp (-1 * (coord * coord) / (2 * ssim->sigma * ssim->sigma)) /
-      (ssim->sigma * sqrt (2 * G_PI));
-}
-
-static gboolean
-gst_ssim_regenerate_windows (GstSSim * ssim)
+/* The SSIM map of the Y plane into @out, its mean, lowest and highest
+ * value and PSNR and MS-SSIM as fields to add to the measurement */
+static GstStructure *
+gst_ssim_measure_quality (GstSSim * ssim, guint8 * org, guint8 * mod,
+    guint8 * out, gfloat * mean, gfloat * lowest, gfloat * highest)
 {
-  gint windowiseven;
-  gint y, x, y2, x2;
-  GstSSimWeightFunc func;
-  gfloat normal_summ = 0;
-  gint normal_count = 0;
-
-  g_free (ssim->weights);
-
-  ssim->weights = g_new (gfloat, ssim->windowsize * ssim->windowsize);
-
-  windowiseven = ((gint) ssim->windowsize / 2) * 2 == ssim->windowsize ? 1 : 0;
-
-  g_free (ssim->windows);
-
-  ssim->windows = g_new (GstSSimWindowCache, ssim->height * ssim->width);
-
-  switch (ssim->windowtype) {
-    case 0:
-      func = gst_ssim_weight_func_none;
-      break;
-    case 1:
-      func = gst_ssim_weight_func_gauss;
-      break;
-    default:
-      GST_WARNING_OBJECT (ssim, "unknown window type - %d. Defaulting to %d",
-          ssim->windowtype, 1);
-      ssim->windowtype = 1;
-      func = gst_ssim_weight_func_gauss;
-  }
-
-  for (y = 0; y < ssim->windowsize; y++) {
-    gint yoffset = y * ssim->windowsize;
-    for (x = 0; x < ssim->windowsize; x++) {
-      ssim->weights[yoffset + x] = func (ssim, x - ssim->windowsize / 2 +
-          windowiseven, y - ssim->windowsize / 2 + windowiseven);
-      normal_summ += ssim->weights[yoffset + x];
-      normal_count++;
-    }
-  }
-
-  for (y = 0; y < ssim->height; y++) {
-    for (x = 0; x < ssim->width; x++) {
-      GstSSimWindowCache win;
-      gint element_count = 0;
-
-      win.x_window_start = x - ssim->windowsize / 2 + windowiseven;
-      win.x_weight_start = 0;
-      if (win.x_window_start < 0) {
-        win.x_weight_start = -win.x_window_start;
-        win.x_window_start = 0;
-      }
-
-      win.x_window_end = x + ssim->windowsize / 2;
-      if (win.x_window_end >= ssim->width)
-        win.x_window_end = ssim->width - 1;
-
-      win.y_window_start = y - ssim->windowsize / 2 + windowiseven;
-      win.y_weight_start = 0;
-      if (win.y_window_start < 0) {
-        win.y_weight_start = -win.y_window_start;
-        win.y_window_start = 0;
-      }
-
-      win.y_window_end = y + ssim->windowsize / 2;
-      if (win.y_window_end >= ssim->height)
-        win.y_window_end = ssim->height - 1;
-
-      win.element_summ = 0;
-      element_count = (win.y_window_end - win.y_window_start + 1) *
-          (win.x_window_end - win.x_window_start + 1);
-      if (element_count == normal_count)
-        win.element_summ = normal_summ;
-      else {
-        for (y2 = win.y_weight_start; y2 < ssim->windowsize; y2++) {
-          for (x2 = win.x_weight_start; x2 < ssim->windowsize; x2++) {
-            win.element_summ += ssim->weights[y2 * ssim->windowsize + x2];
-          }
-        }
-      }
-      ssim->windows[(y * ssim->width + x)] = win;
-    }
-  }
-
-  /* FIXME: while 0.01 and 0.03 are pretty much static, the 255 implies that
-   * we're working with 8-bit-per-color-component format, which may not be true
-   */
-  ssim->const1 = 0.01 * 255 * 0.01 * 255;
-  ssim->const2 = 0.03 * 255 * 0.03 * 255;
-  return TRUE;
+  GstVideoQualityMetrics metrics = GST_VIDEO_QUALITY_METRIC_PSNR;
+  GstVideoQualityPlane orgplane, modplane;
+  GstVideoQualityResult result;
+  GstStructure *str;
+  gdouble low, high;
+
+  if (ssim->quality == NULL)
+    ssim->quality = gst_video_quality_new (ssim->n_threads);
+
+  gst_video_quality_set_ssim_map_window (ssim->quality,
+      ssim->windowtype == 0 ? GST_VIDEO_QUALITY_WINDOW_FLAT :
+      GST_VIDEO_QUALITY_WINDOW_GAUSSIAN, ssim->windowsize, ssim->sigma);
+  gst_video_quality_set_ssim_map_fixed_mean (ssim->quality,
+      ssim->ssimtype == 1);
+
+  /* the Y plane and the grey output both have 4 byte aligned lines */
+  orgplane.data = org;
+  orgplane.width = ssim->width;
+  orgplane.height = ssim->height;
+  orgplane.pstride = 1;
+  orgplane.stride = GST_ROUND_UP_4 (ssim->width);
+  modplane = orgplane;
+  modplane.data = mod;
+
+  *mean = gst_video_quality_ssim_map (ssim->quality, &orgplane, &modplane,
+      out, GST_ROUND_UP_4 (ssim->width), &low, &high);
+  *lowest = low;
+  *highest = high;
+
+  if (ssim->ms_ssim)
+    metrics |= GST_VIDEO_QUALITY_METRIC_MS_SSIM;
+
+  gst_video_quality_measure (ssim->quality, metrics, &orgplane, &modplane, 1,
+      &result);
+
+  GST_LOG_OBJECT (ssim, "PSNR is %f dB, MSE is %f", result.psnr, result.mse);
+
+  str = gst_structure_empty_new ("quality");
+  gst_structure_set (str, "psnr", G_TYPE_DOUBLE, result.psnr, NULL);
+  if (ssim->ms_ssim)
+    gst_structure_set (str, "ms-ssim", G_TYPE_DOUBLE, result.ms_ssim, NULL);
+
+  return str;
 }
 
 static GstFlowReturn
@@ -1413,7 +1096,6 @@ gst_ssim_collected (GstCollectPads * pads, gpointer user_data)
   GSList *collected;
   GstFlowReturn ret = GST_FLOW_OK;
   GstBuffer *orgbuf = NULL;
-  gfloat *orgmu = NULL;
   GstBuffer *outbuf = NULL;
   gpointer outdata = NULL;
   guint outsize = 0;
@@ -1423,21 +1105,8 @@ gst_ssim_collected (GstCollectPads * pads, gpointer user_data)
 
   ssim = GST_SSIM (user_data);
 
-  if (G_UNLIKELY (ssim->windows == NULL)) {
-    GST_DEBUG_OBJECT (ssim, "Regenerating windows");
-    gst_ssim_regenerate_windows (ssim);
-  }
-
-  switch (ssim->ssimtype) {
-    case 0:
-      ssim->func = (GstSSimFunction) calcssim_canonical;
-      break;
-    case 1:
-      ssim->func = (GstSSimFunction) calcssim_without_mu;
-      break;
-    default:
-      return GST_FLOW_ERROR;
-  }
+  if (ssim->ssimtype != 0 && ssim->ssimtype != 1)
+    return GST_FLOW_ERROR;
 
   for (collected = pads->data; collected; collected = g_slist_next (collected)) {
     GstCollectData *collect_data;
@@ -1463,28 +1132,20 @@ gst_ssim_collected (GstCollectPads * pads, gpointer user_data)
   if (G_UNLIKELY (!ready))
     goto eos;
 
-  /* Mu is just a blur, we can calculate it once */
-  if (ssim->ssimtype == 0) {
-    orgmu = g_new (gfloat, ssim->width * ssim->height);
-
-    for (collected = pads->data; collected;
-        collected = g_slist_next (collected)) {
-      GstCollectData *collect_data;
-
-      collect_data = (GstCollectData *) collected->data;
+  for (collected = pads->data; collected; collected = g_slist_next (collected)) {
+    GstCollectData *collect_data;
 
-      if (collect_data->pad == ssim->orig) {
-        orgbuf = gst_collect_pads_pop (pads, collect_data);;
+    collect_data = (GstCollectData *) collected->data;
 
-        GST_DEBUG_OBJECT (ssim, "Original stream - flags(0x%x), timestamp(%"
-            GST_TIME_FORMAT "), duration(%" GST_TIME_FORMAT ")",
-            GST_BUFFER_FLAGS (orgbuf),
-            GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (orgbuf)),
-            GST_TIME_ARGS (GST_BUFFER_DURATION (orgbuf)));
-        calculate_mu (ssim, orgmu, GST_BUFFER_DATA (orgbuf));
+    if (collect_data->pad == ssim->orig) {
+      orgbuf = gst_collect_pads_pop (pads, collect_data);
 
-        break;
-      }
+      GST_DEBUG_OBJECT (ssim, "Original stream - flags(0x%x), timestamp(%"
+          GST_TIME_FORMAT "), duration(%" GST_TIME_FORMAT ")",
+          GST_BUFFER_FLAGS (orgbuf),
+          GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (orgbuf)),
+          GST_TIME_ARGS (GST_BUFFER_DURATION (orgbuf)));
+      break;
     }
   }
 
@@ -1511,6 +1172,7 @@ gst_ssim_collected (GstCollectPads * pads, gpointer user_data)
       if (!GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_GAP)) {
         GstSSimOutputContext *c;
         GstEvent *measured;
+        GstStructure *extra;
         guint64 offset;
         GValue vmean = { 0 }
         , vlowest = {
@@ -1552,8 +1214,8 @@ gst_ssim_collected (GstCollectPads * pads, gpointer user_data)
 
         GST_LOG_OBJECT (ssim, "channel %p: calculating SSIM", collect_data);
 
-        ssim->func (ssim, GST_BUFFER_DATA (orgbuf), orgmu, indata, outdata,
-            &mssim, &lowest, &highest);
+        extra = gst_ssim_measure_quality (ssim, GST_BUFFER_DATA (orgbuf),
+            indata, outdata, &mssim, &lowest, &highest);
 
         GST_DEBUG_OBJECT (GST_OBJECT (ssim), "MSSIM is %f, l-h is %f - %f",
             mssim, lowest, highest);
@@ -1593,8 +1255,10 @@ gst_ssim_collected (GstCollectPads * pads, gpointer user_data)
           c->segment_pending = FALSE;
         }
 
-        measured = gst_event_new_measured (offset,
-            GST_BUFFER_TIMESTAMP (inbuf), "SSIM", &vmean, &vlowest, &vhighest);
+        measured = gst_event_new_measured_full (offset,
+            GST_BUFFER_TIMESTAMP (inbuf), "SSIM", &vmean, &vlowest, &vhighest,
+            extra);
+        gst_structure_free (extra);
         gst_pad_push_event (c->pad, measured);
 
         /* send it out */
@@ -1612,9 +1276,6 @@ gst_ssim_collected (GstCollectPads * pads, gpointer user_data)
   }
   gst_buffer_unref (orgbuf);
 
-  if (ssim->ssimtype == 0)
-    g_free (orgmu);
-
   ssim->segment_position = 0;
 
   return ret;
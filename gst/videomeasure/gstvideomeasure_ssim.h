@@ -23,6 +23,7 @@
 #include <gst/gst.h>
 #include <gst/base/gstcollectpads.h>
 #include <gst/video/video.h>
+#include <gst/videoquality/gstvideoquality.h>
 
 G_BEGIN_DECLS
 
@@ -33,6 +34,8 @@ enum
   PROP_WINDOW_TYPE,
   PROP_WINDOW_SIZE,
   PROP_GAUSS_SIGMA,
+  PROP_N_THREADS,
+  PROP_MS_SSIM,
 };
 
 
@@ -51,19 +54,6 @@ enum
 typedef struct _GstSSim             GstSSim;
 typedef struct _GstSSimClass        GstSSimClass;
 
-typedef struct _GstSSimWindowCache {
-  gint x_window_start;
-  gint x_weight_start;
-  gint x_window_end;
-  gint y_window_start;
-  gint y_weight_start;
-  gint y_window_end;
-  gfloat element_summ;
-} GstSSimWindowCache;
-
-typedef void (*GstSSimFunction) (GstSSim *ssim, guint8 *org, gfloat *orgmu,
-    guint8 *mod, guint8 *out, gfloat *mean, gfloat *lowest, gfloat *highest);
-
 typedef struct _GstSSimOutputContext GstSSimOutputContext;
 
 /* TODO: check if all fields are used */
@@ -104,19 +94,15 @@ struct _GstSSim {
   /* Type of a weight-generator. 0 - no weighting. 1 - Gaussian weighting */
   gint            windowtype;
 
-  /* Array of width*height GstSSimWindowCaches */
-  GstSSimWindowCache *windows;
-
-  /* Array of windowsize*windowsize gfloats */
-  gfloat         *weights;
-
   /* For Gaussian function */
   gfloat          sigma;
-  
-  GstSSimFunction func;
 
-  gfloat         const1;
-  gfloat         const2;
+  /* threads the measurement is spread over, 0 for one per processor */
+  guint           n_threads;
+
+  /* SSIM map, PSNR and optionally MS-SSIM of the Y plane */
+  gboolean        ms_ssim;
+  GstVideoQuality *quality;
 
   /* counters to keep track of timestamps */
   gint64          timestamp;
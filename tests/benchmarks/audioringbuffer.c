@@ -0,0 +1,132 @@
+/* GStreamer
+ *
+ * benchmark for the lock-free ring of audioringbuffer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures how long a segment takes from the producer to the consumer
+ * (handover latency) and how many bytes per second go through the ring, for
+ * the segment sizes of 10 ms of 44.1 kHz audio in a few formats. */
+
+#include <gst/gst.h>
+
+#include "gstspscring.h"
+
+#define N_SEGMENTS 100000
+
+typedef struct
+{
+  GstSpscRing ring;
+  guint segsize;
+  guint n_segments;
+  /* keep at most this many segments in the ring */
+  guint depth;
+} Bench;
+
+static const guint8 silence[1] = { 0 };
+
+static gpointer
+producer (gpointer user_data)
+{
+  Bench *b = user_data;
+  guint8 *seg = g_malloc0 (b->segsize);
+  guint i;
+
+  for (i = 0; i < b->n_segments; i++) {
+    GstClockTime now;
+
+    while (gst_spsc_ring_fill (&b->ring) + b->segsize > b->depth * b->segsize)
+      g_thread_yield ();
+
+    /* the consumer takes the latency from the stamp at the start */
+    now = gst_util_get_timestamp ();
+    memcpy (seg, &now, sizeof (now));
+    gst_spsc_ring_write (&b->ring, seg, b->segsize, silence, 1);
+  }
+  g_free (seg);
+
+  return NULL;
+}
+
+static void
+run (guint segsize, guint depth, guint n_segments)
+{
+  Bench b;
+  GThread *thread;
+  guint8 *seg = g_malloc (segsize);
+  GstClockTime start, total, stamp, lat, lat_sum = 0, lat_max = 0;
+  guint i;
+
+  gst_spsc_ring_init (&b.ring, 8 * segsize);
+  b.segsize = segsize;
+  b.depth = depth;
+  b.n_segments = n_segments;
+
+  start = gst_util_get_timestamp ();
+  thread = g_thread_new ("producer", producer, &b);
+
+  for (i = 0; i < n_segments; i++) {
+    guint len = 0;
+
+    while (TRUE) {
+      len += gst_spsc_ring_read (&b.ring, seg + len, segsize - len);
+      if (len == segsize)
+        break;
+      g_thread_yield ();
+    }
+
+    memcpy (&stamp, seg, sizeof (stamp));
+    lat = gst_util_get_timestamp () - stamp;
+    lat_sum += lat;
+    lat_max = MAX (lat_max, lat);
+  }
+  total = gst_util_get_timestamp () - start;
+  g_thread_join (thread);
+
+  g_print ("%8u %6u %12.3f %12.3f %12.1f\n", segsize, depth,
+      (gdouble) lat_sum / n_segments / GST_USECOND,
+      (gdouble) lat_max / GST_USECOND,
+      (gdouble) segsize * n_segments / (1024 * 1024) / total * GST_SECOND);
+
+  gst_spsc_ring_free (&b.ring);
+  g_free (seg);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  /* 10 ms of 16 bit mono, 16 bit stereo, float stereo and float 5.1 */
+  static const guint segsizes[] = { 882, 1764, 3528, 10584 };
+  guint i, n_segments = N_SEGMENTS;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_segments = atoi (argv[1]);
+
+  g_print ("%8s %6s %12s %12s %12s\n", "segsize", "depth", "avg lat us",
+      "max lat us", "MB/s");
+
+  for (i = 0; i < G_N_ELEMENTS (segsizes); i++) {
+    /* one segment in flight measures the handover, a full ring the
+     * throughput */
+    run (segsizes[i], 1, n_segments);
+    run (segsizes[i], 8, n_segments);
+  }
+
+  return 0;
+}
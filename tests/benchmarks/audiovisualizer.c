@@ -0,0 +1,99 @@
+/* GStreamer
+ *
+ * benchmark for the asynchronous shading of the audio visualizers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the frames per second of wavescope with the fade shader at a
+ * few sizes, with the shading in the streaming thread and in the worker
+ * thread. Downstream is either a plain fakesink or a videoconvert to I420,
+ * which gives the worker thread something to overlap with. Needs the
+ * audiovisualizers plugin and videoconvert in the registry. */
+
+#include <gst/gst.h>
+
+static gdouble
+run (gint width, gint height, gboolean convert, gboolean async_shading,
+    guint n_frames)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start, elapsed;
+  gchar *desc;
+
+  /* 1470 samples are one frame at 30 fps */
+  desc = g_strdup_printf ("audiotestsrc num-buffers=%u samplesperbuffer=1470 "
+      "wave=sine ! audio/x-raw,rate=44100,channels=2 ! "
+      "wavescope shader=fade async-shading=%s ! "
+      "video/x-raw,width=%d,height=%d,framerate=30/1 ! %s"
+      "fakesink sync=false", n_frames, async_shading ? "true" : "false",
+      width, height, convert ? "videoconvert ! video/x-raw,format=I420 ! " :
+      "");
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (pipeline == NULL)
+    return 0.0;
+
+  bus = gst_element_get_bus (pipeline);
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = gst_util_get_timestamp () - start;
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    elapsed = 0;
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  if (elapsed == 0)
+    return 0.0;
+  return (gdouble) n_frames * GST_SECOND / elapsed;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  static const gint sizes[][2] = { {320, 240}, {1280, 720}, {1920, 1080} };
+  guint n_frames = 300, convert, i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_frames = atoi (argv[1]);
+
+  g_print ("frames/s\n%10s %-12s %10s %10s\n", "size", "downstream", "sync",
+      "async");
+
+  for (convert = 0; convert < 2; convert++) {
+    for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+      gint w = sizes[i][0], h = sizes[i][1];
+      gchar *size = g_strdup_printf ("%dx%d", w, h);
+
+      g_print ("%10s %-12s %10.1f %10.1f\n", size,
+          convert ? "videoconvert" : "fakesink",
+          run (w, h, convert, FALSE, n_frames),
+          run (w, h, convert, TRUE, n_frames));
+      g_free (size);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,200 @@
+/* GStreamer
+ *
+ * benchmark for the band pool library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the cost of a run with empty bands, the time per 1080p frame of
+ * a per-pixel operation split into a growing number of bands, and the
+ * frames per second of several elements sharing the default pool. */
+
+#include <gst/gst.h>
+#include <gst/bandpool/gstbandpool.h>
+
+#define WIDTH 1920
+#define HEIGHT 1080
+#define STRIDE (WIDTH * 4)
+
+#define N_RUNNERS 4
+
+typedef struct
+{
+  const guint8 *in;
+  guint8 *out;
+  guint y_start, y_end;
+} Band;
+
+static void
+empty_band (gpointer data, gpointer user_data)
+{
+}
+
+/* something a bit more expensive than a copy, like most filters */
+static void
+frame_band (gpointer data, gpointer user_data)
+{
+  Band *band = data;
+  guint x, y;
+
+  for (y = band->y_start; y < band->y_end; y++) {
+    const guint8 *in = band->in + y * STRIDE;
+    guint8 *out = band->out + y * STRIDE;
+
+    for (x = 0; x < STRIDE; x++)
+      out[x] = (in[x] * 3 + 17) >> 2;
+  }
+}
+
+static void
+run_frame (GstBandPool * pool, const guint8 * in, guint8 * out,
+    guint n_bands)
+{
+  Band *bands = g_newa (Band, n_bands);
+  guint i;
+
+  for (i = 0; i < n_bands; i++) {
+    bands[i].in = in;
+    bands[i].out = out;
+    bands[i].y_start = HEIGHT * i / n_bands;
+    bands[i].y_end = HEIGHT * (i + 1) / n_bands;
+  }
+
+  gst_band_pool_run (pool, frame_band, NULL, bands, sizeof (Band), n_bands);
+}
+
+static void
+bench_overhead (GstBandPool * pool, guint n_runs)
+{
+  static const guint n_bands[] = { 1, 2, 4, 8, 16 };
+  Band bands[16];
+  guint i, j;
+
+  g_print ("%8s %12s\n", "bands", "us per run");
+
+  for (i = 0; i < G_N_ELEMENTS (n_bands); i++) {
+    GstClockTime start = gst_util_get_timestamp ();
+
+    for (j = 0; j < n_runs; j++)
+      gst_band_pool_run (pool, empty_band, NULL, bands, sizeof (Band),
+          n_bands[i]);
+
+    g_print ("%8u %12.3f\n", n_bands[i],
+        (gdouble) (gst_util_get_timestamp () - start) / n_runs / GST_USECOND);
+  }
+}
+
+static void
+bench_scaling (GstBandPool * pool, guint n_frames)
+{
+  guint8 *in = g_malloc0 (STRIDE * HEIGHT);
+  guint8 *out = g_malloc0 (STRIDE * HEIGHT);
+  guint n_bands, j;
+  gdouble single = 0;
+
+  g_print ("%8s %12s %8s\n", "bands", "ms per frame", "speedup");
+
+  for (n_bands = 1; n_bands <= 2 * gst_band_pool_get_n_cpus (); n_bands++) {
+    GstClockTime start = gst_util_get_timestamp ();
+    gdouble ms;
+
+    for (j = 0; j < n_frames; j++)
+      run_frame (pool, in, out, n_bands);
+
+    ms = (gdouble) (gst_util_get_timestamp () - start) / n_frames /
+        GST_MSECOND;
+    if (n_bands == 1)
+      single = ms;
+
+    g_print ("%8u %12.3f %8.2f\n", n_bands, ms, single / ms);
+  }
+
+  g_free (in);
+  g_free (out);
+}
+
+typedef struct
+{
+  GstBandPool *pool;
+  guint n_frames;
+} Runner;
+
+static gpointer
+runner_func (gpointer user_data)
+{
+  Runner *r = user_data;
+  guint8 *in = g_malloc0 (STRIDE * HEIGHT);
+  guint8 *out = g_malloc0 (STRIDE * HEIGHT);
+  guint n_bands = gst_band_pool_get_n_bands (0, HEIGHT, 16);
+  guint i;
+
+  for (i = 0; i < r->n_frames; i++)
+    run_frame (r->pool, in, out, n_bands);
+
+  g_free (in);
+  g_free (out);
+
+  return NULL;
+}
+
+/* every element splits its frames into one band per processor */
+static void
+bench_shared (GstBandPool * pool, guint n_frames)
+{
+  GThread *threads[N_RUNNERS];
+  Runner r;
+  guint n_runners, i;
+
+  r.pool = pool;
+  r.n_frames = n_frames;
+
+  g_print ("%8s %12s\n", "elements", "frames/s");
+
+  for (n_runners = 1; n_runners <= N_RUNNERS; n_runners++) {
+    GstClockTime start = gst_util_get_timestamp ();
+
+    for (i = 0; i < n_runners; i++)
+      threads[i] = g_thread_new ("runner", runner_func, &r);
+    for (i = 0; i < n_runners; i++)
+      g_thread_join (threads[i]);
+
+    g_print ("%8u %12.1f\n", n_runners, (gdouble) n_runners * n_frames *
+        GST_SECOND / (gst_util_get_timestamp () - start));
+  }
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstBandPool *pool;
+  guint n_frames = 100;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_frames = atoi (argv[1]);
+
+  pool = gst_band_pool_get_default ();
+
+  g_print ("%u processors\n\n", gst_band_pool_get_n_cpus ());
+  bench_overhead (pool, 100 * n_frames);
+  g_print ("\n");
+  bench_scaling (pool, n_frames);
+  g_print ("\n");
+  bench_shared (pool, n_frames);
+
+  return 0;
+}
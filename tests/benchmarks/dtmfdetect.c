@@ -0,0 +1,137 @@
+/* GStreamer
+ *
+ * benchmark for the tone detector of dtmfdetect
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the calls per second of zap_dtmf_detect() on 20 ms buffers with
+ * one detector per thread, for one thread up to one per processor, in
+ * total and per core. Every thread sets its detector up again once per
+ * second of audio, as the element does on every caps change, so the
+ * detectors have no shared state to fight over. */
+
+#include <gst/gst.h>
+#include <gst/bandpool/gstbandpool.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "tone_detect.h"
+
+#define RATE 8000
+#define BUFFER_SAMPLES 160
+#define N_BUFFERS 50
+
+typedef struct
+{
+  gint16 *samples;
+  guint n_calls;
+  gint n_digits;
+} Runner;
+
+/* collects the digits found so far and counts the fives among them */
+static gint
+count_fives (dtmf_detect_state_t * state)
+{
+  char digits[MAX_DTMF_DIGITS + 1];
+  gint n, i, fives = 0;
+
+  n = zap_dtmf_get (state, digits, MAX_DTMF_DIGITS);
+  for (i = 0; i < n; i++)
+    if (digits[i] == '5')
+      fives++;
+
+  return fives;
+}
+
+static gpointer
+runner_func (gpointer data)
+{
+  Runner *r = data;
+  dtmf_detect_state_t state;
+  guint i;
+
+  r->n_digits = 0;
+  zap_dtmf_detect_init (&state);
+  for (i = 0; i < r->n_calls; i++) {
+    if (i > 0 && i % N_BUFFERS == 0) {
+      r->n_digits += count_fives (&state);
+      zap_dtmf_detect_init (&state);
+    }
+    zap_dtmf_detect (&state, r->samples + (i % N_BUFFERS) * BUFFER_SAMPLES,
+        BUFFER_SAMPLES, FALSE);
+  }
+  r->n_digits += count_fives (&state);
+
+  return NULL;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  gint16 *samples = g_new (gint16, N_BUFFERS * BUFFER_SAMPLES);
+  Runner *runners;
+  GThread **threads;
+  guint n_calls = 20000, n_cpus, n_threads, i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_calls = atoi (argv[1]);
+
+  /* "5" for 100 ms, then 100 ms of silence, repeated */
+  for (i = 0; i < N_BUFFERS * BUFFER_SAMPLES; i++) {
+    gdouble t = (gdouble) i / RATE;
+
+    samples[i] = (i / (RATE / 10)) % 2 ? 0 :
+        8000 * (sin (2 * G_PI * 770 * t) + sin (2 * G_PI * 1336 * t));
+  }
+
+  n_cpus = gst_band_pool_get_n_cpus ();
+  runners = g_new (Runner, n_cpus);
+  threads = g_new (GThread *, n_cpus);
+
+  g_print ("%u processors\n%8s %12s %12s\n", n_cpus, "threads", "calls/s",
+      "calls/s/core");
+  for (n_threads = 1; n_threads <= n_cpus; n_threads++) {
+    GstClockTime start = gst_util_get_timestamp ();
+    gdouble calls;
+
+    for (i = 0; i < n_threads; i++) {
+      runners[i].samples = samples;
+      runners[i].n_calls = n_calls;
+      threads[i] = g_thread_new ("detector", runner_func, &runners[i]);
+    }
+    for (i = 0; i < n_threads; i++)
+      g_thread_join (threads[i]);
+
+    calls = (gdouble) n_threads * n_calls * GST_SECOND /
+        (gst_util_get_timestamp () - start);
+    g_print ("%8u %12.1f %12.1f\n", n_threads, calls, calls / n_threads);
+
+    /* every burst is a five */
+    for (i = 0; i < n_threads; i++)
+      if (runners[i].n_digits != (n_calls * BUFFER_SAMPLES + RATE / 10) /
+          (RATE / 5))
+        g_printerr ("thread %u detected %d fives\n", i, runners[i].n_digits);
+  }
+
+  g_free (threads);
+  g_free (runners);
+  g_free (samples);
+
+  return 0;
+}
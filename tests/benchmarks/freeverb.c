@@ -0,0 +1,97 @@
+/* GStreamer
+ *
+ * benchmark for the reverb model of freeverb
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures how many times faster than real time the filter banks and the
+ * wet mix of freeverb run at 44.1 kHz, for the output channel counts the
+ * element can produce, odd ones included. Conversion from and to the
+ * interleaved samples is left out. */
+
+#include <gst/gst.h>
+#include <stdlib.h>
+
+#include "gstfreeverbmodel.h"
+
+#define RATE 44100
+
+static gdouble
+run (gint n_banks, guint n_blocks)
+{
+  freeverb_bank *banks = g_new0 (freeverb_bank, n_banks);
+  gfloat *block_in = g_new (gfloat, n_banks * BLOCK_SIZE);
+  gfloat *block_out = g_new (gfloat, n_banks * BLOCK_SIZE);
+  gfloat *noise = g_new (gfloat, BLOCK_SIZE);
+  GstClockTime start, elapsed;
+  guint32 seed = 1;
+  guint i, k;
+  gint b;
+
+  for (k = 0; k < BLOCK_SIZE; k++) {
+    seed = seed * 1103515245 + 12345;
+    noise[k] = (((gint) ((seed >> 16) & 0x7fff) - 0x4000) + DC_OFFSET) *
+        fixedgain;
+  }
+  for (b = 0; b < n_banks; b++) {
+    freeverb_bank_setbuffers (&banks[b], b, 1.0f);
+    freeverb_bank_init (&banks[b]);
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_blocks; i++) {
+    for (b = 0; b < n_banks; b++) {
+      memcpy (block_in + b * BLOCK_SIZE, noise, BLOCK_SIZE * sizeof (gfloat));
+      freeverb_bank_process (&banks[b], 0.5f * scaleroom + offsetroom,
+          0.2f * scaledamp, block_in + b * BLOCK_SIZE,
+          block_out + b * BLOCK_SIZE, BLOCK_SIZE);
+    }
+    /* width 0.5 and level 1 */
+    for (b = 0; b < n_banks; b++)
+      freeverb_bank_wet (block_out, b, n_banks, 0.75f, 0.25f,
+          block_in + b * BLOCK_SIZE, BLOCK_SIZE);
+  }
+  elapsed = gst_util_get_timestamp () - start;
+
+  for (b = 0; b < n_banks; b++)
+    freeverb_bank_release (&banks[b]);
+  g_free (noise);
+  g_free (block_out);
+  g_free (block_in);
+  g_free (banks);
+
+  return (gdouble) n_blocks * BLOCK_SIZE * GST_SECOND / RATE /
+      MAX (elapsed, 1);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  static const gint channels[] = { 2, 3, 4, 5, 6, 8 };
+  guint n_blocks = 20000, i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_blocks = atoi (argv[1]);
+
+  g_print ("%8s %10s\n", "channels", "x realtime");
+  for (i = 0; i < G_N_ELEMENTS (channels); i++)
+    g_print ("%8d %10.1f\n", channels[i], run (channels[i], n_blocks));
+
+  return 0;
+}
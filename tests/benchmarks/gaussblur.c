@@ -0,0 +1,112 @@
+/* GStreamer
+ *
+ * benchmark for the gaussian blur of gaudieffects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the frames per second of gaussianblur against sigma, which sets
+ * the number of kernel taps, at two sizes with one thread (the column under
+ * the size) and with one per processor. The first row is the pipeline
+ * without the blur, the cost of the source. Needs the gaudieffects plugin
+ * in the registry. */
+
+#include <gst/gst.h>
+#include <stdlib.h>
+
+static gdouble
+run (gint width, gint height, const gchar * blur, guint n_frames)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start, elapsed;
+  gchar *desc;
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=%u pattern=smpte ! "
+      "video/x-raw,format=AYUV,width=%d,height=%d,framerate=30/1 ! %s "
+      "fakesink sync=false", n_frames, width, height, blur);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (pipeline == NULL)
+    return 0.0;
+
+  bus = gst_element_get_bus (pipeline);
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = gst_util_get_timestamp () - start;
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    elapsed = 0;
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  if (elapsed == 0)
+    return 0.0;
+  return (gdouble) n_frames * GST_SECOND / elapsed;
+}
+
+static gdouble
+run_blur (gint width, gint height, gdouble sigma, guint n_threads,
+    guint n_frames)
+{
+  gchar *blur;
+  gdouble fps;
+
+  blur = g_strdup_printf ("gaussianblur sigma=%g n-threads=%u !", sigma,
+      n_threads);
+  fps = run (width, height, blur, n_frames);
+  g_free (blur);
+
+  return fps;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  static const gint sizes[][2] = { {640, 480}, {1920, 1080} };
+  static const gdouble sigmas[] = { 0.5, 1.2, 2.0, 4.0, 8.0, 16.0, -1.2 };
+  guint n_frames = 200, i, j;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_frames = atoi (argv[1]);
+
+  g_print ("frames/s\n%8s", "sigma");
+  for (j = 0; j < G_N_ELEMENTS (sizes); j++)
+    g_print (" %6dx%-4d %11s", sizes[j][0], sizes[j][1], "all threads");
+  g_print ("\n%8s", "none");
+  for (j = 0; j < G_N_ELEMENTS (sizes); j++)
+    g_print (" %11.1f %11s", run (sizes[j][0], sizes[j][1], "", n_frames),
+        "");
+  g_print ("\n");
+
+  for (i = 0; i < G_N_ELEMENTS (sigmas); i++) {
+    g_print ("%8.1f", sigmas[i]);
+    for (j = 0; j < G_N_ELEMENTS (sizes); j++)
+      g_print (" %11.1f %11.1f",
+          run_blur (sizes[j][0], sizes[j][1], sigmas[i], 1, n_frames),
+          run_blur (sizes[j][0], sizes[j][1], sigmas[i], 0, n_frames));
+    g_print ("\n");
+  }
+
+  return 0;
+}
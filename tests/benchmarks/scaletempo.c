@@ -0,0 +1,140 @@
+/* GStreamer
+ *
+ * benchmark for the best overlap search of scaletempo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures one overlap search with the dot products, for float and S16,
+ * and with the fft correlation, for the default 30 ms stride and 20%
+ * overlap at several rates, channel counts and search lengths. The last
+ * columns are the cost constants at which both ways would take as long,
+ * see GST_SCALETEMPO_CORR_FFT_COST_FLOAT and _S16, and which way the
+ * element takes for each format. */
+
+#include <gst/gst.h>
+#include <stdlib.h>
+
+#include "gstscaletempocorr.h"
+
+#define STRIDE_MS 30
+#define OVERLAP 0.2
+
+/* keeps the compiler from dropping the searches */
+static volatile guint best_off;
+
+/* microseconds per run */
+static gdouble
+elapsed_since (GstClockTime start, guint n_runs)
+{
+  return (gdouble) (gst_util_get_timestamp () - start) / GST_USECOND / n_runs;
+}
+
+static void
+run (guint rate, guint channels, guint search_ms, guint n_runs)
+{
+  guint frames_overlap = STRIDE_MS * rate / 1000 * OVERLAP;
+  guint frames_search = search_ms * rate / 1000;
+  guint n = (frames_overlap - 1) * channels;
+  guint n_search = frames_search * channels + n;
+  guint len = gst_scaletempo_corr_fft_length (n_search);
+  gfloat *pre_corr = g_new (gfloat, n), *search = g_new (gfloat, n_search);
+  gint32 *pre_corr_s16 = g_new0 (gint32, n + 3);
+  gint16 *search_s16 = g_new0 (gint16, n_search + 3);
+  GstScaletempoCorrFFT c = { 0, };
+  GstClockTime start;
+  gdouble t_float, t_s16, t_fft;
+  guint32 seed = 1;
+  gdouble work, cost_float, cost_s16;
+  guint i, run;
+
+  for (i = 0; i < n_search; i++) {
+    seed = seed * 1103515245 + 12345;
+    search_s16[i] = (gint) ((seed >> 16) & 0x7fff) - 0x4000;
+    search[i] = search_s16[i] / 32768.0f;
+  }
+  for (i = 0; i < n; i++) {
+    pre_corr[i] = search[i + n_search - n];
+    pre_corr_s16[i] = search_s16[i + n_search - n];
+  }
+  gst_scaletempo_corr_fft_init (&c, len);
+
+  start = gst_util_get_timestamp ();
+  for (run = 0; run < n_runs; run++)
+    best_off = gst_scaletempo_corr_float (pre_corr, search, n, frames_search,
+        channels);
+  t_float = elapsed_since (start, n_runs);
+
+  start = gst_util_get_timestamp ();
+  for (run = 0; run < n_runs; run++)
+    best_off = gst_scaletempo_corr_s16 (pre_corr_s16, search_s16, n,
+        frames_search, channels);
+  t_s16 = elapsed_since (start, n_runs);
+
+  /* including the copies the element makes */
+  start = gst_util_get_timestamp ();
+  for (run = 0; run < n_runs; run++) {
+    memcpy (c.overlap, pre_corr, n * sizeof (gfloat));
+    memcpy (c.search, search, n_search * sizeof (gfloat));
+    best_off = gst_scaletempo_corr_fft (&c, n, n_search, frames_search,
+        channels);
+  }
+  t_fft = elapsed_since (start, n_runs);
+
+  /* dot products cost frames_search * n units of one multiply-add, the
+   * fft len * log2 (len) units of cost each */
+  work = (gdouble) frames_search * n / ((gdouble) len * g_bit_storage (len));
+  cost_float = work * t_fft / t_float;
+  cost_s16 = work * t_fft / t_s16;
+
+  g_print ("%6u %3u %4u %6u %6u %10.1f %10.1f %10.1f %7.2f %7.2f %5s %5s\n",
+      rate, channels, search_ms, n * frames_search / 1000, len,
+      t_float, t_s16, t_fft, cost_float, cost_s16,
+      gst_scaletempo_corr_use_fft (FALSE, n, frames_search, len) ? "fft" :
+      "dot", gst_scaletempo_corr_use_fft (TRUE, n, frames_search,
+          len) ? "fft" : "dot");
+
+  gst_scaletempo_corr_fft_free (&c);
+  g_free (search_s16);
+  g_free (pre_corr_s16);
+  g_free (search);
+  g_free (pre_corr);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  static const guint rates[] = { 22050, 44100, 48000, 96000 };
+  static const guint channels[] = { 1, 2, 6 };
+  static const guint searches[] = { 5, 14, 30, 60 };
+  guint n_runs = 200, i, j, k;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_runs = atoi (argv[1]);
+
+  g_print ("us per search\n%6s %3s %4s %6s %6s %10s %10s %10s %7s %7s %5s "
+      "%5s\n", "rate", "ch", "ms", "kMAC", "len", "float", "s16", "fft",
+      "c float", "c s16", "float", "s16");
+
+  for (i = 0; i < G_N_ELEMENTS (rates); i++)
+    for (j = 0; j < G_N_ELEMENTS (channels); j++)
+      for (k = 0; k < G_N_ELEMENTS (searches); k++)
+        run (rates[i], channels[j], searches[k], n_runs);
+
+  return 0;
+}
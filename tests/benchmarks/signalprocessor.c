@@ -0,0 +1,193 @@
+/* GStreamer
+ *
+ * benchmark for the buffer handling of the signal processor base class
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the sample frames per second that go through a processor whose
+ * process() only copies its input to its output, so what is left is the
+ * cost of the base class: (de)interleaving, output buffers and the split
+ * into blocks. Writable inputs can be reused as outputs, shared ones need
+ * an output buffer from the pool. */
+
+#include <gst/gst.h>
+#include <gst/signalprocessor/gstsignalprocessor.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RATE 48000
+#define BUFFER_FRAMES 1024
+
+typedef GstSignalProcessor GstBenchCopy;
+typedef GstSignalProcessorClass GstBenchCopyClass;
+
+static void
+gst_bench_copy_process (GstSignalProcessor * self, guint nframes)
+{
+  GstSignalProcessorClass *klass = GST_SIGNAL_PROCESSOR_GET_CLASS (self);
+
+  if (klass->num_group_in) {
+    memcpy (self->group_out[0].buffer, self->group_in[0].buffer,
+        nframes * self->group_in[0].channels * sizeof (gfloat));
+  } else if (self->audio_out[0] != self->audio_in[0]) {
+    memcpy (self->audio_out[0], self->audio_in[0], nframes * sizeof (gfloat));
+  }
+}
+
+/* @class_data is the number of channels, mono processors work in place */
+static void
+gst_bench_copy_class_init (GstBenchCopyClass * klass, gpointer class_data)
+{
+  guint channels = GPOINTER_TO_UINT (class_data);
+
+  gst_signal_processor_class_add_pad_template (klass, "sink", GST_PAD_SINK,
+      0, channels);
+  gst_signal_processor_class_add_pad_template (klass, "src", GST_PAD_SRC,
+      0, channels);
+  if (channels > 1) {
+    klass->num_group_in = klass->num_group_out = 1;
+  } else {
+    klass->num_audio_in = klass->num_audio_out = 1;
+    GST_SIGNAL_PROCESSOR_CLASS_SET_CAN_PROCESS_IN_PLACE (klass);
+  }
+  klass->process = gst_bench_copy_process;
+}
+
+static GType
+gst_bench_copy_get_type (guint channels)
+{
+  GTypeInfo info = {
+    sizeof (GstBenchCopyClass), NULL, NULL,
+    (GClassInitFunc) gst_bench_copy_class_init, NULL,
+    GUINT_TO_POINTER (channels), sizeof (GstBenchCopy), 0, NULL
+  };
+  gchar *name = g_strdup_printf ("GstBenchCopy%u", channels);
+  GType type;
+
+  type = g_type_from_name (name);
+  if (!type)
+    type = g_type_register_static (GST_TYPE_SIGNAL_PROCESSOR, name, &info, 0);
+  g_free (name);
+
+  return type;
+}
+
+static GstFlowReturn
+drop_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static gdouble
+run (guint channels, guint block_size, gboolean shared, guint n_buffers)
+{
+  GstElement *copy;
+  GstPad *src, *sink, *in, *out;
+  GstBuffer *buffer = NULL;
+  GstCaps *caps;
+  GstSegment segment;
+  GstClockTime start, elapsed;
+  gsize size = BUFFER_FRAMES * channels * sizeof (gfloat);
+  guint i;
+
+  copy = g_object_new (gst_bench_copy_get_type (channels), "block-size",
+      block_size, NULL);
+  in = gst_element_get_static_pad (copy, "sink");
+  out = gst_element_get_static_pad (copy, "src");
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, drop_chain);
+  gst_pad_link (src, in);
+  gst_pad_link (out, sink);
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+  gst_element_set_state (copy, GST_STATE_PLAYING);
+
+  caps = gst_caps_new_simple ("audio/x-raw-float",
+      "endianness", G_TYPE_INT, G_BYTE_ORDER, "width", G_TYPE_INT, 32,
+      "channels", G_TYPE_INT, channels, "rate", G_TYPE_INT, RATE, NULL);
+  gst_pad_set_caps (src, caps);
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (src, gst_event_new_segment (&segment));
+
+  /* a shared input is pushed over and over again, the writable ones have to
+   * be allocated like a source would */
+  if (shared) {
+    buffer = gst_buffer_new_and_alloc (size);
+    gst_buffer_memset (buffer, 0, 0, size);
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_buffers; i++) {
+    GstBuffer *buf;
+
+    if (shared) {
+      buf = gst_buffer_ref (buffer);
+    } else {
+      buf = gst_buffer_new_and_alloc (size);
+      gst_buffer_memset (buf, 0, 0, size);
+    }
+    GST_BUFFER_TIMESTAMP (buf) =
+        gst_util_uint64_scale_int (i * BUFFER_FRAMES, GST_SECOND, RATE);
+    if (gst_pad_push (src, buf) != GST_FLOW_OK)
+      break;
+  }
+  elapsed = gst_util_get_timestamp () - start;
+
+  if (buffer)
+    gst_buffer_unref (buffer);
+  gst_element_set_state (copy, GST_STATE_NULL);
+  gst_pad_set_active (src, FALSE);
+  gst_pad_set_active (sink, FALSE);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+  gst_object_unref (in);
+  gst_object_unref (out);
+  gst_object_unref (copy);
+
+  if (i < n_buffers || elapsed == 0)
+    return 0.0;
+  return (gdouble) n_buffers * BUFFER_FRAMES * GST_SECOND / elapsed / 1e6;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  static const guint channels[] = { 1, 2, 6 };
+  static const guint block_sizes[] = { 0, 256, 64 };
+  guint n_buffers = 20000, i, j;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_buffers = atoi (argv[1]);
+
+  g_print ("Mframes/s, %u frames per buffer\n%8s %10s %10s %10s\n",
+      BUFFER_FRAMES, "channels", "block-size", "writable", "shared");
+
+  for (i = 0; i < G_N_ELEMENTS (channels); i++) {
+    for (j = 0; j < G_N_ELEMENTS (block_sizes); j++) {
+      g_print ("%8u %10u %10.2f %10.2f\n", channels[i], block_sizes[j],
+          run (channels[i], block_sizes[j], FALSE, n_buffers),
+          run (channels[i], block_sizes[j], TRUE, n_buffers));
+    }
+  }
+
+  return 0;
+}
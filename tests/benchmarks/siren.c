@@ -0,0 +1,127 @@
+/* GStreamer
+ *
+ * benchmark for the siren encoder
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures how many 16 kHz streams one thread can encode in real time when
+ * it encodes several of them frame by frame, as a conference server would.
+ * The codec keeps its bit writer in globals, so the streams can not be
+ * spread over threads. The DCT-IV on its own is measured as well. */
+
+#include <gst/gst.h>
+#include <stdlib.h>
+
+#include "siren7.h"
+
+#define FRAME_SAMPLES 320
+#define FRAME_BYTES 40
+#define FRAME_DURATION (20 * GST_MSECOND)
+
+/* the encoders get different signals, so that they do not share cache
+ * lines of input */
+static gint16 *
+create_input (guint n_streams)
+{
+  gint16 *samples = g_new (gint16, n_streams * FRAME_SAMPLES);
+  guint32 seed = 1;
+  guint i;
+
+  for (i = 0; i < n_streams * FRAME_SAMPLES; i++) {
+    seed = seed * 1103515245 + 12345;
+    samples[i] = GINT16_TO_LE ((gint) ((seed >> 16) & 0x3fff) - 0x2000);
+  }
+
+  return samples;
+}
+
+/* returns the number of streams that can be encoded in real time */
+static gdouble
+run_encode (guint n_streams, guint n_frames)
+{
+  SirenEncoder *encoders = g_new (SirenEncoder, n_streams);
+  gint16 *in = create_input (n_streams);
+  guint8 out[FRAME_BYTES];
+  GstClockTime start, elapsed;
+  guint i, s;
+
+  for (s = 0; s < n_streams; s++)
+    encoders[s] = Siren7_NewEncoder (16000);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_frames; i++)
+    for (s = 0; s < n_streams; s++)
+      Siren7_EncodeFrame (encoders[s], (guint8 *) (in + s * FRAME_SAMPLES),
+          out);
+  elapsed = gst_util_get_timestamp () - start;
+
+  for (s = 0; s < n_streams; s++)
+    Siren7_CloseEncoder (encoders[s]);
+  g_free (encoders);
+  g_free (in);
+
+  return (gdouble) n_streams * n_frames * FRAME_DURATION / MAX (elapsed, 1);
+}
+
+/* returns the microseconds per transform */
+static gdouble
+run_dct4 (gint length, guint n_runs)
+{
+  gfloat *in = g_new (gfloat, length), *out = g_new (gfloat, length);
+  GstClockTime start, elapsed;
+  guint i;
+
+  for (i = 0; i < length; i++)
+    in[i] = (gfloat) ((i * 7919) % 1000) - 500.0f;
+
+  siren_dct4_init ();
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_runs; i++)
+    siren_dct4 (in, out, length);
+  elapsed = gst_util_get_timestamp () - start;
+
+  g_free (out);
+  g_free (in);
+
+  return (gdouble) elapsed / GST_USECOND / n_runs;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  static const guint streams[] = { 1, 4, 16, 64 };
+  guint n_frames = 5000, i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_frames = atoi (argv[1]);
+
+  /* warm up */
+  run_encode (1, n_frames / 10 + 1);
+
+  g_print ("%8s %16s\n", "streams", "realtime streams");
+  for (i = 0; i < G_N_ELEMENTS (streams); i++)
+    g_print ("%8u %16.0f\n", streams[i],
+        run_encode (streams[i], n_frames / streams[i] + 1));
+
+  g_print ("\n%8s %16s\n", "length", "us/transform");
+  g_print ("%8d %16.2f\n", 320, run_dct4 (320, n_frames * 10));
+  g_print ("%8d %16.2f\n", 640, run_dct4 (640, n_frames * 10));
+
+  return 0;
+}
@@ -0,0 +1,94 @@
+/* GStreamer
+ *
+ * benchmark for spectrascope
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures how many times faster than realtime spectrascope analyses 2 and
+ * 64 channels of noise at 1280x720 and 30 fps, for the downmix and for one
+ * band per channel, with and without overlapping windows. The window is 2560
+ * samples: with overlap every frame advances by 1470 samples, without it by
+ * the whole window. Needs the audiovisualizers plugin in the registry. */
+
+#include <gst/gst.h>
+#include <stdlib.h>
+
+static gdouble
+run (gint channels, gboolean split, gboolean overlap, guint n_frames)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start, elapsed;
+  gchar *desc;
+
+  /* 1470 samples are one frame at 30 fps */
+  desc = g_strdup_printf ("audiotestsrc num-buffers=%u samplesperbuffer=1470 "
+      "wave=white-noise ! audio/x-raw,rate=44100,channels=%d ! "
+      "spectrascope split-channels=%s overlap=%s ! "
+      "video/x-raw,width=1280,height=720,framerate=30/1 ! "
+      "fakesink sync=false", n_frames, channels, split ? "true" : "false",
+      overlap ? "true" : "false");
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (pipeline == NULL)
+    return 0.0;
+
+  bus = gst_element_get_bus (pipeline);
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  elapsed = gst_util_get_timestamp () - start;
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    elapsed = 0;
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  if (elapsed == 0)
+    return 0.0;
+  return (gdouble) n_frames * GST_SECOND / (30 * elapsed);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  static const gint channels[] = { 2, 64 };
+  guint n_frames = 300, split, i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_frames = atoi (argv[1]);
+
+  g_print ("x realtime\n%8s %-8s %10s %10s\n", "channels", "mode", "plain",
+      "overlap");
+
+  for (i = 0; i < G_N_ELEMENTS (channels); i++) {
+    for (split = 0; split < 2; split++) {
+      g_print ("%8d %-8s %10.1f %10.1f\n", channels[i],
+          split ? "split" : "downmix",
+          run (channels[i], split, FALSE, n_frames),
+          run (channels[i], split, TRUE, n_frames));
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,206 @@
+/* GStreamer
+ *
+ * benchmark for the SSIM map of the ssim element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the frames per second of the SSIM map of a 640x360 luma plane,
+ * computed directly like the ssim element used to (every window walked for
+ * every sample, in float) and with the separable window sums of the video
+ * quality library on 1 up to the number of processors threads, for flat
+ * and Gaussian windows. It also prints how far the results of the two
+ * differ: the mean SSIM, and the map samples of the windows that lie
+ * inside the frame. Windows at the edges differ more as the direct code
+ * normalised them by weights that lie outside the frame. */
+
+#include <gst/gst.h>
+#include <gst/bandpool/gstbandpool.h>
+#include <gst/videoquality/gstvideoquality.h>
+
+#include <math.h>
+
+#define WIDTH 640
+#define HEIGHT 360
+#define WINDOW_SIZE 11
+#define SIGMA 1.5
+
+#define C1 (0.01 * 255 * 0.01 * 255)
+#define C2 (0.03 * 255 * 0.03 * 255)
+
+/* the SSIM map as the element computed it before it moved to the library,
+ * with the canonical metric */
+static gfloat
+direct_ssim_map (const guint8 * org, const guint8 * mod, gboolean gauss,
+    guint8 * out)
+{
+  gfloat weights[WINDOW_SIZE * WINDOW_SIZE], normal_summ = 0;
+  gfloat cumulative_ssim = 0;
+  gint half = WINDOW_SIZE / 2;
+  gint oy, ox, iy, ix, y, x;
+
+  for (y = 0; y < WINDOW_SIZE; y++) {
+    for (x = 0; x < WINDOW_SIZE; x++) {
+      gfloat coord2 = (x - half) * (x - half) + (y - half) * (y - half);
+
+      weights[y * WINDOW_SIZE + x] = gauss ?
+          exp (-coord2 / (2 * SIGMA * SIGMA)) / (SIGMA * sqrt (2 * G_PI)) : 1;
+      normal_summ += weights[y * WINDOW_SIZE + x];
+    }
+  }
+
+  for (oy = 0; oy < HEIGHT; oy++) {
+    for (ox = 0; ox < WIDTH; ox++) {
+      gint y0 = MAX (oy - half, 0), y1 = MIN (oy + half, HEIGHT - 1);
+      gint x0 = MAX (ox - half, 0), x1 = MIN (ox + half, WIDTH - 1);
+      gint ky = y0 - (oy - half), kx = x0 - (ox - half);
+      gfloat mu_o = 0, mu_m = 0, elsumm = 0, ssim;
+      gdouble sigma_o = 0, sigma_m = 0, sigma_om = 0;
+
+      /* the element summed the weights from the first one inside the frame
+       * to the end of the window, also below and right of the frame */
+      if ((y1 - y0 + 1) * (x1 - x0 + 1) == WINDOW_SIZE * WINDOW_SIZE) {
+        elsumm = normal_summ;
+      } else {
+        for (y = ky; y < WINDOW_SIZE; y++)
+          for (x = kx; x < WINDOW_SIZE; x++)
+            elsumm += weights[y * WINDOW_SIZE + x];
+      }
+
+      for (iy = y0; iy <= y1; iy++) {
+        for (ix = x0; ix <= x1; ix++) {
+          gfloat w = weights[(ky + iy - y0) * WINDOW_SIZE + kx + ix - x0];
+
+          mu_o += w * org[iy * WIDTH + ix];
+          mu_m += w * mod[iy * WIDTH + ix];
+        }
+      }
+      mu_o /= elsumm;
+      mu_m /= elsumm;
+
+      for (iy = y0; iy <= y1; iy++) {
+        for (ix = x0; ix <= x1; ix++) {
+          gfloat w = weights[(ky + iy - y0) * WINDOW_SIZE + kx + ix - x0];
+          gfloat tmp1 = org[iy * WIDTH + ix] - mu_o;
+          gfloat tmp2 = mod[iy * WIDTH + ix] - mu_m;
+
+          sigma_o += w * tmp1 * tmp1;
+          sigma_m += w * tmp2 * tmp2;
+          sigma_om += w * tmp1 * tmp2;
+        }
+      }
+      sigma_o /= elsumm;
+      sigma_m /= elsumm;
+      sigma_om /= elsumm;
+
+      ssim = (2 * mu_o * mu_m + C1) * (2 * sigma_om + C2) /
+          ((mu_o * mu_o + mu_m * mu_m + C1) * (sigma_o + sigma_m + C2));
+      out[oy * WIDTH + ox] = 127 + ssim * 128;
+      cumulative_ssim += ssim;
+    }
+  }
+
+  return cumulative_ssim / (WIDTH * HEIGHT);
+}
+
+static gdouble
+elapsed_fps (GstClockTime start, guint n_frames)
+{
+  return (gdouble) n_frames * GST_SECOND / (gst_util_get_timestamp () -
+      start);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint8 *org = g_malloc (WIDTH * HEIGHT), *mod = g_malloc (WIDTH * HEIGHT);
+  guint8 *direct_map = g_malloc (WIDTH * HEIGHT);
+  guint8 *map = g_malloc (WIDTH * HEIGHT);
+  GstVideoQualityPlane ref, dist;
+  guint n_frames = 5, n_cpus, n_threads, i;
+  gint gauss, x, y;
+  GRand *rand;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_frames = atoi (argv[1]);
+
+  /* a pattern with some noise on top */
+  rand = g_rand_new_with_seed (0);
+  for (i = 0; i < WIDTH * HEIGHT; i++) {
+    org[i] = (i * 7 + i / WIDTH * 13) & 0xff;
+    mod[i] = CLAMP (org[i] + g_rand_int_range (rand, -8, 9), 0, 255);
+  }
+  g_rand_free (rand);
+
+  ref.data = org;
+  ref.width = WIDTH;
+  ref.height = HEIGHT;
+  ref.pstride = 1;
+  ref.stride = WIDTH;
+  dist = ref;
+  dist.data = mod;
+
+  n_cpus = gst_band_pool_get_n_cpus ();
+  g_print ("%u processors, %dx%d, frames/s\n", n_cpus, WIDTH, HEIGHT);
+
+  for (gauss = 0; gauss <= 1; gauss++) {
+    GstVideoQualityWindow window = gauss ? GST_VIDEO_QUALITY_WINDOW_GAUSSIAN :
+        GST_VIDEO_QUALITY_WINDOW_FLAT;
+    gdouble direct_mean = 0, mean = 0, direct_fps;
+    GstClockTime start;
+    gint max_diff = 0;
+
+    start = gst_util_get_timestamp ();
+    for (i = 0; i < n_frames; i++)
+      direct_mean = direct_ssim_map (org, mod, gauss, direct_map);
+    direct_fps = elapsed_fps (start, n_frames);
+
+    g_print ("%s window\n%10s %10.2f\n", gauss ? "gaussian" : "flat",
+        "direct", direct_fps);
+
+    for (n_threads = 1; n_threads <= n_cpus; n_threads++) {
+      GstVideoQuality *quality = gst_video_quality_new (n_threads);
+
+      gst_video_quality_set_ssim_map_window (quality, window, WINDOW_SIZE,
+          SIGMA);
+
+      start = gst_util_get_timestamp ();
+      for (i = 0; i < n_frames; i++)
+        mean = gst_video_quality_ssim_map (quality, &ref, &dist, map, WIDTH,
+            NULL, NULL);
+      g_print ("%7u th %10.2f\n", n_threads, elapsed_fps (start, n_frames));
+
+      gst_video_quality_free (quality);
+    }
+
+    for (y = WINDOW_SIZE / 2; y < HEIGHT - WINDOW_SIZE / 2; y++) {
+      for (x = WINDOW_SIZE / 2; x < WIDTH - WINDOW_SIZE / 2; x++)
+        max_diff = MAX (max_diff, ABS (map[y * WIDTH + x] -
+                direct_map[y * WIDTH + x]));
+    }
+    g_print ("mean SSIM %f direct %f, inner map samples differ by up to %d\n",
+        mean, direct_mean, max_diff);
+  }
+
+  g_free (map);
+  g_free (direct_map);
+  g_free (mod);
+  g_free (org);
+
+  return 0;
+}
@@ -0,0 +1,131 @@
+/* GStreamer
+ *
+ * benchmark for the video quality library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the frames per second of every metric on the three planes of a
+ * 1080p I420 frame, measured together like compare does it, and of the
+ * SSIM map of its luma plane like ssim does it, with 1 up to the number of
+ * processors threads. */
+
+#include <gst/gst.h>
+#include <gst/bandpool/gstbandpool.h>
+#include <gst/videoquality/gstvideoquality.h>
+
+#define WIDTH 1920
+#define HEIGHT 1080
+
+static gdouble
+run (GstVideoQuality * quality, GstVideoQualityMetrics metrics,
+    const GstVideoQualityPlane * ref, const GstVideoQualityPlane * dist,
+    guint8 * map, guint n_frames)
+{
+  GstVideoQualityResult results[3];
+  GstClockTime start;
+  guint i;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_frames; i++) {
+    if (map)
+      gst_video_quality_ssim_map (quality, &ref[0], &dist[0], map, WIDTH,
+          NULL, NULL);
+    else
+      gst_video_quality_measure (quality, metrics, ref, dist, 3, results);
+  }
+
+  return (gdouble) n_frames * GST_SECOND / (gst_util_get_timestamp () -
+      start);
+}
+
+static void
+init_planes (GstVideoQualityPlane * planes, guint8 * data)
+{
+  gint i;
+
+  for (i = 0; i < 3; i++) {
+    planes[i].width = i == 0 ? WIDTH : WIDTH / 2;
+    planes[i].height = i == 0 ? HEIGHT : HEIGHT / 2;
+    planes[i].pstride = 1;
+    planes[i].stride = planes[i].width;
+  }
+  planes[0].data = data;
+  planes[1].data = data + WIDTH * HEIGHT;
+  planes[2].data = planes[1].data + WIDTH * HEIGHT / 4;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  static const struct
+  {
+    const gchar *name;
+    GstVideoQualityMetrics metrics;
+  } columns[] = {
+    {"psnr", GST_VIDEO_QUALITY_METRIC_PSNR},
+    {"ssim", GST_VIDEO_QUALITY_METRIC_SSIM},
+    {"ms-ssim", GST_VIDEO_QUALITY_METRIC_MS_SSIM},
+    {"ssim map", 0}
+  };
+  guint size = WIDTH * HEIGHT * 3 / 2;
+  guint8 *ref_data = g_malloc (size), *dist_data = g_malloc (size);
+  guint8 *map = g_malloc (WIDTH * HEIGHT);
+  GstVideoQualityPlane ref[3], dist[3];
+  guint n_frames = 10, n_cpus, n_threads, c, i;
+  GRand *rand;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_frames = atoi (argv[1]);
+
+  /* a pattern with some noise on top */
+  rand = g_rand_new_with_seed (0);
+  for (i = 0; i < size; i++) {
+    ref_data[i] = (i * 7 + i / WIDTH * 13) & 0xff;
+    dist_data[i] = CLAMP (ref_data[i] + g_rand_int_range (rand, -8, 9), 0,
+        255);
+  }
+  g_rand_free (rand);
+
+  init_planes (ref, ref_data);
+  init_planes (dist, dist_data);
+
+  n_cpus = gst_band_pool_get_n_cpus ();
+  g_print ("%u processors, frames/s\n%8s", n_cpus, "threads");
+  for (c = 0; c < G_N_ELEMENTS (columns); c++)
+    g_print (" %10s", columns[c].name);
+  g_print ("\n");
+
+  for (n_threads = 1; n_threads <= n_cpus; n_threads++) {
+    GstVideoQuality *quality = gst_video_quality_new (n_threads);
+
+    g_print ("%8u", n_threads);
+    for (c = 0; c < G_N_ELEMENTS (columns); c++)
+      g_print (" %10.1f", run (quality, columns[c].metrics, ref, dist,
+              columns[c].metrics ? NULL : map, n_frames));
+    g_print ("\n");
+
+    gst_video_quality_free (quality);
+  }
+
+  g_free (map);
+  g_free (dist_data);
+  g_free (ref_data);
+
+  return 0;
+}
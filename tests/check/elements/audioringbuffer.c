@@ -0,0 +1,266 @@
+/* GStreamer
+ *
+ * unit test for the lock-free ring of audioringbuffer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include "gstspscring.h"
+
+/* the element itself is not ported yet, so this only exercises the ring it
+ * hands the samples over with */
+
+static const guint8 silence[2] = { 0x00, 0x80 };
+
+static void
+fill_pattern (guint8 * data, guint len, guint start)
+{
+  guint i;
+
+  for (i = 0; i < len; i++)
+    data[i] = (start + i) & 0xff;
+}
+
+static void
+check_pattern (const guint8 * data, guint len, guint start)
+{
+  guint i;
+
+  for (i = 0; i < len; i++)
+    fail_unless_equals_int (data[i], (start + i) & 0xff);
+}
+
+GST_START_TEST (test_wrap)
+{
+  GstSpscRing ring;
+  guint8 in[10], out[10];
+  guint pos = 0;
+  gint i;
+
+  /* 12 usable bytes in 16 allocated ones */
+  gst_spsc_ring_init (&ring, 12);
+  fail_unless_equals_int (ring.mask, 15);
+
+  /* every round starts at another place in the storage, most of them wrap */
+  for (i = 0; i < 20; i++) {
+    fill_pattern (in, sizeof (in), pos);
+    fail_unless_equals_int (gst_spsc_ring_write (&ring, in, sizeof (in),
+            silence, 2), sizeof (in));
+    fail_unless_equals_int (gst_spsc_ring_fill (&ring), sizeof (in));
+    fail_unless_equals_int (gst_spsc_ring_read (&ring, out, sizeof (out)),
+        sizeof (out));
+    check_pattern (out, sizeof (out), pos);
+    fail_unless_equals_int (gst_spsc_ring_fill (&ring), 0);
+    pos += sizeof (in);
+  }
+
+  gst_spsc_ring_free (&ring);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_positions_wrap)
+{
+  GstSpscRing ring;
+  guint8 in[8], out[8];
+
+  gst_spsc_ring_init (&ring, 8);
+
+  /* the byte counters overflow on long streams */
+  ring.write_pos = ring.read_pos = (gint) (G_MAXUINT - 3);
+
+  fill_pattern (in, sizeof (in), 0);
+  fail_unless_equals_int (gst_spsc_ring_write (&ring, in, sizeof (in),
+          silence, 2), sizeof (in));
+  fail_unless_equals_int (gst_spsc_ring_fill (&ring), sizeof (in));
+  fail_unless_equals_int (gst_spsc_ring_write (&ring, in, 1, silence, 2), 0);
+  fail_unless_equals_int (gst_spsc_ring_read (&ring, out, sizeof (out)),
+      sizeof (out));
+  check_pattern (out, sizeof (out), 0);
+  fail_unless_equals_int (gst_spsc_ring_fill (&ring), 0);
+
+  gst_spsc_ring_free (&ring);
+}
+
+GST_END_TEST;
+
+/* the element counts an overrun whenever a write does not fit */
+GST_START_TEST (test_overrun)
+{
+  GstSpscRing ring;
+  guint8 in[32], out[32];
+
+  gst_spsc_ring_init (&ring, 24);
+
+  fill_pattern (in, sizeof (in), 0);
+  fail_unless_equals_int (gst_spsc_ring_write (&ring, in, sizeof (in),
+          silence, 2), 24);
+  fail_unless_equals_int (gst_spsc_ring_fill (&ring), 24);
+  fail_unless_equals_int (gst_spsc_ring_write (&ring, in + 24, 8, silence, 2),
+      0);
+
+  /* reading a bit makes room for exactly that much */
+  fail_unless_equals_int (gst_spsc_ring_read (&ring, out, 6), 6);
+  check_pattern (out, 6, 0);
+  fail_unless_equals_int (gst_spsc_ring_write (&ring, in + 24, 8, silence, 2),
+      6);
+  fail_unless_equals_int (gst_spsc_ring_read (&ring, out, sizeof (out)), 24);
+  check_pattern (out, 24, 6);
+
+  gst_spsc_ring_free (&ring);
+}
+
+GST_END_TEST;
+
+/* and an underrun whenever a read comes back short */
+GST_START_TEST (test_underrun)
+{
+  GstSpscRing ring;
+  guint8 in[8], out[16];
+
+  gst_spsc_ring_init (&ring, 16);
+
+  fail_unless_equals_int (gst_spsc_ring_read (&ring, out, sizeof (out)), 0);
+
+  fill_pattern (in, sizeof (in), 0);
+  fail_unless_equals_int (gst_spsc_ring_write (&ring, in, sizeof (in),
+          silence, 2), sizeof (in));
+  fail_unless_equals_int (gst_spsc_ring_read (&ring, out, sizeof (out)),
+      sizeof (in));
+  check_pattern (out, sizeof (in), 0);
+  fail_unless_equals_int (gst_spsc_ring_read (&ring, out, sizeof (out)), 0);
+
+  gst_spsc_ring_free (&ring);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_silence)
+{
+  GstSpscRing ring;
+  guint8 in[6], out[16];
+  gint i;
+
+  gst_spsc_ring_init (&ring, 16);
+
+  /* move the positions so that the silence wraps */
+  fill_pattern (in, sizeof (in), 0);
+  gst_spsc_ring_write (&ring, in, sizeof (in), silence, 2);
+  gst_spsc_ring_read (&ring, out, sizeof (in));
+
+  fail_unless_equals_int (gst_spsc_ring_write (&ring, NULL, 14, silence, 2),
+      14);
+  fail_unless_equals_int (gst_spsc_ring_read (&ring, out, sizeof (out)), 14);
+  for (i = 0; i < 14; i++)
+    fail_unless_equals_int (out[i], silence[i % 2]);
+
+  gst_spsc_ring_free (&ring);
+}
+
+GST_END_TEST;
+
+#define DRAIN_BYTES (1024 * 1024 + 7)
+
+typedef struct
+{
+  GstSpscRing ring;
+  volatile gint is_eos;
+} DrainData;
+
+static gpointer
+drain_producer (gpointer user_data)
+{
+  DrainData *d = user_data;
+  guint8 chunk[333];
+  guint pos = 0;
+
+  while (pos < DRAIN_BYTES) {
+    guint len = MIN (sizeof (chunk), DRAIN_BYTES - pos);
+    guint done = 0;
+
+    fill_pattern (chunk, len, pos);
+    while (done < len) {
+      done += gst_spsc_ring_write (&d->ring, chunk + done, len - done,
+          silence, 2);
+      if (done < len)
+        g_thread_yield ();
+    }
+    pos += len;
+  }
+  /* like the element, EOS is only flagged after the last write */
+  g_atomic_int_set (&d->is_eos, TRUE);
+
+  return NULL;
+}
+
+/* after EOS the consumer gets everything that was written before it, in
+ * order, and then an empty ring */
+GST_START_TEST (test_eos_drain)
+{
+  DrainData d;
+  GThread *thread;
+  guint8 out[256];
+  guint pos = 0;
+
+  gst_spsc_ring_init (&d.ring, 1000);
+  d.is_eos = FALSE;
+
+  thread = g_thread_new ("ring-producer", drain_producer, &d);
+  fail_unless (thread != NULL);
+
+  while (TRUE) {
+    /* read the flag before the ring, as in get_range */
+    gboolean is_eos = g_atomic_int_get (&d.is_eos);
+    guint len = gst_spsc_ring_read (&d.ring, out, sizeof (out));
+
+    check_pattern (out, len, pos);
+    pos += len;
+    if (len == 0) {
+      if (is_eos)
+        break;
+      g_thread_yield ();
+    }
+  }
+  g_thread_join (thread);
+
+  fail_unless_equals_int (pos, DRAIN_BYTES);
+  fail_unless_equals_int (gst_spsc_ring_fill (&d.ring), 0);
+
+  gst_spsc_ring_free (&d.ring);
+}
+
+GST_END_TEST;
+
+static Suite *
+audioringbuffer_suite (void)
+{
+  Suite *s = suite_create ("audioringbuffer");
+  TCase *tc_chain = tcase_create ("ring");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_wrap);
+  tcase_add_test (tc_chain, test_positions_wrap);
+  tcase_add_test (tc_chain, test_overrun);
+  tcase_add_test (tc_chain, test_underrun);
+  tcase_add_test (tc_chain, test_silence);
+  tcase_add_test (tc_chain, test_eos_drain);
+
+  return s;
+}
+
+GST_CHECK_MAIN (audioringbuffer);
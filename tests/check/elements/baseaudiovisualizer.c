@@ -66,10 +66,67 @@ static GType gst_test_scope_get_type (void);
 
 G_DEFINE_TYPE (GstTestScope, gst_test_scope, GST_TYPE_AUDIO_VISUALIZER);
 
+#define WIDTH 320
+#define HEIGHT 240
+
+/* when set, setup() asks for windows of two frames that advance by one and
+ * render() checks that every window starts one frame after the previous */
+static gboolean overlap;
+static gint16 next_window;
+
+static gboolean
+gst_test_scope_setup (GstAudioVisualizer * scope)
+{
+  if (overlap) {
+    scope->req_spf = 2 * scope->spf;
+    scope->req_hop = scope->spf;
+  }
+  return TRUE;
+}
+
+/* draws a white line that moves down by 8 rows every frame, so that the
+ * shaded lines of the previous frames stay visible */
+static gboolean
+gst_test_scope_render (GstAudioVisualizer * scope, GstBuffer * audio,
+    GstBuffer * video)
+{
+  GstMapInfo map;
+  guint32 *pixels;
+  guint64 frame;
+  gint x, y;
+
+  if (overlap) {
+    gint16 *samples;
+
+    gst_buffer_map (audio, &map, GST_MAP_READ);
+    samples = (gint16 *) map.data;
+    fail_unless_equals_int (map.size, scope->req_spf * 2 * sizeof (gint16));
+    fail_unless_equals_int (samples[0], next_window);
+    fail_unless_equals_int (samples[scope->spf * 2], next_window + 1);
+    gst_buffer_unmap (audio, &map);
+    next_window++;
+  }
+
+  frame = GST_BUFFER_TIMESTAMP (video) / GST_BUFFER_DURATION (video);
+  y = (frame * 8) % HEIGHT;
+
+  gst_buffer_map (video, &map, GST_MAP_READWRITE);
+  pixels = (guint32 *) map.data;
+  for (x = 0; x < WIDTH; x++)
+    pixels[y * WIDTH + x] = 0xffffffff;
+  gst_buffer_unmap (video, &map);
+
+  return TRUE;
+}
+
 static void
 gst_test_scope_class_init (GstTestScopeClass * g_class)
 {
   GstElementClass *element_class = GST_ELEMENT_CLASS (g_class);
+  GstAudioVisualizerClass *scope_class = GST_AUDIO_VISUALIZER_CLASS (g_class);
+
+  scope_class->setup = GST_DEBUG_FUNCPTR (gst_test_scope_setup);
+  scope_class->render = GST_DEBUG_FUNCPTR (gst_test_scope_render);
 
   gst_element_class_set_details_simple (element_class, "test scope",
       "Visualization",
@@ -155,6 +212,276 @@ GST_START_TEST (count_in_out)
 
 GST_END_TEST;
 
+/* windows of two frames that advance by one: every frame but the last of
+ * one second of audio starts a window */
+GST_START_TEST (overlap_windows)
+{
+  GstElement *elem;
+  GstPad *srcpad, *sinkpad;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  GstMapInfo map;
+  gint16 *samples;
+  const guint spf = 44100 / 30;
+  guint i;
+
+  overlap = TRUE;
+  next_window = 0;
+
+  elem = gst_check_setup_element ("testscope");
+  srcpad = gst_check_setup_src_pad (elem, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (elem, &sinktemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (elem,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (CAPS);
+  gst_pad_set_caps (srcpad, caps);
+  gst_caps_unref (caps);
+
+  /* every sample holds the number of the frame it belongs to */
+  buffer = gst_buffer_new_and_alloc (44100 * 2 * sizeof (gint16));
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  samples = (gint16 *) map.data;
+  for (i = 0; i < 44100 * 2; i++)
+    samples[i] = i / (2 * spf);
+  gst_buffer_unmap (buffer, &map);
+
+  fail_unless (gst_pad_push (srcpad, buffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 29);
+  fail_unless_equals_int (next_window, 29);
+
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  overlap = FALSE;
+
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (elem);
+  gst_check_teardown_sink_pad (elem);
+  gst_check_teardown_element (elem);
+}
+
+GST_END_TEST;
+
+/* pushes 1s of timestamped audio in a time segment and returns the number of
+ * video frames that came out, @qos_event is sent upstream from the sink pad
+ * after the first frame if given */
+static guint
+count_frames_for_one_second (GstElement * elem, GstEvent * qos_event)
+{
+  GstPad *srcpad, *sinkpad;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  GstSegment segment;
+  guint n_frames;
+  /* the audio of one frame at 30 fps */
+  const guint spf = 44100 / 30;
+
+  srcpad = gst_check_setup_src_pad (elem, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (elem, &sinktemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (elem,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (CAPS);
+  gst_pad_set_caps (srcpad, caps);
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  /* the first frame negotiates the video caps */
+  buffer = gst_buffer_new_and_alloc (spf * 2 * sizeof (gint16));
+  GST_BUFFER_TIMESTAMP (buffer) = 0;
+  fail_unless (gst_pad_push (srcpad, buffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+
+  if (qos_event)
+    gst_pad_push_event (sinkpad, qos_event);
+
+  buffer = gst_buffer_new_and_alloc ((44100 - spf) * 2 * sizeof (gint16));
+  GST_BUFFER_TIMESTAMP (buffer) = gst_util_uint64_scale_int (spf, GST_SECOND,
+      44100);
+  fail_unless (gst_pad_push (srcpad, buffer) == GST_FLOW_OK);
+
+  n_frames = g_list_length (buffers);
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+
+  gst_element_set_state (elem, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (elem);
+  gst_check_teardown_sink_pad (elem);
+
+  return n_frames;
+}
+
+GST_START_TEST (max_fps)
+{
+  GstElement *elem;
+
+  /* downstream insists on 30/1, so half of the frames must be dropped */
+  elem = gst_check_setup_element ("testscope");
+  gst_util_set_object_arg (G_OBJECT (elem), "max-fps", "15/1");
+  fail_unless_equals_int (count_frames_for_one_second (elem, NULL), 15);
+  gst_check_teardown_element (elem);
+
+  /* a limit above the frame rate drops nothing */
+  elem = gst_check_setup_element ("testscope");
+  gst_util_set_object_arg (G_OBJECT (elem), "max-fps", "60/1");
+  fail_unless_equals_int (count_frames_for_one_second (elem, NULL), 30);
+  gst_check_teardown_element (elem);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (qos_drop)
+{
+  GstElement *elem;
+  GstBus *bus;
+  GstMessage *msg;
+  GstFormat format;
+  guint64 processed, dropped;
+  guint n_frames;
+
+  elem = gst_check_setup_element ("testscope");
+  bus = gst_bus_new ();
+  gst_element_set_bus (elem, bus);
+
+  /* downstream is 250ms late with the first frame, so the frames up to
+   * 2 * 250ms + one frame duration later are dropped */
+  n_frames = count_frames_for_one_second (elem,
+      gst_event_new_qos (GST_QOS_TYPE_UNDERFLOW, 1.5, 250 * GST_MSECOND, 0));
+  fail_unless (n_frames > 1);
+  fail_unless (n_frames < 30);
+
+  /* every dropped frame is reported */
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_QOS);
+  fail_unless (msg != NULL);
+  gst_message_parse_qos_stats (msg, &format, &processed, &dropped);
+  fail_unless_equals_int (format, GST_FORMAT_BUFFERS);
+  fail_unless_equals_int (dropped, 1);
+  gst_message_unref (msg);
+
+  gst_bus_set_flushing (bus, TRUE);
+  gst_element_set_bus (elem, NULL);
+  gst_object_unref (bus);
+  gst_check_teardown_element (elem);
+}
+
+GST_END_TEST;
+
+/* the element keeps no reference to the frames it pushes, downstream can
+ * write to them without copying */
+static GstPadProbeReturn
+check_writable_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  fail_unless (gst_buffer_is_writable (GST_PAD_PROBE_INFO_BUFFER (info)));
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* pushes the audio of @n_frames frames and returns the video frames */
+static GList *
+render_frames (gboolean async_shading, guint n_frames)
+{
+  GstElement *elem;
+  GstPad *srcpad, *sinkpad;
+  GstBuffer *buffer;
+  GstCaps *caps;
+  GstSegment segment;
+  GList *frames;
+
+  elem = gst_check_setup_element ("testscope");
+  g_object_set (elem, "async-shading", async_shading, NULL);
+  srcpad = gst_check_setup_src_pad (elem, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (elem, &sinktemplate);
+  gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_BUFFER, check_writable_probe,
+      NULL, NULL);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (elem,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (CAPS);
+  gst_pad_set_caps (srcpad, caps);
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  buffer = gst_buffer_new_and_alloc (n_frames * (44100 / 30) * 2 *
+      sizeof (gint16));
+  gst_buffer_memset (buffer, 0, 0, gst_buffer_get_size (buffer));
+  GST_BUFFER_TIMESTAMP (buffer) = 0;
+  fail_unless (gst_pad_push (srcpad, buffer) == GST_FLOW_OK);
+
+  /* going down waits for the pending shading */
+  gst_element_set_state (elem, GST_STATE_NULL);
+  frames = buffers;
+  buffers = NULL;
+
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (elem);
+  gst_check_teardown_sink_pad (elem);
+  gst_check_teardown_element (elem);
+
+  return frames;
+}
+
+GST_START_TEST (async_shading)
+{
+  GList *sync_frames, *async_frames, *s, *a;
+  GstMapInfo smap, amap;
+  guint i;
+
+  sync_frames = render_frames (FALSE, 10);
+  async_frames = render_frames (TRUE, 10);
+  fail_unless_equals_int (g_list_length (sync_frames), 10);
+  fail_unless_equals_int (g_list_length (async_frames), 10);
+
+  /* shading the background in the worker thread must not change what is
+   * drawn on top of it */
+  for (s = sync_frames, a = async_frames, i = 0; s; s = s->next, a = a->next,
+      i++) {
+    gst_buffer_map (GST_BUFFER (s->data), &smap, GST_MAP_READ);
+    gst_buffer_map (GST_BUFFER (a->data), &amap, GST_MAP_READ);
+    fail_unless_equals_int (smap.size, WIDTH * HEIGHT * 4);
+    fail_unless_equals_int (amap.size, smap.size);
+    fail_unless (memcmp (smap.data, amap.data, smap.size) == 0,
+        "frame %u differs", i);
+
+    /* the line of the first frame is faded, but still there */
+    if (i > 0) {
+      guint32 pixel = ((guint32 *) smap.data)[0];
+
+      fail_if (pixel == 0);
+      fail_if (pixel == 0xffffffff);
+    }
+    gst_buffer_unmap (GST_BUFFER (s->data), &smap);
+    gst_buffer_unmap (GST_BUFFER (a->data), &amap);
+  }
+
+  g_list_free_full (sync_frames, (GDestroyNotify) gst_mini_object_unref);
+  g_list_free_full (async_frames, (GDestroyNotify) gst_mini_object_unref);
+}
+
+GST_END_TEST;
+
 static void
 baseaudiovisualizer_init (void)
 {
@@ -171,6 +498,10 @@ baseaudiovisualizer_suite (void)
   tcase_add_checked_fixture (tc_chain, baseaudiovisualizer_init, NULL);
 
   tcase_add_test (tc_chain, count_in_out);
+  tcase_add_test (tc_chain, overlap_windows);
+  tcase_add_test (tc_chain, max_fps);
+  tcase_add_test (tc_chain, qos_drop);
+  tcase_add_test (tc_chain, async_shading);
 
   return s;
 }
@@ -0,0 +1,272 @@
+/* GStreamer
+ *
+ * unit test for coloreffects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gstcoloreffectscube.h"
+
+/* a 2x2x2 table that swaps red and blue */
+static const gchar valid_cube[] =
+    "# comment\n"
+    "TITLE \"swap\"\n"
+    "LUT_3D_SIZE 2\n"
+    "DOMAIN_MIN 0.0 0.0 0.0\n"
+    "DOMAIN_MAX 1.0 1.0 1.0\n"
+    "\n"
+    "0.0 0.0 0.0\n"
+    "0.0 0.0 1.0\n"
+    "0.0 1.0 0.0\n"
+    "0.0 1.0 1.0\n"
+    "1.0 0.0 0.0\n"
+    "1.0 0.0 1.0\n"
+    "1.0 1.0 0.0\n"
+    "1.0 1.0 1.0\n";
+
+/* writes @contents to a temporary file, the caller removes it */
+static gchar *
+write_cube (const gchar * contents)
+{
+  GError *err = NULL;
+  gchar *path = NULL;
+  gint fd;
+
+  fd = g_file_open_tmp ("coloreffects-XXXXXX.cube", &path, &err);
+  fail_unless (fd >= 0, "could not create a temporary file: %s",
+      err ? err->message : "");
+  close (fd);
+  fail_unless (g_file_set_contents (path, contents, -1, NULL));
+
+  return path;
+}
+
+/* the valid table without its last entry */
+static gchar *
+short_cube (void)
+{
+  return g_strndup (valid_cube,
+      strlen (valid_cube) - strlen ("1.0 1.0 1.0\n"));
+}
+
+/* loads @contents and checks that it fails with an error that contains
+ * @message */
+static void
+check_invalid (const gchar * contents, const gchar * message)
+{
+  GError *err = NULL;
+  gfloat min[3], max[3];
+  gchar *path = write_cube (contents);
+  gfloat *cube;
+  gint size = 0;
+
+  cube = gst_color_effects_load_cube (path, &size, min, max, &err);
+  fail_unless (cube == NULL, "loaded invalid table:\n%s", contents);
+  fail_unless (err != NULL);
+  fail_unless (g_error_matches (err, G_FILE_ERROR, G_FILE_ERROR_INVAL));
+  fail_unless (strstr (err->message, message) != NULL,
+      "error \"%s\" does not mention \"%s\"", err->message, message);
+
+  g_error_free (err);
+  g_unlink (path);
+  g_free (path);
+}
+
+GST_START_TEST (test_load_valid)
+{
+  GError *err = NULL;
+  gfloat min[3], max[3];
+  gchar *path = write_cube (valid_cube);
+  gfloat *cube;
+  gint size = 0, r, g, b;
+
+  cube = gst_color_effects_load_cube (path, &size, min, max, &err);
+  fail_unless (cube != NULL, "%s", err ? err->message : "");
+  fail_unless_equals_int (size, 2);
+  for (b = 0; b < 3; b++) {
+    fail_unless_equals_float (min[b], 0.0);
+    fail_unless_equals_float (max[b], 1.0);
+  }
+  /* red varies fastest */
+  for (b = 0; b < 2; b++) {
+    for (g = 0; g < 2; g++) {
+      for (r = 0; r < 2; r++) {
+        const gfloat *p = cube + ((b * 2 + g) * 2 + r) * 3;
+
+        fail_unless_equals_float (p[0], b);
+        fail_unless_equals_float (p[1], g);
+        fail_unless_equals_float (p[2], r);
+      }
+    }
+  }
+
+  g_free (cube);
+  g_unlink (path);
+  g_free (path);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_load_input_range)
+{
+  GError *err = NULL;
+  gfloat min[3], max[3];
+  gchar *contents, *path;
+  gfloat *cube;
+  gint size = 0, i;
+
+  contents = g_strdup_printf ("LUT_3D_INPUT_RANGE 0.0 4.0\n%s",
+      strstr (valid_cube, "LUT_3D_SIZE"));
+  /* a DOMAIN line after the range overrides it */
+  *strstr (contents, "DOMAIN_MAX 1.0") = '#';
+  path = write_cube (contents);
+
+  cube = gst_color_effects_load_cube (path, &size, min, max, &err);
+  fail_unless (cube != NULL, "%s", err ? err->message : "");
+  for (i = 0; i < 3; i++) {
+    fail_unless_equals_float (min[i], 0.0);
+    fail_unless_equals_float (max[i], 4.0);
+  }
+
+  g_free (cube);
+  g_unlink (path);
+  g_free (path);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_load_short)
+{
+  gchar *contents = short_cube ();
+
+  check_invalid (contents, "expected 8 table entries, found 7");
+  check_invalid ("LUT_3D_SIZE 2\n", "found 0");
+  check_invalid ("", "found 0");
+
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_load_malformed)
+{
+  gchar *contents;
+
+  /* not a number */
+  contents = g_strdup (valid_cube);
+  memcpy (strstr (contents, "0.0 1.0 1.0"), "0.0 x.0 1.0", 11);
+  check_invalid (contents, ":10: invalid line");
+  g_free (contents);
+
+  /* one entry too many */
+  contents = g_strconcat (valid_cube, "1.0 1.0 1.0\n", NULL);
+  check_invalid (contents, ":15: invalid line");
+  g_free (contents);
+
+  /* entries before the size */
+  check_invalid ("0.0 0.0 0.0\nLUT_3D_SIZE 2\n", ":1: invalid line");
+  /* sizes out of range, and a second size */
+  check_invalid ("LUT_3D_SIZE 1\n0.0 0.0 0.0\n", ":1: invalid line");
+  check_invalid ("LUT_3D_SIZE 257\n", ":1: invalid line");
+  check_invalid ("LUT_3D_SIZE 2\nLUT_3D_SIZE 2\n", ":2: invalid line");
+  /* short keyword arguments */
+  check_invalid ("DOMAIN_MIN 0.0 0.0\n", ":1: invalid line");
+  check_invalid ("LUT_3D_INPUT_RANGE 0.0\n", ":1: invalid line");
+  /* empty domain */
+  contents = g_strdup (valid_cube);
+  memcpy (strstr (contents, "DOMAIN_MAX 1.0"), "DOMAIN_MAX 0.0", 14);
+  check_invalid (contents, "invalid domain");
+  g_free (contents);
+  /* 1D tables */
+  check_invalid ("LUT_1D_SIZE 2\n0.0 0.0 0.0\n1.0 1.0 1.0\n",
+      "1D lookup tables are not supported");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_load_missing)
+{
+  GError *err = NULL;
+  gfloat min[3], max[3];
+  gint size = 0;
+
+  fail_unless (gst_color_effects_load_cube ("/nonexistent/grade.cube", &size,
+          min, max, &err) == NULL);
+  fail_unless (g_error_matches (err, G_FILE_ERROR, G_FILE_ERROR_NOENT));
+  g_error_free (err);
+}
+
+GST_END_TEST;
+
+/* a table that can not be loaded is reported on the bus */
+GST_START_TEST (test_lut_file_warning)
+{
+  GstElement *coloreffects;
+  GstBus *bus;
+  GstMessage *msg;
+  gchar *path, *contents = short_cube ();
+
+  path = write_cube (contents);
+
+  coloreffects = gst_check_setup_element ("coloreffects");
+  bus = gst_bus_new ();
+  gst_element_set_bus (coloreffects, bus);
+
+  g_object_set (coloreffects, "lut-file", path, NULL);
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_WARNING);
+  fail_unless (msg != NULL, "no warning posted");
+  fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT (coloreffects));
+  gst_message_unref (msg);
+
+  /* a valid table does not warn */
+  g_file_set_contents (path, valid_cube, -1, NULL);
+  g_object_set (coloreffects, "lut-file", path, NULL);
+  fail_unless (gst_bus_pop_filtered (bus, GST_MESSAGE_WARNING) == NULL);
+
+  gst_element_set_bus (coloreffects, NULL);
+  gst_object_unref (bus);
+  gst_check_teardown_element (coloreffects);
+  g_unlink (path);
+  g_free (path);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+static Suite *
+coloreffects_suite (void)
+{
+  Suite *s = suite_create ("coloreffects");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_load_valid);
+  tcase_add_test (tc_chain, test_load_input_range);
+  tcase_add_test (tc_chain, test_load_short);
+  tcase_add_test (tc_chain, test_load_malformed);
+  tcase_add_test (tc_chain, test_load_missing);
+  tcase_add_test (tc_chain, test_lut_file_warning);
+
+  return s;
+}
+
+GST_CHECK_MAIN (coloreffects);
@@ -0,0 +1,317 @@
+/* GStreamer
+ *
+ * unit test for fieldanalysis
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+#include <string.h>
+
+#define WIDTH 320
+#define HEIGHT 240
+#define N_FRAMES 20
+
+#define CAPS_STRING "video/x-raw-yuv, " \
+    "format = (fourcc) I420, " \
+    "width = (int) 320, " \
+    "height = (int) 240, " \
+    "framerate = (fraction) 30000/1001, " \
+    "pixel-aspect-ratio = (fraction) 1/1"
+
+#define DECISION_FLAGS (GST_VIDEO_BUFFER_TFF | GST_VIDEO_BUFFER_RFF | \
+    GST_VIDEO_BUFFER_ONEFIELD | GST_VIDEO_BUFFER_PROGRESSIVE)
+
+/* For ease of programming we use globals to keep refs for our floating
+ * src and sink pads we create; otherwise we always have to do get_pad,
+ * get_peer, and then remove references in every test function */
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_YUV ("I420")));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_YUV ("I420")));
+
+typedef enum
+{
+  CONTENT_PROGRESSIVE,
+  CONTENT_INTERLACED,
+  CONTENT_TELECINE
+} Content;
+
+static GstElement *
+setup_fieldanalysis (void)
+{
+  GstElement *fieldanalysis;
+
+  GST_DEBUG ("setup_fieldanalysis");
+  fieldanalysis = gst_check_setup_element ("fieldanalysis");
+  mysrcpad = gst_check_setup_src_pad (fieldanalysis, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (fieldanalysis, &sinktemplate, NULL);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  return fieldanalysis;
+}
+
+static void
+cleanup_fieldanalysis (GstElement * fieldanalysis)
+{
+  GST_DEBUG ("cleanup_fieldanalysis");
+  gst_element_set_state (fieldanalysis, GST_STATE_NULL);
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (fieldanalysis);
+  gst_check_teardown_sink_pad (fieldanalysis);
+  gst_check_teardown_element (fieldanalysis);
+}
+
+/* which instants of the scene the top and bottom field of frame i show */
+static void
+get_field_times (Content content, gint i, gint * top, gint * bottom)
+{
+  /* 3:2 pulldown of film frames A B C D: AA BB BC CD DD */
+  static const gint pulldown[5][2] = {
+    {0, 0}, {1, 1}, {1, 2}, {2, 3}, {3, 3}
+  };
+
+  switch (content) {
+    case CONTENT_PROGRESSIVE:
+      *top = *bottom = i;
+      break;
+    case CONTENT_INTERLACED:
+      *top = 2 * i;
+      *bottom = 2 * i + 1;
+      break;
+    case CONTENT_TELECINE:
+      *top = 4 * (i / 5) + pulldown[i % 5][0];
+      *bottom = 4 * (i / 5) + pulldown[i % 5][1];
+      break;
+  }
+}
+
+/* vertical stripes 16 samples wide that move 8 samples to the right from
+ * one instant to the next, so fields of different instants comb */
+static void
+fill_frame (guint8 * data, gint top, gint bottom)
+{
+  gint x, y;
+
+  for (y = 0; y < HEIGHT; y++) {
+    gint t = (y & 1) ? bottom : top;
+
+    for (x = 0; x < WIDTH; x++)
+      data[y * WIDTH + x] = ((x + 8 * t) / 16) % 2 ? 200 : 40;
+  }
+  memset (data + WIDTH * HEIGHT, 128, WIDTH * HEIGHT / 2);
+}
+
+/* returns the output buffers, the caller owns the list and the buffers */
+static GList *
+run_analysis (Content content, const gchar * frame_metric, guint n_threads)
+{
+  GstElement *fieldanalysis;
+  GstCaps *caps;
+  GList *outbuffers;
+  gint i;
+
+  fieldanalysis = setup_fieldanalysis ();
+  gst_util_set_object_arg (G_OBJECT (fieldanalysis), "frame-metric",
+      frame_metric);
+  g_object_set (fieldanalysis, "n-threads", n_threads, NULL);
+  fail_unless (gst_element_set_state (fieldanalysis,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (CAPS_STRING);
+  fail_unless (gst_pad_set_caps (mysrcpad, caps));
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_TIME, 0, -1, 0)));
+
+  for (i = 0; i < N_FRAMES; i++) {
+    GstBuffer *inbuffer;
+    gint top, bottom;
+
+    inbuffer = gst_buffer_new_and_alloc (WIDTH * HEIGHT * 3 / 2);
+    get_field_times (content, i, &top, &bottom);
+    fill_frame (GST_BUFFER_DATA (inbuffer), top, bottom);
+    GST_BUFFER_TIMESTAMP (inbuffer) =
+        gst_util_uint64_scale (i, 1001 * GST_SECOND, 30000);
+    gst_buffer_set_caps (inbuffer, caps);
+    fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  }
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  gst_caps_unref (caps);
+
+  outbuffers = buffers;
+  buffers = NULL;
+  cleanup_fieldanalysis (fieldanalysis);
+
+  fail_unless (g_list_length (outbuffers) >= N_FRAMES - 2);
+
+  return outbuffers;
+}
+
+static void
+free_buffers (GList * outbuffers)
+{
+  g_list_foreach (outbuffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (outbuffers);
+}
+
+static gboolean
+buffer_is_interlaced (GstBuffer * buffer)
+{
+  GstStructure *s = gst_caps_get_structure (GST_BUFFER_CAPS (buffer), 0);
+  gboolean interlaced = FALSE;
+
+  gst_structure_get_boolean (s, "interlaced", &interlaced);
+
+  return interlaced;
+}
+
+static gboolean
+buffer_is_telecine (GstBuffer * buffer)
+{
+  GstStructure *s = gst_caps_get_structure (GST_BUFFER_CAPS (buffer), 0);
+
+  return g_strcmp0 (gst_structure_get_string (s, "interlacing-method"),
+      "telecine") == 0;
+}
+
+/* the analysis must come to the same decisions whatever the number of
+ * bands the frames are split into */
+static void
+check_same_decisions (Content content, const gchar * frame_metric)
+{
+  GList *reference, *outbuffers, *l, *m;
+  guint n_threads;
+
+  reference = run_analysis (content, frame_metric, 1);
+
+  for (n_threads = 2; n_threads <= 8; n_threads *= 2) {
+    outbuffers = run_analysis (content, frame_metric, n_threads);
+
+    fail_unless_equals_int (g_list_length (outbuffers),
+        g_list_length (reference));
+    for (l = reference, m = outbuffers; l && m; l = l->next, m = m->next) {
+      GstBuffer *expected = l->data, *buffer = m->data;
+
+      fail_unless_equals_int (GST_BUFFER_FLAGS (buffer) & DECISION_FLAGS,
+          GST_BUFFER_FLAGS (expected) & DECISION_FLAGS);
+      fail_unless (gst_caps_is_equal (GST_BUFFER_CAPS (buffer),
+              GST_BUFFER_CAPS (expected)));
+    }
+
+    free_buffers (outbuffers);
+  }
+
+  free_buffers (reference);
+}
+
+GST_START_TEST (test_progressive)
+{
+  GList *outbuffers, *l;
+
+  outbuffers = run_analysis (CONTENT_PROGRESSIVE, "5-tap", 4);
+  for (l = outbuffers; l; l = l->next) {
+    GstBuffer *buffer = l->data;
+
+    fail_if (buffer_is_interlaced (buffer));
+    fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_VIDEO_BUFFER_ONEFIELD));
+    fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_VIDEO_BUFFER_RFF));
+  }
+  free_buffers (outbuffers);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_interlaced)
+{
+  GList *outbuffers, *l;
+
+  outbuffers = run_analysis (CONTENT_INTERLACED, "5-tap", 4);
+  for (l = outbuffers; l; l = l->next) {
+    GstBuffer *buffer = l->data;
+
+    fail_unless (buffer_is_interlaced (buffer));
+    fail_if (buffer_is_telecine (buffer));
+    fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_VIDEO_BUFFER_ONEFIELD));
+  }
+  free_buffers (outbuffers);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_telecine)
+{
+  GList *outbuffers, *l;
+  gboolean telecine = FALSE;
+
+  outbuffers = run_analysis (CONTENT_TELECINE, "5-tap", 4);
+  for (l = outbuffers; l; l = l->next)
+    telecine |= buffer_is_telecine (l->data);
+  fail_unless (telecine);
+  free_buffers (outbuffers);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_same_decisions_5_tap)
+{
+  check_same_decisions (CONTENT_PROGRESSIVE, "5-tap");
+  check_same_decisions (CONTENT_INTERLACED, "5-tap");
+  check_same_decisions (CONTENT_TELECINE, "5-tap");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_same_decisions_windowed_comb)
+{
+  check_same_decisions (CONTENT_PROGRESSIVE, "windowed-comb");
+  check_same_decisions (CONTENT_INTERLACED, "windowed-comb");
+  check_same_decisions (CONTENT_TELECINE, "windowed-comb");
+}
+
+GST_END_TEST;
+
+static Suite *
+fieldanalysis_suite (void)
+{
+  Suite *s = suite_create ("fieldanalysis");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_set_timeout (tc_chain, 60);
+
+  tcase_add_test (tc_chain, test_progressive);
+  tcase_add_test (tc_chain, test_interlaced);
+  tcase_add_test (tc_chain, test_telecine);
+  tcase_add_test (tc_chain, test_same_decisions_5_tap);
+  tcase_add_test (tc_chain, test_same_decisions_windowed_comb);
+
+  return s;
+}
+
+GST_CHECK_MAIN (fieldanalysis);
@@ -0,0 +1,180 @@
+/* GStreamer
+ *
+ * unit test for the reverb model of freeverb
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <math.h>
+
+#include "gstfreeverbmodel.h"
+
+#define N_BLOCKS 20
+#define MAX_BANKS 6
+
+/* like the element with the default properties */
+#define FEEDBACK (0.5f * scaleroom + offsetroom)
+#define DAMP (0.2f * scaledamp)
+
+typedef struct
+{
+  freeverb_bank banks[MAX_BANKS];
+  gint n_banks;
+  gfloat block_in[MAX_BANKS * BLOCK_SIZE];
+  gfloat block_out[MAX_BANKS * BLOCK_SIZE];
+} Model;
+
+static void
+model_init (Model * m, gint n_banks)
+{
+  gint b;
+
+  m->n_banks = n_banks;
+  for (b = 0; b < n_banks; b++) {
+    freeverb_bank_setbuffers (&m->banks[b], b, 1.0f);
+    freeverb_bank_init (&m->banks[b]);
+  }
+}
+
+static void
+model_free (Model * m)
+{
+  gint b;
+
+  for (b = 0; b < m->n_banks; b++)
+    freeverb_bank_release (&m->banks[b]);
+}
+
+/* runs one block of noise, a different one on each bank, through all banks
+ * into m->block_out */
+static void
+model_run (Model * m, guint32 * seed)
+{
+  gint b;
+  guint k;
+
+  for (b = 0; b < m->n_banks; b++) {
+    gfloat *in = m->block_in + b * BLOCK_SIZE;
+
+    for (k = 0; k < BLOCK_SIZE; k++) {
+      *seed = *seed * 1103515245 + 12345;
+      in[k] = (((gint) ((*seed >> 16) & 0x7fff) - 0x4000) + DC_OFFSET) *
+          fixedgain;
+    }
+    freeverb_bank_process (&m->banks[b], FEEDBACK, DAMP, in,
+        m->block_out + b * BLOCK_SIZE, BLOCK_SIZE);
+  }
+}
+
+/* checks freeverb_bank_wet() of every channel against the mix it should do,
+ * the partner of channel b is b ^ 1, if there is one */
+static void
+check_wet (Model * m, gfloat wet1, gfloat wet2)
+{
+  gfloat wet[BLOCK_SIZE];
+  gint b;
+  guint k;
+
+  for (b = 0; b < m->n_banks; b++) {
+    gint partner = (b ^ 1) < m->n_banks ? (b ^ 1) : -1;
+    const gfloat *out = m->block_out + b * BLOCK_SIZE;
+
+    freeverb_bank_wet (m->block_out, b, m->n_banks, wet1, wet2, wet,
+        BLOCK_SIZE);
+    for (k = 0; k < BLOCK_SIZE; k++) {
+      gdouble expected = (out[k] - DC_OFFSET) * wet1;
+
+      if (partner >= 0)
+        expected += (m->block_out[partner * BLOCK_SIZE + k] - DC_OFFSET) *
+            wet2;
+      fail_unless (fabs (wet[k] - expected) <= 1e-6 * (1.0 + fabs (expected)),
+          "%d banks, channel %d, frame %u: %g instead of %g", m->n_banks, b,
+          k, wet[k], expected);
+    }
+  }
+}
+
+GST_START_TEST (test_pairs)
+{
+  gint n_banks, i;
+
+  for (n_banks = 2; n_banks <= MAX_BANKS; n_banks++) {
+    Model m;
+    guint32 seed = n_banks;
+
+    model_init (&m, n_banks);
+    for (i = 0; i < N_BLOCKS; i++) {
+      model_run (&m, &seed);
+      /* width 0.5 and 0, level 1 */
+      check_wet (&m, 0.75f, 0.25f);
+      check_wet (&m, 0.5f, 0.5f);
+    }
+    model_free (&m);
+  }
+}
+
+GST_END_TEST;
+
+/* The last of an odd number of channels used to be its own partner and got
+ * wet1 + wet2 of its reverb, louder than the others when width < 1. */
+GST_START_TEST (test_unpaired_level)
+{
+  Model m;
+  gfloat wet[BLOCK_SIZE];
+  gdouble energy[3] = { 0.0, 0.0, 0.0 };
+  guint32 seed = 1;
+  gint i, b;
+  guint k;
+
+  model_init (&m, 3);
+  for (i = 0; i < N_BLOCKS; i++) {
+    model_run (&m, &seed);
+    for (b = 0; b < 3; b++) {
+      freeverb_bank_wet (m.block_out, b, 3, 0.5f, 0.5f, wet, BLOCK_SIZE);
+      for (k = 0; k < BLOCK_SIZE; k++)
+        energy[b] += wet[k] * wet[k];
+    }
+  }
+  model_free (&m);
+
+  /* the reverbs of different channels are about uncorrelated, a pair sums
+   * two halves of them and the lone channel has half of one */
+  fail_unless (energy[2] > 0.0);
+  fail_unless (energy[2] < energy[0] && energy[2] < energy[1],
+      "unpaired channel has energy %g, the pair %g and %g", energy[2],
+      energy[0], energy[1]);
+  fail_unless (energy[2] > 0.25 * energy[0] && energy[2] > 0.25 * energy[1],
+      "unpaired channel has energy %g, the pair %g and %g", energy[2],
+      energy[0], energy[1]);
+}
+
+GST_END_TEST;
+
+static Suite *
+freeverb_suite (void)
+{
+  Suite *s = suite_create ("freeverb");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_pairs);
+  tcase_add_test (tc_chain, test_unpaired_level);
+
+  return s;
+}
+
+GST_CHECK_MAIN (freeverb);
@@ -0,0 +1,295 @@
+/* GStreamer
+ *
+ * unit test for interlace
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/video/video.h>
+#include <string.h>
+
+#define CAPS_STRING(fps) "video/x-raw, " \
+    "format = (string) I420, " \
+    "width = (int) 64, " \
+    "height = (int) 48, " \
+    "framerate = (fraction) " fps ", " \
+    "interlace-mode = (string) progressive"
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("I420"))
+    );
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE ("I420"))
+    );
+
+/* every input frame is filled with a value derived from its index, so the
+ * origin of each output line can be told from its content */
+static guint8
+frame_value (gint i)
+{
+  return 16 + 8 * i;
+}
+
+/* pushes @n_frames frames through interlace with the given field pattern and
+ * returns the output buffers, the caller owns the list and the buffers. When
+ * @keep_inputs is set the input buffers are kept referenced so that the
+ * element cannot reuse them for its output. Input frame @flagged_frame gets
+ * @flags set, -1 for none. */
+static GList *
+run_interlace (const gchar * pattern, const gchar * caps_string,
+    gint n_frames, gboolean keep_inputs, gint flagged_frame, guint flags)
+{
+  GstElement *interlace;
+  GstPad *srcpad, *sinkpad;
+  GstCaps *caps;
+  GstVideoInfo info;
+  GList *inbuffers = NULL, *outbuffers;
+  gint i;
+
+  interlace = gst_check_setup_element ("interlace");
+  gst_util_set_object_arg (G_OBJECT (interlace), "field-pattern", pattern);
+  g_object_set (interlace, "top-field-first", TRUE, NULL);
+  srcpad = gst_check_setup_src_pad (interlace, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (interlace, &sinktemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (interlace,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (caps_string);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_pad_set_caps (srcpad, caps);
+  gst_caps_unref (caps);
+
+  for (i = 0; i < n_frames; i++) {
+    GstBuffer *buffer;
+    GstMapInfo map;
+
+    buffer = gst_buffer_new_and_alloc (info.size);
+    gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+    memset (map.data, frame_value (i), map.size);
+    gst_buffer_unmap (buffer, &map);
+    GST_BUFFER_TIMESTAMP (buffer) =
+        gst_util_uint64_scale (i, GST_SECOND * info.fps_d, info.fps_n);
+    if (i == flagged_frame)
+      GST_BUFFER_FLAG_SET (buffer, flags);
+
+    if (keep_inputs)
+      inbuffers = g_list_append (inbuffers, gst_buffer_ref (buffer));
+    fail_unless (gst_pad_push (srcpad, buffer) == GST_FLOW_OK);
+  }
+
+  /* the inputs must not have been written to */
+  for (i = 0; i < g_list_length (inbuffers); i++) {
+    GstBuffer *buffer = g_list_nth_data (inbuffers, i);
+    GstMapInfo map;
+    gsize j;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    for (j = 0; j < map.size; j++)
+      fail_unless_equals_int (map.data[j], frame_value (i));
+    gst_buffer_unmap (buffer, &map);
+  }
+  g_list_foreach (inbuffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (inbuffers);
+
+  outbuffers = buffers;
+  buffers = NULL;
+
+  gst_element_set_state (interlace, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (interlace);
+  gst_check_teardown_sink_pad (interlace);
+  gst_check_teardown_element (interlace);
+
+  return outbuffers;
+}
+
+/* checks that the top lines of every plane of @buffer come from input frame
+ * @top and the bottom lines from input frame @bottom */
+static void
+check_fields (GstBuffer * buffer, const gchar * caps_string, gint top,
+    gint bottom)
+{
+  GstCaps *caps;
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  gint i, j, k;
+
+  caps = gst_caps_from_string (caps_string);
+  fail_unless (gst_video_info_from_caps (&info, caps));
+  gst_caps_unref (caps);
+
+  fail_unless (gst_video_frame_map (&frame, &info, buffer, GST_MAP_READ));
+  for (i = 0; i < GST_VIDEO_FRAME_N_PLANES (&frame); i++) {
+    guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (&frame, i);
+    gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (&frame, i);
+
+    for (j = 0; j < GST_VIDEO_FRAME_COMP_HEIGHT (&frame, i); j++) {
+      guint8 expected = frame_value ((j & 1) ? bottom : top);
+
+      for (k = 0; k < GST_VIDEO_FRAME_COMP_WIDTH (&frame, i); k++)
+        fail_unless_equals_int (data[j * stride + k], expected);
+    }
+  }
+  gst_video_frame_unmap (&frame);
+}
+
+/* 2:3 pulldown of film frames A B C D gives AA BB BC CD DD */
+static void
+check_2_3 (gboolean keep_inputs)
+{
+  static const gint fields[5][2] = {
+    {0, 0}, {1, 1}, {1, 2}, {2, 3}, {3, 3}
+  };
+  const gchar *caps_string = CAPS_STRING ("24000/1001");
+  GList *outbuffers, *l;
+  gint i;
+
+  outbuffers = run_interlace ("2:3", caps_string, 8, keep_inputs, -1, 0);
+  fail_unless_equals_int (g_list_length (outbuffers), 10);
+
+  for (l = outbuffers, i = 0; l; l = l->next, i++) {
+    GstBuffer *buffer = l->data;
+    gint top = 4 * (i / 5) + fields[i % 5][0];
+    gint bottom = 4 * (i / 5) + fields[i % 5][1];
+
+    check_fields (buffer, caps_string, top, bottom);
+    fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buffer,
+            GST_VIDEO_BUFFER_FLAG_INTERLACED), top != bottom);
+    fail_unless (GST_BUFFER_FLAG_IS_SET (buffer, GST_VIDEO_BUFFER_FLAG_TFF));
+  }
+
+  g_list_foreach (outbuffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (outbuffers);
+}
+
+GST_START_TEST (test_2_3_in_place)
+{
+  check_2_3 (FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_2_3_pooled)
+{
+  check_2_3 (TRUE);
+}
+
+GST_END_TEST;
+
+/* in 2:3 the field of D is woven into the buffer of C, which must not hand
+ * its own flags on to CD */
+GST_START_TEST (test_in_place_flags)
+{
+  const gchar *caps_string = CAPS_STRING ("24000/1001");
+  GList *outbuffers;
+  GstBuffer *buffer;
+
+  outbuffers = run_interlace ("2:3", caps_string, 4, FALSE, 2,
+      GST_BUFFER_FLAG_DISCONT | GST_VIDEO_BUFFER_FLAG_RFF |
+      GST_VIDEO_BUFFER_FLAG_ONEFIELD);
+  fail_unless_equals_int (g_list_length (outbuffers), 5);
+
+  buffer = g_list_nth_data (outbuffers, 3);
+  check_fields (buffer, caps_string, 2, 3);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DISCONT));
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_VIDEO_BUFFER_FLAG_RFF));
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_VIDEO_BUFFER_FLAG_ONEFIELD));
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffer, GST_VIDEO_BUFFER_FLAG_TFF));
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffer,
+          GST_VIDEO_BUFFER_FLAG_INTERLACED));
+
+  g_list_foreach (outbuffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (outbuffers);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_1_1)
+{
+  const gchar *caps_string = CAPS_STRING ("60/1");
+  GList *outbuffers, *l;
+  gint i;
+
+  /* every output frame weaves two consecutive input frames */
+  outbuffers = run_interlace ("1:1", caps_string, 8, FALSE, -1, 0);
+  fail_unless_equals_int (g_list_length (outbuffers), 4);
+
+  for (l = outbuffers, i = 0; l; l = l->next, i++)
+    check_fields (l->data, caps_string, 2 * i, 2 * i + 1);
+
+  g_list_foreach (outbuffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (outbuffers);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pattern_rates)
+{
+  static const struct
+  {
+    const gchar *pattern;
+    const gchar *caps_string;
+    gint n_in, n_out;
+  } rates[] = {
+    {"2:3:3:2", CAPS_STRING ("24/1"), 8, 10},
+    {"2-11:3", CAPS_STRING ("24/1"), 24, 25},
+    {"2:2:2:4", CAPS_STRING ("24/1"), 8, 10},
+    {"2:2:3:2:3", CAPS_STRING ("25/1"), 10, 12},
+    {"3:3:4", CAPS_STRING ("18/1"), 6, 10},
+    {"3:3", CAPS_STRING ("20/1"), 4, 6}
+  };
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (rates); i++) {
+    GList *outbuffers;
+
+    outbuffers = run_interlace (rates[i].pattern, rates[i].caps_string,
+        rates[i].n_in, FALSE, -1, 0);
+    fail_unless_equals_int (g_list_length (outbuffers), rates[i].n_out);
+    g_list_foreach (outbuffers, (GFunc) gst_mini_object_unref, NULL);
+    g_list_free (outbuffers);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+interlace_suite (void)
+{
+  Suite *s = suite_create ("interlace");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_2_3_in_place);
+  tcase_add_test (tc_chain, test_2_3_pooled);
+  tcase_add_test (tc_chain, test_in_place_flags);
+  tcase_add_test (tc_chain, test_1_1);
+  tcase_add_test (tc_chain, test_pattern_rates);
+
+  return s;
+}
+
+GST_CHECK_MAIN (interlace);
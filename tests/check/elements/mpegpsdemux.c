@@ -0,0 +1,230 @@
+/* GStreamer
+ *
+ * unit test for the SCR index of mpegpsdemux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include "gstmpegdemuxindex.h"
+
+#define DIST GST_FLUPS_INDEX_ENTRY_DISTANCE
+
+static GArray *
+index_new (void)
+{
+  return g_array_new (FALSE, FALSE, sizeof (GstFluPSIndexEntry));
+}
+
+static void
+check_entries (GArray * index, const guint64 * expected, guint n)
+{
+  guint i;
+
+  fail_unless_equals_int (index->len, n);
+  for (i = 0; i < n; i++) {
+    GstFluPSIndexEntry *e = &g_array_index (index, GstFluPSIndexEntry, i);
+
+    fail_unless (e->offset == expected[2 * i] && e->scr == expected[2 * i + 1],
+        "entry %u is SCR %" G_GUINT64_FORMAT " at %" G_GUINT64_FORMAT
+        ", expected SCR %" G_GUINT64_FORMAT " at %" G_GUINT64_FORMAT, i,
+        e->scr, e->offset, expected[2 * i + 1], expected[2 * i]);
+  }
+}
+
+/* entries come in any order and end up sorted */
+GST_START_TEST (test_insert)
+{
+  static const guint64 expected[] = {
+    /* offset, scr */
+    0, 1000,
+    4 * DIST, 5000,
+    8 * DIST, 9000,
+    12 * DIST, 13000,
+    16 * DIST, 17000,
+  };
+  GArray *index = index_new ();
+
+  fail_unless (gst_flups_index_add (index, 9000, 8 * DIST));
+  fail_unless (gst_flups_index_add (index, 17000, 16 * DIST));
+  fail_unless (gst_flups_index_add (index, 1000, 0));
+  fail_unless (gst_flups_index_add (index, 13000, 12 * DIST));
+  fail_unless (gst_flups_index_add (index, 5000, 4 * DIST));
+  check_entries (index, expected, G_N_ELEMENTS (expected) / 2);
+
+  fail_unless_equals_int (gst_flups_index_find_pos (index, 0), 0);
+  fail_unless_equals_int (gst_flups_index_find_pos (index, 1), 1);
+  fail_unless_equals_int (gst_flups_index_find_pos (index, 8 * DIST), 2);
+  fail_unless_equals_int (gst_flups_index_find_pos (index, 20 * DIST), 5);
+
+  g_array_free (index, TRUE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_reject)
+{
+  static const guint64 expected[] = {
+    4 * DIST, 5000,
+    8 * DIST, 9000,
+  };
+  GArray *index = index_new ();
+
+  fail_unless (gst_flups_index_add (index, 5000, 4 * DIST));
+  fail_unless (gst_flups_index_add (index, 9000, 8 * DIST));
+
+  /* unknown SCR or offset */
+  fail_if (gst_flups_index_add (index, G_MAXUINT64, 0));
+  fail_if (gst_flups_index_add (index, 1000, G_MAXUINT64));
+  /* SCR going backwards, after a discontinuity */
+  fail_if (gst_flups_index_add (index, 4000, 6 * DIST));
+  fail_if (gst_flups_index_add (index, 100, 12 * DIST));
+  fail_if (gst_flups_index_add (index, 10000, 0));
+  fail_if (gst_flups_index_add (index, 9500, 6 * DIST));
+  /* too close to an existing entry, on either side, or the same */
+  fail_if (gst_flups_index_add (index, 8000, 8 * DIST - 1));
+  fail_if (gst_flups_index_add (index, 9000, 8 * DIST));
+  fail_if (gst_flups_index_add (index, 9001, 8 * DIST + DIST - 1));
+  fail_if (gst_flups_index_add (index, 4000, 3 * DIST + 1));
+  check_entries (index, expected, G_N_ELEMENTS (expected) / 2);
+
+  /* exactly the minimum distance is fine */
+  fail_unless (gst_flups_index_add (index, 7000, 6 * DIST));
+  fail_unless (gst_flups_index_add (index, 10000, 9 * DIST));
+  fail_unless_equals_int (index->len, 4);
+
+  g_array_free (index, TRUE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_lookup)
+{
+  GArray *index = index_new ();
+  guint64 min_scr, min_offset, max_scr, max_offset;
+
+  gst_flups_index_add (index, 5000, 4 * DIST);
+  gst_flups_index_add (index, 9000, 8 * DIST);
+  gst_flups_index_add (index, 10000, 9 * DIST);
+
+  /* narrowed to the entries around the SCR, no early return */
+  min_scr = 0;
+  min_offset = 0;
+  max_scr = 20000;
+  max_offset = 20 * DIST;
+  fail_if (gst_flups_index_lookup (index, 7000, &min_scr, &min_offset,
+          &max_scr, &max_offset));
+  fail_unless_equals_uint64 (min_scr, 5000);
+  fail_unless_equals_uint64 (min_offset, 4 * DIST);
+  fail_unless_equals_uint64 (max_scr, 9000);
+  fail_unless_equals_uint64 (max_offset, 8 * DIST);
+
+  /* an interval already narrower than the index is kept */
+  min_scr = 6000;
+  min_offset = 5 * DIST;
+  max_scr = 8000;
+  max_offset = 7 * DIST;
+  fail_if (gst_flups_index_lookup (index, 7000, &min_scr, &min_offset,
+          &max_scr, &max_offset));
+  fail_unless_equals_uint64 (min_offset, 5 * DIST);
+  fail_unless_equals_uint64 (max_offset, 7 * DIST);
+
+  /* an SCR that is indexed returns early at its pack */
+  min_scr = 0;
+  min_offset = 0;
+  max_scr = 20000;
+  max_offset = 20 * DIST;
+  fail_unless (gst_flups_index_lookup (index, 5000, &min_scr, &min_offset,
+          &max_scr, &max_offset));
+  fail_unless_equals_uint64 (min_offset, 4 * DIST);
+
+  /* and so does one between entries that are close together */
+  min_scr = 0;
+  min_offset = 0;
+  max_scr = 20000;
+  max_offset = 20 * DIST;
+  fail_unless (gst_flups_index_lookup (index, 9500, &min_scr, &min_offset,
+          &max_scr, &max_offset));
+  fail_unless_equals_uint64 (min_offset, 8 * DIST);
+  fail_unless_equals_uint64 (max_offset, 9 * DIST);
+
+  /* past the last entry */
+  min_scr = 0;
+  min_offset = 0;
+  max_scr = 20000;
+  max_offset = 20 * DIST;
+  fail_if (gst_flups_index_lookup (index, 15000, &min_scr, &min_offset,
+          &max_scr, &max_offset));
+  fail_unless_equals_uint64 (min_offset, 9 * DIST);
+  fail_unless_equals_uint64 (max_offset, 20 * DIST);
+
+  /* nothing indexed */
+  g_array_set_size (index, 0);
+  min_scr = 0;
+  min_offset = 0;
+  max_scr = 20000;
+  max_offset = 20 * DIST;
+  fail_if (gst_flups_index_lookup (index, 7000, &min_scr, &min_offset,
+          &max_scr, &max_offset));
+  fail_unless_equals_uint64 (min_offset, 0);
+  fail_unless_equals_uint64 (max_offset, 20 * DIST);
+
+  g_array_free (index, TRUE);
+}
+
+GST_END_TEST;
+
+/* reverse playback starts its chunks at indexed packs close enough */
+GST_START_TEST (test_chunk_start)
+{
+  GArray *index = index_new ();
+
+  gst_flups_index_add (index, 5000, 4 * DIST);
+  gst_flups_index_add (index, 9000, 8 * DIST);
+
+  fail_unless_equals_uint64 (gst_flups_index_chunk_start (index, 8 * DIST,
+          4 * DIST), 4 * DIST);
+  fail_unless_equals_uint64 (gst_flups_index_chunk_start (index,
+          8 * DIST + 1, 4 * DIST), 8 * DIST);
+  fail_unless_equals_uint64 (gst_flups_index_chunk_start (index, 12 * DIST,
+          4 * DIST), 8 * DIST);
+  fail_unless (gst_flups_index_chunk_start (index, 12 * DIST + 1,
+          4 * DIST) == G_MAXUINT64);
+  fail_unless (gst_flups_index_chunk_start (index, 4 * DIST,
+          4 * DIST) == G_MAXUINT64);
+
+  g_array_free (index, TRUE);
+}
+
+GST_END_TEST;
+
+static Suite *
+mpegpsdemux_suite (void)
+{
+  Suite *s = suite_create ("mpegpsdemux");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_insert);
+  tcase_add_test (tc_chain, test_reject);
+  tcase_add_test (tc_chain, test_lookup);
+  tcase_add_test (tc_chain, test_chunk_start);
+
+  return s;
+}
+
+GST_CHECK_MAIN (mpegpsdemux);
@@ -29,6 +29,10 @@ static GMainLoop *loop = NULL;
 static gboolean have_eos = FALSE;
 static gboolean have_data = FALSE;
 
+/* the file served by _src_getrange() */
+static const guint8 *src_file = NULL;
+static gsize src_file_size = 0;
+
 static GstStaticPadTemplate mysrctemplate =
 GST_STATIC_PAD_TEMPLATE ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("application/mxf"));
@@ -131,11 +135,11 @@ static GstFlowReturn
 _src_getrange (GstPad * pad, GstObject * parent, guint64 offset, guint length,
     GstBuffer ** buffer)
 {
-  if (offset + length > sizeof (mxf_file))
+  if (offset + length > src_file_size)
     return GST_FLOW_EOS;
 
   *buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
-      (guint8 *) (mxf_file + offset), length, 0, length, NULL, NULL);
+      (guint8 *) (src_file + offset), length, 0, length, NULL, NULL);
 
   return GST_FLOW_OK;
 }
@@ -153,7 +157,7 @@ _src_query (GstPad * pad, GstObject * parent, GstQuery * query)
   if (fmt != GST_FORMAT_BYTES)
     return FALSE;
 
-  gst_query_set_duration (query, fmt, sizeof (mxf_file));
+  gst_query_set_duration (query, fmt, src_file_size);
 
   return TRUE;
 }
@@ -168,17 +172,104 @@ _create_src_pad_pull (void)
   return mysrcpad;
 }
 
-GST_START_TEST (test_pull)
+static gboolean
+_read_structure (gpointer user_data)
+{
+  GstElement *mxfdemux = user_data;
+  GstStructure *s = NULL;
+
+  /* Requests the descriptive metadata from the application thread while
+   * the streaming thread is running */
+  g_object_get (mxfdemux, "structure", &s, NULL);
+  if (s)
+    gst_structure_free (s);
+
+  return TRUE;
+}
+
+/* instance UID of the DMS-1 framework in mxf_dms_file */
+#define DM_FRAMEWORK_UID "ad.d5.00.00.00.00.00.00.00.00.00.00.00.00.00.04"
+
+static gboolean _find_dm_framework (const GstStructure * s);
+
+static gboolean
+_value_has_dm_framework (const GValue * v)
+{
+  guint i;
+
+  if (GST_VALUE_HOLDS_STRUCTURE (v))
+    return _find_dm_framework (gst_value_get_structure (v));
+
+  if (GST_VALUE_HOLDS_ARRAY (v)) {
+    for (i = 0; i < gst_value_array_get_size (v); i++)
+      if (_value_has_dm_framework (gst_value_array_get_value (v, i)))
+        return TRUE;
+  }
+
+  return FALSE;
+}
+
+/* looks for a DM segment that references the framework */
+static gboolean
+_find_dm_framework (const GstStructure * s)
+{
+  guint i;
+
+  if (gst_structure_has_name (s, "dm-segment")) {
+    const gchar *uid = gst_structure_get_string (s, "dm-framework");
+
+    return uid != NULL && strcmp (uid, DM_FRAMEWORK_UID) == 0;
+  }
+
+  for (i = 0; i < gst_structure_n_fields (s); i++) {
+    const gchar *name = gst_structure_nth_field_name (s, i);
+
+    if (_value_has_dm_framework (gst_structure_get_value (s, name)))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+static void
+_check_structure (GstElement * mxfdemux, gboolean has_dm_framework)
+{
+  GstStructure *s = NULL;
+  const GValue *v;
+
+  g_object_get (mxfdemux, "structure", &s, NULL);
+  fail_unless (s != NULL);
+  fail_unless (gst_structure_has_name (s, "preface"));
+
+  v = gst_structure_get_value (s, "content-storage");
+  fail_unless (v != NULL);
+  fail_unless (GST_VALUE_HOLDS_STRUCTURE (v));
+  fail_unless (gst_structure_has_field (gst_value_get_structure (v),
+          "packages"));
+
+  fail_unless_equals_int (_find_dm_framework (s), has_dm_framework);
+
+  gst_structure_free (s);
+}
+
+static void
+_run_pull (const guint8 * file, gsize size, gboolean lazy_descriptive_metadata,
+    gboolean read_while_playing)
 {
   GstElement *mxfdemux;
   GstPad *sinkpad;
+  guint read_structure_id = 0;
 
+  src_file = file;
+  src_file_size = size;
   have_eos = FALSE;
   have_data = FALSE;
   loop = g_main_loop_new (NULL, FALSE);
 
   mxfdemux = gst_element_factory_make ("mxfdemux", NULL);
   fail_unless (mxfdemux != NULL);
+  g_object_set (mxfdemux, "lazy-descriptive-metadata",
+      lazy_descriptive_metadata, NULL);
   g_signal_connect (mxfdemux, "pad-added", G_CALLBACK (_pad_added), NULL);
   sinkpad = gst_element_get_static_pad (mxfdemux, "sink");
   fail_unless (sinkpad != NULL);
@@ -194,12 +285,23 @@ GST_START_TEST (test_pull)
   gst_pad_set_active (mysinkpad, TRUE);
   gst_pad_set_active (mysrcpad, TRUE);
 
+  if (read_while_playing)
+    read_structure_id = g_timeout_add (1, _read_structure, mxfdemux);
+
   gst_element_set_state (mxfdemux, GST_STATE_PLAYING);
 
   g_main_loop_run (loop);
   fail_unless (have_eos == TRUE);
   fail_unless (have_data == TRUE);
 
+  if (read_structure_id)
+    g_source_remove (read_structure_id);
+
+  /* Reading the structure after EOS requests the descriptive metadata in
+   * lazy mode as well, the streaming thread is idle now so it has to be
+   * parsed right away */
+  _check_structure (mxfdemux, file == mxf_dms_file);
+
   gst_element_set_state (mxfdemux, GST_STATE_NULL);
   gst_pad_set_active (mysinkpad, FALSE);
   gst_pad_set_active (mysrcpad, FALSE);
@@ -211,6 +313,40 @@ GST_START_TEST (test_pull)
   loop = NULL;
 }
 
+GST_START_TEST (test_pull)
+{
+  _run_pull (mxf_file, sizeof (mxf_file), FALSE, FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_lazy_descriptive_metadata)
+{
+  _run_pull (mxf_file, sizeof (mxf_file), TRUE, TRUE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_descriptive_metadata)
+{
+  _run_pull (mxf_dms_file, sizeof (mxf_dms_file), FALSE, FALSE);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_lazy_descriptive_metadata_while_playing)
+{
+  _run_pull (mxf_dms_file, sizeof (mxf_dms_file), TRUE, TRUE);
+}
+
+GST_END_TEST;
+
+/* nothing asks for the descriptive metadata before EOS */
+GST_START_TEST (test_pull_lazy_descriptive_metadata_after_eos)
+{
+  _run_pull (mxf_dms_file, sizeof (mxf_dms_file), TRUE, FALSE);
+}
+
 GST_END_TEST;
 
 GST_START_TEST (test_push)
@@ -272,6 +408,10 @@ mxfdemux_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_set_timeout (tc_chain, 180);
   tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_lazy_descriptive_metadata);
+  tcase_add_test (tc_chain, test_pull_descriptive_metadata);
+  tcase_add_test (tc_chain, test_pull_lazy_descriptive_metadata_while_playing);
+  tcase_add_test (tc_chain, test_pull_lazy_descriptive_metadata_after_eos);
   tcase_add_test (tc_chain, test_push);
 
   return s;
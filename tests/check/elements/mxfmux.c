@@ -64,13 +64,53 @@ on_message_cb (GstBus * bus, GstMessage * message, gpointer user_data)
   }
 }
 
+typedef struct
+{
+  GByteArray *data;
+  guint64 position;
+} OutputData;
+
+/* Writes the muxed stream into a byte array, the header partition is
+ * rewritten after a segment event back to offset 0 */
+static GstPadProbeReturn
+output_probe_cb (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  OutputData *output = user_data;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+    gsize size = gst_buffer_get_size (buffer);
+
+    if (output->position + size > output->data->len)
+      g_byte_array_set_size (output->data, output->position + size);
+    gst_buffer_extract (buffer, 0, output->data->data + output->position,
+        size);
+    output->position += size;
+  } else {
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+    if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) {
+      const GstSegment *segment;
+
+      gst_event_parse_segment (event, &segment);
+      fail_unless (segment->format == GST_FORMAT_BYTES);
+      output->position = segment->start;
+    }
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* If @output is not NULL the stream arriving at the element named "sink"
+ * is stored in it */
 static void
-run_test (const gchar * pipeline_string)
+run_test_full (const gchar * pipeline_string, GByteArray * output)
 {
   GstElement *pipeline;
   GstBus *bus;
   GMainLoop *loop;
   OnMessageUserData omud = { NULL, };
+  OutputData output_data = { output, 0 };
   GstStateChangeReturn ret;
 
   GST_DEBUG ("Testing pipeline '%s'", pipeline_string);
@@ -79,6 +119,19 @@ run_test (const gchar * pipeline_string)
   fail_unless (pipeline != NULL);
   g_object_set (G_OBJECT (pipeline), "async-handling", TRUE, NULL);
 
+  if (output) {
+    GstElement *sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+    GstPad *pad;
+
+    fail_unless (sink != NULL);
+    pad = gst_element_get_static_pad (sink, "sink");
+    gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+        GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, output_probe_cb, &output_data,
+        NULL);
+    gst_object_unref (pad);
+    gst_object_unref (sink);
+  }
+
   loop = g_main_loop_new (NULL, FALSE);
 
   bus = gst_element_get_bus (pipeline);
@@ -107,6 +160,158 @@ run_test (const gchar * pipeline_string)
   gst_object_unref (bus);
 }
 
+static void
+run_test (const gchar * pipeline_string)
+{
+  run_test_full (pipeline_string, NULL);
+}
+
+static const guint8 partition_pack_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x05, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01
+};
+
+static const guint8 index_table_segment_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x53, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01, 0x10, 0x01, 0x00
+};
+
+static const guint8 primer_pack_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x05, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01, 0x05, 0x01, 0x00
+};
+
+static const guint8 random_index_pack_key[] = {
+  0x06, 0x0e, 0x2b, 0x34, 0x02, 0x05, 0x01, 0x01,
+  0x0d, 0x01, 0x02, 0x01, 0x01, 0x11, 0x01, 0x00
+};
+
+typedef struct
+{
+  guint n_header_partitions, n_body_partitions, n_footer_partitions;
+  /* body partitions that carry index table segments */
+  guint n_indexed_body_partitions;
+  /* body partitions that repeat the header metadata */
+  guint n_body_partitions_with_metadata;
+  /* random index packs, only as the last packet of the file */
+  guint n_random_index_packs;
+  guint n_index_entries;
+  guint n_random_access_entries;
+  guint64 last_stream_offset;
+} MXFFileInfo;
+
+/* Returns the number of entries of the segment */
+static guint
+parse_index_table_segment (const guint8 * data, guint size,
+    MXFFileInfo * info)
+{
+  guint64 start_position = G_MAXUINT64, duration = 0;
+  guint n_entries = 0;
+
+  while (size >= 4) {
+    guint16 tag = GST_READ_UINT16_BE (data);
+    guint16 tag_size = GST_READ_UINT16_BE (data + 2);
+
+    data += 4;
+    size -= 4;
+    fail_unless (tag_size <= size);
+
+    if (tag == 0x3f0c) {
+      start_position = GST_READ_UINT64_BE (data);
+    } else if (tag == 0x3f0d) {
+      duration = GST_READ_UINT64_BE (data);
+    } else if (tag == 0x3f0a) {
+      guint entry_size, i;
+
+      n_entries = GST_READ_UINT32_BE (data);
+      entry_size = GST_READ_UINT32_BE (data + 4);
+      fail_unless (entry_size >= 11);
+      fail_unless_equals_int (tag_size, 8 + n_entries * entry_size);
+
+      for (i = 0; i < n_entries; i++) {
+        const guint8 *entry = data + 8 + i * entry_size;
+        guint64 stream_offset = GST_READ_UINT64_BE (entry + 3);
+
+        if (entry[2] & 0x80)
+          info->n_random_access_entries++;
+        if (info->n_index_entries + i > 0)
+          fail_unless (stream_offset > info->last_stream_offset);
+        info->last_stream_offset = stream_offset;
+      }
+    }
+
+    data += tag_size;
+    size -= tag_size;
+  }
+
+  /* segments follow each other without gaps */
+  fail_unless_equals_uint64 (start_position, info->n_index_entries);
+  fail_unless_equals_uint64 (duration, n_entries);
+  info->n_index_entries += n_entries;
+
+  return n_entries;
+}
+
+/* Walks the KLV packets of a muxed file, counting the partitions and
+ * checking the index table segments */
+static void
+parse_mxf_file (const guint8 * data, guint size, MXFFileInfo * info)
+{
+  guint offset = 0;
+  guint8 partition_type = 0;
+  gboolean partition_indexed = FALSE;
+
+  memset (info, 0, sizeof (MXFFileInfo));
+
+  while (offset < size) {
+    const guint8 *key = data + offset;
+    guint64 length;
+    guint ber_size;
+
+    fail_unless (offset + 17 <= size);
+    if (key[16] & 0x80) {
+      guint i, n = key[16] & 0x7f;
+
+      fail_unless (n > 0 && n <= 8 && offset + 17 + n <= size);
+      length = 0;
+      for (i = 0; i < n; i++)
+        length = (length << 8) | key[17 + i];
+      ber_size = 1 + n;
+    } else {
+      length = key[16];
+      ber_size = 1;
+    }
+    fail_unless (offset + 16 + ber_size + length <= size);
+
+    if (memcmp (key, partition_pack_key, sizeof (partition_pack_key)) == 0) {
+      partition_type = key[13];
+      if (partition_type == 0x02)
+        info->n_header_partitions++;
+      else if (partition_type == 0x03)
+        info->n_body_partitions++;
+      else if (partition_type == 0x04)
+        info->n_footer_partitions++;
+      partition_indexed = FALSE;
+    } else if (memcmp (key, index_table_segment_key,
+            sizeof (index_table_segment_key)) == 0) {
+      if (parse_index_table_segment (key + 16 + ber_size, length, info) > 0
+          && partition_type == 0x03 && !partition_indexed) {
+        info->n_indexed_body_partitions++;
+        partition_indexed = TRUE;
+      }
+    } else if (memcmp (key, primer_pack_key, sizeof (primer_pack_key)) == 0) {
+      if (partition_type == 0x03)
+        info->n_body_partitions_with_metadata++;
+    } else if (memcmp (key, random_index_pack_key,
+            sizeof (random_index_pack_key)) == 0) {
+      fail_unless (offset + 16 + ber_size + length == size);
+      info->n_random_index_packs++;
+    }
+
+    offset += 16 + ber_size + length;
+  }
+}
+
 GST_START_TEST (test_mpeg2)
 {
   const gchar *mpeg2enc_name = get_mpeg2enc_element_name ();
@@ -239,6 +444,87 @@ GST_START_TEST (test_multiple_av_streams)
 
 GST_END_TEST;
 
+GST_START_TEST (test_partition_interval)
+{
+  gchar *pipeline;
+
+  GByteArray *output = g_byte_array_new ();
+  MXFFileInfo info;
+
+  pipeline = g_strdup_printf ("videotestsrc num-buffers=250 ! "
+      "video/x-raw,format=(string)v308,width=320,height=240,framerate=25/1 ! "
+      "mxfmux name=mux partition-interval=1000000000 ! "
+      "fakesink name=sink "
+      "audiotestsrc num-buffers=250 ! "
+      "audioconvert ! " "audio/x-raw,rate=48000,channels=2 ! " "mux. ");
+
+  run_test_full (pipeline, output);
+  g_free (pipeline);
+
+  parse_mxf_file (output->data, output->len, &info);
+
+  /* 250 frames at 25 fps: the body partition after the header metadata
+   * and one every 25 content packages after that. Every body partition
+   * but the first carries the index of the previous one, the footer the
+   * index of the last one */
+  fail_unless_equals_int (info.n_header_partitions, 1);
+  fail_unless_equals_int (info.n_body_partitions, 10);
+  fail_unless_equals_int (info.n_footer_partitions, 1);
+  fail_unless_equals_int (info.n_indexed_body_partitions, 9);
+  fail_unless_equals_int (info.n_body_partitions_with_metadata, 0);
+  fail_unless_equals_int (info.n_random_index_packs, 1);
+  fail_unless_equals_int (info.n_index_entries, 250);
+  /* uncompressed video, every content package is a random access point */
+  fail_unless_equals_int (info.n_random_access_entries, 250);
+
+  g_byte_array_unref (output);
+}
+
+GST_END_TEST;
+
+/* the header metadata is repeated on its own interval, in the body
+ * partitions that are due anyway or in extra ones */
+static void
+check_header_interval (const gchar * properties, guint n_body_partitions)
+{
+  gchar *pipeline;
+  GByteArray *output = g_byte_array_new ();
+  MXFFileInfo info;
+
+  pipeline = g_strdup_printf ("videotestsrc num-buffers=250 ! "
+      "video/x-raw,format=(string)v308,width=320,height=240,framerate=25/1 ! "
+      "mxfmux name=mux header-interval=2000000000 %s ! "
+      "fakesink name=sink "
+      "audiotestsrc num-buffers=250 ! "
+      "audioconvert ! " "audio/x-raw,rate=48000,channels=2 ! " "mux. ",
+      properties);
+
+  run_test_full (pipeline, output);
+  g_free (pipeline);
+
+  parse_mxf_file (output->data, output->len, &info);
+
+  /* copies after 50, 100, 150 and 200 content packages */
+  fail_unless_equals_int (info.n_header_partitions, 1);
+  fail_unless_equals_int (info.n_body_partitions, n_body_partitions);
+  fail_unless_equals_int (info.n_footer_partitions, 1);
+  fail_unless_equals_int (info.n_indexed_body_partitions,
+      n_body_partitions - 1);
+  fail_unless_equals_int (info.n_body_partitions_with_metadata, 4);
+  fail_unless_equals_int (info.n_random_index_packs, 1);
+  fail_unless_equals_int (info.n_index_entries, 250);
+
+  g_byte_array_unref (output);
+}
+
+GST_START_TEST (test_header_interval)
+{
+  check_header_interval ("", 5);
+  check_header_interval ("partition-interval=1000000000", 10);
+}
+
+GST_END_TEST;
+
 static Suite *
 mxfmux_suite (void)
 {
@@ -254,6 +540,8 @@ mxfmux_suite (void)
   tcase_add_test (tc_chain, test_jpeg2000_alaw);
   tcase_add_test (tc_chain, test_dnxhd_mp3);
   tcase_add_test (tc_chain, test_multiple_av_streams);
+  tcase_add_test (tc_chain, test_partition_interval);
+  tcase_add_test (tc_chain, test_header_interval);
 
   return s;
 }
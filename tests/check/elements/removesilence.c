@@ -0,0 +1,243 @@
+/* GStreamer
+ *
+ * unit test for removesilence
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/audio/audio.h>
+#include <math.h>
+
+#define RATE 8000
+
+/* 100 ms of tone, 200 ms of silence and 100 ms of tone */
+#define TONE_SAMPLES (RATE / 10)
+#define SILENCE_SAMPLES (RATE / 5)
+#define N_SAMPLES (2 * TONE_SAMPLES + SILENCE_SAMPLES)
+
+#define CAPS_STRING "audio/x-raw, " \
+    "format = (string) " GST_AUDIO_NE (S16) ", " \
+    "layout = (string) interleaved, " \
+    "rate = (int) 8000, " \
+    "channels = (int) 1"
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CAPS_STRING));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (CAPS_STRING));
+
+static GstElement *
+setup_removesilence (void)
+{
+  GstElement *removesilence;
+  GstCaps *caps;
+  GstSegment segment;
+
+  GST_DEBUG ("setup_removesilence");
+  removesilence = gst_check_setup_element ("removesilence");
+  mysrcpad = gst_check_setup_src_pad (removesilence, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (removesilence, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  /* a single block of silence switches to silence */
+  gst_util_set_object_arg (G_OBJECT (removesilence), "mode", "block");
+  g_object_set (removesilence, "hysteresis", (guint64) 1, NULL);
+
+  fail_unless (gst_element_set_state (removesilence,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (CAPS_STRING);
+  fail_unless (gst_pad_set_caps (mysrcpad, caps));
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  return removesilence;
+}
+
+static void
+cleanup_removesilence (GstElement * removesilence)
+{
+  GST_DEBUG ("cleanup_removesilence");
+  gst_element_set_state (removesilence, GST_STATE_NULL);
+
+  gst_check_drop_buffers ();
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (removesilence);
+  gst_check_teardown_sink_pad (removesilence);
+  gst_check_teardown_element (removesilence);
+}
+
+static GstBuffer *
+create_tone_silence_tone (void)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gint16 *data;
+  gint i;
+
+  buffer = gst_buffer_new_and_alloc (N_SAMPLES * sizeof (gint16));
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  data = (gint16 *) map.data;
+  for (i = 0; i < N_SAMPLES; i++) {
+    if (i < TONE_SAMPLES || i >= TONE_SAMPLES + SILENCE_SAMPLES)
+      data[i] = 16000 * sin (2 * G_PI * 400 * i / RATE);
+    else
+      data[i] = 0;
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  GST_BUFFER_TIMESTAMP (buffer) = GST_SECOND;
+  GST_BUFFER_DURATION (buffer) = N_SAMPLES * GST_SECOND / RATE;
+
+  return buffer;
+}
+
+static void
+check_part (GstBuffer * buffer, gint offset, gint len)
+{
+  fail_unless_equals_int (gst_buffer_get_size (buffer), len * sizeof (gint16));
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffer),
+      GST_SECOND + gst_util_uint64_scale_int (offset, GST_SECOND, RATE));
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer),
+      gst_util_uint64_scale_int (len, GST_SECOND, RATE));
+}
+
+GST_START_TEST (test_block_split)
+{
+  GstElement *removesilence;
+
+  removesilence = setup_removesilence ();
+  g_object_set (removesilence, "remove", TRUE, NULL);
+
+  fail_unless_equals_int (gst_pad_push (mysrcpad, create_tone_silence_tone ()),
+      GST_FLOW_OK);
+
+  /* the silence in the middle splits the buffer, the second tone keeps its
+   * timestamp */
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  check_part (GST_BUFFER (buffers->data), 0, TONE_SAMPLES);
+  check_part (GST_BUFFER (buffers->next->data),
+      TONE_SAMPLES + SILENCE_SAMPLES, TONE_SAMPLES);
+
+  cleanup_removesilence (removesilence);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_block_keep)
+{
+  GstElement *removesilence;
+
+  removesilence = setup_removesilence ();
+
+  /* without remove the buffer passes unchanged */
+  fail_unless_equals_int (gst_pad_push (mysrcpad, create_tone_silence_tone ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  check_part (GST_BUFFER (buffers->data), 0, N_SAMPLES);
+
+  cleanup_removesilence (removesilence);
+}
+
+GST_END_TEST;
+
+static GstBuffer *
+create_tone (gint freq, gint amplitude, gint n_samples)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gint16 *data;
+  gint i;
+
+  buffer = gst_buffer_new_and_alloc (n_samples * sizeof (gint16));
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  data = (gint16 *) map.data;
+  for (i = 0; i < n_samples; i++)
+    data[i] = amplitude * sin (2 * G_PI * freq * i / RATE + 0.3);
+  gst_buffer_unmap (buffer, &map);
+
+  GST_BUFFER_TIMESTAMP (buffer) = GST_SECOND;
+  GST_BUFFER_DURATION (buffer) = n_samples * GST_SECOND / RATE;
+
+  return buffer;
+}
+
+/* a loud fricative crosses zero on most samples but is kept */
+GST_START_TEST (test_block_fricative)
+{
+  GstElement *removesilence;
+
+  removesilence = setup_removesilence ();
+  g_object_set (removesilence, "remove", TRUE, NULL);
+
+  fail_unless_equals_int (gst_pad_push (mysrcpad, create_tone (3000, 16000,
+              TONE_SAMPLES)), GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  check_part (GST_BUFFER (buffers->data), 0, TONE_SAMPLES);
+
+  cleanup_removesilence (removesilence);
+}
+
+GST_END_TEST;
+
+/* noise just above the threshold that crosses zero on most samples is
+ * removed */
+GST_START_TEST (test_block_noise)
+{
+  GstElement *removesilence;
+
+  removesilence = setup_removesilence ();
+  g_object_set (removesilence, "remove", TRUE, "threshold", -60, NULL);
+
+  /* about -55 dB */
+  fail_unless_equals_int (gst_pad_push (mysrcpad, create_tone (3000, 80,
+              TONE_SAMPLES)), GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 0);
+
+  cleanup_removesilence (removesilence);
+}
+
+GST_END_TEST;
+
+static Suite *
+removesilence_suite (void)
+{
+  Suite *s = suite_create ("removesilence");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_block_split);
+  tcase_add_test (tc_chain, test_block_keep);
+  tcase_add_test (tc_chain, test_block_fricative);
+  tcase_add_test (tc_chain, test_block_noise);
+
+  return s;
+}
+
+GST_CHECK_MAIN (removesilence);
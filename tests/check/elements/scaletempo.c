@@ -0,0 +1,241 @@
+/* GStreamer
+ *
+ * unit test for the best overlap search of scaletempo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include "gstscaletempocorr.h"
+
+/* The element windows the overlap and searches the queue, this does the
+ * same on noise with the layouts of a few rates and channel counts. */
+typedef struct
+{
+  guint frames_overlap;
+  guint frames_search;
+  guint channels;
+  guint n;
+  guint n_search;
+  gfloat *window;
+  gfloat *pre_corr;
+  gfloat *search;
+  gint32 *window_s16;
+  gint32 *pre_corr_s16;
+  gint16 *search_s16;
+  GstScaletempoCorrFFT fft;
+} Search;
+
+static guint32 seed;
+
+static gint16
+noise (void)
+{
+  seed = seed * 1103515245 + 12345;
+  return (gint) ((seed >> 16) & 0x7fff) - 0x4000;
+}
+
+static void
+search_init (Search * s, guint frames_overlap, guint frames_search,
+    guint channels)
+{
+  gint64 t = frames_overlap;
+  gint32 f = 8589934588LL / (t * t);
+  guint i, j;
+
+  memset (s, 0, sizeof (Search));
+  s->frames_overlap = frames_overlap;
+  s->frames_search = frames_search;
+  s->channels = channels;
+  s->n = (frames_overlap - 1) * channels;
+  s->n_search = frames_search * channels + s->n;
+  s->window = g_new (gfloat, s->n);
+  s->pre_corr = g_new (gfloat, s->n);
+  s->search = g_new (gfloat, s->n_search);
+  s->window_s16 = g_new (gint32, s->n);
+  /* padded like the element does for the unrolled loop */
+  s->pre_corr_s16 = g_new0 (gint32, s->n + 3);
+  s->search_s16 = g_new0 (gint16, s->n_search + 3);
+
+  for (i = 1; i < frames_overlap; i++) {
+    for (j = 0; j < channels; j++) {
+      s->window[(i - 1) * channels + j] = i * (frames_overlap - i);
+      s->window_s16[(i - 1) * channels + j] = (i * (t - i) * f) >> 15;
+    }
+  }
+
+  gst_scaletempo_corr_fft_init (&s->fft,
+      gst_scaletempo_corr_fft_length (s->n_search));
+}
+
+static void
+search_free (Search * s)
+{
+  gst_scaletempo_corr_fft_free (&s->fft);
+  g_free (s->search_s16);
+  g_free (s->pre_corr_s16);
+  g_free (s->window_s16);
+  g_free (s->search);
+  g_free (s->pre_corr);
+  g_free (s->window);
+}
+
+/* fills the search region and the overlap with noise, or copies the overlap
+ * from the search region at @planted if it is not -1 */
+static void
+search_fill (Search * s, gint planted)
+{
+  guint i;
+
+  for (i = 0; i < s->n_search; i++) {
+    s->search_s16[i] = noise ();
+    s->search[i] = s->search_s16[i] / 32768.0f;
+  }
+  for (i = 0; i < s->n; i++) {
+    gint16 o = planted < 0 ? noise () :
+        s->search_s16[planted * s->channels + i];
+
+    s->pre_corr[i] = s->window[i] * (o / 32768.0f);
+    s->pre_corr_s16[i] = (s->window_s16[i] * o) >> 15;
+  }
+}
+
+static guint
+search_fft_float (Search * s)
+{
+  memcpy (s->fft.overlap, s->pre_corr, s->n * sizeof (gfloat));
+  memcpy (s->fft.search, s->search, s->n_search * sizeof (gfloat));
+
+  return gst_scaletempo_corr_fft (&s->fft, s->n, s->n_search,
+      s->frames_search, s->channels);
+}
+
+static guint
+search_fft_s16 (Search * s)
+{
+  guint i;
+
+  for (i = 0; i < s->n; i++)
+    s->fft.overlap[i] = s->pre_corr_s16[i];
+  for (i = 0; i < s->n_search; i++)
+    s->fft.search[i] = s->search_s16[i];
+
+  return gst_scaletempo_corr_fft (&s->fft, s->n, s->n_search,
+      s->frames_search, s->channels);
+}
+
+/* the correlation at @off, exactly */
+static gdouble
+correlation (Search * s, guint off)
+{
+  gdouble corr = 0.0;
+  guint i;
+
+  for (i = 0; i < s->n; i++)
+    corr += (gdouble) s->pre_corr[i] * s->search[off * s->channels + i];
+
+  return corr;
+}
+
+static const guint layouts[][3] = {
+  /* frames_overlap, frames_search, channels */
+  {132, 308, 1},
+  {264, 617, 2},
+  {288, 672, 6},
+  {576, 1344, 2},
+  {48, 112, 1},
+};
+
+GST_START_TEST (test_planted_overlap)
+{
+  guint l, k;
+
+  seed = 1;
+  for (l = 0; l < G_N_ELEMENTS (layouts); l++) {
+    Search s;
+
+    search_init (&s, layouts[l][0], layouts[l][1], layouts[l][2]);
+
+    for (k = 0; k < 10; k++) {
+      guint planted = (k * 7919) % s.frames_search;
+
+      search_fill (&s, planted);
+      fail_unless_equals_int (gst_scaletempo_corr_float (s.pre_corr,
+              s.search, s.n, s.frames_search, s.channels), planted);
+      fail_unless_equals_int (gst_scaletempo_corr_s16 (s.pre_corr_s16,
+              s.search_s16, s.n, s.frames_search, s.channels), planted);
+      fail_unless_equals_int (search_fft_float (&s), planted);
+      fail_unless_equals_int (search_fft_s16 (&s), planted);
+    }
+
+    search_free (&s);
+  }
+}
+
+GST_END_TEST;
+
+/* Without a clear peak the float sums of the two ways round differently and
+ * can pick different offsets whose correlations are as good as equal. */
+GST_START_TEST (test_noise)
+{
+  guint l, k;
+
+  seed = 2;
+  for (l = 0; l < G_N_ELEMENTS (layouts); l++) {
+    Search s;
+
+    search_init (&s, layouts[l][0], layouts[l][1], layouts[l][2]);
+
+    for (k = 0; k < 10; k++) {
+      gdouble best = -G_MAXDOUBLE, scale = 0.0, corr_fft;
+      guint off, i;
+
+      search_fill (&s, -1);
+      for (off = 0; off < s.frames_search; off++)
+        best = MAX (best, correlation (&s, off));
+      for (i = 0; i < s.n; i++)
+        scale += ABS (s.pre_corr[i]);
+
+      corr_fft = correlation (&s, search_fft_float (&s));
+      fail_unless (best - corr_fft <= 1e-4 * scale,
+          "fft offset correlates %g, best %g", corr_fft, best);
+      off = gst_scaletempo_corr_float (s.pre_corr, s.search, s.n,
+          s.frames_search, s.channels);
+      fail_unless (best - correlation (&s, off) <= 1e-4 * scale,
+          "float offset correlates %g, best %g", correlation (&s, off), best);
+    }
+
+    search_free (&s);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+scaletempo_suite (void)
+{
+  Suite *s = suite_create ("scaletempo");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_planted_overlap);
+  tcase_add_test (tc_chain, test_noise);
+
+  return s;
+}
+
+GST_CHECK_MAIN (scaletempo);
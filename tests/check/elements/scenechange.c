@@ -0,0 +1,228 @@
+/* GStreamer
+ *
+ * unit test for the scoring of scenechange
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include "gstscenechangedecimate.h"
+#include "gstvideofiltersbadorc-dist.h"
+
+#define WIDTH 320
+#define HEIGHT 240
+#define N_FRAMES 50
+
+static guint32 seed;
+
+static gint
+noise (gint amplitude)
+{
+  seed = seed * 1103515245 + 12345;
+  return (gint) ((seed >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+/* A scene is a gradient with a bright rectangle on it that pans by a few
+ * pixels per frame, plus some sensor noise */
+typedef struct
+{
+  gint base;
+  gint gx, gy;
+  gint rect_x, rect_y, rect_w, rect_h;
+  gint rect_luma;
+  gint pan;
+} Scene;
+
+static const Scene scenes[] = {
+  {40, 1, 2, 60, 40, 80, 60, 200, 2},
+  {150, -1, 0, 200, 120, 60, 90, 30, -3},
+  {90, 0, -1, 20, 150, 150, 50, 230, 1},
+  {200, -2, 1, 100, 20, 40, 180, 60, 4},
+};
+
+/* the first frame of each scene after the first */
+static const gint cuts[] = { 12, 25, 37 };
+
+static void
+render (guint8 * frame, const Scene * scene, gint t)
+{
+  gint x, y;
+
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      gint u = x + scene->pan * t;
+      gint v = scene->base + (scene->gx * u + scene->gy * y) / 4;
+
+      if (u >= scene->rect_x && u < scene->rect_x + scene->rect_w &&
+          y >= scene->rect_y && y < scene->rect_y + scene->rect_h)
+        v = scene->rect_luma;
+      frame[y * WIDTH + x] = CLAMP (v + noise (8), 0, 255);
+    }
+  }
+}
+
+/* Runs the sequence through the decimation, the SAD and the scoring like
+ * the element does and returns in @change which frames it takes for the
+ * start of a scene, and in @scores the score of each frame */
+static void
+run_sequence (gint factor, gboolean * change, gdouble * scores)
+{
+  gint width = WIDTH / factor, height = HEIGHT / factor;
+  guint8 *frame = g_malloc (WIDTH * HEIGHT);
+  guint8 *plane = g_malloc (width * height);
+  guint8 *oldplane = g_malloc (width * height);
+  gdouble diffs[SC_N_DIFFS] = { 0, };
+  gint n_diffs = 0, scene = 0, start = 0, i;
+
+  seed = 1;
+  for (i = 0; i < N_FRAMES; i++) {
+    gdouble threshold;
+    guint32 sad;
+    guint8 *tmp;
+
+    if (scene < G_N_ELEMENTS (cuts) && i == cuts[scene]) {
+      scene++;
+      start = i;
+    }
+    render (frame, &scenes[scene], i - start);
+    gst_scene_change_decimate_rows (plane, width, factor, frame, WIDTH, 0,
+        height);
+
+    change[i] = FALSE;
+    scores[i] = 0.0;
+    if (i > 0) {
+      video_filters_bad_orc_sad_u8 (&sad, oldplane, plane, width * height);
+      scores[i] = (gdouble) sad / (width * height);
+      change[i] = gst_scene_change_score (diffs, &n_diffs, scores[i],
+          &threshold);
+    }
+
+    tmp = oldplane;
+    oldplane = plane;
+    plane = tmp;
+  }
+
+  g_free (oldplane);
+  g_free (plane);
+  g_free (frame);
+}
+
+static gboolean
+is_cut (gint frame)
+{
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (cuts); i++)
+    if (cuts[i] == frame)
+      return TRUE;
+  return FALSE;
+}
+
+static void
+check_cuts (gint factor)
+{
+  gboolean change[N_FRAMES];
+  gdouble scores[N_FRAMES];
+  gint i;
+
+  run_sequence (factor, change, scores);
+  for (i = 0; i < N_FRAMES; i++)
+    fail_unless (change[i] == is_cut (i),
+        "downscale %d, frame %d with score %g: scene change %d, expected %d",
+        factor, i, scores[i], change[i], is_cut (i));
+}
+
+GST_START_TEST (test_cuts)
+{
+  gint factor;
+
+  for (factor = 1; factor <= GST_SCENE_CHANGE_MAX_DOWNSCALE; factor++)
+    check_cuts (factor);
+}
+
+GST_END_TEST;
+
+/* The averaged blocks take out the noise but keep the content, so the score
+ * of a cut hardly changes with the default downscale of 4 while that of a
+ * frame within a scene drops */
+GST_START_TEST (test_downscale_scores)
+{
+  gboolean change[N_FRAMES];
+  gdouble full[N_FRAMES], decimated[N_FRAMES];
+  gint i;
+
+  run_sequence (1, change, full);
+  run_sequence (4, change, decimated);
+
+  for (i = 1; i < N_FRAMES; i++) {
+    if (is_cut (i))
+      fail_unless (decimated[i] > 0.8 * full[i],
+          "frame %d: score %g at downscale 4, %g at 1", i, decimated[i],
+          full[i]);
+    else
+      fail_unless (decimated[i] < full[i],
+          "frame %d: score %g at downscale 4, %g at 1", i, decimated[i],
+          full[i]);
+  }
+}
+
+GST_END_TEST;
+
+/* the ORC backup function against the plain sum */
+GST_START_TEST (test_sad)
+{
+  static const gint sizes[] = { 0, 1, 7, 16, 17, 1000, 76800 };
+  guint8 *a = g_malloc (76800), *b = g_malloc (76800);
+  gint i, k;
+
+  seed = 2;
+  for (i = 0; i < 76800; i++) {
+    /* the extremes first, then noise */
+    a[i] = i < 2 ? 255 * i : noise (128) + 127;
+    b[i] = i < 2 ? 255 * (1 - i) : noise (128) + 127;
+  }
+
+  for (k = 0; k < G_N_ELEMENTS (sizes); k++) {
+    guint32 sad = 12345, expected = 0;
+
+    for (i = 0; i < sizes[k]; i++)
+      expected += ABS (a[i] - b[i]);
+    video_filters_bad_orc_sad_u8 (&sad, a, b, sizes[k]);
+    fail_unless_equals_int (sad, expected);
+  }
+
+  g_free (b);
+  g_free (a);
+}
+
+GST_END_TEST;
+
+static Suite *
+scenechange_suite (void)
+{
+  Suite *s = suite_create ("scenechange");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_sad);
+  tcase_add_test (tc_chain, test_cuts);
+  tcase_add_test (tc_chain, test_downscale_scores);
+
+  return s;
+}
+
+GST_CHECK_MAIN (scenechange);
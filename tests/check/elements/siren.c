@@ -0,0 +1,194 @@
+/* GStreamer
+ *
+ * unit test for the siren codec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* The reference files were made with the codec as it was before the DCT-IV
+ * went through an FFT: siren-reference.bit is the encoded signal of
+ * generate_input() and siren-reference.raw is that bitstream decoded, as 16
+ * bit little endian samples. */
+
+#include <gst/check/gstcheck.h>
+#include <math.h>
+
+#include "siren7.h"
+
+#define N_FRAMES 50
+#define FRAME_SAMPLES 320
+#define FRAME_BYTES 40
+
+/* two triangle waves at five levels and some noise, without floating point
+ * so that it is the same everywhere */
+static void
+generate_input (gint16 * samples, guint n_samples)
+{
+  guint32 seed = 1;
+  guint i;
+
+  for (i = 0; i < n_samples; i++) {
+    gint v1 = i % 64, v2 = i % 13, level = (i / 1600) % 5 + 1, noise;
+    gint t1 = (v1 < 32 ? v1 : 64 - v1) * 500 - 8000;
+    gint t2 = (v2 < 7 ? v2 : 13 - v2) * 860 - 3000;
+
+    seed = seed * 1103515245 + 12345;
+    noise = (gint) ((seed >> 16) & 1023) - 512;
+    samples[i] = GINT16_TO_LE ((t1 + t2) * level / 5 + noise);
+  }
+}
+
+static guint8 *
+load_reference (const gchar * name, gsize size)
+{
+  gchar *path, *data = NULL;
+  gsize len = 0;
+
+  path = g_build_filename (GST_TEST_FILES_PATH, name, NULL);
+  fail_unless (g_file_get_contents (path, &data, &len, NULL),
+      "could not read %s", path);
+  fail_unless_equals_int (len, size);
+  g_free (path);
+
+  return (guint8 *) data;
+}
+
+static void
+encode (const gint16 * samples, guint8 * bits)
+{
+  SirenEncoder encoder = Siren7_NewEncoder (16000);
+  guint i;
+
+  for (i = 0; i < N_FRAMES; i++)
+    fail_unless_equals_int (Siren7_EncodeFrame (encoder,
+            (guint8 *) (samples + i * FRAME_SAMPLES), bits + i * FRAME_BYTES),
+        0);
+  Siren7_CloseEncoder (encoder);
+}
+
+static void
+decode (const guint8 * bits, gint16 * samples)
+{
+  SirenDecoder decoder = Siren7_NewDecoder (16000);
+  guint i;
+
+  for (i = 0; i < N_FRAMES; i++)
+    fail_unless_equals_int (Siren7_DecodeFrame (decoder,
+            (guint8 *) bits + i * FRAME_BYTES,
+            (guint8 *) (samples + i * FRAME_SAMPLES)), 0);
+  Siren7_CloseDecoder (decoder);
+}
+
+/* signal to noise ratio of @test against @ref in dB */
+static gdouble
+snr (const gint16 * ref, const gint16 * test)
+{
+  gdouble signal = 0.0, noise = 0.0;
+  guint i;
+
+  for (i = 0; i < N_FRAMES * FRAME_SAMPLES; i++) {
+    gdouble r = GINT16_FROM_LE (ref[i]), t = GINT16_FROM_LE (test[i]);
+
+    signal += r * r;
+    noise += (r - t) * (r - t);
+  }
+
+  if (noise == 0.0)
+    return G_MAXDOUBLE;
+  return 10.0 * log10 (signal / noise);
+}
+
+GST_START_TEST (test_decode_reference)
+{
+  guint8 *bits;
+  gint16 *ref, *out;
+  gdouble db;
+  guint i;
+
+  bits = load_reference ("siren-reference.bit", N_FRAMES * FRAME_BYTES);
+  ref = (gint16 *) load_reference ("siren-reference.raw",
+      N_FRAMES * FRAME_SAMPLES * sizeof (gint16));
+  out = g_new (gint16, N_FRAMES * FRAME_SAMPLES);
+
+  /* the transform is more precise now, which can move samples by rounding */
+  decode (bits, out);
+  db = snr (ref, out);
+  fail_unless (db > 80.0, "decoded signal only %.1f dB from the reference",
+      db);
+  for (i = 0; i < N_FRAMES * FRAME_SAMPLES; i++)
+    fail_unless (ABS (GINT16_FROM_LE (out[i]) - GINT16_FROM_LE (ref[i])) <= 2,
+        "sample %u is %d, reference %d", i, GINT16_FROM_LE (out[i]),
+        GINT16_FROM_LE (ref[i]));
+
+  g_free (out);
+  g_free (ref);
+  g_free (bits);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_encode_reference)
+{
+  guint8 *ref_bits, *bits;
+  gint16 *ref, *in, *out;
+  guint i, n_diff = 0;
+  gdouble db;
+
+  ref_bits = load_reference ("siren-reference.bit", N_FRAMES * FRAME_BYTES);
+  ref = (gint16 *) load_reference ("siren-reference.raw",
+      N_FRAMES * FRAME_SAMPLES * sizeof (gint16));
+  in = g_new (gint16, N_FRAMES * FRAME_SAMPLES);
+  out = g_new (gint16, N_FRAMES * FRAME_SAMPLES);
+  bits = g_new (guint8, N_FRAMES * FRAME_BYTES);
+
+  generate_input (in, N_FRAMES * FRAME_SAMPLES);
+  encode (in, bits);
+
+  /* a coefficient on a quantizer boundary can go either way, a broken
+   * transform changes almost every byte */
+  for (i = 0; i < N_FRAMES * FRAME_BYTES; i++)
+    if (bits[i] != ref_bits[i])
+      n_diff++;
+  fail_unless (n_diff <= N_FRAMES * FRAME_BYTES / 100,
+      "%u bytes of the bitstream differ", n_diff);
+
+  decode (bits, out);
+  db = snr (ref, out);
+  fail_unless (db > 40.0, "round trip only %.1f dB from the reference", db);
+
+  g_free (bits);
+  g_free (out);
+  g_free (in);
+  g_free (ref);
+  g_free (ref_bits);
+}
+
+GST_END_TEST;
+
+static Suite *
+siren_suite (void)
+{
+  Suite *s = suite_create ("siren");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_decode_reference);
+  tcase_add_test (tc_chain, test_encode_reference);
+
+  return s;
+}
+
+GST_CHECK_MAIN (siren);
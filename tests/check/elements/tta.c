@@ -0,0 +1,275 @@
+/* GStreamer
+ *
+ * unit test for ttadec
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/bandpool/gstbandpool.h>
+
+#include "gstttafilter.h"
+
+/* the element itself is not ported yet, so this checks the filter stages it
+ * runs after the Rice decoding against the decoder of the original ttalib */
+
+#define RATE 44100
+
+/* The decoder as it was before the channels were filtered in parallel,
+ * with the filter of the original ttalib */
+typedef struct
+{
+  long shift;
+  long round;
+  long error;
+  long qm[MAX_ORDER + 1];
+  long dx[MAX_ORDER + 1];
+  long dl[MAX_ORDER + 1];
+} RefFilter;
+
+static void
+ref_memshl (long *pA, long *pB)
+{
+  *pA++ = *pB++;
+  *pA++ = *pB++;
+  *pA++ = *pB++;
+  *pA++ = *pB++;
+  *pA++ = *pB++;
+  *pA++ = *pB++;
+  *pA++ = *pB++;
+  *pA = *pB;
+}
+
+static void
+ref_hybrid_filter (RefFilter * fs, long *in)
+{
+  long *pA = fs->dl;
+  long *pB = fs->qm;
+  long *pM = fs->dx;
+  long sum = fs->round;
+  gint i;
+
+  if (!fs->error) {
+    for (i = 0; i < MAX_ORDER; i++)
+      sum += *pA++ * *pB, pB++;
+    pM += MAX_ORDER;
+  } else if (fs->error < 0) {
+    for (i = 0; i < MAX_ORDER; i++)
+      sum += *pA++ * (*pB -= *pM++), pB++;
+  } else {
+    for (i = 0; i < MAX_ORDER; i++)
+      sum += *pA++ * (*pB += *pM++), pB++;
+  }
+
+  *(pM - 0) = ((*(pA - 1) >> 30) | 1) << 2;
+  *(pM - 1) = ((*(pA - 2) >> 30) | 1) << 1;
+  *(pM - 2) = ((*(pA - 3) >> 30) | 1) << 1;
+  *(pM - 3) = ((*(pA - 4) >> 30) | 1);
+
+  fs->error = *in;
+  *in += (sum >> fs->shift);
+  *pA = *in;
+
+  *(pA - 1) = *(pA - 0) - *(pA - 1);
+  *(pA - 2) = *(pA - 1) - *(pA - 2);
+  *(pA - 3) = *(pA - 2) - *(pA - 3);
+
+  ref_memshl (fs->dl, fs->dl + 1);
+  ref_memshl (fs->dx, fs->dx + 1);
+}
+
+static void
+write_sample (guint8 ** p, long value, gint bytes)
+{
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+  if (bytes > 2)
+    *(*p)++ = (guint8) (value >> 16);
+  if (bytes > 1)
+    *(*p)++ = (guint8) (value >> 8);
+  *(*p)++ = (guint8) value;
+#else
+  *(*p)++ = (guint8) value;
+  if (bytes > 1)
+    *(*p)++ = (guint8) (value >> 8);
+  if (bytes > 2)
+    *(*p)++ = (guint8) (value >> 16);
+#endif
+}
+
+/* decodes @n_samples interleaved @residuals to @out like the old decoder */
+static void
+ref_decode (const long *residuals, gint channels, gint bytes, gint n_samples,
+    guint8 * out)
+{
+  RefFilter fs[8];
+  long last[8], cache[8];
+  gint i, ch, k;
+
+  for (ch = 0; ch < channels; ch++) {
+    memset (&fs[ch], 0, sizeof (RefFilter));
+    fs[ch].shift = flt_set[bytes - 1];
+    fs[ch].round = 1 << (fs[ch].shift - 1);
+    last[ch] = 0;
+  }
+  k = bytes == 1 ? 4 : 5;
+
+  for (i = 0; i < n_samples; i++) {
+    for (ch = 0; ch < channels; ch++) {
+      long value = residuals[i * channels + ch];
+
+      ref_hybrid_filter (&fs[ch], &value);
+      value += PREDICTOR1 (last[ch], k);
+      last[ch] = value;
+      cache[ch] = value;
+    }
+
+    if (channels > 1) {
+      long *prev = cache + channels - 1;
+      long *r = prev - 1;
+
+      for (*prev += *r / 2; r >= cache; r--)
+        *r = *(r + 1) - *r;
+    }
+    for (ch = 0; ch < channels; ch++)
+      write_sample (&out, cache[ch], bytes);
+  }
+}
+
+/* random residuals of a frame of @n_samples interleaved samples */
+static long *
+create_residuals (gint channels, gint n_samples, guint32 seed)
+{
+  GRand *rand = g_rand_new_with_seed (seed);
+  long *residuals;
+  gint i;
+
+  residuals = g_new (long, channels * n_samples);
+  for (i = 0; i < channels * n_samples; i++)
+    residuals[i] = g_rand_int_range (rand, -256, 256);
+  g_rand_free (rand);
+
+  return residuals;
+}
+
+typedef struct
+{
+  decoder *tta;
+  long *values;
+  guint channels, bytes, n_bands;
+  gint n_samples;
+} FilterData;
+
+static void
+filter_band (gpointer data, gpointer user_data)
+{
+  guint band = *(guint *) data;
+  FilterData *f = user_data;
+  guint ch;
+
+  for (ch = band; ch < f->channels; ch += f->n_bands)
+    gst_tta_filter_channel (&f->tta[ch], f->values + ch * f->n_samples,
+        f->n_samples, f->bytes);
+}
+
+/* decodes @residuals like ttadec does after the Rice decoding, with the
+ * channels spread over the bands for @n_threads threads */
+static void
+decode (const long *residuals, gint channels, gint bytes, gint n_samples,
+    guint n_threads, guint8 * out)
+{
+  FilterData f;
+  decoder tta[8];
+  long cache[8];
+  guint bands[8], b;
+  gint i, ch;
+
+  for (ch = 0; ch < channels; ch++) {
+    filter_init (&tta[ch].fst, flt_set[bytes - 1]);
+    tta[ch].last = 0;
+  }
+
+  /* the Rice decoding stores the residuals per channel */
+  f.values = g_new (long, channels * n_samples);
+  for (i = 0; i < n_samples; i++) {
+    for (ch = 0; ch < channels; ch++)
+      f.values[ch * n_samples + i] = residuals[i * channels + ch];
+  }
+
+  f.tta = tta;
+  f.channels = channels;
+  f.bytes = bytes;
+  f.n_samples = n_samples;
+  f.n_bands = gst_band_pool_get_n_bands (n_threads, channels, 1);
+  for (b = 0; b < f.n_bands; b++)
+    bands[b] = b;
+  gst_band_pool_run (gst_band_pool_get_default (), filter_band, &f, bands,
+      sizeof (guint), f.n_bands);
+
+  gst_tta_decorrelate (f.values, n_samples, channels, bytes, n_samples, cache,
+      out);
+
+  g_free (f.values);
+}
+
+GST_START_TEST (test_bit_exact)
+{
+  static const gint n_channels[] = { 1, 2, 6, 8 };
+  const gint n_samples = RATE / 10;
+  gint c, bytes;
+
+  for (c = 0; c < G_N_ELEMENTS (n_channels); c++) {
+    for (bytes = 1; bytes <= 3; bytes++) {
+      gint channels = n_channels[c];
+      guint size = channels * n_samples * bytes;
+      long *residuals;
+      guint8 *expected, *out;
+
+      GST_DEBUG ("%d channels, %d bits", channels, bytes * 8);
+
+      residuals = create_residuals (channels, n_samples, c * 3 + bytes);
+      expected = g_malloc (size);
+      out = g_malloc (size);
+      ref_decode (residuals, channels, bytes, n_samples, expected);
+
+      /* serial and with the channels spread over several bands */
+      decode (residuals, channels, bytes, n_samples, 1, out);
+      fail_unless (memcmp (out, expected, size) == 0);
+      memset (out, 0, size);
+      decode (residuals, channels, bytes, n_samples, 4, out);
+      fail_unless (memcmp (out, expected, size) == 0);
+
+      g_free (out);
+      g_free (expected);
+      g_free (residuals);
+    }
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+tta_suite (void)
+{
+  Suite *s = suite_create ("tta");
+  TCase *tc_chain = tcase_create ("filter");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_bit_exact);
+
+  return s;
+}
+
+GST_CHECK_MAIN (tta);
@@ -0,0 +1,206 @@
+/* GStreamer
+ *
+ * unit test for the band pool library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/bandpool/gstbandpool.h>
+
+#define N_BANDS 16
+#define N_RUNNERS 4
+#define N_RUNS 50
+
+typedef struct
+{
+  guint index;
+  GThread *thread;
+  volatile gint runs;
+} TestBand;
+
+/* bands that are running on pool threads right now, and the maximum */
+static volatile gint running = 0;
+static volatile gint max_running = 0;
+
+static void
+test_band_func (gpointer data, gpointer user_data)
+{
+  TestBand *band = data;
+  GThread *caller = user_data;
+  gint now, max;
+
+  band->thread = g_thread_self ();
+  g_atomic_int_inc (&band->runs);
+
+  if (band->thread == caller)
+    return;
+
+  now = g_atomic_int_add (&running, 1) + 1;
+  do {
+    max = g_atomic_int_get (&max_running);
+  } while (now > max && !g_atomic_int_compare_and_exchange (&max_running, max,
+          now));
+
+  /* give the other bands time to start */
+  g_usleep (1000);
+
+  g_atomic_int_add (&running, -1);
+}
+
+static void
+init_bands (TestBand * bands, guint n_bands)
+{
+  guint i;
+
+  for (i = 0; i < n_bands; i++) {
+    bands[i].index = i;
+    bands[i].thread = NULL;
+    bands[i].runs = 0;
+  }
+}
+
+GST_START_TEST (test_n_bands)
+{
+  guint n_cpus = gst_band_pool_get_n_cpus ();
+
+  fail_unless (n_cpus >= 1);
+
+  fail_unless_equals_int (gst_band_pool_get_n_bands (4, 1000, 10), 4);
+  /* 0 threads means one per processor */
+  fail_unless_equals_int (gst_band_pool_get_n_bands (0, 1000, 10),
+      MIN (n_cpus, 100));
+  /* bands have at least the minimum size */
+  fail_unless_equals_int (gst_band_pool_get_n_bands (8, 20, 10), 2);
+  fail_unless_equals_int (gst_band_pool_get_n_bands (8, 5, 10), 1);
+  fail_unless_equals_int (gst_band_pool_get_n_bands (8, 0, 10), 1);
+  fail_unless_equals_int (gst_band_pool_get_n_bands (8, 5, 0), 5);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_run)
+{
+  GstBandPool *pool = gst_band_pool_get_default ();
+  TestBand bands[N_BANDS];
+  guint i;
+
+  fail_unless (pool != NULL);
+  fail_unless (gst_band_pool_get_default () == pool);
+
+  init_bands (bands, N_BANDS);
+  gst_band_pool_run (pool, test_band_func, g_thread_self (), bands,
+      sizeof (TestBand), N_BANDS);
+
+  /* every band ran once, the first one in this thread */
+  for (i = 0; i < N_BANDS; i++)
+    fail_unless_equals_int (bands[i].runs, 1);
+  fail_unless (bands[0].thread == g_thread_self ());
+
+  /* a single band does not need the threads */
+  init_bands (bands, 1);
+  gst_band_pool_run (pool, test_band_func, g_thread_self (), bands,
+      sizeof (TestBand), 1);
+  fail_unless_equals_int (bands[0].runs, 1);
+  fail_unless (bands[0].thread == g_thread_self ());
+
+  gst_band_pool_run (pool, test_band_func, g_thread_self (), NULL,
+      sizeof (TestBand), 0);
+}
+
+GST_END_TEST;
+
+static gpointer
+runner_func (gpointer user_data)
+{
+  GstBandPool *pool = user_data;
+  TestBand bands[N_BANDS];
+  guint i, j;
+
+  for (i = 0; i < N_RUNS; i++) {
+    init_bands (bands, N_BANDS);
+    gst_band_pool_run (pool, test_band_func, g_thread_self (), bands,
+        sizeof (TestBand), N_BANDS);
+
+    /* the run only returns once all of its own bands are done */
+    for (j = 0; j < N_BANDS; j++)
+      if (g_atomic_int_get (&bands[j].runs) != 1)
+        return GINT_TO_POINTER (FALSE);
+  }
+
+  return GINT_TO_POINTER (TRUE);
+}
+
+/* several elements run their bands on the default pool at the same time,
+ * it never uses more threads than there are processors */
+GST_START_TEST (test_concurrent_runs)
+{
+  GstBandPool *pool = gst_band_pool_get_default ();
+  GThread *runners[N_RUNNERS];
+  guint i;
+
+  running = max_running = 0;
+
+  for (i = 0; i < N_RUNNERS; i++) {
+    runners[i] = g_thread_new ("band-runner", runner_func, pool);
+    fail_unless (runners[i] != NULL);
+  }
+
+  for (i = 0; i < N_RUNNERS; i++)
+    fail_unless (GPOINTER_TO_INT (g_thread_join (runners[i])));
+
+  fail_unless_equals_int (running, 0);
+  fail_unless (max_running >= 1);
+  fail_unless (max_running <= gst_band_pool_get_n_cpus (),
+      "%d bands ran at the same time on %u processors", max_running,
+      gst_band_pool_get_n_cpus ());
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_private_pool)
+{
+  GstBandPool *pool = gst_band_pool_new ();
+  TestBand bands[N_BANDS];
+  guint i;
+
+  init_bands (bands, N_BANDS);
+  gst_band_pool_run (pool, test_band_func, g_thread_self (), bands,
+      sizeof (TestBand), N_BANDS);
+  for (i = 0; i < N_BANDS; i++)
+    fail_unless_equals_int (bands[i].runs, 1);
+
+  gst_band_pool_free (pool);
+}
+
+GST_END_TEST;
+
+static Suite *
+bandpool_suite (void)
+{
+  Suite *s = suite_create ("bandpool");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_n_bands);
+  tcase_add_test (tc_chain, test_run);
+  tcase_add_test (tc_chain, test_concurrent_runs);
+  tcase_add_test (tc_chain, test_private_pool);
+
+  return s;
+}
+
+GST_CHECK_MAIN (bandpool);
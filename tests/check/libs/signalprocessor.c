@@ -0,0 +1,337 @@
+/* GStreamer
+ *
+ * unit test for the signal processor base class
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/signalprocessor/gstsignalprocessor.h>
+#include <string.h>
+
+#define RATE 48000
+
+static GstPad *mysrcpad, *mysinkpad;
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* a processor that copies its input to its output and records what every
+ * process() call got */
+typedef GstSignalProcessor GstTestCopy;
+typedef GstSignalProcessorClass GstTestCopyClass;
+
+typedef struct
+{
+  guint nframes;
+  gboolean in_place;
+} TestCall;
+
+static GArray *calls = NULL;
+
+static void
+gst_test_copy_process (GstSignalProcessor * self, guint nframes)
+{
+  GstSignalProcessorClass *klass = GST_SIGNAL_PROCESSOR_GET_CLASS (self);
+  TestCall call = { nframes, FALSE };
+
+  if (klass->num_group_in) {
+    GstSignalProcessorGroup *in = &self->group_in[0];
+    GstSignalProcessorGroup *out = &self->group_out[0];
+
+    fail_unless_equals_int (in->nframes, nframes);
+    fail_unless_equals_int (out->nframes, nframes);
+    memcpy (out->buffer, in->buffer, nframes * in->channels * sizeof (gfloat));
+    call.in_place = (in->interleaved_buffer == out->interleaved_buffer);
+  } else {
+    if (self->audio_out[0] != self->audio_in[0])
+      memcpy (self->audio_out[0], self->audio_in[0], nframes * sizeof (gfloat));
+    call.in_place = (self->audio_out[0] == self->audio_in[0]);
+  }
+
+  g_array_append_val (calls, call);
+}
+
+/* @class_data is the number of channels, mono processors work in place */
+static void
+gst_test_copy_class_init (GstTestCopyClass * klass, gpointer class_data)
+{
+  guint channels = GPOINTER_TO_UINT (class_data);
+
+  gst_element_class_set_details_simple (GST_ELEMENT_CLASS (klass),
+      "Copy", "Filter/Effect/Audio", "Copies the input to the output",
+      "GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+
+  gst_signal_processor_class_add_pad_template (klass, "sink", GST_PAD_SINK,
+      0, channels);
+  gst_signal_processor_class_add_pad_template (klass, "src", GST_PAD_SRC,
+      0, channels);
+  if (channels > 1) {
+    klass->num_group_in = klass->num_group_out = 1;
+  } else {
+    klass->num_audio_in = klass->num_audio_out = 1;
+    GST_SIGNAL_PROCESSOR_CLASS_SET_CAN_PROCESS_IN_PLACE (klass);
+  }
+  klass->process = gst_test_copy_process;
+}
+
+static GType
+gst_test_copy_get_type (guint channels)
+{
+  static GType types[3] = { 0, };
+
+  g_assert (channels > 0 && channels < G_N_ELEMENTS (types));
+
+  if (!types[channels]) {
+    GTypeInfo info = {
+      sizeof (GstTestCopyClass), NULL, NULL,
+      (GClassInitFunc) gst_test_copy_class_init, NULL,
+      GUINT_TO_POINTER (channels), sizeof (GstTestCopy), 0, NULL
+    };
+    gchar *name = g_strdup_printf ("GstTestCopy%u", channels);
+
+    types[channels] = g_type_register_static (GST_TYPE_SIGNAL_PROCESSOR, name,
+        &info, 0);
+    g_free (name);
+  }
+
+  return types[channels];
+}
+
+static GstElement *
+setup_copy (guint channels, guint block_size)
+{
+  GstElement *copy;
+  GstCaps *caps;
+  GstSegment segment;
+
+  GST_DEBUG ("setup_copy");
+  copy = g_object_new (gst_test_copy_get_type (channels), NULL);
+  g_object_set (copy, "block-size", block_size, NULL);
+  mysrcpad = gst_check_setup_src_pad (copy, &srctemplate);
+  mysinkpad = gst_check_setup_sink_pad (copy, &sinktemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (copy,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_new_simple ("audio/x-raw-float",
+      "endianness", G_TYPE_INT, G_BYTE_ORDER, "width", G_TYPE_INT, 32,
+      "channels", G_TYPE_INT, channels, "rate", G_TYPE_INT, RATE, NULL);
+  fail_unless (gst_pad_set_caps (mysrcpad, caps));
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  calls = g_array_new (FALSE, FALSE, sizeof (TestCall));
+
+  return copy;
+}
+
+static void
+cleanup_copy (GstElement * copy)
+{
+  GST_DEBUG ("cleanup_copy");
+  gst_element_set_state (copy, GST_STATE_NULL);
+
+  g_array_free (calls, TRUE);
+  calls = NULL;
+
+  gst_check_drop_buffers ();
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (copy);
+  gst_check_teardown_sink_pad (copy);
+  gst_check_teardown_element (copy);
+}
+
+/* @n_frames frames of a ramp, one float step per sample */
+static GstBuffer *
+create_ramp (guint channels, guint n_frames)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gfloat *data;
+  guint i;
+
+  buffer = gst_buffer_new_and_alloc (n_frames * channels * sizeof (gfloat));
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  data = (gfloat *) map.data;
+  for (i = 0; i < n_frames * channels; i++)
+    data[i] = i;
+  gst_buffer_unmap (buffer, &map);
+
+  GST_BUFFER_TIMESTAMP (buffer) = GST_SECOND;
+  GST_BUFFER_DURATION (buffer) =
+      gst_util_uint64_scale_int (n_frames, GST_SECOND, RATE);
+
+  return buffer;
+}
+
+static void
+check_ramp (GstBuffer * buffer, guint channels, guint n_frames)
+{
+  GstMapInfo map;
+  const gfloat *data;
+  guint i;
+
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buffer), GST_SECOND);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer),
+      gst_util_uint64_scale_int (n_frames, GST_SECOND, RATE));
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, n_frames * channels * sizeof (gfloat));
+  data = (const gfloat *) map.data;
+  for (i = 0; i < n_frames * channels; i++)
+    fail_unless (data[i] == i, "sample %u is %f", i, data[i]);
+  gst_buffer_unmap (buffer, &map);
+}
+
+static void
+check_blocks (guint n_frames, guint block_size)
+{
+  guint i, n_blocks = (n_frames + block_size - 1) / block_size;
+
+  fail_unless_equals_int (calls->len, n_blocks);
+  for (i = 0; i < n_blocks; i++) {
+    TestCall *call = &g_array_index (calls, TestCall, i);
+
+    fail_unless_equals_int (call->nframes,
+        MIN (block_size, n_frames - i * block_size));
+  }
+}
+
+GST_START_TEST (test_block_size)
+{
+  static const guint block_sizes[] = { 64, 100, 1000, 4096 };
+  guint channels, i;
+
+  for (channels = 1; channels <= 2; channels++) {
+    for (i = 0; i < G_N_ELEMENTS (block_sizes); i++) {
+      GstElement *copy = setup_copy (channels, block_sizes[i]);
+
+      fail_unless_equals_int (gst_pad_push (mysrcpad,
+              create_ramp (channels, 1000)), GST_FLOW_OK);
+
+      check_blocks (1000, block_sizes[i]);
+      fail_unless_equals_int (g_list_length (buffers), 1);
+      check_ramp (buffers->data, channels, 1000);
+
+      cleanup_copy (copy);
+    }
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_no_block_size)
+{
+  GstElement *copy = setup_copy (2, 0);
+
+  fail_unless_equals_int (gst_pad_push (mysrcpad, create_ramp (2, 1000)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push (mysrcpad, create_ramp (2, 10)),
+      GST_FLOW_OK);
+
+  /* every buffer goes to process() in one go */
+  fail_unless_equals_int (calls->len, 2);
+  fail_unless_equals_int (g_array_index (calls, TestCall, 0).nframes, 1000);
+  fail_unless_equals_int (g_array_index (calls, TestCall, 1).nframes, 10);
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  check_ramp (buffers->data, 2, 1000);
+  check_ramp (buffers->next->data, 2, 10);
+
+  cleanup_copy (copy);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_reuse_input)
+{
+  guint channels, i;
+
+  for (channels = 1; channels <= 2; channels++) {
+    GstElement *copy = setup_copy (channels, 64);
+    GstBuffer *in = create_ramp (channels, 1000);
+
+    /* a writable input is processed in place and pushed on */
+    fail_unless_equals_int (gst_pad_push (mysrcpad, in), GST_FLOW_OK);
+    fail_unless_equals_int (g_list_length (buffers), 1);
+    fail_unless (buffers->data == in);
+    check_ramp (buffers->data, channels, 1000);
+    for (i = 0; i < calls->len; i++)
+      fail_unless (g_array_index (calls, TestCall, i).in_place);
+
+    cleanup_copy (copy);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_readonly_input)
+{
+  guint channels, i;
+
+  for (channels = 1; channels <= 2; channels++) {
+    GstElement *copy = setup_copy (channels, 64);
+    GstBuffer *in = create_ramp (channels, 1000);
+
+    /* an input that is shared can not be written to */
+    gst_buffer_ref (in);
+    fail_unless_equals_int (gst_pad_push (mysrcpad, in), GST_FLOW_OK);
+    fail_unless_equals_int (g_list_length (buffers), 1);
+    fail_unless (buffers->data != in);
+    check_ramp (buffers->data, channels, 1000);
+    for (i = 0; i < calls->len; i++)
+      fail_if (g_array_index (calls, TestCall, i).in_place);
+
+    /* and is left alone */
+    fail_unless_equals_int (GST_MINI_OBJECT_REFCOUNT_VALUE (in), 1);
+    check_ramp (in, channels, 1000);
+    gst_buffer_unref (in);
+
+    cleanup_copy (copy);
+  }
+}
+
+GST_END_TEST;
+
+static Suite *
+signalprocessor_suite (void)
+{
+  Suite *s = suite_create ("signalprocessor");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_block_size);
+  tcase_add_test (tc_chain, test_no_block_size);
+  tcase_add_test (tc_chain, test_reuse_input);
+  tcase_add_test (tc_chain, test_readonly_input);
+
+  return s;
+}
+
+GST_CHECK_MAIN (signalprocessor);
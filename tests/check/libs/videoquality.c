@@ -0,0 +1,501 @@
+/* GStreamer
+ *
+ * unit test for the video quality library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/videoquality/gstvideoquality.h>
+#include <string.h>
+#include <math.h>
+
+#define WIDTH 64
+#define HEIGHT 64
+
+/* SSIM constants for 8 bit samples */
+#define C1 ((0.01 * 255) * (0.01 * 255))
+#define C2 ((0.03 * 255) * (0.03 * 255))
+
+#define ALL_METRICS (GST_VIDEO_QUALITY_METRIC_PSNR | \
+    GST_VIDEO_QUALITY_METRIC_SSIM | GST_VIDEO_QUALITY_METRIC_MS_SSIM)
+
+#define assert_close(a, b) \
+  fail_unless (fabs ((a) - (b)) < 1e-6, "%.9f != %.9f", (gdouble) (a), \
+      (gdouble) (b))
+
+static guint8 ref_data[WIDTH * HEIGHT], dist_data[WIDTH * HEIGHT];
+
+static void
+init_planes (GstVideoQualityPlane * ref, GstVideoQualityPlane * dist)
+{
+  ref->data = ref_data;
+  ref->width = WIDTH;
+  ref->height = HEIGHT;
+  ref->pstride = 1;
+  ref->stride = WIDTH;
+  *dist = *ref;
+  dist->data = dist_data;
+}
+
+static void
+fill_pattern (void)
+{
+  gint x, y;
+
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++) {
+      ref_data[y * WIDTH + x] = (x * 7 + y * 13 + x * y) % 256;
+      dist_data[y * WIDTH + x] = (ref_data[y * WIDTH + x] * 3 + x) / 4;
+    }
+  }
+}
+
+/* the 11x11 Gaussian windows with a standard deviation of 1.5 that lie
+ * inside the plane, computed directly */
+static gdouble
+reference_ssim (const GstVideoQualityPlane * ref,
+    const GstVideoQualityPlane * dist, gdouble * mean_cs)
+{
+  gdouble kernel[11][11], ssim_sum = 0, cs_sum = 0, w_sum = 0;
+  gint x, y, i, j, n = 0;
+
+  for (j = 0; j < 11; j++) {
+    for (i = 0; i < 11; i++) {
+      kernel[j][i] = exp (-((i - 5) * (i - 5) + (j - 5) * (j - 5)) / 4.5);
+      w_sum += kernel[j][i];
+    }
+  }
+
+  for (y = 5; y < ref->height - 5; y++) {
+    for (x = 5; x < ref->width - 5; x++) {
+      gdouble mr = 0, md = 0, vr = 0, vd = 0, cov = 0, cs;
+
+      for (j = 0; j < 11; j++) {
+        for (i = 0; i < 11; i++) {
+          gdouble w = kernel[j][i] / w_sum;
+
+          mr += w * ref->data[(y + j - 5) * ref->stride + x + i - 5];
+          md += w * dist->data[(y + j - 5) * dist->stride + x + i - 5];
+        }
+      }
+      for (j = 0; j < 11; j++) {
+        for (i = 0; i < 11; i++) {
+          gdouble w = kernel[j][i] / w_sum;
+          gdouble r = ref->data[(y + j - 5) * ref->stride + x + i - 5] - mr;
+          gdouble d = dist->data[(y + j - 5) * dist->stride + x + i - 5] - md;
+
+          vr += w * r * r;
+          vd += w * d * d;
+          cov += w * r * d;
+        }
+      }
+
+      cs = (2 * cov + C2) / (vr + vd + C2);
+      ssim_sum += (2 * mr * md + C1) / (mr * mr + md * md + C1) * cs;
+      cs_sum += cs;
+      n++;
+    }
+  }
+
+  if (mean_cs)
+    *mean_cs = cs_sum / n;
+
+  return ssim_sum / n;
+}
+
+static void
+reference_downscale (GstVideoQualityPlane * plane, guint8 * data)
+{
+  gint x, y;
+
+  for (y = 0; y < plane->height / 2; y++) {
+    for (x = 0; x < plane->width / 2; x++) {
+      const guint8 *p = plane->data + 2 * y * plane->stride + 2 * x;
+
+      data[y * (plane->width / 2) + x] =
+          (p[0] + p[1] + p[plane->stride] + p[plane->stride + 1] + 2) / 4;
+    }
+  }
+
+  plane->data = data;
+  plane->width /= 2;
+  plane->height /= 2;
+  plane->stride = plane->width;
+}
+
+/* the SSIM map of windows of @size clipped to the plane and normalised by
+ * the weights inside it, computed directly */
+static gdouble
+reference_ssim_map (const GstVideoQualityPlane * ref,
+    const GstVideoQualityPlane * dist, gboolean gauss, gint size,
+    gboolean fixed_mean, guint8 * map, gdouble * lowest, gdouble * highest)
+{
+  gint half = size / 2, even = 1 - size % 2;
+  gdouble sum = 0;
+  gint x, y, i, j;
+
+  *lowest = G_MAXDOUBLE;
+  *highest = -G_MAXDOUBLE;
+
+  for (y = 0; y < ref->height; y++) {
+    for (x = 0; x < ref->width; x++) {
+      gdouble w_sum = 0, mr = 0, md = 0, vr = 0, vd = 0, cov = 0, ssim;
+      gint pass;
+
+      for (pass = 0; pass < 2; pass++) {
+        for (j = y - half + even; j <= y + half; j++) {
+          for (i = x - half + even; i <= x + half; i++) {
+            gdouble w, r, d;
+
+            if (i < 0 || j < 0 || i >= ref->width || j >= ref->height)
+              continue;
+
+            w = gauss ? exp (-((i - x) * (i - x) + (j - y) * (j - y)) /
+                4.5) : 1;
+            r = ref->data[j * ref->stride + i];
+            d = dist->data[j * dist->stride + i];
+            if (pass == 0) {
+              w_sum += w;
+              mr += w * r;
+              md += w * d;
+            } else {
+              vr += w * (r - mr) * (r - mr);
+              vd += w * (d - md) * (d - md);
+              cov += w * (r - mr) * (d - md);
+            }
+          }
+        }
+        if (pass == 0) {
+          mr = fixed_mean ? 128 : mr / w_sum;
+          md = fixed_mean ? 128 : md / w_sum;
+        }
+      }
+      vr /= w_sum;
+      vd /= w_sum;
+      cov /= w_sum;
+
+      ssim = (2 * mr * md + C1) * (2 * cov + C2) /
+          ((mr * mr + md * md + C1) * (vr + vd + C2));
+      map[y * ref->width + x] = (guint8) CLAMP (127 + ssim * 128, 0, 255);
+      *lowest = MIN (*lowest, ssim);
+      *highest = MAX (*highest, ssim);
+      sum += ssim;
+    }
+  }
+
+  return sum / (ref->width * ref->height);
+}
+
+GST_START_TEST (test_identical)
+{
+  GstVideoQuality *quality;
+  GstVideoQualityPlane ref, dist;
+  GstVideoQualityResult result;
+
+  fill_pattern ();
+  init_planes (&ref, &dist);
+
+  quality = gst_video_quality_new (1);
+  gst_video_quality_measure (quality, ALL_METRICS, &ref, &ref, 1, &result);
+  assert_close (result.mse, 0);
+  fail_unless (isinf (result.psnr));
+  assert_close (result.ssim, 1);
+  assert_close (result.ms_ssim, 1);
+  gst_video_quality_free (quality);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_flat)
+{
+  GstVideoQuality *quality;
+  GstVideoQualityPlane ref, dist;
+  GstVideoQualityResult result;
+  gdouble l;
+
+  memset (ref_data, 100, sizeof (ref_data));
+  memset (dist_data, 110, sizeof (dist_data));
+  init_planes (&ref, &dist);
+
+  /* no variance, only the luminance term is left. 64x64 samples with 11x11
+   * windows give 3 scales, the last luminance term gets the weight of the
+   * 3rd scale out of the first 3 */
+  l = (2 * 100 * 110 + C1) / (100 * 100 + 110 * 110 + C1);
+
+  quality = gst_video_quality_new (1);
+  gst_video_quality_measure (quality, ALL_METRICS, &ref, &dist, 1, &result);
+  assert_close (result.mse, 100);
+  assert_close (result.psnr, 10 * log10 (255 * 255 / 100.0));
+  assert_close (result.ssim, l);
+  assert_close (result.ms_ssim, pow (l, 0.3001 / (0.0448 + 0.2856 + 0.3001)));
+  gst_video_quality_free (quality);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_columns)
+{
+  GstVideoQuality *quality;
+  GstVideoQualityPlane ref, dist;
+  GstVideoQualityResult result;
+  gint x, y;
+
+  /* lines alternating between 50 and 150 against flat 100, the window
+   * means differ a little as the windows have an odd number of lines */
+  for (y = 0; y < HEIGHT; y++) {
+    for (x = 0; x < WIDTH; x++)
+      ref_data[y * WIDTH + x] = y & 1 ? 150 : 50;
+  }
+  memset (dist_data, 100, sizeof (dist_data));
+  init_planes (&ref, &dist);
+
+  quality = gst_video_quality_new (1);
+  gst_video_quality_measure (quality, ALL_METRICS, &ref, &dist, 1, &result);
+  assert_close (result.mse, 2500);
+  assert_close (result.psnr, 10 * log10 (255 * 255 / 2500.0));
+  assert_close (result.ssim, reference_ssim (&ref, &dist, NULL));
+  gst_video_quality_free (quality);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_reference)
+{
+  static guint8 ref_scaled[3][WIDTH * HEIGHT], dist_scaled[3][WIDTH * HEIGHT];
+  static const gdouble weights[3] = { 0.0448, 0.2856, 0.3001 };
+  GstVideoQuality *quality;
+  GstVideoQualityPlane ref, dist;
+  GstVideoQualityResult result;
+  gdouble ssim, cs, ms_ssim = 1, weight_sum = 0.0448 + 0.2856 + 0.3001;
+  gint scale;
+
+  fill_pattern ();
+  init_planes (&ref, &dist);
+
+  quality = gst_video_quality_new (1);
+  gst_video_quality_measure (quality, ALL_METRICS, &ref, &dist, 1, &result);
+  assert_close (result.ssim, reference_ssim (&ref, &dist, NULL));
+
+  /* 64x64, 32x32 and 16x16 */
+  for (scale = 0; scale < 3; scale++) {
+    if (scale > 0) {
+      reference_downscale (&ref, ref_scaled[scale]);
+      reference_downscale (&dist, dist_scaled[scale]);
+    }
+    ssim = reference_ssim (&ref, &dist, &cs);
+    ms_ssim *= pow (scale < 2 ? cs : ssim, weights[scale] / weight_sum);
+  }
+  assert_close (result.ms_ssim, ms_ssim);
+  gst_video_quality_free (quality);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_small)
+{
+  GstVideoQuality *quality;
+  GstVideoQualityPlane ref, dist;
+  GstVideoQualityResult result;
+  gdouble l;
+
+  memset (ref_data, 100, sizeof (ref_data));
+  memset (dist_data, 110, sizeof (dist_data));
+  init_planes (&ref, &dist);
+  ref.width = dist.width = 8;
+  ref.height = dist.height = 4;
+
+  /* smaller than a window, measured with clipped windows */
+  l = (2 * 100 * 110 + C1) / (100 * 100 + 110 * 110 + C1);
+
+  quality = gst_video_quality_new (1);
+  gst_video_quality_measure (quality, ALL_METRICS, &ref, &dist, 1, &result);
+  assert_close (result.mse, 100);
+  assert_close (result.ssim, l);
+  assert_close (result.ms_ssim, l);
+  gst_video_quality_free (quality);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_empty)
+{
+  GstVideoQuality *quality;
+  GstVideoQualityPlane ref, dist;
+  GstVideoQualityResult result;
+  gdouble mean, lowest, highest;
+
+  init_planes (&ref, &dist);
+  ref.width = dist.width = 0;
+  ref.height = dist.height = 0;
+
+  quality = gst_video_quality_new (1);
+  gst_video_quality_measure (quality, ALL_METRICS, &ref, &dist, 1, &result);
+  fail_if (isnan (result.mse));
+  fail_if (isnan (result.ssim));
+  fail_if (isnan (result.ms_ssim));
+
+  mean = gst_video_quality_ssim_map (quality, &ref, &dist, NULL, 0, &lowest,
+      &highest);
+  fail_if (isnan (mean));
+  fail_if (isnan (lowest));
+  fail_if (isnan (highest));
+  gst_video_quality_free (quality);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ssim_map_flat)
+{
+  static guint8 map[WIDTH * HEIGHT];
+  GstVideoQuality *quality;
+  GstVideoQualityPlane ref, dist;
+  GstVideoQualityWindow window;
+  gdouble l, cs, mean, lowest, highest;
+  gint i;
+
+  memset (ref_data, 100, sizeof (ref_data));
+  memset (dist_data, 110, sizeof (dist_data));
+  init_planes (&ref, &dist);
+
+  l = (2 * 100 * 110 + C1) / (100 * 100 + 110 * 110 + C1);
+  /* with the mean fixed at 128 the luminance term is 1 and the samples
+   * deviate by -28 and -18 from it */
+  cs = (2 * 28 * 18 + C2) / (28 * 28 + 18 * 18 + C2);
+
+  quality = gst_video_quality_new (1);
+  for (window = GST_VIDEO_QUALITY_WINDOW_FLAT;
+      window <= GST_VIDEO_QUALITY_WINDOW_GAUSSIAN; window++) {
+    gst_video_quality_set_ssim_map_window (quality, window, 11, 1.5);
+
+    /* the windows at the edges are clipped and must give the same value */
+    gst_video_quality_set_ssim_map_fixed_mean (quality, FALSE);
+    mean = gst_video_quality_ssim_map (quality, &ref, &dist, map, WIDTH,
+        &lowest, &highest);
+    assert_close (mean, l);
+    assert_close (lowest, l);
+    assert_close (highest, l);
+    for (i = 0; i < WIDTH * HEIGHT; i++)
+      fail_unless_equals_int (map[i], (guint8) (127 + l * 128));
+
+    gst_video_quality_set_ssim_map_fixed_mean (quality, TRUE);
+    mean = gst_video_quality_ssim_map (quality, &ref, &dist, NULL, 0,
+        &lowest, &highest);
+    assert_close (mean, cs);
+    assert_close (lowest, cs);
+    assert_close (highest, cs);
+  }
+  gst_video_quality_free (quality);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ssim_map_reference)
+{
+  static guint8 map[WIDTH * HEIGHT], expected_map[WIDTH * HEIGHT];
+  static const gint sizes[] = { 11, 8 };
+  GstVideoQuality *quality;
+  GstVideoQualityPlane ref, dist;
+  gdouble mean, lowest, highest, expected, expected_lowest, expected_highest;
+  gint gauss, fixed_mean, s, i;
+
+  fill_pattern ();
+  init_planes (&ref, &dist);
+
+  /* the windows of the ssim element: flat or Gaussian with a standard
+   * deviation of 1.5, odd and even sizes, measured or fixed means */
+  quality = gst_video_quality_new (4);
+  for (gauss = 0; gauss <= 1; gauss++) {
+    for (s = 0; s < G_N_ELEMENTS (sizes); s++) {
+      for (fixed_mean = 0; fixed_mean <= 1; fixed_mean++) {
+        gst_video_quality_set_ssim_map_window (quality, gauss ?
+            GST_VIDEO_QUALITY_WINDOW_GAUSSIAN : GST_VIDEO_QUALITY_WINDOW_FLAT,
+            sizes[s], 1.5);
+        gst_video_quality_set_ssim_map_fixed_mean (quality, fixed_mean);
+
+        mean = gst_video_quality_ssim_map (quality, &ref, &dist, map, WIDTH,
+            &lowest, &highest);
+        expected = reference_ssim_map (&ref, &dist, gauss, sizes[s],
+            fixed_mean, expected_map, &expected_lowest, &expected_highest);
+
+        assert_close (mean, expected);
+        assert_close (lowest, expected_lowest);
+        assert_close (highest, expected_highest);
+        /* rounding may differ when a value is close to a step of the map */
+        for (i = 0; i < WIDTH * HEIGHT; i++)
+          fail_unless (ABS (map[i] - expected_map[i]) <= 1);
+      }
+    }
+  }
+  gst_video_quality_free (quality);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_threads)
+{
+  static guint8 map1[WIDTH * HEIGHT], map4[WIDTH * HEIGHT];
+  GstVideoQuality *quality1, *quality4;
+  GstVideoQualityPlane ref, dist;
+  GstVideoQualityResult result1, result4;
+  gdouble mean1, mean4;
+
+  fill_pattern ();
+  init_planes (&ref, &dist);
+
+  quality1 = gst_video_quality_new (1);
+  quality4 = gst_video_quality_new (4);
+
+  gst_video_quality_measure (quality1, ALL_METRICS, &ref, &dist, 1, &result1);
+  gst_video_quality_measure (quality4, ALL_METRICS, &ref, &dist, 1, &result4);
+  fail_unless (result1.mse == result4.mse);
+  assert_close (result1.ssim, result4.ssim);
+  assert_close (result1.ms_ssim, result4.ms_ssim);
+
+  mean1 = gst_video_quality_ssim_map (quality1, &ref, &dist, map1, WIDTH,
+      NULL, NULL);
+  mean4 = gst_video_quality_ssim_map (quality4, &ref, &dist, map4, WIDTH,
+      NULL, NULL);
+  assert_close (mean1, mean4);
+  fail_unless (memcmp (map1, map4, sizeof (map1)) == 0);
+
+  gst_video_quality_free (quality1);
+  gst_video_quality_free (quality4);
+}
+
+GST_END_TEST;
+
+static Suite *
+videoquality_suite (void)
+{
+  Suite *s = suite_create ("video quality library");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_identical);
+  tcase_add_test (tc_chain, test_flat);
+  tcase_add_test (tc_chain, test_columns);
+  tcase_add_test (tc_chain, test_reference);
+  tcase_add_test (tc_chain, test_small);
+  tcase_add_test (tc_chain, test_empty);
+  tcase_add_test (tc_chain, test_ssim_map_flat);
+  tcase_add_test (tc_chain, test_ssim_map_reference);
+  tcase_add_test (tc_chain, test_threads);
+
+  return s;
+}
+
+GST_CHECK_MAIN (videoquality);
@@ -21,7 +21,9 @@
  */
 
 #include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
 #include <string.h>
+#include <unistd.h>
 
 static const gchar *
 get_mpeg2enc_element_name (void)
@@ -260,6 +262,156 @@ GST_START_TEST (test_multiple_av_streams)
 
 GST_END_TEST;
 
+typedef struct
+{
+  gboolean flushed;
+  GstClockTime first_timestamp;
+} SeekPadData;
+
+typedef struct
+{
+  SeekPadData pads[2];
+  gint n_pads;
+} SeekData;
+
+static void
+run_pipeline (GstElement * pipeline)
+{
+  GstBus *bus = gst_element_get_bus (pipeline);
+  GstMessage *msg;
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (msg != NULL);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+}
+
+static GstPadProbeReturn
+seek_pad_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  SeekPadData *d = user_data;
+
+  /* only the seek flushes */
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_EVENT_FLUSH) {
+    if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+        GST_EVENT_FLUSH_STOP)
+      d->flushed = TRUE;
+  } else if (d->flushed && !GST_CLOCK_TIME_IS_VALID (d->first_timestamp)) {
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+    d->first_timestamp = GST_BUFFER_TIMESTAMP (buffer);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+on_seek_pad_added (GstElement * element, GstPad * pad, gpointer user_data)
+{
+  SeekData *d = user_data;
+  SeekPadData *pad_data;
+  GstElement *pipeline = GST_ELEMENT (gst_element_get_parent (element));
+  GstElement *queue, *sink;
+  GstPad *sinkpad;
+
+  /* one streaming thread feeds both sinks */
+  queue = gst_element_factory_make ("queue", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  gst_bin_add_many (GST_BIN (pipeline), queue, sink, NULL);
+  fail_unless (gst_element_link (queue, sink));
+  gst_element_sync_state_with_parent (sink);
+  gst_element_sync_state_with_parent (queue);
+
+  sinkpad = gst_element_get_static_pad (queue, "sink");
+  fail_unless (gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK);
+  gst_object_unref (sinkpad);
+
+  fail_unless (d->n_pads < G_N_ELEMENTS (d->pads));
+  pad_data = &d->pads[d->n_pads++];
+  pad_data->flushed = FALSE;
+  pad_data->first_timestamp = GST_CLOCK_TIME_NONE;
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_EVENT_FLUSH, seek_pad_probe, pad_data, NULL);
+
+  gst_object_unref (pipeline);
+}
+
+/* mxfmux interleaves both tracks into one essence container and starts a
+ * new body partition every second, the demuxer has to find the seek
+ * position from the index table segments of all partitions */
+GST_START_TEST (test_seek_multiple_partitions)
+{
+  SeekData d = { {{FALSE, 0},}, 0 };
+  GstElement *pipeline, *demux;
+  gchar *location, *desc;
+  gint fd, i;
+
+  fd = g_file_open_tmp ("mxfpartitionsXXXXXX.mxf", &location, NULL);
+  fail_unless (fd != -1);
+  close (fd);
+
+  desc = g_strdup_printf ("videotestsrc num-buffers=100 ! "
+      "video/x-raw,format=(string)v308,width=64,height=48,framerate=25/1 ! "
+      "mxfmux name=mux partition-interval=1000000000 ! "
+      "filesink location=%s "
+      "audiotestsrc num-buffers=100 samplesperbuffer=1920 ! "
+      "audioconvert ! " "audio/x-raw,rate=48000,channels=2 ! " "mux. ",
+      location);
+  pipeline = gst_parse_launch (desc, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (desc);
+  run_pipeline (pipeline);
+  gst_object_unref (pipeline);
+
+  desc = g_strdup_printf ("filesrc location=%s ! mxfdemux name=demux",
+      location);
+  pipeline = gst_parse_launch (desc, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (desc);
+
+  demux = gst_bin_get_by_name (GST_BIN (pipeline), "demux");
+  fail_unless (demux != NULL);
+  g_signal_connect (demux, "pad-added", (GCallback) on_seek_pad_added, &d);
+  gst_object_unref (demux);
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PAUSED) != GST_STATE_CHANGE_FAILURE);
+  fail_unless (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
+
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT, 3 * GST_SECOND));
+  fail_unless (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_SUCCESS);
+
+  /* every frame is a keyframe, both tracks continue with the edit unit the
+   * seek position falls into */
+  fail_unless_equals_int (d.n_pads, 2);
+  for (i = 0; i < d.n_pads; i++) {
+    fail_unless (d.pads[i].flushed);
+    fail_unless (GST_CLOCK_TIME_IS_VALID (d.pads[i].first_timestamp));
+    fail_unless (d.pads[i].first_timestamp >
+        3 * GST_SECOND - 40 * GST_MSECOND);
+    fail_unless (d.pads[i].first_timestamp <= 3 * GST_SECOND);
+  }
+
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (pipeline);
+
+  g_unlink (location);
+  g_free (location);
+}
+
+GST_END_TEST;
+
 static Suite *
 mxf_suite (void)
 {
@@ -275,6 +427,7 @@ mxf_suite (void)
   tcase_add_test (tc_chain, test_jpeg2000_alaw);
   tcase_add_test (tc_chain, test_dnxhd_mp3);
   tcase_add_test (tc_chain, test_multiple_av_streams);
+  tcase_add_test (tc_chain, test_seek_multiple_partitions);
 
   return s;
 }